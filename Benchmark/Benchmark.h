@@ -0,0 +1,158 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal headless benchmark harness. Each translation unit registers its
+// benchmarks with DX3D_BENCHMARK; Benchmark/main.cpp runs them (optionally
+// filtered by a substring passed on the command line) and can write every
+// reported value as JSON for tracking across commits. A failed correctness
+// check (bench::check, bench::fail) makes it exit non-zero. Benchmark/CMakeLists.txt
+// builds it; new benchmark files go into its source list.
+namespace dx3d::bench
+{
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+        void reset() { m_start = std::chrono::steady_clock::now(); }
+        double elapsedMs() const
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    struct BenchmarkEntry
+    {
+        const char* name;
+        std::function<void()> fn;
+    };
+
+    inline std::vector<BenchmarkEntry>& registry()
+    {
+        static std::vector<BenchmarkEntry> s_entries;
+        return s_entries;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char* name, std::function<void()> fn) { registry().push_back({ name, std::move(fn) }); }
+    };
+
+    // Scripted setup from the command line (--steps=, --size=, --particles=,
+    // --seed=). Zero means unset; simulation benchmarks fall back to their own defaults.
+    struct Config
+    {
+        int steps = 0;
+        int size = 0;
+        int particles = 0;
+        std::uint32_t seed = 0;
+        bool hasSeed = false;
+    };
+
+    inline Config& config()
+    {
+        static Config s_config;
+        return s_config;
+    }
+
+    inline int steps(int fallback) { return config().steps > 0 ? config().steps : fallback; }
+    inline int gridSize(int fallback) { return config().size > 0 ? config().size : fallback; }
+    inline int particles(int fallback) { return config().particles > 0 ? config().particles : fallback; }
+    inline std::uint32_t seed(std::uint32_t fallback) { return config().hasSeed ? config().seed : fallback; }
+
+    struct Result
+    {
+        std::string bench;
+        std::string metric;
+        double value;
+        std::string unit;
+    };
+
+    // Every value reported so far, in order
+    inline std::vector<Result>& results()
+    {
+        static std::vector<Result> s_results;
+        return s_results;
+    }
+
+    // Print one measurement line: "<bench> <metric>: <value> <unit>"
+    inline void report(const char* bench, const char* metric, double value, const char* unit)
+    {
+        std::printf("  %-32s %-28s %12.3f %s\n", bench, metric, value, unit);
+        results().push_back({ bench, metric, value, unit });
+    }
+
+    // Correctness checks failed so far; main exits with EXIT_FAILURE when any did
+    inline int& failures()
+    {
+        static int s_failures = 0;
+        return s_failures;
+    }
+
+    // Record a failed correctness check; the benchmark still runs to the end
+    inline void fail(const char* message)
+    {
+        std::printf("  FAILED: %s\n", message);
+        ++failures();
+    }
+
+    // Report a pass/fail metric as 1 or 0 and fail the run when it does not hold
+    inline bool check(const char* bench, const char* metric, bool ok)
+    {
+        report(bench, metric, ok ? 1.0 : 0.0, "");
+        if (!ok) fail(metric);
+        return ok;
+    }
+
+    // Time spent per named phase of a simulation step, summed over the run
+    class PhaseTimes
+    {
+    public:
+        void add(const char* phase, double ms)
+        {
+            for (auto& entry : m_phases)
+            {
+                if (entry.first == phase) { entry.second += ms; return; }
+            }
+            m_phases.emplace_back(phase, ms);
+        }
+
+        // One "<prefix><phase>" line per phase in ms per step
+        void report(const char* bench, const char* prefix, int steps) const
+        {
+            char metric[64];
+            for (const auto& entry : m_phases)
+            {
+                std::snprintf(metric, sizeof(metric), "%s%s", prefix, entry.first.c_str());
+                bench::report(bench, metric, entry.second / steps, "ms/step");
+            }
+        }
+
+    private:
+        std::vector<std::pair<std::string, double>> m_phases;
+    };
+
+    inline volatile unsigned char g_sink = 0;
+
+    // Keep the optimizer from discarding a computed value
+    template<typename T>
+    inline void doNotOptimize(const T& value)
+    {
+        g_sink = *reinterpret_cast<const volatile unsigned char*>(&value);
+    }
+}
+
+#define DX3D_BENCH_CONCAT_IMPL(a, b) a##b
+#define DX3D_BENCH_CONCAT(a, b) DX3D_BENCH_CONCAT_IMPL(a, b)
+#define DX3D_BENCHMARK(name) \
+    static void name(); \
+    static ::dx3d::bench::Registrar DX3D_BENCH_CONCAT(s_registrar_, name)(#name, &name); \
+    static void name()
@@ -0,0 +1,319 @@
+#include "Benchmark.h"
+#include <DX3D/Core/EntityManager.h>
+#include <DX3D/Core/AllocationCounter.h>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kEntityCount = 100000;
+    constexpr int kIterations = 50;
+
+    struct BenchPosition { float x = 0.0f, y = 0.0f; };
+    struct BenchVelocity { float x = 1.0f, y = -1.0f; };
+    struct BenchTag { int value = 0; };
+
+    // The pre-sparse-set Entity layout: one hash map of type-erased unique_ptrs per entity
+    class LegacyEntity
+    {
+    public:
+        template<typename T>
+        T& addComponent()
+        {
+            auto component = std::make_unique<T>();
+            T& ref = *component;
+            m_components[std::type_index(typeid(T))] = std::make_shared<Wrapper<T>>(std::move(component));
+            return ref;
+        }
+
+        template<typename T>
+        T* getComponent()
+        {
+            auto it = m_components.find(std::type_index(typeid(T)));
+            if (it == m_components.end()) return nullptr;
+            return std::static_pointer_cast<Wrapper<T>>(it->second)->component.get();
+        }
+
+    private:
+        struct WrapperBase { virtual ~WrapperBase() = default; };
+        template<typename T>
+        struct Wrapper : WrapperBase
+        {
+            explicit Wrapper(std::unique_ptr<T> c) : component(std::move(c)) {}
+            std::unique_ptr<T> component;
+        };
+        std::unordered_map<std::type_index, std::shared_ptr<WrapperBase>> m_components;
+    };
+}
+
+DX3D_BENCHMARK(EcsIteration100k)
+{
+    const float dt = 1.0f / 60.0f;
+
+    // Before: per-entity hash map lookups
+    {
+        std::vector<std::unique_ptr<LegacyEntity>> entities;
+        entities.reserve(kEntityCount);
+        for (int i = 0; i < kEntityCount; ++i)
+        {
+            auto e = std::make_unique<LegacyEntity>();
+            e->addComponent<BenchPosition>();
+            e->addComponent<BenchVelocity>();
+            if (i % 3 == 0) e->addComponent<BenchTag>();
+            entities.push_back(std::move(e));
+        }
+
+        bench::Stopwatch sw;
+        for (int it = 0; it < kIterations; ++it)
+        {
+            for (auto& e : entities)
+            {
+                auto* p = e->getComponent<BenchPosition>();
+                auto* v = e->getComponent<BenchVelocity>();
+                if (!p || !v) continue;
+                p->x += v->x * dt;
+                p->y += v->y * dt;
+            }
+        }
+        bench::report("EcsIteration100k", "legacy getComponent", sw.elapsedMs() / kIterations, "ms/iter");
+        bench::doNotOptimize(entities.front()->getComponent<BenchPosition>()->x);
+    }
+
+    EntityManager em;
+    for (int i = 0; i < kEntityCount; ++i)
+    {
+        auto& e = em.createEntity();
+        e.addComponent<BenchPosition>();
+        e.addComponent<BenchVelocity>();
+        if (i % 3 == 0) e.addComponent<BenchTag>();
+    }
+
+    // After, unchanged call sites: Entity::getComponent through the sparse sets
+    {
+        auto entities = em.getEntitiesWithComponent<BenchPosition>();
+        bench::Stopwatch sw;
+        for (int it = 0; it < kIterations; ++it)
+        {
+            for (auto* e : entities)
+            {
+                auto* p = e->getComponent<BenchPosition>();
+                auto* v = e->getComponent<BenchVelocity>();
+                if (!p || !v) continue;
+                p->x += v->x * dt;
+                p->y += v->y * dt;
+            }
+        }
+        bench::report("EcsIteration100k", "sparse-set getComponent", sw.elapsedMs() / kIterations, "ms/iter");
+    }
+
+    // After, dense pool iteration
+    {
+        bench::Stopwatch sw;
+        for (int it = 0; it < kIterations; ++it)
+        {
+            em.forEach<BenchPosition>([&](Entity& e, BenchPosition& p) {
+                if (auto* v = e.getComponent<BenchVelocity>())
+                {
+                    p.x += v->x * dt;
+                    p.y += v->y * dt;
+                }
+            });
+        }
+        bench::report("EcsIteration100k", "sparse-set forEach", sw.elapsedMs() / kIterations, "ms/iter");
+    }
+
+    bench::doNotOptimize(em.getComponents<BenchPosition>().front()->x);
+}
+
+DX3D_BENCHMARK(EcsAddRemove100k)
+{
+    EntityManager em;
+    std::vector<Entity*> entities;
+    entities.reserve(kEntityCount);
+
+    bench::Stopwatch sw;
+    for (int i = 0; i < kEntityCount; ++i)
+    {
+        auto& e = em.createEntity();
+        e.addComponent<BenchPosition>();
+        e.addComponent<BenchVelocity>();
+        entities.push_back(&e);
+    }
+    bench::report("EcsAddRemove100k", "create + 2 components", sw.elapsedMs(), "ms");
+
+    sw.reset();
+    for (auto* e : entities) e->removeComponent<BenchVelocity>();
+    for (auto* e : entities) e->addComponent<BenchVelocity>();
+    bench::report("EcsAddRemove100k", "remove + re-add component", sw.elapsedMs(), "ms");
+}
+
+// A PhysicsTetrisScene-style frame: many small queries over the same entity set
+DX3D_BENCHMARK(EcsScanHeavyFrame)
+{
+    constexpr int kEntities = 20000;
+    constexpr int kQueriesPerFrame = 30;
+    constexpr int kFrames = 60;
+
+    EntityManager em;
+    for (int i = 0; i < kEntities; ++i)
+    {
+        auto& e = em.createEntity();
+        e.addComponent<BenchPosition>().y = static_cast<float>(i % 100);
+        if (i % 2 == 0) e.addComponent<BenchVelocity>();
+        if (i % 5 == 0) e.addComponent<BenchTag>();
+    }
+
+    long long filteredCount = 0;
+    bench::Stopwatch sw;
+    for (int frame = 0; frame < kFrames; ++frame)
+    {
+        for (int q = 0; q < kQueriesPerFrame; ++q)
+        {
+            auto entities = em.getEntitiesWithComponent<BenchPosition>();
+            for (auto* e : entities)
+            {
+                auto* p = e->getComponent<BenchPosition>();
+                auto* v = e->getComponent<BenchVelocity>();
+                if (!p || !v) continue;
+                if (p->y == static_cast<float>(q)) ++filteredCount;
+            }
+        }
+    }
+    bench::report("EcsScanHeavyFrame", "getEntitiesWithComponent", sw.elapsedMs() / kFrames, "ms/frame");
+
+    long long viewCount = 0;
+    sw.reset();
+    for (int frame = 0; frame < kFrames; ++frame)
+    {
+        for (int q = 0; q < kQueriesPerFrame; ++q)
+        {
+            em.view<BenchPosition, BenchVelocity>().each([&](Entity&, BenchPosition& p, BenchVelocity&) {
+                if (p.y == static_cast<float>(q)) ++viewCount;
+            });
+        }
+    }
+    bench::report("EcsScanHeavyFrame", "view<Position, Velocity>", sw.elapsedMs() / kFrames, "ms/frame");
+
+    if (viewCount != filteredCount)
+    {
+        char message[96];
+        std::snprintf(message, sizeof(message), "view matched %lld, filter matched %lld", viewCount, filteredCount);
+        bench::fail(message);
+    }
+
+    // Incremental maintenance cost: toggling a component keeps the cached set in sync
+    sw.reset();
+    auto tagged = em.getEntitiesWithComponent<BenchTag>();
+    for (auto* e : tagged) e->removeComponent<BenchVelocity>();
+    for (auto* e : tagged) e->addComponent<BenchVelocity>();
+    bench::report("EcsScanHeavyFrame", "toggle component (cached view)", sw.elapsedMs(), "ms");
+}
+
+// FLIP "Reset Particles" pattern: spawn a named batch, then remove every one of them
+DX3D_BENCHMARK(EcsSpawnDespawn)
+{
+    constexpr int kEntities = 20000;
+
+    // Legacy removal: linear find + vector::erase per name, O(n^2) for a bulk delete
+    {
+        std::vector<std::unique_ptr<std::string>> entities;
+        std::unordered_map<std::string, std::string*> byName;
+        for (int i = 0; i < kEntities; ++i)
+        {
+            entities.push_back(std::make_unique<std::string>("Particle_" + std::to_string(i)));
+            byName[*entities.back()] = entities.back().get();
+        }
+        bench::Stopwatch sw;
+        for (int i = 0; i < kEntities; ++i)
+        {
+            auto it = byName.find("Particle_" + std::to_string(i));
+            std::string* raw = it->second;
+            byName.erase(it);
+            for (auto e = entities.begin(); e != entities.end(); ++e)
+            {
+                if (e->get() == raw) { entities.erase(e); break; }
+            }
+        }
+        bench::report("EcsSpawnDespawn", "legacy erase-by-name", sw.elapsedMs(), "ms");
+    }
+
+    EntityManager em;
+    std::vector<EntityHandle> handles;
+    handles.reserve(kEntities);
+
+    bench::Stopwatch sw;
+    for (int i = 0; i < kEntities; ++i)
+    {
+        auto& e = em.createEntity("Particle_" + std::to_string(i));
+        e.addComponent<BenchPosition>();
+        handles.push_back(e.getHandle());
+    }
+    bench::report("EcsSpawnDespawn", "spawn", sw.elapsedMs(), "ms");
+
+    sw.reset();
+    for (int i = 0; i < kEntities; ++i) em.removeEntity("Particle_" + std::to_string(i));
+    bench::report("EcsSpawnDespawn", "removeEntity(name)", sw.elapsedMs(), "ms");
+
+    // Respawn into recycled slots, then destroy through the deferred queue
+    for (int i = 0; i < kEntities; ++i) em.createEntity("Particle_" + std::to_string(i)).addComponent<BenchPosition>();
+    sw.reset();
+    for (const auto& e : em.getEntities()) em.queueDestroy(e.get());
+    em.flushDestroyQueue();
+    bench::report("EcsSpawnDespawn", "queueDestroy + flush", sw.elapsedMs(), "ms");
+
+    int stale = 0;
+    for (EntityHandle h : handles) if (em.getEntity(h)) ++stale;
+    if (stale != 0 || !em.getEntities().empty() || em.getComponentCount<BenchPosition>() != 0)
+    {
+        char message[96];
+        std::snprintf(message, sizeof(message), "%d stale handles resolved, %zu entities left", stale, em.getEntities().size());
+        bench::fail(message);
+    }
+}
+
+// SPHFluidSimulationScene::updateParticleSprites pattern: resolve every particle's sprite once per frame
+DX3D_BENCHMARK(EcsNameLookup)
+{
+    constexpr int kParticles = 10000;
+    constexpr int kFrames = 60;
+
+    EntityManager em;
+    std::vector<std::string> names;
+    std::vector<NameId> nameIds;
+    std::vector<EntityHandle> handles;
+    for (int i = 0; i < kParticles; ++i)
+    {
+        names.push_back("SPHParticle_" + std::to_string(i));
+        auto& e = em.createEntity(names.back());
+        e.addComponent<BenchPosition>();
+        nameIds.push_back(e.getNameId());
+        handles.push_back(e.getHandle());
+    }
+
+    float sum = 0.0f;
+    auto run = [&](const char* metric, auto&& resolve)
+    {
+        AllocationScope allocs;
+        bench::Stopwatch sw;
+        for (int frame = 0; frame < kFrames; ++frame)
+        {
+            for (int i = 0; i < kParticles; ++i)
+            {
+                if (Entity* e = resolve(i)) sum += e->getComponent<BenchPosition>()->x;
+            }
+        }
+        bench::report("EcsNameLookup", metric, sw.elapsedMs() / kFrames, "ms/frame");
+        bench::report("EcsNameLookup", metric, static_cast<double>(allocs.allocations()) / kFrames, "allocs/frame");
+    };
+
+    run("findEntity(built string)", [&](int i) { return em.findEntity("SPHParticle_" + std::to_string(i)); });
+    run("findEntity(stored string)", [&](int i) { return em.findEntity(names[i]); });
+    run("findEntity(NameId)", [&](int i) { return em.findEntity(nameIds[i]); });
+    run("getEntity(EntityHandle)", [&](int i) { return em.getEntity(handles[i]); });
+    bench::doNotOptimize(sum);
+}
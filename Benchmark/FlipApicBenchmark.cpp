@@ -0,0 +1,197 @@
+#include "Benchmark.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleTransfer.h>
+#include <DX3D/Game/Scenes/FlipPressureSolver.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kGridWidth = 64;  // default for --size (height is 3/4 of it)
+    constexpr int kSteps = 240;     // default for --steps (2 s at 120 Hz)
+    constexpr float kCellSize = 10.0f;
+    constexpr float kDt = 1.0f / 120.0f;
+    constexpr float kGravity = -980.0f;
+    constexpr float kFlipBlending = 0.8f; // the scene's default
+
+    struct Float2 { float x, y; };
+    struct Particle
+    {
+        Float2 position;
+        Float2 velocity;
+        Float2 affineU;
+        Float2 affineV;
+    };
+
+    // The scene's FLIP step without collisions or rendering: P2G, gravity,
+    // projection with PCG, G2P, advection and wall clamping
+    class DamBreak
+    {
+    public:
+        DamBreak(int width, int perCellAxis, FlipVelocityMode mode) : m_width(width), m_height(width * 3 / 4), m_mode(mode)
+        {
+            m_u.assign((m_width + 1) * m_height, 0.0f);
+            m_uWeight.assign(m_u.size(), 0.0f);
+            m_v.assign(m_width * (m_height + 1), 0.0f);
+            m_vWeight.assign(m_v.size(), 0.0f);
+            m_pressure.assign(m_width * m_height, 0.0f);
+            m_divergence.assign(m_pressure.size(), 0.0f);
+            m_cells.assign(m_pressure.size(), FlipCellType::Air);
+
+            // Column in the left 40% of the tank, 60% tall, perCellAxis^2 particles per cell
+            const float spacing = kCellSize / perCellAxis;
+            for (int j = perCellAxis; j < perCellAxis * (m_height * 6 / 10); ++j)
+                for (int i = perCellAxis; i < perCellAxis * (m_width * 4 / 10); ++i)
+                    m_particles.push_back({ { (i + 0.5f) * spacing, (j + 0.5f) * spacing }, { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f } });
+
+            m_settings.type = FlipPressureSolverType::ConjugateGradient;
+            m_settings.tolerance = 1e-3f;
+            m_settings.maxThreads = static_cast<int>(JobSystem::getInstance().getThreadCount());
+        }
+
+        int getParticleCount() const { return static_cast<int>(m_particles.size()); }
+
+        // Kinetic plus potential energy per particle, floor at y = 0
+        double energy() const
+        {
+            double total = 0.0;
+            for (const Particle& p : m_particles)
+                total += 0.5 * (p.velocity.x * p.velocity.x + p.velocity.y * p.velocity.y) - kGravity * p.position.y;
+            return total / m_particles.size();
+        }
+
+        void step()
+        {
+            const FlipFaceGrid faces = getFaces();
+            const int threads = m_settings.maxThreads;
+            m_transfer.particlesToGrid(m_particles, faces, FlipTransferMode::PrivateGrids, threads, m_mode == FlipVelocityMode::Apic);
+            for (std::size_t k = 0; k < m_u.size(); ++k) if (m_uWeight[k] > 0.0f) m_u[k] /= m_uWeight[k];
+            for (std::size_t k = 0; k < m_v.size(); ++k)
+            {
+                if (m_vWeight[k] > 0.0f) m_v[k] /= m_vWeight[k];
+                m_v[k] += kGravity * kDt;
+            }
+
+            project();
+            m_transfer.gridToParticles(m_particles, faces, m_mode, kFlipBlending, threads);
+
+            const float lo = kCellSize + 1.0f;
+            const float hiX = (m_width - 1) * kCellSize - 1.0f;
+            const float hiY = (m_height - 1) * kCellSize - 1.0f;
+            for (Particle& p : m_particles)
+            {
+                p.position.x += p.velocity.x * kDt;
+                p.position.y += p.velocity.y * kDt;
+                if (p.position.x < lo) { p.position.x = lo; p.velocity.x = std::max(0.0f, p.velocity.x); }
+                if (p.position.x > hiX) { p.position.x = hiX; p.velocity.x = std::min(0.0f, p.velocity.x); }
+                if (p.position.y < lo) { p.position.y = lo; p.velocity.y = std::max(0.0f, p.velocity.y); }
+                if (p.position.y > hiY) { p.position.y = hiY; p.velocity.y = std::min(0.0f, p.velocity.y); }
+            }
+        }
+
+    private:
+        FlipFaceGrid getFaces()
+        {
+            FlipFaceGrid faces;
+            faces.cellSize = kCellSize;
+            faces.width = m_width;
+            faces.height = m_height;
+            faces.u = m_u.data();
+            faces.uWeight = m_uWeight.data();
+            faces.v = m_v.data();
+            faces.vWeight = m_vWeight.data();
+            return faces;
+        }
+
+        bool isWall(int i, int j) const { return i <= 0 || j <= 0 || i >= m_width - 1 || j >= m_height - 1; }
+
+        void project()
+        {
+            std::fill(m_cells.begin(), m_cells.end(), FlipCellType::Air);
+            for (const Particle& p : m_particles)
+            {
+                const int i = static_cast<int>(p.position.x / kCellSize);
+                const int j = static_cast<int>(p.position.y / kCellSize);
+                if (i >= 0 && i < m_width && j >= 0 && j < m_height) m_cells[j * m_width + i] = FlipCellType::Fluid;
+            }
+            for (int j = 0; j < m_height; ++j)
+                for (int i = 0; i < m_width; ++i)
+                    if (isWall(i, j)) m_cells[j * m_width + i] = FlipCellType::Solid;
+
+            for (int j = 0; j < m_height; ++j)
+                for (int i = 0; i <= m_width; ++i)
+                    if (isWall(i - 1, j) || isWall(i, j)) m_u[j * (m_width + 1) + i] = 0.0f;
+            for (int j = 0; j <= m_height; ++j)
+                for (int i = 0; i < m_width; ++i)
+                    if (isWall(i, j - 1) || isWall(i, j)) m_v[j * m_width + i] = 0.0f;
+
+            for (int j = 0; j < m_height; ++j)
+            {
+                for (int i = 0; i < m_width; ++i)
+                {
+                    const int id = j * m_width + i;
+                    m_divergence[id] = m_cells[id] != FlipCellType::Fluid ? 0.0f :
+                        (m_u[j * (m_width + 1) + i + 1] - m_u[j * (m_width + 1) + i] + m_v[(j + 1) * m_width + i] - m_v[j * m_width + i]) / kCellSize;
+                }
+            }
+            m_solver.solve(m_width, m_height, m_cells.data(), m_divergence.data(), kCellSize, m_pressure.data(), m_settings);
+
+            auto open = [&](int a, int b)
+            {
+                return m_cells[a] != FlipCellType::Solid && m_cells[b] != FlipCellType::Solid &&
+                    (m_cells[a] == FlipCellType::Fluid || m_cells[b] == FlipCellType::Fluid);
+            };
+            for (int j = 0; j < m_height; ++j)
+                for (int i = 1; i < m_width; ++i)
+                    if (open(j * m_width + i - 1, j * m_width + i))
+                        m_u[j * (m_width + 1) + i] -= (m_pressure[j * m_width + i] - m_pressure[j * m_width + i - 1]) / kCellSize;
+            for (int j = 1; j < m_height; ++j)
+                for (int i = 0; i < m_width; ++i)
+                    if (open((j - 1) * m_width + i, j * m_width + i))
+                        m_v[j * m_width + i] -= (m_pressure[j * m_width + i] - m_pressure[(j - 1) * m_width + i]) / kCellSize;
+        }
+
+        int m_width;
+        int m_height;
+        FlipVelocityMode m_mode;
+        std::vector<Particle> m_particles;
+        std::vector<float> m_u, m_uWeight, m_v, m_vWeight, m_pressure, m_divergence;
+        std::vector<FlipCellType> m_cells;
+        FlipParticleTransfer m_transfer;
+        FlipPressureSolver m_solver;
+        FlipPressureSettings m_settings;
+    };
+}
+
+DX3D_BENCHMARK(FlipApicDamBreak)
+{
+    const int width = bench::gridSize(kGridWidth);
+    const int steps = bench::steps(kSteps);
+    const FlipVelocityMode modes[] = { FlipVelocityMode::PicFlip, FlipVelocityMode::Apic };
+
+    // Energy retained after the collapse is what keeps splashes lively; compare
+    // APIC at low particle density against PIC/FLIP at low and high density
+    for (int perCellAxis : { 2, 3 })
+    {
+        for (FlipVelocityMode mode : modes)
+        {
+            DamBreak sim(width, perCellAxis, mode);
+            const double startEnergy = sim.energy();
+            bench::Stopwatch sw;
+            for (int step = 0; step < steps; ++step) sim.step();
+            const double ms = sw.elapsedMs();
+
+            char metric[64];
+            const char* name = getFlipVelocityModeName(mode);
+            std::snprintf(metric, sizeof(metric), "%s, %d ppc, step", name, perCellAxis * perCellAxis);
+            bench::report("FlipApicDamBreak", metric, ms / steps, "ms");
+            std::snprintf(metric, sizeof(metric), "%s, %d ppc, throughput", name, perCellAxis * perCellAxis);
+            bench::report("FlipApicDamBreak", metric, static_cast<double>(sim.getParticleCount()) * steps / (ms * 1000.0), "Mparticle-steps/s");
+            std::snprintf(metric, sizeof(metric), "%s, %d ppc, energy kept", name, perCellAxis * perCellAxis);
+            bench::report("FlipApicDamBreak", metric, 100.0 * sim.energy() / startEnergy, "%");
+        }
+    }
+}
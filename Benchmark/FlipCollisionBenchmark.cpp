@@ -0,0 +1,175 @@
+#include "Benchmark.h"
+#include "SimulationFixtures.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleGrid.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    constexpr int kParticleCount = 20000; // default for --particles
+    constexpr int kSteps = 20;            // default for --steps
+    constexpr float kRadius = 4.0f;
+    constexpr float kTarget = kRadius * 2.0f * 0.95f;
+    constexpr float kCellSize = kRadius * 2.0f;
+    constexpr float kRestitution = 0.1f;
+
+    // A settled FLIP pool, in random memory order like an unsorted particle array
+    std::vector<FlipParticle> makePool(int count, float& width, float& height)
+    {
+        FlipPool pool = makeFlipPool(count, kTarget, 1.0f, 50.0f, 5, true);
+        width = pool.width;
+        height = pool.height;
+        return std::move(pool.particles);
+    }
+
+    // The pre-grid path: unordered_map buckets rebuilt every iteration and a
+    // sequential (Gauss-Seidel) sweep over the 9 buckets around each particle
+    void legacyCollisions(std::vector<FlipParticle>& particles, std::unordered_map<long long, std::vector<int>>& hash)
+    {
+        auto key = [](int ix, int iy) { return (static_cast<long long>(ix) << 32) ^ static_cast<unsigned long long>(iy); };
+        const float inv = 1.0f / kCellSize;
+        hash.clear();
+        for (int i = 0; i < static_cast<int>(particles.size()); ++i)
+            hash[key(static_cast<int>(std::floor(particles[i].position.x * inv)), static_cast<int>(std::floor(particles[i].position.y * inv)))].push_back(i);
+
+        for (int i = 0; i < static_cast<int>(particles.size()); ++i)
+        {
+            const int ix = static_cast<int>(std::floor(particles[i].position.x * inv));
+            const int iy = static_cast<int>(std::floor(particles[i].position.y * inv));
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    auto bucket = hash.find(key(ix + dx, iy + dy));
+                    if (bucket == hash.end()) continue;
+                    for (int j : bucket->second)
+                    {
+                        if (j <= i) continue;
+                        FlipParticle& a = particles[i];
+                        FlipParticle& b = particles[j];
+                        const float ddx = b.position.x - a.position.x, ddy = b.position.y - a.position.y;
+                        const float dist2 = ddx * ddx + ddy * ddy;
+                        if (dist2 >= kTarget * kTarget) continue;
+                        const float dist = dist2 > 1e-10f ? std::sqrt(dist2) : 0.0f;
+                        const float nx = dist > 0.0f ? ddx / dist : 1.0f, ny = dist > 0.0f ? ddy / dist : 0.0f;
+                        const float overlap = kTarget - dist;
+                        a.position.x -= nx * overlap * 0.5f; a.position.y -= ny * overlap * 0.5f;
+                        b.position.x += nx * overlap * 0.5f; b.position.y += ny * overlap * 0.5f;
+                        const float relN = (b.velocity.x - a.velocity.x) * nx + (b.velocity.y - a.velocity.y) * ny;
+                        if (relN < 0.0f)
+                        {
+                            const float impulse = -(1.0f + kRestitution) * relN * 0.5f;
+                            a.velocity.x -= nx * impulse; a.velocity.y -= ny * impulse;
+                            b.velocity.x += nx * impulse; b.velocity.y += ny * impulse;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void sortByCell(std::vector<FlipParticle>& particles, FlipParticleGrid& grid)
+    {
+        grid.build(particles);
+        std::vector<FlipParticle> sorted(particles.size());
+        for (std::size_t k = 0; k < sorted.size(); ++k) sorted[k] = particles[grid.getSortedIndices()[k]];
+        particles.swap(sorted);
+    }
+
+    // Run steps collision passes from the same start state, timing only the resolve
+    double gridMs(const std::vector<FlipParticle>& start, FlipParticleGrid& grid, int threads, int steps, std::vector<FlipParticle>& result)
+    {
+        FlipCollisionSettings settings;
+        settings.targetDistance = kTarget;
+        settings.restitution = kRestitution;
+        settings.maxThreads = threads;
+        std::vector<float> scratch;
+
+        double ms = 0.0;
+        for (int step = 0; step < steps; ++step)
+        {
+            result = start;
+            bench::Stopwatch sw;
+            resolveFlipCollisions(result, grid, settings, scratch);
+            ms += sw.elapsedMs();
+        }
+        return ms / steps;
+    }
+}
+
+DX3D_BENCHMARK(FlipCollisionGrid)
+{
+    const int count = bench::particles(kParticleCount);
+    const int steps = bench::steps(kSteps);
+    const unsigned threads = std::max(1u, JobSystem::getInstance().getThreadCount());
+
+    float width = 0.0f, height = 0.0f;
+    const std::vector<FlipParticle> pool = makePool(count, width, height);
+    FlipParticleGrid grid;
+    grid.resize(0.0f, 0.0f, width, height, kCellSize);
+
+    // Before: unordered_map hash, sequential sweep
+    {
+        std::unordered_map<long long, std::vector<int>> hash;
+        std::vector<FlipParticle> particles;
+        double ms = 0.0;
+        for (int step = 0; step < steps; ++step)
+        {
+            particles = pool;
+            bench::Stopwatch sw;
+            legacyCollisions(particles, hash);
+            ms += sw.elapsedMs();
+        }
+        bench::report("FlipCollisionGrid", "hash map + sequential", ms / steps, "ms/step");
+    }
+
+    // Grid build alone
+    {
+        bench::Stopwatch sw;
+        for (int step = 0; step < steps; ++step) grid.build(pool);
+        bench::report("FlipCollisionGrid", "counting sort build", sw.elapsedMs() / steps, "ms/step");
+    }
+
+    // After: counting-sort grid, Jacobi resolve, unsorted then cell-sorted memory order
+    std::vector<FlipParticle> serial, parallel;
+    const double unsortedMs = gridMs(pool, grid, 1, steps, serial);
+    bench::report("FlipCollisionGrid", "grid, unsorted, 1 thread", unsortedMs, "ms/step");
+
+    std::vector<FlipParticle> sortedPool = pool;
+    sortByCell(sortedPool, grid);
+    const double sortedMs = gridMs(sortedPool, grid, 1, steps, serial);
+    bench::report("FlipCollisionGrid", "grid, sorted, 1 thread", sortedMs, "ms/step");
+
+    char metric[64];
+    const double parallelMs = gridMs(sortedPool, grid, static_cast<int>(threads), steps, parallel);
+    std::snprintf(metric, sizeof(metric), "grid, sorted, %u threads", threads);
+    bench::report("FlipCollisionGrid", metric, parallelMs, "ms/step");
+    bench::report("FlipCollisionGrid", "throughput", count / (parallelMs * 1000.0), "Mparticles/s");
+
+    // Determinism: the Jacobi update must not depend on the thread count
+    const bool identical = std::memcmp(serial.data(), parallel.data(), serial.size() * sizeof(FlipParticle)) == 0;
+    bench::check("FlipCollisionGrid", "1 vs N threads identical", identical);
+    bench::doNotOptimize(parallel[count / 2].position.x);
+
+    // Two particles on the same spot have no contact normal; they must still split along x
+    std::vector<FlipParticle> coincident(2);
+    coincident[0].position = coincident[1].position = { kCellSize * 2.0f, kCellSize * 2.0f };
+    FlipParticleGrid pairGrid;
+    pairGrid.resize(0.0f, 0.0f, kCellSize * 4.0f, kCellSize * 4.0f, kCellSize);
+    FlipCollisionSettings settings;
+    settings.targetDistance = kTarget;
+    std::vector<float> scratch;
+    resolveFlipCollisions(coincident, pairGrid, settings, scratch);
+    const float gap = coincident[1].position.x - coincident[0].position.x;
+    const bool separated = std::abs(gap - kTarget) < 1e-4f && coincident[0].position.y == coincident[1].position.y;
+    bench::check("FlipCollisionGrid", "coincident pair separated", separated);
+}
@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipPressureSolver.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kSizes[] = { 64, 128, 256, 512 }; // --size runs just that size
+    constexpr float kTolerance = 1e-4f;
+    constexpr int kMaxIterations = 2000;
+    constexpr float kCellSize = 10.0f;
+
+    // A tank like the scene's: solid ring, fluid in the lower 60% with a few air
+    // bubbles, air above, and a smooth divergence field with some noise on top
+    struct Tank
+    {
+        int size = 0;
+        std::vector<FlipCellType> cells;
+        std::vector<float> divergence;
+    };
+
+    Tank makeTank(int size)
+    {
+        Tank tank;
+        tank.size = size;
+        tank.cells.assign(static_cast<std::size_t>(size) * size, FlipCellType::Air);
+        tank.divergence.assign(tank.cells.size(), 0.0f);
+
+        std::mt19937 rng(bench::seed(3));
+        std::uniform_real_distribution<float> noise(-0.2f, 0.2f);
+        std::uniform_int_distribution<int> bubble(0, 199);
+        const int surface = size * 6 / 10;
+        for (int j = 0; j < size; ++j)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                const std::size_t id = static_cast<std::size_t>(j) * size + i;
+                if (i == 0 || j == 0 || i == size - 1 || j == size - 1)
+                {
+                    tank.cells[id] = FlipCellType::Solid;
+                    continue;
+                }
+                if (j >= surface || bubble(rng) == 0)
+                    continue;
+                tank.cells[id] = FlipCellType::Fluid;
+                const float x = static_cast<float>(i) / size, y = static_cast<float>(j) / size;
+                tank.divergence[id] = std::sin(6.0f * x) * std::cos(4.0f * y) + noise(rng);
+            }
+        }
+        return tank;
+    }
+}
+
+DX3D_BENCHMARK(FlipPressureSolve)
+{
+    const int threads = static_cast<int>(JobSystem::getInstance().getThreadCount());
+    const FlipPressureSolverType types[] = { FlipPressureSolverType::Jacobi, FlipPressureSolverType::ConjugateGradient, FlipPressureSolverType::Multigrid };
+    const int requested = bench::gridSize(0);
+
+    for (int size : kSizes)
+    {
+        if (requested > 0 && size != requested) continue;
+        const Tank tank = makeTank(size);
+
+        for (FlipPressureSolverType type : types)
+        {
+            FlipPressureSolver solver;
+            FlipPressureSettings settings;
+            settings.type = type;
+            settings.tolerance = kTolerance;
+            settings.maxIterations = kMaxIterations;
+            settings.maxThreads = threads;
+            std::vector<float> pressure(tank.cells.size(), 0.0f);
+
+            // Cold start, then a warm start on a slightly changed right-hand side like the next frame
+            bench::Stopwatch sw;
+            const FlipPressureStats cold = solver.solve(size, size, tank.cells.data(), tank.divergence.data(), kCellSize, pressure.data(), settings);
+            const double coldMs = sw.elapsedMs();
+
+            std::vector<float> nextDivergence = tank.divergence;
+            for (float& d : nextDivergence) d *= 1.02f;
+            bench::Stopwatch warmSw;
+            const FlipPressureStats warm = solver.solve(size, size, tank.cells.data(), nextDivergence.data(), kCellSize, pressure.data(), settings);
+            const double warmMs = warmSw.elapsedMs();
+
+            char metric[64];
+            const char* name = getFlipPressureSolverName(type);
+            std::snprintf(metric, sizeof(metric), "%d^2 %s", size, name);
+            bench::report("FlipPressureSolve", metric, coldMs, "ms");
+            std::snprintf(metric, sizeof(metric), "%d^2 %s iterations", size, name);
+            bench::report("FlipPressureSolve", metric, cold.iterations, "");
+            std::snprintf(metric, sizeof(metric), "%d^2 %s residual", size, name);
+            bench::report("FlipPressureSolve", metric, cold.residual, "");
+            std::snprintf(metric, sizeof(metric), "%d^2 %s warm", size, name);
+            bench::report("FlipPressureSolve", metric, warmMs, "ms");
+            std::snprintf(metric, sizeof(metric), "%d^2 %s warm iterations", size, name);
+            bench::report("FlipPressureSolve", metric, warm.iterations, "");
+            if (!cold.converged)
+                std::printf("  %s did not reach %.0e on %d^2 within %d iterations\n", name, kTolerance, size, kMaxIterations);
+        }
+    }
+}
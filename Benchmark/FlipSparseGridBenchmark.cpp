@@ -0,0 +1,296 @@
+#include "Benchmark.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleTransfer.h>
+#include <DX3D/Game/Scenes/FlipPressureSolver.h>
+#include <DX3D/Game/Scenes/FlipSparseGrid.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kGridWidth = 4096;  // default for --size (height is a quarter of it)
+    constexpr int kPoolWidth = 128;   // cells; the pool is half as tall
+    constexpr int kSteps = 20;        // default for --steps
+    constexpr float kCellSize = 1.0f;
+    constexpr float kDt = 1.0f / 120.0f;
+    constexpr float kGravity = -98.0f;
+
+    struct Float2 { float x, y; };
+    struct Particle { Float2 position, velocity; };
+
+    bool isWall(int i, int j, int width, int height) { return i <= 0 || j <= 0 || i >= width - 1 || j >= height - 1; }
+
+    // 2x2 particles per cell in a pool on the floor of a large, otherwise empty tank,
+    // or in two pools against its far walls
+    std::vector<Particle> makePool(int width, bool split)
+    {
+        std::vector<Particle> particles;
+        for (int pool = 0; pool < (split ? 2 : 1); ++pool)
+        {
+            const float offsetX = pool == 0 ? 0.0f : (width - kPoolWidth - 2) * kCellSize;
+            for (int j = 2; j < kPoolWidth + 2; ++j)
+                for (int i = 2; i < kPoolWidth * 2 + 2; ++i)
+                    particles.push_back({ { offsetX + (i + 0.5f) * 0.5f * kCellSize, (j + 0.5f) * 0.5f * kCellSize }, { 0.0f, 0.0f } });
+        }
+        return particles;
+    }
+
+    void advect(std::vector<Particle>& particles, int width, int height)
+    {
+        const float lo = kCellSize * 1.01f;
+        const float hiX = (width - 1) * kCellSize * 0.999f;
+        const float hiY = (height - 1) * kCellSize * 0.999f;
+        for (Particle& p : particles)
+        {
+            p.position.x = std::clamp(p.position.x + p.velocity.x * kDt, lo, hiX);
+            p.position.y = std::clamp(p.position.y + p.velocity.y * kDt, lo, hiY);
+        }
+    }
+
+    FlipPressureSettings pressureSettings()
+    {
+        FlipPressureSettings settings;
+        settings.tolerance = 1e-3f;
+        settings.maxThreads = static_cast<int>(JobSystem::getInstance().getThreadCount());
+        return settings;
+    }
+
+    // The scene's FLIP step before tiling: every pass covers the whole domain
+    class DenseTank
+    {
+    public:
+        DenseTank(int width, int height) : m_width(width), m_height(height)
+        {
+            const std::size_t cells = static_cast<std::size_t>(width) * height;
+            for (auto* faces : { &m_u, &m_uWeight }) faces->assign(cells + height, 0.0f);
+            for (auto* faces : { &m_v, &m_vWeight }) faces->assign(cells + width, 0.0f);
+            m_pressure.assign(cells, 0.0f);
+            m_divergence.assign(cells, 0.0f);
+            m_cells.assign(cells, FlipCellType::Air);
+        }
+
+        void step(std::vector<Particle>& particles, bench::PhaseTimes& phases)
+        {
+            const int threads = m_settings.maxThreads;
+            const int w = m_width;
+            bench::Stopwatch sw;
+            for (auto* field : { &m_u, &m_uWeight, &m_v, &m_vWeight, &m_divergence }) std::fill(field->begin(), field->end(), 0.0f);
+            std::fill(m_cells.begin(), m_cells.end(), FlipCellType::Air);
+            phases.add("clear", sw.elapsedMs());
+
+            sw.reset();
+            m_transfer.particlesToGrid(particles, faces(), FlipTransferMode::PrivateGrids, threads);
+            for (std::size_t k = 0; k < m_u.size(); ++k) if (m_uWeight[k] > 0.0f) m_u[k] /= m_uWeight[k];
+            for (std::size_t k = 0; k < m_v.size(); ++k)
+            {
+                if (m_vWeight[k] > 0.0f) m_v[k] /= m_vWeight[k];
+                m_v[k] += kGravity * kDt;
+            }
+            phases.add("p2g", sw.elapsedMs());
+
+            sw.reset();
+            for (const Particle& p : particles)
+                m_cells[static_cast<int>(p.position.y / kCellSize) * w + static_cast<int>(p.position.x / kCellSize)] = FlipCellType::Fluid;
+            for (int j = 0; j < m_height; ++j)
+            {
+                for (int i = 0; i <= w; ++i)
+                {
+                    if (i < w && isWall(i, j, w, m_height)) m_cells[j * w + i] = FlipCellType::Solid;
+                    if (i == 0 || i == w || isWall(i - 1, j, w, m_height) || isWall(i, j, w, m_height)) m_u[j * (w + 1) + i] = 0.0f;
+                }
+            }
+            for (int j = 0; j <= m_height; ++j)
+                for (int i = 0; i < w; ++i)
+                    if (j == 0 || j == m_height || isWall(i, j - 1, w, m_height) || isWall(i, j, w, m_height)) m_v[j * w + i] = 0.0f;
+            for (int j = 0; j < m_height; ++j)
+            {
+                for (int i = 0; i < w; ++i)
+                {
+                    const int id = j * w + i;
+                    if (m_cells[id] != FlipCellType::Fluid) continue;
+                    m_divergence[id] = (m_u[j * (w + 1) + i + 1] - m_u[j * (w + 1) + i] + m_v[(j + 1) * w + i] - m_v[id]) / kCellSize;
+                }
+            }
+            phases.add("build", sw.elapsedMs());
+
+            sw.reset();
+            m_solver.solve(w, m_height, m_cells.data(), m_divergence.data(), kCellSize, m_pressure.data(), m_settings);
+            phases.add("pressure", sw.elapsedMs());
+
+            sw.reset();
+            auto open = [&](int a, int b)
+            {
+                return m_cells[a] != FlipCellType::Solid && m_cells[b] != FlipCellType::Solid &&
+                    (m_cells[a] == FlipCellType::Fluid || m_cells[b] == FlipCellType::Fluid);
+            };
+            for (int j = 0; j < m_height; ++j)
+            {
+                for (int i = 0; i < w; ++i)
+                {
+                    const int id = j * w + i;
+                    if (i > 0 && open(id - 1, id)) m_u[j * (w + 1) + i] -= (m_pressure[id] - m_pressure[id - 1]) / kCellSize;
+                    if (j > 0 && open(id - w, id)) m_v[id] -= (m_pressure[id] - m_pressure[id - w]) / kCellSize;
+                }
+            }
+            m_transfer.gridToParticles(particles, faces(), FlipVelocityMode::PicFlip, 0.8f, threads);
+            phases.add("g2p", sw.elapsedMs());
+        }
+
+    private:
+        FlipFaceGrid faces()
+        {
+            FlipFaceGrid faces;
+            faces.cellSize = kCellSize;
+            faces.width = m_width;
+            faces.height = m_height;
+            faces.u = m_u.data();
+            faces.uWeight = m_uWeight.data();
+            faces.v = m_v.data();
+            faces.vWeight = m_vWeight.data();
+            return faces;
+        }
+
+        int m_width;
+        int m_height;
+        std::vector<float> m_u, m_uWeight, m_v, m_vWeight, m_pressure, m_divergence;
+        std::vector<FlipCellType> m_cells;
+        FlipParticleTransfer m_transfer;
+        FlipPressureSolver m_solver;
+        FlipPressureSettings m_settings = pressureSettings();
+    };
+
+    // The same step on FlipSparseGrid, as the scene runs it
+    class SparseTank
+    {
+    public:
+        SparseTank(int width, int height) : m_width(width), m_height(height)
+        {
+            m_grid.resize(0.0f, 0.0f, kCellSize, width, height);
+        }
+
+        int getTileCount() const { return m_grid.getTileCount(); }
+
+        void step(std::vector<Particle>& particles, bench::PhaseTimes& phases)
+        {
+            const int threads = m_settings.maxThreads;
+            constexpr int T = FlipSparseGrid::TileSize;
+            bench::Stopwatch sw;
+            m_grid.build(particles, 1, threads);
+            phases.add("clear", sw.elapsedMs());
+
+            sw.reset();
+            m_transfer.particlesToGrid(particles, m_grid.getFaceGrid(), FlipTransferMode::PrivateGrids, threads);
+            float* u = m_grid.getU();
+            float* uWeight = m_grid.getUWeight();
+            float* v = m_grid.getV();
+            float* vWeight = m_grid.getVWeight();
+            const int size = m_grid.getTileCount() * FlipSparseGrid::TileCells;
+            for (int k = 0; k < size; ++k)
+            {
+                if (uWeight[k] > 0.0f) u[k] /= uWeight[k];
+                if (vWeight[k] > 0.0f) v[k] /= vWeight[k];
+                v[k] += kGravity * kDt;
+            }
+            phases.add("p2g", sw.elapsedMs());
+
+            sw.reset();
+            FlipCellType* cells = m_grid.getCellTypes();
+            const int* counts = m_grid.getParticleCounts();
+            float* divergence = m_grid.getDivergence();
+            const float* pressure = m_grid.getPressure();
+            for (int k = 0; k < size; ++k)
+            {
+                const int i = m_grid.getTileX(k / FlipSparseGrid::TileCells) * T + k % T;
+                const int j = m_grid.getTileY(k / FlipSparseGrid::TileCells) * T + (k % FlipSparseGrid::TileCells) / T;
+                cells[k] = (i >= m_width || j >= m_height || isWall(i, j, m_width, m_height)) ? FlipCellType::Solid : (counts[k] > 0 ? FlipCellType::Fluid : FlipCellType::Air);
+                if (j < m_height && i <= m_width && (i == 0 || i == m_width || isWall(i - 1, j, m_width, m_height) || isWall(i, j, m_width, m_height))) u[k] = 0.0f;
+                if (i < m_width && j <= m_height && (j == 0 || j == m_height || isWall(i, j - 1, m_width, m_height) || isWall(i, j, m_width, m_height))) v[k] = 0.0f;
+            }
+            for (int k = 0; k < size; ++k)
+            {
+                if (cells[k] != FlipCellType::Fluid) continue;
+                const int i = m_grid.getTileX(k / FlipSparseGrid::TileCells) * T + k % T;
+                const int j = m_grid.getTileY(k / FlipSparseGrid::TileCells) * T + (k % FlipSparseGrid::TileCells) / T;
+                divergence[k] = (u[m_grid.index(i + 1, j)] - u[k] + v[m_grid.index(i, j + 1)] - v[k]) / kCellSize;
+            }
+            phases.add("build", sw.elapsedMs());
+
+            sw.reset();
+            m_grid.solvePressure(m_solver, m_settings);
+            phases.add("pressure", sw.elapsedMs());
+
+            sw.reset();
+            auto open = [&](int a, int b)
+            {
+                return a >= 0 && cells[a] != FlipCellType::Solid && cells[b] != FlipCellType::Solid &&
+                    (cells[a] == FlipCellType::Fluid || cells[b] == FlipCellType::Fluid);
+            };
+            for (int k = 0; k < size; ++k)
+            {
+                const int i = m_grid.getTileX(k / FlipSparseGrid::TileCells) * T + k % T;
+                const int j = m_grid.getTileY(k / FlipSparseGrid::TileCells) * T + (k % FlipSparseGrid::TileCells) / T;
+                if (i >= m_width || j >= m_height) continue;
+                const int left = m_grid.index(i - 1, j);
+                const int below = m_grid.index(i, j - 1);
+                if (i > 0 && open(left, k)) u[k] -= (pressure[k] - pressure[left]) / kCellSize;
+                if (j > 0 && open(below, k)) v[k] -= (pressure[k] - pressure[below]) / kCellSize;
+            }
+            m_transfer.gridToParticles(particles, m_grid.getFaceGrid(), FlipVelocityMode::PicFlip, 0.8f, threads);
+            phases.add("g2p", sw.elapsedMs());
+        }
+
+    private:
+        int m_width;
+        int m_height;
+        FlipSparseGrid m_grid;
+        FlipParticleTransfer m_transfer;
+        FlipPressureSolver m_solver;
+        FlipPressureSettings m_settings = pressureSettings();
+    };
+
+    template<typename Tank>
+    void runTank(const char* name, bool split = false)
+    {
+        const int width = bench::gridSize(kGridWidth);
+        const int height = width / 4;
+        const int steps = bench::steps(kSteps);
+        std::vector<Particle> particles = makePool(width, split);
+        Tank tank(width, height);
+        bench::PhaseTimes phases;
+
+        bench::Stopwatch sw;
+        for (int step = 0; step < steps; ++step)
+        {
+            tank.step(particles, phases);
+            advect(particles, width, height);
+        }
+        bench::report(name, "step", sw.elapsedMs() / steps, "ms");
+        phases.report(name, "", steps);
+        if constexpr (requires { tank.getTileCount(); })
+            bench::report(name, "tiles", tank.getTileCount(), "");
+
+        float meanY = 0.0f;
+        for (const Particle& p : particles) meanY += p.position.y;
+        bench::report(name, "mean particle height", meanY / particles.size(), "cells");
+    }
+}
+
+// 4096x1024 cells with a 128x64 pool; peak heap shows the memory side
+DX3D_BENCHMARK(FlipGridDense)
+{
+    runTank<DenseTank>("FlipGridDense");
+}
+
+DX3D_BENCHMARK(FlipGridSparse)
+{
+    runTank<SparseTank>("FlipGridSparse");
+}
+
+// Two pools a tank width apart: the pressure solve covers each one's own window
+DX3D_BENCHMARK(FlipGridSparseSplit)
+{
+    runTank<SparseTank>("FlipGridSparseSplit", true);
+}
@@ -0,0 +1,125 @@
+#include "Benchmark.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleTransfer.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kParticleCount = 100000; // default for --particles
+    constexpr int kGridSize = 128;         // default for --size (cells per side)
+    constexpr int kSteps = 20;             // default for --steps
+    constexpr float kCellSize = 10.0f;
+
+    struct Float2 { float x, y; };
+    struct Particle
+    {
+        Float2 position;
+        Float2 velocity;
+    };
+
+    // Face arrays for one transfer
+    struct Faces
+    {
+        std::vector<float> u, uWeight, v, vWeight;
+
+        FlipFaceGrid bind(int size)
+        {
+            u.assign(static_cast<std::size_t>(size + 1) * size, 0.0f);
+            uWeight.assign(u.size(), 0.0f);
+            v.assign(static_cast<std::size_t>(size) * (size + 1), 0.0f);
+            vWeight.assign(v.size(), 0.0f);
+
+            FlipFaceGrid grid;
+            grid.originX = -0.5f * size * kCellSize;
+            grid.originY = -0.5f * size * kCellSize;
+            grid.cellSize = kCellSize;
+            grid.width = size;
+            grid.height = size;
+            grid.u = u.data();
+            grid.uWeight = uWeight.data();
+            grid.v = v.data();
+            grid.vWeight = vWeight.data();
+            return grid;
+        }
+
+        bool operator==(const Faces& other) const
+        {
+            auto same = [](const std::vector<float>& a, const std::vector<float>& b)
+            {
+                return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+            };
+            return same(u, other.u) && same(uWeight, other.uWeight) && same(v, other.v) && same(vWeight, other.vWeight);
+        }
+    };
+
+    // The lower half of the domain filled like a settled tank, with a few particles
+    // past the walls, in random memory order
+    std::vector<Particle> makeParticles(int count, int size)
+    {
+        std::mt19937 rng(bench::seed(11));
+        const float half = 0.5f * size * kCellSize;
+        std::uniform_real_distribution<float> x(-half - kCellSize, half + kCellSize);
+        std::uniform_real_distribution<float> y(-half - kCellSize, 0.0f);
+        std::uniform_real_distribution<float> speed(-200.0f, 200.0f);
+        std::vector<Particle> particles(count);
+        for (auto& p : particles)
+        {
+            p.position = { x(rng), y(rng) };
+            p.velocity = { speed(rng), speed(rng) };
+        }
+        return particles;
+    }
+
+    double transferMs(FlipParticleTransfer& transfer, const std::vector<Particle>& particles, int size,
+        FlipTransferMode mode, int threads, int steps, Faces& faces)
+    {
+        const FlipFaceGrid grid = faces.bind(size);
+        bench::Stopwatch sw;
+        for (int step = 0; step < steps; ++step)
+            transfer.particlesToGrid(particles, grid, mode, threads);
+        return sw.elapsedMs() / steps;
+    }
+}
+
+DX3D_BENCHMARK(FlipTransfer)
+{
+    const int count = bench::particles(kParticleCount);
+    const int size = bench::gridSize(kGridSize);
+    const int steps = bench::steps(kSteps);
+    const int threads = static_cast<int>(std::max(1u, JobSystem::getInstance().getThreadCount()));
+    const std::vector<Particle> particles = makeParticles(count, size);
+
+    FlipParticleTransfer transfer;
+    Faces serial, privateOne, privateAll, gatherOne, gatherAll;
+    char metric[64];
+
+    const double serialMs = transferMs(transfer, particles, size, FlipTransferMode::Serial, 1, steps, serial);
+    bench::report("FlipTransfer", "serial", serialMs, "ms/step");
+
+    const double privateOneMs = transferMs(transfer, particles, size, FlipTransferMode::PrivateGrids, 1, steps, privateOne);
+    bench::report("FlipTransfer", "private grids, 1 thread", privateOneMs, "ms/step");
+    const double privateAllMs = transferMs(transfer, particles, size, FlipTransferMode::PrivateGrids, threads, steps, privateAll);
+    std::snprintf(metric, sizeof(metric), "private grids, %d threads", threads);
+    bench::report("FlipTransfer", metric, privateAllMs, "ms/step");
+
+    const double gatherOneMs = transferMs(transfer, particles, size, FlipTransferMode::Gather, 1, steps, gatherOne);
+    bench::report("FlipTransfer", "gather, 1 thread", gatherOneMs, "ms/step");
+    const double gatherAllMs = transferMs(transfer, particles, size, FlipTransferMode::Gather, threads, steps, gatherAll);
+    std::snprintf(metric, sizeof(metric), "gather, %d threads", threads);
+    bench::report("FlipTransfer", metric, gatherAllMs, "ms/step");
+
+    bench::report("FlipTransfer", "throughput", count / (std::min(privateAllMs, gatherAllMs) * 1000.0), "Mparticles/s");
+
+    // Gather and single-slice private grids add in particle order, like the serial loop
+    const bool gatherExact = gatherOne == serial && gatherAll == serial;
+    const bool privateExact = privateOne == serial;
+    bench::check("FlipTransfer", "gather matches serial", gatherExact);
+    bench::check("FlipTransfer", "private x1 matches serial", privateExact);
+    bench::doNotOptimize(privateAll.u[size / 2]);
+}
@@ -0,0 +1,206 @@
+#include "Benchmark.h"
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kGridSize = 256;
+    constexpr int kJacobiIterations = 200;
+    constexpr int kParticleCount = 20000; // default for --particles
+    constexpr int kNeighborFrames = 20;   // default for --steps
+
+    unsigned maxThreads()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The pre-job-system helper: spawn and join fresh threads on every call
+    template<typename F>
+    void spawnParallelFor(int start, int end, int threads, F&& fn)
+    {
+        const int total = end - start;
+        if (threads <= 1 || total < 1024)
+        {
+            fn(start, end);
+            return;
+        }
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        const int chunk = (total + threads - 1) / threads;
+        for (int t = 0; t < threads; ++t)
+        {
+            const int b = start + t * chunk;
+            const int e = std::min(end, b + chunk);
+            if (b >= e) break;
+            pool.emplace_back([&fn, b, e]() { fn(b, e); });
+        }
+        for (auto& th : pool) th.join();
+    }
+
+    // One FLIP-style Jacobi sweep over the interior of an n x n grid
+    void jacobiRows(const std::vector<float>& in, std::vector<float>& out, const std::vector<float>& rhs, int n, int rowBegin, int rowEnd)
+    {
+        for (int y = std::max(1, rowBegin); y < std::min(n - 1, rowEnd); ++y)
+        {
+            for (int x = 1; x < n - 1; ++x)
+            {
+                const int i = y * n + x;
+                out[i] = 0.25f * (in[i - 1] + in[i + 1] + in[i - n] + in[i + n] - rhs[i]);
+            }
+        }
+    }
+
+    struct NeighborScene
+    {
+        std::vector<float> x, y, density;
+        std::vector<std::vector<int>> neighbors;
+    };
+
+    // Random particles with neighbor lists built on a uniform grid
+    NeighborScene makeNeighborScene(int count)
+    {
+        NeighborScene scene;
+        const float extent = 400.0f;
+        const float radius = 6.0f;
+        std::mt19937 rng(bench::seed(42));
+        std::uniform_real_distribution<float> pos(0.0f, extent);
+        scene.x.resize(count);
+        scene.y.resize(count);
+        scene.density.resize(count);
+        for (int i = 0; i < count; ++i) { scene.x[i] = pos(rng); scene.y[i] = pos(rng); }
+
+        const int cells = static_cast<int>(extent / radius) + 1;
+        std::vector<std::vector<int>> grid(cells * cells);
+        for (int i = 0; i < count; ++i)
+            grid[static_cast<int>(scene.y[i] / radius) * cells + static_cast<int>(scene.x[i] / radius)].push_back(i);
+
+        scene.neighbors.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            const int cx = static_cast<int>(scene.x[i] / radius);
+            const int cy = static_cast<int>(scene.y[i] / radius);
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const int gx = cx + dx, gy = cy + dy;
+                    if (gx < 0 || gy < 0 || gx >= cells || gy >= cells) continue;
+                    for (int j : grid[gy * cells + gx])
+                        if (j != i) scene.neighbors[i].push_back(j);
+                }
+        }
+        return scene;
+    }
+
+    void densityRange(NeighborScene& scene, int begin, int end)
+    {
+        const float h = 6.0f, h2 = h * h;
+        for (int i = begin; i < end; ++i)
+        {
+            float density = 0.0f;
+            for (int j : scene.neighbors[i])
+            {
+                const float dx = scene.x[i] - scene.x[j];
+                const float dy = scene.y[i] - scene.y[j];
+                const float r2 = dx * dx + dy * dy;
+                if (r2 < h2)
+                {
+                    const float d = h2 - r2;
+                    density += d * d * d;
+                }
+            }
+            scene.density[i] = density;
+        }
+    }
+}
+
+DX3D_BENCHMARK(JobSystemJacobiScaling)
+{
+    const int n = kGridSize;
+    std::vector<float> a(n * n, 0.0f), b(n * n, 0.0f), rhs(n * n, 0.0f);
+    for (int i = 0; i < n * n; ++i) rhs[i] = static_cast<float>((i * 7919) % 13) - 6.0f;
+
+    char metric[64];
+    for (unsigned threads = 1; threads <= maxThreads(); threads *= 2)
+    {
+        // Before: threads spawned per sweep
+        {
+            std::fill(a.begin(), a.end(), 0.0f);
+            bench::Stopwatch sw;
+            for (int it = 0; it < kJacobiIterations; ++it)
+            {
+                spawnParallelFor(0, n, static_cast<int>(threads), [&](int r0, int r1) { jacobiRows(a, b, rhs, n, r0, r1); });
+                a.swap(b);
+            }
+            std::snprintf(metric, sizeof(metric), "spawn threads=%u", threads);
+            bench::report("JobSystemJacobiScaling", metric, sw.elapsedMs(), "ms");
+            bench::doNotOptimize(a[n * n / 2]);
+        }
+
+        // After: persistent workers
+        {
+            JobSystem jobs(threads - 1);
+            std::fill(a.begin(), a.end(), 0.0f);
+            bench::Stopwatch sw;
+            for (int it = 0; it < kJacobiIterations; ++it)
+            {
+                jobs.parallelFor(0, n, 8, [&](int r0, int r1) { jacobiRows(a, b, rhs, n, r0, r1); });
+                a.swap(b);
+            }
+            std::snprintf(metric, sizeof(metric), "job system threads=%u", threads);
+            bench::report("JobSystemJacobiScaling", metric, sw.elapsedMs(), "ms");
+            bench::doNotOptimize(a[n * n / 2]);
+        }
+    }
+}
+
+DX3D_BENCHMARK(JobSystemNeighborScaling)
+{
+    const int count = bench::particles(kParticleCount);
+    const int frames = bench::steps(kNeighborFrames);
+    NeighborScene scene = makeNeighborScene(count);
+
+    char metric[64];
+    for (unsigned threads = 1; threads <= maxThreads(); threads *= 2)
+    {
+        JobSystem jobs(threads - 1);
+        bench::Stopwatch sw;
+        for (int frame = 0; frame < frames; ++frame)
+            jobs.parallelFor(0, count, 64, [&](int begin, int end) { densityRange(scene, begin, end); });
+        const double ms = sw.elapsedMs() / frames;
+        std::snprintf(metric, sizeof(metric), "density threads=%u", threads);
+        bench::report("JobSystemNeighborScaling", metric, ms, "ms/frame");
+        std::snprintf(metric, sizeof(metric), "throughput threads=%u", threads);
+        bench::report("JobSystemNeighborScaling", metric, count / (ms * 1000.0), "Mparticles/s");
+        bench::doNotOptimize(scene.density[count / 2]);
+    }
+}
+
+DX3D_BENCHMARK(JobSystemTaskGraph)
+{
+    constexpr int kTasks = 64;
+    constexpr int kRuns = 2000;
+    JobSystem jobs(std::max(1u, maxThreads()) - 1);
+
+    // Layered chain: each layer of 8 tasks waits on the previous layer
+    std::atomic<int> counter{ 0 };
+    TaskGraph graph;
+    std::vector<TaskGraph::TaskId> ids;
+    for (int i = 0; i < kTasks; ++i)
+    {
+        ids.push_back(graph.add([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); }));
+        if (i >= 8) graph.precede(ids[i - 8], ids[i]);
+    }
+
+    bench::Stopwatch sw;
+    for (int run = 0; run < kRuns; ++run) graph.run(jobs);
+    bench::report("JobSystemTaskGraph", "64-task graph run", sw.elapsedMs() * 1000.0 / kRuns, "us");
+    bench::doNotOptimize(counter);
+}
@@ -0,0 +1,277 @@
+#include "Benchmark.h"
+#include "SimulationFixtures.h"
+#include <DX3D/Game/Scenes/FlipParticleGrid.h>
+#include <DX3D/Game/Scenes/SPHKernels.h>
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
+#include <DX3D/Game/Scenes/SPHPairBlocks.h>
+#include <DX3D/Game/Scenes/SPHPositionSolver.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    constexpr int kParticleCount = 1600;   // default for --particles: 40 rows, as deep as the scene's pool
+    constexpr int kSimSeconds = 4;         // default for --steps: simulated seconds per run
+    constexpr int kColumns = 40;           // dam break: the column fills the left half of the tank
+    constexpr int kPositionStepFrames = 4; // SPHFluidSimulationScene's PBF step, in fixed updates
+    constexpr float kSkins[] = { 0.0f, 2.0f, 4.0f, 8.0f, 12.0f };
+
+    // The scene's two solver steps around SPHFluidSimulationScene::updateNeighborsOptimized:
+    // the table is refreshed if the skin allows, else the grid is updated and the table
+    // and blocks rebuilt
+    struct Solver
+    {
+        FlipParticleGrid grid;
+        SPHNeighborTable table;
+        SPHPairBlocks blocks;
+        SPHKernels kernels;
+        SPHPositionSolver positions;
+        int rebuilds = 0;
+        double neighborMs = 0.0;
+
+        void setUp(const SPHTank& tank, float skin)
+        {
+            // Cells span the search radius, as the scene sizes them
+            grid.resize(0.0f, 0.0f, tank.width, tank.height, kSPHRadius + skin);
+            table.setSkin(skin);
+            setUpSPHKernels(kernels);
+            positions.setSettings(kSPHRadius, getSPHPositionSettings(tank));
+        }
+
+        void neighbors(SPHTank& t)
+        {
+            const int count = static_cast<int>(t.x.size());
+            bench::Stopwatch sw;
+            if (!table.refresh(t.x.data(), t.y.data(), count, kSPHRadius, 0))
+            {
+                grid.update(t.x.data(), t.y.data(), count, 0);
+                table.build(t.x.data(), t.y.data(), count, grid, kSPHRadius, 0);
+                blocks.build(grid, kSPHRadius + table.getSkin(), 0);
+                ++rebuilds;
+            }
+            neighborMs += sw.elapsedMs();
+        }
+
+        // stepSPHOptimized: gas-law forces, damped integration, the collision pass over
+        // the table pairs (in index order), then the boundaries
+        void stepEquationOfState(SPHTank& t, float dt)
+        {
+            const int count = static_cast<int>(t.x.size());
+            neighbors(t);
+            integrateSPHForces(t, table, kernels, dt);
+            for (int iteration = 0; iteration < 2; ++iteration)
+                for (int i = 0; i < count; ++i) resolveSPHCollisions(t, table, i);
+            enforceSPHBoundaries(t);
+        }
+
+        // stepPositionBased: the table is refreshed on the predicted positions
+        void stepPositionBased(SPHTank& t, float dt)
+        {
+            const int count = static_cast<int>(t.x.size());
+            SPHPositionFields fields = getSPHPositionFields(t);
+            positions.predict(fields, count, dt);
+            neighbors(t);
+            positions.solve(table, blocks, fields, count, dt);
+            enforceSPHBoundaries(t);
+        }
+
+        void step(SPHSolverMode mode, SPHTank& t)
+        {
+            if (mode == SPHSolverMode::PositionBased) stepPositionBased(t, kSceneDt * kPositionStepFrames);
+            else stepEquationOfState(t, kSceneDt);
+        }
+    };
+
+    // Solver steps per simulated second in the scene
+    int stepRate(SPHSolverMode mode)
+    {
+        return mode == SPHSolverMode::PositionBased ? 60 / kPositionStepFrames : 60;
+    }
+
+    // Every cell of the updated grid holds the same particles as a fresh build
+    bool sameCells(const FlipParticleGrid& updated, const FlipParticleGrid& built)
+    {
+        std::vector<int> a, b;
+        for (int c = 0; c < updated.getCellsX() * updated.getCellsY(); ++c)
+        {
+            a.assign(updated.getSortedIndices().begin() + updated.getCellStart(c), updated.getSortedIndices().begin() + updated.getCellEnd(c));
+            b.assign(built.getSortedIndices().begin() + built.getCellStart(c), built.getSortedIndices().begin() + built.getCellEnd(c));
+            std::sort(a.begin(), a.end());
+            if (a != b) return false;
+        }
+        return true;
+    }
+
+    // Both tables hold the same neighbors for every particle, in any order
+    bool samePairs(const SPHNeighborTable& a, const SPHNeighborTable& b, int count)
+    {
+        std::vector<int> na, nb;
+        for (int i = 0; i < count; ++i)
+        {
+            na.clear();
+            nb.clear();
+            for (int k = a.begin(i); k < a.end(i); ++k) na.push_back(a.getIndex(k));
+            for (int k = b.begin(i); k < b.end(i); ++k) nb.push_back(b.getIndex(k));
+            std::sort(na.begin(), na.end());
+            std::sort(nb.begin(), nb.end());
+            if (na != nb) return false;
+        }
+        return true;
+    }
+
+    // FLIP collision pool, drifting
+    constexpr float kFlipTarget = 4.0f * 2.0f * 0.95f;
+    constexpr float kFlipCellSize = 16.0f; // FlipFluidSimulationScene's collision cell size
+
+    std::vector<FlipParticle> makePool(int count, float& width, float& height)
+    {
+        FlipPool pool = makeFlipPool(count, kFlipTarget, 1.5f, 30.0f, 25, false);
+        width = pool.width;
+        height = pool.height;
+        return std::move(pool.particles);
+    }
+
+    // Advect and bounce off the box, as the FLIP scene between its collision passes
+    void advect(std::vector<FlipParticle>& particles, float width, float height)
+    {
+        for (FlipParticle& p : particles)
+        {
+            p.position.x += p.velocity.x * kSceneDt;
+            p.position.y += p.velocity.y * kSceneDt;
+            if (p.position.x < 0.0f || p.position.x > width) p.velocity.x = -p.velocity.x;
+            if (p.position.y < 0.0f || p.position.y > height) p.velocity.y = -p.velocity.y;
+            p.position.x = std::clamp(p.position.x, 0.0f, width);
+            p.position.y = std::clamp(p.position.y, 0.0f, height);
+        }
+    }
+}
+
+DX3D_BENCHMARK(NeighborSkin)
+{
+    const int count = bench::particles(kParticleCount);
+    const int seconds = bench::steps(kSimSeconds);
+    char metric[96];
+
+    // SPH steps per second against the skin, per solver, after the first simulated
+    // second (the collapse). A skin makes each rebuild search further; a step that only
+    // re-measures the candidates skips the grid, the search and the blocks.
+    for (SPHSolverMode mode : { SPHSolverMode::EquationOfState, SPHSolverMode::PositionBased })
+    {
+        const char* name = mode == SPHSolverMode::PositionBased ? "PBF" : "EOS";
+        const int collapseSteps = stepRate(mode);
+        const int steps = std::max(1, (seconds - 1) * stepRate(mode));
+        double baseline = 0.0;
+        for (float skin : kSkins)
+        {
+            SPHTank tank = makeSPHTank(count, kColumns, 2 * kColumns);
+            Solver solver;
+            solver.setUp(tank, skin);
+            for (int s = 0; s < collapseSteps; ++s) solver.step(mode, tank);
+            solver.rebuilds = 0;
+            solver.neighborMs = 0.0;
+            bench::Stopwatch sw;
+            for (int s = 0; s < steps; ++s) solver.step(mode, tank);
+            const double rate = steps / (sw.elapsedMs() / 1000.0);
+            if (skin == 0.0f) baseline = rate;
+            std::snprintf(metric, sizeof(metric), "%s skin %.0f", name, skin);
+            bench::report("NeighborSkin", metric, rate, "steps/s");
+            std::snprintf(metric, sizeof(metric), "%s skin %.0f: vs no skin", name, skin);
+            bench::report("NeighborSkin", metric, rate / baseline, "x");
+            std::snprintf(metric, sizeof(metric), "%s skin %.0f: neighbor search", name, skin);
+            bench::report("NeighborSkin", metric, solver.neighborMs / steps, "ms/step");
+            std::snprintf(metric, sizeof(metric), "%s skin %.0f: rebuilds", name, skin);
+            bench::report("NeighborSkin", metric, 100.0 * solver.rebuilds / steps, "% steps");
+        }
+    }
+
+    // Correctness on the drifting FLIP pool, which mostly refreshes: each refreshed
+    // table holds exactly the pairs of a fresh build, and the incrementally updated
+    // grid the same cells
+    {
+        const float skin = 8.0f;
+        float width = 0.0f, height = 0.0f;
+        std::vector<FlipParticle> particles = makePool(count * 10, width, height);
+        FlipParticleGrid grid, freshGrid;
+        grid.resize(0.0f, 0.0f, width, height, kFlipCellSize);
+        freshGrid.resize(0.0f, 0.0f, width, height, kFlipCellSize);
+        SPHNeighborTable pairs, fresh;
+        pairs.setSkin(skin);
+        int wrongTables = 0, wrongGrids = 0, refreshed = 0;
+        for (int s = 0; s < seconds * 15; ++s)
+        {
+            advect(particles, width, height);
+            grid.update(particles, 0);
+            if (pairs.refresh(particles, kFlipTarget, 0)) ++refreshed;
+            else pairs.build(particles, grid, kFlipTarget, 0);
+            freshGrid.build(particles, 0);
+            fresh.build(particles, freshGrid, kFlipTarget, 0);
+            wrongTables += !samePairs(pairs, fresh, static_cast<int>(particles.size()));
+            wrongGrids += !sameCells(grid, freshGrid);
+        }
+        bench::report("NeighborSkin", "refreshed tables checked", refreshed, "");
+        bench::report("NeighborSkin", "tables differing from a build", wrongTables, "");
+        bench::report("NeighborSkin", "updated grids differing from a build", wrongGrids, "");
+        if (wrongTables > 0 || wrongGrids > 0)
+            bench::fail("incremental neighbor search disagrees with a rebuild");
+    }
+
+    // FLIP collisions, 2 iterations a step: the grid updated per iteration against a
+    // skin pair list refreshed per iteration
+    {
+        const int flipSteps = seconds * 15;
+        float width = 0.0f, height = 0.0f;
+        const std::vector<FlipParticle> pool = makePool(count * 10, width, height);
+        FlipCollisionSettings settings;
+        settings.targetDistance = kFlipTarget;
+        settings.iterations = 2;
+        settings.maxThreads = 0;
+        std::vector<float> scratch;
+        double gridMs = 0.0;
+        for (float skin : kSkins)
+        {
+            std::vector<FlipParticle> particles = pool;
+            FlipParticleGrid grid;
+            grid.resize(0.0f, 0.0f, width, height, kFlipCellSize);
+            SPHNeighborTable pairs;
+            pairs.setSkin(skin);
+            int rebuilds = 0, passes = 0;
+            bench::Stopwatch sw;
+            for (int s = 0; s < flipSteps; ++s)
+            {
+                advect(particles, width, height);
+                if (skin == 0.0f)
+                {
+                    resolveFlipCollisions(particles, grid, settings, scratch);
+                    continue;
+                }
+                resolveFlipCollisions(particles, pairs, [&]()
+                {
+                    ++passes;
+                    if (pairs.refresh(particles, kFlipTarget, 0)) return;
+                    grid.update(particles, 0);
+                    pairs.build(particles, grid, kFlipTarget, 0);
+                    ++rebuilds;
+                }, settings, scratch);
+            }
+            const double ms = sw.elapsedMs() / flipSteps;
+            if (skin == 0.0f)
+            {
+                gridMs = ms;
+                bench::report("NeighborSkin", "FLIP grid per iteration", ms, "ms/step");
+                continue;
+            }
+            std::snprintf(metric, sizeof(metric), "FLIP skin %.0f", skin);
+            bench::report("NeighborSkin", metric, ms, "ms/step");
+            std::snprintf(metric, sizeof(metric), "FLIP skin %.0f: vs grid", skin);
+            bench::report("NeighborSkin", metric, gridMs / ms, "x");
+            std::snprintf(metric, sizeof(metric), "FLIP skin %.0f: rebuilds", skin);
+            bench::report("NeighborSkin", metric, 100.0 * rebuilds / std::max(1, passes), "% passes");
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#include "Benchmark.h"
+#include <DX3D/Graphics/ParticleBatchRenderer.h>
+#include <random>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kParticleCount = 100000; // default for --particles
+    constexpr int kFrames = 100;           // default for --steps
+    constexpr std::uint32_t kMaterials = 2; // the fluid scenes' node.png and MetaballFalloff.png
+
+    // Stands in for the D3D11 device: keeps the upload and the draws it was asked for
+    class RecordingTarget final : public ParticleBatchTarget
+    {
+    public:
+        struct Draw { std::uint32_t material, firstInstance, count; };
+
+        bool uploadInstances(const ParticleInstance* instances, std::uint32_t count) override
+        {
+            ++uploads;
+            uploaded.assign(instances, instances + count);
+            return true;
+        }
+
+        void drawInstances(std::uint32_t material, std::uint32_t firstInstance, std::uint32_t count) override
+        {
+            draws.push_back({ material, firstInstance, count });
+        }
+
+        void reset()
+        {
+            uploads = 0;
+            uploaded.clear();
+            draws.clear();
+        }
+
+        int uploads = 0;
+        std::vector<ParticleInstance> uploaded;
+        std::vector<Draw> draws;
+    };
+
+    // SoA particles the way a simulation keeps them
+    struct Particles
+    {
+        std::vector<float> x, y;
+        std::vector<std::uint32_t> color;
+    };
+}
+
+DX3D_BENCHMARK(ParticleBatch)
+{
+    const int count = bench::particles(kParticleCount);
+    const int frames = bench::steps(kFrames);
+
+    std::mt19937 rng(bench::seed(7));
+    std::uniform_real_distribution<float> pos(-1000.0f, 1000.0f);
+    Particles particles;
+    for (int i = 0; i < count; ++i)
+    {
+        particles.x.push_back(pos(rng));
+        particles.y.push_back(pos(rng));
+        particles.color.push_back(static_cast<std::uint32_t>(rng()));
+    }
+
+    // Interleave the materials per particle so packing has to regroup them
+    ParticleBatchRenderer batch;
+    RecordingTarget target;
+    auto submit = [&]()
+    {
+        for (int i = 0; i < count; ++i)
+            batch.add(static_cast<std::uint32_t>(i) % kMaterials, particles.x[i], particles.y[i], 4.0f, particles.color[i]);
+    };
+
+    // One upload, one draw per material, each draw's range holding exactly its
+    // particles in submission order
+    submit();
+    batch.flush(target);
+    bool exact = target.uploads == 1 && target.draws.size() == kMaterials && target.uploaded.size() == static_cast<std::size_t>(count);
+    std::uint32_t next = 0;
+    for (const auto& draw : target.draws)
+    {
+        exact = exact && draw.firstInstance == next;
+        for (std::uint32_t k = 0; exact && k < draw.count; ++k)
+        {
+            const int i = static_cast<int>(k * kMaterials + draw.material);
+            const ParticleInstance& instance = target.uploaded[draw.firstInstance + k];
+            exact = i < count && instance.x == particles.x[i] && instance.y == particles.y[i] && instance.size == 4.0f && instance.color == particles.color[i];
+        }
+        next += draw.count;
+    }
+    bench::check("ParticleBatch", "packing matches submission", exact);
+    bench::report("ParticleBatch", "draw calls per frame", static_cast<double>(target.draws.size()), "");
+    bench::report("ParticleBatch", "sprite draw calls it replaces", count, "");
+
+    // Per-particle adds, as the scenes submit
+    bench::Stopwatch sw;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        target.reset();
+        submit();
+        batch.flush(target);
+    }
+    const double singleMs = sw.elapsedMs() / frames;
+    bench::report("ParticleBatch", "pack + upload, per-particle add", singleMs, "ms/frame");
+
+    // SoA add, one call per material
+    std::vector<float> x[kMaterials], y[kMaterials];
+    std::vector<std::uint32_t> colors[kMaterials];
+    for (int i = 0; i < count; ++i)
+    {
+        x[i % kMaterials].push_back(particles.x[i]);
+        y[i % kMaterials].push_back(particles.y[i]);
+        colors[i % kMaterials].push_back(particles.color[i]);
+    }
+    sw.reset();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        target.reset();
+        for (std::uint32_t m = 0; m < kMaterials; ++m)
+            batch.add(m, static_cast<std::uint32_t>(x[m].size()), x[m].data(), y[m].data(), nullptr, 4.0f, colors[m].data(), 0);
+        batch.flush(target);
+    }
+    const double soaMs = sw.elapsedMs() / frames;
+    bench::report("ParticleBatch", "pack + upload, SoA add", soaMs, "ms/frame");
+    bench::report("ParticleBatch", "throughput", count / (singleMs * 1000.0), "Minstances/s");
+    bench::doNotOptimize(target.uploaded.data());
+}
@@ -0,0 +1,122 @@
+#include "Benchmark.h"
+#include <DX3D/Components/AABBTree.h>
+#include <DX3D/Components/KDTree.h>
+#include <DX3D/Components/Quadtree.h>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kEntityCount = 5000; // default for --particles
+    constexpr int kSteps = 300;        // default for --steps
+    constexpr float kDt = 1.0f / 60.0f;
+    // PartitionScene at 1280x720: the trees cover the screen, entities move in half of it
+    const Vec2 kTreeSize(1280.0f, 720.0f);
+    const Vec2 kEntityBounds(640.0f, 360.0f);
+    constexpr float kSpeedMultiplier = 3.0f;
+
+    struct MovingEntity
+    {
+        QuadtreeEntity qtEntity;
+        Vec2 velocity;
+    };
+
+    // PartitionScene::updateMovingEntities without the sprite sync: move, bounce off the bounds
+    void moveEntities(std::vector<MovingEntity>& entities, float dt)
+    {
+        for (MovingEntity& e : entities)
+        {
+            Vec2& p = e.qtEntity.position;
+            const Vec2 half(e.qtEntity.size.x * 0.5f, e.qtEntity.size.y * 0.5f);
+            p.x += e.velocity.x * dt * kSpeedMultiplier;
+            p.y += e.velocity.y * dt * kSpeedMultiplier;
+            if (p.x - half.x <= -kEntityBounds.x || p.x + half.x >= kEntityBounds.x)
+            {
+                e.velocity.x = -e.velocity.x;
+                if (p.x < -kEntityBounds.x + half.x) p.x = -kEntityBounds.x + half.x;
+                else if (p.x > kEntityBounds.x - half.x) p.x = kEntityBounds.x - half.x;
+            }
+            if (p.y - half.y <= -kEntityBounds.y || p.y + half.y >= kEntityBounds.y)
+            {
+                e.velocity.y = -e.velocity.y;
+                if (p.y < -kEntityBounds.y + half.y) p.y = -kEntityBounds.y + half.y;
+                else if (p.y > kEntityBounds.y - half.y) p.y = kEntityBounds.y - half.y;
+            }
+        }
+    }
+}
+
+// PartitionScene's per-frame work: move the entities, then rebuild the selected
+// partition. The scene rebuilds one tree per frame; each of the three is timed here.
+// The scene itself (sprites, line visualization, K-means and DBSCAN on its members)
+// needs the D3D11 renderer.
+DX3D_BENCHMARK(Partition)
+{
+    const int count = bench::particles(kEntityCount);
+    const int steps = bench::steps(kSteps);
+
+    std::mt19937 rng(bench::seed(5));
+    std::uniform_real_distribution<float> posX(-kEntityBounds.x * 0.5f, kEntityBounds.x * 0.5f);
+    std::uniform_real_distribution<float> posY(-kEntityBounds.y * 0.5f, kEntityBounds.y * 0.5f);
+    std::uniform_real_distribution<float> size(10.0f, 30.0f);
+    std::uniform_real_distribution<float> velocity(-120.0f, 120.0f);
+    std::vector<MovingEntity> entities(count);
+    for (int i = 0; i < count; ++i)
+    {
+        entities[i].qtEntity.position = Vec2(posX(rng), posY(rng));
+        entities[i].qtEntity.size = Vec2(size(rng), size(rng));
+        entities[i].qtEntity.id = i;
+        entities[i].velocity = Vec2(velocity(rng), velocity(rng));
+    }
+
+    AABBTree aabbTree(Vec2(0.0f, 0.0f), kTreeSize, 16, 16);
+    KDTree kdTree(Vec2(0.0f, 0.0f), kTreeSize, 16, 16);
+    std::vector<QuadtreeEntity> snapshot;
+    snapshot.reserve(count);
+    std::size_t nodes[3] = {};
+    bench::PhaseTimes phases;
+    for (int step = 0; step < steps; ++step)
+    {
+        bench::Stopwatch sw;
+        moveEntities(entities, kDt);
+        snapshot.clear();
+        for (const MovingEntity& e : entities) snapshot.push_back(e.qtEntity);
+        phases.add("move", sw.elapsedMs());
+
+        // The scene replaces its quadtree rather than clearing it
+        sw.reset();
+        Quadtree quadtree(Vec2(0.0f, 0.0f), kTreeSize, 4, 5);
+        for (const QuadtreeEntity& e : snapshot) quadtree.insert(e);
+        phases.add("quadtree rebuild", sw.elapsedMs());
+
+        sw.reset();
+        aabbTree.buildFrom(snapshot);
+        phases.add("aabb tree rebuild", sw.elapsedMs());
+
+        sw.reset();
+        kdTree.buildFrom(snapshot);
+        phases.add("kd tree rebuild", sw.elapsedMs());
+
+        if (step == steps - 1)
+        {
+            std::vector<Quadtree*> quadNodes;
+            std::vector<AABBNode*> aabbNodes;
+            std::vector<KDNode*> kdNodes;
+            quadtree.getAllNodes(quadNodes);
+            aabbTree.getAllNodes(aabbNodes);
+            kdTree.getAllNodes(kdNodes);
+            nodes[0] = quadNodes.size();
+            nodes[1] = aabbNodes.size();
+            nodes[2] = kdNodes.size();
+        }
+    }
+
+    bench::report("Partition", "entities", count, "");
+    phases.report("Partition", "", steps);
+    bench::report("Partition", "quadtree nodes", static_cast<double>(nodes[0]), "");
+    bench::report("Partition", "aabb tree nodes", static_cast<double>(nodes[1]), "");
+    bench::report("Partition", "kd tree nodes", static_cast<double>(nodes[2]), "");
+}
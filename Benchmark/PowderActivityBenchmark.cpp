@@ -0,0 +1,137 @@
+#include "Benchmark.h"
+#include <DX3D/Game/Scenes/PowderActivity.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kWorldSize = 1024; // default for --size
+    constexpr int kSteps = 200;      // default for --steps
+    constexpr int kStreamWidth = 16;
+
+    enum : uint8_t { Empty = 0, Sand = 1, Stone = 2 };
+
+    // A mostly settled size^2 world: a stone floor, a sand bed over the bottom
+    // half and one narrow stream of sand pouring onto it. Steps follow
+    // PowderScene::updateGrid: sync the back buffer, update awake cells from the
+    // front into the back buffer, diff, swap.
+    struct SettledWorld
+    {
+        int size;
+        std::vector<uint8_t> front;
+        std::vector<uint8_t> back;
+        PowderActivityMap activity;
+        bench::PhaseTimes phases;
+
+        explicit SettledWorld(int worldSize)
+            : size(worldSize), front(static_cast<std::size_t>(worldSize) * worldSize, Empty)
+        {
+            for (int y = 0; y < size / 2; ++y)
+            {
+                for (int x = 0; x < size; ++x)
+                    front[y * size + x] = (y < 8) ? Stone : Sand;
+            }
+            back = front;
+            activity.resize(size, size);
+        }
+
+        void tryFall(int x, int y)
+        {
+            const int idx = y * size + x;
+            const int targets[3] = { idx - size, idx - size + ((x + y) % 2 ? 1 : -1), idx - size + ((x + y) % 2 ? -1 : 1) };
+            for (int i = 0; i < 3; ++i)
+            {
+                const int tx = targets[i] % size;
+                if (std::abs(tx - x) > 1 || back[targets[i]] != Empty)
+                    continue;
+                back[targets[i]] = Sand;
+                back[idx] = Empty;
+                return;
+            }
+        }
+
+        void step(bool sleeping)
+        {
+            bench::Stopwatch sw;
+
+            // Pour the stream (a brush edit)
+            const int streamX = size / 2 - kStreamWidth / 2;
+            for (int x = streamX; x < streamX + kStreamWidth; ++x)
+                front[(size - 1) * size + x] = Sand;
+            activity.markChanged(streamX, size - 1, streamX + kStreamWidth - 1, size - 1);
+
+            for (PowderChunk& chunk : activity.getChunks())
+            {
+                if (chunk.dirty.isEmpty())
+                    continue;
+                for (int y = chunk.dirty.minY; y <= chunk.dirty.maxY; ++y)
+                {
+                    const int begin = y * size + chunk.dirty.minX;
+                    std::copy(front.begin() + begin, front.begin() + begin + chunk.dirty.maxX - chunk.dirty.minX + 1, back.begin() + begin);
+                }
+                chunk.dirty = PowderCellRect{};
+            }
+            phases.add("sync", sw.elapsedMs());
+            sw.reset();
+
+            if (!sleeping)
+                activity.wake(0, 0, size - 1, size - 1);
+
+            for (const PowderChunk& chunk : activity.getChunks())
+            {
+                if (chunk.awake.isEmpty())
+                    continue;
+                for (int y = std::max(chunk.awake.minY, 1); y <= chunk.awake.maxY; ++y)
+                {
+                    for (int x = chunk.awake.minX; x <= chunk.awake.maxX; ++x)
+                    {
+                        if (front[y * size + x] == Sand && activity.isAwake(x, y))
+                            tryFall(x, y);
+                    }
+                }
+            }
+
+            phases.add("update", sw.elapsedMs());
+            sw.reset();
+
+            activity.collectChanges(1, [this](int idx) { return front[idx] != back[idx]; });
+            front.swap(back);
+            phases.add("collect", sw.elapsedMs());
+        }
+    };
+}
+
+DX3D_BENCHMARK(PowderSettledWorld)
+{
+    const int size = bench::gridSize(kWorldSize);
+    const int steps = bench::steps(kSteps);
+    const double cells = static_cast<double>(size) * size;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const bool sleeping = (pass == 1);
+        SettledWorld world(size);
+
+        // Let the initial wake-up settle before timing
+        for (int i = 0; i < 100; ++i) world.step(sleeping);
+        world.phases = bench::PhaseTimes();
+
+        double awake = 0.0;
+        bench::Stopwatch sw;
+        for (int i = 0; i < steps; ++i)
+        {
+            world.step(sleeping);
+            awake += world.activity.getAwakeCellCount();
+        }
+        const double ms = sw.elapsedMs() / steps;
+        bench::report("PowderSettledWorld", sleeping ? "sleeping: step" : "every cell: step", ms, "ms");
+        bench::report("PowderSettledWorld", sleeping ? "sleeping: active cells" : "every cell: active cells", 100.0 * awake / steps / cells, "%");
+        bench::report("PowderSettledWorld", sleeping ? "sleeping: throughput" : "every cell: throughput", cells / (ms * 1000.0), "Mcells/s");
+        world.phases.report("PowderSettledWorld", sleeping ? "sleeping: " : "every cell: ", steps);
+        bench::doNotOptimize(world.front[size * size / 2]);
+    }
+}
@@ -0,0 +1,168 @@
+#include "Benchmark.h"
+#include <DX3D/Game/Scenes/PowderAirKernels.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kBaseSize = 512; // default for --size
+    constexpr int kSteps = 20;     // default for --steps
+
+    // One set of air planes shaped like PowderScene's: random fields and scattered solid blobs
+    struct AirFields
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> pressure, velocityX, velocityY, heat;
+        std::vector<float> pressureNext, velocityXNext, velocityYNext;
+        std::vector<float> blurX, blurY, blurValue, curl;
+        std::vector<uint8_t> blockAir, blockAirHeat;
+
+        AirFields(int w, int h) : width(w), height(h)
+        {
+            const size_t count = static_cast<size_t>(w) * h;
+            for (auto* plane : { &pressure, &velocityX, &velocityY, &heat, &pressureNext, &velocityXNext, &velocityYNext, &blurX, &blurY, &blurValue, &curl })
+                plane->resize(count);
+            blockAir.resize(count);
+            blockAirHeat.resize(count);
+
+            // Magnitudes straddle every loss band (0.5, 2, 5, 10, 20)
+            std::mt19937 rng(bench::seed(11));
+            std::uniform_real_distribution<float> field(-30.0f, 30.0f);
+            std::uniform_real_distribution<float> temperature(173.15f, 1373.15f);
+            for (size_t i = 0; i < count; ++i)
+            {
+                pressure[i] = field(rng);
+                velocityX[i] = field(rng) * 0.5f;
+                velocityY[i] = field(rng) * 0.5f;
+                heat[i] = temperature(rng);
+            }
+            std::uniform_int_distribution<int> cx(0, w - 1), cy(0, h - 1);
+            for (int blob = 0; blob < w * h / 400; ++blob)
+            {
+                const int x0 = cx(rng), y0 = cy(rng);
+                for (int y = std::max(0, y0 - 3); y < std::min(h, y0 + 3); ++y)
+                {
+                    for (int x = std::max(0, x0 - 3); x < std::min(w, x0 + 3); ++x)
+                    {
+                        blockAir[y * w + x] = 1;
+                        blockAirHeat[y * w + x] = 0x8;
+                    }
+                }
+            }
+        }
+
+        void resetNext()
+        {
+            pressureNext = pressure;
+            velocityXNext = velocityX;
+            velocityYNext = velocityY;
+        }
+    };
+
+    PowderAirStencil makeStencil(int width, int height, PowderAirSimd simd)
+    {
+        float kernel[9];
+        float sum = 0.0f;
+        for (int j = -1; j <= 1; ++j)
+        {
+            for (int i = -1; i <= 1; ++i)
+            {
+                kernel[(i + 1) + 3 * (j + 1)] = std::exp(-2.0f * (i * i + j * j));
+                sum += kernel[(i + 1) + 3 * (j + 1)];
+            }
+        }
+        for (float& k : kernel) k /= sum;
+
+        PowderAirStencil stencil;
+        stencil.resize(width, height);
+        stencil.setKernel(kernel);
+        stencil.setSimd(simd);
+        return stencil;
+    }
+
+    // Every stencil pass PowderScene::updateAirSystem runs in one step
+    void runStencils(const PowderAirStencil& stencil, AirFields& f)
+    {
+        const int h = f.height;
+        stencil.divergence(f.velocityX.data(), f.velocityY.data(), f.pressureNext.data(), 0.6f, 0, h);
+        stencil.gradient(f.pressure.data(), f.blockAir.data(), f.velocityXNext.data(), f.velocityYNext.data(), 0.6f, 0, h);
+        stencil.blur(f.velocityX.data(), f.blockAir.data(), 1, f.blurX.data(), 0, h);
+        stencil.blur(f.velocityY.data(), f.blockAir.data(), 1, f.blurY.data(), 0, h);
+        stencil.blur(f.pressure.data(), f.blockAir.data(), 1, f.blurValue.data(), 0, h);
+        stencil.vorticity(f.velocityX.data(), f.velocityY.data(), f.curl.data(), 0, h);
+        stencil.convection(f.heat.data(), f.blockAir.data(), f.velocityXNext.data(), f.velocityYNext.data(), 295.15f, 0.0f, -1.0f, 0.0001f, 0, h);
+        stencil.blur(f.heat.data(), f.blockAirHeat.data(), 0x8, f.blurValue.data(), 0, h);
+        stencil.blur(f.velocityX.data(), f.blockAirHeat.data(), 0x8, f.blurX.data(), 0, h);
+        stencil.blur(f.velocityY.data(), f.blockAirHeat.data(), 0x8, f.blurY.data(), 0, h);
+    }
+
+    float maxDifference(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        float worst = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i) worst = std::max(worst, std::abs(a[i] - b[i]));
+        return worst;
+    }
+
+    double stepMs(const PowderAirStencil& stencil, AirFields& fields)
+    {
+        const int steps = bench::steps(kSteps);
+        bench::Stopwatch sw;
+        for (int step = 0; step < steps; ++step)
+        {
+            fields.resetNext();
+            runStencils(stencil, fields);
+        }
+        bench::doNotOptimize(fields.velocityXNext[fields.width + 1]);
+        return sw.elapsedMs() / steps;
+    }
+}
+
+DX3D_BENCHMARK(PowderAirStencils)
+{
+    const PowderAirSimd best = getPowderAirSimdSupport();
+    std::printf("  air kernels: %s\n", getPowderAirSimdName(best));
+
+    const int baseSize = bench::gridSize(kBaseSize);
+
+    // Validation: the vectorized interior against the scalar reference, per output plane
+    {
+        AirFields scalar(baseSize + 3, baseSize - 1); // odd sizes exercise the row tails
+        AirFields simd(baseSize + 3, baseSize - 1);
+        scalar.resetNext();
+        simd.resetNext();
+        runStencils(makeStencil(scalar.width, scalar.height, PowderAirSimd::Scalar), scalar);
+        runStencils(makeStencil(simd.width, simd.height, best), simd);
+
+        float worst = 0.0f;
+        worst = std::max(worst, maxDifference(scalar.pressureNext, simd.pressureNext));
+        worst = std::max(worst, maxDifference(scalar.velocityXNext, simd.velocityXNext));
+        worst = std::max(worst, maxDifference(scalar.velocityYNext, simd.velocityYNext));
+        worst = std::max(worst, maxDifference(scalar.blurX, simd.blurX));
+        worst = std::max(worst, maxDifference(scalar.blurY, simd.blurY));
+        worst = std::max(worst, maxDifference(scalar.blurValue, simd.blurValue));
+        worst = std::max(worst, maxDifference(scalar.curl, simd.curl));
+        bench::report("PowderAirStencils", "max |simd - scalar|", worst, "");
+        if (worst > 1e-3f)
+            bench::fail("SIMD air stencils differ from the scalar path");
+    }
+
+    // Cost: scalar at the base resolution (512^2 unless --size) against SIMD at 4x the cells
+    AirFields base(baseSize, baseSize);
+    AirFields large(baseSize * 2, baseSize * 2);
+    const double scalarBase = stepMs(makeStencil(base.width, base.height, PowderAirSimd::Scalar), base);
+    const double simdBase = stepMs(makeStencil(base.width, base.height, best), base);
+    const double simdLarge = stepMs(makeStencil(large.width, large.height, best), large);
+    bench::report("PowderAirStencils", "scalar base", scalarBase, "ms/step");
+    bench::report("PowderAirStencils", "simd base", simdBase, "ms/step");
+    bench::report("PowderAirStencils", "simd 4x cells", simdLarge, "ms/step");
+    bench::report("PowderAirStencils", "simd 4x cells throughput", static_cast<double>(large.width) * large.height / (simdLarge * 1000.0), "Mcells/s");
+    bench::report("PowderAirStencils", "speedup at base", scalarBase / simdBase, "x");
+    bench::report("PowderAirStencils", "4x cells simd / base scalar", simdLarge / scalarBase, "x cost");
+}
@@ -0,0 +1,205 @@
+#include "Benchmark.h"
+#include <DX3D/Game/Scenes/PowderActivity.h>
+#include <DX3D/Game/Scenes/PowderAirKernels.h>
+#include <DX3D/Game/Scenes/PowderAirWake.h>
+#include <DX3D/Game/Scenes/PowderElements.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kWorldSize = 512; // default for --size
+    constexpr int kSteps = 300;     // default for --steps
+    constexpr float kDt = 1.0f / 60.0f;
+    constexpr float kAmbient = 273.15f + 22.0f;
+    constexpr int kDraftRadius = 3;
+
+    using Type = PowderParticleType;
+
+    // PowderScene's default world after it settles, with air on: a stone floor, a sand
+    // bed, a water pool, a lava strip heating the air and a small fire above it whose
+    // draft stirs the air. The air step runs the scene's sources (lava heat, fire draft)
+    // and the PowderAirStencil passes of PowderScene::updateAirSystem without advection.
+    struct AirWorld
+    {
+        int size;
+        PowderElementTable elements;
+        std::vector<Type> types;
+        std::vector<float> temperature;
+        std::vector<float> pressure, velocityX, velocityY, heat;
+        std::vector<float> pressureNext, velocityXNext, velocityYNext, heatNext;
+        std::vector<uint8_t> blockAir, blockAirHeat;
+        std::vector<int> fires;
+        PowderAirStencil stencil;
+
+        explicit AirWorld(int worldSize) : size(worldSize)
+        {
+            const std::size_t count = static_cast<std::size_t>(size) * size;
+            types.assign(count, Type::Empty);
+            temperature.assign(count, kAmbient);
+            for (auto* plane : { &pressure, &velocityX, &velocityY, &pressureNext, &velocityXNext, &velocityYNext })
+                plane->assign(count, 0.0f);
+            heat.assign(count, kAmbient);
+            heatNext.assign(count, kAmbient);
+            blockAir.assign(count, 0);
+            blockAirHeat.assign(count, 0);
+
+            for (int y = 0; y < size / 2; ++y)
+            {
+                for (int x = 0; x < size; ++x)
+                    types[y * size + x] = y < 8 ? Type::Stone : (x < size * 3 / 4 ? Type::Sand : Type::Water);
+            }
+            for (int y = size / 2; y < size / 2 + 4; ++y)
+            {
+                for (int x = size / 8; x < size / 4; ++x)
+                {
+                    types[y * size + x] = Type::Lava;
+                    temperature[y * size + x] = elements.getProperties(Type::Lava).burnTemp;
+                }
+            }
+            for (int y = size / 2 + 4; y < size / 2 + 7; ++y)
+            {
+                for (int x = size * 3 / 16 - 1; x <= size * 3 / 16 + 1; ++x)
+                {
+                    types[y * size + x] = Type::Fire;
+                    temperature[y * size + x] = 1500.0f;
+                    fires.push_back(y * size + x);
+                }
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const bool blocks = types[i] != Type::Empty && elements.getProperties(types[i]).matterState == PowderMatterState::Solid;
+                blockAir[i] = blocks ? 1 : 0;
+                blockAirHeat[i] = blocks ? 0x8 : 0;
+            }
+
+            float kernel[9];
+            float sum = 0.0f;
+            for (int j = -1; j <= 1; ++j)
+            {
+                for (int i = -1; i <= 1; ++i)
+                {
+                    kernel[(i + 1) + 3 * (j + 1)] = std::exp(-2.0f * (i * i + j * j));
+                    sum += kernel[(i + 1) + 3 * (j + 1)];
+                }
+            }
+            for (float& k : kernel) k /= sum;
+            stencil.resize(size, size);
+            stencil.setKernel(kernel);
+        }
+
+        PowderAirFields fields() const
+        {
+            return { pressure.data(), velocityX.data(), velocityY.data(), heat.data(), size, size };
+        }
+
+        void stepAir()
+        {
+            // Sources, as PowderScene::updateParticle: lava and fire heat the air, fire adds its draft
+            for (std::size_t i = 0; i < types.size(); ++i)
+            {
+                const PowderParticleProperties& props = elements.getProperties(types[i]);
+                if (props.heatsAir)
+                    heat[i] = std::min(heat[i] + (props.burnTemp - kAmbient) * 0.1f * kDt, props.burnTemp);
+            }
+            const float draft = elements.getProperties(Type::Fire).draftStrength;
+            for (int fire : fires)
+            {
+                for (int dy = -kDraftRadius; dy <= kDraftRadius; ++dy)
+                {
+                    for (int dx = -kDraftRadius; dx <= kDraftRadius; ++dx)
+                    {
+                        const int idx = fire + dy * size + dx;
+                        const float dist = std::sqrt(static_cast<float>(dx * dx + dy * dy)) / kDraftRadius;
+                        if (dist > 1.0f || blockAir[idx]) continue;
+                        velocityY[idx] += draft * (1.0f - dist * 0.7f) * kDt;
+                        pressure[idx] += draft * 0.3f * (1.0f - dist * 0.7f) * kDt;
+                    }
+                }
+            }
+
+            pressureNext = pressure;
+            velocityXNext = velocityX;
+            velocityYNext = velocityY;
+            stencil.divergence(velocityX.data(), velocityY.data(), pressureNext.data(), 0.6f, 0, size);
+            stencil.gradient(pressure.data(), blockAir.data(), velocityXNext.data(), velocityYNext.data(), 0.6f, 0, size);
+            stencil.convection(heat.data(), blockAir.data(), velocityXNext.data(), velocityYNext.data(), kAmbient, 0.0f, -1.0f, 0.0001f, 0, size);
+            pressure.swap(pressureNext);
+            velocityX.swap(velocityXNext);
+            velocityY.swap(velocityYNext);
+            stencil.blur(heat.data(), blockAirHeat.data(), 0x8, heatNext.data(), 0, size);
+            heat.swap(heatNext);
+        }
+    };
+
+    bool sameAwake(const PowderActivityMap& a, const PowderActivityMap& b, int size)
+    {
+        if (a.getAwakeCellCount() != b.getAwakeCellCount())
+            return false;
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                if (a.isAwake(x, y) != b.isAwake(x, y))
+                    return false;
+            }
+        }
+        return true;
+    }
+}
+
+// PowderScene's wakeFromAir with air on, over a settled world: the full test of
+// every sleeping particle against the chunks picked by the air threshold pass.
+// Particles do not move here, so both activity maps see the same steps and must
+// end up with the same awake cells.
+DX3D_BENCHMARK(PowderAirWaking)
+{
+    const int size = bench::gridSize(kWorldSize);
+    const int steps = bench::steps(kSteps);
+    const float delta = 1.0f; // PowderScene's default wake delta
+
+    AirWorld world(size);
+    PowderActivityMap fullMap, chunkMap;
+    fullMap.resize(size, size);
+    chunkMap.resize(size, size);
+    PowderAirWake airWake;
+    airWake.resize(size, size);
+    const auto unchanged = [](int) { return false; };
+
+    double airMs = 0.0, fullMs = 0.0, chunkMs = 0.0, testedChunks = 0.0;
+    int mismatches = 0;
+    for (int step = 0; step < steps; ++step)
+    {
+        bench::Stopwatch sw;
+        world.stepAir();
+        airMs += sw.elapsedMs();
+
+        const PowderAirFields air = world.fields();
+        sw.reset();
+        PowderAirWake::wakeAll(fullMap, world.elements, world.types.data(), world.temperature.data(), air, delta);
+        fullMs += sw.elapsedMs();
+        sw.reset();
+        testedChunks += airWake.wake(chunkMap, world.elements, world.types.data(), world.temperature.data(), air, delta, 0);
+        chunkMs += sw.elapsedMs();
+
+        mismatches += !sameAwake(fullMap, chunkMap, size);
+        fullMap.collectChanges(2, unchanged);
+        chunkMap.collectChanges(2, unchanged);
+    }
+
+    const int chunks = chunkMap.getChunksX() * chunkMap.getChunksY();
+    bench::report("PowderAirWaking", "air step", airMs / steps, "ms/step");
+    bench::report("PowderAirWaking", "full test", fullMs / steps, "ms/step");
+    bench::report("PowderAirWaking", "chunked test", chunkMs / steps, "ms/step");
+    bench::report("PowderAirWaking", "speedup", fullMs / chunkMs, "x");
+    bench::report("PowderAirWaking", "chunks tested", 100.0 * testedChunks / steps / chunks, "%");
+    bench::report("PowderAirWaking", "awake cells at end", chunkMap.getAwakeCellCount(), "");
+    bench::report("PowderAirWaking", "steps waking differently", mismatches, "");
+    if (mismatches > 0)
+        bench::fail("the chunked air wake differs from the full test");
+}
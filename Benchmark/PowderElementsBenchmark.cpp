@@ -0,0 +1,132 @@
+#include "Benchmark.h"
+#include <DX3D/Game/Scenes/PowderElements.h>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kGridSize = 512;
+    constexpr int kPasses = 20;
+
+    using Type = PowderParticleType;
+
+    // A settled-looking mix: mostly empty, sand/water/stone heavy, a sprinkling of reactive elements
+    std::vector<Type> makeMixedGrid()
+    {
+        const Type palette[] = {
+            Type::Empty, Type::Empty, Type::Empty, Type::Empty, Type::Sand, Type::Sand, Type::Water, Type::Water,
+            Type::Stone, Type::Wood, Type::Gas, Type::Acid, Type::Fire, Type::Smoke, Type::Steam, Type::Metal,
+            Type::Lava, Type::Mud, Type::Oil
+        };
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pick(0, static_cast<int>(sizeof(palette) / sizeof(palette[0])) - 1);
+        std::vector<Type> grid(kGridSize * kGridSize);
+        for (Type& cell : grid) cell = palette[pick(rng)];
+        return grid;
+    }
+
+    // The pre-table structure: a hash lookup per cell and per neighbor, then per-type branches
+    float legacyPass(const std::vector<Type>& grid, const std::unordered_map<Type, PowderParticleProperties>& props)
+    {
+        auto lookup = [&props](Type type) -> const PowderParticleProperties& { return props.find(type)->second; };
+        float heat = 0.0f;
+        for (int y = 1; y < kGridSize - 1; ++y)
+        {
+            for (int x = 1; x < kGridSize - 1; ++x)
+            {
+                const Type type = grid[y * kGridSize + x];
+                if (type == Type::Empty) continue;
+                const PowderParticleProperties& self = lookup(type);
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        if (dx == 0 && dy == 0) continue;
+                        const Type n = grid[(y + dy) * kGridSize + x + dx];
+                        if (n == Type::Empty) continue;
+                        const PowderParticleProperties& other = lookup(n);
+                        if (type == Type::Fire && other.flammable) heat += other.ignitionTemp * 0.2f;
+                        else if (type == Type::Fire && n == Type::Mud) heat += 1.0f;
+                        else if (self.flammable && n == Type::Fire) heat += self.burnTemp * 0.1f;
+                        else if ((type == Type::Metal || type == Type::Stone) && (n == Type::Fire || n == Type::Lava)) heat += other.burnTemp * 0.5f;
+                        else if (type == Type::Water && n == Type::Fire) heat += other.burnTemp * 0.2f;
+                        else if (type == Type::Sand && n == Type::Water) heat += 1.0f;
+                        else if (type == Type::Lava && (n == Type::Sand || n == Type::Metal)) heat += self.burnTemp * 0.6f;
+                        else if (type == Type::Lava && (n == Type::Water || n == Type::Mud)) heat += 1.0f;
+                        else if (type == Type::Lava && other.flammable) heat += self.burnTemp;
+                        else if (type == Type::Acid && n != Type::Acid) heat += 0.15f;
+                    }
+                }
+            }
+        }
+        return heat;
+    }
+
+    // The table-driven loop PowderScene::applyReactions runs: flat properties, a reaction
+    // mask per element and one matrix lookup per reacting neighbor
+    float tablePass(const std::vector<Type>& grid, const PowderElementTable& table)
+    {
+        float heat = 0.0f;
+        for (int y = 1; y < kGridSize - 1; ++y)
+        {
+            for (int x = 1; x < kGridSize - 1; ++x)
+            {
+                const Type type = grid[y * kGridSize + x];
+                const uint32_t mask = table.getReactionMask(type);
+                if (mask == 0) continue;
+                const PowderParticleProperties& self = table.getProperties(type);
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        if (dx == 0 && dy == 0) continue;
+                        const Type n = grid[(y + dy) * kGridSize + x + dx];
+                        if ((mask & (1u << static_cast<int>(n))) == 0) continue;
+                        const PowderReaction& reaction = table.getReaction(type, n);
+                        switch (reaction.kind)
+                        {
+                        case PowderReactionKind::HeatSelf: heat += table.getProperties(n).burnTemp * reaction.rate; break;
+                        case PowderReactionKind::Heat: heat += self.burnTemp * reaction.rate; break;
+                        case PowderReactionKind::Ignite: heat += table.getProperties(n).ignitionTemp * reaction.rate; break;
+                        case PowderReactionKind::Kindle: heat += self.burnTemp * reaction.rate; break;
+                        case PowderReactionKind::Convert: heat += 1.0f; break;
+                        case PowderReactionKind::Corrode: heat += reaction.chance; break;
+                        default: break;
+                        }
+                    }
+                }
+            }
+        }
+        return heat;
+    }
+}
+
+DX3D_BENCHMARK(PowderReactionThroughput)
+{
+    const std::vector<Type> grid = makeMixedGrid();
+    const PowderElementTable table;
+    std::unordered_map<Type, PowderParticleProperties> props;
+    for (int i = 0; i < PowderParticleTypeCount; ++i)
+        props[static_cast<Type>(i)] = table.getProperties(static_cast<Type>(i));
+
+    const double cells = static_cast<double>(kGridSize - 2) * (kGridSize - 2) * kPasses;
+    {
+        bench::Stopwatch sw;
+        float heat = 0.0f;
+        for (int pass = 0; pass < kPasses; ++pass) heat += legacyPass(grid, props);
+        bench::report("PowderReactionThroughput", "map + branches", cells / (sw.elapsedMs() * 1000.0), "Mcells/s");
+        bench::doNotOptimize(heat);
+    }
+    {
+        bench::Stopwatch sw;
+        float heat = 0.0f;
+        for (int pass = 0; pass < kPasses; ++pass) heat += tablePass(grid, table);
+        bench::report("PowderReactionThroughput", "reaction table", cells / (sw.elapsedMs() * 1000.0), "Mcells/s");
+        bench::doNotOptimize(heat);
+    }
+}
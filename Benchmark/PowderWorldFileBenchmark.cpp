@@ -0,0 +1,144 @@
+#include "Benchmark.h"
+#include <DX3D/Game/Scenes/PowderWorldFile.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kWorldSize = 2048;
+    constexpr int kLoads = 5;
+    const char* const kPath = "PowderWorldFileBenchmark.pwld";
+    const char* const kReplayPath = "PowderWorldFileBenchmark.pwrp";
+
+    // A 4-megacell world shaped like a played-in PowderScene: layered terrain with
+    // noisy material boundaries, a hot lava pocket and a calm air field with one
+    // disturbed region
+    PowderWorldSnapshot makeWorld()
+    {
+        PowderWorldSnapshot world;
+        world.width = kWorldSize;
+        world.height = kWorldSize;
+        world.randomSeed = 12345;
+        world.stepCount = 1000;
+
+        const std::size_t cells = static_cast<std::size_t>(kWorldSize) * kWorldSize;
+        world.type.assign(cells, 0);
+        world.life.assign(cells, 0);
+        world.temperature.assign(cells, world.ambientAirTemp);
+        for (auto* air : { &world.airPressure, &world.airVelocityX, &world.airVelocityY })
+            air->assign(cells, 0.0f);
+        world.airHeat.assign(cells, world.ambientAirTemp);
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> jitter(-2, 2);
+        std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+        for (int x = 0; x < kWorldSize; ++x)
+        {
+            const int stone = 200 + static_cast<int>(60.0f * std::sin(x * 0.01f)) + jitter(rng);
+            const int sand = stone + 150 + jitter(rng);
+            const int water = sand + 100;
+            for (int y = 0; y < water; ++y)
+            {
+                const std::size_t idx = static_cast<std::size_t>(y) * kWorldSize + x;
+                world.type[idx] = (y < stone) ? 3 : (y < sand) ? 1 : 2;
+            }
+        }
+        for (int y = 100; y < 160; ++y)
+        {
+            for (int x = 900; x < 1100; ++x)
+            {
+                const std::size_t idx = static_cast<std::size_t>(y) * kWorldSize + x;
+                world.type[idx] = 11;
+                world.temperature[idx] = 1500.0f + noise(rng);
+            }
+        }
+        for (int y = 1200; y < 1500; ++y)
+        {
+            for (int x = 600; x < 1400; ++x)
+            {
+                const std::size_t idx = static_cast<std::size_t>(y) * kWorldSize + x;
+                world.airVelocityX[idx] = noise(rng);
+                world.airVelocityY[idx] = noise(rng);
+                world.airPressure[idx] = noise(rng) * 4.0f;
+            }
+        }
+        return world;
+    }
+
+    // Saves a small replay holding one edit and reports whether it loads back
+    bool loadsReplayWith(const PowderReplayEvent& edit)
+    {
+        PowderReplay replay;
+        replay.start.width = 64;
+        replay.start.height = 64;
+        replay.start.type.assign(64 * 64, 0);
+        replay.start.life.assign(64 * 64, 0);
+        replay.start.temperature.assign(64 * 64, replay.start.ambientAirTemp);
+        replay.events.push_back(edit);
+        PowderReplay loaded;
+        const bool ok = savePowderReplay(kReplayPath, replay) && loadPowderReplay(kReplayPath, loaded);
+        std::remove(kReplayPath);
+        return ok;
+    }
+
+    double rawBytes(const PowderWorldSnapshot& world)
+    {
+        return static_cast<double>(world.type.size()) * (sizeof(std::uint8_t) + sizeof(std::int16_t) + sizeof(float) * 5);
+    }
+}
+
+DX3D_BENCHMARK(PowderWorldFile)
+{
+    const PowderWorldSnapshot world = makeWorld();
+    const std::uint64_t hash = hashPowderWorld(world);
+
+    bench::Stopwatch saveSw;
+    if (!savePowderWorld(kPath, world))
+    {
+        bench::fail("could not write the world file");
+        return;
+    }
+    const double saveMs = saveSw.elapsedMs();
+
+    std::vector<std::uint8_t> bytes;
+    writePowderWorld(world, bytes);
+
+    double loadMs = 0.0;
+    bool roundTrip = true;
+    for (int i = 0; i < kLoads; ++i)
+    {
+        PowderWorldSnapshot loaded;
+        bench::Stopwatch sw;
+        const bool ok = loadPowderWorld(kPath, loaded);
+        loadMs += sw.elapsedMs();
+        roundTrip = roundTrip && ok && hashPowderWorld(loaded) == hash;
+    }
+    std::remove(kPath);
+
+    bench::report("PowderWorldFile", "world", static_cast<double>(kWorldSize) * kWorldSize / 1e6, "Mcells");
+    bench::report("PowderWorldFile", "raw planes", rawBytes(world) / (1024.0 * 1024.0), "MiB");
+    bench::report("PowderWorldFile", "file", bytes.size() / (1024.0 * 1024.0), "MiB");
+    bench::report("PowderWorldFile", "compression", rawBytes(world) / bytes.size(), "x");
+    bench::report("PowderWorldFile", "save", saveMs, "ms");
+    bench::report("PowderWorldFile", "mapped load", loadMs / kLoads, "ms");
+    bench::check("PowderWorldFile", "round trip hash match", roundTrip);
+
+    PowderReplayEvent edit;
+    edit.particleType = 1;
+    edit.x = 32;
+    edit.y = 32;
+    edit.radius = 4;
+    PowderReplayEvent badKind = edit, badType = edit, negativeRadius = edit, hugeRadius = edit;
+    badKind.kind = static_cast<PowderEditKind>(7);
+    badType.particleType = 0xFF;
+    negativeRadius.radius = -1;
+    hugeRadius.radius = 1 << 30;
+    const bool validated = loadsReplayWith(edit) && !loadsReplayWith(badKind) && !loadsReplayWith(badType) &&
+        !loadsReplayWith(negativeRadius) && !loadsReplayWith(hugeRadius);
+    bench::check("PowderWorldFile", "replay events validated", validated);
+}
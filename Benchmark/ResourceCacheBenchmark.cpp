@@ -0,0 +1,169 @@
+#include "Benchmark.h"
+#include <DX3D/Core/ResourceCache.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kLookups = 200000;     // default for --steps
+    constexpr int kKeys = 64;            // distinct files the lookups cycle through
+    constexpr std::size_t kBytes = 1024; // per fake resource
+
+    // Stands in for a decoded texture: the loader counts how often it really ran
+    struct Blob
+    {
+        std::vector<std::uint8_t> data;
+    };
+
+    using BlobCache = ResourceCache<Blob>;
+
+    BlobCache::Loader blobLoader(int& loads, std::size_t bytes = kBytes)
+    {
+        return [&loads, bytes]()
+        {
+            ++loads;
+            auto blob = std::make_shared<Blob>();
+            blob->data.resize(bytes);
+            return BlobCache::Loaded{ blob, bytes };
+        };
+    }
+
+    // A decode slow enough that skipping it shows up in the timing
+    BlobCache::Loaded decodeBlob(const std::wstring& key)
+    {
+        auto blob = std::make_shared<Blob>();
+        blob->data.resize(kBytes);
+        std::uint8_t h = 0;
+        for (int pass = 0; pass < 4; ++pass)
+            for (std::size_t i = 0; i < blob->data.size(); ++i)
+            {
+                h = static_cast<std::uint8_t>(h * 31 + key[i % key.size()] + pass);
+                blob->data[i] = h;
+            }
+        return { blob, kBytes };
+    }
+
+}
+
+DX3D_BENCHMARK(ResourceCacheLookup)
+{
+    // Keying: the second lookup of a key is a hit returning the same object; a
+    // different key is a separate load
+    {
+        BlobCache cache;
+        int loads = 0;
+        auto a = cache.get(L"node.png", blobLoader(loads));
+        auto b = cache.get(L"node.png", blobLoader(loads));
+        auto c = cache.get(L"Node.png", blobLoader(loads));
+        const auto stats = cache.getStats();
+        const bool ok = a && a == b && c && c != a && loads == 2 && stats.hits == 1 && stats.misses == 2 &&
+            stats.entries == 2 && stats.bytesResident == 2 * kBytes;
+        bench::check("ResourceCacheLookup", "same key shares one load", ok);
+    }
+
+    // Eviction: over budget the least recently used unreferenced entry goes first,
+    // and referenced entries stay however far over budget that leaves the cache
+    {
+        BlobCache cache(3 * kBytes);
+        int loads = 0;
+        cache.get(L"a", blobLoader(loads));
+        cache.get(L"b", blobLoader(loads));
+        cache.get(L"c", blobLoader(loads));
+        cache.get(L"a", blobLoader(loads)); // b is now least recently used
+        cache.get(L"d", blobLoader(loads));
+        bool ok = cache.contains(L"a") && !cache.contains(L"b") && cache.contains(L"c") && cache.contains(L"d") &&
+            cache.getStats().evictions == 1 && cache.getStats().bytesResident == 3 * kBytes;
+
+        auto held = cache.get(L"c", blobLoader(loads));
+        cache.setBudget(0);
+        ok = ok && cache.contains(L"c") && cache.getStats().entries == 1 && cache.getStats().bytesResident == kBytes;
+        held.reset();
+        ok = ok && cache.trim() == 1 && cache.getStats().entries == 0 && cache.getStats().bytesResident == 0;
+        bench::check("ResourceCacheLookup", "LRU eviction skips referenced entries", ok);
+    }
+
+    // Failed loads return nullptr and are retried rather than cached
+    {
+        BlobCache cache;
+        int attempts = 0;
+        auto fail = [&attempts]() { ++attempts; return BlobCache::Loaded{}; };
+        const bool ok = !cache.get(L"missing.png", fail) && !cache.get(L"missing.png", fail) && attempts == 2 &&
+            !cache.contains(L"missing.png") && cache.getStats().bytesResident == 0;
+        bench::check("ResourceCacheLookup", "failed loads not cached", ok);
+    }
+
+    // Prefetch: decoded on a worker, then get() takes the result without loading again.
+    // A failed prefetch is a miss: get() loads the key itself
+    {
+        BlobCache cache;
+        int loads = 0;
+        int prefetched = 0;
+        for (int k = 0; k < kKeys; ++k)
+            cache.prefetch(L"tile" + std::to_wstring(k), blobLoader(prefetched));
+        cache.prefetch(L"bad", []() { return BlobCache::Loaded{}; });
+        cache.waitForPrefetches();
+        bool ok = prefetched == kKeys && cache.getStats().pending == kKeys + 1;
+        for (int k = 0; k < kKeys; ++k)
+            ok = ok && cache.get(L"tile" + std::to_wstring(k), blobLoader(loads)) != nullptr;
+        ok = ok && loads == 0 && cache.get(L"bad", blobLoader(loads)) != nullptr && loads == 1 && cache.contains(L"bad");
+        const auto stats = cache.getStats();
+        ok = ok && stats.hits == static_cast<std::uint64_t>(kKeys) && stats.misses == 1 && stats.pending == 0 &&
+            stats.entries == static_cast<std::size_t>(kKeys) + 1 && stats.bytesResident == (kKeys + 1) * kBytes;
+        bench::check("ResourceCacheLookup", "prefetch then get loads once", ok);
+    }
+
+    // Concurrent gets of the same keys agree on one object per key
+    {
+        BlobCache cache;
+        std::vector<std::shared_ptr<Blob>> seen(4 * kKeys);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&cache, &seen, t]()
+            {
+                for (int k = 0; k < kKeys; ++k)
+                {
+                    const std::wstring key = L"shared" + std::to_wstring(k);
+                    seen[t * kKeys + k] = cache.get(key, [&key]() { return decodeBlob(key); });
+                }
+            });
+        for (auto& thread : threads) thread.join();
+        bool ok = cache.getStats().entries == static_cast<std::size_t>(kKeys);
+        for (int k = 0; k < kKeys; ++k)
+        {
+            const std::wstring key = L"shared" + std::to_wstring(k);
+            auto cached = cache.get(key, [&key]() { return decodeBlob(key); });
+            for (int t = 0; t < 4; ++t) ok = ok && seen[t * kKeys + k] == cached;
+        }
+        bench::check("ResourceCacheLookup", "concurrent gets share one object", ok);
+    }
+
+    // Lookup cost against decoding every time, as each sprite used to
+    const int lookups = bench::steps(kLookups);
+    std::vector<std::wstring> keys;
+    for (int k = 0; k < kKeys; ++k) keys.push_back(L"DX3D/Assets/Textures/sprite" + std::to_wstring(k) + L".png");
+
+    bench::Stopwatch sw;
+    std::size_t sink = 0;
+    for (int i = 0; i < lookups; ++i)
+        sink += decodeBlob(keys[i % kKeys]).resource->data[0];
+    const double decodeMs = sw.elapsedMs();
+
+    BlobCache cache;
+    sw.reset();
+    for (int i = 0; i < lookups; ++i)
+    {
+        const std::wstring& key = keys[i % kKeys];
+        sink += cache.get(key, [&key]() { return decodeBlob(key); })->data[0];
+    }
+    const double cachedMs = sw.elapsedMs();
+    bench::doNotOptimize(sink);
+
+    const auto stats = cache.getStats();
+    bench::report("ResourceCacheLookup", "hit rate", 100.0 * stats.hits / (stats.hits + stats.misses), "%");
+    bench::report("ResourceCacheLookup", "decode every lookup", decodeMs * 1e6 / lookups, "ns/lookup");
+    bench::report("ResourceCacheLookup", "cached lookup", cachedMs * 1e6 / lookups, "ns/lookup");
+    bench::report("ResourceCacheLookup", "speedup", decodeMs / cachedMs, "x");
+}
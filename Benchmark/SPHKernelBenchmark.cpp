@@ -0,0 +1,268 @@
+#include "Benchmark.h"
+#include "SimulationFixtures.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/SPHKernels.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    constexpr int kParticleCount = 200000; // default for --particles
+    constexpr int kSteps = 5;              // default for --steps
+    constexpr int kAllThreads = 0;
+
+    // The scene's SPHParameters
+    SPHFluidConstants sceneFluid()
+    {
+        SPHFluidConstants fluid;
+        fluid.mass = 1.0f;
+        fluid.restDensity = 1000.0f;
+        fluid.minDensity = fluid.restDensity * 0.1f;
+        fluid.gasConstant = 50000.0f;
+        fluid.viscosity = 1.0f + 0.2f;
+        fluid.artificialPressure = 0.05f;
+        fluid.gravity = -500.0f;
+        fluid.maxAcceleration = 5000.0f;
+        return fluid;
+    }
+
+    struct Fluid
+    {
+        std::vector<float> x, y, vx, vy, density, pressure, invDensity, ax, ay;
+
+        void resize(int count)
+        {
+            for (auto* field : { &x, &y, &vx, &vy, &density, &pressure, &invDensity, &ax, &ay }) field->resize(count);
+        }
+
+        SPHFluidFields fields()
+        {
+            SPHFluidFields f;
+            f.x = x.data();
+            f.y = y.data();
+            f.vx = vx.data();
+            f.vy = vy.data();
+            f.density = density.data();
+            f.pressure = pressure.data();
+            f.invDensity = invDensity.data();
+            f.ax = ax.data();
+            f.ay = ay.data();
+            return f;
+        }
+    };
+
+    // The shared lattice in Z-order, as the scene keeps it
+    Fluid makeFluid(int count, FlipParticleGrid& grid)
+    {
+        SPHLattice lattice = makeSPHLattice(count, 22);
+        sortSPHLattice(lattice, grid);
+        Fluid fluid;
+        fluid.resize(count);
+        fluid.x.swap(lattice.x);
+        fluid.y.swap(lattice.y);
+        fluid.vx.swap(lattice.vx);
+        fluid.vy.swap(lattice.vy);
+        return fluid;
+    }
+
+    void runKernels(const SPHKernels& kernels, const SPHNeighborTable& table, Fluid& fluid)
+    {
+        SPHFluidFields fields = fluid.fields();
+        const int count = static_cast<int>(fluid.x.size());
+        JobSystem& jobs = JobSystem::getInstance();
+        jobs.parallelFor(0, count, 256, [&](int begin, int end) { kernels.density(table, fields, begin, end); }, kAllThreads);
+        jobs.parallelFor(0, count, 4096, [&](int begin, int end) { kernels.pressure(fields, begin, end); }, kAllThreads);
+        jobs.parallelFor(0, count, 256, [&](int begin, int end) { kernels.forces(table, fields, begin, end); }, kAllThreads);
+    }
+
+    // The optimized path before this change: the AoS particles copied into the SoA
+    // arrays and back every step, and every pass walking the 3x3 candidate cells,
+    // re-testing and re-sqrting each pair and calling the kernels one pair at a time
+    struct Particle
+    {
+        float x, y, vx, vy, ax, ay, density, pressure;
+    };
+
+    void previousStep(std::vector<Particle>& particles, Fluid& soa, const FlipParticleGrid& grid, const SPHFluidConstants& fluid)
+    {
+        const int count = static_cast<int>(particles.size());
+        JobSystem& jobs = JobSystem::getInstance();
+        for (int i = 0; i < count; ++i)
+        {
+            soa.x[i] = particles[i].x;
+            soa.y[i] = particles[i].y;
+            soa.vx[i] = particles[i].vx;
+            soa.vy[i] = particles[i].vy;
+            soa.ax[i] = particles[i].ax;
+            soa.ay[i] = particles[i].ay;
+            soa.density[i] = particles[i].density;
+            soa.pressure[i] = particles[i].pressure;
+        }
+
+        const std::vector<int>& sorted = grid.getSortedIndices();
+        auto forCandidates = [&](int i, auto&& fn)
+        {
+            const int cell = grid.getParticleCell(i);
+            const int cx = cell % grid.getCellsX();
+            const int cy = cell / grid.getCellsX();
+            for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, grid.getCellsY() - 1); ++y)
+                for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, grid.getCellsX() - 1); ++x)
+                {
+                    const int c = y * grid.getCellsX() + x;
+                    for (int s = grid.getCellStart(c); s < grid.getCellEnd(c); ++s)
+                        if (sorted[s] != i) fn(sorted[s]);
+                }
+        };
+
+        jobs.parallelFor(0, count, 64, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                float density = 0.0f;
+                forCandidates(i, [&](int j)
+                {
+                    const float dx = soa.x[i] - soa.x[j];
+                    const float dy = soa.y[i] - soa.y[j];
+                    const float distance = std::sqrt(dx * dx + dy * dy);
+                    if (distance < kSPHRadius) density += fluid.mass * sphPoly6(distance);
+                });
+                soa.density[i] = std::max(density, fluid.minDensity);
+            }
+        }, kAllThreads);
+        for (int i = 0; i < count; ++i) soa.pressure[i] = fluid.gasConstant * (soa.density[i] - fluid.restDensity);
+        jobs.parallelFor(0, count, 64, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                float pfx = 0.0f, pfy = 0.0f, afx = 0.0f, afy = 0.0f, vfx = 0.0f, vfy = 0.0f;
+                forCandidates(i, [&](int j)
+                {
+                    const float dx = soa.x[i] - soa.x[j];
+                    const float dy = soa.y[i] - soa.y[j];
+                    const float distance = std::sqrt(dx * dx + dy * dy);
+                    if (distance >= kSPHRadius || distance <= 1e-6f) return;
+                    const float pressureTerm = (soa.pressure[i] + soa.pressure[j]) / (2.0f * std::max(1e-3f, soa.density[j]));
+                    const float gradient = sphSpikyGradientFactor(distance);
+                    const float gx = dx * gradient;
+                    const float gy = dy * gradient;
+                    pfx -= gx * fluid.mass * pressureTerm;
+                    pfy -= gy * fluid.mass * pressureTerm;
+                    const float ratio = soa.density[i] / fluid.restDensity;
+                    const float artificialPressure = fluid.artificialPressure * (ratio * ratio * ratio * ratio - 1.0f);
+                    afx -= gx * fluid.mass * artificialPressure;
+                    afy -= gy * fluid.mass * artificialPressure;
+                    const float visc = fluid.viscosity * fluid.mass * sphViscosity(distance) / std::max(1e-3f, soa.density[j]);
+                    vfx += (soa.vx[j] - soa.vx[i]) * visc;
+                    vfy += (soa.vy[j] - soa.vy[i]) * visc;
+                });
+                const float denom = std::max(1e-3f, soa.density[i]);
+                float ax = (pfx + afx + vfx) / denom;
+                float ay = (pfy + afy + vfy) / denom + fluid.gravity;
+                const float magnitude = std::sqrt(ax * ax + ay * ay);
+                if (magnitude > fluid.maxAcceleration)
+                {
+                    ax *= fluid.maxAcceleration / magnitude;
+                    ay *= fluid.maxAcceleration / magnitude;
+                }
+                soa.ax[i] = ax;
+                soa.ay[i] = ay;
+            }
+        }, kAllThreads);
+
+        for (int i = 0; i < count; ++i)
+        {
+            particles[i].ax = soa.ax[i];
+            particles[i].ay = soa.ay[i];
+            particles[i].density = soa.density[i];
+            particles[i].pressure = soa.pressure[i];
+        }
+    }
+
+    bool closeTo(float a, float b, float tolerance) { return std::fabs(a - b) <= tolerance * std::max(1.0f, std::fabs(b)); }
+
+    // Densities within 1e-5 and accelerations within 1e-3 (relative), as SPHNeighbors checks
+    bool sameResults(const Fluid& a, const Fluid& b)
+    {
+        for (std::size_t i = 0; i < a.x.size(); ++i)
+            if (!closeTo(a.density[i], b.density[i], 1e-5f) || !closeTo(a.ax[i], b.ax[i], 1e-3f) || !closeTo(a.ay[i], b.ay[i], 1e-3f))
+                return false;
+        return true;
+    }
+}
+
+DX3D_BENCHMARK(SPHSoAKernels)
+{
+    const int count = bench::particles(kParticleCount);
+    const int steps = bench::steps(kSteps);
+    const SPHFluidConstants fluid = sceneFluid();
+
+    FlipParticleGrid grid;
+    const Fluid initial = makeFluid(count, grid);
+    SPHNeighborTable table;
+    table.build(initial.x.data(), initial.y.data(), count, grid, kSPHRadius, kAllThreads);
+
+    SPHKernels kernels;
+    kernels.setConstants(SPHKernelConstants::forRadius(kSPHRadius), fluid);
+    bench::report("SPHSoAKernels", "widest SIMD (0 scalar, 1 SSE2, 2 AVX2)", static_cast<double>(getSPHSimdSupport()), "");
+
+    // Every instruction set the build has agrees with the scalar reference, and the
+    // scalar reference with the per-pair kernel calls it replaces
+    Fluid scalar = initial;
+    kernels.setSimd(SPHSimd::Scalar);
+    runKernels(kernels, table, scalar);
+
+    Fluid previous = initial;
+    std::vector<Particle> particles(count);
+    for (int i = 0; i < count; ++i) particles[i] = { initial.x[i], initial.y[i], initial.vx[i], initial.vy[i], 0.0f, 0.0f, 0.0f, 0.0f };
+    previousStep(particles, previous, grid, fluid);
+    bench::check("SPHSoAKernels", "scalar matches per-pair kernels", sameResults(scalar, previous));
+
+    for (SPHSimd simd : { SPHSimd::Sse2, SPHSimd::Avx2 })
+    {
+        if (simd > getSPHSimdSupport()) continue;
+        Fluid lanes = initial;
+        kernels.setSimd(simd);
+        runKernels(kernels, table, lanes);
+        bench::check("SPHSoAKernels", (std::string(getSPHSimdName(simd)) + " matches scalar").c_str(), sameResults(lanes, scalar));
+    }
+
+    // Density + pressure + forces per step, with the neighbor table built each step as the scene does
+    bench::Stopwatch sw;
+    for (int s = 0; s < steps; ++s)
+    {
+        grid.build(previous.x.data(), previous.y.data(), count, kAllThreads);
+        previousStep(particles, previous, grid, fluid);
+    }
+    const double previousMs = sw.elapsedMs() / steps;
+    bench::report("SPHSoAKernels", "before: sync + per-pair kernels", previousMs, "ms/step");
+
+    double bestMs = previousMs;
+    for (SPHSimd simd : { SPHSimd::Scalar, SPHSimd::Sse2, SPHSimd::Avx2 })
+    {
+        if (simd > getSPHSimdSupport()) continue;
+        Fluid fluidState = initial;
+        kernels.setSimd(simd);
+        double kernelMs = 0.0;
+        sw.reset();
+        for (int s = 0; s < steps; ++s)
+        {
+            grid.build(fluidState.x.data(), fluidState.y.data(), count, kAllThreads);
+            table.build(fluidState.x.data(), fluidState.y.data(), count, grid, kSPHRadius, kAllThreads);
+            bench::Stopwatch kernelSw;
+            runKernels(kernels, table, fluidState);
+            kernelMs += kernelSw.elapsedMs();
+        }
+        const double totalMs = sw.elapsedMs() / steps;
+        bench::doNotOptimize(fluidState.ax.data());
+        const std::string name = getSPHSimdName(simd);
+        bench::report("SPHSoAKernels", (name + ": kernels").c_str(), kernelMs / steps, "ms/step");
+        bench::report("SPHSoAKernels", (name + ": table + kernels").c_str(), totalMs, "ms/step");
+        bestMs = std::min(bestMs, totalMs);
+    }
+    bench::report("SPHSoAKernels", "speedup, fastest vs before", previousMs / bestMs, "x");
+}
@@ -0,0 +1,293 @@
+#include "Benchmark.h"
+#include "SimulationFixtures.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    constexpr int kParticleCount = 50000; // default for --particles
+    constexpr int kSteps = 10;            // default for --steps
+    constexpr float kMass = 1.0f;
+    constexpr float kRestDensity = 1000.0f;
+    constexpr float kGasConstant = 50000.0f;
+    constexpr float kViscosity = 1.0f;
+    constexpr int kAllThreads = 0; // the scene runs every pass on the whole job system
+
+    struct Float2 { float x, y; };
+    struct Particle
+    {
+        Float2 position;
+        Float2 velocity;
+        Float2 acceleration;
+        float density;
+        float pressure;
+    };
+
+    // Pressure + viscosity acceleration from one neighbor pair
+    void addPairForce(const Particle& pi, const Particle& pj, float rx, float ry, float distance, float& fx, float& fy)
+    {
+        const float pressureTerm = kMass * (pi.pressure + pj.pressure) / (2.0f * pj.density);
+        const float g = sphSpikyGradientFactor(distance);
+        fx -= rx * g * pressureTerm;
+        fy -= ry * g * pressureTerm;
+        const float visc = kViscosity * kMass * sphViscosity(distance) / pj.density;
+        fx += (pj.velocity.x - pi.velocity.x) * visc;
+        fy += (pj.velocity.y - pi.velocity.y) * visc;
+    }
+
+    void computePressure(std::vector<Particle>& particles)
+    {
+        for (auto& p : particles) p.pressure = kGasConstant * (p.density - kRestDensity);
+    }
+
+    // The scene before the neighbor table: per-cell vectors, per-particle candidate
+    // lists from the 3x3 cells, and every pass re-testing and re-sqrting each pair
+    struct LegacyNeighbors
+    {
+        int width = 0, height = 0;
+        float originX = 0.0f, originY = 0.0f;
+        std::vector<std::vector<int>> cells;
+        std::vector<std::vector<int>> neighbors;
+
+        void build(const std::vector<Particle>& particles)
+        {
+            for (auto& cell : cells) cell.clear();
+            for (int i = 0; i < static_cast<int>(particles.size()); ++i)
+            {
+                const int x = std::clamp(static_cast<int>((particles[i].position.x - originX) / kSPHRadius), 0, width - 1);
+                const int y = std::clamp(static_cast<int>((particles[i].position.y - originY) / kSPHRadius), 0, height - 1);
+                cells[y * width + x].push_back(i);
+            }
+            neighbors.resize(particles.size());
+            JobSystem::getInstance().parallelFor(0, static_cast<int>(particles.size()), 64, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    auto& list = neighbors[i];
+                    list.clear();
+                    const int gx = static_cast<int>((particles[i].position.x - originX) / kSPHRadius);
+                    const int gy = static_cast<int>((particles[i].position.y - originY) / kSPHRadius);
+                    for (int y = gy - 1; y <= gy + 1; ++y)
+                        for (int x = gx - 1; x <= gx + 1; ++x)
+                        {
+                            if (x < 0 || x >= width || y < 0 || y >= height) continue;
+                            for (int j : cells[y * width + x])
+                                if (j != i) list.push_back(j);
+                        }
+                }
+            });
+        }
+
+        void densityAndForces(std::vector<Particle>& particles) const
+        {
+            const float radius2 = kSPHRadius * kSPHRadius;
+            const int count = static_cast<int>(particles.size());
+            JobSystem::getInstance().parallelFor(0, count, 64, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    float density = 0.0f;
+                    for (int j : neighbors[i])
+                    {
+                        const float dx = particles[i].position.x - particles[j].position.x;
+                        const float dy = particles[i].position.y - particles[j].position.y;
+                        const float r2 = dx * dx + dy * dy;
+                        if (r2 < radius2) density += kMass * sphPoly6(std::sqrt(std::max(1e-6f, r2)));
+                    }
+                    particles[i].density = std::max(density + kMass * sphPoly6(0.0f), kRestDensity * 0.3f);
+                }
+            });
+            computePressure(particles);
+            JobSystem::getInstance().parallelFor(0, count, 64, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    float fx = 0.0f, fy = 0.0f;
+                    for (int j : neighbors[i])
+                    {
+                        const float dx = particles[i].position.x - particles[j].position.x;
+                        const float dy = particles[i].position.y - particles[j].position.y;
+                        const float r2 = dx * dx + dy * dy;
+                        if (r2 < radius2 && r2 > 1e-12f) addPairForce(particles[i], particles[j], dx, dy, std::sqrt(r2), fx, fy);
+                    }
+                    particles[i].acceleration = { fx / particles[i].density, fy / particles[i].density };
+                }
+            });
+        }
+    };
+
+    void densityAndForces(std::vector<Particle>& particles, const SPHNeighborTable& table)
+    {
+        const int count = static_cast<int>(particles.size());
+        JobSystem::getInstance().parallelFor(0, count, 64, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                float density = 0.0f;
+                for (int k = table.begin(i); k < table.end(i); ++k)
+                    density += kMass * sphPoly6(std::max(1e-3f, table.getDistance(k)));
+                particles[i].density = std::max(density + kMass * sphPoly6(0.0f), kRestDensity * 0.3f);
+            }
+        });
+        computePressure(particles);
+        JobSystem::getInstance().parallelFor(0, count, 64, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                float fx = 0.0f, fy = 0.0f;
+                for (int k = table.begin(i); k < table.end(i); ++k)
+                {
+                    if (table.getR2(k) <= 1e-12f) continue;
+                    const Particle& pj = particles[table.getIndex(k)];
+                    const float dx = particles[i].position.x - pj.position.x;
+                    const float dy = particles[i].position.y - pj.position.y;
+                    addPairForce(particles[i], pj, dx, dy, table.getDistance(k), fx, fy);
+                }
+                particles[i].acceleration = { fx / particles[i].density, fy / particles[i].density };
+            }
+        });
+    }
+
+    struct Timing
+    {
+        double neighborsMs = 0.0;
+        double kernelsMs = 0.0;
+    };
+
+    // The shared lattice in shuffled order, as particles end up after mixing
+    std::vector<Particle> makeParticles(int count, float& side)
+    {
+        const SPHLattice lattice = makeSPHLattice(count, 21);
+        side = lattice.side;
+        std::vector<Particle> particles(count);
+        for (int i = 0; i < count; ++i)
+        {
+            particles[i].position = { lattice.x[i], lattice.y[i] };
+            particles[i].velocity = { lattice.vx[i], lattice.vy[i] };
+        }
+        std::mt19937 rng(bench::seed(21));
+        std::shuffle(particles.begin(), particles.end(), rng);
+        return particles;
+    }
+
+    bool closeTo(float a, float b, float tolerance) { return std::fabs(a - b) <= tolerance * std::max(1.0f, std::fabs(b)); }
+}
+
+DX3D_BENCHMARK(SPHNeighbors)
+{
+    const int count = bench::particles(kParticleCount);
+    const int steps = bench::steps(kSteps);
+    float side = 0.0f;
+    std::vector<Particle> shuffled = makeParticles(count, side);
+
+    LegacyNeighbors legacy;
+    legacy.width = legacy.height = static_cast<int>(std::ceil(side / kSPHRadius));
+    legacy.cells.resize(static_cast<std::size_t>(legacy.width) * legacy.height);
+
+    FlipParticleGrid grid;
+    grid.resize(0.0f, 0.0f, side, side, kSPHRadius);
+    SPHNeighborTable table;
+
+    // The table holds exactly the candidates within the radius, and the passes
+    // reading it agree with the re-testing ones
+    std::vector<Particle> before = shuffled;
+    std::vector<Particle> after = shuffled;
+    legacy.build(before);
+    legacy.densityAndForces(before);
+    grid.build(after, kAllThreads);
+    table.build(after, grid, kSPHRadius, kAllThreads);
+    densityAndForces(after, table);
+
+    bool samePairs = table.getParticleCount() == count;
+    bool sameResults = true;
+    std::vector<int> expected, actual;
+    for (int i = 0; samePairs && i < count; ++i)
+    {
+        expected.clear();
+        for (int j : legacy.neighbors[i])
+        {
+            const float dx = shuffled[i].position.x - shuffled[j].position.x;
+            const float dy = shuffled[i].position.y - shuffled[j].position.y;
+            if (dx * dx + dy * dy < kSPHRadius * kSPHRadius) expected.push_back(j);
+        }
+        actual.clear();
+        for (int k = table.begin(i); k < table.end(i); ++k) actual.push_back(table.getIndex(k));
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        samePairs = expected == actual;
+        sameResults = sameResults && closeTo(after[i].density, before[i].density, 1e-5f) &&
+            closeTo(after[i].acceleration.x, before[i].acceleration.x, 1e-3f) && closeTo(after[i].acceleration.y, before[i].acceleration.y, 1e-3f);
+    }
+    bench::check("SPHNeighbors", "table matches culled candidates", samePairs);
+    bench::check("SPHNeighbors", "density + forces match", sameResults);
+
+    // Z-order (as the scene reorders, from the grid it just built) keeps every particle
+    std::vector<int> order;
+    std::vector<std::uint64_t> cellKeys;
+    std::vector<Particle> zordered(count);
+    bench::Stopwatch sw;
+    mortonOrder(grid, order, cellKeys);
+    for (int k = 0; k < count; ++k) zordered[k] = shuffled[order[k]];
+    const double reorderMs = sw.elapsedMs();
+    std::vector<int> seen(count, 0);
+    for (int i : order) ++seen[i];
+    const bool permutation = static_cast<int>(order.size()) == count && std::all_of(seen.begin(), seen.end(), [](int n) { return n == 1; });
+    bench::check("SPHNeighbors", "z-order is a permutation", permutation);
+
+    auto timeLegacy = [&](std::vector<Particle> particles)
+    {
+        Timing timing;
+        for (int s = 0; s < steps; ++s)
+        {
+            bench::Stopwatch sw;
+            legacy.build(particles);
+            timing.neighborsMs += sw.elapsedMs();
+            sw.reset();
+            legacy.densityAndForces(particles);
+            timing.kernelsMs += sw.elapsedMs();
+        }
+        bench::doNotOptimize(particles.data());
+        return timing;
+    };
+    auto timeTable = [&](std::vector<Particle> particles)
+    {
+        Timing timing;
+        for (int s = 0; s < steps; ++s)
+        {
+            bench::Stopwatch sw;
+            grid.build(particles, kAllThreads);
+            table.build(particles, grid, kSPHRadius, kAllThreads);
+            timing.neighborsMs += sw.elapsedMs();
+            sw.reset();
+            densityAndForces(particles, table);
+            timing.kernelsMs += sw.elapsedMs();
+        }
+        bench::doNotOptimize(particles.data());
+        return timing;
+    };
+
+    const Timing legacyShuffled = timeLegacy(shuffled);
+    const Timing tableShuffled = timeTable(shuffled);
+    const Timing legacyZ = timeLegacy(zordered);
+    const Timing tableZ = timeTable(zordered);
+    auto perStep = [steps](double ms) { return ms / steps; };
+
+    bench::report("SPHNeighbors", "pairs per particle", static_cast<double>(table.getPairCount()) / count, "");
+    bench::report("SPHNeighbors", "before: neighbors", perStep(legacyShuffled.neighborsMs), "ms/step");
+    bench::report("SPHNeighbors", "before: density + forces", perStep(legacyShuffled.kernelsMs), "ms/step");
+    bench::report("SPHNeighbors", "table: neighbors", perStep(tableShuffled.neighborsMs), "ms/step");
+    bench::report("SPHNeighbors", "table: density + forces", perStep(tableShuffled.kernelsMs), "ms/step");
+    bench::report("SPHNeighbors", "before, z-ordered: total", perStep(legacyZ.neighborsMs + legacyZ.kernelsMs), "ms/step");
+    bench::report("SPHNeighbors", "table, z-ordered: neighbors", perStep(tableZ.neighborsMs), "ms/step");
+    bench::report("SPHNeighbors", "table, z-ordered: density + forces", perStep(tableZ.kernelsMs), "ms/step");
+    bench::report("SPHNeighbors", "z-order reorder", reorderMs, "ms");
+    bench::report("SPHNeighbors", "speedup, table + z-order vs before",
+        (legacyShuffled.neighborsMs + legacyShuffled.kernelsMs) / (tableZ.neighborsMs + tableZ.kernelsMs), "x");
+}
@@ -0,0 +1,313 @@
+#include "Benchmark.h"
+#include "SimulationFixtures.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/SPHKernels.h>
+#include <DX3D/Game/Scenes/SPHPairBlocks.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    constexpr int kParticleCount = 200000; // default for --particles
+    constexpr int kSteps = 5;              // default for --steps
+    constexpr int kMaxThreads = 16;
+    constexpr int kCollisionIterations = 2;
+    constexpr int kMaxCollisionNeighbors = 16;
+
+    struct Fluid
+    {
+        std::vector<float> x, y, vx, vy, density, pressure, fx, fy, ax, ay;
+    };
+
+    // The shared lattice in Z-order with densities and pressures from the SoA kernels
+    Fluid makeFluid(int count, FlipParticleGrid& grid, SPHNeighborTable& table)
+    {
+        SPHLattice lattice = makeSPHLattice(count, 23);
+        sortSPHLattice(lattice, grid);
+        Fluid fluid;
+        fluid.x.swap(lattice.x);
+        fluid.y.swap(lattice.y);
+        fluid.vx.swap(lattice.vx);
+        fluid.vy.swap(lattice.vy);
+        for (auto* field : { &fluid.density, &fluid.pressure, &fluid.fx, &fluid.fy, &fluid.ax, &fluid.ay })
+            field->resize(count);
+        table.build(fluid.x.data(), fluid.y.data(), count, grid, kSPHRadius, 0);
+
+        SPHFluidConstants constants;
+        constants.minDensity = constants.restDensity * 0.3f;
+        SPHKernels kernels;
+        kernels.setConstants(SPHKernelConstants::forRadius(kSPHRadius), constants);
+        std::vector<float> invDensity(count);
+        SPHFluidFields fields;
+        fields.x = fluid.x.data();
+        fields.y = fluid.y.data();
+        fields.density = fluid.density.data();
+        fields.pressure = fluid.pressure.data();
+        fields.invDensity = invDensity.data();
+        kernels.density(table, fields, 0, count);
+        kernels.pressure(fields, 0, count);
+        return fluid;
+    }
+
+    // SPHFluidSimulationScene::pairForces on SoA fields
+    struct PairForces
+    {
+        SPHKernelConstants kernel = SPHKernelConstants::forRadius(kSPHRadius);
+        float mass = 1.0f;
+        float restDensity = 1000.0f;
+        float viscosity = 1.0f + 0.2f;
+        float artificialPressure = 0.05f;
+
+        void operator()(const Fluid& f, int i, int j, float distance, float& onIx, float& onIy, float& onJx, float& onJy) const
+        {
+            const float t = 1.0f - distance * kernel.invH;
+            const float gradientScale = -kernel.spikyGradient * t * t / distance;
+            const float gx = (f.x[i] - f.x[j]) * gradientScale;
+            const float gy = (f.y[i] - f.y[j]) * gradientScale;
+            const float q = std::max(distance * kernel.invH, 1e-6f);
+            const float visc = viscosity * mass * kernel.viscosity * (-0.5f * q * q * q + q * q + 0.5f / q - 1.0f);
+            const float pressureSum = f.pressure[i] + f.pressure[j];
+            const float ratioA = f.density[i] / restDensity;
+            const float ratioB = f.density[j] / restDensity;
+            const float artificialA = artificialPressure * (ratioA * ratioA * ratioA * ratioA - 1.0f);
+            const float artificialB = artificialPressure * (ratioB * ratioB * ratioB * ratioB - 1.0f);
+            const float scaleI = -mass * (pressureSum / (2.0f * f.density[j]) + artificialA);
+            const float scaleJ = mass * (pressureSum / (2.0f * f.density[i]) + artificialB);
+            const float dvx = f.vx[j] - f.vx[i];
+            const float dvy = f.vy[j] - f.vy[i];
+            onIx = gx * scaleI + dvx * (visc / f.density[j]);
+            onIy = gy * scaleI + dvy * (visc / f.density[j]);
+            onJx = gx * scaleJ - dvx * (visc / f.density[i]);
+            onJy = gy * scaleJ - dvy * (visc / f.density[i]);
+        }
+    };
+
+    void accelerate(JobSystem& jobs, Fluid& f)
+    {
+        jobs.parallelFor(0, static_cast<int>(f.x.size()), 1024, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                float ax = f.fx[i] / f.density[i];
+                float ay = f.fy[i] / f.density[i] - 500.0f;
+                const float magnitude = std::sqrt(ax * ax + ay * ay);
+                if (magnitude > 5000.0f)
+                {
+                    ax *= 5000.0f / magnitude;
+                    ay *= 5000.0f / magnitude;
+                }
+                f.ax[i] = ax;
+                f.ay[i] = ay;
+            }
+        });
+    }
+
+    // Every pair from both sides
+    void gatherForces(JobSystem& jobs, const SPHNeighborTable& table, const PairForces& pair, Fluid& f)
+    {
+        jobs.parallelFor(0, static_cast<int>(f.x.size()), 64, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                float fx = 0.0f, fy = 0.0f;
+                for (int k = table.begin(i); k < table.end(i); ++k)
+                {
+                    if (table.getR2(k) <= 1e-12f) continue;
+                    float onIx, onIy, onJx, onJy;
+                    pair(f, i, table.getIndex(k), table.getDistance(k), onIx, onIy, onJx, onJy);
+                    fx += onIx;
+                    fy += onIy;
+                }
+                f.fx[i] = fx;
+                f.fy[i] = fy;
+            }
+        });
+        accelerate(jobs, f);
+    }
+
+    // Pairs (i, j > i) of particle i into forces
+    void scatterPairs(const SPHNeighborTable& table, const PairForces& pair, const Fluid& f, int i, float* fx, float* fy)
+    {
+        for (int k = table.begin(i); k < table.end(i); ++k)
+        {
+            const int j = table.getIndex(k);
+            if (j <= i || table.getR2(k) <= 1e-12f) continue;
+            float onIx, onIy, onJx, onJy;
+            pair(f, i, j, table.getDistance(k), onIx, onIy, onJx, onJy);
+            fx[i] += onIx;
+            fy[i] += onIy;
+            fx[j] += onJx;
+            fy[j] += onJy;
+        }
+    }
+
+    void perThreadForces(JobSystem& jobs, SPHThreadAccumulators& sums, const SPHNeighborTable& table, const PairForces& pair, Fluid& f)
+    {
+        const int count = static_cast<int>(f.x.size());
+        sums.begin(count);
+        jobs.parallelFor(0, count, 64, [&](int begin, int end)
+        {
+            SPHThreadAccumulators::Buffer forces = sums.local();
+            for (int i = begin; i < end; ++i) scatterPairs(table, pair, f, i, forces.x, forces.y);
+        });
+        sums.reduce(f.fx.data(), f.fy.data());
+        accelerate(jobs, f);
+    }
+
+    void coloredForces(JobSystem& jobs, const SPHPairBlocks& blocks, const SPHNeighborTable& table, const PairForces& pair, Fluid& f)
+    {
+        std::fill(f.fx.begin(), f.fx.end(), 0.0f);
+        std::fill(f.fy.begin(), f.fy.end(), 0.0f);
+        blocks.forEachBlock([&](int, const int* particles, int count)
+        {
+            for (int n = 0; n < count; ++n) scatterPairs(table, pair, f, particles[n], f.fx.data(), f.fy.data());
+        });
+        accelerate(jobs, f);
+    }
+
+    // SPHFluidSimulationScene::resolveCollisionsBlocked on SoA fields
+    void coloredCollisions(const SPHPairBlocks& blocks, const SPHNeighborTable& table, Fluid& f)
+    {
+        const float diameter = kSPHParticleRadius * 2.0f;
+        const float target = diameter * 0.95f;
+        const float slop = diameter * 0.1f;
+        for (int iteration = 0; iteration < kCollisionIterations; ++iteration)
+        {
+            blocks.forEachBlock([&](int, const int* particles, int count)
+            {
+                for (int n = 0; n < count; ++n)
+                {
+                    const int i = particles[n];
+                    int processed = 0;
+                    for (int k = table.begin(i); k < table.end(i); ++k)
+                    {
+                        const int j = table.getIndex(k);
+                        if (j <= i) continue;
+                        if (processed++ >= kMaxCollisionNeighbors) break;
+                        const float dx = f.x[j] - f.x[i];
+                        const float dy = f.y[j] - f.y[i];
+                        const float dist2 = dx * dx + dy * dy;
+                        if (dist2 >= target * target || dist2 <= 1e-6f) continue;
+                        const float dist = std::sqrt(dist2);
+                        const float overlap = target - dist;
+                        if (overlap <= slop) continue;
+                        const float nx = dx / dist;
+                        const float ny = dy / dist;
+                        const float separation = (overlap - slop) * 0.4f;
+                        f.x[i] -= nx * separation;
+                        f.y[i] -= ny * separation;
+                        f.x[j] += nx * separation;
+                        f.y[j] += ny * separation;
+                        const float relVelN = (f.vx[j] - f.vx[i]) * nx + (f.vy[j] - f.vy[i]) * ny;
+                        if (relVelN < -5.0f)
+                        {
+                            const float correction = -relVelN * 0.1f;
+                            f.vx[i] += nx * correction;
+                            f.vy[i] += ny * correction;
+                            f.vx[j] -= nx * correction;
+                            f.vy[j] -= ny * correction;
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    bool identical(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+
+    // Accelerations within 5 (1e-3 of the 5000 clamp): the pair sums cancel, so a
+    // different summation order is measured against the clamp, not the particle's value
+    bool sameAccelerations(const Fluid& a, const Fluid& b)
+    {
+        for (std::size_t i = 0; i < a.ax.size(); ++i)
+            if (std::fabs(a.ax[i] - b.ax[i]) > 5.0f || std::fabs(a.ay[i] - b.ay[i]) > 5.0f) return false;
+        return true;
+    }
+}
+
+DX3D_BENCHMARK(SPHPairScaling)
+{
+    const int count = bench::particles(kParticleCount);
+    const int steps = bench::steps(kSteps);
+
+    FlipParticleGrid grid;
+    SPHNeighborTable table;
+    const Fluid initial = makeFluid(count, grid, table);
+    const PairForces pair;
+    bench::report("SPHPairScaling", "hardware threads", std::max(1u, std::thread::hardware_concurrency()), "");
+
+    // Strong scaling: the same fluid on 1 to 16 threads. Forces three ways (each pair
+    // from both sides, each pair once into per-thread sums, each pair once through
+    // colored blocks) and the colored collision pass; the colored results must not
+    // change with the thread count.
+    Fluid gatherOne, coloredOne, collidedOne;
+    double gatherOneMs = 0.0, perThreadOneMs = 0.0, coloredOneMs = 0.0, collisionOneMs = 0.0;
+    bool coloredDeterministic = true;
+    bool perThreadMatches = true;
+    bool coloredMatches = true;
+    char metric[64];
+    for (int threads = 1; threads <= kMaxThreads; threads *= 2)
+    {
+        JobSystem jobs(threads - 1);
+        SPHPairBlocks blocks(jobs);
+        SPHThreadAccumulators sums(jobs);
+        blocks.build(grid, kSPHRadius, 0);
+
+        Fluid gathered = initial, perThread = initial, colored = initial, collided = initial;
+        bench::Stopwatch sw;
+        for (int s = 0; s < steps; ++s) gatherForces(jobs, table, pair, gathered);
+        const double gatherMs = sw.elapsedMs() / steps;
+        sw.reset();
+        for (int s = 0; s < steps; ++s) perThreadForces(jobs, sums, table, pair, perThread);
+        const double perThreadMs = sw.elapsedMs() / steps;
+        sw.reset();
+        for (int s = 0; s < steps; ++s) coloredForces(jobs, blocks, table, pair, colored);
+        const double coloredMs = sw.elapsedMs() / steps;
+        sw.reset();
+        for (int s = 0; s < steps; ++s) coloredCollisions(blocks, table, collided);
+        const double collisionMs = sw.elapsedMs() / steps;
+        bench::doNotOptimize(collided.x.data());
+
+        if (threads == 1)
+        {
+            gatherOne = gathered;
+            coloredOne = colored;
+            collidedOne = collided;
+            gatherOneMs = gatherMs;
+            perThreadOneMs = perThreadMs;
+            coloredOneMs = coloredMs;
+            collisionOneMs = collisionMs;
+        }
+        coloredDeterministic = coloredDeterministic && identical(colored.ax, coloredOne.ax) && identical(colored.ay, coloredOne.ay)
+            && identical(collided.x, collidedOne.x) && identical(collided.y, collidedOne.y);
+        perThreadMatches = perThreadMatches && sameAccelerations(perThread, gatherOne);
+        coloredMatches = coloredMatches && sameAccelerations(colored, gatherOne);
+
+        std::snprintf(metric, sizeof(metric), "gather forces threads=%d", threads);
+        bench::report("SPHPairScaling", metric, gatherMs, "ms/step");
+        std::snprintf(metric, sizeof(metric), "per-thread forces threads=%d", threads);
+        bench::report("SPHPairScaling", metric, perThreadMs, "ms/step");
+        std::snprintf(metric, sizeof(metric), "colored forces threads=%d", threads);
+        bench::report("SPHPairScaling", metric, coloredMs, "ms/step");
+        std::snprintf(metric, sizeof(metric), "colored collisions threads=%d", threads);
+        bench::report("SPHPairScaling", metric, collisionMs, "ms/step");
+        std::snprintf(metric, sizeof(metric), "speedup vs 1 thread, colored forces threads=%d", threads);
+        bench::report("SPHPairScaling", metric, coloredOneMs / coloredMs, "x");
+        std::snprintf(metric, sizeof(metric), "speedup vs 1 thread, collisions threads=%d", threads);
+        bench::report("SPHPairScaling", metric, collisionOneMs / collisionMs, "x");
+    }
+    bench::check("SPHPairScaling", "colored identical for every thread count", coloredDeterministic);
+    bench::check("SPHPairScaling", "per-thread forces match gather", perThreadMatches);
+    bench::check("SPHPairScaling", "colored forces match gather", coloredMatches);
+    bench::report("SPHPairScaling", "1 thread speedup, each pair once vs gather", gatherOneMs / std::min(perThreadOneMs, coloredOneMs), "x");
+}
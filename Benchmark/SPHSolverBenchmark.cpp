@@ -0,0 +1,162 @@
+#include "Benchmark.h"
+#include "SimulationFixtures.h"
+#include <DX3D/Game/Scenes/SPHKernels.h>
+#include <DX3D/Game/Scenes/SPHPairBlocks.h>
+#include <DX3D/Game/Scenes/SPHPositionSolver.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    constexpr int kParticleCount = 1600;  // default for --particles: 20 rows, about the scene's pool depth
+    constexpr int kSimSeconds = 3;        // default for --steps: simulated seconds per run
+    constexpr int kColumns = 80;          // tank width in particles
+    constexpr int kPositionIterations = SPHPositionSolverSettings{}.iterations; // SPHFluidSimulationScene's default
+
+    struct Solver
+    {
+        FlipParticleGrid grid;
+        SPHNeighborTable table;
+        SPHPairBlocks blocks;
+        SPHKernels kernels;
+        SPHPositionSolver positions;
+
+        void buildNeighbors(SPHTank& t)
+        {
+            const int count = static_cast<int>(t.x.size());
+            grid.build(t.x.data(), t.y.data(), count, 0);
+            table.build(t.x.data(), t.y.data(), count, grid, kSPHRadius, 0);
+        }
+
+        // SPHFluidSimulationScene::stepSPHOptimized: gas-law forces, damped integration,
+        // two colored collision iterations, then the boundaries
+        void stepEquationOfState(SPHTank& t, float dt)
+        {
+            buildNeighbors(t);
+            blocks.build(grid, kSPHRadius, 0);
+            integrateSPHForces(t, table, kernels, dt);
+            for (int iteration = 0; iteration < 2; ++iteration)
+            {
+                blocks.forEachBlock([&](int, const int* particles, int n)
+                {
+                    for (int p = 0; p < n; ++p) resolveSPHCollisions(t, table, particles[p]);
+                });
+            }
+            enforceSPHBoundaries(t);
+        }
+
+        // SPHFluidSimulationScene::stepPositionBased
+        void stepPositionBased(SPHTank& t, float dt)
+        {
+            const int count = static_cast<int>(t.x.size());
+            SPHPositionFields fields = getSPHPositionFields(t);
+            positions.predict(fields, count, dt);
+            buildNeighbors(t);
+            blocks.build(grid, kSPHRadius, 0);
+            positions.solve(table, blocks, fields, count, dt);
+            enforceSPHBoundaries(t);
+        }
+    };
+
+    struct Run
+    {
+        double wallSeconds = 0.0;
+        float compression = 0.0f; // 1 - settled mean height / rest mean height
+        float speed = 0.0f;       // mean speed as a fraction of the free-fall speed
+        bool stable = false;
+    };
+
+    Run simulate(SPHSolverMode mode, int count, float dt, float seconds, int iterations)
+    {
+        SPHTank tank = makeSPHTank(count, kColumns, kColumns);
+        Solver solver;
+        solver.grid.resize(-kSPHRadius, -kSPHRadius, tank.width + 2.0f * kSPHRadius, tank.height + 2.0f * kSPHRadius, kSPHRadius);
+        setUpSPHKernels(solver.kernels);
+        SPHPositionSolverSettings settings = getSPHPositionSettings(tank);
+        settings.iterations = iterations;
+        solver.positions.setSettings(kSPHRadius, settings);
+
+        const int steps = static_cast<int>(std::ceil(seconds / dt));
+        bench::Stopwatch sw;
+        for (int s = 0; s < steps; ++s)
+        {
+            if (mode == SPHSolverMode::PositionBased) solver.stepPositionBased(tank, dt);
+            else solver.stepEquationOfState(tank, dt);
+        }
+        Run run;
+        run.wallSeconds = sw.elapsedMs() / 1000.0;
+
+        // Settled: finite and slow (mean speed under 5% of the free-fall speed); the
+        // compression is measured by the column's mean height
+        double meanY = 0.0;
+        double meanSpeed = 0.0;
+        bool finite = true;
+        for (int i = 0; i < count; ++i)
+        {
+            finite = finite && std::isfinite(tank.x[i]) && std::isfinite(tank.y[i]);
+            meanSpeed += std::sqrt(tank.vx[i] * tank.vx[i] + tank.vy[i] * tank.vy[i]);
+            meanY += tank.y[i];
+        }
+        meanY /= count;
+        meanSpeed /= count;
+        run.compression = 1.0f - static_cast<float>(meanY) / tank.restMeanY;
+        run.speed = static_cast<float>(meanSpeed) / tank.fallSpeed;
+        run.stable = finite && run.speed < 0.05f;
+        return run;
+    }
+}
+
+DX3D_BENCHMARK(SPHSolverModes)
+{
+    const int count = bench::particles(kParticleCount);
+    const float seconds = static_cast<float>(bench::steps(kSimSeconds));
+
+    // Each solver over a range of steps: where it still settles, how much the column
+    // compresses, and simulated seconds per wall second
+    char metric[96];
+    const float scales[] = { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f };
+    Run eos[6], pbf[6];
+    for (int k = 0; k < 6; ++k)
+    {
+        const float dt = kSceneDt * scales[k];
+        eos[k] = simulate(SPHSolverMode::EquationOfState, count, dt, seconds, 0);
+        pbf[k] = simulate(SPHSolverMode::PositionBased, count, dt, seconds, kPositionIterations);
+        for (int m = 0; m < 2; ++m)
+        {
+            const Run& run = m == 0 ? eos[k] : pbf[k];
+            const char* name = m == 0 ? "EOS" : "PBF";
+            std::snprintf(metric, sizeof(metric), "%s dt=%.2fx scene: settled", name, scales[k]);
+            bench::report("SPHSolverModes", metric, run.stable ? 1.0 : 0.0, "");
+            std::snprintf(metric, sizeof(metric), "%s dt=%.2fx scene: mean speed", name, scales[k]);
+            bench::report("SPHSolverModes", metric, run.speed * 100.0, "% fall");
+            std::snprintf(metric, sizeof(metric), "%s dt=%.2fx scene: compression", name, scales[k]);
+            bench::report("SPHSolverModes", metric, run.compression * 100.0, "%");
+            std::snprintf(metric, sizeof(metric), "%s dt=%.2fx scene: sim/wall", name, scales[k]);
+            bench::report("SPHSolverModes", metric, seconds / run.wallSeconds, "s/s");
+        }
+    }
+
+    // Equal compression: the largest step each solver settles at without its height
+    // straying from rest further than the current solver's does at the scene's step
+    // (which never settles here, so it is only held to the compression)
+    const float budget = std::fabs(eos[2].compression) + 0.005f;
+    int bestEos = 2, bestPbf = -1;
+    for (int k = 0; k < 6; ++k)
+    {
+        if (k > 2 && eos[k].stable && std::fabs(eos[k].compression) <= budget) bestEos = k;
+        if (pbf[k].stable && std::fabs(pbf[k].compression) <= budget) bestPbf = k;
+    }
+    bench::report("SPHSolverModes", "compression budget (EOS at scene dt)", budget * 100.0, "%");
+    bench::report("SPHSolverModes", "EOS largest dt within budget", scales[bestEos], "x scene");
+    if (bestPbf >= 0)
+    {
+        bench::report("SPHSolverModes", "PBF largest dt within budget", scales[bestPbf], "x scene");
+        bench::report("SPHSolverModes", "PBF vs EOS sim/wall at those steps",
+            eos[bestEos].wallSeconds / pbf[bestPbf].wallSeconds, "x");
+    }
+}
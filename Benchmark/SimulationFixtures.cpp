@@ -0,0 +1,229 @@
+#include "SimulationFixtures.h"
+#include "Benchmark.h"
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace dx3d::bench
+{
+    namespace
+    {
+        const SPHKernelConstants SceneKernel = SPHKernelConstants::forRadius(kSPHRadius);
+    }
+
+    SPHTank makeSPHTank(int count, int columns, int tankColumns)
+    {
+        SPHTank tank;
+        const int rows = (count + columns - 1) / columns;
+        tank.width = (tankColumns - 1) * kSPHRestSpacing;
+        tank.height = 1.5f * rows * kSPHRestSpacing;
+        double restSum = 0.0;
+        for (int i = 0; i < count; ++i)
+        {
+            tank.x.push_back((i % columns) * kSPHRestSpacing);
+            tank.y.push_back((i / columns) * kSPHRestSpacing * 1.3f);
+            restSum += (i / columns) * kSPHRestSpacing;
+        }
+        for (auto* field : { &tank.vx, &tank.vy, &tank.density, &tank.pressure, &tank.invDensity, &tank.ax, &tank.ay })
+            field->assign(count, 0.0f);
+        tank.restMeanY = static_cast<float>(restSum / count);
+        tank.fallSpeed = std::sqrt(2.0f * -kSPHGravity * rows * kSPHRestSpacing);
+        return tank;
+    }
+
+    void enforceSPHBoundaries(SPHTank& t)
+    {
+        for (std::size_t i = 0; i < t.x.size(); ++i)
+        {
+            float nx = 0.0f, ny = 0.0f;
+            if (t.x[i] < 0.0f) { t.x[i] = 0.0f; nx = 1.0f; }
+            else if (t.x[i] > t.width) { t.x[i] = t.width; nx = -1.0f; }
+            if (t.y[i] < 0.0f) { t.y[i] = 0.0f; nx = 0.0f; ny = 1.0f; }
+            else if (t.y[i] > t.height) { t.y[i] = t.height; nx = 0.0f; ny = -1.0f; }
+            const float vn = t.vx[i] * nx + t.vy[i] * ny;
+            if (vn < 0.0f)
+            {
+                t.vx[i] = (t.vx[i] - nx * vn * 1.1f) * 0.98f;
+                t.vy[i] = (t.vy[i] - ny * vn * 1.1f) * 0.98f;
+            }
+        }
+    }
+
+    SPHFluidFields getSPHFluidFields(SPHTank& t)
+    {
+        SPHFluidFields fields;
+        fields.x = t.x.data();
+        fields.y = t.y.data();
+        fields.vx = t.vx.data();
+        fields.vy = t.vy.data();
+        fields.density = t.density.data();
+        fields.pressure = t.pressure.data();
+        fields.invDensity = t.invDensity.data();
+        fields.ax = t.ax.data();
+        fields.ay = t.ay.data();
+        return fields;
+    }
+
+    SPHPositionFields getSPHPositionFields(SPHTank& t)
+    {
+        SPHPositionFields fields;
+        fields.x = t.x.data();
+        fields.y = t.y.data();
+        fields.vx = t.vx.data();
+        fields.vy = t.vy.data();
+        fields.density = t.density.data();
+        return fields;
+    }
+
+    void setUpSPHKernels(SPHKernels& kernels)
+    {
+        SPHFluidConstants fluid;
+        fluid.minDensity = fluid.restDensity * 0.1f;
+        fluid.viscosity = 1.0f + 0.2f;
+        kernels.setConstants(SPHKernelConstants::forRadius(kSPHRadius), fluid);
+    }
+
+    SPHPositionSolverSettings getSPHPositionSettings(const SPHTank& t)
+    {
+        SPHPositionSolverSettings settings;
+        settings.restSpacing = kSPHRestSpacing;
+        settings.gravity = kSPHGravity;
+        settings.minX = 0.0f;
+        settings.minY = 0.0f;
+        settings.maxX = t.width;
+        settings.maxY = t.height;
+        return settings;
+    }
+
+    void integrateSPHForces(SPHTank& t, const SPHNeighborTable& table, SPHKernels& kernels, float dt)
+    {
+        const int count = static_cast<int>(t.x.size());
+        SPHFluidFields fields = getSPHFluidFields(t);
+        JobSystem& jobs = JobSystem::getInstance();
+        jobs.parallelFor(0, count, 256, [&](int b, int e) { kernels.density(table, fields, b, e); });
+        jobs.parallelFor(0, count, 4096, [&](int b, int e) { kernels.pressure(fields, b, e); });
+        jobs.parallelFor(0, count, 256, [&](int b, int e) { kernels.forces(table, fields, b, e); });
+        for (int i = 0; i < count; ++i)
+        {
+            t.vx[i] = (t.vx[i] + t.ax[i] * dt) * 0.99f;
+            t.vy[i] = (t.vy[i] + t.ay[i] * dt) * 0.99f;
+            t.x[i] += t.vx[i] * dt;
+            t.y[i] += t.vy[i] * dt;
+        }
+    }
+
+    void resolveSPHCollisions(SPHTank& t, const SPHNeighborTable& table, int i)
+    {
+        const float target = kSPHRestSpacing;
+        const float slop = kSPHParticleRadius * 2.0f * 0.1f;
+        int processed = 0;
+        for (int k = table.begin(i); k < table.end(i); ++k)
+        {
+            const int j = table.getIndex(k);
+            if (j <= i) continue;
+            if (processed++ >= 16) break;
+            const float dx = t.x[j] - t.x[i];
+            const float dy = t.y[j] - t.y[i];
+            const float dist2 = dx * dx + dy * dy;
+            if (dist2 >= target * target || dist2 <= 1e-6f) continue;
+            const float dist = std::sqrt(dist2);
+            const float overlap = target - dist;
+            if (overlap <= slop) continue;
+            const float nx = dx / dist, ny = dy / dist;
+            const float separation = (overlap - slop) * 0.4f;
+            t.x[i] -= nx * separation;
+            t.y[i] -= ny * separation;
+            t.x[j] += nx * separation;
+            t.y[j] += ny * separation;
+            const float relVelN = (t.vx[j] - t.vx[i]) * nx + (t.vy[j] - t.vy[i]) * ny;
+            if (relVelN < -5.0f)
+            {
+                const float correction = -relVelN * 0.1f;
+                t.vx[i] += nx * correction;
+                t.vy[i] += ny * correction;
+                t.vx[j] -= nx * correction;
+                t.vy[j] -= ny * correction;
+            }
+        }
+    }
+
+    SPHLattice makeSPHLattice(int count, std::uint32_t seed)
+    {
+        SPHLattice lattice;
+        const int perRow = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        lattice.side = (perRow + 2) * kSPHLatticeSpacing;
+        std::mt19937 rng(bench::seed(seed));
+        std::uniform_real_distribution<float> jitter(-0.3f * kSPHLatticeSpacing, 0.3f * kSPHLatticeSpacing);
+        std::uniform_real_distribution<float> speed(-50.0f, 50.0f);
+        for (auto* field : { &lattice.x, &lattice.y, &lattice.vx, &lattice.vy })
+            field->resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            lattice.x[i] = (1 + i % perRow) * kSPHLatticeSpacing + jitter(rng);
+            lattice.y[i] = (1 + i / perRow) * kSPHLatticeSpacing + jitter(rng);
+            lattice.vx[i] = speed(rng);
+            lattice.vy[i] = speed(rng);
+        }
+        return lattice;
+    }
+
+    void sortSPHLattice(SPHLattice& lattice, FlipParticleGrid& grid)
+    {
+        const int count = static_cast<int>(lattice.x.size());
+        grid.resize(0.0f, 0.0f, lattice.side, lattice.side, kSPHRadius);
+        grid.build(lattice.x.data(), lattice.y.data(), count, 0);
+        std::vector<int> order;
+        std::vector<std::uint64_t> cellKeys;
+        mortonOrder(grid, order, cellKeys);
+        std::vector<float> sorted(count);
+        for (auto* field : { &lattice.x, &lattice.y, &lattice.vx, &lattice.vy })
+        {
+            for (int k = 0; k < count; ++k) sorted[k] = (*field)[order[k]];
+            field->swap(sorted);
+        }
+        grid.build(lattice.x.data(), lattice.y.data(), count, 0);
+    }
+
+    float sphPoly6(float distance)
+    {
+        if (distance >= SceneKernel.h) return 0.0f;
+        const float t = 1.0f - distance * distance * SceneKernel.invH2;
+        return SceneKernel.poly6 * t * t * t;
+    }
+
+    float sphSpikyGradientFactor(float distance)
+    {
+        if (distance >= SceneKernel.h || distance < 1e-6f) return 0.0f;
+        const float t = 1.0f - distance * SceneKernel.invH;
+        return -SceneKernel.spikyGradient * t * t / distance;
+    }
+
+    float sphViscosity(float distance)
+    {
+        if (distance >= SceneKernel.h) return 0.0f;
+        const float q = std::max(distance * SceneKernel.invH, 1e-6f);
+        return SceneKernel.viscosity * (-0.5f * q * q * q + q * q + 0.5f / q - 1.0f);
+    }
+
+    FlipPool makeFlipPool(int count, float target, float room, float maxSpeed, std::uint32_t seed, bool shuffled)
+    {
+        FlipPool pool;
+        const int columns = static_cast<int>(std::sqrt(count * 2.0f));
+        const float spacing = target * 0.9f;
+        pool.width = (columns + 2) * spacing * room;
+        pool.height = (count / columns + 2) * spacing * room;
+
+        std::mt19937 rng(bench::seed(seed));
+        std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+        std::uniform_real_distribution<float> speed(-maxSpeed, maxSpeed);
+        pool.particles.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            pool.particles[i].position = { (i % columns + 1) * spacing + jitter(rng), (i / columns + 1) * spacing + jitter(rng) };
+            pool.particles[i].velocity = { speed(rng), speed(rng) };
+        }
+        if (shuffled) std::shuffle(pool.particles.begin(), pool.particles.end(), rng);
+        return pool;
+    }
+}
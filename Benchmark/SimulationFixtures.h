@@ -0,0 +1,86 @@
+#pragma once
+#include <DX3D/Game/Scenes/SPHKernels.h>
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
+#include <DX3D/Game/Scenes/SPHPositionSolver.h>
+#include <cstdint>
+#include <vector>
+
+// Particle set-ups and scene passes shared by the SPH and FLIP benchmarks, so every
+// benchmark measures the same tank, pool and collision pass as the others.
+namespace dx3d::bench
+{
+    constexpr float kSPHRadius = 25.0f;        // SPHFluidSimulationScene's smoothing radius
+    constexpr float kSPHParticleRadius = 4.0f;
+    constexpr float kSPHRestSpacing = kSPHParticleRadius * 2.0f * 0.95f; // the collision pass's target distance
+    constexpr float kSPHGravity = -500.0f;
+    constexpr float kSceneDt = 1.0f / 60.0f;   // one stepSPH per fixed update
+
+    // SoA particle state of the SPH scene's optimized path
+    struct SPHTank
+    {
+        std::vector<float> x, y, vx, vy, density, pressure, invDensity, ax, ay;
+        float width = 0.0f;     // particle centers stay in [0, width] x [0, height]
+        float height = 0.0f;
+        float restMeanY = 0.0f; // mean height of the same particles packed at kSPHRestSpacing
+        float fallSpeed = 0.0f; // free-fall speed over the column's height
+    };
+
+    // A column columns particles wide in a tank tankColumns rest spacings wide, rows 30%
+    // further apart than at rest, so it drops and settles (or spreads) under its own weight
+    SPHTank makeSPHTank(int count, int columns, int tankColumns);
+    // Clamp into the tank and reflect, as SPHFluidSimulationScene::resolveParticleBoundaryCollisions
+    void enforceSPHBoundaries(SPHTank& t);
+
+    SPHFluidFields getSPHFluidFields(SPHTank& t);
+    SPHPositionFields getSPHPositionFields(SPHTank& t);
+    // The scene's fluid constants on the SoA kernels
+    void setUpSPHKernels(SPHKernels& kernels);
+    // The scene's position-based settings, boxed to the tank
+    SPHPositionSolverSettings getSPHPositionSettings(const SPHTank& t);
+
+    // stepSPHOptimized before the collisions: gas-law forces and damped integration
+    void integrateSPHForces(SPHTank& t, const SPHNeighborTable& table, SPHKernels& kernels, float dt);
+    // One particle of the scene's collision pass: separates i from its first 16
+    // higher-index neighbors in the table and damps their approach
+    void resolveSPHCollisions(SPHTank& t, const SPHNeighborTable& table, int i);
+
+    // SPH kernel and neighbor benchmarks: count particles on a square lattice
+    // kSPHLatticeSpacing apart, jittered by up to 30% of the spacing and moving at
+    // up to 50 along each axis. The seed is overridable by --seed
+    constexpr float kSPHLatticeSpacing = 10.0f; // ~20 neighbors per particle, like the settled scene
+
+    struct SPHLattice
+    {
+        std::vector<float> x, y, vx, vy;
+        float side = 0.0f; // particle centers stay in [0, side] on both axes
+    };
+
+    SPHLattice makeSPHLattice(int count, std::uint32_t seed);
+    // Put the particles in Z-order as the scene keeps them; leaves grid sized to the
+    // lattice with kSPHRadius cells and built over the reordered positions
+    void sortSPHLattice(SPHLattice& lattice, FlipParticleGrid& grid);
+
+    // The scene's per-pair kernels at kSPHRadius, from SPHKernelConstants::forRadius;
+    // zero outside the radius. The spiky gradient at offset r is r * sphSpikyGradientFactor(|r|)
+    float sphPoly6(float distance);
+    float sphSpikyGradientFactor(float distance);
+    float sphViscosity(float distance);
+
+    // FLIP collision pool: particles on a jittered lattice 10% tighter than target,
+    // moving in random directions
+    struct FlipParticle
+    {
+        struct { float x, y; } position, velocity;
+    };
+
+    struct FlipPool
+    {
+        std::vector<FlipParticle> particles;
+        float width = 0.0f;
+        float height = 0.0f;
+    };
+
+    // room scales the box around the lattice; shuffled puts the particles in random
+    // memory order, like an unsorted particle array. The seed is overridable by --seed
+    FlipPool makeFlipPool(int count, float target, float room, float maxSpeed, std::uint32_t seed, bool shuffled);
+}
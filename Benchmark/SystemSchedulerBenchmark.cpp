@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+#include <DX3D/Core/EntityManager.h>
+#include <DX3D/Core/SystemManager.h>
+#include <cmath>
+#include <cstdio>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr int kEntityCount = 20000;
+    constexpr int kFrames = 100;
+
+    struct SchedBody { float x = 0.0f, y = 0.0f, vx = 1.0f, vy = 0.5f; };
+    struct SchedSpring { float rest = 1.0f, stretch = 0.0f; };
+    struct SchedSprite { float x = 0.0f, y = 0.0f, angle = 0.0f; };
+    struct SchedAudio { float phase = 0.0f; };
+    struct SchedAi { float think = 0.0f; };
+
+    // Spend a predictable amount of ALU time per component
+    float churn(float value)
+    {
+        for (int i = 0; i < 32; ++i) value = std::sin(value) * 0.5f + 0.25f;
+        return value;
+    }
+
+    // A TestScene-shaped frame: three independent chains plus a sprite sync that depends on two of them
+    void registerFrame(SystemManager& systems)
+    {
+        systems.addSystem("Bodies", SystemAccess().write<SchedBody>(), [](EntityManager& em, float dt) {
+            em.forEach<SchedBody>([dt](Entity&, SchedBody& b) { b.x += b.vx * dt; b.y = churn(b.y + b.vy * dt); });
+        });
+        systems.addSystem("Springs", SystemAccess().write<SchedSpring>(), [](EntityManager& em, float) {
+            em.forEach<SchedSpring>([](Entity&, SchedSpring& s) { s.stretch = churn(s.stretch + s.rest); });
+        });
+        systems.addSystem("Audio", SystemAccess().write<SchedAudio>(), [](EntityManager& em, float dt) {
+            em.forEach<SchedAudio>([dt](Entity&, SchedAudio& a) { a.phase = churn(a.phase + dt); });
+        });
+        systems.addSystem("Ai", SystemAccess().write<SchedAi>(), [](EntityManager& em, float) {
+            em.forEach<SchedAi>([](Entity&, SchedAi& a) { a.think = churn(a.think + 1.0f); });
+        });
+        systems.addSystem("SpriteSync", SystemAccess().read<SchedBody, SchedSpring>().write<SchedSprite>(), [](EntityManager& em, float) {
+            em.forEach<SchedSprite>([](Entity& e, SchedSprite& s) {
+                const SchedBody* b = e.getComponent<SchedBody>();
+                const SchedSpring* sp = e.getComponent<SchedSpring>();
+                s.x = b->x; s.y = b->y; s.angle = sp->stretch;
+            });
+        });
+    }
+}
+
+DX3D_BENCHMARK(SystemSchedulerOverlap)
+{
+    EntityManager em;
+    for (int i = 0; i < kEntityCount; ++i)
+    {
+        Entity& e = em.createEntity();
+        e.addComponent<SchedBody>();
+        e.addComponent<SchedSpring>();
+        e.addComponent<SchedSprite>();
+        e.addComponent<SchedAudio>();
+        e.addComponent<SchedAi>();
+    }
+
+    SystemManager systems;
+    registerFrame(systems);
+    systems.build();
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const bool parallel = (pass == 1);
+        systems.setParallel(parallel);
+        bench::Stopwatch sw;
+        for (int frame = 0; frame < kFrames; ++frame) systems.update(em, 1.0f / 60.0f);
+        bench::report("SystemSchedulerOverlap", parallel ? "parallel schedule" : "serial schedule", sw.elapsedMs() / kFrames, "ms/frame");
+    }
+
+    std::printf("%s", systems.dumpSchedule().c_str());
+}
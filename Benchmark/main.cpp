@@ -0,0 +1,138 @@
+#include "Benchmark.h"
+#include <DX3D/Core/AllocationCounter.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+static_assert(dx3d::AllocationCounter::enabled, "Build the benchmarks with DX3D_TRACK_ALLOCATIONS for the heap figures");
+
+namespace
+{
+    struct BenchmarkRun
+    {
+        const char* name;
+        double wallMs;
+        std::int64_t peakHeapBytes; // heap high-water mark above what was live when it started
+        std::uint64_t allocations;
+        std::size_t firstResult;
+        std::size_t resultCount;
+    };
+
+    void writeJsonString(std::FILE* file, const std::string& text)
+    {
+        std::fputc('"', file);
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\') std::fputc('\\', file);
+            if (static_cast<unsigned char>(c) < 0x20) { std::fprintf(file, "\\u%04x", c); continue; }
+            std::fputc(c, file);
+        }
+        std::fputc('"', file);
+    }
+
+    bool writeJson(const char* path, const std::vector<BenchmarkRun>& runs)
+    {
+        std::FILE* file = std::fopen(path, "w");
+        if (!file) return false;
+
+        const auto& config = dx3d::bench::config();
+        const auto& results = dx3d::bench::results();
+        std::fprintf(file, "{\n  \"threads\": %u,\n  \"failed_checks\": %d,\n", std::thread::hardware_concurrency(), dx3d::bench::failures());
+        std::fprintf(file, "  \"config\": { \"steps\": %d, \"size\": %d, \"particles\": %d, \"seed\": %u },\n",
+            config.steps, config.size, config.particles, config.hasSeed ? config.seed : 0u);
+        std::fprintf(file, "  \"benchmarks\": [\n");
+        for (std::size_t i = 0; i < runs.size(); ++i)
+        {
+            const BenchmarkRun& run = runs[i];
+            std::fprintf(file, "    {\n      \"name\": ");
+            writeJsonString(file, run.name);
+            std::fprintf(file, ",\n      \"wall_ms\": %.3f,\n      \"peak_heap_bytes\": %lld,\n      \"allocations\": %llu,\n      \"metrics\": [\n",
+                run.wallMs, static_cast<long long>(run.peakHeapBytes), static_cast<unsigned long long>(run.allocations));
+            for (std::size_t r = 0; r < run.resultCount; ++r)
+            {
+                const dx3d::bench::Result& result = results[run.firstResult + r];
+                std::fprintf(file, "        { \"metric\": ");
+                writeJsonString(file, result.metric);
+                std::fprintf(file, ", \"value\": %.6g, \"unit\": ", result.value);
+                writeJsonString(file, result.unit);
+                std::fprintf(file, " }%s\n", r + 1 < run.resultCount ? "," : "");
+            }
+            std::fprintf(file, "      ]\n    }%s\n", i + 1 < runs.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+
+    // "--name=value" -> value, or nullptr when arg is a different option
+    const char* optionValue(const char* arg, const char* name)
+    {
+        const std::size_t length = std::strlen(name);
+        return std::strncmp(arg, name, length) == 0 && arg[length] == '=' ? arg + length + 1 : nullptr;
+    }
+}
+
+// Usage: Benchmark [filter] [--steps=N] [--size=N] [--particles=N] [--seed=N] [--json=path]
+// Runs every registered benchmark whose name contains the filter substring.
+// Simulation benchmarks take their step count, grid size, particle count and
+// seed from the options; --json writes every reported value, the wall time and
+// the heap high-water mark of each benchmark to path. Exits with EXIT_FAILURE
+// when a correctness check failed, after running everything that matched.
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    auto& config = dx3d::bench::config();
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (const char* v = optionValue(arg, "--steps")) config.steps = std::atoi(v);
+        else if (const char* v = optionValue(arg, "--size")) config.size = std::atoi(v);
+        else if (const char* v = optionValue(arg, "--particles")) config.particles = std::atoi(v);
+        else if (const char* v = optionValue(arg, "--seed")) { config.seed = static_cast<std::uint32_t>(std::strtoul(v, nullptr, 10)); config.hasSeed = true; }
+        else if (const char* v = optionValue(arg, "--json")) jsonPath = v;
+        else if (arg[0] == '-')
+        {
+            std::printf("Unknown option %s\n", arg);
+            return EXIT_FAILURE;
+        }
+        else filter = arg;
+    }
+
+    std::vector<BenchmarkRun> runs;
+    for (const auto& entry : dx3d::bench::registry())
+    {
+        if (filter && !std::strstr(entry.name, filter)) continue;
+        std::printf("[%s]\n", entry.name);
+
+        BenchmarkRun run{ entry.name, 0.0, 0, 0, dx3d::bench::results().size(), 0 };
+        const std::int64_t liveBefore = dx3d::AllocationCounter::liveBytes();
+        dx3d::AllocationCounter::resetPeak();
+        dx3d::AllocationScope allocations;
+        dx3d::bench::Stopwatch sw;
+        entry.fn();
+        run.wallMs = sw.elapsedMs();
+        run.allocations = allocations.allocations();
+        run.peakHeapBytes = dx3d::AllocationCounter::peakBytes() - liveBefore;
+        run.resultCount = dx3d::bench::results().size() - run.firstResult;
+        dx3d::bench::report(entry.name, "peak heap", run.peakHeapBytes / (1024.0 * 1024.0), "MiB");
+        runs.push_back(run);
+    }
+
+    if (runs.empty())
+    {
+        std::printf("No benchmarks matched.\n");
+        return EXIT_FAILURE;
+    }
+    if (jsonPath && !writeJson(jsonPath, runs))
+    {
+        std::printf("Could not write %s\n", jsonPath);
+        return EXIT_FAILURE;
+    }
+    if (dx3d::bench::failures() > 0)
+    {
+        std::printf("%d check(s) failed.\n", dx3d::bench::failures());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
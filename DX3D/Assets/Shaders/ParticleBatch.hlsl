@@ -0,0 +1,56 @@
+// Batched particle quads (ParticleBatchDevice): no vertex buffer, each instance reads
+// its quad from the structured buffer and SV_VertexID picks one of its six corners.
+struct ParticleInstance
+{
+    float2 position;
+    float size;
+    uint color; // RGBA8, red in the low byte
+};
+
+StructuredBuffer<ParticleInstance> instances : register(t1);
+Texture2D tex : register(t0);
+SamplerState samp : register(s0);
+
+cbuffer TransformBuffer : register(b0)
+{
+    row_major matrix worldMatrix; // identity
+    row_major matrix viewMatrix;
+    row_major matrix projectionMatrix;
+};
+
+cbuffer DrawBuffer : register(b1)
+{
+    uint firstInstance; // of this material's range
+};
+
+struct VSOutput
+{
+    float4 position : SV_Position;
+    float2 uv : TEXCOORD0;
+    float4 tint : COLOR0;
+};
+
+// Same corners, uvs and winding as Mesh::CreateQuadTextured (indices 0,1,2 0,2,3)
+static const float2 corners[6] = { float2(-0.5f, -0.5f), float2(-0.5f, 0.5f), float2(0.5f, 0.5f),
+                                   float2(-0.5f, -0.5f), float2(0.5f, 0.5f), float2(0.5f, -0.5f) };
+static const float2 uvs[6] = { float2(0, 1), float2(0, 0), float2(1, 0),
+                               float2(0, 1), float2(1, 0), float2(1, 1) };
+
+VSOutput VSMain(uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID)
+{
+    ParticleInstance p = instances[firstInstance + instanceId];
+    float4 wp = mul(float4(p.position + corners[vertexId] * p.size, 0.0f, 1.0f), worldMatrix);
+
+    VSOutput o;
+    o.position = mul(mul(wp, viewMatrix), projectionMatrix);
+    o.uv = uvs[vertexId];
+    o.tint = float4(p.color & 0xFF, (p.color >> 8) & 0xFF, (p.color >> 16) & 0xFF, p.color >> 24) / 255.0f;
+    return o;
+}
+
+// Matches Basic.hlsl with the per-particle tint in place of the b1 tint
+float4 PSMain(VSOutput input) : SV_Target
+{
+    float4 texColor = tex.Sample(samp, input.uv);
+    return float4(lerp(texColor.rgb, input.tint.rgb, input.tint.a), texColor.a);
+}
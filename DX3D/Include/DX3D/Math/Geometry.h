@@ -1,13 +1,16 @@
 ﻿#pragma once
 #include <DX3D/Core/Core.h>
 #include <vector>
+// Nothing here uses D3D; the headless benchmark builds the spatial trees without it
+#ifdef _WIN32
 #include <d3d11.h>
+#endif
 #include <cmath>
 #include <string>
 #include <algorithm>
 
 namespace dx3d {
-    static float clamp(float value, float min, float max) {
+    inline float clamp(float value, float min, float max) {
         if (value < min) return min;
         if (value > max) return max;
         return value;
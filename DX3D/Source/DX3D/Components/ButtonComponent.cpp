@@ -2,6 +2,7 @@
 #include <DX3D/Graphics/DirectWriteText.h>
 #include <iostream>
 #include <DX3D/Graphics/GraphicsEngine.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 
 using namespace dx3d;
 
@@ -83,9 +84,9 @@ ButtonComponent::ButtonComponent(GraphicsDevice& device,
     m_sprite = std::make_unique<SpriteComponent>(device, normalTexture, width, height);
 
     // Load custom textures
-    m_normalTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), normalTexture.c_str());
-    m_hoveredTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), hoveredTexture.c_str());
-    m_pressedTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), pressedTexture.c_str());
+    m_normalTexture = device.getResourceCache().getTexture(normalTexture);
+    m_hoveredTexture = device.getResourceCache().getTexture(hoveredTexture);
+    m_pressedTexture = device.getResourceCache().getTexture(pressedTexture);
 
     // Ensure text system is initialized
     if (!TextSystem::isInitialized()) {
@@ -244,28 +245,28 @@ void ButtonComponent::setState(ButtonState state) {
 }
 
 void ButtonComponent::setNormalTexture(const std::wstring& texturePath) {
-    m_normalTexture = Texture2D::LoadTexture2D(m_device.getD3DDevice(), texturePath.c_str());
+    m_normalTexture = m_device.getResourceCache().getTexture(texturePath);
     if (m_currentState == ButtonState::Normal) {
         updateVisualState();
     }
 }
 
 void ButtonComponent::setHoveredTexture(const std::wstring& texturePath) {
-    m_hoveredTexture = Texture2D::LoadTexture2D(m_device.getD3DDevice(), texturePath.c_str());
+    m_hoveredTexture = m_device.getResourceCache().getTexture(texturePath);
     if (m_currentState == ButtonState::Hovered) {
         updateVisualState();
     }
 }
 
 void ButtonComponent::setPressedTexture(const std::wstring& texturePath) {
-    m_pressedTexture = Texture2D::LoadTexture2D(m_device.getD3DDevice(), texturePath.c_str());
+    m_pressedTexture = m_device.getResourceCache().getTexture(texturePath);
     if (m_currentState == ButtonState::Pressed) {
         updateVisualState();
     }
 }
 
 void ButtonComponent::setDisabledTexture(const std::wstring& texturePath) {
-    m_disabledTexture = Texture2D::LoadTexture2D(m_device.getD3DDevice(), texturePath.c_str());
+    m_disabledTexture = m_device.getResourceCache().getTexture(texturePath);
     if (m_currentState == ButtonState::Disabled) {
         updateVisualState();
     }
@@ -17,17 +17,19 @@ namespace dx3d {
             if (dt > 1.0f / 60.0f) dt = 1.0f / 60.0f;
 
             auto bodies = em.getEntitiesWithComponent<FirmGuyComponent>();
-            auto springNodes = em.getEntitiesWithComponent<SpringGuyNodeComponent>();
-            auto softGuyEntities = em.getEntitiesWithComponent<SoftGuyComponent>();
+
+            // Packed component arrays; bodyComps is index-aligned with bodies
+            const std::vector<FirmGuyComponent*> bodyComps = em.getComponents<FirmGuyComponent>();
+            const std::vector<SpringGuyNodeComponent*> springComps = em.getComponents<SpringGuyNodeComponent>();
+            const std::vector<SoftGuyComponent*> softGuyComps = em.getComponents<SoftGuyComponent>();
 
             // Sub-step integration to reduce tunneling through thin/rotating walls
             const int subSteps = 4;
             float subDt = dt / static_cast<float>(subSteps);
             for (int step = 0; step < subSteps; ++step) {
                 // Integrate
-                for (auto* e : bodies) {
-                    auto* rb = e->getComponent<FirmGuyComponent>();
-                    if (!rb || rb->isStatic()) continue;
+                for (auto* rb : bodyComps) {
+                    if (rb->isStatic()) continue;
 
                     Vec2 v = rb->getVelocity();
                     v.y += gravity * rb->getGravityScale() * subDt;
@@ -44,9 +46,8 @@ namespace dx3d {
                         for (size_t j = i + 1; j < bodies.size(); ++j) {
                     auto* ea = bodies[i];
                     auto* eb = bodies[j];
-                    auto* a = ea->getComponent<FirmGuyComponent>();
-                    auto* b = eb->getComponent<FirmGuyComponent>();
-                    if (!a || !b) continue;
+                    auto* a = bodyComps[i];
+                    auto* b = bodyComps[j];
 
                     // Static-static: skip
                     if (a->isStatic() && b->isStatic()) continue;
@@ -245,11 +246,10 @@ namespace dx3d {
                     }
                     
                     // Collision detection between FirmGuy and SpringGuy nodes
-                    for (auto* firmEntity : bodies) {
-                        for (auto* springEntity : springNodes) {
-                            auto* firmGuy = firmEntity->getComponent<FirmGuyComponent>();
-                            auto* springNode = springEntity->getComponent<SpringGuyNodeComponent>();
-                            if (!firmGuy || !springNode) continue;
+                    for (size_t bi = 0; bi < bodies.size(); ++bi) {
+                        auto* firmEntity = bodies[bi];
+                        auto* firmGuy = bodyComps[bi];
+                        for (auto* springNode : springComps) {
                             
                             // Skip if both are static
                             if (firmGuy->isStatic() && springNode->isPositionFixed()) continue;
@@ -367,11 +367,10 @@ namespace dx3d {
                     }
                     
                     // Collision detection between FirmGuy and SoftGuy
-                    for (auto* firmEntity : bodies) {
-                        for (auto* softEntity : softGuyEntities) {
-                            auto* firmGuy = firmEntity->getComponent<FirmGuyComponent>();
-                            auto* softGuy = softEntity->getComponent<SoftGuyComponent>();
-                            if (!firmGuy || !softGuy) continue;
+                    for (size_t bi = 0; bi < bodies.size(); ++bi) {
+                        auto* firmEntity = bodies[bi];
+                        auto* firmGuy = bodyComps[bi];
+                        for (auto* softGuy : softGuyComps) {
                             
                             // Get SoftGuy nodes for collision detection
                             const auto& softNodes = softGuy->getNodes();
@@ -501,9 +500,9 @@ namespace dx3d {
 
             // Sync to sprites if present (position only; keep authoring size)
             // Skip static bodies that are manually positioned (like rotating box walls)
-            for (auto* e : bodies) {
-                auto* rb = e->getComponent<FirmGuyComponent>();
-                if (!rb) continue;
+            for (size_t bi = 0; bi < bodies.size(); ++bi) {
+                auto* e = bodies[bi];
+                auto* rb = bodyComps[bi];
                 if (auto* sprite = e->getComponent<SpriteComponent>()) {
                     // Only sync position for non-static bodies or if sprite position differs significantly from physics position
                     Vec2 physicsPos = rb->getPosition();
@@ -100,7 +100,8 @@ void KDTree::getAllNodes(std::vector<KDNode*>& out) const {
 }
 
 void KDTree::collectNodes(KDNode* n, std::vector<KDNode*>& out) const {
-    if (!n) return; out.push_back(n);
+    if (!n) return;
+    out.push_back(n);
     collectNodes(n->left, out); collectNodes(n->right, out);
 }
 
@@ -36,6 +36,17 @@ namespace dx3d {
 		}
 	}
 
+	void NodeComponent::calculateForces(const std::vector<BeamComponent*>& beams) {
+		m_totalForce = Vec2(0.0f, 0.0f);
+		m_totalMass = 0.0f;
+
+		for (auto* beam : beams) {
+			if (beam->isConnectedToNode(*this)) {
+				beam->addForceAndMassDiv2AtNode(*this, m_totalForce, m_totalMass);
+			}
+		}
+	}
+
 	void NodeComponent::resetTotalMass() {
 		m_totalMass = 0.0f;
 		m_totalForce = Vec2(0.0f, 0.0f);
@@ -201,57 +212,52 @@ namespace dx3d {
 
 	// PhysicsSystem Implementation
 	void PhysicsSystem::updateNodes(EntityManager& entityManager, float dt) {
-		auto nodeEntities = entityManager.getEntitiesWithComponent<NodeComponent>();
-		auto beamEntities = entityManager.getEntitiesWithComponent<BeamComponent>();
+		// Iterate the packed component pools directly instead of resolving per entity
+		const std::vector<BeamComponent*>& beams = entityManager.getComponents<BeamComponent>();
 
 		// First, calculate forces for all nodes (don't clear external forces yet)
-		for (auto* nodeEntity : nodeEntities) {
-			if (auto* node = nodeEntity->getComponent<NodeComponent>()) {
-				node->calculateForces(beamEntities);
-
-				// Update sprite position if it exists
-				if (auto* sprite = nodeEntity->getComponent<SpriteComponent>()) {
-					Vec2 pos = node->getPosition();
-					sprite->setPosition(pos.x, pos.y, 0.0f);
-				}
+		entityManager.forEach<NodeComponent>([&](Entity& nodeEntity, NodeComponent& node) {
+			node.calculateForces(beams);
+
+			// Update sprite position if it exists
+			if (auto* sprite = nodeEntity.getComponent<SpriteComponent>()) {
+				Vec2 pos = node.getPosition();
+				sprite->setPosition(pos.x, pos.y, 0.0f);
 			}
-		}
+		});
 
 		// Then, update node physics
-		for (auto* nodeEntity : nodeEntities) {
-			if (auto* node = nodeEntity->getComponent<NodeComponent>()) {
-				node->update(dt);
-
-				// Update sprite position after physics update
-				if (auto* sprite = nodeEntity->getComponent<SpriteComponent>()) {
-					Vec2 pos = node->getPosition();
-					sprite->setPosition(pos.x, pos.y, 0.0f);
-				}
+		entityManager.forEach<NodeComponent>([&](Entity& nodeEntity, NodeComponent& node) {
+			node.update(dt);
+
+			// Update sprite position after physics update
+			if (auto* sprite = nodeEntity.getComponent<SpriteComponent>()) {
+				Vec2 pos = node.getPosition();
+				sprite->setPosition(pos.x, pos.y, 0.0f);
 			}
-		}
+		});
 
 		// Finally, clear external forces after physics update
-		for (auto* nodeEntity : nodeEntities) {
-			if (auto* node = nodeEntity->getComponent<NodeComponent>()) {
-				node->clearExternalForces(); // Clear external forces after they've been used
-			}
-		}
+		entityManager.forEach<NodeComponent>([](Entity&, NodeComponent& node) {
+			node.clearExternalForces(); // Clear external forces after they've been used
+		});
 	}
 
 	void PhysicsSystem::updateBeams(EntityManager& entityManager, float dt) {
-		auto beamEntities = entityManager.getEntitiesWithComponent<BeamComponent>();
-
-		for (auto* beamEntity : beamEntities) {
-			auto* beam = beamEntity->getComponent<BeamComponent>();
-			if (!beam) continue;
+		entityManager.view<BeamComponent>().each([&](Entity& beamEntity, BeamComponent& beamComp) {
+			auto* beam = &beamComp;
 
 			// Physics tick for the beam
 			beam->update(dt);
 
 			// Get live node positions
-			auto* node1 = beam->getNode1Entity()->getComponent<NodeComponent>();
-			auto* node2 = beam->getNode2Entity()->getComponent<NodeComponent>();
-			if (!node1 || !node2) continue;
+			// Node entities may have been destroyed; the refs then read null
+			auto* node1Entity = beam->getNode1Entity();
+			auto* node2Entity = beam->getNode2Entity();
+			if (!node1Entity || !node2Entity) return;
+			auto* node1 = node1Entity->getComponent<NodeComponent>();
+			auto* node2 = node2Entity->getComponent<NodeComponent>();
+			if (!node1 || !node2) return;
 
 			Vec2 p1 = node1->getPosition();
 			Vec2 p2 = node2->getPosition();
@@ -267,7 +273,7 @@ namespace dx3d {
 			float angleRad = std::atan2(beamVector.y, beamVector.x);
 			float thickness = beam->getThickness();
 
-			if (auto* sprite = beamEntity->getComponent<SpriteComponent>()) {
+			if (auto* sprite = beamEntity.getComponent<SpriteComponent>()) {
 				// Get the mesh dimensions to understand how to scale properly
 				auto mesh = sprite->getMesh();
 				if (mesh) {
@@ -290,26 +296,19 @@ namespace dx3d {
 					sprite->setScale(length, clamp(thickness, 10, 500), 1.0f);
 				}
 			}
-		}
+		});
 	}
 
 
 	void PhysicsSystem::resetPhysics(EntityManager& entityManager) {
-		auto nodeEntities = entityManager.getEntitiesWithComponent<NodeComponent>();
-		auto beamEntities = entityManager.getEntitiesWithComponent<BeamComponent>();
-
-		for (auto* nodeEntity : nodeEntities) {
-			if (auto* node = nodeEntity->getComponent<NodeComponent>()) {
-				node->setPosition(node->startingPos);
-				node->setVelocity(Vec2(0.0f, 0.0f));
-				node->resetTotalMass();
-			}
+		for (auto* node : entityManager.getComponents<NodeComponent>()) {
+			node->setPosition(node->startingPos);
+			node->setVelocity(Vec2(0.0f, 0.0f));
+			node->resetTotalMass();
 		}
 
-		for (auto* beamEntity : beamEntities) {
-			if (auto* beam = beamEntity->getComponent<BeamComponent>()) {
-				beam->resetBeam();
-			}
+		for (auto* beam : entityManager.getComponents<BeamComponent>()) {
+			beam->resetBeam();
 		}
 	}
 
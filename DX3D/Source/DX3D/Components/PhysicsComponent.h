@@ -15,6 +15,7 @@ namespace dx3d {
         NodeComponent(Vec2 position, bool positionFixed = false);
         void update(float dt);
         void calculateForces(const std::vector<Entity*>& beamEntities);
+        void calculateForces(const std::vector<BeamComponent*>& beams);
         void resetTotalMass();
 
         // Getters/Setters
@@ -115,10 +116,11 @@ namespace dx3d {
 		Entity* getNode1() const { return m_node1Entity; }
 		Entity* getNode2() const { return m_node2Entity; }
     private:
-        Entity* m_node1Entity;
-        Entity* m_node2Entity;
-        Entity* m_node1StartEntity;
-        Entity* m_node2StartEntity;
+        // Weak refs: a beam whose node was destroyed sees nullptr instead of a dangling pointer
+        EntityRef m_node1Entity;
+        EntityRef m_node2Entity;
+        EntityRef m_node1StartEntity;
+        EntityRef m_node2StartEntity;
         float m_length0 = 0.0f;
         float m_mass = 0.0f;
         float m_colorForceFactor = 0.0f;
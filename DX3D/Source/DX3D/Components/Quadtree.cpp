@@ -14,7 +14,7 @@ void Quadtree::insert(const QuadtreeEntity& entity) {
     }
 
     // If this is a leaf node and we haven't exceeded capacity
-    if (isLeaf() && m_entities.size() < m_maxEntities) {
+    if (isLeaf() && static_cast<int>(m_entities.size()) < m_maxEntities) {
         m_entities.push_back(entity);
         return;
     }
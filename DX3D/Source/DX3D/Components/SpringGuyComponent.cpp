@@ -1,5 +1,6 @@
 #include <DX3D/Components/SpringGuyComponent.h>
 #include <DX3D/Graphics/SpriteComponent.h>
+#include <DX3D/Core/JobSystem.h>
 #include <cmath>
 
 namespace dx3d {
@@ -126,19 +127,12 @@ namespace dx3d {
         Vec2 relativeVelocity = node1->getVelocity() - node2->getVelocity();
         Vec2 dampingForce = relativeVelocity * -m_damping;
 
-        // Clamp force to maximum
+        // Clamp force to maximum (stress visualization is updated separately in updateStress)
         float forceMagnitude = forceBeam.length();
         if (forceMagnitude > m_maxForce) {
             forceBeam = forceBeam.normalized() * m_maxForce;
         }
 
-        // Update stress visualization (cast away const for this calculation)
-        const_cast<SpringGuyBeamComponent*>(this)->m_colorForceFactor = forceMagnitude / m_maxForce;
-        if (m_colorForceFactor >= 1.0f) {
-            const_cast<SpringGuyBeamComponent*>(this)->m_colorForceFactor = 1.0f;
-            const_cast<SpringGuyBeamComponent*>(this)->m_isBroken = true;
-        }
-
         // Add damping to the spring force
         Vec2 totalForce = forceBeam + dampingForce;
 
@@ -153,6 +147,25 @@ namespace dx3d {
         return Vec2(0.0f, 0.0f);
     }
 
+    void SpringGuyBeamComponent::updateStress() {
+        if (!m_node1Entity || !m_node2Entity || m_length0 <= 0.0f || !m_enabled) return;
+
+        auto* node1 = m_node1Entity->getComponent<SpringGuyNodeComponent>();
+        auto* node2 = m_node2Entity->getComponent<SpringGuyNodeComponent>();
+        if (!node1 || !node2) return;
+
+        // Same spring force magnitude getForceAtNode computes, before clamping
+        Vec2 currentLength = node1->getPosition() - node2->getPosition();
+        float restLength = m_length0 * m_restLengthMultiplier;
+        float forceMagnitude = std::fabs(currentLength.length() - restLength) * m_stiffness;
+
+        m_colorForceFactor = forceMagnitude / m_maxForce;
+        if (m_colorForceFactor >= 1.0f) {
+            m_colorForceFactor = 1.0f;
+            m_isBroken = true;
+        }
+    }
+
     void SpringGuyBeamComponent::addForceAndMassDiv2AtNode(const SpringGuyNodeComponent& node, Vec2& forceSum, float& massSum) {
         forceSum += getForceAtNode(node);
         massSum += m_mass * 0.5f;
@@ -203,94 +216,104 @@ namespace dx3d {
     void SpringGuySystem::updateNodes(EntityManager& entityManager, float dt) {
         auto nodeEntities = entityManager.getEntitiesWithComponent<SpringGuyNodeComponent>();
         auto beamEntities = entityManager.getEntitiesWithComponent<SpringGuyBeamComponent>();
+        auto& jobs = JobSystem::getInstance();
 
-        // First, calculate forces for all nodes (don't clear external forces yet)
-        for (auto* nodeEntity : nodeEntities) {
-            if (auto* node = nodeEntity->getComponent<SpringGuyNodeComponent>()) {
-                node->calculateForces(beamEntities);
-
-                // Update sprite position if it exists
-                if (auto* sprite = nodeEntity->getComponent<SpriteComponent>()) {
-                    Vec2 pos = node->getPosition();
-                    sprite->setPosition(pos.x, pos.y, 0.0f);
+        // Beam stress only depends on positions, which do not change until integration
+        jobs.parallelFor(0, static_cast<int>(beamEntities.size()), 64, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                if (auto* beam = beamEntities[i]->getComponent<SpringGuyBeamComponent>()) {
+                    beam->updateStress();
                 }
             }
-        }
-
-        // Then, update node physics
-        for (auto* nodeEntity : nodeEntities) {
-            if (auto* node = nodeEntity->getComponent<SpringGuyNodeComponent>()) {
-                node->update(dt);
-
-                // Update sprite position after physics update
-                if (auto* sprite = nodeEntity->getComponent<SpriteComponent>()) {
-                    Vec2 pos = node->getPosition();
-                    sprite->setPosition(pos.x, pos.y, 0.0f);
+        });
+
+        // First, calculate forces for all nodes (don't clear external forces yet).
+        // Each node only writes its own force/mass, so nodes run in parallel.
+        jobs.parallelFor(0, static_cast<int>(nodeEntities.size()), 16, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                if (auto* node = nodeEntities[i]->getComponent<SpringGuyNodeComponent>()) {
+                    node->calculateForces(beamEntities);
                 }
             }
-        }
-
-        // Finally, clear external forces after physics update
-        for (auto* nodeEntity : nodeEntities) {
-            if (auto* node = nodeEntity->getComponent<SpringGuyNodeComponent>()) {
-                node->clearExternalForces(); // Clear external forces after they've been used
+        });
+
+        // Then, update node physics, sync sprites and clear the external forces that were used
+        jobs.parallelFor(0, static_cast<int>(nodeEntities.size()), 256, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                auto* nodeEntity = nodeEntities[i];
+                if (auto* node = nodeEntity->getComponent<SpringGuyNodeComponent>()) {
+                    node->update(dt);
+
+                    if (auto* sprite = nodeEntity->getComponent<SpriteComponent>()) {
+                        Vec2 pos = node->getPosition();
+                        sprite->setPosition(pos.x, pos.y, 0.0f);
+                    }
+                    node->clearExternalForces();
+                }
             }
-        }
+        });
     }
 
     void SpringGuySystem::updateBeams(EntityManager& entityManager, float dt) {
         auto beamEntities = entityManager.getEntitiesWithComponent<SpringGuyBeamComponent>();
 
-        for (auto* beamEntity : beamEntities) {
-            auto* beam = beamEntity->getComponent<SpringGuyBeamComponent>();
-            if (!beam) continue;
-
-            // Physics tick for the beam
-            beam->update(dt);
-
-            // Get live node positions
-            auto* node1 = beam->getNode1Entity()->getComponent<SpringGuyNodeComponent>();
-            auto* node2 = beam->getNode2Entity()->getComponent<SpringGuyNodeComponent>();
-            if (!node1 || !node2) continue;
-
-            Vec2 p1 = node1->getPosition();
-            Vec2 p2 = node2->getPosition();
-
-            // Calculate beam vector (node1 to node2)
-            Vec2 beamVector = p1 - p2;
-
-            // Center position - exact midpoint between the two nodes
-            Vec2 center = Vec2((p1.x + p2.x) * 0.5f, (p1.y + p2.y) * 0.5f);
-
-            // Length and angle
-            float length = beamVector.length();
-            float angleRad = std::atan2(beamVector.y, beamVector.x);
-            float thickness = beam->getThickness();
-
-            if (auto* sprite = beamEntity->getComponent<SpriteComponent>()) {
-                // Get the mesh dimensions to understand how to scale properly
-                auto mesh = sprite->getMesh();
-                if (mesh) {
-                    float meshWidth = mesh->getWidth();
-                    float meshHeight = mesh->getHeight();
-
-                    // Scale the mesh to match the beam dimensions
-                    float scaleX = (meshWidth > 0.0f) ? length / meshWidth : length;
-                    float scaleY = (meshHeight > 0.0f) ? thickness / meshHeight : thickness;
-
-                    sprite->setPosition(center.x, center.y, 0.0f);
-                    sprite->setRotationZ(angleRad);
-                    sprite->setScale(length, clamp(thickness, 10, 500), 1.0f);
-
-                }
-                else {
-                    // Fallback if mesh dimensions aren't available
-                    sprite->setPosition(center.x, center.y, 0.0f);
-                    sprite->setRotationZ(angleRad);
-                    sprite->setScale(length, clamp(thickness, 10, 500), 1.0f);
+        // Each beam only writes itself and its own sprite
+        JobSystem::getInstance().parallelFor(0, static_cast<int>(beamEntities.size()), 64, [&](int begin, int end) {
+            for (int b = begin; b < end; ++b) {
+                auto* beamEntity = beamEntities[b];
+                auto* beam = beamEntity->getComponent<SpringGuyBeamComponent>();
+                if (!beam) continue;
+
+                // Physics tick for the beam
+                beam->update(dt);
+
+                // Get live node positions
+                Entity* node1Entity = beam->getNode1Entity();
+                Entity* node2Entity = beam->getNode2Entity();
+                if (!node1Entity || !node2Entity) continue;
+                auto* node1 = node1Entity->getComponent<SpringGuyNodeComponent>();
+                auto* node2 = node2Entity->getComponent<SpringGuyNodeComponent>();
+                if (!node1 || !node2) continue;
+
+                Vec2 p1 = node1->getPosition();
+                Vec2 p2 = node2->getPosition();
+
+                // Calculate beam vector (node1 to node2)
+                Vec2 beamVector = p1 - p2;
+
+                // Center position - exact midpoint between the two nodes
+                Vec2 center = Vec2((p1.x + p2.x) * 0.5f, (p1.y + p2.y) * 0.5f);
+
+                // Length and angle
+                float length = beamVector.length();
+                float angleRad = std::atan2(beamVector.y, beamVector.x);
+                float thickness = beam->getThickness();
+
+                if (auto* sprite = beamEntity->getComponent<SpriteComponent>()) {
+                    // Get the mesh dimensions to understand how to scale properly
+                    auto mesh = sprite->getMesh();
+                    if (mesh) {
+                        float meshWidth = mesh->getWidth();
+                        float meshHeight = mesh->getHeight();
+
+                        // Scale the mesh to match the beam dimensions
+                        float scaleX = (meshWidth > 0.0f) ? length / meshWidth : length;
+                        float scaleY = (meshHeight > 0.0f) ? thickness / meshHeight : thickness;
+
+                        sprite->setPosition(center.x, center.y, 0.0f);
+                        sprite->setRotationZ(angleRad);
+                        sprite->setScale(length, clamp(thickness, 10, 500), 1.0f);
+
+                    }
+                    else {
+                        // Fallback if mesh dimensions aren't available
+                        sprite->setPosition(center.x, center.y, 0.0f);
+                        sprite->setRotationZ(angleRad);
+                        sprite->setScale(length, clamp(thickness, 10, 500), 1.0f);
+                    }
                 }
             }
-        }
+        });
     }
 
     void SpringGuySystem::resetPhysics(EntityManager& entityManager) {
@@ -89,6 +89,8 @@ namespace dx3d {
 
         // Physics calculations
         Vec2 getForceAtNode(const SpringGuyNodeComponent& node) const;
+        // Refresh the stress factor from the current node positions (once per step, before forces)
+        void updateStress();
         void addForceAndMassDiv2AtNode(const SpringGuyNodeComponent& node, Vec2& forceSum, float& massSum);
 
         // State queries
@@ -139,10 +141,10 @@ namespace dx3d {
         Entity* getNode1() const { return m_node1Entity; }
         Entity* getNode2() const { return m_node2Entity; }
     private:
-        Entity* m_node1Entity;
-        Entity* m_node2Entity;
-        Entity* m_node1StartEntity;
-        Entity* m_node2StartEntity;
+        EntityRef m_node1Entity;
+        EntityRef m_node2Entity;
+        EntityRef m_node1StartEntity;
+        EntityRef m_node2StartEntity;
         float m_length0 = 0.0f;
         float m_mass = 0.0f;
         float m_colorForceFactor = 0.0f;
@@ -2,6 +2,7 @@
 #include <DX3D/Graphics/Texture2D.h>
 #include <DX3D/Core/EntityManager.h>
 #include <DX3D/Graphics/GraphicsDevice.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 #include <iostream>
 
 namespace dx3d
@@ -80,8 +81,8 @@ namespace dx3d
 
     void SunComponent::createSprites(GraphicsDevice& device, EntityManager& entityManager, 
                                      const std::wstring& nodePath, const std::wstring& bloomPath) {
-        auto nodeTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), nodePath.c_str());
-        auto bloomTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), bloomPath.c_str());
+        auto nodeTexture = device.getResourceCache().getTexture(nodePath);
+        auto bloomTexture = device.getResourceCache().getTexture(bloomPath);
 
         if (!nodeTexture || !bloomTexture) {
             std::cout << "Warning: Could not load sun textures for " << m_baseName << std::endl;
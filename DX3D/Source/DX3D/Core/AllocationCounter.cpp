@@ -0,0 +1,97 @@
+#include <DX3D/Core/AllocationCounter.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace
+{
+    std::atomic<std::uint64_t> g_allocationCount{ 0 };
+    std::atomic<std::int64_t> g_liveBytes{ 0 };
+    std::atomic<std::int64_t> g_peakBytes{ 0 };
+}
+
+std::uint64_t dx3d::AllocationCounter::total()
+{
+    return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+std::int64_t dx3d::AllocationCounter::liveBytes()
+{
+    return g_liveBytes.load(std::memory_order_relaxed);
+}
+
+std::int64_t dx3d::AllocationCounter::peakBytes()
+{
+    return g_peakBytes.load(std::memory_order_relaxed);
+}
+
+void dx3d::AllocationCounter::resetPeak()
+{
+    g_peakBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+#if defined(DX3D_TRACK_ALLOCATIONS)
+namespace
+{
+    std::int64_t blockSize(void* p)
+    {
+#if defined(_WIN32)
+        return static_cast<std::int64_t>(_msize(p));
+#elif defined(__APPLE__)
+        return static_cast<std::int64_t>(malloc_size(p));
+#else
+        return static_cast<std::int64_t>(malloc_usable_size(p));
+#endif
+    }
+
+    void trackAllocation(void* p)
+    {
+        const std::int64_t size = blockSize(p);
+        const std::int64_t live = g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        std::int64_t peak = g_peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    void trackFree(void* p)
+    {
+        if (p) g_liveBytes.fetch_sub(blockSize(p), std::memory_order_relaxed);
+    }
+}
+
+// Replacing the basic forms is enough: the array and nothrow forms forward to
+// them, and the aligned forms keep their default (separate, untracked) implementation.
+void* operator new(std::size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    while (true)
+    {
+        if (void* p = std::malloc(size))
+        {
+            trackAllocation(p);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    trackFree(p);
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    trackFree(p);
+    std::free(p);
+}
+#endif
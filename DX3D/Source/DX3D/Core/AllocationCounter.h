@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+namespace dx3d {
+    // Counts calls to the global operator new (all threads) and the bytes they
+    // hold. The replacement operators live in AllocationCounter.cpp and are only
+    // compiled with DX3D_TRACK_ALLOCATIONS defined; otherwise every count reads 0.
+    class AllocationCounter {
+    public:
+#if defined(DX3D_TRACK_ALLOCATIONS)
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+        static std::uint64_t total();
+        // Bytes currently held through operator new (usable block sizes, so a
+        // little above the requested sizes)
+        static std::int64_t liveBytes();
+        // Highest liveBytes() since the last resetPeak()
+        static std::int64_t peakBytes();
+        static void resetPeak();
+    };
+
+    // Number of heap allocations made since construction (or the last reset)
+    class AllocationScope {
+    public:
+        AllocationScope() : m_start(AllocationCounter::total()) {}
+
+        std::uint64_t allocations() const { return AllocationCounter::total() - m_start; }
+        void reset() { m_start = AllocationCounter::total(); }
+
+    private:
+        std::uint64_t m_start;
+    };
+}
@@ -0,0 +1,387 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dx3d {
+    using EntityId = std::size_t;
+    using ComponentTypeId = std::uint32_t;
+
+    namespace detail {
+        inline ComponentTypeId nextComponentTypeId() {
+            // Atomic: systems running on worker threads may touch a type for the first time
+            static std::atomic<ComponentTypeId> s_next{ 0 };
+            return s_next.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Dense, process-wide index for each component type (replaces std::type_index hashing)
+    template<typename T>
+    ComponentTypeId getComponentTypeId() {
+        static const ComponentTypeId s_id = detail::nextComponentTypeId();
+        return s_id;
+    }
+
+    static constexpr std::uint32_t InvalidDenseIndex = 0xFFFFFFFFu;
+
+    // Paged EntityId -> dense index table. Pages are allocated on first write so
+    // sparse id ranges stay cheap.
+    class SparseIndex {
+    public:
+        std::uint32_t get(EntityId entity) const {
+            const std::size_t page = entity / PageSize;
+            if (page >= m_pages.size() || !m_pages[page]) return InvalidDenseIndex;
+            return m_pages[page][entity % PageSize];
+        }
+
+        std::uint32_t& at(EntityId entity) {
+            const std::size_t page = entity / PageSize;
+            if (page >= m_pages.size()) m_pages.resize(page + 1);
+            if (!m_pages[page]) {
+                m_pages[page].reset(new std::uint32_t[PageSize]);
+                std::fill_n(m_pages[page].get(), PageSize, InvalidDenseIndex);
+            }
+            return m_pages[page][entity % PageSize];
+        }
+
+        void clear() { m_pages.clear(); }
+
+    private:
+        static constexpr std::size_t PageSize = 4096;
+        std::vector<std::unique_ptr<std::uint32_t[]>> m_pages;
+    };
+
+    // Packed set of entity ids with O(1) insert/erase/contains
+    class EntitySet {
+    public:
+        bool contains(EntityId entity) const { return m_sparse.get(entity) != InvalidDenseIndex; }
+
+        void insert(EntityId entity) {
+            std::uint32_t& index = m_sparse.at(entity);
+            if (index != InvalidDenseIndex) return;
+            index = static_cast<std::uint32_t>(m_dense.size());
+            m_dense.push_back(entity);
+        }
+
+        void erase(EntityId entity) {
+            const std::uint32_t index = m_sparse.get(entity);
+            if (index == InvalidDenseIndex) return;
+            const EntityId last = m_dense.back();
+            m_dense[index] = last;
+            m_sparse.at(last) = index;
+            m_dense.pop_back();
+            m_sparse.at(entity) = InvalidDenseIndex;
+        }
+
+        void clear() {
+            m_dense.clear();
+            m_sparse.clear();
+        }
+
+        const std::vector<EntityId>& entities() const { return m_dense; }
+        std::size_t size() const { return m_dense.size(); }
+
+    private:
+        std::vector<EntityId> m_dense;
+        SparseIndex m_sparse;
+    };
+
+    // Type-erased interface so the registry can drop every component of an entity
+    class ComponentPoolBase {
+    public:
+        virtual ~ComponentPoolBase() = default;
+        virtual bool contains(EntityId entity) const = 0;
+        virtual void remove(EntityId entity) = 0;
+        virtual void clear() = 0;
+        virtual std::size_t size() const = 0;
+        virtual const std::vector<EntityId>& owners() const = 0;
+    };
+
+    // Sparse-set storage for a single component type.
+    //
+    // - sparse: SparseIndex EntityId -> dense index table, O(1) lookup without hashing
+    // - dense:  packed owner ids and component pointers, iterated linearly by systems
+    // - slots:  components live in fixed-size pages that never move, so the T* / T&
+    //           handed out by Entity::addComponent/getComponent stay valid until the
+    //           component itself is removed (scenes cache these pointers)
+    //
+    // Add and remove are O(1): removal swaps the last dense entry into the hole and
+    // recycles the slot through a free list.
+    template<typename T>
+    class ComponentPool final : public ComponentPoolBase {
+    public:
+        ComponentPool() = default;
+        ComponentPool(const ComponentPool&) = delete;
+        ComponentPool& operator=(const ComponentPool&) = delete;
+        ~ComponentPool() override { clear(); }
+
+        template<typename... Args>
+        T& emplace(EntityId entity, Args&&... args) {
+            std::uint32_t slot = acquireSlot();
+            T* component = new (slotAddress(slot)) T(std::forward<Args>(args)...);
+
+            std::uint32_t& denseIndex = m_sparse.at(entity);
+            if (denseIndex != InvalidDenseIndex) {
+                // Replacing an existing component: construct first so args may still read the old one
+                std::uint32_t oldSlot = m_slots[denseIndex];
+                destroySlot(oldSlot);
+                m_slots[denseIndex] = slot;
+                m_components[denseIndex] = component;
+                return *component;
+            }
+
+            denseIndex = static_cast<std::uint32_t>(m_owners.size());
+            m_owners.push_back(entity);
+            m_components.push_back(component);
+            m_slots.push_back(slot);
+            return *component;
+        }
+
+        T* tryGet(EntityId entity) const {
+            std::uint32_t denseIndex = lookup(entity);
+            return denseIndex != InvalidDenseIndex ? m_components[denseIndex] : nullptr;
+        }
+
+        bool contains(EntityId entity) const override {
+            return lookup(entity) != InvalidDenseIndex;
+        }
+
+        void remove(EntityId entity) override {
+            std::uint32_t denseIndex = lookup(entity);
+            if (denseIndex == InvalidDenseIndex) return;
+
+            destroySlot(m_slots[denseIndex]);
+
+            // Swap-and-pop keeps the dense arrays packed
+            std::uint32_t last = static_cast<std::uint32_t>(m_owners.size() - 1);
+            if (denseIndex != last) {
+                m_owners[denseIndex] = m_owners[last];
+                m_components[denseIndex] = m_components[last];
+                m_slots[denseIndex] = m_slots[last];
+                m_sparse.at(m_owners[denseIndex]) = denseIndex;
+            }
+            m_owners.pop_back();
+            m_components.pop_back();
+            m_slots.pop_back();
+            m_sparse.at(entity) = InvalidDenseIndex;
+        }
+
+        void clear() override {
+            for (std::uint32_t slot : m_slots) {
+                reinterpret_cast<T*>(slotAddress(slot))->~T();
+            }
+            m_owners.clear();
+            m_components.clear();
+            m_slots.clear();
+            m_sparse.clear();
+            m_pages.clear();
+            m_freeSlots.clear();
+            m_slotCount = 0;
+        }
+
+        std::size_t size() const override { return m_owners.size(); }
+        bool empty() const { return m_owners.empty(); }
+
+        // Dense views: index i of owners() owns components()[i]
+        const std::vector<EntityId>& owners() const override { return m_owners; }
+        const std::vector<T*>& components() const { return m_components; }
+
+        // Invoke fn(EntityId, T&) for every component in dense order
+        template<typename Fn>
+        void each(Fn&& fn) const {
+            const std::size_t count = m_owners.size();
+            for (std::size_t i = 0; i < count; ++i) {
+                fn(m_owners[i], *m_components[i]);
+            }
+        }
+
+    private:
+        static constexpr std::size_t SlotPageSize = 256;
+
+        struct alignas(T) Slot {
+            unsigned char bytes[sizeof(T)];
+        };
+
+        std::uint32_t lookup(EntityId entity) const {
+            return m_sparse.get(entity);
+        }
+
+        void* slotAddress(std::uint32_t slot) const {
+            return m_pages[slot / SlotPageSize][slot % SlotPageSize].bytes;
+        }
+
+        std::uint32_t acquireSlot() {
+            if (!m_freeSlots.empty()) {
+                std::uint32_t slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+                return slot;
+            }
+            if (m_slotCount == m_pages.size() * SlotPageSize) {
+                m_pages.emplace_back(new Slot[SlotPageSize]);
+            }
+            return m_slotCount++;
+        }
+
+        void destroySlot(std::uint32_t slot) {
+            reinterpret_cast<T*>(slotAddress(slot))->~T();
+            m_freeSlots.push_back(slot);
+        }
+
+        SparseIndex m_sparse;
+        std::vector<EntityId> m_owners;
+        std::vector<T*> m_components;
+        std::vector<std::uint32_t> m_slots;
+        std::vector<std::unique_ptr<Slot[]>> m_pages;
+        std::vector<std::uint32_t> m_freeSlots;
+        std::uint32_t m_slotCount = 0;
+    };
+
+    // Entities that own every component in a fixed type set. Kept up to date by
+    // the registry on each add/remove so multi-component views never rescan.
+    class ViewCache {
+    public:
+        explicit ViewCache(std::vector<ComponentTypeId> types) : m_types(std::move(types)) {}
+
+        const std::vector<ComponentTypeId>& types() const { return m_types; }
+        EntitySet& set() { return m_set; }
+        const EntitySet& set() const { return m_set; }
+
+    private:
+        std::vector<ComponentTypeId> m_types; // sorted
+        EntitySet m_set;
+    };
+
+    // Owns one ComponentPool per component type, indexed by ComponentTypeId
+    class ComponentRegistry {
+    public:
+        ComponentRegistry() = default;
+        ComponentRegistry(const ComponentRegistry&) = delete;
+        ComponentRegistry& operator=(const ComponentRegistry&) = delete;
+
+        template<typename T, typename... Args>
+        T& emplace(EntityId entity, Args&&... args) {
+            ComponentPool<T>& p = assure<T>();
+            const bool existed = p.contains(entity);
+            T& component = p.emplace(entity, std::forward<Args>(args)...);
+            if (!existed) onComponentAdded(getComponentTypeId<T>(), entity);
+            return component;
+        }
+
+        template<typename T>
+        T* tryGet(EntityId entity) const {
+            const ComponentPool<T>* p = pool<T>();
+            return p ? p->tryGet(entity) : nullptr;
+        }
+
+        template<typename T>
+        bool has(EntityId entity) const {
+            const ComponentPool<T>* p = pool<T>();
+            return p && p->contains(entity);
+        }
+
+        template<typename T>
+        void remove(EntityId entity) {
+            ComponentPool<T>* p = pool<T>();
+            if (!p || !p->contains(entity)) return;
+            onComponentRemoved(getComponentTypeId<T>(), entity);
+            p->remove(entity);
+        }
+
+        // Drop every component owned by an entity (used when the entity is destroyed)
+        void removeAll(EntityId entity) {
+            for (auto& view : m_views) view->set().erase(entity);
+            // Indexed loop: a component destructor may register a new pool
+            for (std::size_t i = 0; i < m_pools.size(); ++i) {
+                if (m_pools[i]) m_pools[i]->remove(entity);
+            }
+        }
+
+        // Cached set of entities owning every Ts; created and filled on first use,
+        // then maintained incrementally
+        template<typename... Ts>
+        const ViewCache& assureView() {
+            static_assert(sizeof...(Ts) > 1, "single-component views iterate the pool directly");
+            (assure<Ts>(), ...);
+
+            ComponentTypeId ids[] = { getComponentTypeId<Ts>()... };
+            std::sort(std::begin(ids), std::end(ids));
+            for (auto& view : m_views) {
+                if (std::equal(view->types().begin(), view->types().end(), std::begin(ids), std::end(ids))) {
+                    return *view;
+                }
+            }
+
+            auto view = std::make_unique<ViewCache>(std::vector<ComponentTypeId>(std::begin(ids), std::end(ids)));
+            for (ComponentTypeId id : ids) {
+                if (id >= m_viewsByType.size()) m_viewsByType.resize(id + 1);
+                m_viewsByType[id].push_back(view.get());
+            }
+
+            // Seed from the smallest pool
+            const ComponentPoolBase* smallest = m_pools[ids[0]].get();
+            for (ComponentTypeId id : ids) {
+                if (m_pools[id]->size() < smallest->size()) smallest = m_pools[id].get();
+            }
+            for (EntityId entity : smallest->owners()) {
+                if (ownsAll(*view, entity)) view->set().insert(entity);
+            }
+
+            m_views.push_back(std::move(view));
+            return *m_views.back();
+        }
+
+        // Returns nullptr if no component of this type was ever added
+        template<typename T>
+        ComponentPool<T>* pool() const {
+            const ComponentTypeId id = getComponentTypeId<T>();
+            if (id >= m_pools.size()) return nullptr;
+            return static_cast<ComponentPool<T>*>(m_pools[id].get());
+        }
+
+        template<typename T>
+        ComponentPool<T>& assure() {
+            const ComponentTypeId id = getComponentTypeId<T>();
+            if (id >= m_pools.size()) m_pools.resize(id + 1);
+            if (!m_pools[id]) m_pools[id] = std::make_unique<ComponentPool<T>>();
+            return *static_cast<ComponentPool<T>*>(m_pools[id].get());
+        }
+
+        void clear() {
+            for (auto& view : m_views) view->set().clear();
+            for (std::size_t i = 0; i < m_pools.size(); ++i) {
+                if (m_pools[i]) m_pools[i]->clear();
+            }
+        }
+
+    private:
+        bool ownsAll(const ViewCache& view, EntityId entity) const {
+            for (ComponentTypeId id : view.types()) {
+                if (!m_pools[id]->contains(entity)) return false;
+            }
+            return true;
+        }
+
+        void onComponentAdded(ComponentTypeId type, EntityId entity) {
+            if (type >= m_viewsByType.size()) return;
+            for (ViewCache* view : m_viewsByType[type]) {
+                if (ownsAll(*view, entity)) view->set().insert(entity);
+            }
+        }
+
+        void onComponentRemoved(ComponentTypeId type, EntityId entity) {
+            if (type >= m_viewsByType.size()) return;
+            for (ViewCache* view : m_viewsByType[type]) {
+                view->set().erase(entity);
+            }
+        }
+
+        std::vector<std::unique_ptr<ComponentPoolBase>> m_pools;
+        std::vector<std::unique_ptr<ViewCache>> m_views;
+        std::vector<std::vector<ViewCache*>> m_viewsByType;
+    };
+}
@@ -1,84 +1,99 @@
 #pragma once
+#include <DX3D/Core/ComponentStorage.h>
+#include <DX3D/Core/NameId.h>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
 #include <memory>
-#include <typeindex>
 #include <vector>
 #include <algorithm>
+#include <type_traits>
 
 namespace dx3d {
-    using EntityId = std::size_t;
+    class EntityManager;
+
+    // Generational entity handle. The index is recycled after destruction; the
+    // generation is bumped each time, so stale handles never resolve to a new entity.
+    struct EntityHandle {
+        static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+        std::uint32_t index = InvalidIndex;
+        std::uint32_t generation = 0;
+
+        bool isValid() const { return index != InvalidIndex; }
+        bool operator==(const EntityHandle& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+    };
 
     class Entity {
     public:
-        Entity(EntityId id, const std::string& name = "")
-            : m_id(id), m_name(name) {
+        Entity(EntityHandle handle, NameId name, ComponentRegistry& registry, EntityManager& manager)
+            : m_handle(handle), m_name(name), m_nameText(&NameTable::str(name)), m_registry(&registry), m_manager(&manager) {
         }
 
-        EntityId getId() const { return m_id; }
-        const std::string& getName() const { return m_name; }
-        void setName(const std::string& name) { m_name = name; }
+        // Slot index; unique among live entities and used as the component storage key
+        EntityId getId() const { return m_handle.index; }
+        EntityHandle getHandle() const { return m_handle; }
+        EntityManager* getManager() const { return m_manager; }
+        const std::string& getName() const { return *m_nameText; }
+        NameId getNameId() const { return m_name; }
+        void setName(const std::string& name) {
+            m_name = NameTable::intern(name);
+            m_nameText = &NameTable::str(m_name);
+        }
 
-        // Add a component to this entity
+        // Add a component to this entity (replaces any existing component of the same type)
         template<typename T, typename... Args>
         T& addComponent(Args&&... args) {
-            auto component = std::unique_ptr<T>(new T(std::forward<Args>(args)...));
-            T& ref = *component;
-
-            // Store the component with type erasure
-            m_components[std::type_index(typeid(T))] = std::make_shared<ComponentWrapper<T>>(std::move(component));
-
-            return ref;
+            return m_registry->emplace<T>(getId(), std::forward<Args>(args)...);
         }
 
         // Get a component from this entity
         template<typename T>
         T* getComponent() {
-            auto it = m_components.find(std::type_index(typeid(T)));
-            if (it != m_components.end()) {
-                auto wrapper = std::static_pointer_cast<ComponentWrapper<T>>(it->second);
-                return wrapper->component.get();
-            }
-            return nullptr;
+            return m_registry->tryGet<T>(getId());
         }
 
         template<typename T>
         const T* getComponent() const {
-            auto it = m_components.find(std::type_index(typeid(T)));
-            if (it != m_components.end()) {
-                auto wrapper = std::static_pointer_cast<ComponentWrapper<T>>(it->second);
-                return wrapper->component.get();
-            }
-            return nullptr;
+            return m_registry->tryGet<T>(getId());
         }
 
         // Check if entity has a component
         template<typename T>
         bool hasComponent() const {
-            return m_components.find(std::type_index(typeid(T))) != m_components.end();
+            return m_registry->has<T>(getId());
         }
 
         // Remove a component
         template<typename T>
         void removeComponent() {
-            m_components.erase(std::type_index(typeid(T)));
+            m_registry->remove<T>(getId());
         }
 
-    private:
-        // Base class for component storage
-        struct ComponentWrapperBase {
-            virtual ~ComponentWrapperBase() = default;
-        };
+        // Tags are empty marker components; query them with EntityManager::view<Tag>()
+        template<typename Tag>
+        void addTag() {
+            static_assert(std::is_empty_v<Tag>, "Tags must be empty structs");
+            m_registry->emplace<Tag>(getId());
+        }
 
-        // Templated wrapper for specific component types
-        template<typename T>
-        struct ComponentWrapper : ComponentWrapperBase {
-            ComponentWrapper(std::unique_ptr<T> comp) : component(std::move(comp)) {}
-            std::unique_ptr<T> component;
-        };
+        template<typename Tag>
+        bool hasTag() const {
+            return m_registry->has<Tag>(getId());
+        }
 
-        EntityId m_id;
-        std::string m_name;
-        std::unordered_map<std::type_index, std::shared_ptr<ComponentWrapperBase>> m_components;
+        template<typename Tag>
+        void removeTag() {
+            m_registry->remove<Tag>(getId());
+        }
+
+    private:
+        EntityHandle m_handle;
+        NameId m_name;
+        // Interned text is never freed, so this stays valid without touching the table
+        const std::string* m_nameText;
+        // Components are stored per type in the owning EntityManager's registry
+        ComponentRegistry* m_registry;
+        EntityManager* m_manager;
     };
-}
\ No newline at end of file
+}
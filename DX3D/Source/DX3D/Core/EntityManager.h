@@ -4,50 +4,182 @@
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <tuple>
 
 namespace dx3d {
+    // Non-owning, allocation-free view over every entity that has all of Ts.
+    // Iterate with range-for (yields Entity*) or each(fn(Entity&, Ts&...)).
+    // Adding/removing any of Ts while iterating invalidates the view.
+    template<typename... Ts>
+    class EntityView {
+    public:
+        class Iterator {
+        public:
+            Iterator(const EntityId* it, const std::vector<Entity*>* entityById)
+                : m_it(it), m_entityById(entityById) {}
+            Entity* operator*() const { return (*m_entityById)[*m_it]; }
+            Iterator& operator++() { ++m_it; return *this; }
+            bool operator!=(const Iterator& other) const { return m_it != other.m_it; }
+            bool operator==(const Iterator& other) const { return m_it == other.m_it; }
+
+        private:
+            const EntityId* m_it;
+            const std::vector<Entity*>* m_entityById;
+        };
+
+        EntityView(const std::vector<EntityId>& ids, const std::vector<Entity*>& entityById, ComponentPool<Ts>&... pools)
+            : m_ids(&ids), m_entityById(&entityById), m_pools(&pools...) {}
+
+        Iterator begin() const { return Iterator(m_ids->data(), m_entityById); }
+        Iterator end() const { return Iterator(m_ids->data() + m_ids->size(), m_entityById); }
+        std::size_t size() const { return m_ids->size(); }
+        bool empty() const { return m_ids->empty(); }
+
+        template<typename Fn>
+        void each(Fn&& fn) const {
+            if constexpr (sizeof...(Ts) == 1) {
+                // Single type: the view is the pool itself, components are index-aligned
+                const auto& components = std::get<0>(m_pools)->components();
+                for (std::size_t i = 0; i < m_ids->size(); ++i) {
+                    fn(*(*m_entityById)[(*m_ids)[i]], *components[i]);
+                }
+            }
+            else {
+                for (EntityId id : *m_ids) {
+                    fn(*(*m_entityById)[id], *std::get<ComponentPool<Ts>*>(m_pools)->tryGet(id)...);
+                }
+            }
+        }
+
+    private:
+        const std::vector<EntityId>* m_ids;
+        const std::vector<Entity*>* m_entityById;
+        std::tuple<ComponentPool<Ts>*...> m_pools;
+    };
+
     class EntityManager {
     public:
-        EntityManager() : m_nextEntityId(1) {}
+        EntityManager() = default;
+        EntityManager(const EntityManager&) = delete;
+        EntityManager& operator=(const EntityManager&) = delete;
 
-        // Create a new entity
+        // Create a new entity. Slots of destroyed entities are reused (O(1)).
         Entity& createEntity(const std::string& name = "") {
-            EntityId id = m_nextEntityId++;
-            
-            // Create entity with raw pointer to avoid unique_ptr issues
-            Entity* entity = new Entity(id, name);
+            return createEntity(NameTable::intern(name));
+        }
+
+        Entity& createEntity(NameId name) {
+            std::uint32_t index;
+            if (!m_freeSlots.empty()) {
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+            else {
+                index = static_cast<std::uint32_t>(m_entityById.size());
+                m_entityById.push_back(nullptr);
+                m_generations.push_back(0);
+                m_denseIndex.push_back(0);
+            }
+
+            EntityHandle handle{ index, m_generations[index] };
+            Entity* entity = new Entity(handle, name, m_registry, *this);
+            m_denseIndex[index] = static_cast<std::uint32_t>(m_entities.size());
             m_entities.push_back(std::unique_ptr<Entity>(entity));
-            Entity& ref = *entity;
+            m_entityById[index] = entity;
 
-            if (!name.empty()) {
-                m_namedEntities[name] = &ref;
+            if (name.isValid()) {
+                m_namedEntities[name] = entity;
             }
 
-            return ref;
+            return *entity;
+        }
+
+        bool removeEntity(std::string_view name) {
+            return removeEntity(NameTable::find(name));
         }
-        bool removeEntity(const std::string& name) {
+
+        bool removeEntity(NameId name) {
             auto it = m_namedEntities.find(name);
-            if (it != m_namedEntities.end()) {
-                Entity* entityToRemove = it->second;
+            if (it == m_namedEntities.end()) return false;
+            destroyEntity(it->second);
+            return true;
+        }
+
+        // Immediately destroy an entity and its components. O(1): the entity list
+        // is compacted by swap-and-pop, so getEntities() order is not preserved.
+        bool destroyEntity(Entity* entity) {
+            if (!entity || m_entityById[entity->getId()] != entity) return false;
+
+            const std::uint32_t index = static_cast<std::uint32_t>(entity->getId());
+
+            // Only drop the name if it still maps to this entity (names may be reused)
+            if (entity->getNameId().isValid()) {
+                auto it = m_namedEntities.find(entity->getNameId());
+                if (it != m_namedEntities.end() && it->second == entity) {
+                    m_namedEntities.erase(it);
+                }
+            }
+
+            // Destroy its components in the per-type pools
+            m_registry.removeAll(index);
+
+            const std::uint32_t dense = m_denseIndex[index];
+            const std::uint32_t last = static_cast<std::uint32_t>(m_entities.size() - 1);
+            if (dense != last) {
+                std::swap(m_entities[dense], m_entities[last]);
+                m_denseIndex[m_entities[dense]->getId()] = dense;
+            }
+            m_entities.pop_back();
+
+            m_entityById[index] = nullptr;
+            ++m_generations[index];
+            m_freeSlots.push_back(index);
+            return true;
+        }
 
-                // Remove from named entities map
-                m_namedEntities.erase(it);
+        bool destroyEntity(EntityHandle handle) {
+            return destroyEntity(getEntity(handle));
+        }
 
-                // Remove from entities vector
-                m_entities.erase(
-                    std::remove_if(m_entities.begin(), m_entities.end(),
-                        [entityToRemove](const std::unique_ptr<Entity>& entity) {
-                            return entity.get() == entityToRemove;
-                        }),
-                    m_entities.end());
+        // Deferred destruction: safe to call while iterating entities or views.
+        // Queued entities are destroyed by flushDestroyQueue() (scenes call it at frame end).
+        void queueDestroy(EntityHandle handle) {
+            if (isAlive(handle)) m_destroyQueue.push_back(handle);
+        }
 
-                return true;
+        void queueDestroy(Entity* entity) {
+            if (entity) queueDestroy(entity->getHandle());
+        }
+
+        void flushDestroyQueue() {
+            // Stale or duplicate handles resolve to nullptr and are skipped
+            for (std::size_t i = 0; i < m_destroyQueue.size(); ++i) {
+                destroyEntity(m_destroyQueue[i]);
             }
-            return false;
+            m_destroyQueue.clear();
         }
-        // Find entity by name
-        Entity* findEntity(const std::string& name) {
+
+        bool isAlive(EntityHandle handle) const {
+            return handle.index < m_generations.size()
+                && m_generations[handle.index] == handle.generation
+                && m_entityById[handle.index] != nullptr;
+        }
+
+        // Resolve a handle; nullptr once the entity has been destroyed
+        Entity* getEntity(EntityHandle handle) const {
+            return isAlive(handle) ? m_entityById[handle.index] : nullptr;
+        }
+
+        // Find entity by name. Per-frame code should keep an EntityHandle or a
+        // NameId instead; the string overload hashes the text on every call.
+        Entity* findEntity(std::string_view name) {
+            return findEntity(NameTable::find(name));
+        }
+
+        Entity* findEntity(NameId name) {
+            if (!name.isValid()) return nullptr;
             auto it = m_namedEntities.find(name);
             return (it != m_namedEntities.end()) ? it->second : nullptr;
         }
@@ -61,24 +193,100 @@ namespace dx3d {
         template<typename T>
         std::vector<Entity*> getEntitiesWithComponent() {
             std::vector<Entity*> result;
-            for (auto& entity : m_entities) {
-                if (entity->hasComponent<T>()) {
-                    result.push_back(entity.get());
+            if (ComponentPool<T>* pool = m_registry.pool<T>()) {
+                result.reserve(pool->size());
+                for (EntityId id : pool->owners()) {
+                    result.push_back(m_entityById[id]);
                 }
             }
             return result;
         }
 
-        // Clear all entities
+        // Cached query over entities owning all of Ts. Multi-component result sets
+        // are maintained incrementally on add/remove, so this never rescans or allocates
+        // after the first call for a given type set.
+        template<typename... Ts>
+        EntityView<Ts...> view() {
+            if constexpr (sizeof...(Ts) == 1) {
+                auto& pool = m_registry.assure<Ts...>();
+                return EntityView<Ts...>(pool.owners(), m_entityById, pool);
+            }
+            else {
+                const ViewCache& cache = m_registry.assureView<Ts...>();
+                return EntityView<Ts...>(cache.set().entities(), m_entityById, m_registry.assure<Ts>()...);
+            }
+        }
+
+        // Dense iteration over every T without building an entity list: fn(Entity&, T&)
+        template<typename T, typename Fn>
+        void forEach(Fn&& fn) {
+            ComponentPool<T>* pool = m_registry.pool<T>();
+            if (!pool) return;
+            const auto& owners = pool->owners();
+            const auto& components = pool->components();
+            for (std::size_t i = 0; i < owners.size(); ++i) {
+                fn(*m_entityById[owners[i]], *components[i]);
+            }
+        }
+
+        // Packed pointers to every T (valid until the next add/remove of a T)
+        template<typename T>
+        const std::vector<T*>& getComponents() {
+            return m_registry.assure<T>().components();
+        }
+
+        template<typename T>
+        std::size_t getComponentCount() const {
+            const ComponentPool<T>* pool = m_registry.pool<T>();
+            return pool ? pool->size() : 0;
+        }
+
+        ComponentRegistry& getRegistry() { return m_registry; }
+
+        // Clear all entities. Outstanding handles become stale.
         void clear() {
+            m_registry.clear();
             m_entities.clear();
             m_namedEntities.clear();
-            m_nextEntityId = 1;
+            m_destroyQueue.clear();
+            m_freeSlots.clear();
+            for (std::uint32_t i = 0; i < m_entityById.size(); ++i) {
+                if (m_entityById[i]) ++m_generations[i];
+                m_entityById[i] = nullptr;
+                m_freeSlots.push_back(static_cast<std::uint32_t>(m_entityById.size() - 1 - i));
+            }
         }
 
     private:
+        // Declared first so component storage outlives the entities that reference it
+        ComponentRegistry m_registry;
         std::vector<std::unique_ptr<Entity>> m_entities;
-        std::unordered_map<std::string, Entity*> m_namedEntities;
-        EntityId m_nextEntityId;
+        // Per-slot tables indexed by EntityHandle::index
+        std::vector<Entity*> m_entityById;
+        std::vector<std::uint32_t> m_generations;
+        std::vector<std::uint32_t> m_denseIndex;
+        std::vector<std::uint32_t> m_freeSlots;
+        std::vector<EntityHandle> m_destroyQueue;
+        std::unordered_map<NameId, Entity*> m_namedEntities;
+    };
+
+    // Weak reference to an entity for components and scenes that keep links to
+    // other entities. Converts to Entity* and yields nullptr once the target is destroyed.
+    class EntityRef {
+    public:
+        EntityRef() = default;
+        EntityRef(Entity* entity)
+            : m_manager(entity ? entity->getManager() : nullptr)
+            , m_handle(entity ? entity->getHandle() : EntityHandle{}) {
+        }
+
+        Entity* get() const { return m_manager ? m_manager->getEntity(m_handle) : nullptr; }
+        operator Entity*() const { return get(); }
+        Entity* operator->() const { return get(); }
+        EntityHandle handle() const { return m_handle; }
+
+    private:
+        EntityManager* m_manager = nullptr;
+        EntityHandle m_handle;
     };
 }
\ No newline at end of file
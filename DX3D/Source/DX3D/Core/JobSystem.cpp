@@ -0,0 +1,277 @@
+#include <DX3D/Core/JobSystem.h>
+
+using namespace dx3d;
+
+namespace
+{
+    // Which JobSystem (if any) the current thread works for, and its slot there
+    thread_local JobSystem* t_owner = nullptr;
+    thread_local unsigned t_index = 0;
+}
+
+// ========================= ScratchArena =========================
+
+ScratchArena::ScratchArena(std::size_t blockSize)
+    : m_blockSize(std::max<std::size_t>(blockSize, 256))
+{
+}
+
+void* ScratchArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    while (true)
+    {
+        if (m_block == m_blocks.size())
+        {
+            Block block;
+            block.size = std::max(m_blockSize, bytes + alignment);
+            block.data.reset(new std::byte[block.size]);
+            m_blocks.push_back(std::move(block));
+        }
+
+        Block& block = m_blocks[m_block];
+        const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data.get());
+        const std::uintptr_t aligned = (base + m_offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+        const std::size_t offset = static_cast<std::size_t>(aligned - base);
+        if (offset + bytes <= block.size)
+        {
+            m_offset = offset + bytes;
+            return block.data.get() + offset;
+        }
+
+        // Does not fit: move on to the next block. A retained block that is too
+        // small for this request is replaced by one that fits.
+        ++m_block;
+        m_offset = 0;
+        if (m_block < m_blocks.size() && m_blocks[m_block].size < bytes + alignment)
+        {
+            m_blocks[m_block].size = std::max(m_blockSize, bytes + alignment);
+            m_blocks[m_block].data.reset(new std::byte[m_blocks[m_block].size]);
+        }
+    }
+}
+
+std::size_t ScratchArena::getCapacity() const
+{
+    std::size_t total = 0;
+    for (const auto& block : m_blocks) total += block.size;
+    return total;
+}
+
+// ========================= WorkQueue =========================
+
+void JobSystem::WorkQueue::push(const Job* jobs, std::size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_count + count > m_ring.size())
+    {
+        // Grow to a power of two and unwrap the ring
+        std::size_t capacity = std::max<std::size_t>(m_ring.size(), 64);
+        while (capacity < m_count + count) capacity *= 2;
+        std::vector<Job> ring(capacity);
+        for (std::size_t i = 0; i < m_count; ++i)
+            ring[i] = m_ring[(m_head + i) & (m_ring.size() - 1)];
+        m_ring.swap(ring);
+        m_head = 0;
+    }
+    const std::size_t mask = m_ring.size() - 1;
+    for (std::size_t i = 0; i < count; ++i)
+        m_ring[(m_head + m_count + i) & mask] = jobs[i];
+    m_count += count;
+}
+
+bool JobSystem::WorkQueue::pop(Job& job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_count == 0) return false;
+    --m_count;
+    job = m_ring[(m_head + m_count) & (m_ring.size() - 1)];
+    return true;
+}
+
+bool JobSystem::WorkQueue::steal(Job& job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_count == 0) return false;
+    job = m_ring[m_head];
+    m_head = (m_head + 1) & (m_ring.size() - 1);
+    --m_count;
+    return true;
+}
+
+// ========================= JobSystem =========================
+
+JobSystem::JobSystem(unsigned workerCount)
+{
+    m_states.reserve(workerCount + 1);
+    for (unsigned i = 0; i <= workerCount; ++i)
+        m_states.push_back(std::make_unique<ThreadState>());
+
+    m_workers.reserve(workerCount);
+    for (unsigned i = 1; i <= workerCount; ++i)
+        m_workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop.store(true);
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) worker.join();
+}
+
+JobSystem& JobSystem::getInstance()
+{
+    static JobSystem instance(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return instance;
+}
+
+unsigned JobSystem::getThreadIndex() const
+{
+    return (t_owner == this) ? t_index : 0;
+}
+
+ScratchArena& JobSystem::getScratch()
+{
+    if (t_owner == this) return m_states[t_index]->scratch;
+    // Non-worker threads each get their own arena
+    thread_local ScratchArena s_externalScratch;
+    return s_externalScratch;
+}
+
+void JobSystem::submit(const Job* jobs, std::size_t count)
+{
+    if (count == 0) return;
+    m_states[getThreadIndex()]->queue.push(jobs, count);
+    m_queued.fetch_add(static_cast<int>(count), std::memory_order_release);
+
+    if (m_workers.empty()) return;
+    // Taking the lock orders this wake-up after a worker's predicate check
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    if (count == 1) m_wake.notify_one();
+    else m_wake.notify_all();
+}
+
+void JobSystem::wait(const std::atomic<int>& pending)
+{
+    const unsigned index = getThreadIndex();
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        if (!runOne(index)) std::this_thread::yield();
+    }
+}
+
+void JobSystem::execute(const Job& job)
+{
+    job.fn(job.data, job.begin, job.end);
+    job.pending->fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool JobSystem::runOne(unsigned index)
+{
+    Job job;
+    bool found = m_states[index]->queue.pop(job);
+
+    // Steal from the other queues, starting after our own slot
+    const std::size_t count = m_states.size();
+    for (std::size_t k = 1; !found && k < count; ++k)
+        found = m_states[(index + k) % count]->queue.steal(job);
+
+    if (!found) return false;
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    execute(job);
+    return true;
+}
+
+void JobSystem::workerLoop(unsigned index)
+{
+    t_owner = this;
+    t_index = index;
+
+    while (!m_stop.load(std::memory_order_acquire))
+    {
+        if (runOne(index)) continue;
+
+        // Brief spin before sleeping: parallel loops usually come in bursts
+        bool found = false;
+        for (int spin = 0; spin < 64 && !found; ++spin)
+        {
+            std::this_thread::yield();
+            found = m_queued.load(std::memory_order_acquire) > 0;
+        }
+        if (found) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() {
+            return m_stop.load(std::memory_order_acquire) || m_queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+// ========================= TaskGraph =========================
+
+TaskGraph::TaskId TaskGraph::add(std::function<void()> fn)
+{
+    Task task;
+    task.fn = std::move(fn);
+    m_tasks.push_back(std::move(task));
+    return static_cast<TaskId>(m_tasks.size() - 1);
+}
+
+void TaskGraph::precede(TaskId first, TaskId then)
+{
+    m_tasks[first].successors.push_back(then);
+    ++m_tasks[then].dependencies;
+}
+
+void TaskGraph::clear()
+{
+    m_tasks.clear();
+    m_jobs.clear();
+}
+
+void TaskGraph::run(JobSystem& jobs)
+{
+    if (m_tasks.empty()) return;
+
+    if (m_remainingSize != m_tasks.size())
+    {
+        m_remaining.reset(new std::atomic<int>[m_tasks.size()]);
+        m_remainingSize = m_tasks.size();
+    }
+
+    m_running = &jobs;
+    m_jobs.clear();
+    for (std::size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        m_remaining[i].store(m_tasks[i].dependencies, std::memory_order_relaxed);
+        if (m_tasks[i].dependencies == 0)
+            m_jobs.push_back(Job{ &TaskGraph::runTask, this, static_cast<int>(i), 0, &m_pending });
+    }
+    m_pending.store(static_cast<int>(m_tasks.size()), std::memory_order_release);
+
+    jobs.submit(m_jobs.data(), m_jobs.size());
+    jobs.wait(m_pending);
+    m_running = nullptr;
+}
+
+void TaskGraph::runTask(void* data, int index, int)
+{
+    auto* graph = static_cast<TaskGraph*>(data);
+    const Task& task = graph->m_tasks[index];
+    task.fn();
+
+    // Release successors before this task's own completion is counted, so
+    // m_pending cannot reach zero while work is still being scheduled
+    for (TaskId next : task.successors)
+    {
+        if (graph->m_remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Job job{ &TaskGraph::runTask, graph, static_cast<int>(next), 0, &graph->m_pending };
+            graph->m_running->submit(&job, 1);
+        }
+    }
+}
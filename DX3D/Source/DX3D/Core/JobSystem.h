@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dx3d {
+    // Bump allocator for short-lived per-thread data. Blocks are kept after
+    // rewind()/reset(), so steady-state frames do not touch the heap.
+    // Only trivially destructible types belong here; nothing is destroyed.
+    class ScratchArena {
+    public:
+        struct Marker {
+            std::size_t block = 0;
+            std::size_t offset = 0;
+        };
+
+        explicit ScratchArena(std::size_t blockSize = 64 * 1024);
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+
+        void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+        template<typename T>
+        T* allocate(std::size_t count) {
+            static_assert(std::is_trivially_destructible_v<T>, "ScratchArena never runs destructors");
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        Marker getMarker() const { return { m_block, m_offset }; }
+        void rewind(Marker marker) { m_block = marker.block; m_offset = marker.offset; }
+        void reset() { m_block = 0; m_offset = 0; }
+        std::size_t getCapacity() const;
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size = 0;
+        };
+
+        std::vector<Block> m_blocks;
+        std::size_t m_blockSize;
+        std::size_t m_block = 0;
+        std::size_t m_offset = 0;
+    };
+
+    // Rewinds an arena to where it was when the scope was opened
+    class ScratchScope {
+    public:
+        explicit ScratchScope(ScratchArena& arena) : m_arena(arena), m_marker(arena.getMarker()) {}
+        ~ScratchScope() { m_arena.rewind(m_marker); }
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+
+    private:
+        ScratchArena& m_arena;
+        ScratchArena::Marker m_marker;
+    };
+
+    // A unit of work: fn(data, begin, end). pending is decremented when it finishes.
+    struct Job {
+        void (*fn)(void* data, int begin, int end) = nullptr;
+        void* data = nullptr;
+        int begin = 0;
+        int end = 0;
+        std::atomic<int>* pending = nullptr;
+    };
+
+    // Persistent worker pool with one work-stealing queue per thread. Owners push and
+    // pop at the back (LIFO, cache-warm); idle threads steal from the front of others.
+    // Threads that wait on work (parallelFor, TaskGraph::run) execute jobs while they wait,
+    // so nested parallel loops cannot deadlock.
+    //
+    // Thread index 0 is the non-worker slot and is meant for the main thread; workers
+    // are 1..getWorkerCount().
+    class JobSystem {
+    public:
+        explicit JobSystem(unsigned workerCount);
+        ~JobSystem();
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // Engine-wide pool with hardware_concurrency() - 1 workers
+        static JobSystem& getInstance();
+
+        unsigned getWorkerCount() const { return static_cast<unsigned>(m_workers.size()); }
+        // Workers plus the calling thread
+        unsigned getThreadCount() const { return getWorkerCount() + 1; }
+
+        // Index of the calling thread in [0, getThreadCount()); 0 for non-worker threads
+        unsigned getThreadIndex() const;
+        // Scratch arena owned by the calling thread
+        ScratchArena& getScratch();
+
+        // Run fn(rangeBegin, rangeEnd) over [begin, end) split into chunks of at least
+        // grain items. maxThreads > 0 caps how many threads work on the loop at once.
+        // Blocks until every chunk has finished; the caller runs chunks too.
+        template<typename Fn>
+        void parallelFor(int begin, int end, int grain, Fn&& fn, int maxThreads = 0) {
+            const int total = end - begin;
+            if (total <= 0) return;
+            grain = std::max(1, grain);
+
+            int threads = static_cast<int>(getThreadCount());
+            if (maxThreads > 0) threads = std::min(threads, maxThreads);
+            // Over-decompose when uncapped so stealing can balance uneven chunks
+            const int maxChunks = (maxThreads > 0) ? threads : threads * 4;
+            const int chunks = std::min((total + grain - 1) / grain, maxChunks);
+            if (chunks <= 1) {
+                fn(begin, end);
+                return;
+            }
+
+            using F = std::remove_reference_t<Fn>;
+            std::atomic<int> pending(chunks - 1);
+            // Jobs are copied into the queue, so the array only has to outlive submit()
+            ScratchArena& scratch = getScratch();
+            ScratchScope scope(scratch);
+            Job* jobs = scratch.allocate<Job>(static_cast<std::size_t>(chunks - 1));
+            for (int c = 1; c < chunks; ++c) {
+                Job& job = jobs[c - 1];
+                job.fn = [](void* data, int b, int e) { (*static_cast<F*>(data))(b, e); };
+                job.data = const_cast<void*>(static_cast<const void*>(std::addressof(fn)));
+                job.begin = begin + static_cast<int>(static_cast<long long>(total) * c / chunks);
+                job.end = begin + static_cast<int>(static_cast<long long>(total) * (c + 1) / chunks);
+                job.pending = &pending;
+            }
+            submit(jobs, static_cast<std::size_t>(chunks - 1));
+
+            fn(begin, begin + static_cast<int>(static_cast<long long>(total) / chunks));
+            wait(pending);
+        }
+
+        // Queue jobs on the calling thread's queue and wake workers
+        void submit(const Job* jobs, std::size_t count);
+        // Execute queued jobs until pending reaches zero
+        void wait(const std::atomic<int>& pending);
+
+    private:
+        class WorkQueue {
+        public:
+            void push(const Job* jobs, std::size_t count);
+            bool pop(Job& job);
+            bool steal(Job& job);
+
+        private:
+            std::mutex m_mutex;
+            std::vector<Job> m_ring;
+            std::size_t m_head = 0;
+            std::size_t m_count = 0;
+        };
+
+        struct ThreadState {
+            WorkQueue queue;
+            ScratchArena scratch;
+        };
+
+        void workerLoop(unsigned index);
+        bool runOne(unsigned index);
+        static void execute(const Job& job);
+
+        std::vector<std::unique_ptr<ThreadState>> m_states; // [0] = non-worker slot
+        std::vector<std::thread> m_workers;
+        std::atomic<int> m_queued{ 0 };
+        std::atomic<bool> m_stop{ false };
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wake;
+    };
+
+    // Dependency graph of tasks run on a JobSystem. Edges must form a DAG.
+    // Build once and run() every frame; running does not allocate.
+    class TaskGraph {
+    public:
+        using TaskId = std::uint32_t;
+
+        TaskId add(std::function<void()> fn);
+        // then runs only after first has finished
+        void precede(TaskId first, TaskId then);
+        // Execute every task, respecting dependencies; blocks until all are done
+        void run(JobSystem& jobs = JobSystem::getInstance());
+
+        std::size_t size() const { return m_tasks.size(); }
+        void clear();
+
+    private:
+        struct Task {
+            std::function<void()> fn;
+            std::vector<TaskId> successors;
+            int dependencies = 0;
+        };
+
+        static void runTask(void* data, int index, int);
+
+        std::vector<Task> m_tasks;
+        std::unique_ptr<std::atomic<int>[]> m_remaining;
+        std::size_t m_remainingSize = 0;
+        std::vector<Job> m_jobs;
+        JobSystem* m_running = nullptr;
+        std::atomic<int> m_pending{ 0 };
+    };
+}
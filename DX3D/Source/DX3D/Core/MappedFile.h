@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dx3d {
+    // Read-only memory mapping of a whole file. Pages are loaded by the OS on first
+    // touch, so opening is O(1) regardless of the file size.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Returns false (and stays closed) when the file is missing, empty or cannot be mapped
+        bool open(const std::string& path);
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        const std::uint8_t* getData() const { return m_data; }
+        std::size_t getSize() const { return m_size; }
+
+    private:
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;    // HANDLE
+        void* m_mapping = nullptr; // HANDLE
+#else
+        int m_fd = -1;
+#endif
+    };
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace dx3d {
+    // Interned string id. Equality and hashing are integer operations; the text
+    // lives once in the process-wide NameTable. Value 0 is the empty name.
+    struct NameId {
+        std::uint32_t value = 0;
+
+        bool isValid() const { return value != 0; }
+        bool operator==(const NameId& other) const { return value == other.value; }
+        bool operator!=(const NameId& other) const { return value != other.value; }
+    };
+
+    // Process-wide string interner. Interned strings are never freed, so the
+    // references returned by str() stay valid for the lifetime of the program.
+    // Names must come from a bounded set (fixed entity names, asset names): a name
+    // built per spawn or per frame would grow the table for good. Leave spawned
+    // entities unnamed and keep their EntityHandle or a component instead.
+    class NameTable {
+    public:
+        static constexpr std::uint32_t ChunkSize = 1024;
+        static constexpr std::uint32_t MaxChunks = 1024;
+        static constexpr std::uint32_t Capacity = ChunkSize * MaxChunks;
+
+        // Return the id for name, adding it on first use. Throws once Capacity
+        // names exist, which only unbounded name generation can reach.
+        static NameId intern(std::string_view name) {
+            if (name.empty()) return {};
+            auto& table = instance();
+            std::lock_guard<std::mutex> lock(table.m_mutex);
+            auto it = table.m_ids.find(name);
+            if (it != table.m_ids.end()) return { it->second };
+
+            const std::uint32_t value = table.m_count.load(std::memory_order_relaxed);
+            if (value == Capacity) throw std::length_error("NameTable is full; entity names must come from a bounded set");
+            std::string* chunk = table.m_chunks[value / ChunkSize].load(std::memory_order_relaxed);
+            if (!chunk) {
+                chunk = new std::string[ChunkSize];
+                table.m_chunks[value / ChunkSize].store(chunk, std::memory_order_relaxed);
+            }
+            std::string& stored = chunk[value % ChunkSize];
+            stored = name;
+            table.m_ids.emplace(std::string_view(stored), value);
+            // Publishes the string (and its chunk) to str() on other threads
+            table.m_count.store(value + 1, std::memory_order_release);
+            return { value };
+        }
+
+        // Look up an existing id without inserting; invalid if name was never interned
+        static NameId find(std::string_view name) {
+            if (name.empty()) return {};
+            auto& table = instance();
+            std::lock_guard<std::mutex> lock(table.m_mutex);
+            auto it = table.m_ids.find(name);
+            return (it != table.m_ids.end()) ? NameId{ it->second } : NameId{};
+        }
+
+        // Lock-free: published strings are never moved or modified
+        static const std::string& str(NameId id) {
+            auto& table = instance();
+            if (id.value >= table.m_count.load(std::memory_order_acquire)) id = {};
+            return table.m_chunks[id.value / ChunkSize].load(std::memory_order_relaxed)[id.value % ChunkSize];
+        }
+
+    private:
+        NameTable() {
+            // Id 0 is the empty name
+            m_chunks[0].store(new std::string[ChunkSize], std::memory_order_relaxed);
+            m_count.store(1, std::memory_order_release);
+        }
+
+        ~NameTable() {
+            for (auto& chunk : m_chunks) delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        static NameTable& instance() {
+            static NameTable s_table;
+            return s_table;
+        }
+
+        // Guards insertion and m_ids; str() reads the chunks without it
+        std::mutex m_mutex;
+        // Fixed-size chunks keep string addresses stable, so the map can key on views
+        // into them and readers never see a reallocation
+        std::array<std::atomic<std::string*>, MaxChunks> m_chunks{};
+        std::atomic<std::uint32_t> m_count{ 0 };
+        std::unordered_map<std::string_view, std::uint32_t> m_ids;
+    };
+}
+
+template<>
+struct std::hash<dx3d::NameId> {
+    std::size_t operator()(const dx3d::NameId& id) const noexcept { return id.value; }
+};
@@ -0,0 +1,265 @@
+#pragma once
+#include <DX3D/Core/JobSystem.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dx3d
+{
+    // Key -> shared resource cache. Each resource is loaded once and then shared;
+    // callers hold shared_ptrs and the cache holds one more, so an entry is in use
+    // while anything outside the cache still references it. Over the byte budget the
+    // least recently used entries that are not in use are evicted; in-use entries
+    // are never dropped, so the budget can be exceeded while they stay referenced.
+    //
+    // prefetch() runs a loader on the JobSystem; get() on that key waits for it
+    // (running queued jobs meanwhile), and loads the key itself if the prefetch
+    // failed. Loaders run without the lock held, so they may use the cache for other
+    // keys. Failed loads return nullptr and are not cached.
+    template<typename T>
+    class ResourceCache
+    {
+    public:
+        struct Loaded
+        {
+            std::shared_ptr<T> resource;
+            std::size_t bytes = 0;
+        };
+        using Loader = std::function<Loaded()>;
+
+        struct Stats
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+            std::size_t bytesResident = 0;
+            std::size_t entries = 0;
+            std::size_t pending = 0; // prefetches not yet collected
+        };
+
+        explicit ResourceCache(std::size_t budgetBytes = SIZE_MAX, JobSystem& jobs = JobSystem::getInstance())
+            : m_budget(budgetBytes), m_jobs(jobs) {}
+        ~ResourceCache() { waitForPrefetches(); }
+        ResourceCache(const ResourceCache&) = delete;
+        ResourceCache& operator=(const ResourceCache&) = delete;
+
+        // Cached resource for key, loading it with load on a miss
+        std::shared_ptr<T> get(const std::wstring& key, const Loader& load);
+        // Start loading key in the background unless it is cached or already loading
+        void prefetch(const std::wstring& key, Loader load);
+        // Block until every prefetch has finished (their results stay pending until used)
+        void waitForPrefetches();
+
+        bool contains(const std::wstring& key) const;
+        void setBudget(std::size_t bytes);
+        std::size_t getBudget() const { return m_budget; }
+        // Evict every entry not in use, including finished prefetches; returns how many
+        std::size_t trim();
+        Stats getStats() const;
+
+    private:
+        struct Pending
+        {
+            std::atomic<int> remaining{ 1 };
+            Loader load;
+            Loaded result;
+        };
+
+        struct Entry
+        {
+            Loaded loaded;
+            std::uint64_t lastUse = 0;
+            std::shared_ptr<Pending> pending; // set while a prefetch owns the entry
+        };
+
+        bool isEvictable(const Entry& entry) const { return !entry.pending && entry.loaded.resource.use_count() == 1; }
+        // With m_mutex held: move a finished prefetch's result into its entry (or drop the
+        // entry if the load failed); the caller evicts once it holds the resource
+        void collect(const std::wstring& key, Entry& entry);
+        // With m_mutex held: evict LRU unused entries until under budget
+        void evictOverBudget();
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, Entry> m_entries;
+        std::vector<std::shared_ptr<Pending>> m_inFlight; // kept alive until their jobs finish
+        std::size_t m_budget;
+        std::size_t m_bytes = 0;
+        std::uint64_t m_clock = 0;
+        std::uint64_t m_hits = 0;
+        std::uint64_t m_misses = 0;
+        std::uint64_t m_evictions = 0;
+        JobSystem& m_jobs;
+    };
+
+    template<typename T>
+    std::shared_ptr<T> ResourceCache<T>::get(const std::wstring& key, const Loader& load)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end() && it->second.pending)
+        {
+            // Only a prefetch that produced the resource counts as a hit; a failed one
+            // has dropped its entry, and the key loads below like any miss
+            std::shared_ptr<Pending> pending = it->second.pending;
+            lock.unlock();
+            m_jobs.wait(pending->remaining);
+            lock.lock();
+            it = m_entries.find(key);
+            if (it != m_entries.end() && it->second.pending == pending) collect(key, it->second);
+            it = m_entries.find(key);
+        }
+        if (it != m_entries.end() && !it->second.pending)
+        {
+            ++m_hits;
+            it->second.lastUse = ++m_clock;
+            std::shared_ptr<T> resource = it->second.loaded.resource;
+            evictOverBudget();
+            return resource;
+        }
+
+        ++m_misses;
+        lock.unlock();
+        Loaded loaded = load();
+        lock.lock();
+        if (!loaded.resource) return nullptr;
+
+        // Another thread may have loaded the same key meanwhile; keep the first
+        auto [inserted, fresh] = m_entries.try_emplace(key);
+        if (!fresh && inserted->second.pending) return loaded.resource; // a prefetch is still running
+        if (fresh)
+        {
+            inserted->second.loaded = std::move(loaded);
+            m_bytes += inserted->second.loaded.bytes;
+        }
+        inserted->second.lastUse = ++m_clock;
+        std::shared_ptr<T> resource = inserted->second.loaded.resource;
+        evictOverBudget();
+        return resource;
+    }
+
+    template<typename T>
+    void ResourceCache<T>::prefetch(const std::wstring& key, Loader load)
+    {
+        std::shared_ptr<Pending> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto [it, fresh] = m_entries.try_emplace(key);
+            if (!fresh) return;
+            pending = std::make_shared<Pending>();
+            pending->load = std::move(load);
+            it->second.pending = pending;
+            it->second.lastUse = ++m_clock;
+            std::erase_if(m_inFlight, [](const auto& p) { return p->remaining.load(std::memory_order_acquire) == 0; });
+            m_inFlight.push_back(pending);
+        }
+
+        Job job;
+        job.fn = [](void* data, int, int)
+        {
+            auto* p = static_cast<Pending*>(data);
+            p->result = p->load();
+        };
+        job.data = pending.get();
+        job.pending = &pending->remaining;
+        m_jobs.submit(&job, 1);
+    }
+
+    template<typename T>
+    void ResourceCache<T>::waitForPrefetches()
+    {
+        std::vector<std::shared_ptr<Pending>> inFlight;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            inFlight.swap(m_inFlight);
+        }
+        for (const auto& pending : inFlight) m_jobs.wait(pending->remaining);
+    }
+
+    template<typename T>
+    void ResourceCache<T>::collect(const std::wstring& key, Entry& entry)
+    {
+        Loaded result = std::move(entry.pending->result);
+        entry.pending.reset();
+        if (!result.resource)
+        {
+            m_entries.erase(key);
+            return;
+        }
+        entry.loaded = std::move(result);
+        m_bytes += entry.loaded.bytes;
+    }
+
+    template<typename T>
+    bool ResourceCache<T>::contains(const std::wstring& key) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.find(key) != m_entries.end();
+    }
+
+    template<typename T>
+    void ResourceCache<T>::setBudget(std::size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budget = bytes;
+        evictOverBudget();
+    }
+
+    template<typename T>
+    std::size_t ResourceCache<T>::trim()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Finished prefetches nobody asked for are unused too
+        std::vector<std::wstring> finished;
+        for (const auto& [key, entry] : m_entries)
+            if (entry.pending && entry.pending->remaining.load(std::memory_order_acquire) == 0) finished.push_back(key);
+        for (const auto& key : finished) collect(key, m_entries[key]);
+
+        std::size_t evicted = 0;
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            if (!isEvictable(it->second)) { ++it; continue; }
+            m_bytes -= it->second.loaded.bytes;
+            it = m_entries.erase(it);
+            ++evicted;
+        }
+        m_evictions += evicted;
+        return evicted;
+    }
+
+    template<typename T>
+    typename ResourceCache<T>::Stats ResourceCache<T>::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.evictions = m_evictions;
+        stats.bytesResident = m_bytes;
+        stats.entries = m_entries.size();
+        for (const auto& [key, entry] : m_entries)
+            if (entry.pending) ++stats.pending;
+        return stats;
+    }
+
+    template<typename T>
+    void ResourceCache<T>::evictOverBudget()
+    {
+        while (m_bytes > m_budget)
+        {
+            auto victim = m_entries.end();
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+                if (isEvictable(it->second) && (victim == m_entries.end() || it->second.lastUse < victim->second.lastUse))
+                    victim = it;
+            if (victim == m_entries.end()) return;
+            m_bytes -= victim->second.loaded.bytes;
+            m_entries.erase(victim);
+            ++m_evictions;
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include <DX3D/Core/Scene.h>
+#include <DX3D/Core/EntityManager.h>
 #include <DX3D/Graphics/GraphicsEngine.h>
 #include <DX3D/Graphics/GraphicsDevice.h>
 #include <DX3D/Graphics/Texture2D.h>
@@ -6,6 +7,13 @@
 
 using namespace dx3d;
 
+Scene::~Scene() = default;
+
+void Scene::onFrameEnd()
+{
+    if (m_entityManager) m_entityManager->flushDestroyQueue();
+}
+
 void Scene::renderImGui(GraphicsEngine& engine)
 {
     // Default fallback: show a cat image if available
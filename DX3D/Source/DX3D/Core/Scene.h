@@ -1,13 +1,15 @@
 #pragma once
+#include <memory>
 
 namespace dx3d {
     class GraphicsEngine;
     class SwapChain;
     class Game;
+    class EntityManager;
 
     class Scene {
     public:
-        virtual ~Scene() = default;
+        virtual ~Scene();
 
         // Core scene methods
         virtual void load(GraphicsEngine& engine) = 0;
@@ -16,6 +18,9 @@ namespace dx3d {
         virtual void render(GraphicsEngine& engine, SwapChain& swapChain) = 0;
         // ImGui hook per scene; default draws fallback content
         virtual void renderImGui(GraphicsEngine& engine);
+        // Called once per frame after present; destroys the entities queued with
+        // queueDestroy(). Overrides call Scene::onFrameEnd()
+        virtual void onFrameEnd();
 
         // Input handling methods - override these in derived classes if needed
         virtual void onKeyDown(int keyCode) {}
@@ -23,5 +28,9 @@ namespace dx3d {
         virtual void onMouseMove(int x, int y) {}
         virtual void onMouseClick(int button, int x, int y) {}
         virtual void onMouseRelease(int button, int x, int y) {}
+
+    protected:
+        // Created by the scene in load()
+        std::unique_ptr<EntityManager> m_entityManager;
     };
 }
\ No newline at end of file
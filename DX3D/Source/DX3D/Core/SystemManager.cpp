@@ -0,0 +1,236 @@
+#include <DX3D/Core/SystemManager.h>
+#include <DX3D/Core/EntityManager.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace dx3d;
+
+namespace
+{
+    std::int64_t nowTicks()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    double ticksToMs(std::int64_t ticks)
+    {
+        using Period = std::chrono::steady_clock::period;
+        return static_cast<double>(ticks) * 1000.0 * Period::num / Period::den;
+    }
+
+    // typeid names are compiler specific; keep the part after the last scope/space
+    const char* shortTypeName(const char* name)
+    {
+        const char* result = name;
+        for (const char* c = name; *c; ++c)
+        {
+            if (*c == ':' || *c == ' ') result = c + 1;
+        }
+        return result;
+    }
+}
+
+// ========================= SystemAccess =========================
+
+bool SystemAccess::touches(const std::vector<Entry>& entries, ComponentTypeId id)
+{
+    for (const Entry& entry : entries)
+    {
+        if (entry.id == id) return true;
+    }
+    return false;
+}
+
+bool SystemAccess::conflictsWith(const SystemAccess& other) const
+{
+    if (m_exclusive || other.m_exclusive) return true;
+    for (const Entry& entry : m_writes)
+    {
+        if (touches(other.m_writes, entry.id) || touches(other.m_reads, entry.id)) return true;
+    }
+    for (const Entry& entry : m_reads)
+    {
+        if (touches(other.m_writes, entry.id)) return true;
+    }
+    return false;
+}
+
+void SystemAccess::prepare(ComponentRegistry& registry) const
+{
+    for (auto fn : m_prepare) fn(registry);
+}
+
+std::string SystemAccess::describe() const
+{
+    if (m_exclusive) return "exclusive";
+
+    std::string text;
+    auto append = [&text](const char* label, const std::vector<Entry>& entries)
+    {
+        if (entries.empty()) return;
+        if (!text.empty()) text += "  ";
+        text += label;
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            text += (i == 0) ? " " : ", ";
+            text += shortTypeName(entries[i].name);
+        }
+    };
+    append("reads:", m_reads);
+    append("writes:", m_writes);
+    return text.empty() ? "no component access" : text;
+}
+
+// ========================= SystemManager =========================
+
+SystemManager::SystemManager(JobSystem& jobs)
+    : m_jobs(jobs)
+{
+}
+
+SystemManager::SystemId SystemManager::addSystem(std::string name, SystemAccess access, SystemFn fn)
+{
+    System system;
+    system.name = std::move(name);
+    system.access = std::move(access);
+    system.fn = std::move(fn);
+    m_systems.push_back(std::move(system));
+    m_dirty = true;
+    return static_cast<SystemId>(m_systems.size() - 1);
+}
+
+void SystemManager::setEnabled(SystemId id, bool enabled)
+{
+    // Disabled systems stay in the graph and return immediately, so ordering is unchanged
+    m_systems[id].enabled = enabled;
+}
+
+void SystemManager::build()
+{
+    const std::size_t count = m_systems.size();
+
+    // ancestors[j][i]: system i finishes before j starts. An edge i -> j is only
+    // added when no already-added dependency orders them, which keeps the graph
+    // close to its transitive reduction.
+    std::vector<std::vector<bool>> ancestors(count, std::vector<bool>(count, false));
+    for (std::size_t j = 0; j < count; ++j)
+    {
+        System& system = m_systems[j];
+        system.dependencies.clear();
+        system.stage = 0;
+        for (std::size_t i = j; i-- > 0;)
+        {
+            if (ancestors[j][i] || !m_systems[i].access.conflictsWith(system.access)) continue;
+
+            system.dependencies.push_back(static_cast<SystemId>(i));
+            system.stage = std::max(system.stage, m_systems[i].stage + 1);
+            ancestors[j][i] = true;
+            for (std::size_t k = 0; k < i; ++k)
+            {
+                if (ancestors[i][k]) ancestors[j][k] = true;
+            }
+        }
+        std::reverse(system.dependencies.begin(), system.dependencies.end());
+    }
+
+    m_graph.clear();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const SystemId id = static_cast<SystemId>(i);
+        m_graph.add([this, id]() { runSystem(id); });
+    }
+    for (std::size_t j = 0; j < count; ++j)
+    {
+        for (SystemId dependency : m_systems[j].dependencies)
+            m_graph.precede(dependency, static_cast<TaskGraph::TaskId>(j));
+    }
+    m_dirty = false;
+}
+
+void SystemManager::runSystem(SystemId id)
+{
+    System& system = m_systems[id];
+    if (!system.enabled) return;
+
+    const std::int64_t start = nowTicks();
+    system.fn(*m_entityManager, m_dt);
+    const std::int64_t end = nowTicks();
+
+    SystemStats& stats = system.stats;
+    stats.lastMs = ticksToMs(end - start);
+    stats.averageMs = (stats.averageMs == 0.0) ? stats.lastMs : stats.averageMs * 0.9 + stats.lastMs * 0.1;
+    stats.startMs = ticksToMs(start - m_frameStart);
+    stats.threadIndex = m_jobs.getThreadIndex();
+}
+
+void SystemManager::update(EntityManager& entityManager, float dt)
+{
+    if (m_systems.empty()) return;
+    if (m_dirty) build();
+
+    for (const System& system : m_systems) system.access.prepare(entityManager.getRegistry());
+
+    m_entityManager = &entityManager;
+    m_dt = dt;
+    m_frameStart = nowTicks();
+
+    if (m_parallel && m_jobs.getWorkerCount() > 0)
+    {
+        m_graph.run(m_jobs);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < m_systems.size(); ++i) runSystem(static_cast<SystemId>(i));
+    }
+
+    m_frameMs = ticksToMs(nowTicks() - m_frameStart);
+    m_entityManager = nullptr;
+}
+
+std::string SystemManager::dumpSchedule() const
+{
+    std::string out;
+    char line[256];
+
+    int stages = 0;
+    std::size_t edges = 0;
+    for (const System& system : m_systems)
+    {
+        stages = std::max(stages, system.stage + 1);
+        edges += system.dependencies.size();
+    }
+    std::snprintf(line, sizeof(line), "System schedule: %zu systems, %zu edges, %d stages (%s), last frame %.3f ms\n",
+        m_systems.size(), edges, stages, m_parallel ? "parallel" : "serial", m_frameMs);
+    out += line;
+
+    for (int stage = 0; stage < stages; ++stage)
+    {
+        std::snprintf(line, sizeof(line), "  stage %d\n", stage);
+        out += line;
+        for (std::size_t i = 0; i < m_systems.size(); ++i)
+        {
+            const System& system = m_systems[i];
+            if (system.stage != stage) continue;
+
+            std::snprintf(line, sizeof(line), "    [%zu] %-20s %8.3f ms (avg %.3f) start %.3f ms thread %u%s\n",
+                i, system.name.c_str(), system.stats.lastMs, system.stats.averageMs,
+                system.stats.startMs, system.stats.threadIndex, system.enabled ? "" : " (disabled)");
+            out += line;
+
+            out += "        ";
+            out += system.access.describe();
+            if (!system.dependencies.empty())
+            {
+                out += "\n        after:";
+                for (SystemId dependency : system.dependencies)
+                {
+                    out += ' ';
+                    out += m_systems[dependency].name;
+                }
+            }
+            out += '\n';
+        }
+    }
+    return out;
+}
@@ -1,63 +1,138 @@
 #pragma once
-#include "Entity.h"
-#include <unordered_map>
-#include <memory>
-#include <set>
-#include <bitset>
+#include <DX3D/Core/ComponentStorage.h>
+#include <DX3D/Core/JobSystem.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <typeinfo>
+#include <vector>
 
 namespace dx3d {
-    using Signature = std::bitset<32>;
+    class EntityManager;
 
-    class System {
+    // Component types a system reads and writes. Two systems conflict when either
+    // one writes a type the other touches; conflicting systems keep their
+    // registration order, everything else may run concurrently.
+    class SystemAccess {
     public:
-        std::set<EntityID> m_entities;
-    };
-
-    class SystemManager {
-    public:
-        template<typename T>
-        std::shared_ptr<T> registerSystem() {
-            const char* typeName = typeid(T).name();
-            auto system = std::make_shared<T>();
-            m_systems.insert({typeName, system});
-            return system;
+        template<typename... Ts>
+        SystemAccess& read() {
+            (add<Ts>(m_reads), ...);
+            return *this;
         }
 
-        template<typename T>
-        void setSignature(Signature signature) {
-            const char* typeName = typeid(T).name();
-            m_signatures.insert({typeName, signature});
+        template<typename... Ts>
+        SystemAccess& write() {
+            (add<Ts>(m_writes), ...);
+            return *this;
         }
 
-        void entityDestroyed(EntityID entity) {
-            for (auto const& pair : m_systems) {
-                auto const& system = pair.second;
-                system->m_entities.erase(entity);
-            }
+        // Conflict with every other system (entity creation/destruction, global state)
+        SystemAccess& exclusive() {
+            m_exclusive = true;
+            return *this;
         }
 
-        void entitySignatureChanged(EntityID entity, Signature entitySignature) {
-            for (auto const& pair : m_systems) {
-                auto const& type = pair.first;
-                auto const& system = pair.second;
-                auto const& systemSignature = m_signatures[type];
-
-                if ((entitySignature & systemSignature) == systemSignature) {
-                    system->m_entities.insert(entity);
-                } else {
-                    system->m_entities.erase(entity);
-                }
-            }
-        }
+        bool isExclusive() const { return m_exclusive; }
+        bool conflictsWith(const SystemAccess& other) const;
+        // Create the component pools up front so concurrent systems never resize the registry
+        void prepare(ComponentRegistry& registry) const;
+        // "reads: A, B  writes: C"
+        std::string describe() const;
+
+    private:
+        struct Entry {
+            ComponentTypeId id = 0;
+            const char* name = nullptr;
+        };
 
         template<typename T>
-        std::shared_ptr<T> getSystem() {
-            const char* typeName = typeid(T).name();
-            return std::static_pointer_cast<T>(m_systems[typeName]);
+        void add(std::vector<Entry>& entries) {
+            const ComponentTypeId id = getComponentTypeId<T>();
+            for (const Entry& entry : entries) {
+                if (entry.id == id) return;
+            }
+            entries.push_back({ id, typeid(T).name() });
+            m_prepare.push_back([](ComponentRegistry& registry) { registry.assure<T>(); });
         }
 
+        static bool touches(const std::vector<Entry>& entries, ComponentTypeId id);
+
+        std::vector<Entry> m_reads;
+        std::vector<Entry> m_writes;
+        std::vector<void(*)(ComponentRegistry&)> m_prepare;
+        bool m_exclusive = false;
+    };
+
+    // Runs per-frame systems on the JobSystem. Systems declare their component access;
+    // the manager derives a dependency DAG from it (rebuilt only when the system list
+    // changes) and runs non-conflicting systems in parallel.
+    //
+    // While systems run in parallel they must not add/remove components or entities
+    // (declare those systems exclusive) and multi-component views they use should
+    // already exist, since creating a view mutates the registry.
+    class SystemManager {
+    public:
+        using SystemId = std::uint32_t;
+        using SystemFn = std::function<void(EntityManager&, float)>;
+
+        struct SystemStats {
+            double lastMs = 0.0;
+            double averageMs = 0.0; // exponential moving average
+            double startMs = 0.0;   // offset from the start of the frame
+            unsigned threadIndex = 0;
+        };
+
+        explicit SystemManager(JobSystem& jobs = JobSystem::getInstance());
+
+        SystemId addSystem(std::string name, SystemAccess access, SystemFn fn);
+        void setEnabled(SystemId id, bool enabled);
+        bool isEnabled(SystemId id) const { return m_systems[id].enabled; }
+
+        // false runs every system on the calling thread in registration order
+        void setParallel(bool parallel) { m_parallel = parallel; }
+        bool isParallel() const { return m_parallel; }
+
+        // Derive dependencies and stages now; update() does this lazily after changes
+        void build();
+        // Run every enabled system once
+        void update(EntityManager& entityManager, float dt);
+
+        std::size_t getSystemCount() const { return m_systems.size(); }
+        const std::string& getSystemName(SystemId id) const { return m_systems[id].name; }
+        const SystemStats& getSystemStats(SystemId id) const { return m_systems[id].stats; }
+        // Systems this one waits for (after transitive reduction)
+        const std::vector<SystemId>& getDependencies(SystemId id) const { return m_systems[id].dependencies; }
+        // Longest dependency chain leading to this system; systems in the same stage can overlap
+        int getStage(SystemId id) const { return m_systems[id].stage; }
+        double getFrameMs() const { return m_frameMs; }
+
+        // Human-readable schedule: stages, dependencies, declared access and timings
+        std::string dumpSchedule() const;
+
     private:
-        std::unordered_map<const char*, Signature> m_signatures{};
-        std::unordered_map<const char*, std::shared_ptr<System>> m_systems{};
+        struct System {
+            std::string name;
+            SystemAccess access;
+            SystemFn fn;
+            bool enabled = true;
+            std::vector<SystemId> dependencies;
+            int stage = 0;
+            SystemStats stats;
+        };
+
+        void runSystem(SystemId id);
+
+        JobSystem& m_jobs;
+        std::vector<System> m_systems;
+        TaskGraph m_graph;
+        bool m_dirty = true;
+        bool m_parallel = true;
+
+        // Per-update state read by the graph tasks
+        EntityManager* m_entityManager = nullptr;
+        float m_dt = 0.0f;
+        std::int64_t m_frameStart = 0;
+        double m_frameMs = 0.0;
     };
-}
\ No newline at end of file
+}
@@ -42,6 +42,7 @@ SOFTWARE.*/
 #include <DX3D/Game/Scenes/CloudScene.h>
 #include <DX3D/Game/Scenes/PowderScene.h>
 #include <DX3D/Graphics/SwapChain.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 
 // Define the static Game instance
 namespace dx3d {
@@ -66,6 +67,11 @@ dx3d::Game::Game(const GameDesc& desc) :
     m_graphicsEngine = std::make_unique<GraphicsEngine>(GraphicsEngineDesc{ m_logger });
     m_display = std::make_unique<Display>(DisplayDesc{ {m_logger,desc.windowSize},m_graphicsEngine->getGraphicsDevice() });
 
+    // Textures shared by the particle scenes decode in the background while the first scene loads
+    auto& resourceCache = m_graphicsEngine->getGraphicsDevice().getResourceCache();
+    resourceCache.prefetchTexture(L"DX3D/Assets/Textures/node.png");
+    resourceCache.prefetchTexture(L"DX3D/Assets/Textures/MetaballFalloff.png");
+
     m_lastFrameTime = std::chrono::steady_clock::now();
     setScene(std::make_unique<dx3d::BridgeScene>());
     m_currentSceneType = SceneType::BridgeScene;
@@ -272,6 +278,22 @@ void dx3d::Game::onInternalUpdate()
                 }
             }
             ImGui::TextDisabled("Hotkeys: 1-9, 0, P switch scenes");
+
+            if (ImGui::CollapsingHeader("Resource Cache"))
+            {
+                auto& resourceCache = m_graphicsEngine->getGraphicsDevice().getResourceCache();
+                auto showStats = [](const char* label, const auto& stats)
+                {
+                    ImGui::Text("%s: %zu resident, %.2f MiB", label, stats.entries, stats.bytesResident / (1024.0 * 1024.0));
+                    ImGui::Text("  hits %llu, misses %llu, evicted %llu, prefetched %zu",
+                        static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+                        static_cast<unsigned long long>(stats.evictions), stats.pending);
+                };
+                showStats("Textures", resourceCache.getTextureStats());
+                showStats("Meshes", resourceCache.getMeshStats());
+                if (ImGui::Button("Trim unused"))
+                    resourceCache.trim();
+            }
         }
         ImGui::End();
     }
@@ -303,6 +325,9 @@ void dx3d::Game::onInternalUpdate()
     // Present after ImGui so UI is visible
     m_graphicsEngine->endFrame(m_display->getSwapChain());
 
+    if (m_activeScene)
+        m_activeScene->onFrameEnd();
+
     input.update();
     //if(true)
     if(imguiRebuild)
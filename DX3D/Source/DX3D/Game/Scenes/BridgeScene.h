@@ -39,7 +39,6 @@ namespace dx3d {
 
     private:
         // Core systems
-        std::unique_ptr<EntityManager> m_entityManager;
         GraphicsDevice* m_graphicsDevice = nullptr;
         SceneMode m_currentMode = SceneMode::Build;
         bool m_isSimulationRunning = false;
@@ -53,7 +52,7 @@ namespace dx3d {
         Entity* m_tempBeam = nullptr;            // Temporary beam being created
 
         // Legacy dragging system (kept for compatibility)
-        Entity* m_draggedNode = nullptr;         // The node being dragged
+        EntityRef m_draggedNode;                 // The node being dragged
         Entity* m_draggedFromNode = nullptr;     // The original node we clicked on
         Vec2 m_dragOffset{ 0.0f, 0.0f };
 
@@ -27,7 +27,6 @@ namespace dx3d
 
     private:
         // Core components
-        std::unique_ptr<EntityManager> m_entityManager;
         Camera3D m_camera3D;
         LineRenderer* m_lineRenderer = nullptr;
         GraphicsDevice* m_graphicsDevice = nullptr;
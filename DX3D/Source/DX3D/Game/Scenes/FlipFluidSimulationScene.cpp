@@ -1,10 +1,12 @@
 #include <DX3D/Game/Scenes/FlipFluidSimulationScene.h>
 #include <DX3D/Graphics/GraphicsEngine.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 #include <DX3D/Graphics/SwapChain.h>
 #include <DX3D/Graphics/Camera.h>
 #include <DX3D/Graphics/SpriteComponent.h>
 #include <DX3D/Graphics/LineRenderer.h>
 #include <imgui.h>
+#include <chrono>
 #include <cmath>
 #include <sstream>
 #include <algorithm>
@@ -12,17 +14,17 @@
 
 using namespace dx3d;
 
-static inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
-
-
 void FlipFluidSimulationScene::load(GraphicsEngine& engine)
 {
     auto& device = engine.getGraphicsDevice();
     m_graphicsDevice = &device;
     m_entityManager = std::make_unique<EntityManager>();
+    m_threadCount = static_cast<int>(JobSystem::getInstance().getThreadCount());
 
-    // Preload node texture for Sprites mode
-    m_nodeTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), L"DX3D/Assets/Textures/node.png");
+    // Particle batch materials: node.png for Sprites mode, the falloff for Metaballs mode
+    m_particleBatchDevice = std::make_unique<ParticleBatchDevice>(device);
+    m_nodeMaterial = m_particleBatchDevice->addMaterial(device.getResourceCache().getTexture(L"DX3D/Assets/Textures/node.png"));
+    m_metaballMaterial = m_particleBatchDevice->addMaterial(device.getResourceCache().getTexture(L"DX3D/Assets/Textures/MetaballFalloff.png"));
 
     // Camera
     createCamera(engine);
@@ -52,18 +54,11 @@ void FlipFluidSimulationScene::load(GraphicsEngine& engine)
     m_gridOrigin.x += 10.0f * m_cellSize;  // Offset by 10 cells to center
     m_gridOrigin.y += 10.0f * m_cellSize;  // Offset by 10 cells to center
 
-    // Allocate grid arrays
-    m_u.assign((m_gridWidth + 1) * m_gridHeight, 0.0f);
-    m_v.assign(m_gridWidth * (m_gridHeight + 1), 0.0f);
-    m_uWeight.assign((m_gridWidth + 1) * m_gridHeight, 0.0f);
-    m_vWeight.assign(m_gridWidth * (m_gridHeight + 1), 0.0f);
-    m_pressure.assign(m_gridWidth * m_gridHeight, 0.0f);
-    m_divergence.assign(m_gridWidth * m_gridHeight, 0.0f);
-    m_solid.assign(m_gridWidth * m_gridHeight, 0);
-    m_cellParticleCount.assign(m_gridWidth * m_gridHeight, 0);
+    // Grid tiles are allocated around the particles every step
+    m_grid.resize(m_gridOrigin.x, m_gridOrigin.y, m_cellSize, m_gridWidth, m_gridHeight);
 
-    // spatial hash default cell size ~ 2x radius
-    m_hashCellSize = std::max(m_particleRadius * 2.0f, 1.0f);
+    // collision grid default cell size ~ 2x radius (the contact distance)
+    m_collisionCellSize = std::max(m_particleRadius * 2.0f, 1.0f);
 
     // Create boundaries and particles
     createBoundaries();
@@ -81,6 +76,7 @@ void FlipFluidSimulationScene::load(GraphicsEngine& engine)
 void FlipFluidSimulationScene::createCamera(GraphicsEngine& engine)
 {
     auto& cameraEntity = m_entityManager->createEntity("MainCamera");
+    m_cameraEntity = cameraEntity.getHandle();
     float screenWidth = GraphicsEngine::getWindowWidth();
     float screenHeight = GraphicsEngine::getWindowHeight();
     auto& camera = cameraEntity.addComponent<Camera2D>(screenWidth, screenHeight);
@@ -88,15 +84,15 @@ void FlipFluidSimulationScene::createCamera(GraphicsEngine& engine)
     camera.setZoom(0.8f);
 }
 
-std::string FlipFluidSimulationScene::boundaryName(int i) const
+NameId FlipFluidSimulationScene::boundaryName(int i) const
 {
-    switch (i)
-    {
-    case 0: return "BoundaryLeft";
-    case 1: return "BoundaryRight";
-    case 2: return "BoundaryBottom";
-    default: return "BoundaryTop";
-    }
+    static const NameId names[4] = {
+        NameTable::intern("BoundaryLeft"),
+        NameTable::intern("BoundaryRight"),
+        NameTable::intern("BoundaryBottom"),
+        NameTable::intern("BoundaryTop")
+    };
+    return names[std::clamp(i, 0, 3)];
 }
 
 
@@ -105,7 +101,7 @@ std::string FlipFluidSimulationScene::boundaryName(int i) const
 void FlipFluidSimulationScene::createBoundaries()
 {
     // Create FirmGuy physics boundaries with visual sprites
-    auto addBoundary = [&](const std::string& name, const Vec2& pos, float w, float h)
+    auto addBoundary = [&](NameId name, const Vec2& pos, float w, float h)
     {
         auto& e = m_entityManager->createEntity(name);
         
@@ -150,7 +146,6 @@ void FlipFluidSimulationScene::spawnParticles()
     Vec2 start = m_gridOrigin + Vec2(m_domainWidth * 0.15f, m_domainHeight * 0.55f);
     float spacing = m_particleRadius * 2.0f * 0.9f;
 
-    int id = 0;
     for (int j = 0; j < particlesY; ++j)
     {
         for (int i = 0; i < particlesX; ++i)
@@ -158,13 +153,7 @@ void FlipFluidSimulationScene::spawnParticles()
             Particle p;
             p.position = start + Vec2(i * spacing, j * spacing);
             p.velocity = Vec2(0.0f, 0.0f);
-            p.entityName = "Particle_" + std::to_string(id++);
-
-            auto& e = m_entityManager->createEntity(p.entityName);
-            auto& s = e.addComponent<SpriteComponent>(*m_graphicsDevice, L"DX3D/Assets/Textures/MetaballFalloff.png", m_particleRadius * 2.0f, m_particleRadius * 2.0f);
-            s.setPosition(p.position.x, p.position.y, 0.0f);
-            s.setTint(Vec4(0.2f, 0.6f, 1.0f, 1.0f));
-            
+            p.color = Vec4(0.2f, 0.6f, 1.0f, 1.0f);
             m_particles.push_back(p);
         }
     }
@@ -208,7 +197,7 @@ void FlipFluidSimulationScene::update(float dt)
     }
 
     // Camera zoom with Q/E
-    if (auto* camEnt = m_entityManager->findEntity("MainCamera"))
+    if (auto* camEnt = m_entityManager->getEntity(m_cameraEntity))
     {
         if (auto* cam = camEnt->getComponent<Camera2D>())
         {
@@ -293,8 +282,6 @@ void FlipFluidSimulationScene::fixedUpdate(float dt)
     
     // Apply buoyancy forces to ball
     applyBallBuoyancy();
-
-    updateParticleSprites();
     
     // Clustered mesh mode removed - not worth keeping
     
@@ -302,7 +289,7 @@ void FlipFluidSimulationScene::fixedUpdate(float dt)
     // generateFluidSurface();
     
     // Only sync boundary sprites to rotated box (not position updates)
-    auto syncBoundarySprite = [&](const std::string& name, const Vec2& localCenter, float halfW, float halfH)
+    auto syncBoundarySprite = [&](NameId name, const Vec2& localCenter, float halfW, float halfH)
     {
         float c = cosf(m_boxAngle), s = sinf(m_boxAngle);
         Vec2 worldCenter = m_boxCenter + Vec2(c * localCenter.x - s * localCenter.y, s * localCenter.x + c * localCenter.y);
@@ -325,7 +312,7 @@ void FlipFluidSimulationScene::render(GraphicsEngine& engine, SwapChain& swapCha
 {
     auto& ctx = engine.getContext();
 
-    if (auto* cameraEntity = m_entityManager->findEntity("MainCamera"))
+    if (auto* cameraEntity = m_entityManager->getEntity(m_cameraEntity))
     {
         if (auto* camera = cameraEntity->getComponent<Camera2D>())
         {
@@ -348,20 +335,18 @@ void FlipFluidSimulationScene::render(GraphicsEngine& engine, SwapChain& swapCha
     }
     else // Sprites mode
     {
-        // Use node.png for particle sprites in Sprites mode
-        for (auto* entity : m_entityManager->getEntitiesWithComponent<SpriteComponent>())
+        // Particles as node.png quads in one batch, then the boundary and ball sprites
+        for (const auto& p : m_particles)
+            m_particleBatch.add(m_nodeMaterial, p.position.x, p.position.y, m_particleRadius * 2.0f,
+                packParticleColor(p.color.x, p.color.y, p.color.z, 1.0f));
+        if (m_particleBatchDevice) m_particleBatchDevice->draw(engine, ctx, m_particleBatch);
+        m_particleBatch.clear();
+
+        m_entityManager->view<SpriteComponent>().each([&](Entity& entity, SpriteComponent& sprite)
         {
-            if (auto* sprite = entity->getComponent<SpriteComponent>())
-            {
-                const std::string& n = entity->getName();
-                if (n.rfind("Particle_", 0) == 0 && m_nodeTexture)
-                {
-                    sprite->setTexture(m_nodeTexture);
-                }
-                if (sprite->isVisible() && sprite->isValid())
-                    sprite->draw(ctx);
-            }
-        }
+            if (sprite.isVisible() && sprite.isValid())
+                sprite.draw(ctx);
+        });
     }
     
     // Anchor sprite removed - no longer needed for debugging
@@ -387,6 +372,19 @@ void FlipFluidSimulationScene::render(GraphicsEngine& engine, SwapChain& swapCha
             m_lineRenderer->addLine(Vec2(m_gridOrigin.x, y), Vec2(m_gridOrigin.x + m_domainWidth, y), color, 1.0f);
         }
 
+        // allocated grid tiles
+        Vec4 tileCol = Vec4(1.0f, 0.8f, 0.2f, 0.25f);
+        const float tileSize = FlipSparseGrid::TileSize * m_cellSize;
+        for (int slot = 0; slot < m_grid.getTileCount(); ++slot)
+        {
+            Vec2 lo = m_gridOrigin + Vec2(m_grid.getTileX(slot) * tileSize, m_grid.getTileY(slot) * tileSize);
+            Vec2 hi = lo + Vec2(tileSize, tileSize);
+            m_lineRenderer->addLine(lo, Vec2(hi.x, lo.y), tileCol, 1.0f);
+            m_lineRenderer->addLine(Vec2(hi.x, lo.y), hi, tileCol, 1.0f);
+            m_lineRenderer->addLine(hi, Vec2(lo.x, hi.y), tileCol, 1.0f);
+            m_lineRenderer->addLine(Vec2(lo.x, hi.y), lo, tileCol, 1.0f);
+        }
+
         // draw rotated box outline
         float c = cosf(m_boxAngle), s = sinf(m_boxAngle);
         Vec2 hx = Vec2(m_boxHalf.x, 0.0f);
@@ -413,7 +411,7 @@ void FlipFluidSimulationScene::render(GraphicsEngine& engine, SwapChain& swapCha
     // renderFluidSurface(engine, ctx);
 
     // Update FirmGuy boundary positions and rotations to match box angle
-    auto updateBoundaryPhysics = [&](const std::string& name, const Vec2& localPos)
+    auto updateBoundaryPhysics = [&](NameId name, const Vec2& localPos)
     {
         if (auto* e = m_entityManager->findEntity(name))
         {
@@ -454,8 +452,23 @@ void FlipFluidSimulationScene::renderImGui(GraphicsEngine& engine)
         ImGui::Checkbox("Show Grid", &m_showGridDebug);
         // Grid debug display removed - not needed for simplified rendering modes
         ImGui::SliderFloat("Gravity", &m_gravity, -2000.0f, 0.0f, "%.0f");
-        ImGui::SliderFloat("FLIP Blending", &m_flipBlending, 0.0f, 1.0f, "%.2f");
-        ImGui::SliderInt("Jacobi Iterations", &m_jacobiIterations, 5, 200);
+        int velocityMode = static_cast<int>(m_velocityMode);
+        const char* velocityNames[] = { getFlipVelocityModeName(FlipVelocityMode::PicFlip), getFlipVelocityModeName(FlipVelocityMode::Apic) };
+        if (ImGui::Combo("Velocity Transfer", &velocityMode, velocityNames, 2))
+            m_velocityMode = static_cast<FlipVelocityMode>(velocityMode);
+        if (m_velocityMode == FlipVelocityMode::PicFlip)
+            ImGui::SliderFloat("FLIP Blending", &m_flipBlending, 0.0f, 1.0f, "%.2f");
+        int solverType = static_cast<int>(m_pressureSolverType);
+        const char* solverNames[] = { getFlipPressureSolverName(FlipPressureSolverType::Jacobi), getFlipPressureSolverName(FlipPressureSolverType::ConjugateGradient), getFlipPressureSolverName(FlipPressureSolverType::Multigrid) };
+        if (ImGui::Combo("Pressure Solver", &solverType, solverNames, 3))
+            m_pressureSolverType = static_cast<FlipPressureSolverType>(solverType);
+        ImGui::SliderFloat("Tolerance", &m_pressureTolerance, 1e-6f, 1e-1f, "%.1e", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("Max Iterations", &m_pressureMaxIterations, 5, 1000);
+        ImGui::Text("Pressure: %d it, residual %.1e%s, %.2f ms", m_pressureStats.iterations, m_pressureStats.residual,
+            m_pressureStats.converged ? "" : " (not converged)", m_pressureMs);
+        ImGui::Text("Grid tiles: %d of %d", m_grid.getTileCount(),
+            ((m_gridWidth + FlipSparseGrid::TileSize - 1) / FlipSparseGrid::TileSize) * ((m_gridHeight + FlipSparseGrid::TileSize - 1) / FlipSparseGrid::TileSize));
+        ImGui::SliderInt("Tile Margin", &m_gridTileMargin, 1, 4);
         ImGui::SliderInt("Substeps", &m_substeps, 1, 8);
         
         ImGui::Separator();
@@ -551,8 +564,14 @@ void FlipFluidSimulationScene::renderImGui(GraphicsEngine& engine)
         ImGui::Checkbox("Particle Collisions", &m_enableParticleCollisions);
         ImGui::SliderInt("Collision Iterations", &m_collisionIterations, 1, 6);
         ImGui::SliderFloat("Restitution", &m_collisionRestitution, 0.0f, 0.5f, "%.2f");
-        ImGui::Checkbox("Use Spatial Hash", &m_useSpatialHash);
-        ImGui::SliderFloat("Hash Cell Size", &m_hashCellSize, m_particleRadius*1.5f, m_particleRadius*4.0f, "%.1f");
+        ImGui::Checkbox("Use Particle Grid", &m_useParticleGrid);
+        ImGui::SliderFloat("Grid Cell Size", &m_collisionCellSize, m_particleRadius*1.5f, m_particleRadius*4.0f, "%.1f");
+        ImGui::Checkbox("Sort Particles By Cell", &m_sortParticlesByCell);
+        ImGui::SliderFloat("Collision Skin", &m_collisionSkin, 0.0f, m_particleRadius * 2.0f, "%.1f");
+        const int collisionUpdates = m_collisionRebuilds + m_collisionReuses;
+        ImGui::Text("Pair rebuilds: %d of %d (%.0f%%)", m_collisionRebuilds, collisionUpdates,
+            collisionUpdates > 0 ? 100.0f * m_collisionRebuilds / collisionUpdates : 0.0f);
+        ImGui::Text("Collisions: %.2f ms", m_collisionMs);
 
         ImGui::Separator();
         ImGui::Text("Interactive Ball");
@@ -646,53 +665,33 @@ void FlipFluidSimulationScene::renderImGui(GraphicsEngine& engine)
 
         if (ImGui::Button("Reset Particles", ImVec2(-FLT_MIN, 0)))
         {
-            // Remove existing particle entities
-            const auto& all = m_entityManager->getEntities();
-            std::vector<std::string> toRemove;
-            for (const auto& up : all)
-            {
-                const std::string& n = up->getName();
-                if (n.rfind("Particle_", 0) == 0) toRemove.push_back(n);
-            }
-            for (const auto& n : toRemove) m_entityManager->removeEntity(n);
             spawnParticles();
         }
         ImGui::Separator();
-        int maxThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+        int maxThreads = static_cast<int>(JobSystem::getInstance().getThreadCount());
         ImGui::SliderInt("Threads", &m_threadCount, 1, maxThreads);
         ImGui::SameLine();
         ImGui::Text("(1 = single-thread)");
-    }
-    ImGui::End();
-}
 
-void FlipFluidSimulationScene::updateParticleSprites()
-{
-    for (const auto& p : m_particles)
-    {
-        if (auto* e = m_entityManager->findEntity(p.entityName))
-        {
-            if (auto* s = e->getComponent<SpriteComponent>())
-            {
-                s->setPosition(p.position.x, p.position.y, 0.0f);
-                
-                // Reset scale and alpha when not using metaball rendering
-                if (!m_useMetaballRendering)
-                {
-                    s->setScale(1.0f, 1.0f, 1.0f);
-                    Vec4 tint = s->getTint();
-                    tint.w = 1.0f; // Full opacity
-                    s->setTint(tint);
-                }
-            }
-        }
+        int transferMode = static_cast<int>(m_transferMode);
+        const char* transferNames[] = { getFlipTransferModeName(FlipTransferMode::Serial), getFlipTransferModeName(FlipTransferMode::PrivateGrids), getFlipTransferModeName(FlipTransferMode::Gather) };
+        if (ImGui::Combo("P2G Transfer", &transferMode, transferNames, 3))
+            m_transferMode = static_cast<FlipTransferMode>(transferMode);
+        ImGui::Text("P2G: %.2f ms", m_transferMs);
     }
+    ImGui::End();
 }
 
 // ========================= FLIP Core =========================
 
 void FlipFluidSimulationScene::stepFLIP(float dt)
 {
+    resizeParticleGrid();
+    // With the collision skin the sort waits for a pair rebuild, which it would force
+    const bool collisionPairs = m_enableParticleCollisions && m_useParticleGrid && m_collisionSkin > 0.0f;
+    if (m_sortParticlesByCell && !collisionPairs)
+        sortParticlesByCell();
+
     clearGrid();
     particlesToGrid(dt);
     buildPressureSystem(dt);
@@ -704,38 +703,49 @@ void FlipFluidSimulationScene::stepFLIP(float dt)
     enforceBoundaryOnParticles();
     if (m_enableParticleCollisions)
     {
-        if (m_useSpatialHash)
+        const auto start = std::chrono::steady_clock::now();
+        if (m_useParticleGrid)
         {
-            buildSpatialHash();
-            resolveParticleCollisionsHashed();
+            FlipCollisionSettings settings;
+            settings.targetDistance = m_particleRadius * 2.0f * 0.95f; // slightly less to allow packing
+            settings.restitution = m_collisionRestitution;
+            settings.iterations = m_collisionIterations;
+            settings.maxThreads = std::max(1, m_threadCount);
+            if (collisionPairs)
+            {
+                m_collisionPairs.setSkin(m_collisionSkin);
+                resolveFlipCollisions(m_particles, m_collisionPairs, [&]()
+                {
+                    if (m_collisionPairs.refresh(m_particles, settings.targetDistance, settings.maxThreads))
+                    {
+                        ++m_collisionReuses;
+                        return;
+                    }
+                    if (m_sortParticlesByCell) sortParticlesByCell();
+                    else m_particleGrid.update(m_particles, settings.maxThreads);
+                    m_collisionPairs.build(m_particles, m_particleGrid, settings.targetDistance, settings.maxThreads);
+                    ++m_collisionRebuilds;
+                }, settings, m_collisionScratch);
+            }
+            else
+            {
+                resolveFlipCollisions(m_particles, m_particleGrid, settings, m_collisionScratch);
+            }
         }
         else
         {
             resolveParticleCollisions();
         }
+        m_collisionMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
     }
     updateParticleColors();
 }
 
 void FlipFluidSimulationScene::clearGrid()
 {
-    std::fill(m_u.begin(), m_u.end(), 0.0f);
-    std::fill(m_v.begin(), m_v.end(), 0.0f);
-    std::fill(m_uWeight.begin(), m_uWeight.end(), 0.0f);
-    std::fill(m_vWeight.begin(), m_vWeight.end(), 0.0f);
-    std::fill(m_pressure.begin(), m_pressure.end(), 0.0f);
-    std::fill(m_divergence.begin(), m_divergence.end(), 0.0f);
-
-    // mark outermost cells as solid
-    std::fill(m_solid.begin(), m_solid.end(), 0);
-    for (int j = 0; j < m_gridHeight; ++j)
-    {
-        for (int i = 0; i < m_gridWidth; ++i)
-        {
-            bool solid = (i == 0) || (i == m_gridWidth - 1) || (j == 0) || (j == m_gridHeight - 1);
-            m_solid[idxP(i, j)] = solid ? 1 : 0;
-        }
-    }
+    // Allocate tiles around the particles; everything but the pressure starts at zero
+    m_grid.resize(m_gridOrigin.x, m_gridOrigin.y, m_cellSize, m_gridWidth, m_gridHeight);
+    m_grid.build(m_particles, std::max(1, m_gridTileMargin), std::max(1, m_threadCount));
 }
 
 Vec2 FlipFluidSimulationScene::worldToGrid(const Vec2& p) const
@@ -752,90 +762,78 @@ Vec2 FlipFluidSimulationScene::gridToWorld(const Vec2& ij) const
 void FlipFluidSimulationScene::particlesToGrid(float dt)
 {
     // Scatter particle velocities to face-centered grid with bilinear weights
-    for (const auto& p : m_particles)
+    const auto start = std::chrono::steady_clock::now();
+    m_transfer.particlesToGrid(m_particles, m_grid.getFaceGrid(), m_transferMode, std::max(1, m_threadCount), m_velocityMode == FlipVelocityMode::Apic);
+
+    // Normalize, and add gravity to V faces
+    float* u = m_grid.getU();
+    float* uWeight = m_grid.getUWeight();
+    float* v = m_grid.getV();
+    float* vWeight = m_grid.getVWeight();
+    parallelFor(0, m_grid.getTileCount(), 4, [&](int tileStart, int tileEnd)
     {
-        // U (faces between i and i+1 at j)
+        for (int idx = tileStart * FlipSparseGrid::TileCells; idx < tileEnd * FlipSparseGrid::TileCells; ++idx)
         {
-            float gx = (p.position.x - m_gridOrigin.x) / m_cellSize; // i in cell space
-            float gy = (p.position.y - m_gridOrigin.y) / m_cellSize - 0.5f; // v-centered shift
-            int i0 = (int)std::floor(gx);
-            int j0 = (int)std::floor(gy);
-            for (int dj = 0; dj <= 1; ++dj)
-            {
-                for (int di = 0; di <= 1; ++di)
-                {
-                    int i = i0 + di;
-                    int j = j0 + dj;
-                    if (i < 0 || i > m_gridWidth || j < 0 || j >= m_gridHeight) continue;
-                    float wx = 1.0f - std::abs((gx - i));
-                    float wy = 1.0f - std::abs((gy - j));
-                    float w = clampf(wx, 0.0f, 1.0f) * clampf(wy, 0.0f, 1.0f);
-                    int idx = j * (m_gridWidth + 1) + i;
-                    m_u[idx] += p.velocity.x * w;
-                    m_uWeight[idx] += w;
-                }
-            }
+            if (uWeight[idx] > 0.0f) u[idx] /= uWeight[idx];
+            if (vWeight[idx] > 0.0f) v[idx] /= vWeight[idx];
+            v[idx] += m_gravity * dt;
         }
+    });
+    m_transferMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
-        // V (faces between j and j+1 at i)
+void FlipFluidSimulationScene::buildPressureSystem(float dt)
+{
+    // Fluid cells are non-solid cells holding at least one particle; the rest of the
+    // open cells are air with zero pressure. Tile cells past the grid count as solid.
+    FlipCellType* cellTypes = m_grid.getCellTypes();
+    const int* particleCount = m_grid.getParticleCounts();
+    float* u = m_grid.getU();
+    float* v = m_grid.getV();
+    parallelFor(0, m_grid.getTileCount(), 4, [&](int tileStart, int tileEnd)
+    {
+        for (int tile = tileStart; tile < tileEnd; ++tile)
         {
-            float gx = (p.position.x - m_gridOrigin.x) / m_cellSize - 0.5f;
-            float gy = (p.position.y - m_gridOrigin.y) / m_cellSize;
-            int i0 = (int)std::floor(gx);
-            int j0 = (int)std::floor(gy);
-            for (int dj = 0; dj <= 1; ++dj)
+            for (int local = 0; local < FlipSparseGrid::TileCells; ++local)
             {
-                for (int di = 0; di <= 1; ++di)
-                {
-                    int i = i0 + di;
-                    int j = j0 + dj;
-                    if (i < 0 || i >= m_gridWidth || j < 0 || j > m_gridHeight) continue;
-                    float wx = 1.0f - std::abs((gx - i));
-                    float wy = 1.0f - std::abs((gy - j));
-                    float w = clampf(wx, 0.0f, 1.0f) * clampf(wy, 0.0f, 1.0f);
-                    int idx = j * m_gridWidth + i;
-                    m_v[idx] += p.velocity.y * w;
-                    m_vWeight[idx] += w;
-                }
+                const int i = m_grid.getTileX(tile) * FlipSparseGrid::TileSize + local % FlipSparseGrid::TileSize;
+                const int j = m_grid.getTileY(tile) * FlipSparseGrid::TileSize + local / FlipSparseGrid::TileSize;
+                const int id = tile * FlipSparseGrid::TileCells + local;
+                const bool inside = i < m_gridWidth && j < m_gridHeight;
+                cellTypes[id] = (!inside || isSolidCell(i, j)) ? FlipCellType::Solid : (particleCount[id] > 0 ? FlipCellType::Fluid : FlipCellType::Air);
+
+                // Solid walls are static: no flow through faces that touch them
+                if (j < m_gridHeight && i <= m_gridWidth && (i == 0 || i == m_gridWidth || isSolidCell(i - 1, j) || isSolidCell(i, j))) u[id] = 0.0f;
+                if (i < m_gridWidth && j <= m_gridHeight && (j == 0 || j == m_gridHeight || isSolidCell(i, j - 1) || isSolidCell(i, j))) v[id] = 0.0f;
             }
         }
-    }
-
-    // Normalize
-    for (size_t k = 0; k < m_u.size(); ++k)
-        if (m_uWeight[k] > 0.0f) m_u[k] /= m_uWeight[k];
-    for (size_t k = 0; k < m_v.size(); ++k)
-        if (m_vWeight[k] > 0.0f) m_v[k] /= m_vWeight[k];
-
-    // Add gravity to V faces
-    for (int j = 0; j <= m_gridHeight; ++j)
-    {
-        for (int i = 0; i < m_gridWidth; ++i)
-        {
-            int idx = j * m_gridWidth + i;
-            m_v[idx] += m_gravity * dt;
-        }
-    }
-}
+    });
 
-void FlipFluidSimulationScene::buildPressureSystem(float dt)
-{
     // Compute divergence at cell centers from face velocities
-    parallelFor(0, m_gridHeight, 1, [&](int rowStart, int rowEnd)
+    float* divergence = m_grid.getDivergence();
+    auto face = [&](const float* faces, int i, int j)
     {
-        for (int j = rowStart; j < rowEnd; ++j)
+        const int idx = m_grid.index(i, j);
+        return idx < 0 ? 0.0f : faces[idx];
+    };
+    parallelFor(0, m_grid.getTileCount(), 4, [&](int tileStart, int tileEnd)
+    {
+        for (int tile = tileStart; tile < tileEnd; ++tile)
         {
-            for (int i = 0; i < m_gridWidth; ++i)
+            for (int local = 0; local < FlipSparseGrid::TileCells; ++local)
             {
-                if (m_solid[idxP(i, j)]) { m_divergence[idxP(i, j)] = 0.0f; continue; }
+                const int id = tile * FlipSparseGrid::TileCells + local;
+                if (cellTypes[id] != FlipCellType::Fluid) { divergence[id] = 0.0f; continue; }
+                const int i = m_grid.getTileX(tile) * FlipSparseGrid::TileSize + local % FlipSparseGrid::TileSize;
+                const int j = m_grid.getTileY(tile) * FlipSparseGrid::TileSize + local / FlipSparseGrid::TileSize;
 
-                float uR = m_u[j * (m_gridWidth + 1) + (i + 1)];
-                float uL = m_u[j * (m_gridWidth + 1) + i];
-                float vT = m_v[(j + 1) * m_gridWidth + i];
-                float vB = m_v[j * m_gridWidth + i];
+                float uR = face(u, i + 1, j);
+                float uL = u[id];
+                float vT = face(v, i, j + 1);
+                float vB = v[id];
 
                 float div = (uR - uL + vT - vB) / m_cellSize;
-                m_divergence[idxP(i, j)] = div;
+                divergence[id] = div;
             }
         }
     });
@@ -843,138 +841,68 @@ void FlipFluidSimulationScene::buildPressureSystem(float dt)
 
 void FlipFluidSimulationScene::solvePressure()
 {
-    // Jacobi iterations on Poisson: Laplace(p) = divergence
-    std::vector<float> pNew(m_pressure.size(), 0.0f);
-    for (int it = 0; it < m_jacobiIterations; ++it)
-    {
-        parallelFor(0, m_gridHeight, 1, [&](int rowStart, int rowEnd)
-        {
-            for (int j = rowStart; j < rowEnd; ++j)
-            {
-                for (int i = 0; i < m_gridWidth; ++i)
-                {
-                    int id = idxP(i, j);
-                    if (m_solid[id]) { pNew[id] = 0.0f; continue; }
-
-                    float sum = 0.0f;
-                    int count = 0;
-                    if (i > 0 && !m_solid[idxP(i - 1, j)]) { sum += m_pressure[idxP(i - 1, j)]; ++count; }
-                    if (i < m_gridWidth - 1 && !m_solid[idxP(i + 1, j)]) { sum += m_pressure[idxP(i + 1, j)]; ++count; }
-                    if (j > 0 && !m_solid[idxP(i, j - 1)]) { sum += m_pressure[idxP(i, j - 1)]; ++count; }
-                    if (j < m_gridHeight - 1 && !m_solid[idxP(i, j + 1)]) { sum += m_pressure[idxP(i, j + 1)]; ++count; }
-
-                    if (count > 0)
-                        pNew[id] = (sum - m_divergence[id] * m_cellSize * m_cellSize) / count;
-                    else
-                        pNew[id] = 0.0f;
-                }
-            }
-        });
-        m_pressure.swap(pNew);
-    }
+    // Solve Laplace(p) = divergence over the fluid cells, warm started from last step's pressure
+    const auto start = std::chrono::steady_clock::now();
+    FlipPressureSettings settings;
+    settings.type = m_pressureSolverType;
+    settings.tolerance = m_pressureTolerance;
+    settings.maxIterations = m_pressureMaxIterations;
+    settings.maxThreads = std::max(1, m_threadCount);
+    m_pressureStats = m_grid.solvePressure(m_pressureSolver, settings);
+    m_pressureMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 void FlipFluidSimulationScene::applyPressureGradient(float dt)
 {
-    // Subtract pressure gradient from face velocities to make flow divergence-free
-    parallelFor(0, m_gridHeight, 1, [&](int rowStart, int rowEnd)
-    {
-        for (int j = rowStart; j < rowEnd; ++j)
-        {
-            for (int i = 1; i < m_gridWidth; ++i)
-            {
-                float pR = m_pressure[idxP(i, j)];
-                float pL = m_pressure[idxP(i - 1, j)];
-                int iu = j * (m_gridWidth + 1) + i;
-                m_u[iu] -= (pR - pL) / m_cellSize;
-            }
-        }
-    });
-    parallelFor(1, m_gridHeight, 1, [&](int rowStart, int rowEnd)
+    // Subtract pressure gradient from faces next to fluid to make flow divergence-free;
+    // faces touching solids were zeroed in buildPressureSystem and stay closed
+    const FlipCellType* cellTypes = m_grid.getCellTypes();
+    const float* pressure = m_grid.getPressure();
+    float* u = m_grid.getU();
+    float* v = m_grid.getV();
+    auto open = [&](int a, int b)
+    {
+        return a >= 0 && cellTypes[a] != FlipCellType::Solid && cellTypes[b] != FlipCellType::Solid &&
+            (cellTypes[a] == FlipCellType::Fluid || cellTypes[b] == FlipCellType::Fluid);
+    };
+    parallelFor(0, m_grid.getTileCount(), 4, [&](int tileStart, int tileEnd)
     {
-        for (int j = rowStart; j < rowEnd; ++j)
+        for (int tile = tileStart; tile < tileEnd; ++tile)
         {
-            for (int i = 0; i < m_gridWidth; ++i)
+            for (int local = 0; local < FlipSparseGrid::TileCells; ++local)
             {
-                float pT = m_pressure[idxP(i, j)];
-                float pB = m_pressure[idxP(i, j - 1)];
-                int iv = j * m_gridWidth + i;
-                m_v[iv] -= (pT - pB) / m_cellSize;
+                const int i = m_grid.getTileX(tile) * FlipSparseGrid::TileSize + local % FlipSparseGrid::TileSize;
+                const int j = m_grid.getTileY(tile) * FlipSparseGrid::TileSize + local / FlipSparseGrid::TileSize;
+                if (i >= m_gridWidth || j >= m_gridHeight) continue;
+                const int id = tile * FlipSparseGrid::TileCells + local;
+
+                const int left = m_grid.index(i - 1, j);
+                if (i > 0 && open(left, id))
+                    u[id] -= (pressure[id] - pressure[left]) / m_cellSize;
+                const int below = m_grid.index(i, j - 1);
+                if (j > 0 && open(below, id))
+                    v[id] -= (pressure[id] - pressure[below]) / m_cellSize;
             }
         }
     });
 }
 
-float FlipFluidSimulationScene::sampleU(float x, float y) const
-{
-    // bilinear sample face-centered U
-    float gx = (x - m_gridOrigin.x) / m_cellSize;
-    float gy = (y - m_gridOrigin.y) / m_cellSize - 0.5f;
-    int i0 = (int)std::floor(gx);
-    int j0 = (int)std::floor(gy);
-    float tx = gx - i0;
-    float ty = gy - j0;
-
-    auto at = [&](int i, int j) -> float
-    {
-        if (i < 0 || i > m_gridWidth || j < 0 || j >= m_gridHeight) return 0.0f;
-        return m_u[j * (m_gridWidth + 1) + i];
-    };
-
-    float v00 = at(i0, j0);
-    float v10 = at(i0 + 1, j0);
-    float v01 = at(i0, j0 + 1);
-    float v11 = at(i0 + 1, j0 + 1);
-    float vx0 = lerp(v00, v10, tx);
-    float vx1 = lerp(v01, v11, tx);
-    return lerp(vx0, vx1, ty);
-}
-
-float FlipFluidSimulationScene::sampleV(float x, float y) const
-{
-    float gx = (x - m_gridOrigin.x) / m_cellSize - 0.5f;
-    float gy = (y - m_gridOrigin.y) / m_cellSize;
-    int i0 = (int)std::floor(gx);
-    int j0 = (int)std::floor(gy);
-    float tx = gx - i0;
-    float ty = gy - j0;
-
-    auto at = [&](int i, int j) -> float
-    {
-        if (i < 0 || i >= m_gridWidth || j < 0 || j > m_gridHeight) return 0.0f;
-        return m_v[j * m_gridWidth + i];
-    };
-
-    float v00 = at(i0, j0);
-    float v10 = at(i0 + 1, j0);
-    float v01 = at(i0, j0 + 1);
-    float v11 = at(i0 + 1, j0 + 1);
-    float vx0 = lerp(v00, v10, tx);
-    float vx1 = lerp(v01, v11, tx);
-    return lerp(vx0, vx1, ty);
-}
-
 void FlipFluidSimulationScene::gridToParticles(float dt)
 {
-    // FLIP/PIC blend: newVel = FLIP*w + PIC*(1-w)
-    for (auto& p : m_particles)
-    {
-        Vec2 pic(sampleU(p.position.x, p.position.y), sampleV(p.position.x, p.position.y));
-
-        // For a simple FLIP update, compute delta grid velocity at particle position
-        // Here we approximate by using the current PIC value as new grid vel and blending toward it
-        Vec2 newVel = pic;
-        p.velocity = p.velocity * m_flipBlending + newVel * (1.0f - m_flipBlending);
-    }
+    // FLIP/PIC blend: newVel = FLIP*w + PIC*(1-w), or APIC: grid velocity plus its gradient
+    m_transfer.gridToParticles(m_particles, m_grid.getFaceGrid(), m_velocityMode, m_flipBlending, std::max(1, m_threadCount));
 }
 
 void FlipFluidSimulationScene::advectParticles(float dt)
 {
-    for (auto& p : m_particles)
+    parallelFor(0, static_cast<int>(m_particles.size()), 1024, [&](int begin, int end)
     {
-        // Simple forward Euler. For stability, substeps are already used.
-        p.position += p.velocity * dt;
-    }
+        for (int i = begin; i < end; ++i)
+        {
+            // Simple forward Euler. For stability, substeps are already used.
+            m_particles[i].position += m_particles[i].velocity * dt;
+        }
+    });
 }
 
 void FlipFluidSimulationScene::enforceBoundaryOnParticles()
@@ -1049,8 +977,8 @@ void FlipFluidSimulationScene::resolveParticleCollisions()
                 float dist2 = dp.x * dp.x + dp.y * dp.y;
                 if (dist2 < targetDist2)
                 {
-                    float dist = std::sqrt(std::max(1e-5f, dist2));
-                    Vec2 n = (dist > 1e-5f) ? (dp * (1.0f / dist)) : Vec2(1.0f, 0.0f);
+                    float dist = (dist2 > 1e-10f) ? std::sqrt(dist2) : 0.0f;
+                    Vec2 n = (dist > 0.0f) ? (dp * (1.0f / dist)) : Vec2(1.0f, 0.0f);
                     float overlap = targetDist - dist;
 
                     // Separate equally
@@ -1074,71 +1002,36 @@ void FlipFluidSimulationScene::resolveParticleCollisions()
 
 // (quad tree variant removed by request)
 
-void FlipFluidSimulationScene::buildSpatialHash()
+void FlipFluidSimulationScene::resizeParticleGrid()
 {
-    m_hash.clear();
-    float inv = 1.0f / std::max(1.0f, m_hashCellSize);
-    for (int i = 0; i < (int)m_particles.size(); ++i)
-    {
-        const Vec2 p = m_particles[i].position;
-        int ix = (int)std::floor((p.x - m_gridOrigin.x) * inv);
-        int iy = (int)std::floor((p.y - m_gridOrigin.y) * inv);
-        m_hash[hashKey(ix, iy)].push_back(i);
-    }
+    // 3x3 cell neighborhoods only find every contact if a cell spans the contact distance
+    const float cellSize = std::max(m_collisionCellSize, m_particleRadius * 2.0f);
+    m_particleGrid.resize(m_gridOrigin.x, m_gridOrigin.y, m_gridWidth * m_cellSize, m_gridHeight * m_cellSize, cellSize);
 }
 
-void FlipFluidSimulationScene::resolveParticleCollisionsHashed()
+void FlipFluidSimulationScene::sortParticlesByCell()
 {
-    const float targetDist = m_particleRadius * 2.0f * 0.95f;
-    const float targetDist2 = targetDist * targetDist;
-    float inv = 1.0f / std::max(1.0f, m_hashCellSize);
+    m_particleGrid.update(m_particles, std::max(1, m_threadCount));
+    const std::vector<int>& order = m_particleGrid.getSortedIndices();
 
-    for (int it = 0; it < m_collisionIterations; ++it)
+    m_sortedParticles.resize(m_particles.size());
+    parallelFor(0, static_cast<int>(order.size()), 1024, [&](int begin, int end)
     {
-        for (int i = 0; i < (int)m_particles.size(); ++i)
-        {
-            const Vec2 pi = m_particles[i].position;
-            int ix = (int)std::floor((pi.x - m_gridOrigin.x) * inv);
-            int iy = (int)std::floor((pi.y - m_gridOrigin.y) * inv);
-
-            for (int dy = -1; dy <= 1; ++dy)
-            {
-                for (int dx = -1; dx <= 1; ++dx)
-                {
-                    auto itBucket = m_hash.find(hashKey(ix + dx, iy + dy));
-                    if (itBucket == m_hash.end()) continue;
-                    const auto& bucket = itBucket->second;
-                    for (int j : bucket)
-                    {
-                        if (j <= i) continue;
-                        Vec2 dp = m_particles[j].position - m_particles[i].position;
-                        float dist2 = dp.x * dp.x + dp.y * dp.y;
-                        if (dist2 < targetDist2)
-                        {
-                            float dist = std::sqrt(std::max(1e-5f, dist2));
-                            Vec2 n = (dist > 1e-5f) ? (dp * (1.0f / dist)) : Vec2(1.0f, 0.0f);
-                            float overlap = targetDist - dist;
-                            m_particles[i].position -= n * (overlap * 0.5f);
-                            m_particles[j].position += n * (overlap * 0.5f);
-
-                            Vec2 relVel = m_particles[j].velocity - m_particles[i].velocity;
-                            float relN = relVel.x * n.x + relVel.y * n.y;
-                            if (relN < 0.0f)
-                            {
-                                float impulse = -(1.0f + m_collisionRestitution) * relN * 0.5f;
-                                m_particles[i].velocity -= n * impulse;
-                                m_particles[j].velocity += n * impulse;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        for (int k = begin; k < end; ++k)
+            m_sortedParticles[k] = m_particles[order[k]];
+    });
+    m_particles.swap(m_sortedParticles);
 
-        // Rebuild hash after positions changed for next iteration
-        if (it + 1 < m_collisionIterations)
-            buildSpatialHash();
+    // Held particles are tracked by index
+    if (!m_pickedParticles.empty())
+    {
+        std::vector<int> newIndex(order.size());
+        for (int k = 0; k < static_cast<int>(order.size()); ++k) newIndex[order[k]] = k;
+        for (int& idx : m_pickedParticles) idx = newIndex[idx];
     }
+
+    // Particle k is now the one in slot k: the grid stays valid for the next update
+    m_particleGrid.renumberSorted();
 }
 
 void FlipFluidSimulationScene::updateParticleColors()
@@ -1148,78 +1041,72 @@ void FlipFluidSimulationScene::updateParticleColors()
     float sMax = std::max(m_colorSpeedMax, sMin + 1.0f);
     float invRange = 1.0f / (sMax - sMin);
 
-    for (const auto& p : m_particles)
+    for (auto& p : m_particles)
     {
-        if (auto* e = m_entityManager->findEntity(p.entityName))
-        {
-            if (auto* s = e->getComponent<SpriteComponent>())
-            {
-                float speed = p.velocity.length();
-                float t = (speed - sMin) * invRange;
-                t = std::max(0.0f, std::min(1.0f, t));
+        float speed = p.velocity.length();
+        float t = (speed - sMin) * invRange;
+        t = std::max(0.0f, std::min(1.0f, t));
 
-                Vec4 tint;
-                if (m_debugColor)
-                {
-                    // Debug gradient: Blue (slow) -> Green (medium) -> Red (fast)
-                    Vec4 blue  = Vec4(0.0f, 0.0f, 1.0f, 1.0f);
-                    Vec4 green = Vec4(0.0f, 1.0f, 0.0f, 1.0f);
-                    Vec4 red   = Vec4(1.0f, 0.0f, 0.0f, 1.0f);
+        Vec4 tint;
+        if (m_debugColor)
+        {
+            // Debug gradient: Blue (slow) -> Green (medium) -> Red (fast)
+            Vec4 blue  = Vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            Vec4 green = Vec4(0.0f, 1.0f, 0.0f, 1.0f);
+            Vec4 red   = Vec4(1.0f, 0.0f, 0.0f, 1.0f);
 
-                    if (t < 0.5f)
-                    {
-                        float k = t / 0.5f; // 0..1 from blue to green
-                        tint = Vec4(
-                            blue.x + (green.x - blue.x) * k,
-                            blue.y + (green.y - blue.y) * k,
-                            blue.z + (green.z - blue.z) * k,
-                            1.0f);
-                    }
-                    else
-                    {
-                        float k = (t - 0.5f) / 0.5f; // 0..1 from green to red
-                        tint = Vec4(
-                            green.x + (red.x - green.x) * k,
-                            green.y + (red.y - green.y) * k,
-                            green.z + (red.z - green.z) * k,
-                            1.0f);
-                    }
-                }
-                else
-                {
-                    // Original gradient: deep blue (slow) -> cyan -> white (fast)
-                    Vec4 slow = Vec4(0.1f, 0.35f, 0.9f, 1.0f);
-                    Vec4 fast = Vec4(0.95f, 0.95f, 0.95f, 1.0f);
-                    Vec4 mid  = Vec4(0.0f, 1.0f, 1.0f, 1.0f);
+            if (t < 0.5f)
+            {
+                float k = t / 0.5f; // 0..1 from blue to green
+                tint = Vec4(
+                    blue.x + (green.x - blue.x) * k,
+                    blue.y + (green.y - blue.y) * k,
+                    blue.z + (green.z - blue.z) * k,
+                    1.0f);
+            }
+            else
+            {
+                float k = (t - 0.5f) / 0.5f; // 0..1 from green to red
+                tint = Vec4(
+                    green.x + (red.x - green.x) * k,
+                    green.y + (red.y - green.y) * k,
+                    green.z + (red.z - green.z) * k,
+                    1.0f);
+            }
+        }
+        else
+        {
+            // Original gradient: deep blue (slow) -> cyan -> white (fast)
+            Vec4 slow = Vec4(0.1f, 0.35f, 0.9f, 1.0f);
+            Vec4 fast = Vec4(0.95f, 0.95f, 0.95f, 1.0f);
+            Vec4 mid  = Vec4(0.0f, 1.0f, 1.0f, 1.0f);
 
-                    if (t < 0.5f)
-                    {
-                        float k = t / 0.5f;
-                        tint = Vec4(
-                            slow.x + (mid.x - slow.x) * k,
-                            slow.y + (mid.y - slow.y) * k,
-                            slow.z + (mid.z - slow.z) * k,
-                            1.0f);
-                    }
-                    else
-                    {
-                        float k = (t - 0.5f) / 0.5f;
-                        tint = Vec4(
-                            mid.x + (fast.x - mid.x) * k,
-                            mid.y + (fast.y - mid.y) * k,
-                            mid.z + (fast.z - mid.z) * k,
-                            1.0f);
-                    }
-                }
-                s->setTint(tint);
+            if (t < 0.5f)
+            {
+                float k = t / 0.5f;
+                tint = Vec4(
+                    slow.x + (mid.x - slow.x) * k,
+                    slow.y + (mid.y - slow.y) * k,
+                    slow.z + (mid.z - slow.z) * k,
+                    1.0f);
+            }
+            else
+            {
+                float k = (t - 0.5f) / 0.5f;
+                tint = Vec4(
+                    mid.x + (fast.x - mid.x) * k,
+                    mid.y + (fast.y - mid.y) * k,
+                    mid.z + (fast.z - mid.z) * k,
+                    1.0f);
             }
         }
+        p.color = tint;
     }
 }
 
 Vec2 FlipFluidSimulationScene::getMouseWorldPosition() const
 {
-    auto* cameraEntity = m_entityManager->findEntity("MainCamera");
+    auto* cameraEntity = m_entityManager->getEntity(m_cameraEntity);
     if (!cameraEntity) return Vec2(0.0f, 0.0f);
     auto* cam = cameraEntity->getComponent<Camera2D>();
     if (!cam) return Vec2(0.0f, 0.0f);
@@ -1229,7 +1116,6 @@ Vec2 FlipFluidSimulationScene::getMouseWorldPosition() const
 
 void FlipFluidSimulationScene::addParticlesAt(const Vec2& worldPos, int count, float jitter)
 {
-    int startIdx = (int)m_particles.size();
     for (int i = 0; i < count; ++i)
     {
         Particle p;
@@ -1237,13 +1123,7 @@ void FlipFluidSimulationScene::addParticlesAt(const Vec2& worldPos, int count, f
         float ry = ((rand() % 2000) / 1000.0f - 1.0f) * jitter;
         p.position = worldPos + Vec2(rx, ry);
         p.velocity = Vec2(0.0f, 0.0f);
-        p.entityName = "Particle_" + std::to_string(startIdx + i);
-
-        auto& e = m_entityManager->createEntity(p.entityName);
-        auto& s = e.addComponent<SpriteComponent>(*m_graphicsDevice, L"DX3D/Assets/Textures/MetaballFalloff.png", m_particleRadius * 2.0f, m_particleRadius * 2.0f);
-        s.setPosition(p.position.x, p.position.y, 0.0f);
-        s.setTint(Vec4(0.2f, 0.6f, 1.0f, 1.0f));
-        
+        p.color = Vec4(0.2f, 0.6f, 1.0f, 1.0f);
         m_particles.push_back(p);
     }
     ensureWorldAnchor();
@@ -1352,63 +1232,65 @@ void FlipFluidSimulationScene::applyViscosity(float dt)
     // Apply viscosity by smoothing the velocity field
     if (m_viscosity > 0.0f)
     {
-        std::vector<float> uNew = m_u;
-        std::vector<float> vNew = m_v;
-        
-        // Viscous diffusion on U faces
-        for (int j = 0; j < m_gridHeight; ++j)
+        const int count = m_grid.getTileCount() * FlipSparseGrid::TileCells;
+        float* u = m_grid.getU();
+        float* v = m_grid.getV();
+        const float* uWeight = m_grid.getUWeight();
+        const float* vWeight = m_grid.getVWeight();
+        std::vector<float> uNew(u, u + count);
+        std::vector<float> vNew(v, v + count);
+
+        // Neighbor face (i, j) adds to the laplacian if it received particle weight
+        auto addNeighbor = [&](const float* faces, const float* weights, int i, int j, float& laplacian, int& neighbors)
+        {
+            const int idx = m_grid.index(i, j);
+            if (idx >= 0 && weights[idx] > 0.0f) { laplacian += faces[idx]; ++neighbors; }
+        };
+
+        for (int tile = 0; tile < m_grid.getTileCount(); ++tile)
         {
-            for (int i = 1; i < m_gridWidth; ++i)
+            for (int local = 0; local < FlipSparseGrid::TileCells; ++local)
             {
-                int idx = j * (m_gridWidth + 1) + i;
-                if (m_uWeight[idx] > 0.0f)
+                const int i = m_grid.getTileX(tile) * FlipSparseGrid::TileSize + local % FlipSparseGrid::TileSize;
+                const int j = m_grid.getTileY(tile) * FlipSparseGrid::TileSize + local / FlipSparseGrid::TileSize;
+                const int idx = tile * FlipSparseGrid::TileCells + local;
+
+                // Viscous diffusion on U faces
+                if (j < m_gridHeight && i >= 1 && i < m_gridWidth && uWeight[idx] > 0.0f)
                 {
                     float laplacian = 0.0f;
-                    int count = 0;
-                    
-                    // Check neighbors
-                    if (i > 0 && m_uWeight[idx - 1] > 0.0f) { laplacian += m_u[idx - 1]; ++count; }
-                    if (i < m_gridWidth && m_uWeight[idx + 1] > 0.0f) { laplacian += m_u[idx + 1]; ++count; }
-                    if (j > 0 && m_uWeight[idx - (m_gridWidth + 1)] > 0.0f) { laplacian += m_u[idx - (m_gridWidth + 1)]; ++count; }
-                    if (j < m_gridHeight - 1 && m_uWeight[idx + (m_gridWidth + 1)] > 0.0f) { laplacian += m_u[idx + (m_gridWidth + 1)]; ++count; }
-                    
-                    if (count > 0)
+                    int neighbors = 0;
+                    addNeighbor(u, uWeight, i - 1, j, laplacian, neighbors);
+                    addNeighbor(u, uWeight, i + 1, j, laplacian, neighbors);
+                    if (j > 0) addNeighbor(u, uWeight, i, j - 1, laplacian, neighbors);
+                    if (j < m_gridHeight - 1) addNeighbor(u, uWeight, i, j + 1, laplacian, neighbors);
+                    if (neighbors > 0)
                     {
-                        laplacian /= count;
-                        uNew[idx] = m_u[idx] + m_viscosity * dt * (laplacian - m_u[idx]);
+                        laplacian /= neighbors;
+                        uNew[idx] = u[idx] + m_viscosity * dt * (laplacian - u[idx]);
                     }
                 }
-            }
-        }
-        
-        // Viscous diffusion on V faces
-        for (int j = 1; j < m_gridHeight; ++j)
-        {
-            for (int i = 0; i < m_gridWidth; ++i)
-            {
-                int idx = j * m_gridWidth + i;
-                if (m_vWeight[idx] > 0.0f)
+
+                // Viscous diffusion on V faces
+                if (i < m_gridWidth && j >= 1 && j < m_gridHeight && vWeight[idx] > 0.0f)
                 {
                     float laplacian = 0.0f;
-                    int count = 0;
-                    
-                    // Check neighbors
-                    if (i > 0 && m_vWeight[idx - 1] > 0.0f) { laplacian += m_v[idx - 1]; ++count; }
-                    if (i < m_gridWidth - 1 && m_vWeight[idx + 1] > 0.0f) { laplacian += m_v[idx + 1]; ++count; }
-                    if (j > 0 && m_vWeight[idx - m_gridWidth] > 0.0f) { laplacian += m_v[idx - m_gridWidth]; ++count; }
-                    if (j < m_gridHeight && m_vWeight[idx + m_gridWidth] > 0.0f) { laplacian += m_v[idx + m_gridWidth]; ++count; }
-                    
-                    if (count > 0)
+                    int neighbors = 0;
+                    if (i > 0) addNeighbor(v, vWeight, i - 1, j, laplacian, neighbors);
+                    if (i < m_gridWidth - 1) addNeighbor(v, vWeight, i + 1, j, laplacian, neighbors);
+                    addNeighbor(v, vWeight, i, j - 1, laplacian, neighbors);
+                    addNeighbor(v, vWeight, i, j + 1, laplacian, neighbors);
+                    if (neighbors > 0)
                     {
-                        laplacian /= count;
-                        vNew[idx] = m_v[idx] + m_viscosity * dt * (laplacian - m_v[idx]);
+                        laplacian /= neighbors;
+                        vNew[idx] = v[idx] + m_viscosity * dt * (laplacian - v[idx]);
                     }
                 }
             }
         }
-        
-        m_u = uNew;
-        m_v = vNew;
+
+        std::copy(uNew.begin(), uNew.end(), u);
+        std::copy(vNew.begin(), vNew.end(), v);
     }
     
     // Apply global velocity damping to reduce "jelly" effect
@@ -1467,16 +1349,7 @@ void FlipFluidSimulationScene::updateMetaballData()
         m_metaballPositions.push_back(p.position);
         m_metaballRadii.push_back(m_metaballRadius);
         
-        // Get color from particle's sprite
-        Vec4 color(0.2f, 0.6f, 1.0f, 1.0f); // default blue
-        if (auto* e = m_entityManager->findEntity(p.entityName))
-        {
-            if (auto* s = e->getComponent<SpriteComponent>())
-            {
-                color = s->getTint();
-            }
-        }
-        m_metaballColors.push_back(color);
+        m_metaballColors.push_back(p.color);
     }
 }
 
@@ -1629,10 +1502,7 @@ void FlipFluidSimulationScene::createMetaballFalloffTexture()
     // This should be a radial gradient texture with white center fading to transparent edges
     if (m_graphicsDevice)
     {
-        m_metaballFalloffTexture = Texture2D::LoadTexture2D(
-            m_graphicsDevice->getD3DDevice(),
-            L"DX3D/Assets/Textures/MetaballFalloff.png"
-        );
+        m_metaballFalloffTexture = m_graphicsDevice->getResourceCache().getTexture(L"DX3D/Assets/Textures/MetaballFalloff.png");
     }
 }
 
@@ -1651,75 +1521,13 @@ void FlipFluidSimulationScene::renderMetaballField(GraphicsEngine& engine, Devic
     // Enable additive blending for field accumulation
     ctx.enableAlphaBlending();
     
-    // Load metaball falloff texture if not already loaded
-    static std::shared_ptr<Texture2D> metaballTexture = nullptr;
-    if (!metaballTexture)
-    {
-        metaballTexture = Texture2D::LoadTexture2D(engine.getGraphicsDevice().getD3DDevice(), L"DX3D/Assets/Textures/MetaballFalloff.png");
-    }
-    
-    // Render each particle using the MetaballFalloff.png texture with velocity colors
-    for (const auto& p : m_particles)
-    {
-        if (auto* e = m_entityManager->findEntity(p.entityName))
-        {
-            if (auto* s = e->getComponent<SpriteComponent>())
-            {
-                // Store original scale, color, and texture
-                Vec3 originalScale = s->getScale();
-                Vec4 originalColor = s->getTint();
-                auto originalTexture = s->getTexture();
-                
-                // Set metaball texture and scale up for metaball effect
-                if (metaballTexture)
-                {
-                    s->setTexture(metaballTexture);
-                }
-                float scale = m_metaballRadius / m_particleRadius;
-                s->setScale(scale, scale, 1.0f);
-                
-                // Use the particle's velocity-based color for metaball rendering
-                s->setTint(originalColor);
-                
-                if (s->isVisible() && s->isValid())
-                {
-                    s->draw(ctx);
-                }
-                
-                // Restore original scale, color, and texture
-                s->setScale(originalScale.x, originalScale.y, originalScale.z);
-                s->setTint(originalColor);
-                s->setTexture(originalTexture);
-            }
-        }
-    }
-}
-
-void FlipFluidSimulationScene::renderMetaballsAsSprites(DeviceContext& ctx)
-{
-    // Improved sprite-based metaball rendering
-    // Create much larger, more transparent sprites for better blending
-    
+    // One MetaballFalloff.png quad per particle with its velocity color, in a single batch
+    const float size = m_metaballRadius * 2.0f;
     for (const auto& p : m_particles)
-    {
-        if (auto* e = m_entityManager->findEntity(p.entityName))
-        {
-            if (auto* s = e->getComponent<SpriteComponent>())
-            {
-                // Use a much larger scale for better metaball effect
-                float scale = (m_metaballRadius * 2.0f) / m_particleRadius; // Double the radius
-                s->setScale(scale, scale, 1.0f);
-                
-                // Make particles transparent for better blending
-                Vec4 tint = s->getTint();
-                tint.w = m_metaballSmoothing; // Use the alpha control from UI
-                s->setTint(tint);
-                
-                if (s->isVisible() && s->isValid())
-                    s->draw(ctx);
-            }
-        }
-    }
+        m_particleBatch.add(m_metaballMaterial, p.position.x, p.position.y, size,
+            packParticleColor(p.color.x, p.color.y, p.color.z, p.color.w));
+    if (m_particleBatchDevice) m_particleBatchDevice->draw(engine, ctx, m_particleBatch);
+    m_particleBatch.clear();
 }
 
 // ========================= Marching Squares Fluid Surface =========================
@@ -1729,32 +1537,30 @@ float FlipFluidSimulationScene::calculateDensityAt(const Vec2& worldPos)
     float density = 0.0f;
     float influenceRadius = m_particleRadius * 2.0f;
     
-    // Use spatial hashing to only check nearby particles
-    float invCellSize = 1.0f / std::max(1.0f, m_hashCellSize);
-    int gridX = (int)std::floor((worldPos.x - m_gridOrigin.x) * invCellSize);
-    int gridY = (int)std::floor((worldPos.y - m_gridOrigin.y) * invCellSize);
+    // Use the particle grid (built by the caller) to only check nearby particles
+    const int cellsX = m_particleGrid.getCellsX();
+    const int cell = m_particleGrid.cellOf(worldPos.x, worldPos.y);
+    const int cellX = cell % cellsX;
+    const int cellY = cell / cellsX;
     
     // Check particles in nearby grid cells
-    for (int dy = -1; dy <= 1; ++dy)
+    for (int y = std::max(cellY - 1, 0); y <= std::min(cellY + 1, m_particleGrid.getCellsY() - 1); ++y)
     {
-        for (int dx = -1; dx <= 1; ++dx)
+        for (int x = std::max(cellX - 1, 0); x <= std::min(cellX + 1, cellsX - 1); ++x)
         {
-            auto it = m_hash.find(hashKey(gridX + dx, gridY + dy));
-            if (it != m_hash.end())
+            const int c = y * cellsX + x;
+            for (int k = m_particleGrid.getCellStart(c); k < m_particleGrid.getCellEnd(c); ++k)
             {
-                for (int particleIdx : it->second)
+                const auto& p = m_particles[m_particleGrid.getSortedIndices()[k]];
+                Vec2 toParticle = worldPos - p.position;
+                float dist = toParticle.length();
+                
+                if (dist < influenceRadius)
                 {
-                    const auto& p = m_particles[particleIdx];
-                    Vec2 toParticle = worldPos - p.position;
-                    float dist = toParticle.length();
-                    
-                    if (dist < influenceRadius)
-                    {
-                        // Smooth falloff function (similar to metaball)
-                        float t = dist / influenceRadius;
-                        float influence = 1.0f - (3.0f * t * t - 2.0f * t * t * t); // Smooth step
-                        density += influence;
-                    }
+                    // Smooth falloff function (similar to metaball)
+                    float t = dist / influenceRadius;
+                    float influence = 1.0f - (3.0f * t * t - 2.0f * t * t * t); // Smooth step
+                    density += influence;
                 }
             }
         }
@@ -1821,6 +1627,7 @@ void FlipFluidSimulationScene::generateFluidSurface()
     int gridHeight = (int)((gridMax.y - gridMin.y) / cellSize) + 1;
     
     // Sample density values at grid points
+    m_particleGrid.build(m_particles, std::max(1, m_threadCount));
     std::vector<std::vector<float>> densityGrid(gridHeight, std::vector<float>(gridWidth));
     for (int j = 0; j < gridHeight; ++j)
     {
@@ -7,13 +7,18 @@
 #include <DX3D/Core/Input.h>
 #include <DX3D/Graphics/LineRenderer.h>
 #include <DX3D/Graphics/Mesh.h>
+#include <DX3D/Graphics/ParticleBatchDevice.h>
 #include <DX3D/Components/FirmGuyComponent.h>
 #include <DX3D/Components/FirmGuySystem.h>
 #include <vector>
 #include <memory>
 #include <string>
-#include <thread>
-#include <unordered_map>
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleGrid.h>
+#include <DX3D/Game/Scenes/FlipParticleTransfer.h>
+#include <DX3D/Game/Scenes/FlipPressureSolver.h>
+#include <DX3D/Game/Scenes/FlipSparseGrid.h>
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
 #include <algorithm>
 
 namespace dx3d
@@ -35,20 +40,19 @@ namespace dx3d
         {
             Vec2 position;   // world space
             Vec2 velocity;   // world space
-            std::string entityName; // for ECS sprite lookup
+            Vec4 color;      // velocity tint, drawn through m_particleBatch
+            Vec2 affineU;    // APIC: gradient of u around the particle (per world unit)
+            Vec2 affineV;    // APIC: gradient of v
         };
 
-        // Grid indexing helpers (MAC grid: u on vertical faces, v on horizontal faces)
-        inline int idxP(int x, int y) const { return y * m_gridWidth + x; }
-        inline int idxU(int x, int y) const { return y * (m_gridWidth + 1) + x; }
-        inline int idxV(int x, int y) const { return y * m_gridWidth + x; }
+        // The outermost ring of grid cells is solid
+        inline bool isSolidCell(int x, int y) const { return x <= 0 || y <= 0 || x >= m_gridWidth - 1 || y >= m_gridHeight - 1; }
 
         // Scene setup helpers
         void createCamera(GraphicsEngine& engine);
         void createBoundaries();
         void updateBoundaryPositions();
         void spawnParticles();
-        void updateParticleSprites();
         void updateBoundarySprites();
         void addParticlesAt(const Vec2& worldPos, int count, float jitter = 1.0f);
         void applyForceBrush(const Vec2& worldPos, const Vec2& worldVel);
@@ -79,8 +83,10 @@ namespace dx3d
         void enforceBoundaryOnParticles();
         void resolveParticleCollisions();
         void updateParticleColors();
-        void resolveParticleCollisionsHashed();
-        void buildSpatialHash();
+        // Fit the collision grid to the simulation grid at the current cell size
+        void resizeParticleGrid();
+        // Reorder m_particles by grid cell so neighbors are adjacent in memory
+        void sortParticlesByCell();
         void applyViscosity(float dt);
         void renderMetaballs(GraphicsEngine& engine, DeviceContext& ctx);
         void updateMetaballData();
@@ -91,9 +97,6 @@ namespace dx3d
         Vec4 calculateMetaballColor(const Vec2& worldPos);
         void renderMetaballMesh(GraphicsEngine& engine, DeviceContext& ctx);
         
-        // Metaball rendering functions
-        void renderMetaballsAsSprites(DeviceContext& ctx);
-        
         // Texture-based metaball rendering (john-wigg.dev approach)
         void initializeMetaballTextures(GraphicsEngine& engine);
         void createMetaballFalloffTexture();
@@ -117,12 +120,10 @@ namespace dx3d
         // Utility
         Vec2 worldToGrid(const Vec2& p) const;
         Vec2 gridToWorld(const Vec2& ij) const;
-        float sampleU(float x, float y) const;
-        float sampleV(float x, float y) const;
         float clampf(float v, float a, float b) const { return v < a ? a : (v > b ? b : v); }
 
         // ECS
-        std::unique_ptr<EntityManager> m_entityManager;
+        EntityHandle m_cameraEntity;
         GraphicsDevice* m_graphicsDevice = nullptr;
         LineRenderer* m_lineRenderer = nullptr;
 
@@ -135,18 +136,14 @@ namespace dx3d
         float m_cellSize = 10.0f; // world units per cell
         Vec2 m_gridOrigin = Vec2(-300.0f, -200.0f); // bottom-left of domain in world space
 
-        std::vector<float> m_u;        // size: (W+1)*H
-        std::vector<float> m_v;        // size: W*(H+1)
-        std::vector<float> m_uWeight;  // same as m_u
-        std::vector<float> m_vWeight;  // same as m_v
-        std::vector<float> m_pressure; // size: W*H
-        std::vector<float> m_divergence;// size: W*H
-        std::vector<uint8_t> m_solid;  // size: W*H (0 fluid/air, 1 solid)
+        // u, v, weights, pressure, divergence, cell types and particle counts in 8x8 tiles
+        // allocated around the particles; fluid = non-solid cell holding a particle
+        FlipSparseGrid m_grid;
+        int m_gridTileMargin = 1; // tiles kept around occupied ones; the transfer needs at least 1
 
         // Simulation parameters (editable via ImGui)
         float m_gravity = -980.0f;          // px/s^2 downward in world Y
         float m_flipBlending = 0.8f;        // 1.0 = pure FLIP, 0.0 = pure PIC
-        int   m_jacobiIterations = 5;       // pressure solve
         int   m_substeps = 1;               // simulation substeps per fixedUpdate
         float m_particleRadius = 4.0f;      // for rendering and boundary padding
         bool  m_paused = false;
@@ -189,8 +186,12 @@ namespace dx3d
         std::string m_metaballQuadEntity = "MetaballQuad";
         bool m_metaballQuadCreated = false;
 
-        // Sprites-mode particle texture (node.png)
-        std::shared_ptr<Texture2D> m_nodeTexture;
+        // Particles are quads in one batch rather than one sprite entity each:
+        // node.png in Sprites mode, MetaballFalloff.png in Metaballs mode
+        ParticleBatchRenderer m_particleBatch;
+        std::unique_ptr<ParticleBatchDevice> m_particleBatchDevice;
+        ui32 m_nodeMaterial = 0;
+        ui32 m_metaballMaterial = 0;
 
         // Mouse interaction
         enum class MouseTool { Add, Force, Pickup };
@@ -212,46 +213,51 @@ namespace dx3d
         bool  m_enableParticleCollisions = true;
         int   m_collisionIterations = 1;
         float m_collisionRestitution = 0.1f; // 0..1
+        float m_collisionMs = 0.0f;          // time spent in collisions last step
 
         // Coloring
-        std::vector<int> m_cellParticleCount; // size W*H (not needed for velocity coloring, kept for future)
         int   m_colorFoamThreshold = 2;   // legacy
         float m_colorSpeedThreshold = 200.0f; // legacy
         float m_colorSpeedMin = 0.0f;     // speed for darkest blue
         float m_colorSpeedMax = 400.0f;   // speed for white spray
         bool  m_debugColor = false;       // toggle for blue->green->red debug gradient
 
-        // Multithreading
-        int   m_threadCount = 1; // default single-thread; enable in UI if beneficial
+        // Multithreading: loops run on the engine JobSystem's persistent workers
+        int   m_threadCount = 1; // threads used per loop; set to all job system threads on load
         template<typename F>
         void parallelFor(int start, int end, int grain, F&& fn)
         {
-            int n = std::max(1, m_threadCount);
-            if (n <= 1)
-            {
-                fn(start, end);
-                return;
-            }
-            grain = std::max(1, grain);
-            int total = end - start;
-            int chunk = std::max(grain, (total + n - 1) / n);
-            std::vector<std::thread> threads;
-            threads.reserve(n);
-            for (int t = 0; t < n; ++t)
-            {
-                int s = start + t * chunk;
-                int e = std::min(end, s + chunk);
-                if (s >= e) break;
-                threads.emplace_back([=]() { fn(s, e); });
-            }
-            for (auto& th : threads) th.join();
+            JobSystem::getInstance().parallelFor(start, end, grain, std::forward<F>(fn), std::max(1, m_threadCount));
         }
 
-        // Spatial hashing for particle neighbors
-        bool  m_useSpatialHash = true;
-        float m_hashCellSize = 16.0f; // default ~ 4x radius for better performance
-        std::unordered_map<long long, std::vector<int>> m_hash; // key = (ix<<32)|iy
-        inline long long hashKey(int ix, int iy) const { return (static_cast<long long>(ix) << 32) ^ static_cast<unsigned long long>(iy); }
+        // Counting-sort particle grid for collision neighbors
+        bool  m_useParticleGrid = true;     // false falls back to the O(N^2) pair loop
+        bool  m_sortParticlesByCell = true; // reorder m_particles by cell every step
+        float m_collisionCellSize = 16.0f;  // raised to the contact distance if smaller
+        FlipParticleGrid m_particleGrid;
+        std::vector<Particle> m_sortedParticles; // reorder target, swapped with m_particles
+        std::vector<float> m_collisionScratch;
+        // Verlet skin for the collision pass (0 = grid search every iteration): contact pairs
+        // within the contact distance + skin are kept and only re-measured until some
+        // particle has moved more than skin / 2; particles are then sorted on rebuilds only
+        float m_collisionSkin = 4.0f;
+        SPHNeighborTable m_collisionPairs;
+        int m_collisionRebuilds = 0;
+        int m_collisionReuses = 0;
+
+        // Particle-to-grid transfer; Gather reproduces Serial bit for bit on any thread count
+        FlipTransferMode m_transferMode = FlipTransferMode::PrivateGrids;
+        FlipVelocityMode m_velocityMode = FlipVelocityMode::PicFlip; // APIC ignores m_flipBlending
+        FlipParticleTransfer m_transfer;
+        float m_transferMs = 0.0f; // time spent in particlesToGrid last step
+
+        // Pressure projection; m_pressure is kept between steps as the warm start
+        FlipPressureSolverType m_pressureSolverType = FlipPressureSolverType::ConjugateGradient;
+        float m_pressureTolerance = 1e-3f; // relative to the largest divergence term
+        int   m_pressureMaxIterations = 200;
+        FlipPressureSolver m_pressureSolver;
+        FlipPressureStats m_pressureStats;
+        float m_pressureMs = 0.0f;
 
         // Boundaries in world space (axis-aligned box)
         float m_domainWidth = 600.0f;
@@ -268,7 +274,7 @@ namespace dx3d
         float m_boundaryTopOffset = 15.0f;
 
         // Interactive FirmGuy ball parameters
-        std::string m_ballEntityName = "FluidBall";
+        NameId m_ballEntityName = NameTable::intern("FluidBall");
         bool m_ballEnabled = false;
         float m_ballRadius = 18.0f;
         float m_ballMass = 3.0f;
@@ -300,7 +306,7 @@ namespace dx3d
         // Clustered mesh rendering removed - not worth keeping
 
         // Helpers to name entities
-        std::string boundaryName(int i) const;
+        NameId boundaryName(int i) const;
         Vec2 getMouseWorldPosition() const;
     };
 }
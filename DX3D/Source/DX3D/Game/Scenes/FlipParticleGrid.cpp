@@ -0,0 +1,146 @@
+#include <DX3D/Game/Scenes/FlipParticleGrid.h>
+#include <cstdlib>
+
+using namespace dx3d;
+
+void FlipParticleGrid::resize(float originX, float originY, float width, float height, float cellSize)
+{
+    cellSize = std::max(cellSize, 1e-3f);
+    const float invCellSize = 1.0f / cellSize;
+    const int cellsX = std::max(1, static_cast<int>(std::ceil(width * invCellSize)));
+    const int cellsY = std::max(1, static_cast<int>(std::ceil(height * invCellSize)));
+    if (originX == m_originX && originY == m_originY && cellSize == m_cellSize && cellsX == m_cellsX && cellsY == m_cellsY)
+        return; // keep the cells for update()
+
+    m_originX = originX;
+    m_originY = originY;
+    m_cellSize = cellSize;
+    m_invCellSize = invCellSize;
+    m_cellsX = cellsX;
+    m_cellsY = cellsY;
+    m_cellStart.assign(static_cast<std::size_t>(m_cellsX) * m_cellsY + 1, 0);
+    m_particleCell.clear(); // the next update() sorts from scratch
+}
+
+void FlipParticleGrid::build(const float* x, const float* y, int count, int maxThreads)
+{
+    m_particleCell.resize(count);
+    JobSystem::getInstance().parallelFor(0, count, 1024, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+            m_particleCell[i] = cellOf(x[i], y[i]);
+    }, maxThreads);
+    sortByCell();
+}
+
+int FlipParticleGrid::update(const float* x, const float* y, int count, int maxThreads)
+{
+    if (count != static_cast<int>(m_particleCell.size()))
+    {
+        build(x, y, count, maxThreads);
+        return count;
+    }
+    m_nextCell.resize(count);
+    JobSystem::getInstance().parallelFor(0, count, 1024, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+            m_nextCell[i] = cellOf(x[i], y[i]);
+    }, maxThreads);
+    return applyCellChanges();
+}
+
+void FlipParticleGrid::renumberSorted()
+{
+    m_nextCell.resize(m_sorted.size());
+    for (std::size_t k = 0; k < m_sorted.size(); ++k) m_nextCell[k] = m_particleCell[m_sorted[k]];
+    m_particleCell.swap(m_nextCell);
+    for (std::size_t k = 0; k < m_sorted.size(); ++k)
+    {
+        m_sorted[k] = static_cast<int>(k);
+        m_slot[k] = static_cast<int>(k);
+    }
+}
+
+int FlipParticleGrid::applyCellChanges()
+{
+    m_moved.clear();
+    long long shifts = 0;
+    for (int i = 0; i < static_cast<int>(m_nextCell.size()); ++i)
+    {
+        if (m_nextCell[i] == m_particleCell[i]) continue;
+        m_moved.push_back(i);
+        shifts += std::abs(m_nextCell[i] - m_particleCell[i]);
+    }
+    const int moved = static_cast<int>(m_moved.size());
+    if (shifts > static_cast<long long>(m_sorted.size() + m_cellStart.size()))
+    {
+        m_particleCell.swap(m_nextCell);
+        sortByCell();
+        return moved;
+    }
+    for (int p : m_moved) moveParticle(p, m_nextCell[p]);
+    return moved;
+}
+
+void FlipParticleGrid::moveParticle(int p, int to)
+{
+    // The hole left by p walks cell by cell: each cell on the way hands its slot next
+    // to the hole over to its neighbor by moving its particle at that end into the hole
+    int hole = m_slot[p];
+    const int from = m_particleCell[p];
+    if (from < to)
+    {
+        for (int c = from; c < to; ++c)
+        {
+            const int last = m_cellStart[c + 1] - 1;
+            if (last != hole)
+            {
+                const int q = m_sorted[last];
+                m_sorted[hole] = q;
+                m_slot[q] = hole;
+                hole = last;
+            }
+            --m_cellStart[c + 1];
+        }
+    }
+    else
+    {
+        for (int c = from; c > to; --c)
+        {
+            const int first = m_cellStart[c];
+            if (first != hole)
+            {
+                const int q = m_sorted[first];
+                m_sorted[hole] = q;
+                m_slot[q] = hole;
+                hole = first;
+            }
+            ++m_cellStart[c];
+        }
+    }
+    m_sorted[hole] = p;
+    m_slot[p] = hole;
+    m_particleCell[p] = to;
+}
+
+void FlipParticleGrid::sortByCell()
+{
+    // Count into m_cellStart[c + 1], prefix-sum to start offsets, then scatter
+    // with a running cursor per cell (m_cellStart[c] advances to the next start and
+    // is shifted back afterwards)
+    std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+    for (int cell : m_particleCell) ++m_cellStart[cell + 1];
+    for (std::size_t c = 1; c < m_cellStart.size(); ++c) m_cellStart[c] += m_cellStart[c - 1];
+
+    m_sorted.resize(m_particleCell.size());
+    m_slot.resize(m_particleCell.size());
+    for (int i = 0; i < static_cast<int>(m_particleCell.size()); ++i)
+    {
+        const int slot = m_cellStart[m_particleCell[i]]++;
+        m_sorted[slot] = i;
+        m_slot[i] = slot;
+    }
+
+    for (std::size_t c = m_cellStart.size() - 1; c > 0; --c) m_cellStart[c] = m_cellStart[c - 1];
+    m_cellStart[0] = 0;
+}
@@ -0,0 +1,239 @@
+#pragma once
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace dx3d
+{
+    // Uniform grid over a particle set, built by counting sort: the cell of every
+    // particle, per-cell counts turned into start offsets by a prefix sum, then the
+    // particle indices grouped by cell (ascending within a cell after a build). The
+    // arrays are reused, so rebuilding allocates nothing once the particle count settles.
+    class FlipParticleGrid
+    {
+    public:
+        // Cover [originX, originX + width) x [originY, originY + height) with square cells;
+        // positions outside are clamped into the border cells
+        void resize(float originX, float originY, float width, float height, float cellSize);
+
+        // particles[i].position.x / .y for i in [0, particles.size())
+        template<typename Particles>
+        void build(const Particles& particles, int maxThreads = 1);
+        // Same from separate x[i] / y[i] arrays for i in [0, count)
+        void build(const float* x, const float* y, int count, int maxThreads = 1);
+
+        // Incremental build: only particles whose cell changed since the last build or
+        // update are moved, each shifted through the cells between its old and new one
+        // (cells are then no longer ascending inside). Falls back to a full sort when
+        // the count changed or that would touch fewer slots, e.g. after the particles
+        // were permuted without renumberSorted(). Returns the particles moved.
+        template<typename Particles>
+        int update(const Particles& particles, int maxThreads = 1);
+        int update(const float* x, const float* y, int count, int maxThreads = 1);
+        // The particles were gathered in getSortedIndices() order: renumber the cells
+        // to match (particle k is the one that sat in slot k) without sorting again
+        void renumberSorted();
+
+        int cellOf(float x, float y) const
+        {
+            const int cx = std::clamp(static_cast<int>(std::floor((x - m_originX) * m_invCellSize)), 0, m_cellsX - 1);
+            const int cy = std::clamp(static_cast<int>(std::floor((y - m_originY) * m_invCellSize)), 0, m_cellsY - 1);
+            return cy * m_cellsX + cx;
+        }
+
+        int getCellsX() const { return m_cellsX; }
+        int getCellsY() const { return m_cellsY; }
+        float getCellSize() const { return m_cellSize; }
+        // Particles of a cell are getSortedIndices()[getCellStart(c) .. getCellEnd(c))
+        int getCellStart(int cell) const { return m_cellStart[cell]; }
+        int getCellEnd(int cell) const { return m_cellStart[cell + 1]; }
+        int getParticleCell(int particle) const { return m_particleCell[particle]; }
+        const std::vector<int>& getSortedIndices() const { return m_sorted; }
+
+    private:
+        // Counts, prefix sum and scatter once m_particleCell is filled
+        void sortByCell();
+        // Moves the particles whose m_nextCell differs from m_particleCell
+        int applyCellChanges();
+        // Moves particle p from its cell to cell to, shifting one slot through each cell between
+        void moveParticle(int p, int to);
+
+        float m_originX = 0.0f;
+        float m_originY = 0.0f;
+        float m_cellSize = 1.0f;
+        float m_invCellSize = 1.0f;
+        int m_cellsX = 1;
+        int m_cellsY = 1;
+        std::vector<int> m_cellStart{ 0, 0 }; // cells + 1 offsets into m_sorted
+        std::vector<int> m_particleCell;      // cell of each particle
+        std::vector<int> m_sorted;            // particle indices ordered by cell
+        std::vector<int> m_slot;              // position of each particle in m_sorted
+        std::vector<int> m_nextCell;          // update scratch
+        std::vector<int> m_moved;
+    };
+
+    template<typename Particles>
+    void FlipParticleGrid::build(const Particles& particles, int maxThreads)
+    {
+        const int count = static_cast<int>(particles.size());
+        m_particleCell.resize(count);
+        JobSystem::getInstance().parallelFor(0, count, 1024, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+                m_particleCell[i] = cellOf(particles[i].position.x, particles[i].position.y);
+        }, maxThreads);
+        sortByCell();
+    }
+
+    template<typename Particles>
+    int FlipParticleGrid::update(const Particles& particles, int maxThreads)
+    {
+        const int count = static_cast<int>(particles.size());
+        if (count != static_cast<int>(m_particleCell.size()))
+        {
+            build(particles, maxThreads);
+            return count;
+        }
+        m_nextCell.resize(count);
+        JobSystem::getInstance().parallelFor(0, count, 1024, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+                m_nextCell[i] = cellOf(particles[i].position.x, particles[i].position.y);
+        }, maxThreads);
+        return applyCellChanges();
+    }
+
+    struct FlipCollisionSettings
+    {
+        float targetDistance = 7.6f; // centers closer than this are pushed apart
+        float restitution = 0.1f;    // 0..1 along the contact normal
+        int iterations = 1;
+        int maxThreads = 1;
+    };
+
+    // Correction sums of one particle over its overlapping neighbors
+    struct FlipContactSums
+    {
+        float dpx = 0.0f, dpy = 0.0f, dvx = 0.0f, dvy = 0.0f;
+    };
+
+    // Adds neighbor j's push on particle i if they overlap
+    template<typename Particles>
+    void addFlipContact(const Particles& particles, int i, int j, const FlipCollisionSettings& settings, FlipContactSums& sums)
+    {
+        const float dx = particles[j].position.x - particles[i].position.x;
+        const float dy = particles[j].position.y - particles[i].position.y;
+        const float dist2 = dx * dx + dy * dy;
+        if (dist2 >= settings.targetDistance * settings.targetDistance) return;
+
+        // Normal from i to j; coincident particles split along x by index. Tested on
+        // dist2 itself: a clamped distance would never fall below the threshold
+        float nx, ny, dist;
+        if (dist2 > 1e-10f) { dist = std::sqrt(dist2); nx = dx / dist; ny = dy / dist; }
+        else { dist = 0.0f; nx = (j > i) ? 1.0f : -1.0f; ny = 0.0f; }
+
+        const float overlap = settings.targetDistance - dist;
+        sums.dpx -= nx * overlap * 0.5f;
+        sums.dpy -= ny * overlap * 0.5f;
+
+        const float relN = (particles[j].velocity.x - particles[i].velocity.x) * nx + (particles[j].velocity.y - particles[i].velocity.y) * ny;
+        if (relN < 0.0f)
+        {
+            const float impulse = -(1.0f + settings.restitution) * relN * 0.5f;
+            sums.dvx -= nx * impulse;
+            sums.dvy -= ny * impulse;
+        }
+    }
+
+    // One Jacobi iteration: contacts(i, sums) adds every neighbor's push on i, from the
+    // state at the start of the iteration; then all particles move at once
+    template<typename Particles, typename Contacts>
+    void applyFlipContacts(Particles& particles, Contacts&& contacts, int maxThreads, std::vector<float>& scratch)
+    {
+        const int count = static_cast<int>(particles.size());
+        scratch.resize(static_cast<std::size_t>(count) * 4);
+        JobSystem::getInstance().parallelFor(0, count, 256, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                FlipContactSums sums;
+                contacts(i, sums);
+                float* out = &scratch[static_cast<std::size_t>(i) * 4];
+                out[0] = particles[i].position.x + sums.dpx;
+                out[1] = particles[i].position.y + sums.dpy;
+                out[2] = particles[i].velocity.x + sums.dvx;
+                out[3] = particles[i].velocity.y + sums.dvy;
+            }
+        }, maxThreads);
+
+        JobSystem::getInstance().parallelFor(0, count, 1024, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const float* in = &scratch[static_cast<std::size_t>(i) * 4];
+                particles[i].position.x = in[0];
+                particles[i].position.y = in[1];
+                particles[i].velocity.x = in[2];
+                particles[i].velocity.y = in[3];
+            }
+        }, maxThreads);
+    }
+
+    // Pairwise separation and restitution over the grid neighborhood, Jacobi style:
+    // each particle sums its corrections from every overlapping neighbor against the
+    // positions and velocities at the start of the iteration, then all particles
+    // move at once. Every pair is seen from both sides with opposite signs, so one
+    // pair resolves exactly as in a sequential sweep, and the result does not depend
+    // on the thread count or on which thread ran which particles. The grid is
+    // updated before each iteration, moving only the particles that changed cell; its
+    // cells must be at least targetDistance wide. scratch holds the corrected state
+    // between the gather and the write-back.
+    template<typename Particles>
+    void resolveFlipCollisions(Particles& particles, FlipParticleGrid& grid, const FlipCollisionSettings& settings, std::vector<float>& scratch)
+    {
+        const int cellsX = grid.getCellsX();
+        const int cellsY = grid.getCellsY();
+        for (int it = 0; it < settings.iterations; ++it)
+        {
+            grid.update(particles, settings.maxThreads);
+            const std::vector<int>& sorted = grid.getSortedIndices();
+            applyFlipContacts(particles, [&](int i, FlipContactSums& sums)
+            {
+                const int cell = grid.getParticleCell(i);
+                const int cx = cell % cellsX;
+                const int cy = cell / cellsX;
+                for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, cellsY - 1); ++y)
+                {
+                    for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, cellsX - 1); ++x)
+                    {
+                        const int c = y * cellsX + x;
+                        for (int k = grid.getCellStart(c); k < grid.getCellEnd(c); ++k)
+                        {
+                            const int j = sorted[k];
+                            if (j != i) addFlipContact(particles, i, j, settings, sums);
+                        }
+                    }
+                }
+            }, settings.maxThreads, scratch);
+        }
+    }
+
+    // Same over a pair list (begin / end / getIndex, as SPHNeighborTable) instead of
+    // the grid: refreshPairs() runs before each iteration and must leave every pair
+    // closer than targetDistance in it, e.g. by re-measuring a Verlet list and only
+    // rebuilding it from the grid when particles moved too far
+    template<typename Particles, typename Pairs, typename RefreshPairs>
+    void resolveFlipCollisions(Particles& particles, const Pairs& pairs, RefreshPairs&& refreshPairs, const FlipCollisionSettings& settings, std::vector<float>& scratch)
+    {
+        for (int it = 0; it < settings.iterations; ++it)
+        {
+            refreshPairs();
+            applyFlipContacts(particles, [&](int i, FlipContactSums& sums)
+            {
+                for (int k = pairs.begin(i); k < pairs.end(i); ++k)
+                    addFlipContact(particles, i, pairs.getIndex(k), settings, sums);
+            }, settings.maxThreads, scratch);
+        }
+    }
+}
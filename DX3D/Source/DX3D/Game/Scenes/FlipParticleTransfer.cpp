@@ -0,0 +1,480 @@
+#include <DX3D/Game/Scenes/FlipParticleTransfer.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define DX3D_FLIP_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DX3D_FLIP_SSE2 1
+#endif
+#if defined(DX3D_FLIP_SSE2) || defined(DX3D_FLIP_AVX2)
+#include <immintrin.h>
+#endif
+
+using namespace dx3d;
+
+namespace
+{
+    // Same as the scene's clampf(v, 0, 1)
+    float clamp01(float v) { return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v); }
+
+    struct StencilOut
+    {
+        int* i0;
+        int* j0;
+        float* wx0;
+        float* wx1;
+        float* wy0;
+        float* wy1;
+    };
+
+    struct StencilParams
+    {
+        float originX;
+        float originY;
+        float cellSize;
+        float shiftX; // subtracted in cell units: 0.5 moves onto the other face family
+        float shiftY;
+    };
+
+    void stencilScalar(const float* px, const float* py, const StencilParams& params, const StencilOut& out, int begin, int end)
+    {
+        for (int p = begin; p < end; ++p)
+        {
+            const float gx = (px[p] - params.originX) / params.cellSize - params.shiftX;
+            const float gy = (py[p] - params.originY) / params.cellSize - params.shiftY;
+            const int i = static_cast<int>(std::floor(gx));
+            const int j = static_cast<int>(std::floor(gy));
+            out.i0[p] = i;
+            out.j0[p] = j;
+            out.wx0[p] = clamp01(1.0f - std::abs(gx - static_cast<float>(i)));
+            out.wx1[p] = clamp01(1.0f - std::abs(gx - static_cast<float>(i + 1)));
+            out.wy0[p] = clamp01(1.0f - std::abs(gy - static_cast<float>(j)));
+            out.wy1[p] = clamp01(1.0f - std::abs(gy - static_cast<float>(j + 1)));
+        }
+    }
+
+    // ========================= Lane types =========================
+
+#if defined(DX3D_FLIP_SSE2)
+    struct SseLanes
+    {
+        using F = __m128;
+        using I = __m128i;
+        static constexpr int Width = 4;
+
+        static F load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+        static void store(int* p, I v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        static F set(float v) { return _mm_set1_ps(v); }
+        static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+        static F div(F a, F b) { return _mm_div_ps(a, b); }
+        static F abs(F a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+        // Same result as the scalar clamp01, including for NaN
+        static F clamp01(F a) { return _mm_min_ps(set(1.0f), _mm_max_ps(_mm_setzero_ps(), a)); }
+        static I floorToInt(F a)
+        {
+            const I t = _mm_cvttps_epi32(a);
+            return _mm_add_epi32(t, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(t), a)));
+        }
+        static I next(I a) { return _mm_add_epi32(a, _mm_set1_epi32(1)); }
+        static F toFloat(I a) { return _mm_cvtepi32_ps(a); }
+    };
+#endif
+
+#if defined(DX3D_FLIP_AVX2)
+    struct AvxLanes
+    {
+        using F = __m256;
+        using I = __m256i;
+        static constexpr int Width = 8;
+
+        static F load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+        static void store(int* p, I v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        static F set(float v) { return _mm256_set1_ps(v); }
+        static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F div(F a, F b) { return _mm256_div_ps(a, b); }
+        static F abs(F a) { return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+        static F clamp01(F a) { return _mm256_min_ps(set(1.0f), _mm256_max_ps(_mm256_setzero_ps(), a)); }
+        static I floorToInt(F a)
+        {
+            const I t = _mm256_cvttps_epi32(a);
+            return _mm256_add_epi32(t, _mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(t), a, _CMP_GT_OQ)));
+        }
+        static I next(I a) { return _mm256_add_epi32(a, _mm256_set1_epi32(1)); }
+        static F toFloat(I a) { return _mm256_cvtepi32_ps(a); }
+    };
+#endif
+
+    // Whole vectors of particles from begin; returns where the scalar tail starts
+    template<typename L>
+    int stencilLanes(const float* px, const float* py, const StencilParams& params, const StencilOut& out, int begin, int end)
+    {
+        const typename L::F originX = L::set(params.originX);
+        const typename L::F originY = L::set(params.originY);
+        const typename L::F cellSize = L::set(params.cellSize);
+        const typename L::F shiftX = L::set(params.shiftX);
+        const typename L::F shiftY = L::set(params.shiftY);
+        const typename L::F one = L::set(1.0f);
+
+        int p = begin;
+        for (; p + L::Width <= end; p += L::Width)
+        {
+            const typename L::F gx = L::sub(L::div(L::sub(L::load(px + p), originX), cellSize), shiftX);
+            const typename L::F gy = L::sub(L::div(L::sub(L::load(py + p), originY), cellSize), shiftY);
+            const typename L::I i = L::floorToInt(gx);
+            const typename L::I j = L::floorToInt(gy);
+            L::store(out.i0 + p, i);
+            L::store(out.j0 + p, j);
+            L::store(out.wx0 + p, L::clamp01(L::sub(one, L::abs(L::sub(gx, L::toFloat(i))))));
+            L::store(out.wx1 + p, L::clamp01(L::sub(one, L::abs(L::sub(gx, L::toFloat(L::next(i)))))));
+            L::store(out.wy0 + p, L::clamp01(L::sub(one, L::abs(L::sub(gy, L::toFloat(j))))));
+            L::store(out.wy1 + p, L::clamp01(L::sub(one, L::abs(L::sub(gy, L::toFloat(L::next(j)))))));
+        }
+        return p;
+    }
+
+    void stencilRange(const float* px, const float* py, const StencilParams& params, const StencilOut& out, int begin, int end)
+    {
+#if defined(DX3D_FLIP_AVX2)
+        begin = stencilLanes<AvxLanes>(px, py, params, out, begin, end);
+#endif
+#if defined(DX3D_FLIP_SSE2)
+        begin = stencilLanes<SseLanes>(px, py, params, out, begin, end);
+#endif
+        stencilScalar(px, py, params, out, begin, end);
+    }
+}
+
+const char* dx3d::getFlipTransferModeName(FlipTransferMode mode)
+{
+    switch (mode)
+    {
+    case FlipTransferMode::PrivateGrids: return "Private Grids";
+    case FlipTransferMode::Gather: return "Gather (Deterministic)";
+    default: return "Serial";
+    }
+}
+
+const char* dx3d::getFlipVelocityModeName(FlipVelocityMode mode)
+{
+    return mode == FlipVelocityMode::Apic ? "APIC" : "PIC/FLIP";
+}
+
+FlipFaceSample dx3d::sampleFlipFaces(const float* faces, int facesX, int facesY, const FlipFaceGrid& grid,
+    float shiftX, float shiftY, float x, float y)
+{
+    const float gx = (x - grid.originX) / grid.cellSize - shiftX;
+    const float gy = (y - grid.originY) / grid.cellSize - shiftY;
+    const int i0 = (int)std::floor(gx);
+    const int j0 = (int)std::floor(gy);
+    const float tx = gx - i0;
+    const float ty = gy - j0;
+
+    auto at = [&](int i, int j) -> float
+    {
+        const int idx = flipFaceIndex(grid, i, j, facesX, facesY);
+        return idx < 0 ? 0.0f : faces[idx];
+    };
+    const float v00 = at(i0, j0);
+    const float v10 = at(i0 + 1, j0);
+    const float v01 = at(i0, j0 + 1);
+    const float v11 = at(i0 + 1, j0 + 1);
+
+    FlipFaceSample sample;
+    const float bottom = v00 + (v10 - v00) * tx;
+    const float top = v01 + (v11 - v01) * tx;
+    sample.value = bottom + (top - bottom) * ty;
+    // Gradient of the bilinear weights: d(w)/dx = +-(1 - ty or ty) / cellSize, likewise for y
+    sample.gradX = ((v10 - v00) * (1.0f - ty) + (v11 - v01) * ty) / grid.cellSize;
+    sample.gradY = (top - bottom) / grid.cellSize;
+    return sample;
+}
+
+float FlipParticleTransfer::carried(const float* velocity, const float* affineX, const float* affineY,
+    const FlipFaceGrid& grid, float shiftX, float shiftY, int p, int i, int j) const
+{
+    if (!m_affine)
+        return velocity[p];
+    // Same expressions as the stencil, so every path carries identical values
+    const float gx = (m_px[p] - grid.originX) / grid.cellSize - shiftX;
+    const float gy = (m_py[p] - grid.originY) / grid.cellSize - shiftY;
+    return velocity[p] + (affineX[p] * (i - gx) + affineY[p] * (j - gy)) * grid.cellSize;
+}
+
+void FlipParticleTransfer::transfer(const FlipFaceGrid& grid, FlipTransferMode mode, int maxThreads)
+{
+    if (mode == FlipTransferMode::Serial)
+    {
+        transferSerial(grid);
+        return;
+    }
+
+    computeStencil(m_uStencil, grid, 0.0f, 0.5f, maxThreads);
+    computeStencil(m_vStencil, grid, 0.5f, 0.0f, maxThreads);
+
+    if (mode == FlipTransferMode::PrivateGrids)
+    {
+        transferPrivateGrids(grid, maxThreads);
+        return;
+    }
+
+    binStencil(m_uStencil, grid, grid.width + 1, grid.height);
+    binStencil(m_vStencil, grid, grid.width, grid.height + 1);
+    gatherFaces(m_uStencil, m_vx.data(), m_affineUX.data(), m_affineUY.data(), grid, 0.0f, 0.5f, grid.width + 1, grid.height, grid.u, grid.uWeight, maxThreads);
+    gatherFaces(m_vStencil, m_vy.data(), m_affineVX.data(), m_affineVY.data(), grid, 0.5f, 0.0f, grid.width, grid.height + 1, grid.v, grid.vWeight, maxThreads);
+}
+
+void FlipParticleTransfer::transferSerial(const FlipFaceGrid& grid)
+{
+    const int uSize = flipFaceCount(grid, grid.width + 1, grid.height);
+    const int vSize = flipFaceCount(grid, grid.width, grid.height + 1);
+    std::fill(grid.u, grid.u + uSize, 0.0f);
+    std::fill(grid.uWeight, grid.uWeight + uSize, 0.0f);
+    std::fill(grid.v, grid.v + vSize, 0.0f);
+    std::fill(grid.vWeight, grid.vWeight + vSize, 0.0f);
+
+    for (int p = 0; p < static_cast<int>(m_px.size()); ++p)
+    {
+        // U (faces between i and i+1 at j)
+        {
+            float gx = (m_px[p] - grid.originX) / grid.cellSize;
+            float gy = (m_py[p] - grid.originY) / grid.cellSize - 0.5f;
+            int i0 = (int)std::floor(gx);
+            int j0 = (int)std::floor(gy);
+            for (int dj = 0; dj <= 1; ++dj)
+            {
+                for (int di = 0; di <= 1; ++di)
+                {
+                    int i = i0 + di;
+                    int j = j0 + dj;
+                    int idx = flipFaceIndex(grid, i, j, grid.width + 1, grid.height);
+                    if (idx < 0) continue;
+                    float w = clamp01(1.0f - std::abs(gx - i)) * clamp01(1.0f - std::abs(gy - j));
+                    grid.u[idx] += carried(m_vx.data(), m_affineUX.data(), m_affineUY.data(), grid, 0.0f, 0.5f, p, i, j) * w;
+                    grid.uWeight[idx] += w;
+                }
+            }
+        }
+
+        // V (faces between j and j+1 at i)
+        {
+            float gx = (m_px[p] - grid.originX) / grid.cellSize - 0.5f;
+            float gy = (m_py[p] - grid.originY) / grid.cellSize;
+            int i0 = (int)std::floor(gx);
+            int j0 = (int)std::floor(gy);
+            for (int dj = 0; dj <= 1; ++dj)
+            {
+                for (int di = 0; di <= 1; ++di)
+                {
+                    int i = i0 + di;
+                    int j = j0 + dj;
+                    int idx = flipFaceIndex(grid, i, j, grid.width, grid.height + 1);
+                    if (idx < 0) continue;
+                    float w = clamp01(1.0f - std::abs(gx - i)) * clamp01(1.0f - std::abs(gy - j));
+                    grid.v[idx] += carried(m_vy.data(), m_affineVX.data(), m_affineVY.data(), grid, 0.5f, 0.0f, p, i, j) * w;
+                    grid.vWeight[idx] += w;
+                }
+            }
+        }
+    }
+}
+
+void FlipParticleTransfer::computeStencil(Stencil& stencil, const FlipFaceGrid& grid, float shiftX, float shiftY, int maxThreads)
+{
+    const int count = static_cast<int>(m_px.size());
+    for (auto* ints : { &stencil.i0, &stencil.j0 }) ints->resize(count);
+    for (auto* weights : { &stencil.wx0, &stencil.wx1, &stencil.wy0, &stencil.wy1 }) weights->resize(count);
+
+    const StencilParams params{ grid.originX, grid.originY, grid.cellSize, shiftX, shiftY };
+    const StencilOut out{ stencil.i0.data(), stencil.j0.data(), stencil.wx0.data(), stencil.wx1.data(), stencil.wy0.data(), stencil.wy1.data() };
+    JobSystem::getInstance().parallelFor(0, count, 2048, [&](int begin, int end)
+    {
+        stencilRange(m_px.data(), m_py.data(), params, out, begin, end);
+    }, maxThreads);
+}
+
+void FlipParticleTransfer::transferPrivateGrids(const FlipFaceGrid& grid, int maxThreads)
+{
+    const int count = static_cast<int>(m_px.size());
+    const int uSize = flipFaceCount(grid, grid.width + 1, grid.height);
+    const int vSize = flipFaceCount(grid, grid.width, grid.height + 1);
+    const std::size_t sliceSize = static_cast<std::size_t>(uSize) * 2 + static_cast<std::size_t>(vSize) * 2;
+    // One slice per thread, but no more than keeps each slice's scatter worth its clear and reduction
+    const int slices = std::clamp(std::min(maxThreads, count / 1024), 1, std::max(1, maxThreads));
+    m_private.resize(sliceSize * slices);
+
+    JobSystem::getInstance().parallelFor(0, slices, 1, [&](int sliceBegin, int sliceEnd)
+    {
+        for (int s = sliceBegin; s < sliceEnd; ++s)
+        {
+            float* u = m_private.data() + sliceSize * s;
+            float* uWeight = u + uSize;
+            float* v = uWeight + uSize;
+            float* vWeight = v + vSize;
+            std::fill(u, u + sliceSize, 0.0f);
+
+            const int first = static_cast<int>(static_cast<long long>(count) * s / slices);
+            const int last = static_cast<int>(static_cast<long long>(count) * (s + 1) / slices);
+            auto scatter = [&](const Stencil& st, const float* velocity, const float* affineX, const float* affineY,
+                float shiftX, float shiftY, int p, int facesX, int facesY, float* sum, float* weight)
+            {
+                const float wx[2] = { st.wx0[p], st.wx1[p] };
+                const float wy[2] = { st.wy0[p], st.wy1[p] };
+                for (int dj = 0; dj <= 1; ++dj)
+                {
+                    const int j = st.j0[p] + dj;
+                    for (int di = 0; di <= 1; ++di)
+                    {
+                        const int i = st.i0[p] + di;
+                        const int idx = flipFaceIndex(grid, i, j, facesX, facesY);
+                        if (idx < 0) continue;
+                        const float w = wx[di] * wy[dj];
+                        sum[idx] += carried(velocity, affineX, affineY, grid, shiftX, shiftY, p, i, j) * w;
+                        weight[idx] += w;
+                    }
+                }
+            };
+            for (int p = first; p < last; ++p)
+            {
+                scatter(m_uStencil, m_vx.data(), m_affineUX.data(), m_affineUY.data(), 0.0f, 0.5f, p, grid.width + 1, grid.height, u, uWeight);
+                scatter(m_vStencil, m_vy.data(), m_affineVX.data(), m_affineVY.data(), 0.5f, 0.0f, p, grid.width, grid.height + 1, v, vWeight);
+            }
+        }
+    }, maxThreads);
+
+    // Sum the slices in slice order
+    auto reduce = [&](std::size_t offset, int size, float* dst)
+    {
+        JobSystem::getInstance().parallelFor(0, size, 4096, [&](int begin, int end)
+        {
+            const float* first = m_private.data() + offset;
+            std::copy(first + begin, first + end, dst + begin);
+            for (int s = 1; s < slices; ++s)
+            {
+                const float* src = m_private.data() + sliceSize * s + offset;
+                for (int k = begin; k < end; ++k) dst[k] += src[k];
+            }
+        }, maxThreads);
+    };
+    reduce(0, uSize, grid.u);
+    reduce(uSize, uSize, grid.uWeight);
+    reduce(static_cast<std::size_t>(uSize) * 2, vSize, grid.v);
+    reduce(static_cast<std::size_t>(uSize) * 2 + vSize, vSize, grid.vWeight);
+}
+
+void FlipParticleTransfer::binStencil(Stencil& stencil, const FlipFaceGrid& grid, int facesX, int facesY)
+{
+    // Bin (i0 + 1, j0 + 1) for base faces in [-1, facesX) x [-1, facesY); particles
+    // based further out touch no face. Counting sort keeps indices ascending per bin.
+    const int count = static_cast<int>(stencil.i0.size());
+    auto binOf = [&](int p)
+    {
+        return flipFaceIndex(grid, stencil.i0[p] + 1, stencil.j0[p] + 1, facesX + 1, facesY + 1);
+    };
+
+    stencil.binStart.assign(static_cast<std::size_t>(flipFaceCount(grid, facesX + 1, facesY + 1)) + 1, 0);
+    for (int p = 0; p < count; ++p)
+    {
+        const int bin = binOf(p);
+        if (bin >= 0) ++stencil.binStart[bin + 1];
+    }
+    for (std::size_t b = 1; b < stencil.binStart.size(); ++b) stencil.binStart[b] += stencil.binStart[b - 1];
+
+    stencil.binned.resize(stencil.binStart.back());
+    for (int p = 0; p < count; ++p)
+    {
+        const int bin = binOf(p);
+        if (bin >= 0) stencil.binned[stencil.binStart[bin]++] = p;
+    }
+    for (std::size_t b = stencil.binStart.size() - 1; b > 0; --b) stencil.binStart[b] = stencil.binStart[b - 1];
+    stencil.binStart[0] = 0;
+}
+
+void FlipParticleTransfer::gatherFaces(const Stencil& stencil, const float* velocity, const float* affineX, const float* affineY,
+    const FlipFaceGrid& grid, float shiftX, float shiftY, int facesX, int facesY, float* sum, float* weight, int maxThreads)
+{
+    // Face (i, j) is reached from base faces (i - 1 | i, j - 1 | j), i.e. bins
+    // (i | i + 1, j | j + 1). Merging the four ascending bins visits the particles
+    // in index order, so each face adds exactly what the serial loop adds, in order.
+    auto gatherFace = [&](int i, int j)
+    {
+        const int bins[4] =
+        {
+            flipFaceIndex(grid, i, j, facesX + 1, facesY + 1),
+            flipFaceIndex(grid, i + 1, j, facesX + 1, facesY + 1),
+            flipFaceIndex(grid, i, j + 1, facesX + 1, facesY + 1),
+            flipFaceIndex(grid, i + 1, j + 1, facesX + 1, facesY + 1)
+        };
+        const float* wx[4] = { stencil.wx1.data(), stencil.wx0.data(), stencil.wx1.data(), stencil.wx0.data() };
+        const float* wy[4] = { stencil.wy1.data(), stencil.wy1.data(), stencil.wy0.data(), stencil.wy0.data() };
+        int cursor[4], end[4];
+        for (int q = 0; q < 4; ++q)
+        {
+            cursor[q] = bins[q] < 0 ? 0 : stencil.binStart[bins[q]];
+            end[q] = bins[q] < 0 ? 0 : stencil.binStart[bins[q] + 1];
+        }
+
+        float s = 0.0f;
+        float ws = 0.0f;
+        while (true)
+        {
+            int best = -1;
+            int bestParticle = INT_MAX;
+            for (int q = 0; q < 4; ++q)
+            {
+                if (cursor[q] < end[q] && stencil.binned[cursor[q]] < bestParticle)
+                {
+                    best = q;
+                    bestParticle = stencil.binned[cursor[q]];
+                }
+            }
+            if (best < 0) break;
+            ++cursor[best];
+
+            const float w = wx[best][bestParticle] * wy[best][bestParticle];
+            s += carried(velocity, affineX, affineY, grid, shiftX, shiftY, bestParticle, i, j) * w;
+            ws += w;
+        }
+        const int idx = flipFaceIndex(grid, i, j, facesX, facesY);
+        sum[idx] = s;
+        weight[idx] = ws;
+    };
+
+    if (!grid.tileSlots)
+    {
+        JobSystem::getInstance().parallelFor(0, facesY, 1, [&](int rowBegin, int rowEnd)
+        {
+            for (int j = rowBegin; j < rowEnd; ++j)
+                for (int i = 0; i < facesX; ++i) gatherFace(i, j);
+        }, maxThreads);
+        return;
+    }
+
+    // Tiled: only allocated tiles; entries past the family's edge are zeroed
+    JobSystem::getInstance().parallelFor(0, grid.slotCount, 4, [&](int slotBegin, int slotEnd)
+    {
+        for (int slot = slotBegin; slot < slotEnd; ++slot)
+        {
+            const int tileX = grid.slotTiles[slot] % grid.tilesX;
+            const int tileY = grid.slotTiles[slot] / grid.tilesX;
+            for (int local = 0; local < 64; ++local)
+            {
+                const int i = tileX * 8 + (local & 7);
+                const int j = tileY * 8 + (local >> 3);
+                if (i < facesX && j < facesY)
+                {
+                    gatherFace(i, j);
+                }
+                else
+                {
+                    sum[slot * 64 + local] = 0.0f;
+                    weight[slot * 64 + local] = 0.0f;
+                }
+            }
+        }
+    }, maxThreads);
+}
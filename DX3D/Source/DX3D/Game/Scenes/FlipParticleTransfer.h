@@ -0,0 +1,213 @@
+#pragma once
+#include <DX3D/Core/JobSystem.h>
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // How particle velocities are scattered onto the MAC faces
+    enum class FlipTransferMode : uint8_t
+    {
+        Serial = 0,   // reference loop on the calling thread
+        PrivateGrids, // one private grid per slice of particles, then a per-face reduction
+        Gather        // each face sums its particles in index order; bit-identical to Serial
+    };
+
+    const char* getFlipTransferModeName(FlipTransferMode mode);
+
+    // What particles take back from the grid
+    enum class FlipVelocityMode : uint8_t
+    {
+        PicFlip = 0, // blend of the particle's own velocity and the grid's
+        Apic         // grid velocity plus its gradient as a per-particle affine field
+    };
+
+    const char* getFlipVelocityModeName(FlipVelocityMode mode);
+
+    // Face-centered grid the transfer writes: u and uWeight are (width + 1) x height,
+    // v and vWeight are width x (height + 1), all row-major
+    struct FlipFaceGrid
+    {
+        float originX = 0.0f;
+        float originY = 0.0f;
+        float cellSize = 1.0f;
+        int width = 0;
+        int height = 0;
+        float* u = nullptr;
+        float* uWeight = nullptr;
+        float* v = nullptr;
+        float* vWeight = nullptr;
+
+        // Optional 8x8 tiling (FlipSparseGrid): face (i, j) of either family is entry
+        // (j & 7) * 8 + (i & 7) of tile slot tileSlots[(j >> 3) * tilesX + (i >> 3)],
+        // and each array holds slotCount * 64 entries. Slot -1 is not allocated:
+        // its faces read as 0 and take no writes.
+        const int* tileSlots = nullptr;
+        const int* slotTiles = nullptr; // tile index of each slot
+        int tilesX = 0;
+        int slotCount = 0;
+    };
+
+    // Array index of face (i, j) in a facesX x facesY family, or -1
+    inline int flipFaceIndex(const FlipFaceGrid& grid, int i, int j, int facesX, int facesY)
+    {
+        if (i < 0 || j < 0 || i >= facesX || j >= facesY) return -1;
+        if (!grid.tileSlots) return j * facesX + i;
+        const int slot = grid.tileSlots[(j >> 3) * grid.tilesX + (i >> 3)];
+        return slot < 0 ? -1 : slot * 64 + ((j & 7) << 3) + (i & 7);
+    }
+
+    // Entries in each array of a facesX x facesY family
+    inline int flipFaceCount(const FlipFaceGrid& grid, int facesX, int facesY)
+    {
+        return grid.tileSlots ? grid.slotCount * 64 : facesX * facesY;
+    }
+
+    // Bilinear sample of one face family and its spatial gradient (per world unit)
+    struct FlipFaceSample
+    {
+        float value = 0.0f;
+        float gradX = 0.0f;
+        float gradY = 0.0f;
+    };
+
+    // faces is facesX x facesY, offset by (shiftX, shiftY) cells from the grid origin;
+    // faces outside the grid (or in unallocated tiles) read as 0
+    FlipFaceSample sampleFlipFaces(const float* faces, int facesX, int facesY, const FlipFaceGrid& grid,
+        float shiftX, float shiftY, float x, float y);
+
+    // Particle/grid transfers with bilinear weights. Positions and velocities are
+    // copied to flat arrays, then the base face and the four clamped 1D weights of
+    // every particle are computed once, four or eight particles at a time, with
+    // the same operations as the scalar loop. Serial and Gather match bit for bit
+    // (up to floating point contraction); PrivateGrids sums in a different order
+    // but is repeatable for a given thread count. On a tiled grid every particle's
+    // own tile and its neighbors must be allocated.
+    class FlipParticleTransfer
+    {
+    public:
+        // Overwrite the face arrays with the weighted velocity and weight sums (not normalized).
+        // particles[i].position.x / .y and .velocity.x / .y for i in [0, particles.size());
+        // with affine set, particles also need .affineU / .affineV (APIC), and each face
+        // receives velocity + affine . (face - position)
+        template<typename Particles>
+        void particlesToGrid(const Particles& particles, const FlipFaceGrid& grid, FlipTransferMode mode, int maxThreads = 1, bool affine = false);
+
+        // Read the (normalized, projected) face velocities back. PicFlip sets
+        // velocity = velocity * flipBlending + grid * (1 - flipBlending); Apic sets
+        // velocity = grid and affineU / affineV to the gradients of u and v.
+        template<typename Particles>
+        void gridToParticles(Particles& particles, const FlipFaceGrid& grid, FlipVelocityMode mode, float flipBlending, int maxThreads = 1) const;
+
+    private:
+        // Base face (i0, j0) and clamped weights for faces i0 / i0 + 1 and j0 / j0 + 1
+        struct Stencil
+        {
+            std::vector<int> i0;
+            std::vector<int> j0;
+            std::vector<float> wx0;
+            std::vector<float> wx1;
+            std::vector<float> wy0;
+            std::vector<float> wy1;
+            // Gather: particles grouped by base face + (1, 1), ascending within a bin;
+            // bins use the face layout of a (facesX + 1) x (facesY + 1) family
+            std::vector<int> binStart;
+            std::vector<int> binned;
+        };
+
+        void transfer(const FlipFaceGrid& grid, FlipTransferMode mode, int maxThreads);
+        void transferSerial(const FlipFaceGrid& grid);
+        void computeStencil(Stencil& stencil, const FlipFaceGrid& grid, float shiftX, float shiftY, int maxThreads);
+        void transferPrivateGrids(const FlipFaceGrid& grid, int maxThreads);
+        void binStencil(Stencil& stencil, const FlipFaceGrid& grid, int facesX, int facesY);
+        void gatherFaces(const Stencil& stencil, const float* velocity, const float* affineX, const float* affineY,
+            const FlipFaceGrid& grid, float shiftX, float shiftY, int facesX, int facesY, float* sum, float* weight, int maxThreads);
+
+        // Velocity particle p carries to face (i, j) of the family shifted by (shiftX, shiftY)
+        float carried(const float* velocity, const float* affineX, const float* affineY,
+            const FlipFaceGrid& grid, float shiftX, float shiftY, int p, int i, int j) const;
+
+        std::vector<float> m_px;
+        std::vector<float> m_py;
+        std::vector<float> m_vx;
+        std::vector<float> m_vy;
+        bool m_affine = false;
+        std::vector<float> m_affineUX; // APIC: gradient of u carried by each particle
+        std::vector<float> m_affineUY;
+        std::vector<float> m_affineVX; // and of v
+        std::vector<float> m_affineVY;
+        Stencil m_uStencil;
+        Stencil m_vStencil;
+        std::vector<float> m_private; // per slice: u, uWeight, v, vWeight
+    };
+
+    template<typename Particles>
+    void FlipParticleTransfer::particlesToGrid(const Particles& particles, const FlipFaceGrid& grid, FlipTransferMode mode, int maxThreads, bool affine)
+    {
+        const int count = static_cast<int>(particles.size());
+        m_px.resize(count);
+        m_py.resize(count);
+        m_vx.resize(count);
+        m_vy.resize(count);
+        JobSystem::getInstance().parallelFor(0, count, 2048, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                m_px[i] = particles[i].position.x;
+                m_py[i] = particles[i].position.y;
+                m_vx[i] = particles[i].velocity.x;
+                m_vy[i] = particles[i].velocity.y;
+            }
+        }, maxThreads);
+
+        m_affine = false;
+        if constexpr (requires { particles[0].affineU.x; particles[0].affineV.y; })
+        {
+            m_affine = affine;
+            if (affine)
+            {
+                for (auto* field : { &m_affineUX, &m_affineUY, &m_affineVX, &m_affineVY }) field->resize(count);
+                JobSystem::getInstance().parallelFor(0, count, 2048, [&](int begin, int end)
+                {
+                    for (int i = begin; i < end; ++i)
+                    {
+                        m_affineUX[i] = particles[i].affineU.x;
+                        m_affineUY[i] = particles[i].affineU.y;
+                        m_affineVX[i] = particles[i].affineV.x;
+                        m_affineVY[i] = particles[i].affineV.y;
+                    }
+                }, maxThreads);
+            }
+        }
+        transfer(grid, mode, maxThreads);
+    }
+
+    template<typename Particles>
+    void FlipParticleTransfer::gridToParticles(Particles& particles, const FlipFaceGrid& grid, FlipVelocityMode mode, float flipBlending, int maxThreads) const
+    {
+        JobSystem::getInstance().parallelFor(0, static_cast<int>(particles.size()), 256, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                auto& p = particles[i];
+                const FlipFaceSample u = sampleFlipFaces(grid.u, grid.width + 1, grid.height, grid, 0.0f, 0.5f, p.position.x, p.position.y);
+                const FlipFaceSample v = sampleFlipFaces(grid.v, grid.width, grid.height + 1, grid, 0.5f, 0.0f, p.position.x, p.position.y);
+                if constexpr (requires { p.affineU.x; p.affineV.y; })
+                {
+                    if (mode == FlipVelocityMode::Apic)
+                    {
+                        p.velocity.x = u.value;
+                        p.velocity.y = v.value;
+                        p.affineU.x = u.gradX;
+                        p.affineU.y = u.gradY;
+                        p.affineV.x = v.gradX;
+                        p.affineV.y = v.gradY;
+                        continue;
+                    }
+                }
+                p.velocity.x = p.velocity.x * flipBlending + u.value * (1.0f - flipBlending);
+                p.velocity.y = p.velocity.y * flipBlending + v.value * (1.0f - flipBlending);
+            }
+        }, maxThreads);
+    }
+}
@@ -0,0 +1,503 @@
+#include <DX3D/Game/Scenes/FlipPressureSolver.h>
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace dx3d;
+
+namespace
+{
+    const float MicTuning = 0.97f;       // MIC(0) tau
+    const float MicSafety = 0.25f;       // fall back to the diagonal below this fraction of it
+    const int SmoothSweeps = 2;          // red-black Gauss-Seidel pairs before and after each coarse correction
+    const int CoarsestSweeps = 16;       // pairs each way on the coarsest level
+    const int CoarsestSize = 8;          // stop coarsening once a side is this small
+
+    bool isFluid(const FlipCellType* cells, int id) { return cells[id] == FlipCellType::Fluid; }
+}
+
+const char* dx3d::getFlipPressureSolverName(FlipPressureSolverType type)
+{
+    switch (type)
+    {
+    case FlipPressureSolverType::ConjugateGradient: return "PCG (MIC0)";
+    case FlipPressureSolverType::Multigrid: return "Multigrid";
+    default: return "Jacobi";
+    }
+}
+
+template<typename RowFn>
+double FlipPressureSolver::sumRows(int height, RowFn&& rowFn)
+{
+    m_rowPartials.resize(height);
+    JobSystem::getInstance().parallelFor(0, height, 1, [&](int rowBegin, int rowEnd)
+    {
+        for (int j = rowBegin; j < rowEnd; ++j) m_rowPartials[j] = rowFn(j);
+    }, m_maxThreads);
+    double total = 0.0;
+    for (int j = 0; j < height; ++j) total += m_rowPartials[j];
+    return total;
+}
+
+template<typename RowFn>
+double FlipPressureSolver::maxRows(int height, RowFn&& rowFn)
+{
+    m_rowPartials.resize(height);
+    JobSystem::getInstance().parallelFor(0, height, 1, [&](int rowBegin, int rowEnd)
+    {
+        for (int j = rowBegin; j < rowEnd; ++j) m_rowPartials[j] = rowFn(j);
+    }, m_maxThreads);
+    double result = 0.0;
+    for (int j = 0; j < height; ++j) result = std::max(result, m_rowPartials[j]);
+    return result;
+}
+
+FlipPressureStats FlipPressureSolver::solve(int width, int height, const FlipCellType* cells, const float* divergence,
+    float cellSize, float* pressure, const FlipPressureSettings& settings)
+{
+    m_maxThreads = std::max(1, settings.maxThreads);
+    Level& top = m_top;
+    top.width = width;
+    top.height = height;
+    const std::size_t size = static_cast<std::size_t>(width) * height;
+    top.cells.assign(cells, cells + size);
+    top.x.resize(size);
+    top.b.resize(size);
+    top.r.resize(size);
+    setupLevel(top);
+
+    const float scale = -cellSize * cellSize;
+    const float bMax = static_cast<float>(maxRows(height, [&](int j)
+    {
+        double rowMax = 0.0;
+        for (int id = j * width; id < (j + 1) * width; ++id)
+        {
+            const bool fluid = top.diag[id] > 0;
+            top.b[id] = fluid ? divergence[id] * scale : 0.0f;
+            top.x[id] = fluid ? pressure[id] : 0.0f;
+            rowMax = std::max(rowMax, static_cast<double>(std::abs(top.b[id])));
+        }
+        return rowMax;
+    }));
+
+    FlipPressureStats stats;
+    if (bMax <= 0.0f)
+    {
+        std::fill(pressure, pressure + size, 0.0f);
+        stats.converged = true;
+        return stats;
+    }
+
+    switch (settings.type)
+    {
+    case FlipPressureSolverType::ConjugateGradient: stats = solveConjugateGradient(bMax, settings, false); break;
+    case FlipPressureSolverType::Multigrid: stats = solveConjugateGradient(bMax, settings, true); break;
+    default: stats = solveJacobi(bMax, settings); break;
+    }
+    std::copy(top.x.begin(), top.x.end(), pressure);
+    return stats;
+}
+
+void FlipPressureSolver::setupLevel(Level& level)
+{
+    const int w = level.width;
+    const int h = level.height;
+    level.diag.resize(static_cast<std::size_t>(w) * h);
+    JobSystem::getInstance().parallelFor(0, h, 8, [&](int rowBegin, int rowEnd)
+    {
+        for (int j = rowBegin; j < rowEnd; ++j)
+        {
+            for (int i = 0; i < w; ++i)
+            {
+                const int id = j * w + i;
+                if (!isFluid(level.cells.data(), id)) { level.diag[id] = 0; continue; }
+                int open = 0;
+                if (i > 0 && level.cells[id - 1] != FlipCellType::Solid) ++open;
+                if (i < w - 1 && level.cells[id + 1] != FlipCellType::Solid) ++open;
+                if (j > 0 && level.cells[id - w] != FlipCellType::Solid) ++open;
+                if (j < h - 1 && level.cells[id + w] != FlipCellType::Solid) ++open;
+                level.diag[id] = static_cast<uint8_t>(open);
+            }
+        }
+    }, m_maxThreads);
+}
+
+float FlipPressureSolver::residual(Level& level)
+{
+    const int w = level.width;
+    const FlipCellType* cells = level.cells.data();
+    return static_cast<float>(maxRows(level.height, [&](int j)
+    {
+        double rowMax = 0.0;
+        for (int i = 0; i < w; ++i)
+        {
+            const int id = j * w + i;
+            if (level.diag[id] == 0) { level.r[id] = 0.0f; continue; }
+            float ax = level.diag[id] * level.x[id];
+            if (i > 0 && isFluid(cells, id - 1)) ax -= level.x[id - 1];
+            if (i < w - 1 && isFluid(cells, id + 1)) ax -= level.x[id + 1];
+            if (j > 0 && isFluid(cells, id - w)) ax -= level.x[id - w];
+            if (j < level.height - 1 && isFluid(cells, id + w)) ax -= level.x[id + w];
+            level.r[id] = level.b[id] - ax;
+            rowMax = std::max(rowMax, static_cast<double>(std::abs(level.r[id])));
+        }
+        return rowMax;
+    }));
+}
+
+// ========================= Jacobi =========================
+
+FlipPressureStats FlipPressureSolver::solveJacobi(float bMax, const FlipPressureSettings& settings)
+{
+    // The residual of the current iterate falls out of the sweep: r = diag * (next - x)
+    Level& top = m_top;
+    const int w = top.width;
+    const FlipCellType* cells = top.cells.data();
+    FlipPressureStats stats;
+    float* x = top.x.data();
+    float* next = top.r.data();
+    for (;;)
+    {
+        const float* current = x;
+        float* out = next;
+        stats.residual = static_cast<float>(maxRows(top.height, [&](int j)
+        {
+            double rowMax = 0.0;
+            for (int i = 0; i < w; ++i)
+            {
+                const int id = j * w + i;
+                if (top.diag[id] == 0) { out[id] = 0.0f; continue; }
+                float sum = top.b[id];
+                if (i > 0 && isFluid(cells, id - 1)) sum += current[id - 1];
+                if (i < w - 1 && isFluid(cells, id + 1)) sum += current[id + 1];
+                if (j > 0 && isFluid(cells, id - w)) sum += current[id - w];
+                if (j < top.height - 1 && isFluid(cells, id + w)) sum += current[id + w];
+                out[id] = sum / top.diag[id];
+                rowMax = std::max(rowMax, static_cast<double>(std::abs(top.diag[id] * (out[id] - current[id]))));
+            }
+            return rowMax;
+        })) / bMax;
+
+        stats.converged = stats.residual <= settings.tolerance;
+        if (stats.converged || stats.iterations >= settings.maxIterations)
+            break;
+        std::swap(x, next);
+        ++stats.iterations;
+    }
+    // The swept buffers alternate between x and r; the last accepted iterate is x
+    if (x != top.x.data())
+        std::copy(x, x + top.x.size(), top.x.begin());
+    return stats;
+}
+
+// ========================= MIC(0) PCG =========================
+
+void FlipPressureSolver::buildMic0(const Level& level)
+{
+    // Modified incomplete Cholesky in lexicographic order (Bridson, "Fluid Simulation for Computer Graphics")
+    const int w = level.width;
+    const int h = level.height;
+    const FlipCellType* cells = level.cells.data();
+    m_precon.assign(level.diag.size(), 0.0f);
+    for (int j = 0; j < h; ++j)
+    {
+        for (int i = 0; i < w; ++i)
+        {
+            const int id = j * w + i;
+            if (level.diag[id] == 0) continue;
+            const float diag = level.diag[id];
+            float e = diag;
+            if (i > 0 && isFluid(cells, id - 1))
+            {
+                const float p = m_precon[id - 1];
+                e -= p * p;
+                if (j < h - 1 && isFluid(cells, id - 1 + w)) e -= MicTuning * p * p;
+            }
+            if (j > 0 && isFluid(cells, id - w))
+            {
+                const float p = m_precon[id - w];
+                e -= p * p;
+                if (i < w - 1 && isFluid(cells, id - w + 1)) e -= MicTuning * p * p;
+            }
+            if (e < MicSafety * diag) e = diag;
+            m_precon[id] = 1.0f / std::sqrt(e);
+        }
+    }
+}
+
+void FlipPressureSolver::applyMic0(const Level& level, const float* r, float* z)
+{
+    // Forward then backward substitution; inherently sequential
+    const int w = level.width;
+    const int h = level.height;
+    const FlipCellType* cells = level.cells.data();
+    float* q = m_q.data();
+    for (int j = 0; j < h; ++j)
+    {
+        for (int i = 0; i < w; ++i)
+        {
+            const int id = j * w + i;
+            if (level.diag[id] == 0) { q[id] = 0.0f; continue; }
+            float t = r[id];
+            if (i > 0 && isFluid(cells, id - 1)) t += m_precon[id - 1] * q[id - 1];
+            if (j > 0 && isFluid(cells, id - w)) t += m_precon[id - w] * q[id - w];
+            q[id] = t * m_precon[id];
+        }
+    }
+    for (int j = h - 1; j >= 0; --j)
+    {
+        for (int i = w - 1; i >= 0; --i)
+        {
+            const int id = j * w + i;
+            if (level.diag[id] == 0) { z[id] = 0.0f; continue; }
+            float t = q[id];
+            if (i < w - 1 && isFluid(cells, id + 1)) t += m_precon[id] * z[id + 1];
+            if (j < h - 1 && isFluid(cells, id + w)) t += m_precon[id] * z[id + w];
+            z[id] = t * m_precon[id];
+        }
+    }
+}
+
+FlipPressureStats FlipPressureSolver::solveConjugateGradient(float bMax, const FlipPressureSettings& settings, bool multigrid)
+{
+    Level& top = m_top;
+    const int w = top.width;
+    const int h = top.height;
+    const FlipCellType* cells = top.cells.data();
+    const std::size_t size = top.x.size();
+    m_z.resize(size);
+    m_s.resize(size);
+    m_q.resize(size);
+    float* x = top.x.data();
+    float* r = top.r.data();
+
+    FlipPressureStats stats;
+    stats.residual = residual(top) / bMax;
+    stats.converged = stats.residual <= settings.tolerance;
+    if (stats.converged)
+        return stats;
+
+    // z = M^-1 r with either preconditioner; both are symmetric, as CG requires
+    auto precondition = [&](float* z)
+    {
+        if (!multigrid)
+        {
+            applyMic0(top, r, z);
+            return;
+        }
+        Level& fine = m_levels[0];
+        std::copy(r, r + size, fine.b.begin());
+        std::fill(fine.x.begin(), fine.x.end(), 0.0f);
+        vCycle(0);
+        std::copy(fine.x.begin(), fine.x.end(), z);
+    };
+    if (multigrid)
+        buildLevels();
+    else
+        buildMic0(top);
+
+    precondition(m_z.data());
+    std::copy(m_z.begin(), m_z.end(), m_s.begin());
+    double sigma = sumRows(h, [&](int j)
+    {
+        double dot = 0.0;
+        for (int id = j * w; id < (j + 1) * w; ++id) dot += static_cast<double>(m_z[id]) * r[id];
+        return dot;
+    });
+
+    // m_q is the substitution scratch of applyMic0, so A*s lands in m_z
+    float* as = m_z.data();
+    while (stats.iterations < settings.maxIterations)
+    {
+        ++stats.iterations;
+        const double sAs = sumRows(h, [&](int j)
+        {
+            double dot = 0.0;
+            for (int i = 0; i < w; ++i)
+            {
+                const int id = j * w + i;
+                if (top.diag[id] == 0) { as[id] = 0.0f; continue; }
+                float v = top.diag[id] * m_s[id];
+                if (i > 0 && isFluid(cells, id - 1)) v -= m_s[id - 1];
+                if (i < w - 1 && isFluid(cells, id + 1)) v -= m_s[id + 1];
+                if (j > 0 && isFluid(cells, id - w)) v -= m_s[id - w];
+                if (j < h - 1 && isFluid(cells, id + w)) v -= m_s[id + w];
+                as[id] = v;
+                dot += static_cast<double>(v) * m_s[id];
+            }
+            return dot;
+        });
+        if (sAs <= 0.0)
+            break;
+
+        const float alpha = static_cast<float>(sigma / sAs);
+        stats.residual = static_cast<float>(maxRows(h, [&](int j)
+        {
+            double rowMax = 0.0;
+            for (int id = j * w; id < (j + 1) * w; ++id)
+            {
+                x[id] += alpha * m_s[id];
+                r[id] -= alpha * as[id];
+                rowMax = std::max(rowMax, static_cast<double>(std::abs(r[id])));
+            }
+            return rowMax;
+        })) / bMax;
+        stats.converged = stats.residual <= settings.tolerance;
+        if (stats.converged)
+            break;
+
+        precondition(m_z.data());
+        const double sigmaNew = sumRows(h, [&](int j)
+        {
+            double dot = 0.0;
+            for (int id = j * w; id < (j + 1) * w; ++id) dot += static_cast<double>(m_z[id]) * r[id];
+            return dot;
+        });
+        const float beta = static_cast<float>(sigmaNew / sigma);
+        sigma = sigmaNew;
+        JobSystem::getInstance().parallelFor(0, h, 8, [&](int rowBegin, int rowEnd)
+        {
+            for (int id = rowBegin * w; id < rowEnd * w; ++id) m_s[id] = m_z[id] + beta * m_s[id];
+        }, m_maxThreads);
+    }
+    return stats;
+}
+
+// ========================= Multigrid =========================
+
+void FlipPressureSolver::buildLevels()
+{
+    // Level 0 mirrors the problem grid. A coarse cell is Air if any child is Air
+    // (keeps the free surface on every level), else Fluid if any child is, else Solid.
+    if (m_levels.empty()) m_levels.emplace_back();
+    Level& first = m_levels[0];
+    first.width = m_top.width;
+    first.height = m_top.height;
+    first.cells = m_top.cells;
+    first.diag = m_top.diag;
+    first.x.resize(m_top.x.size());
+    first.b.resize(m_top.x.size());
+    first.r.resize(m_top.x.size());
+
+    std::size_t depth = 1;
+    while (true)
+    {
+        const Level& fine = m_levels[depth - 1];
+        if (std::min(fine.width, fine.height) <= CoarsestSize)
+            break;
+        if (m_levels.size() <= depth) m_levels.emplace_back();
+        Level& coarse = m_levels[depth];
+        const Level& parent = m_levels[depth - 1];
+        coarse.width = (parent.width + 1) / 2;
+        coarse.height = (parent.height + 1) / 2;
+        const std::size_t size = static_cast<std::size_t>(coarse.width) * coarse.height;
+        coarse.cells.resize(size);
+        coarse.x.resize(size);
+        coarse.b.resize(size);
+        coarse.r.resize(size);
+        for (int j = 0; j < coarse.height; ++j)
+        {
+            for (int i = 0; i < coarse.width; ++i)
+            {
+                bool air = false, fluid = false;
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int fi = 2 * i + (c & 1);
+                    const int fj = 2 * j + (c >> 1);
+                    if (fi >= parent.width || fj >= parent.height) continue;
+                    const FlipCellType type = parent.cells[fj * parent.width + fi];
+                    air = air || type == FlipCellType::Air;
+                    fluid = fluid || type == FlipCellType::Fluid;
+                }
+                coarse.cells[j * coarse.width + i] = air ? FlipCellType::Air : (fluid ? FlipCellType::Fluid : FlipCellType::Solid);
+            }
+        }
+        setupLevel(coarse);
+        ++depth;
+    }
+    m_levels.resize(depth);
+}
+
+void FlipPressureSolver::smooth(Level& level, int sweeps, bool reverse)
+{
+    // Red-black Gauss-Seidel: each colour only reads the other, so rows run in parallel
+    const int w = level.width;
+    const int h = level.height;
+    const FlipCellType* cells = level.cells.data();
+    for (int sweep = 0; sweep < sweeps * 2; ++sweep)
+    {
+        const int colour = (sweep & 1) ^ (reverse ? 1 : 0);
+        JobSystem::getInstance().parallelFor(0, h, 4, [&](int rowBegin, int rowEnd)
+        {
+            for (int j = rowBegin; j < rowEnd; ++j)
+            {
+                for (int i = (j + colour) & 1; i < w; i += 2)
+                {
+                    const int id = j * w + i;
+                    if (level.diag[id] == 0) continue;
+                    float sum = level.b[id];
+                    if (i > 0 && isFluid(cells, id - 1)) sum += level.x[id - 1];
+                    if (i < w - 1 && isFluid(cells, id + 1)) sum += level.x[id + 1];
+                    if (j > 0 && isFluid(cells, id - w)) sum += level.x[id - w];
+                    if (j < h - 1 && isFluid(cells, id + w)) sum += level.x[id + w];
+                    level.x[id] = sum / level.diag[id];
+                }
+            }
+        }, m_maxThreads);
+    }
+}
+
+void FlipPressureSolver::vCycle(int depth)
+{
+    Level& fine = m_levels[depth];
+    if (depth + 1 == static_cast<int>(m_levels.size()))
+    {
+        smooth(fine, CoarsestSweeps, false);
+        smooth(fine, CoarsestSweeps, true);
+        return;
+    }
+
+    smooth(fine, SmoothSweeps, false);
+    residual(fine);
+
+    // Restrict with half the child sum: the Galerkin operator of piecewise-constant
+    // prolongation is twice the coarse 5-point stencil
+    Level& coarse = m_levels[depth + 1];
+    JobSystem::getInstance().parallelFor(0, coarse.height, 4, [&](int rowBegin, int rowEnd)
+    {
+        for (int j = rowBegin; j < rowEnd; ++j)
+        {
+            for (int i = 0; i < coarse.width; ++i)
+            {
+                const int id = j * coarse.width + i;
+                coarse.x[id] = 0.0f;
+                if (coarse.diag[id] == 0) { coarse.b[id] = 0.0f; continue; }
+                float sum = 0.0f;
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int fi = 2 * i + (c & 1);
+                    const int fj = 2 * j + (c >> 1);
+                    if (fi < fine.width && fj < fine.height) sum += fine.r[fj * fine.width + fi];
+                }
+                coarse.b[id] = 0.5f * sum;
+            }
+        }
+    }, m_maxThreads);
+
+    vCycle(depth + 1);
+
+    JobSystem::getInstance().parallelFor(0, fine.height, 4, [&](int rowBegin, int rowEnd)
+    {
+        for (int j = rowBegin; j < rowEnd; ++j)
+        {
+            const float* parent = coarse.x.data() + (j / 2) * coarse.width;
+            for (int i = 0; i < fine.width; ++i)
+            {
+                const int id = j * fine.width + i;
+                if (fine.diag[id] != 0) fine.x[id] += parent[i / 2];
+            }
+        }
+    }, m_maxThreads);
+
+    smooth(fine, SmoothSweeps, true);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // Pressure cells: only Fluid cells are unknowns. Air cells hold p = 0 (free
+    // surface), Solid cells contribute no flux.
+    enum class FlipCellType : uint8_t
+    {
+        Air = 0,
+        Fluid,
+        Solid
+    };
+
+    enum class FlipPressureSolverType : uint8_t
+    {
+        Jacobi = 0,        // one sweep per iteration; the original solver
+        ConjugateGradient, // MIC(0)-preconditioned CG
+        Multigrid          // CG preconditioned by one geometric V-cycle (red-black Gauss-Seidel smoothing)
+    };
+
+    const char* getFlipPressureSolverName(FlipPressureSolverType type);
+
+    struct FlipPressureSettings
+    {
+        FlipPressureSolverType type = FlipPressureSolverType::ConjugateGradient;
+        float tolerance = 1e-4f; // stop once max |b - Ap| <= tolerance * max |b|
+        int maxIterations = 200; // Jacobi sweeps or CG iterations
+        int maxThreads = 1;
+    };
+
+    struct FlipPressureStats
+    {
+        int iterations = 0;
+        float residual = 0.0f; // max |b - Ap| / max |b| of the returned pressure
+        bool converged = false;
+    };
+
+    // Poisson solve for the FLIP projection on a width x height cell grid. Each
+    // Fluid cell satisfies
+    //     n * p - sum(p of Fluid neighbors) = -divergence * cellSize^2
+    // where n counts the neighbors that are not Solid (outside the grid is Solid),
+    // matching the 5-point stencil the scene's Jacobi sweep used. pressure is both
+    // the warm start and the result; non-Fluid cells come back as 0. Reductions are
+    // summed per row in row order, so results do not depend on the thread count.
+    class FlipPressureSolver
+    {
+    public:
+        FlipPressureStats solve(int width, int height, const FlipCellType* cells, const float* divergence,
+            float cellSize, float* pressure, const FlipPressureSettings& settings);
+
+    private:
+        struct Level
+        {
+            int width = 0;
+            int height = 0;
+            std::vector<FlipCellType> cells;
+            std::vector<uint8_t> diag; // non-Solid neighbors of Fluid cells, 0 elsewhere
+            std::vector<float> x;
+            std::vector<float> b;
+            std::vector<float> r;
+        };
+
+        void setupLevel(Level& level);
+        void buildLevels();
+        float residual(Level& level); // level.r = b - Ax, returns max |r|
+
+        FlipPressureStats solveJacobi(float bMax, const FlipPressureSettings& settings);
+        FlipPressureStats solveConjugateGradient(float bMax, const FlipPressureSettings& settings, bool multigrid);
+
+        void buildMic0(const Level& level);
+        void applyMic0(const Level& level, const float* r, float* z);
+        void smooth(Level& level, int sweeps, bool reverse);
+        void vCycle(int depth);
+
+        template<typename RowFn>
+        double sumRows(int height, RowFn&& rowFn);
+        template<typename RowFn>
+        double maxRows(int height, RowFn&& rowFn);
+
+        int m_maxThreads = 1;
+        Level m_top;                 // the problem: x is the pressure, r the residual
+        std::vector<Level> m_levels; // multigrid hierarchy, [0] mirrors m_top
+        std::vector<float> m_precon;
+        std::vector<float> m_z;
+        std::vector<float> m_s;
+        std::vector<float> m_q;
+        std::vector<double> m_rowPartials;
+    };
+}
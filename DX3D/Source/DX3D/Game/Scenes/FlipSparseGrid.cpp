@@ -0,0 +1,242 @@
+#include <DX3D/Game/Scenes/FlipSparseGrid.h>
+#include <algorithm>
+#include <climits>
+
+using namespace dx3d;
+
+void FlipSparseGrid::resize(float originX, float originY, float cellSize, int width, int height)
+{
+    m_originX = originX;
+    m_originY = originY;
+    m_cellSize = cellSize;
+    if (width == m_width && height == m_height)
+        return;
+
+    m_width = width;
+    m_height = height;
+    // u faces reach i = width, Gather bins i = width + 1; likewise for rows
+    m_tilesX = ((width + 1) >> TileShift) + 1;
+    m_tilesY = ((height + 1) >> TileShift) + 1;
+    m_tileSlots.assign(static_cast<std::size_t>(m_tilesX) * m_tilesY, -1);
+    m_tileMark.assign(m_tileSlots.size(), 0);
+    m_slotTiles.clear();
+    m_pressure.clear();
+}
+
+void FlipSparseGrid::allocate(int margin, int maxThreads)
+{
+    // Tiles holding particles (mark 1), then their neighbors within margin (mark 2)
+    m_newTiles.clear();
+    for (int cell : m_particleCell)
+    {
+        if (cell < 0) continue;
+        const int tile = ((cell / m_width) >> TileShift) * m_tilesX + ((cell % m_width) >> TileShift);
+        if (m_tileMark[tile]) continue;
+        m_tileMark[tile] = 1;
+        m_newTiles.push_back(tile);
+    }
+    const std::size_t occupied = m_newTiles.size();
+    for (std::size_t k = 0; k < occupied; ++k)
+    {
+        const int tileX = m_newTiles[k] % m_tilesX;
+        const int tileY = m_newTiles[k] / m_tilesX;
+        for (int y = std::max(0, tileY - margin); y <= std::min(m_tilesY - 1, tileY + margin); ++y)
+        {
+            for (int x = std::max(0, tileX - margin); x <= std::min(m_tilesX - 1, tileX + margin); ++x)
+            {
+                const int tile = y * m_tilesX + x;
+                if (m_tileMark[tile]) continue;
+                m_tileMark[tile] = 2;
+                m_newTiles.push_back(tile);
+            }
+        }
+    }
+    std::sort(m_newTiles.begin(), m_newTiles.end());
+    for (int tile : m_newTiles) m_tileMark[tile] = 0;
+
+    // Carry the pressure of tiles that stay, then switch the map over to the new slots
+    const int slots = static_cast<int>(m_newTiles.size());
+    m_scratch.resize(static_cast<std::size_t>(slots) * TileCells);
+    JobSystem::getInstance().parallelFor(0, slots, 16, [&](int slotBegin, int slotEnd)
+    {
+        for (int slot = slotBegin; slot < slotEnd; ++slot)
+        {
+            const int oldSlot = m_tileSlots[m_newTiles[slot]];
+            float* dst = m_scratch.data() + static_cast<std::size_t>(slot) * TileCells;
+            if (oldSlot >= 0)
+                std::copy(m_pressure.begin() + static_cast<std::size_t>(oldSlot) * TileCells, m_pressure.begin() + static_cast<std::size_t>(oldSlot + 1) * TileCells, dst);
+            else
+                std::fill(dst, dst + TileCells, 0.0f);
+        }
+    }, maxThreads);
+    m_pressure.swap(m_scratch);
+    for (int tile : m_slotTiles) m_tileSlots[tile] = -1;
+    m_slotTiles.swap(m_newTiles);
+    for (int slot = 0; slot < slots; ++slot) m_tileSlots[m_slotTiles[slot]] = slot;
+
+    const std::size_t size = static_cast<std::size_t>(slots) * TileCells;
+    for (auto* field : { &m_u, &m_uWeight, &m_v, &m_vWeight, &m_divergence }) field->resize(size);
+    m_cellTypes.resize(size);
+    m_particleCount.resize(size);
+    JobSystem::getInstance().parallelFor(0, slots, 16, [&](int slotBegin, int slotEnd)
+    {
+        const std::size_t begin = static_cast<std::size_t>(slotBegin) * TileCells;
+        const std::size_t end = static_cast<std::size_t>(slotEnd) * TileCells;
+        for (auto* field : { &m_u, &m_uWeight, &m_v, &m_vWeight, &m_divergence })
+            std::fill(field->begin() + begin, field->begin() + end, 0.0f);
+        std::fill(m_cellTypes.begin() + begin, m_cellTypes.begin() + end, FlipCellType::Air);
+        std::fill(m_particleCount.begin() + begin, m_particleCount.begin() + end, 0);
+    }, maxThreads);
+
+    for (int cell : m_particleCell)
+        if (cell >= 0) ++m_particleCount[index(cell % m_width, cell / m_width)];
+}
+
+FlipFaceGrid FlipSparseGrid::getFaceGrid()
+{
+    FlipFaceGrid faces;
+    faces.originX = m_originX;
+    faces.originY = m_originY;
+    faces.cellSize = m_cellSize;
+    faces.width = m_width;
+    faces.height = m_height;
+    faces.u = m_u.data();
+    faces.uWeight = m_uWeight.data();
+    faces.v = m_v.data();
+    faces.vWeight = m_vWeight.data();
+    faces.tileSlots = m_tileSlots.data();
+    faces.slotTiles = m_slotTiles.data();
+    faces.tilesX = m_tilesX;
+    faces.slotCount = getTileCount();
+    return faces;
+}
+
+FlipPressureStats FlipSparseGrid::solvePressure(FlipPressureSolver& solver, const FlipPressureSettings& settings)
+{
+    const int slots = getTileCount();
+    const int maxThreads = std::max(1, settings.maxThreads);
+
+    // Bounds of the Fluid cells of every tile (maxX < 0 without any)
+    m_slotBounds.resize(static_cast<std::size_t>(slots) * 4);
+    JobSystem::getInstance().parallelFor(0, slots, 16, [&](int slotBegin, int slotEnd)
+    {
+        for (int slot = slotBegin; slot < slotEnd; ++slot)
+        {
+            int minX = INT_MAX, minY = INT_MAX, maxX = -1, maxY = -1;
+            for (int local = 0; local < TileCells; ++local)
+            {
+                if (m_cellTypes[static_cast<std::size_t>(slot) * TileCells + local] != FlipCellType::Fluid) continue;
+                const int i = getTileX(slot) * TileSize + (local & (TileSize - 1));
+                const int j = getTileY(slot) * TileSize + (local >> TileShift);
+                minX = std::min(minX, i);
+                minY = std::min(minY, j);
+                maxX = std::max(maxX, i);
+                maxY = std::max(maxY, j);
+            }
+            int* bounds = &m_slotBounds[static_cast<std::size_t>(slot) * 4];
+            bounds[0] = minX; bounds[1] = minY; bounds[2] = maxX; bounds[3] = maxY;
+        }
+    }, maxThreads);
+    auto hasFluid = [&](int slot) { return m_slotBounds[static_cast<std::size_t>(slot) * 4 + 2] >= 0; };
+
+    // Flood fill the regions in ascending slot order, using m_regionSlots as the queue
+    m_slotRegion.assign(slots, -1);
+    m_regionSlots.clear();
+    m_regionStart.clear();
+    for (int seed = 0; seed < slots; ++seed)
+    {
+        if (!hasFluid(seed) || m_slotRegion[seed] >= 0) continue;
+        const int region = static_cast<int>(m_regionStart.size());
+        m_regionStart.push_back(static_cast<int>(m_regionSlots.size()));
+        m_slotRegion[seed] = region;
+        m_regionSlots.push_back(seed);
+        for (std::size_t k = m_regionStart.back(); k < m_regionSlots.size(); ++k)
+        {
+            const int tileX = getTileX(m_regionSlots[k]);
+            const int tileY = getTileY(m_regionSlots[k]);
+            const int neighbors[4][2] = { { tileX - 1, tileY }, { tileX + 1, tileY }, { tileX, tileY - 1 }, { tileX, tileY + 1 } };
+            for (const auto& n : neighbors)
+            {
+                if (n[0] < 0 || n[1] < 0 || n[0] >= m_tilesX || n[1] >= m_tilesY) continue;
+                const int slot = m_tileSlots[n[1] * m_tilesX + n[0]];
+                if (slot < 0 || !hasFluid(slot) || m_slotRegion[slot] >= 0) continue;
+                m_slotRegion[slot] = region;
+                m_regionSlots.push_back(slot);
+            }
+        }
+    }
+    const int regions = static_cast<int>(m_regionStart.size());
+    m_regionStart.push_back(static_cast<int>(m_regionSlots.size()));
+
+    FlipPressureStats stats;
+    stats.converged = true;
+    for (int region = 0; region < regions; ++region)
+    {
+        // Bounds of the region's Fluid cells, one cell wider so every neighbor of one is inside
+        int minX = INT_MAX, minY = INT_MAX, maxX = -1, maxY = -1;
+        for (int k = m_regionStart[region]; k < m_regionStart[region + 1]; ++k)
+        {
+            const int* bounds = &m_slotBounds[static_cast<std::size_t>(m_regionSlots[k]) * 4];
+            minX = std::min(minX, bounds[0]);
+            minY = std::min(minY, bounds[1]);
+            maxX = std::max(maxX, bounds[2]);
+            maxY = std::max(maxY, bounds[3]);
+        }
+        minX = std::max(0, minX - 1);
+        minY = std::max(0, minY - 1);
+        maxX = std::min(m_width - 1, maxX + 1);
+        maxY = std::min(m_height - 1, maxY + 1);
+
+        const int windowWidth = maxX - minX + 1;
+        const int windowHeight = maxY - minY + 1;
+        const std::size_t windowSize = static_cast<std::size_t>(windowWidth) * windowHeight;
+        m_windowCells.resize(windowSize);
+        m_windowDivergence.resize(windowSize);
+        m_windowPressure.resize(windowSize);
+        JobSystem::getInstance().parallelFor(0, windowHeight, 8, [&](int rowBegin, int rowEnd)
+        {
+            for (int y = rowBegin; y < rowEnd; ++y)
+            {
+                for (int x = 0; x < windowWidth; ++x)
+                {
+                    const std::size_t w = static_cast<std::size_t>(y) * windowWidth + x;
+                    const int idx = index(minX + x, minY + y);
+                    const bool outside = idx < 0 || (m_cellTypes[idx] == FlipCellType::Fluid && m_slotRegion[idx / TileCells] != region);
+                    m_windowCells[w] = outside ? FlipCellType::Air : m_cellTypes[idx];
+                    m_windowDivergence[w] = outside ? 0.0f : m_divergence[idx];
+                    m_windowPressure[w] = outside ? 0.0f : m_pressure[idx];
+                }
+            }
+        }, maxThreads);
+
+        const FlipPressureStats regionStats = solver.solve(windowWidth, windowHeight, m_windowCells.data(), m_windowDivergence.data(),
+            m_cellSize, m_windowPressure.data(), settings);
+        stats.iterations = std::max(stats.iterations, regionStats.iterations);
+        stats.residual = std::max(stats.residual, regionStats.residual);
+        stats.converged = stats.converged && regionStats.converged;
+
+        JobSystem::getInstance().parallelFor(m_regionStart[region], m_regionStart[region + 1], 16, [&](int begin, int end)
+        {
+            for (int k = begin; k < end; ++k)
+            {
+                const int slot = m_regionSlots[k];
+                for (int local = 0; local < TileCells; ++local)
+                {
+                    const int x = getTileX(slot) * TileSize + (local & (TileSize - 1)) - minX;
+                    const int y = getTileY(slot) * TileSize + (local >> TileShift) - minY;
+                    const bool inside = x >= 0 && y >= 0 && x < windowWidth && y < windowHeight;
+                    m_pressure[static_cast<std::size_t>(slot) * TileCells + local] = inside ? m_windowPressure[static_cast<std::size_t>(y) * windowWidth + x] : 0.0f;
+                }
+            }
+        }, maxThreads);
+    }
+
+    // Tiles without Fluid cells belong to no region
+    JobSystem::getInstance().parallelFor(0, slots, 16, [&](int slotBegin, int slotEnd)
+    {
+        for (int slot = slotBegin; slot < slotEnd; ++slot)
+            if (m_slotRegion[slot] < 0)
+                std::fill(m_pressure.begin() + static_cast<std::size_t>(slot) * TileCells, m_pressure.begin() + static_cast<std::size_t>(slot + 1) * TileCells, 0.0f);
+    }, maxThreads);
+    return stats;
+}
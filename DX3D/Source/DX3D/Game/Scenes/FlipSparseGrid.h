@@ -0,0 +1,124 @@
+#pragma once
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleTransfer.h>
+#include <DX3D/Game/Scenes/FlipPressureSolver.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // MAC grid stored as 8x8-cell tiles that are allocated around the particles every
+    // step, so memory and per-step work follow the fluid instead of the domain. A tile
+    // holds its cells' pressure, divergence, type and particle count, the u faces on
+    // their left and the v faces below them: cell and faces (i, j) share one index.
+    // The tile map has an extra column and row for the faces on the far boundary (and
+    // the transfer's Gather bins one further out). Slots are kept in ascending tile
+    // order, so passes over them visit the grid in the same order every step.
+    class FlipSparseGrid
+    {
+    public:
+        static constexpr int TileShift = 3;
+        static constexpr int TileSize = 1 << TileShift;
+        static constexpr int TileCells = TileSize * TileSize;
+
+        // width x height cells of cellSize from (originX, originY); drops every tile if the shape changes
+        void resize(float originX, float originY, float cellSize, int width, int height);
+
+        // Allocate the tiles holding particles plus margin tiles around them, keep the
+        // pressure of tiles that stay allocated, zero the rest of the data and count the
+        // particles per cell. particles[i].position.x / .y for i in [0, particles.size())
+        template<typename Particles>
+        void build(const Particles& particles, int margin = 1, int maxThreads = 1);
+
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+        float getCellSize() const { return m_cellSize; }
+        int getTileCount() const { return static_cast<int>(m_slotTiles.size()); }
+        int getTileX(int slot) const { return m_slotTiles[slot] % m_tilesX; }
+        int getTileY(int slot) const { return m_slotTiles[slot] / m_tilesX; }
+
+        // Index of cell / face (i, j) into the arrays below, or -1 if its tile is not allocated
+        int index(int i, int j) const
+        {
+            if (i < 0 || j < 0 || i >= m_tilesX * TileSize || j >= m_tilesY * TileSize) return -1;
+            const int slot = m_tileSlots[(j >> TileShift) * m_tilesX + (i >> TileShift)];
+            return slot < 0 ? -1 : slot * TileCells + ((j & (TileSize - 1)) << TileShift) + (i & (TileSize - 1));
+        }
+
+        // getTileCount() * TileCells entries each
+        float* getU() { return m_u.data(); }
+        float* getUWeight() { return m_uWeight.data(); }
+        float* getV() { return m_v.data(); }
+        float* getVWeight() { return m_vWeight.data(); }
+        float* getPressure() { return m_pressure.data(); }
+        float* getDivergence() { return m_divergence.data(); }
+        FlipCellType* getCellTypes() { return m_cellTypes.data(); }
+        const int* getParticleCounts() const { return m_particleCount.data(); }
+
+        // The tiled face arrays for FlipParticleTransfer
+        FlipFaceGrid getFaceGrid();
+
+        // Solve for the Fluid cells' pressure one region at a time: tiles holding Fluid cells
+        // joined through shared edges, each on the smallest window of cells holding its Fluid
+        // cells and their neighbors (unallocated cells and other regions' Fluid cells inside
+        // read as Air). The other cells get 0; the stats are the worst over the regions
+        FlipPressureStats solvePressure(FlipPressureSolver& solver, const FlipPressureSettings& settings);
+
+    private:
+        // Tiles and slots for the cells in m_particleCell, then clear the arrays
+        void allocate(int margin, int maxThreads);
+
+        float m_originX = 0.0f;
+        float m_originY = 0.0f;
+        float m_cellSize = 1.0f;
+        int m_width = 0;
+        int m_height = 0;
+        int m_tilesX = 0;
+        int m_tilesY = 0;
+        std::vector<int> m_tileSlots;      // slot of each tile, -1 if not allocated
+        std::vector<int> m_slotTiles;      // tile of each slot, ascending
+        std::vector<uint8_t> m_tileMark;   // build scratch, all 0 between builds
+        std::vector<int> m_newTiles;
+        std::vector<int> m_particleCell;   // cell of each particle, -1 outside the grid
+
+        std::vector<float> m_u;
+        std::vector<float> m_uWeight;
+        std::vector<float> m_v;
+        std::vector<float> m_vWeight;
+        std::vector<float> m_pressure;     // kept per tile as the solver's warm start
+        std::vector<float> m_divergence;
+        std::vector<FlipCellType> m_cellTypes;
+        std::vector<int> m_particleCount;
+        std::vector<float> m_scratch;      // pressure carried over while slots move
+
+        // Pressure regions. A Fluid cell's neighbors lie in its own tile or one sharing an
+        // edge with it, so separate regions have no stencil entries in common
+        std::vector<int> m_slotBounds;     // Fluid cell bounds of each slot: minX, minY, maxX, maxY
+        std::vector<int> m_slotRegion;     // region of each slot, -1 without Fluid cells
+        std::vector<int> m_regionSlots;    // slots grouped by region
+        std::vector<int> m_regionStart;    // regions + 1 offsets into m_regionSlots
+
+        // Dense pressure window of one region
+        std::vector<FlipCellType> m_windowCells;
+        std::vector<float> m_windowDivergence;
+        std::vector<float> m_windowPressure;
+    };
+
+    template<typename Particles>
+    void FlipSparseGrid::build(const Particles& particles, int margin, int maxThreads)
+    {
+        const int count = static_cast<int>(particles.size());
+        m_particleCell.resize(count);
+        JobSystem::getInstance().parallelFor(0, count, 2048, [&](int begin, int end)
+        {
+            for (int p = begin; p < end; ++p)
+            {
+                const int i = static_cast<int>(std::floor((particles[p].position.x - m_originX) / m_cellSize));
+                const int j = static_cast<int>(std::floor((particles[p].position.y - m_originY) / m_cellSize));
+                m_particleCell[p] = (i >= 0 && i < m_width && j >= 0 && j < m_height) ? j * m_width + i : -1;
+            }
+        }, maxThreads);
+        allocate(margin, maxThreads);
+    }
+}
@@ -9,6 +9,7 @@
 #include <imgui.h>
 #include <cmath>
 #include <chrono>
+#include <algorithm>
 
 using namespace dx3d;
 
@@ -167,8 +168,8 @@ void JellyTetrisReduxScene::spawnTetrimino(TetriminoReduxType type, Vec2 positio
     if (static_cast<int>(type) >= m_tetriminoTemplates.size()) return;
 
     const auto& data = m_tetriminoTemplates[static_cast<int>(type)];
-    std::string baseName = createTetriminoNodes(data, position, m_nextTetriminoId);
-    createTetriminoBeams(data, baseName, position, m_nextTetriminoId);
+    NodePositionMap nodePositions = createTetriminoNodes(data, position, m_nextTetriminoId);
+    createTetriminoBeams(data, nodePositions, position, m_nextTetriminoId);
 
     m_nextTetriminoId++;
     
@@ -176,12 +177,18 @@ void JellyTetrisReduxScene::spawnTetrimino(TetriminoReduxType type, Vec2 positio
     m_spatialGridDirty = true;
 }
 
-std::string JellyTetrisReduxScene::createTetriminoNodes(const JellyTetriminoData& data, Vec2 basePosition, int tetriminoId) {
-    std::string baseName = data.name + "_" + std::to_string(tetriminoId);
-    
+int JellyTetrisReduxScene::getTetriminoId(const Entity* entity) {
+    const auto* piece = entity ? entity->getComponent<TetriminoPieceComponent>() : nullptr;
+    return piece ? piece->tetriminoId : -1;
+}
+
+static std::string getPositionKey(const Vec2& position) {
+    return std::to_string(static_cast<int>(position.x)) + "," + std::to_string(static_cast<int>(position.y));
+}
+
+JellyTetrisReduxScene::NodePositionMap JellyTetrisReduxScene::createTetriminoNodes(const JellyTetriminoData& data, Vec2 basePosition, int tetriminoId) {
     // Use a string-based key for position mapping to avoid Vec2 comparison issues
-    std::map<std::string, std::string> nodePositions; // position string -> nodeName
-    int nodeIndex = 0;
+    NodePositionMap nodePositions;
 
     for (size_t squareIndex = 0; squareIndex < data.squarePieces.size(); ++squareIndex) {
         const SquarePiece& square = data.squarePieces[squareIndex];
@@ -191,73 +198,37 @@ std::string JellyTetrisReduxScene::createTetriminoNodes(const JellyTetriminoData
         for (size_t i = 0; i < square.getNodeOffsets().size(); ++i) {
             Vec2 nodePos = squareWorldPos + square.getNodeOffsets()[i];
             
-            // Create a string key for the position
-            std::string posKey = std::to_string(static_cast<int>(nodePos.x)) + "," + 
-                                std::to_string(static_cast<int>(nodePos.y));
-            
-            // Check if a node already exists at this position (from adjacent squares)
-            std::string nodeName;
-            if (nodePositions.find(posKey) != nodePositions.end()) {
-                // Node already exists, reuse it
-                nodeName = nodePositions[posKey];
-            } else {
-                // Create new node
-                nodeName = baseName + "_Node" + std::to_string(nodeIndex);
-                nodePositions[posKey] = nodeName;
-                nodeIndex++;
-
-                auto& nodeEntity = m_entityManager->createEntity(nodeName);
-                nodeEntity.addComponent<NodeComponent>(nodePos, false); // Non-fixed so they can fall
-
-                auto& sprite = nodeEntity.addComponent<SpriteComponent>(
-                    *m_graphicsDevice,
-                    L"DX3D/Assets/Textures/node.png",
-                    NODE_SIZE * 0.8f, NODE_SIZE * 0.8f  // Make nodes more visible
-                );
-                sprite.setPosition(nodePos.x, nodePos.y, 0.0f);
-                // Use a more visible color for nodes
-                Vec4 nodeColor = square.getColor();
-                nodeColor.w = 1.0f; // Make nodes fully opaque
-                sprite.setTint(nodeColor);
-            }
-        }
-    }
-
-    return baseName;
-}
+            // Reuse the node if an adjacent square already created one here
+            std::string posKey = getPositionKey(nodePos);
+            if (nodePositions.find(posKey) != nodePositions.end()) continue;
 
-void JellyTetrisReduxScene::createTetriminoBeams(const JellyTetriminoData& data, const std::string& baseName, Vec2 basePosition, int tetriminoId) {
-    int beamIndex = 0;
-    
-    // Create a map to track node positions and their corresponding entity names
-    std::map<std::string, std::string> nodePositions; // position string -> nodeName
-    Vec2 basePos = basePosition;
-    
-    // First, collect all node positions and their names
-    int nodeIndex = 0;
-    for (size_t squareIndex = 0; squareIndex < data.squarePieces.size(); ++squareIndex) {
-        const SquarePiece& square = data.squarePieces[squareIndex];
-        Vec2 squareWorldPos = basePos + square.getCenterPosition();
+            // Unnamed: per-spawn names would grow the NameTable forever
+            auto& nodeEntity = m_entityManager->createEntity();
+            nodePositions[posKey] = &nodeEntity;
+            nodeEntity.addComponent<TetriminoPieceComponent>(tetriminoId, data.name);
+            nodeEntity.addComponent<NodeComponent>(nodePos, false); // Non-fixed so they can fall
 
-        for (size_t i = 0; i < square.getNodeOffsets().size(); ++i) {
-            Vec2 nodePos = squareWorldPos + square.getNodeOffsets()[i];
-            
-            // Create string key for position
-            std::string posKey = std::to_string(static_cast<int>(nodePos.x)) + "," + 
-                                std::to_string(static_cast<int>(nodePos.y));
-            
-            if (nodePositions.find(posKey) == nodePositions.end()) {
-                std::string nodeName = baseName + "_Node" + std::to_string(nodeIndex);
-                nodePositions[posKey] = nodeName;
-                nodeIndex++;
-            }
+            auto& sprite = nodeEntity.addComponent<SpriteComponent>(
+                *m_graphicsDevice,
+                L"DX3D/Assets/Textures/node.png",
+                NODE_SIZE * 0.8f, NODE_SIZE * 0.8f  // Make nodes more visible
+            );
+            sprite.setPosition(nodePos.x, nodePos.y, 0.0f);
+            // Use a more visible color for nodes
+            Vec4 nodeColor = square.getColor();
+            nodeColor.w = 1.0f; // Make nodes fully opaque
+            sprite.setTint(nodeColor);
         }
     }
 
-    // Now create beams for each square piece
+    return nodePositions;
+}
+
+void JellyTetrisReduxScene::createTetriminoBeams(const JellyTetriminoData& data, const NodePositionMap& nodePositions, Vec2 basePosition, int tetriminoId) {
+    // Create beams for each square piece
     for (size_t squareIndex = 0; squareIndex < data.squarePieces.size(); ++squareIndex) {
         const SquarePiece& square = data.squarePieces[squareIndex];
-        Vec2 squareWorldPos = basePos + square.getCenterPosition();
+        Vec2 squareWorldPos = basePosition + square.getCenterPosition();
         
         for (size_t i = 0; i < square.getBeamConnections().size(); ++i) {
             int node1Idx = square.getBeamConnections()[i].first;
@@ -267,24 +238,14 @@ void JellyTetrisReduxScene::createTetriminoBeams(const JellyTetriminoData& data,
             Vec2 node1Pos = squareWorldPos + square.getNodeOffsets()[node1Idx];
             Vec2 node2Pos = squareWorldPos + square.getNodeOffsets()[node2Idx];
 
-            // Create string keys for positions
-            std::string pos1Key = std::to_string(static_cast<int>(node1Pos.x)) + "," + 
-                                 std::to_string(static_cast<int>(node1Pos.y));
-            std::string pos2Key = std::to_string(static_cast<int>(node2Pos.x)) + "," + 
-                                 std::to_string(static_cast<int>(node2Pos.y));
-
-            // Find the corresponding entity names
-            std::string node1Name = nodePositions[pos1Key];
-            std::string node2Name = nodePositions[pos2Key];
-            std::string beamName = baseName + "_Beam" + std::to_string(beamIndex);
+            // Find the corresponding node entities
+            auto node1It = nodePositions.find(getPositionKey(node1Pos));
+            auto node2It = nodePositions.find(getPositionKey(node2Pos));
+            if (node1It == nodePositions.end() || node2It == nodePositions.end()) continue;
 
-            auto* node1Entity = m_entityManager->findEntity(node1Name);
-            auto* node2Entity = m_entityManager->findEntity(node2Name);
-
-            if (!node1Entity || !node2Entity) continue;
-
-            auto& beamEntity = m_entityManager->createEntity(beamName);
-            auto& beamComponent = beamEntity.addComponent<BeamComponent>(node1Entity, node2Entity);
+            auto& beamEntity = m_entityManager->createEntity();
+            beamEntity.addComponent<TetriminoPieceComponent>(tetriminoId, data.name);
+            auto& beamComponent = beamEntity.addComponent<BeamComponent>(node1It->second, node2It->second);
 
             auto& sprite = beamEntity.addComponent<SpriteComponent>(
                 *m_graphicsDevice,
@@ -298,7 +259,6 @@ void JellyTetrisReduxScene::createTetriminoBeams(const JellyTetriminoData& data,
             Vec4 beamColor = square.getColor();
             beamColor.w = 0.8f; // Make beams more opaque
             sprite.setTint(beamColor);
-            beamIndex++;
         }
     }
 }
@@ -510,8 +470,11 @@ void JellyTetrisReduxScene::renderImGui(GraphicsEngine& engine)
         // Status
         if (ImGui::CollapsingHeader("Status", ImGuiTreeNodeFlags_DefaultOpen))
         {
-            if (m_isDraggingNode) {
-                ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Dragging Node: %s", m_draggedNode ? m_draggedNode->getName().c_str() : "Unknown");
+            const auto* draggedPiece = m_draggedNode.get() ? m_draggedNode->getComponent<TetriminoPieceComponent>() : nullptr;
+            if (m_isDraggingNode && draggedPiece) {
+                ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Dragging Node: %s_%d", draggedPiece->typeName.c_str(), draggedPiece->tetriminoId);
+            } else if (m_isDraggingNode) {
+                ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Dragging Node: Unknown");
             } else {
                 ImGui::Text("No node being dragged");
             }
@@ -636,20 +599,13 @@ void JellyTetrisReduxScene::spawnTestTetramino(TetriminoReduxType type) {
 
 void JellyTetrisReduxScene::clearTestTetraminos() {
     // Clear all tetramino entities
-    const auto& allEntities = m_entityManager->getEntities();
-    std::vector<std::string> entitiesToRemove;
-    
-    for (const auto& entityPtr : allEntities) {
-        Entity* entity = entityPtr.get();
-        std::string name = entity->getName();
-        if (name.find("_Node") != std::string::npos || 
-            name.find("_Beam") != std::string::npos) {
-            entitiesToRemove.push_back(name);
-        }
+    std::vector<EntityHandle> entitiesToRemove;
+    for (auto* entity : m_entityManager->getEntitiesWithComponent<TetriminoPieceComponent>()) {
+        entitiesToRemove.push_back(entity->getHandle());
     }
     
-    for (const std::string& name : entitiesToRemove) {
-        m_entityManager->removeEntity(name);
+    for (EntityHandle entity : entitiesToRemove) {
+        m_entityManager->destroyEntity(entity);
     }
     
     // Reset tetrimino ID counter
@@ -710,23 +666,19 @@ void JellyTetrisReduxScene::updateCameraMovement(float dt) {
 
 void JellyTetrisReduxScene::renderTetraminoVisualOverlays(DeviceContext& ctx) {
     // Group nodes by tetramino and render visual overlays
-    std::map<std::string, std::vector<Entity*>> tetraminoNodes;
+    std::map<int, std::vector<Entity*>> tetraminoNodes;
     
-    // Group nodes by tetramino prefix
+    // Group nodes by tetramino
     auto nodeEntities = m_entityManager->getEntitiesWithComponent<NodeComponent>();
     for (auto* nodeEntity : nodeEntities) {
-        std::string nodeName = nodeEntity->getName();
-        
-        // Extract tetramino prefix (e.g., "I_0" from "I_0_Node0")
-        size_t lastUnderscore = nodeName.find_last_of('_');
-        if (lastUnderscore != std::string::npos) {
-            std::string prefix = nodeName.substr(0, lastUnderscore);
-            tetraminoNodes[prefix].push_back(nodeEntity);
+        int tetraminoId = getTetriminoId(nodeEntity);
+        if (tetraminoId >= 0) {
+            tetraminoNodes[tetraminoId].push_back(nodeEntity);
         }
     }
     
     // Render visual overlay for each tetramino
-    for (const auto& [prefix, nodes] : tetraminoNodes) {
+    for (const auto& [tetraminoId, nodes] : tetraminoNodes) {
         if (nodes.empty()) continue;
         
         // Get the first node's color to determine tetramino color
@@ -784,8 +736,11 @@ void JellyTetrisReduxScene::checkBoundaryCollisions() {
         if (!beam) continue;
 
         // Get beam endpoints
-        auto* node1 = beam->getNode1Entity()->getComponent<NodeComponent>();
-        auto* node2 = beam->getNode2Entity()->getComponent<NodeComponent>();
+        auto* node1Entity = beam->getNode1Entity();
+        auto* node2Entity = beam->getNode2Entity();
+        if (!node1Entity || !node2Entity) continue;
+        auto* node1 = node1Entity->getComponent<NodeComponent>();
+        auto* node2 = node2Entity->getComponent<NodeComponent>();
         if (!node1 || !node2) continue;
         
         // Skip if both nodes are fixed
@@ -881,41 +836,15 @@ void JellyTetrisReduxScene::handleTetraminoInput() {
     
     // First pass: find the highest tetramino ID
     for (auto* nodeEntity : nodeEntities) {
-        std::string nodeName = nodeEntity->getName();
-        
-        // Extract tetramino ID from node name (e.g., "I_5_Node0" -> ID 5)
-        size_t firstUnderscore = nodeName.find('_');
-        if (firstUnderscore != std::string::npos) {
-            size_t secondUnderscore = nodeName.find('_', firstUnderscore + 1);
-            if (secondUnderscore != std::string::npos) {
-                std::string idStr = nodeName.substr(firstUnderscore + 1, secondUnderscore - firstUnderscore - 1);
-                int tetraminoId = std::stoi(idStr);
-                
-                if (tetraminoId > highestId) {
-                    highestId = tetraminoId;
-                }
-            }
-        }
+        highestId = std::max(highestId, getTetriminoId(nodeEntity));
     }
     
     if (highestId == -1) return;
     
     // Second pass: collect all nodes with the highest ID
     for (auto* nodeEntity : nodeEntities) {
-        std::string nodeName = nodeEntity->getName();
-        
-        // Extract tetramino ID from node name
-        size_t firstUnderscore = nodeName.find('_');
-        if (firstUnderscore != std::string::npos) {
-            size_t secondUnderscore = nodeName.find('_', firstUnderscore + 1);
-            if (secondUnderscore != std::string::npos) {
-                std::string idStr = nodeName.substr(firstUnderscore + 1, secondUnderscore - firstUnderscore - 1);
-                int tetraminoId = std::stoi(idStr);
-                
-                if (tetraminoId == highestId) {
-                    tetraminoNodes.push_back(nodeEntity);
-                }
-            }
+        if (getTetriminoId(nodeEntity) == highestId) {
+            tetraminoNodes.push_back(nodeEntity);
         }
     }
     
@@ -997,21 +926,10 @@ Entity* JellyTetrisReduxScene::getMostRecentTetramino() {
     auto nodeEntities = m_entityManager->getEntitiesWithComponent<NodeComponent>();
     
     for (auto* nodeEntity : nodeEntities) {
-        std::string nodeName = nodeEntity->getName();
-        
-        // Extract tetramino ID from node name (e.g., "I_5_Node0" -> ID 5)
-        size_t firstUnderscore = nodeName.find('_');
-        if (firstUnderscore != std::string::npos) {
-            size_t secondUnderscore = nodeName.find('_', firstUnderscore + 1);
-            if (secondUnderscore != std::string::npos) {
-                std::string idStr = nodeName.substr(firstUnderscore + 1, secondUnderscore - firstUnderscore - 1);
-                int tetraminoId = std::stoi(idStr);
-                
-                if (tetraminoId > highestId) {
-                    highestId = tetraminoId;
-                    mostRecent = nodeEntity;
-                }
-            }
+        int tetraminoId = getTetriminoId(nodeEntity);
+        if (tetraminoId > highestId) {
+            highestId = tetraminoId;
+            mostRecent = nodeEntity;
         }
     }
     
@@ -1038,28 +956,8 @@ void JellyTetrisReduxScene::checkNodeCollisions() {
             if (node1->isPositionFixed() && node2->isPositionFixed()) continue;
             
             // Check if nodes are from the same tetramino (don't collide with themselves)
-            std::string name1 = node1Entity->getName();
-            std::string name2 = node2Entity->getName();
-            
-            // Quick check: if names are identical, skip
-            if (name1 == name2) continue;
-            
-            // Extract tetramino ID for faster comparison
-            // Format: "I_0_Node0" -> tetramino ID is between first and second underscore
-            size_t firstUnderscore1 = name1.find('_');
-            size_t firstUnderscore2 = name2.find('_');
-            size_t secondUnderscore1 = name1.find('_', firstUnderscore1 + 1);
-            size_t secondUnderscore2 = name2.find('_', firstUnderscore2 + 1);
-            
-            if (firstUnderscore1 != std::string::npos && secondUnderscore1 != std::string::npos &&
-                firstUnderscore2 != std::string::npos && secondUnderscore2 != std::string::npos) {
-                
-                std::string tetraminoId1 = name1.substr(firstUnderscore1 + 1, secondUnderscore1 - firstUnderscore1 - 1);
-                std::string tetraminoId2 = name2.substr(firstUnderscore2 + 1, secondUnderscore2 - firstUnderscore2 - 1);
-                
-                // Skip collision if same tetramino
-                if (tetraminoId1 == tetraminoId2) continue;
-            }
+            int tetraminoId1 = getTetriminoId(node1Entity);
+            if (tetraminoId1 >= 0 && tetraminoId1 == getTetriminoId(node2Entity)) continue;
             
             // Check for collision
             Vec2 pos1 = node1->getPosition();
@@ -1177,21 +1075,9 @@ void JellyTetrisReduxScene::checkNodeBeamCollisions() {
             
             if (!node1a || !node1b || !node2a || !node2b) continue;
             
-            // Skip if both beams are from the same tetramino (check by name prefix)
-            std::string beam1Name = beam1Entity->getName();
-            std::string beam2Name = beam2Entity->getName();
-            
-            // Extract tetramino prefix (e.g., "I_0" from "I_0_Beam0")
-            size_t lastUnderscore1 = beam1Name.find_last_of('_');
-            size_t lastUnderscore2 = beam2Name.find_last_of('_');
-            
-            if (lastUnderscore1 != std::string::npos && lastUnderscore2 != std::string::npos) {
-                std::string prefix1 = beam1Name.substr(0, lastUnderscore1);
-                std::string prefix2 = beam2Name.substr(0, lastUnderscore2);
-                
-                // Skip collision if they're from the same tetramino
-                if (prefix1 == prefix2) continue;
-            }
+            // Skip if both beams are from the same tetramino
+            int tetraminoId1 = getTetriminoId(beam1Entity);
+            if (tetraminoId1 >= 0 && tetraminoId1 == getTetriminoId(beam2Entity)) continue;
             
             Vec2 beam1Start = node1a->getPosition();
             Vec2 beam1End = node1b->getPosition();
@@ -1325,8 +1211,11 @@ float JellyTetrisReduxScene::distanceLineSegmentToLineSegment(const Vec2& line1S
 
 void JellyTetrisReduxScene::resolveNodeBeamCollision(NodeComponent& node, BeamComponent& beam) {
     // Get beam endpoints
-    auto* node1 = beam.getNode1Entity()->getComponent<NodeComponent>();
-    auto* node2 = beam.getNode2Entity()->getComponent<NodeComponent>();
+    auto* node1Entity = beam.getNode1Entity();
+    auto* node2Entity = beam.getNode2Entity();
+    if (!node1Entity || !node2Entity) return;
+    auto* node1 = node1Entity->getComponent<NodeComponent>();
+    auto* node2 = node2Entity->getComponent<NodeComponent>();
     if (!node1 || !node2) return;
     
     Vec2 nodePos = node.getPosition();
@@ -1582,7 +1471,8 @@ void JellyTetrisReduxScene::updateNodeDragging() {
     }
     
     // Update dragging with spring-damper force towards mouse
-    if (m_isDraggingNode && m_cachedDraggedNode) {
+    // The cached components are only valid while the node is alive
+    if (m_isDraggingNode && m_draggedNode && m_cachedDraggedNode) {
         Vec2 targetPos = worldMousePos + m_dragOffset;
         Vec2 currentPos = m_cachedDraggedNode->getPosition();
         Vec2 toTarget = targetPos - currentPos;
@@ -1609,14 +1499,14 @@ void JellyTetrisReduxScene::updateNodeDragging() {
     
     // Stop dragging
     if (mouseReleased) {
-        if (m_isDraggingNode && m_cachedDraggedSprite) {
+        if (m_isDraggingNode && m_draggedNode && m_cachedDraggedSprite) {
             // Reset Z position to normal depth
             Vec3 pos = m_cachedDraggedSprite->getPosition();
             m_cachedDraggedSprite->setPosition(pos.x, pos.y, 0.0f); // Reset to normal Z
         }
         
         m_isDraggingNode = false;
-        m_draggedNode = nullptr;
+        m_draggedNode = EntityRef();
         m_cachedDraggedNode = nullptr;
         m_cachedDraggedSprite = nullptr;
     }
@@ -1641,8 +1531,11 @@ void JellyTetrisReduxScene::updateSpatialGrid() {
         auto* beam = beamEntity->getComponent<BeamComponent>();
         if (!beam) continue;
         
-        auto* node1 = beam->getNode1Entity()->getComponent<NodeComponent>();
-        auto* node2 = beam->getNode2Entity()->getComponent<NodeComponent>();
+        auto* node1Entity = beam->getNode1Entity();
+        auto* node2Entity = beam->getNode2Entity();
+        if (!node1Entity || !node2Entity) continue;
+        auto* node1 = node1Entity->getComponent<NodeComponent>();
+        auto* node2 = node2Entity->getComponent<NodeComponent>();
         if (!node1 || !node2) continue;
         
         Vec2 pos1 = node1->getPosition();
@@ -1708,29 +1601,9 @@ void JellyTetrisReduxScene::checkCollisionsInCell(const std::string& cellKey) {
             
             if (!beam1 || !beam2) continue;
             
-            // Skip if beams are from same tetramino (optimized check)
-            std::string beam1Name = beam1Entity->getName();
-            std::string beam2Name = beam2Entity->getName();
-            
-            // Quick check: if names are identical, skip
-            if (beam1Name == beam2Name) continue;
-            
-            // Extract tetramino ID from beam names for faster comparison
-            // Format: "I_0_Beam0" -> tetramino ID is between first and second underscore
-            size_t firstUnderscore1 = beam1Name.find('_');
-            size_t firstUnderscore2 = beam2Name.find('_');
-            size_t secondUnderscore1 = beam1Name.find('_', firstUnderscore1 + 1);
-            size_t secondUnderscore2 = beam2Name.find('_', firstUnderscore2 + 1);
-            
-            if (firstUnderscore1 != std::string::npos && secondUnderscore1 != std::string::npos &&
-                firstUnderscore2 != std::string::npos && secondUnderscore2 != std::string::npos) {
-                
-                std::string tetraminoId1 = beam1Name.substr(firstUnderscore1 + 1, secondUnderscore1 - firstUnderscore1 - 1);
-                std::string tetraminoId2 = beam2Name.substr(firstUnderscore2 + 1, secondUnderscore2 - firstUnderscore2 - 1);
-                
-                // Skip collision if same tetramino
-                if (tetraminoId1 == tetraminoId2) continue;
-            }
+            // Skip if beams are from same tetramino
+            int tetraminoId1 = getTetriminoId(beam1Entity);
+            if (tetraminoId1 >= 0 && tetraminoId1 == getTetriminoId(beam2Entity)) continue;
             
             // Get beam endpoints
             auto* node1aEntity = beam1->getNode1Entity();
@@ -60,6 +60,13 @@ namespace dx3d
         std::string name;
     };
 
+    // Which spawned tetrimino a node or beam belongs to. Pieces are told apart by this
+    // id rather than by entity name, so spawning never adds names to the NameTable.
+    struct TetriminoPieceComponent {
+        int tetriminoId = 0;
+        std::string typeName; // template name, for display
+    };
+
     class JellyTetrisReduxScene : public Scene {
     public:
         void load(GraphicsEngine& engine) override;
@@ -88,8 +95,12 @@ namespace dx3d
         // Tetrimino management
         void initializeTetriminoTemplates();
         void spawnTetrimino(TetriminoReduxType type, Vec2 position);
-        std::string createTetriminoNodes(const JellyTetriminoData& data, Vec2 basePosition, int tetriminoId);
-        void createTetriminoBeams(const JellyTetriminoData& data, const std::string& baseName, Vec2 basePosition, int tetriminoId);
+        // Nodes are shared between adjacent squares; keyed by rounded position
+        using NodePositionMap = std::map<std::string, Entity*>;
+        NodePositionMap createTetriminoNodes(const JellyTetriminoData& data, Vec2 basePosition, int tetriminoId);
+        void createTetriminoBeams(const JellyTetriminoData& data, const NodePositionMap& nodePositions, Vec2 basePosition, int tetriminoId);
+        // -1 for entities that are not part of a tetrimino
+        static int getTetriminoId(const Entity* entity);
 
         // Play field
         void createPlayField();
@@ -98,7 +109,6 @@ namespace dx3d
         void spawnTestTetramino(TetriminoReduxType type);
         void clearTestTetraminos();
         void toggleTestMode();
-        std::unique_ptr<EntityManager> m_entityManager;
         GraphicsDevice* m_graphicsDevice = nullptr;
 
         // Game state
@@ -132,7 +142,7 @@ namespace dx3d
         float m_tetraminoRotationForceMultiplier = 1.0f; // Rotation force strength
         
         // Node dragging state
-        Entity* m_draggedNode = nullptr;
+        EntityRef m_draggedNode; // reads null if the node is destroyed mid-drag
         bool m_isDraggingNode = false;
         Vec2 m_dragOffset;
         Vec2 m_lastMousePosition;
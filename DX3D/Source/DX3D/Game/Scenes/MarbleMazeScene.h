@@ -36,9 +36,6 @@ namespace dx3d {
         float m_bounce{ 0.6f };
         float m_forceStrength{ 15.0f };
         
-        // ECS
-        std::unique_ptr<EntityManager> m_entityManager;
-        
         // Textures
         std::shared_ptr<Texture2D> m_beamTexture;
         
@@ -65,7 +65,6 @@ namespace dx3d
         void fixedUpdate(float dt) override;
 
     private:
-        std::unique_ptr<EntityManager> m_entityManager;
         std::unique_ptr<Quadtree> m_quadtree;
         std::unique_ptr<AABBTree> m_aabbTree;
         std::unique_ptr<KDTree> m_kdTree;
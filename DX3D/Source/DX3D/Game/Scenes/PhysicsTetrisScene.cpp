@@ -8,6 +8,7 @@
 #include <DX3D/Core/Input.h>
 #include <iostream>
 #include <set>
+#include <unordered_set>
 #include <iomanip>
 #include <sstream>
 #include <imgui.h>
@@ -458,14 +459,14 @@ void PhysicsTetrisScene::update(float dt) {
 void PhysicsTetrisScene::updateCollisions() {
     auto nodeEntities = m_entityManager->getEntitiesWithComponent<NodeComponent>();
     auto beamEntities = m_entityManager->getEntitiesWithComponent<BeamComponent>();
+    // Index-aligned with nodeEntities
+    const std::vector<NodeComponent*> nodes = m_entityManager->getComponents<NodeComponent>();
 
     // Node-to-node collisions 
     for (size_t i = 0; i < nodeEntities.size(); ++i) {
         for (size_t j = i + 1; j < nodeEntities.size(); ++j) {
-            auto* node1 = nodeEntities[i]->getComponent<NodeComponent>();
-            auto* node2 = nodeEntities[j]->getComponent<NodeComponent>();
-
-            if (!node1 || !node2) continue;
+            auto* node1 = nodes[i];
+            auto* node2 = nodes[j];
 
             Vec2 pos1 = node1->getPosition();
             Vec2 pos2 = node2->getPosition();
@@ -778,10 +779,10 @@ void PhysicsTetrisScene::render(GraphicsEngine& engine, SwapChain& swapChain) {
     }
 
     // Render beams first (behind nodes)
-    for (auto* entity : m_entityManager->getEntitiesWithComponent<BeamComponent>()) {
-        auto* beam = entity->getComponent<BeamComponent>();
-        auto* sprite = entity->getComponent<SpriteComponent>();
-        if (beam && sprite && sprite->isVisible() && sprite->isValid()) {
+    m_entityManager->view<BeamComponent, SpriteComponent>().each([&](Entity&, BeamComponent& beamComp, SpriteComponent& spriteComp) {
+        auto* beam = &beamComp;
+        auto* sprite = &spriteComp;
+        if (sprite->isVisible() && sprite->isValid()) {
             float stress = clamp(beam->getStressFactor(), 0.0f, 1.0f);
             Vec4 currentTint = sprite->getTint();
             // Mix stress coloring with base color
@@ -794,16 +795,14 @@ void PhysicsTetrisScene::render(GraphicsEngine& engine, SwapChain& swapChain) {
             sprite->setTint(stressTint);
             sprite->draw(ctx);
         }
-    }
+    });
 
     // Render all sprites (nodes, boundaries, etc.)
-    for (auto* entity : m_entityManager->getEntitiesWithComponent<SpriteComponent>()) {
-        if (auto* sprite = entity->getComponent<SpriteComponent>()) {
-            if (sprite->isVisible() && sprite->isValid() && !entity->getComponent<BeamComponent>()) {
-                sprite->draw(ctx);
-            }
+    m_entityManager->view<SpriteComponent>().each([&](Entity& entity, SpriteComponent& sprite) {
+        if (sprite.isVisible() && sprite.isValid() && !entity.hasComponent<BeamComponent>()) {
+            sprite.draw(ctx);
         }
-    }
+    });
     // Render frame debug visualization only if enabled
     if (m_showFrameDebug) {
         renderFrameDebug(ctx);
@@ -1434,88 +1433,69 @@ void PhysicsTetrisScene::checkAndClearLines() {
     for (float y = playFieldBottom; y <= playFieldTop; y += lineSpacing) {
         if (isLineComplete(y)) {
             clearLine(y);
+            // Cleared nodes must not count towards the next line
+            m_entityManager->flushDestroyQueue();
         }
     }
 }
 
 bool PhysicsTetrisScene::isLineComplete(float y, float tolerance) {
-    auto nodeEntities = m_entityManager->getEntitiesWithComponent<NodeComponent>();
     int nodeCount = 0;
     
     // Count nodes that are close to this Y level and within the play field
-    for (auto* nodeEntity : nodeEntities) {
-        auto* node = nodeEntity->getComponent<NodeComponent>();
-        if (!node || node->isPositionFixed()) continue;
-        
-        // Skip wall nodes
-        std::string nodeName = nodeEntity->getName();
-        if (nodeName.find("Wall") != std::string::npos) continue;
+    m_entityManager->view<NodeComponent>().each([&](Entity& nodeEntity, NodeComponent& node) {
+        if (node.isPositionFixed()) return;
         
-        Vec2 pos = node->getPosition();
+        Vec2 pos = node.getPosition();
         
         // Check if node is at this Y level (within tolerance) and within play field X bounds
         if (abs(pos.y - y) <= LINE_SCAN_TOLERANCE && 
             pos.x >= -PLAY_FIELD_WIDTH / 2 && 
             pos.x <= PLAY_FIELD_WIDTH / 2) {
+            // Skip wall nodes
+            if (nodeEntity.getName().find("Wall") != std::string::npos) return;
             nodeCount++;
         }
-    }
+    });
     
     return nodeCount >= LINE_CLEAR_NODE_THRESHOLD ; // Line is complete if 5 or more nodes
 }
 
 void PhysicsTetrisScene::clearLine(float y, float tolerance) {
-    auto nodeEntities = m_entityManager->getEntitiesWithComponent<NodeComponent>();
-    std::vector<std::string> nodesToRemove;
-    std::vector<std::string> beamsToRemove;
+    std::vector<EntityHandle> nodesToRemove;
+    std::vector<EntityHandle> beamsToRemove;
+    std::unordered_set<const Entity*> removedNodeSet;
     std::set<std::string> affectedTetriminos; // Track which tetriminos are affected
     
     // Find all nodes in this line
-    for (auto* nodeEntity : nodeEntities) {
-        auto* node = nodeEntity->getComponent<NodeComponent>();
-        if (!node || node->isPositionFixed()) continue;
+    m_entityManager->view<NodeComponent>().each([&](Entity& nodeEntity, NodeComponent& node) {
+        if (node.isPositionFixed()) return;
         
-        std::string nodeName = nodeEntity->getName();
-        if (nodeName.find("Wall") != std::string::npos) continue;
+        const std::string& nodeName = nodeEntity.getName();
+        if (nodeName.find("Wall") != std::string::npos) return;
         
-        Vec2 pos = node->getPosition();
+        Vec2 pos = node.getPosition();
         
         if (abs(pos.y - y) <= tolerance && 
             pos.x >= -PLAY_FIELD_WIDTH / 2 && 
             pos.x <= PLAY_FIELD_WIDTH / 2) {
-            nodesToRemove.push_back(nodeName);
+            nodesToRemove.push_back(nodeEntity.getHandle());
+            removedNodeSet.insert(&nodeEntity);
             
             // Extract tetrimino prefix (e.g., "I_0" from "I_0_Node1")
             size_t nodePos = nodeName.find("_Node");
             if (nodePos != std::string::npos) {
-                std::string tetriminoPrefix = nodeName.substr(0, nodePos);
-                affectedTetriminos.insert(tetriminoPrefix);
+                affectedTetriminos.insert(nodeName.substr(0, nodePos));
             }
         }
-    }
+    });
     
-    // Find and remove beams connected to these nodes
-    auto beamEntities = m_entityManager->getEntitiesWithComponent<BeamComponent>();
-    for (auto* beamEntity : beamEntities) {
-        auto* beam = beamEntity->getComponent<BeamComponent>();
-        if (!beam) continue;
-        
-        std::string node1Name = beam->getNode1()->getName();
-        std::string node2Name = beam->getNode2()->getName();
-        
-        // If either node of the beam is being removed, remove the beam too
-        bool shouldRemoveBeam = false;
-        for (const std::string& nodeToRemove : nodesToRemove) {
-            if (node1Name == nodeToRemove || node2Name == nodeToRemove) {
-                shouldRemoveBeam = true;
-                break;
-            }
+    // Find beams connected to these nodes (one set lookup per beam endpoint)
+    m_entityManager->view<BeamComponent>().each([&](Entity& beamEntity, BeamComponent& beam) {
+        if (removedNodeSet.count(beam.getNode1()) || removedNodeSet.count(beam.getNode2())) {
+            beamsToRemove.push_back(beamEntity.getHandle());
         }
-        
-        if (shouldRemoveBeam) {
-            beamsToRemove.push_back(beamEntity->getName());
-        }
-    }
+    });
     
     // Remove frames for all affected tetriminos (any tetrimino that had nodes cleared)
     std::vector<std::string> framesToRemove;
@@ -1526,17 +1506,17 @@ void PhysicsTetrisScene::clearLine(float y, float tolerance) {
         }
     }
     
-    // Remove the entities
-    for (const std::string& beamName : beamsToRemove) {
-        m_entityManager->removeEntity(beamName);
+    // Queue the entities; checkAndClearLines flushes before scanning the next line
+    for (EntityHandle beam : beamsToRemove) {
+        m_entityManager->queueDestroy(beam);
     }
     
-    for (const std::string& nodeName : nodesToRemove) {
-        m_entityManager->removeEntity(nodeName);
+    for (EntityHandle node : nodesToRemove) {
+        m_entityManager->queueDestroy(node);
     }
     
     for (const std::string& frameName : framesToRemove) {
-        m_entityManager->removeEntity(frameName);
+        m_entityManager->queueDestroy(m_entityManager->findEntity(frameName));
     }
     
     // Apply gravity to orphaned nodes (nodes whose frames were removed)
@@ -1604,27 +1584,23 @@ void PhysicsTetrisScene::renderLineScanDebug() {
 }
 
 float PhysicsTetrisScene::calculateLineProgress(float y, float tolerance) {
-    auto nodeEntities = m_entityManager->getEntitiesWithComponent<NodeComponent>();
     int nodeCount = 0;
     
     // Count nodes that are close to this Y level and within the play field
-    for (auto* nodeEntity : nodeEntities) {
-        auto* node = nodeEntity->getComponent<NodeComponent>();
-        if (!node || node->isPositionFixed()) continue;
-        
-        // Skip wall nodes
-        std::string nodeName = nodeEntity->getName();
-        if (nodeName.find("Wall") != std::string::npos) continue;
+    m_entityManager->view<NodeComponent>().each([&](Entity& nodeEntity, NodeComponent& node) {
+        if (node.isPositionFixed()) return;
         
-        Vec2 pos = node->getPosition();
+        Vec2 pos = node.getPosition();
         
         // Check if node is at this Y level (within tolerance) and within play field X bounds
         if (abs(pos.y - y) <= tolerance && 
             pos.x >= -PLAY_FIELD_WIDTH / 2 && 
             pos.x <= PLAY_FIELD_WIDTH / 2) {
+            // Skip wall nodes
+            if (nodeEntity.getName().find("Wall") != std::string::npos) return;
             nodeCount++;
         }
-    }
+    });
     
     // Return progress as a percentage (0.0 to 1.0)
     return std::min(1.0f, static_cast<float>(nodeCount) / static_cast<float>(LINE_CLEAR_NODE_THRESHOLD));
@@ -160,7 +160,6 @@ namespace dx3d
         void checkGameOverCondition();
         void handleGameOver();
         void restartGame();
-        std::unique_ptr<EntityManager> m_entityManager;
         GraphicsDevice* m_graphicsDevice = nullptr;
 
         // Game state
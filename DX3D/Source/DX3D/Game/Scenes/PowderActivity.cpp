@@ -0,0 +1,110 @@
+#include <DX3D/Game/Scenes/PowderActivity.h>
+
+using namespace dx3d;
+
+void PowderActivityMap::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_chunksX = (width + ChunkSize - 1) / ChunkSize;
+    m_chunksY = (height + ChunkSize - 1) / ChunkSize;
+    m_sleep.resize(static_cast<std::size_t>(width) * height);
+    clear();
+}
+
+void PowderActivityMap::clear()
+{
+    m_chunks.assign(static_cast<std::size_t>(m_chunksX) * m_chunksY, PowderChunk{});
+    std::fill(m_sleep.begin(), m_sleep.end(), 0);
+    m_awakeCellCount = 0;
+}
+
+void PowderActivityMap::wake(int minX, int minY, int maxX, int maxY)
+{
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    maxX = std::min(maxX, m_width - 1);
+    maxY = std::min(maxY, m_height - 1);
+    if (maxX < minX || maxY < minY)
+        return;
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        uint8_t* row = &m_sleep[static_cast<std::size_t>(y) * m_width];
+        for (int x = minX; x <= maxX; ++x)
+        {
+            if (row[x] == 0)
+                ++m_awakeCellCount;
+            row[x] = SleepSteps;
+        }
+    }
+
+    for (int cy = minY / ChunkSize; cy <= maxY / ChunkSize; ++cy)
+    {
+        for (int cx = minX / ChunkSize; cx <= maxX / ChunkSize; ++cx)
+        {
+            PowderCellRect& awake = m_chunks[cy * m_chunksX + cx].awake;
+            awake.include(std::max(minX, cx * ChunkSize), std::max(minY, cy * ChunkSize));
+            awake.include(std::min(maxX, cx * ChunkSize + ChunkSize - 1), std::min(maxY, cy * ChunkSize + ChunkSize - 1));
+        }
+    }
+}
+
+void PowderActivityMap::markChanged(int minX, int minY, int maxX, int maxY)
+{
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    maxX = std::min(maxX, m_width - 1);
+    maxY = std::min(maxY, m_height - 1);
+    if (maxX < minX || maxY < minY)
+        return;
+
+    for (int cy = minY / ChunkSize; cy <= maxY / ChunkSize; ++cy)
+    {
+        for (int cx = minX / ChunkSize; cx <= maxX / ChunkSize; ++cx)
+        {
+            PowderCellRect& dirty = m_chunks[cy * m_chunksX + cx].dirty;
+            dirty.include(std::max(minX, cx * ChunkSize), std::max(minY, cy * ChunkSize));
+            dirty.include(std::min(maxX, cx * ChunkSize + ChunkSize - 1), std::min(maxY, cy * ChunkSize + ChunkSize - 1));
+        }
+    }
+
+    // Neighbors of an edited cell may react to it
+    wake(minX - 1, minY - 1, maxX + 1, maxY + 1);
+}
+
+void PowderActivityMap::settle()
+{
+    for (PowderChunk& chunk : m_chunks)
+    {
+        if (chunk.awake.isEmpty())
+            continue;
+
+        PowderCellRect stillAwake;
+        for (int y = chunk.awake.minY; y <= chunk.awake.maxY; ++y)
+        {
+            uint8_t* row = &m_sleep[static_cast<std::size_t>(y) * m_width];
+            for (int x = chunk.awake.minX; x <= chunk.awake.maxX; ++x)
+            {
+                if (row[x] == 0)
+                    continue;
+                if (--row[x] == 0)
+                    --m_awakeCellCount;
+                else
+                    stillAwake.include(x, y);
+            }
+        }
+        chunk.awake = stillAwake;
+    }
+}
+
+int PowderActivityMap::getAwakeChunkCount() const
+{
+    int count = 0;
+    for (const PowderChunk& chunk : m_chunks)
+    {
+        if (!chunk.awake.isEmpty())
+            ++count;
+    }
+    return count;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // Inclusive rectangle of grid cells; empty while maxX < minX
+    struct PowderCellRect
+    {
+        int minX = 0;
+        int minY = 0;
+        int maxX = -1;
+        int maxY = -1;
+
+        bool isEmpty() const { return maxX < minX; }
+        void include(int x, int y)
+        {
+            if (isEmpty()) { minX = maxX = x; minY = maxY = y; return; }
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+        }
+        void include(const PowderCellRect& other)
+        {
+            if (other.isEmpty()) return;
+            include(other.minX, other.minY);
+            include(other.maxX, other.maxY);
+        }
+    };
+
+    // Square tile of the grid; loops visit the awake rect of each chunk
+    struct PowderChunk
+    {
+        PowderCellRect awake;  // bounding box of the chunk's awake cells
+        PowderCellRect dirty;  // cells that differ between the front and back buffer
+    };
+
+    // Which cells of a double-buffered falling-sand grid are simulated. Every cell
+    // has a sleep counter that wake() resets and each step counts down; a cell
+    // that has not changed, and had no changed neighbor, for SleepSteps steps is
+    // skipped until something wakes it again (a neighbor changing, a tool, or the
+    // owner for air and temperature). Chunks keep the bounding box of their awake
+    // cells, so a step costs O(awake cells) rather than O(grid).
+    class PowderActivityMap
+    {
+    public:
+        static constexpr int ChunkSize = 32;
+        static constexpr int SleepSteps = 64; // covers stalls from movementChance rolls
+
+        void resize(int width, int height);
+        // Everything asleep and nothing dirty
+        void clear();
+
+        // Keep the given cells (clipped to the grid) simulated for at least SleepSteps steps
+        void wake(int minX, int minY, int maxX, int maxY);
+        // Cells edited outside a step (tools, brush): mark them dirty and wake them and their neighbors
+        void markChanged(int minX, int minY, int maxX, int maxY);
+
+        // After a step: diff the buffers within reach cells of the awake rects
+        // (differs(index) compares front and back), record dirty rects, wake around
+        // the changes and count every awake cell down
+        template<typename Differs>
+        void collectChanges(int reach, Differs&& differs);
+
+        bool isAwake(int x, int y) const { return m_sleep[y * m_width + x] != 0; }
+        PowderChunk& getChunk(int x, int y) { return m_chunks[(y / ChunkSize) * m_chunksX + x / ChunkSize]; }
+        std::vector<PowderChunk>& getChunks() { return m_chunks; }
+        const std::vector<PowderChunk>& getChunks() const { return m_chunks; }
+        int getChunksX() const { return m_chunksX; }
+        int getChunksY() const { return m_chunksY; }
+
+        int getAwakeCellCount() const { return m_awakeCellCount; }
+        int getAwakeChunkCount() const;
+
+    private:
+        // Count the awake cells down and shrink each awake rect to what is still awake
+        void settle();
+
+        int m_width = 0;
+        int m_height = 0;
+        int m_chunksX = 0;
+        int m_chunksY = 0;
+        std::vector<PowderChunk> m_chunks; // row-major, m_chunksX * m_chunksY
+        std::vector<uint8_t> m_sleep;      // steps left before the cell sleeps; 0 = asleep
+        int m_awakeCellCount = 0;
+    };
+
+    template<typename Differs>
+    void PowderActivityMap::collectChanges(int reach, Differs&& differs)
+    {
+        // An update writes at most reach cells from the cell being updated, so every
+        // change lies within that margin of an awake rect
+        for (const PowderChunk& chunk : m_chunks)
+        {
+            if (chunk.awake.isEmpty())
+                continue;
+
+            const int minX = std::max(chunk.awake.minX - reach, 0);
+            const int minY = std::max(chunk.awake.minY - reach, 0);
+            const int maxX = std::min(chunk.awake.maxX + reach, m_width - 1);
+            const int maxY = std::min(chunk.awake.maxY + reach, m_height - 1);
+            for (int y = minY; y <= maxY; ++y)
+            {
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    if (differs(y * m_width + x))
+                        getChunk(x, y).dirty.include(x, y);
+                }
+            }
+        }
+
+        // Count down, then re-wake around the cells that changed
+        settle();
+        for (std::size_t i = 0; i < m_chunks.size(); ++i)
+        {
+            const PowderCellRect dirty = m_chunks[i].dirty;
+            if (!dirty.isEmpty())
+                wake(dirty.minX - 1, dirty.minY - 1, dirty.maxX + 1, dirty.maxY + 1);
+        }
+    }
+}
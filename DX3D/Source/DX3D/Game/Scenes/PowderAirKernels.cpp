@@ -0,0 +1,448 @@
+#include <DX3D/Game/Scenes/PowderAirKernels.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#define DX3D_AIR_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DX3D_AIR_SSE2 1
+#endif
+#if defined(DX3D_AIR_SSE2) || defined(DX3D_AIR_AVX2)
+#include <immintrin.h>
+#endif
+
+using namespace dx3d;
+
+namespace
+{
+    const float PressureStep = 0.5f;
+    const float VelocityStep = 0.5f;
+
+    // Weak fields decay faster (spread out), strong ones keep most of their magnitude
+    float pressureLossFor(float pressure, float defaultLoss)
+    {
+        const float magnitude = std::abs(pressure);
+        if (magnitude > 20.0f) return 0.98f;
+        if (magnitude > 10.0f) return 0.85f;
+        if (magnitude > 2.0f) return defaultLoss;
+        if (magnitude > 0.5f) return 0.3f;
+        return 0.1f;
+    }
+
+    float velocityLossFor(float magnitude, float defaultLoss)
+    {
+        if (magnitude > 10.0f) return 0.98f;
+        if (magnitude > 5.0f) return 0.85f;
+        if (magnitude > 2.0f) return defaultLoss;
+        if (magnitude > 0.5f) return 0.3f;
+        return 0.1f;
+    }
+
+    // ========================= Scalar reference =========================
+
+    float blurCell(const float* src, const uint8_t* blocked, uint8_t blockBit, const float* kernel, int width, int height, int x, int y)
+    {
+        const float center = src[y * width + x];
+        float sum = 0.0f;
+        for (int j = -1; j <= 1; ++j)
+        {
+            for (int i = -1; i <= 1; ++i)
+            {
+                const int nx = x + i;
+                const int ny = y + j;
+                const float f = kernel[(i + 1) + 3 * (j + 1)];
+                if (nx > 0 && nx < width - 1 && ny > 0 && ny < height - 1 && !(blocked[ny * width + nx] & blockBit))
+                    sum += src[ny * width + nx] * f;
+                else
+                    sum += center * f;
+            }
+        }
+        return sum;
+    }
+
+    void divergenceCell(const float* vx, const float* vy, float* pressureNext, float pressureLoss, int width, int idx)
+    {
+        const float dp = (vx[idx - 1] - vx[idx + 1]) + (vy[idx - width] - vy[idx + width]);
+        pressureNext[idx] = pressureNext[idx] * pressureLossFor(pressureNext[idx], pressureLoss) + dp * PressureStep;
+    }
+
+    void gradientCell(const float* pressure, const uint8_t* blocked, float* vxNext, float* vyNext, float velocityLoss,
+        int width, int height, int x, int y)
+    {
+        const int idx = y * width + x;
+        const bool self = blocked[idx] != 0;
+
+        // Blocked cells clear the velocity on their own axis neighbors (only interior
+        // cells do the clearing), then the gradient result is blocked at walls again
+        const bool clearX = self || (x - 1 >= 1 && blocked[idx - 1]) || (x + 1 <= width - 2 && blocked[idx + 1]);
+        const bool clearY = self || (y - 1 >= 1 && blocked[idx - width]) || (y + 1 <= height - 2 && blocked[idx + width]);
+        const bool wallX = self || blocked[idx - 1] || blocked[idx + 1];
+        const bool wallY = self || blocked[idx - width] || blocked[idx + width];
+
+        float vx = clearX ? 0.0f : vxNext[idx];
+        float vy = clearY ? 0.0f : vyNext[idx];
+        const float dx = pressure[idx - 1] - pressure[idx + 1];
+        const float dy = pressure[idx - width] - pressure[idx + width];
+
+        const float loss = velocityLossFor(std::sqrt(vx * vx + vy * vy), velocityLoss);
+        vx = vx * loss + dx * VelocityStep;
+        vy = vy * loss + dy * VelocityStep;
+
+        vxNext[idx] = wallX ? 0.0f : vx;
+        vyNext[idx] = wallY ? 0.0f : vy;
+    }
+
+    float vorticityCell(const float* vx, const float* vy, int width, int height, int x, int y)
+    {
+        if (x > 1 && x < width - 2 && y > 1 && y < height - 2)
+        {
+            const int idx = y * width + x;
+            const float dvxDy = vx[idx + width] - vx[idx - width];
+            const float dvyDx = vy[idx + 1] - vy[idx - 1];
+            return (dvyDx - dvxDy) * 0.5f;
+        }
+        return 0.0f;
+    }
+
+    void convectionCell(const float* heat, const uint8_t* blocked, float* vxNext, float* vyNext,
+        float ambient, float gravityX, float gravityY, float strength, int idx)
+    {
+        if (blocked[idx])
+            return;
+        const float weight = std::clamp((heat[idx] - ambient) / 10000.0f, -0.01f, 0.01f);
+        vxNext[idx] += weight * gravityX * strength;
+        vyNext[idx] += weight * gravityY * strength;
+    }
+
+    // ========================= Lane types =========================
+
+#if defined(DX3D_AIR_SSE2)
+    struct SseLanes
+    {
+        using F = __m128;
+        static constexpr int Width = 4;
+
+        static F load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+        static F set(float v) { return _mm_set1_ps(v); }
+        static F add(F a, F b) { return _mm_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+        static F div(F a, F b) { return _mm_div_ps(a, b); }
+        static F min(F a, F b) { return _mm_min_ps(a, b); }
+        static F max(F a, F b) { return _mm_max_ps(a, b); }
+        static F sqrt(F a) { return _mm_sqrt_ps(a); }
+        static F abs(F a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+        static F greater(F a, F b) { return _mm_cmpgt_ps(a, b); }
+        static F both(F a, F b) { return _mm_and_ps(a, b); }
+        static F select(F mask, F a, F b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+        // All bits set in lanes whose blocked byte has none of blockBit
+        static F open(const uint8_t* blocked, uint8_t blockBit)
+        {
+            int32_t bytes;
+            std::memcpy(&bytes, blocked, sizeof(bytes));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+            lanes = _mm_and_si128(lanes, _mm_set1_epi32(blockBit));
+            return _mm_castsi128_ps(_mm_cmpeq_epi32(lanes, zero));
+        }
+    };
+#endif
+
+#if defined(DX3D_AIR_AVX2)
+    struct AvxLanes
+    {
+        using F = __m256;
+        static constexpr int Width = 8;
+
+        static F load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+        static F set(float v) { return _mm256_set1_ps(v); }
+        static F add(F a, F b) { return _mm256_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+        static F div(F a, F b) { return _mm256_div_ps(a, b); }
+        static F min(F a, F b) { return _mm256_min_ps(a, b); }
+        static F max(F a, F b) { return _mm256_max_ps(a, b); }
+        static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+        static F abs(F a) { return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+        static F greater(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static F both(F a, F b) { return _mm256_and_ps(a, b); }
+        static F select(F mask, F a, F b) { return _mm256_blendv_ps(b, a, mask); }
+
+        static F open(const uint8_t* blocked, uint8_t blockBit)
+        {
+            __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(blocked)));
+            lanes = _mm256_and_si256(lanes, _mm256_set1_epi32(blockBit));
+            return _mm256_castsi256_ps(_mm256_cmpeq_epi32(lanes, _mm256_setzero_si256()));
+        }
+    };
+#endif
+
+    // Run fn with the lane type for simd; returns x unchanged when only the scalar path is available
+    template<typename Fn>
+    int dispatchLanes(PowderAirSimd simd, int x, Fn&& fn)
+    {
+#if defined(DX3D_AIR_AVX2)
+        if (simd == PowderAirSimd::Avx2) return fn(AvxLanes{});
+#endif
+#if defined(DX3D_AIR_SSE2)
+        if (simd != PowderAirSimd::Scalar) return fn(SseLanes{});
+#endif
+        (void)simd;
+        return x;
+    }
+
+    // ========================= Vectorized rows =========================
+    // Each processes whole vectors of cells starting at x while they end before xEnd
+    // and returns the first cell left for the scalar tail.
+
+    template<typename L>
+    int blurRow(const float* src, const uint8_t* blocked, uint8_t blockBit, const float* kernel, float* dst, int width, int y, int x, int xEnd)
+    {
+        using F = typename L::F;
+        F weights[9];
+        for (int k = 0; k < 9; ++k) weights[k] = L::set(kernel[k]);
+
+        for (; x + L::Width <= xEnd; x += L::Width)
+        {
+            const int idx = y * width + x;
+            const F center = L::load(src + idx);
+            F sum = L::set(0.0f);
+            for (int j = -1; j <= 1; ++j)
+            {
+                for (int i = -1; i <= 1; ++i)
+                {
+                    const int n = idx + j * width + i;
+                    const F value = L::select(L::open(blocked + n, blockBit), L::load(src + n), center);
+                    sum = L::add(sum, L::mul(value, weights[(i + 1) + 3 * (j + 1)]));
+                }
+            }
+            L::store(dst + idx, sum);
+        }
+        return x;
+    }
+
+    template<typename L>
+    int divergenceRow(const float* vx, const float* vy, float* pressureNext, float pressureLoss, int width, int y, int x, int xEnd)
+    {
+        using F = typename L::F;
+        const F defaultLoss = L::set(pressureLoss);
+        const F step = L::set(PressureStep);
+
+        for (; x + L::Width <= xEnd; x += L::Width)
+        {
+            const int idx = y * width + x;
+            const F dp = L::add(L::sub(L::load(vx + idx - 1), L::load(vx + idx + 1)),
+                                L::sub(L::load(vy + idx - width), L::load(vy + idx + width)));
+
+            // Same thresholds as pressureLossFor, resolved weakest first so stronger bands win
+            const F pressure = L::load(pressureNext + idx);
+            const F magnitude = L::abs(pressure);
+            F loss = L::set(0.1f);
+            loss = L::select(L::greater(magnitude, L::set(0.5f)), L::set(0.3f), loss);
+            loss = L::select(L::greater(magnitude, L::set(2.0f)), defaultLoss, loss);
+            loss = L::select(L::greater(magnitude, L::set(10.0f)), L::set(0.85f), loss);
+            loss = L::select(L::greater(magnitude, L::set(20.0f)), L::set(0.98f), loss);
+
+            L::store(pressureNext + idx, L::add(L::mul(pressure, loss), L::mul(dp, step)));
+        }
+        return x;
+    }
+
+    template<typename L>
+    int gradientRow(const float* pressure, const uint8_t* blocked, float* vxNext, float* vyNext, float velocityLoss, int width, int y, int x, int xEnd)
+    {
+        using F = typename L::F;
+        const F defaultLoss = L::set(velocityLoss);
+        const F step = L::set(VelocityStep);
+        const F zero = L::set(0.0f);
+
+        for (; x + L::Width <= xEnd; x += L::Width)
+        {
+            const int idx = y * width + x;
+
+            // Away from the edges the wall clearing and the wall block test cover the same cells
+            const F self = L::open(blocked + idx, 0xFF);
+            const F openX = L::both(self, L::both(L::open(blocked + idx - 1, 0xFF), L::open(blocked + idx + 1, 0xFF)));
+            const F openY = L::both(self, L::both(L::open(blocked + idx - width, 0xFF), L::open(blocked + idx + width, 0xFF)));
+
+            F vx = L::select(openX, L::load(vxNext + idx), zero);
+            F vy = L::select(openY, L::load(vyNext + idx), zero);
+            const F dx = L::sub(L::load(pressure + idx - 1), L::load(pressure + idx + 1));
+            const F dy = L::sub(L::load(pressure + idx - width), L::load(pressure + idx + width));
+
+            const F magnitude = L::sqrt(L::add(L::mul(vx, vx), L::mul(vy, vy)));
+            F loss = L::set(0.1f);
+            loss = L::select(L::greater(magnitude, L::set(0.5f)), L::set(0.3f), loss);
+            loss = L::select(L::greater(magnitude, L::set(2.0f)), defaultLoss, loss);
+            loss = L::select(L::greater(magnitude, L::set(5.0f)), L::set(0.85f), loss);
+            loss = L::select(L::greater(magnitude, L::set(10.0f)), L::set(0.98f), loss);
+
+            vx = L::add(L::mul(vx, loss), L::mul(dx, step));
+            vy = L::add(L::mul(vy, loss), L::mul(dy, step));
+            L::store(vxNext + idx, L::select(openX, vx, zero));
+            L::store(vyNext + idx, L::select(openY, vy, zero));
+        }
+        return x;
+    }
+
+    template<typename L>
+    int vorticityRow(const float* vx, const float* vy, float* curl, int width, int y, int x, int xEnd)
+    {
+        using F = typename L::F;
+        const F half = L::set(0.5f);
+
+        for (; x + L::Width <= xEnd; x += L::Width)
+        {
+            const int idx = y * width + x;
+            const F dvxDy = L::sub(L::load(vx + idx + width), L::load(vx + idx - width));
+            const F dvyDx = L::sub(L::load(vy + idx + 1), L::load(vy + idx - 1));
+            L::store(curl + idx, L::mul(L::sub(dvyDx, dvxDy), half));
+        }
+        return x;
+    }
+
+    template<typename L>
+    int convectionRow(const float* heat, const uint8_t* blocked, float* vxNext, float* vyNext,
+        float ambient, float gravityX, float gravityY, float strength, int width, int y, int x, int xEnd)
+    {
+        using F = typename L::F;
+        const F ambientV = L::set(ambient);
+        const F scale = L::set(10000.0f);
+        const F lo = L::set(-0.01f);
+        const F hi = L::set(0.01f);
+        const F gx = L::set(gravityX);
+        const F gy = L::set(gravityY);
+        const F strengthV = L::set(strength);
+        const F zero = L::set(0.0f);
+
+        for (; x + L::Width <= xEnd; x += L::Width)
+        {
+            const int idx = y * width + x;
+            const F open = L::open(blocked + idx, 0xFF);
+            const F weight = L::min(L::max(L::div(L::sub(L::load(heat + idx), ambientV), scale), lo), hi);
+            L::store(vxNext + idx, L::add(L::load(vxNext + idx), L::select(open, L::mul(L::mul(weight, gx), strengthV), zero)));
+            L::store(vyNext + idx, L::add(L::load(vyNext + idx), L::select(open, L::mul(L::mul(weight, gy), strengthV), zero)));
+        }
+        return x;
+    }
+}
+
+PowderAirSimd dx3d::getPowderAirSimdSupport()
+{
+#if defined(DX3D_AIR_AVX2)
+    return PowderAirSimd::Avx2;
+#elif defined(DX3D_AIR_SSE2)
+    return PowderAirSimd::Sse2;
+#else
+    return PowderAirSimd::Scalar;
+#endif
+}
+
+const char* dx3d::getPowderAirSimdName(PowderAirSimd simd)
+{
+    switch (simd)
+    {
+    case PowderAirSimd::Sse2: return "SSE2";
+    case PowderAirSimd::Avx2: return "AVX2";
+    default: return "Scalar";
+    }
+}
+
+void PowderAirStencil::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+}
+
+void PowderAirStencil::setKernel(const float kernel[9])
+{
+    std::copy(kernel, kernel + 9, m_kernel);
+}
+
+void PowderAirStencil::setSimd(PowderAirSimd simd)
+{
+    m_simd = std::min(simd, getPowderAirSimdSupport());
+}
+
+void PowderAirStencil::blur(const float* src, const uint8_t* blocked, uint8_t blockBit, float* dst, int rowBegin, int rowEnd) const
+{
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        int x = 0;
+        if (y >= 2 && y < m_height - 2)
+        {
+            // Two cells in from every edge all nine taps are interior, so only the block mask matters
+            for (; x < 2; ++x) dst[y * m_width + x] = blurCell(src, blocked, blockBit, m_kernel, m_width, m_height, x, y);
+            x = dispatchLanes(m_simd, x, [&](auto lanes)
+            {
+                return blurRow<decltype(lanes)>(src, blocked, blockBit, m_kernel, dst, m_width, y, x, m_width - 2);
+            });
+        }
+        for (; x < m_width; ++x) dst[y * m_width + x] = blurCell(src, blocked, blockBit, m_kernel, m_width, m_height, x, y);
+    }
+}
+
+void PowderAirStencil::divergence(const float* velocityX, const float* velocityY, float* pressureNext, float pressureLoss, int rowBegin, int rowEnd) const
+{
+    for (int y = std::max(rowBegin, 1); y < std::min(rowEnd, m_height - 1); ++y)
+    {
+        int x = dispatchLanes(m_simd, 1, [&](auto lanes)
+        {
+            return divergenceRow<decltype(lanes)>(velocityX, velocityY, pressureNext, pressureLoss, m_width, y, 1, m_width - 1);
+        });
+        for (; x < m_width - 1; ++x) divergenceCell(velocityX, velocityY, pressureNext, pressureLoss, m_width, y * m_width + x);
+    }
+}
+
+void PowderAirStencil::gradient(const float* pressure, const uint8_t* blocked, float* velocityXNext, float* velocityYNext, float velocityLoss, int rowBegin, int rowEnd) const
+{
+    for (int y = std::max(rowBegin, 1); y < std::min(rowEnd, m_height - 1); ++y)
+    {
+        int x = 1;
+        if (y >= 2 && y < m_height - 2)
+        {
+            gradientCell(pressure, blocked, velocityXNext, velocityYNext, velocityLoss, m_width, m_height, x++, y);
+            x = dispatchLanes(m_simd, x, [&](auto lanes)
+            {
+                return gradientRow<decltype(lanes)>(pressure, blocked, velocityXNext, velocityYNext, velocityLoss, m_width, y, x, m_width - 2);
+            });
+        }
+        for (; x < m_width - 1; ++x) gradientCell(pressure, blocked, velocityXNext, velocityYNext, velocityLoss, m_width, m_height, x, y);
+    }
+}
+
+void PowderAirStencil::vorticity(const float* velocityX, const float* velocityY, float* curl, int rowBegin, int rowEnd) const
+{
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        int x = 0;
+        if (y >= 2 && y < m_height - 2)
+        {
+            for (; x < 2; ++x) curl[y * m_width + x] = 0.0f;
+            x = dispatchLanes(m_simd, x, [&](auto lanes)
+            {
+                return vorticityRow<decltype(lanes)>(velocityX, velocityY, curl, m_width, y, x, m_width - 2);
+            });
+        }
+        for (; x < m_width; ++x) curl[y * m_width + x] = vorticityCell(velocityX, velocityY, m_width, m_height, x, y);
+    }
+}
+
+void PowderAirStencil::convection(const float* heat, const uint8_t* blocked, float* velocityXNext, float* velocityYNext,
+    float ambient, float gravityX, float gravityY, float strength, int rowBegin, int rowEnd) const
+{
+    for (int y = std::max(rowBegin, 2); y < std::min(rowEnd, m_height - 2); ++y)
+    {
+        int x = dispatchLanes(m_simd, 2, [&](auto lanes)
+        {
+            return convectionRow<decltype(lanes)>(heat, blocked, velocityXNext, velocityYNext, ambient, gravityX, gravityY, strength, m_width, y, 2, m_width - 2);
+        });
+        for (; x < m_width - 2; ++x)
+            convectionCell(heat, blocked, velocityXNext, velocityYNext, ambient, gravityX, gravityY, strength, y * m_width + x);
+    }
+}
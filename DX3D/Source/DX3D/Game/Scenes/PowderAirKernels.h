@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+namespace dx3d
+{
+    // Instruction set used by the air stencils. Only what the build targets is
+    // available: SSE2 on every x64 build, AVX2 when compiled with /arch:AVX2 (-mavx2).
+    enum class PowderAirSimd : uint8_t
+    {
+        Scalar = 0,
+        Sse2,
+        Avx2
+    };
+
+    // Widest instruction set this build was compiled for
+    PowderAirSimd getPowderAirSimdSupport();
+    const char* getPowderAirSimdName(PowderAirSimd simd);
+
+    // Row stencils for the PowderScene air fields. Every field is a width x height
+    // row-major float plane; blocked maps are the scene's uint8 masks (m_blockAir,
+    // or m_blockAirHeat tested against bit 0x8 by the blur) applied as lane masks.
+    // The interior is vectorized and the outer two rings plus the row tails run
+    // the scalar reference, so results match the scalar path up to floating point
+    // contraction. Passes only write the rows in [rowBegin, rowEnd), which lets
+    // callers split them across threads.
+    class PowderAirStencil
+    {
+    public:
+        void resize(int width, int height);
+        void setKernel(const float kernel[9]);
+        void setSimd(PowderAirSimd simd); // Clamped to getPowderAirSimdSupport()
+        PowderAirSimd getSimd() const { return m_simd; }
+
+        // 3x3 weighted blur; neighbors that are blocked or on the outer edge take the center value
+        void blur(const float* src, const uint8_t* blocked, uint8_t blockBit, float* dst, int rowBegin, int rowEnd) const;
+
+        // Pressure from velocity divergence: next = next * loss(|next|) + div * 0.5, interior cells only
+        void divergence(const float* velocityX, const float* velocityY, float* pressureNext, float pressureLoss, int rowBegin, int rowEnd) const;
+
+        // Velocity from the pressure gradient with magnitude-dependent loss, zeroed next to blocked cells
+        void gradient(const float* pressure, const uint8_t* blocked, float* velocityXNext, float* velocityYNext, float velocityLoss, int rowBegin, int rowEnd) const;
+
+        // Curl (dvy/dx - dvx/dy) / 2, zero within two cells of the edge
+        void vorticity(const float* velocityX, const float* velocityY, float* curl, int rowBegin, int rowEnd) const;
+
+        // Buoyancy: velocity += clamp((heat - ambient) / 10000, +-0.01) * gravity * strength on open cells
+        void convection(const float* heat, const uint8_t* blocked, float* velocityXNext, float* velocityYNext,
+            float ambient, float gravityX, float gravityY, float strength, int rowBegin, int rowEnd) const;
+
+    private:
+        int m_width = 0;
+        int m_height = 0;
+        float m_kernel[9] = {};
+        PowderAirSimd m_simd = getPowderAirSimdSupport();
+    };
+}
@@ -0,0 +1,202 @@
+#include <DX3D/Game/Scenes/PowderAirWake.h>
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace dx3d;
+
+namespace
+{
+    // Lighter particles are pushed more: sensitivity is 1 / density, clamped
+    const float MinAirSensitivity = 0.1f;
+    const float MaxAirSensitivity = 10.0f;
+    // Push thresholds, divided by the particle's sensitivity
+    const float PressureThreshold = 0.5f;
+    const float VelocityThreshold = 0.3f;
+
+    // Weaker air than this pushes no particle, not even the lightest; halved so
+    // float rounding near the threshold cannot skip a chunk the full test would wake
+    const float MinPushVelocity = 0.5f * VelocityThreshold / (MaxAirSensitivity * MaxAirSensitivity);
+    const float MinPushForce = 0.5f * PressureThreshold / (MaxAirSensitivity * MaxAirSensitivity);
+    // Rounding of temperature differences in the hundreds of kelvin
+    const float HeatEpsilon = 1e-3f;
+
+    bool wakesParticle(const PowderParticleProperties& props, const PowderAirFields& air, int x, int y, float temperature, float temperatureDelta)
+    {
+        // Air sources (fire, lava) never sleep
+        if (props.heatsAir || props.draftStrength > 0.0f)
+            return true;
+        const int idx = y * air.width + x;
+        if (props.airHeatRate > 0.0f && std::abs(air.heat[idx] - temperature) > temperatureDelta)
+            return true;
+        if (props.matterState == PowderMatterState::Solid)
+            return false;
+
+        int pushX = 0;
+        int pushY = 0;
+        getPowderAirPush(air, x, y, props.density, pushX, pushY);
+        return pushX != 0 || pushY != 0;
+    }
+}
+
+void dx3d::getPowderAirPush(const PowderAirFields& air, int x, int y, float density, int& pushX, int& pushY)
+{
+    const int idx = y * air.width + x;
+    const float vx = air.velocityX[idx];
+    const float vy = air.velocityY[idx];
+
+    const float sensitivity = std::clamp(1.0f / std::max(density, 0.1f), MinAirSensitivity, MaxAirSensitivity);
+    const float pressureThreshold = PressureThreshold / sensitivity;
+    const float velocityThreshold = VelocityThreshold / sensitivity;
+
+    // Pressure gradient, zero on the edges
+    float pressureX = 0.0f;
+    float pressureY = 0.0f;
+    if (x > 0 && x < air.width - 1)
+        pressureX = air.pressure[idx - 1] - air.pressure[idx + 1];
+    if (y > 0 && y < air.height - 1)
+        pressureY = air.pressure[idx - air.width] - air.pressure[idx + air.width];
+
+    const float forceX = (pressureX * 0.5f + vx) * sensitivity;
+    const float forceY = (pressureY * 0.5f + vy) * sensitivity;
+    if (std::abs(forceX) > pressureThreshold || std::abs(vx * sensitivity) > velocityThreshold)
+        pushX = (forceX > 0.0f) ? 1 : (forceX < 0.0f) ? -1 : 0;
+    if (std::abs(forceY) > pressureThreshold || std::abs(vy * sensitivity) > velocityThreshold)
+        pushY = (forceY > 0.0f) ? 1 : (forceY < 0.0f) ? -1 : 0;
+}
+
+void PowderAirWake::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_chunksX = (width + ChunkSize - 1) / ChunkSize;
+    const int chunksY = (height + ChunkSize - 1) / ChunkSize;
+    m_chunks.clear();
+    m_chunks.resize(static_cast<std::size_t>(m_chunksX) * chunksY);
+    m_testedHeat.assign(static_cast<std::size_t>(width) * height, 0.0f);
+    m_stale = true;
+}
+
+int PowderAirWake::wake(PowderActivityMap& activity, const PowderElementTable& elements, const PowderParticleType* types,
+    const float* temperatures, const PowderAirFields& air, float temperatureDelta, int maxThreads)
+{
+    const bool stale = m_stale;
+    m_stale = false;
+
+    // Chunks are independent: each reads the air and activity and writes only its own state
+    const std::vector<PowderChunk>& activityChunks = activity.getChunks();
+    JobSystem::getInstance().parallelFor(0, static_cast<int>(m_chunks.size()), 4, [&](int begin, int end)
+    {
+        for (int c = begin; c < end; ++c)
+        {
+            ChunkState& chunk = m_chunks[c];
+            const bool awake = !activityChunks[c].awake.isEmpty();
+            chunk.tested = stale || awake || chunk.hadAwake || needsTest(c, air);
+            chunk.hadAwake = awake;
+            if (chunk.tested)
+                testChunk(c, activity, elements, types, temperatures, air, temperatureDelta);
+        }
+    }, maxThreads);
+
+    // Waking updates the map's shared counts, so it runs after the parallel pass
+    int tested = 0;
+    for (ChunkState& chunk : m_chunks)
+    {
+        if (!chunk.tested)
+            continue;
+        ++tested;
+        for (int idx : chunk.woken)
+            activity.wake(idx % m_width, idx / m_width, idx % m_width, idx / m_width);
+        chunk.woken.clear();
+    }
+    return tested;
+}
+
+void PowderAirWake::wakeAll(PowderActivityMap& activity, const PowderElementTable& elements, const PowderParticleType* types,
+    const float* temperatures, const PowderAirFields& air, float temperatureDelta)
+{
+    for (int y = 0; y < air.height; ++y)
+    {
+        for (int x = 0; x < air.width; ++x)
+        {
+            const int idx = y * air.width + x;
+            if (types[idx] == PowderParticleType::Empty || activity.isAwake(x, y))
+                continue;
+            if (wakesParticle(elements.getProperties(types[idx]), air, x, y, temperatures[idx], temperatureDelta))
+                activity.wake(x, y, x, y);
+        }
+    }
+}
+
+bool PowderAirWake::needsTest(int chunkIndex, const PowderAirFields& air) const
+{
+    const int minX = (chunkIndex % m_chunksX) * ChunkSize;
+    const int minY = (chunkIndex / m_chunksX) * ChunkSize;
+    const int maxX = std::min(minX + ChunkSize, m_width);
+    const int maxY = std::min(minY + ChunkSize, m_height);
+    // Pressure gradients are zero on the grid edges
+    const int innerMinX = std::max(minX, 1);
+    const int innerMaxX = std::min(maxX, m_width - 1);
+    const int width = m_width;
+    const float heatBound = m_chunks[chunkIndex].headroom - HeatEpsilon;
+
+    // Whether getPowderAirPush or the heat test could fire anywhere in the chunk;
+    // branch-free per row so the compiler vectorizes it, checked once per row
+    for (int y = minY; y < maxY; ++y)
+    {
+        const int row = y * width;
+        const float* vx = air.velocityX + row;
+        const float* vy = air.velocityY + row;
+        const float* pressure = air.pressure + row;
+        const float* heat = air.heat + row;
+        const float* testedHeat = m_testedHeat.data() + row;
+
+        int exceeds = 0; // an int, not a bool, so the |= reductions vectorize
+        for (int x = minX; x < maxX; ++x)
+        {
+            exceeds |= std::abs(vx[x]) > MinPushVelocity;
+            exceeds |= std::abs(vy[x]) > MinPushVelocity;
+            exceeds |= std::abs(heat[x] - testedHeat[x]) > heatBound;
+        }
+        for (int x = innerMinX; x < innerMaxX; ++x)
+            exceeds |= std::abs(pressure[x - 1] - pressure[x + 1]) * 0.5f + std::abs(vx[x]) > MinPushForce;
+        if (y > 0 && y < m_height - 1)
+        {
+            for (int x = minX; x < maxX; ++x)
+                exceeds |= std::abs(pressure[x - width] - pressure[x + width]) * 0.5f + std::abs(vy[x]) > MinPushForce;
+        }
+        if (exceeds)
+            return true;
+    }
+    return false;
+}
+
+void PowderAirWake::testChunk(int chunkIndex, const PowderActivityMap& activity, const PowderElementTable& elements,
+    const PowderParticleType* types, const float* temperatures, const PowderAirFields& air, float temperatureDelta)
+{
+    const int minX = (chunkIndex % m_chunksX) * ChunkSize;
+    const int minY = (chunkIndex / m_chunksX) * ChunkSize;
+    const int maxX = std::min(minX + ChunkSize, m_width);
+    const int maxY = std::min(minY + ChunkSize, m_height);
+
+    ChunkState& chunk = m_chunks[chunkIndex];
+    float headroom = std::numeric_limits<float>::max();
+    for (int y = minY; y < maxY; ++y)
+    {
+        for (int x = minX; x < maxX; ++x)
+        {
+            const int idx = y * m_width + x;
+            m_testedHeat[idx] = air.heat[idx];
+            if (types[idx] == PowderParticleType::Empty || activity.isAwake(x, y))
+                continue;
+
+            const PowderParticleProperties& props = elements.getProperties(types[idx]);
+            if (wakesParticle(props, air, x, y, temperatures[idx], temperatureDelta))
+                chunk.woken.push_back(idx);
+            else if (props.airHeatRate > 0.0f)
+                headroom = std::min(headroom, temperatureDelta - std::abs(air.heat[idx] - temperatures[idx]));
+        }
+    }
+    chunk.headroom = headroom;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <DX3D/Game/Scenes/PowderActivity.h>
+#include <DX3D/Game/Scenes/PowderElements.h>
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // The air planes of a powder grid, width x height row-major (PowderScene's m_air*)
+    struct PowderAirFields
+    {
+        const float* pressure = nullptr;
+        const float* velocityX = nullptr;
+        const float* velocityY = nullptr;
+        const float* heat = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+    // Direction (-1, 0 or 1 per axis) the air at (x, y) pushes a particle of the given
+    // density. Axes where the air is too weak to move it are left unchanged.
+    void getPowderAirPush(const PowderAirFields& air, int x, int y, float density, int& pushX, int& pushY);
+
+    // Wakes the sleeping particles the air field affects: air sources, particles the air
+    // would push and particles whose temperature lags the air by more than the wake delta.
+    // Rather than testing every sleeping particle each step, a threshold pass over the
+    // air picks the chunks worth testing:
+    //  - the air somewhere in the chunk is strong enough to push the lightest particle,
+    //  - the air heat moved further since the chunk's last test than the smallest gap
+    //    its sleeping particles had left before the wake delta, or
+    //  - cells in it were awake on this or the previous pass, so some may have just
+    //    fallen asleep untested.
+    // Every other chunk holds no particle the full test would wake, so both wake the
+    // same cells.
+    class PowderAirWake
+    {
+    public:
+        static constexpr int ChunkSize = PowderActivityMap::ChunkSize;
+
+        void resize(int width, int height);
+        // Test every chunk on the next pass; for passes skipped (air or sleeping off)
+        // and changes the air field does not show (wake delta, element properties)
+        void invalidate() { m_stale = true; }
+
+        // Returns the number of chunks tested
+        int wake(PowderActivityMap& activity, const PowderElementTable& elements, const PowderParticleType* types,
+            const float* temperatures, const PowderAirFields& air, float temperatureDelta, int maxThreads);
+        // Reference: test every sleeping particle of the grid
+        static void wakeAll(PowderActivityMap& activity, const PowderElementTable& elements, const PowderParticleType* types,
+            const float* temperatures, const PowderAirFields& air, float temperatureDelta);
+
+    private:
+        struct ChunkState
+        {
+            float headroom = 0.0f;    // smallest wake delta left by the sleeping particles at the last test
+            bool hadAwake = false;    // the chunk had awake cells on the previous pass
+            bool tested = false;
+            std::vector<int> woken;   // cells to wake, applied after the parallel pass
+        };
+
+        bool needsTest(int chunkIndex, const PowderAirFields& air) const;
+        void testChunk(int chunkIndex, const PowderActivityMap& activity, const PowderElementTable& elements,
+            const PowderParticleType* types, const float* temperatures, const PowderAirFields& air, float temperatureDelta);
+
+        int m_width = 0;
+        int m_height = 0;
+        int m_chunksX = 0;
+        std::vector<ChunkState> m_chunks;
+        std::vector<float> m_testedHeat; // air heat each cell was last tested against
+        bool m_stale = true;
+    };
+}
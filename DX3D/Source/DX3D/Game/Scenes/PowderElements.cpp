@@ -0,0 +1,219 @@
+#include <DX3D/Game/Scenes/PowderElements.h>
+
+using namespace dx3d;
+
+namespace
+{
+    using Type = PowderParticleType;
+    using State = PowderMatterState;
+    using Kind = PowderReactionKind;
+
+    constexpr float AmbientTemp = 273.15f + 22.0f; // ~22°C
+    constexpr float MeltingPoint = 1473.15f;       // ~1200°C, stone, sand and metal melt into lava
+    constexpr float BoilingPoint = 373.15f;        // 100°C, water <-> steam
+
+    PowderReaction makeReaction(Kind kind, float rate = 0.0f)
+    {
+        PowderReaction reaction;
+        reaction.kind = kind;
+        reaction.rate = rate;
+        return reaction;
+    }
+
+    PowderReaction makeConversion(Type product, Type selfProduct = Type::Empty, float productTemp = 0.0f, float selfProductTemp = 0.0f)
+    {
+        PowderReaction reaction;
+        reaction.kind = Kind::Convert;
+        reaction.product = product;
+        reaction.productTemp = productTemp;
+        reaction.selfProduct = selfProduct;
+        reaction.selfProductTemp = selfProductTemp;
+        return reaction;
+    }
+}
+
+PowderElementTable::PowderElementTable()
+{
+    // Sand: Powder state - falls down, can swap with less dense particles, but doesn't spread horizontally
+    PowderParticleProperties sand;
+    sand.matterState = State::Powder;
+    sand.density = 3.0f;
+    sand.transitionInto = Type::Lava;
+    sand.transitionTemp = MeltingPoint;
+    setProperties(Type::Sand, sand);
+
+    // Water: Liquid state - random horizontal movement, falls down, can float above denser liquids/powders
+    PowderParticleProperties water;
+    water.matterState = State::Liquid;
+    water.density = 1.0f;
+    water.airHeatRate = 0.05f; // Water heats up slower than steam cools
+    water.transitionInto = Type::Steam; // Boils at 100°C
+    water.transitionTemp = BoilingPoint;
+    setProperties(Type::Water, water);
+
+    // Metal: Solid state - does not move via non-chemical reactions (formerly Stone)
+    PowderParticleProperties metal;
+    metal.matterState = State::Solid;
+    metal.density = 10.0f;
+    metal.airHeatRate = 0.05f; // Metal heats up slowly
+    metal.transitionInto = Type::Lava; // Lower than lava temp so it can actually melt
+    metal.transitionTemp = MeltingPoint;
+    setProperties(Type::Metal, metal);
+
+    // Stone: Powder state - falls down like sand, melts into lava when hot
+    PowderParticleProperties stone;
+    stone.matterState = State::Powder;
+    stone.density = 4.0f; // Denser than lava (stone sinks in lava)
+    stone.flammable = false; // Stone cannot ignite
+    stone.airHeatRate = 0.05f;
+    stone.transitionInto = Type::Lava;
+    stone.transitionTemp = MeltingPoint;
+    setProperties(Type::Stone, stone);
+
+    // Lava: Liquid state - hot molten rock, converts other particles
+    PowderParticleProperties lava;
+    lava.matterState = State::Liquid;
+    lava.density = 3.0f; // Same density as sand (so they don't sink through each other)
+    lava.movementChance = 0.3f; // More viscous - moves horizontally less often
+    lava.flammable = false; // Lava doesn't burn
+    lava.burnTemp = 1500.0f; // Lava is very hot
+    lava.heatsAir = true;
+    setProperties(Type::Lava, lava);
+
+    // Wood: Solid state - does not move via non-chemical reactions
+    PowderParticleProperties wood;
+    wood.matterState = State::Solid;
+    wood.density = 0.8f;
+    wood.flammable = true; // Wood can burn
+    wood.ignitionTemp = 573.15f; // ~300°C ignition temperature
+    wood.burnTemp = 1200.0f; // Hot when burning
+    wood.burnLife = 50; // Wood burns slowly
+    setProperties(Type::Wood, wood);
+
+    // Gas: Gas state - moves opposite to gravity (upward), repels from other gas particles
+    PowderParticleProperties gas;
+    gas.matterState = State::Gas;
+    gas.density = 0.1f; // Very light
+    gas.movementChance = 0.3f; // 30% chance to move each frame (makes gas move slower)
+    gas.flammable = true; // Gas can burn
+    gas.ignitionTemp = 473.15f; // ~200°C ignition temperature
+    gas.burnTemp = 1500.0f; // Very hot when burning
+    gas.burnLife = 10; // Gas burns very quickly
+    gas.burnRate = 2;
+    setProperties(Type::Gas, gas);
+
+    // Acid: Liquid state - corrodes almost everything, has life value
+    PowderParticleProperties acid;
+    acid.matterState = State::Liquid;
+    acid.density = 1.2f; // Slightly denser than water
+    setProperties(Type::Acid, acid);
+
+    // Fire: Gas state - rises up, heats air, ignites flammable particles
+    PowderParticleProperties fire;
+    fire.matterState = State::Gas;
+    fire.density = 0.05f; // Very light, rises quickly
+    fire.movementChance = 0.5f; // 50% chance to move
+    fire.flammable = false; // Fire doesn't ignite itself
+    fire.burnTemp = 1500.0f; // Fire is very hot
+    fire.lifetime = 100;
+    fire.heatsAir = true;
+    fire.draftStrength = 15.0f; // Strong upward impulse (like a draft)
+    fire.rises = true;
+    setProperties(Type::Fire, fire);
+
+    // Smoke: Gas state - rises up, dissipates over time
+    PowderParticleProperties smoke;
+    smoke.matterState = State::Gas;
+    smoke.density = 0.2f; // Heavier than fire but lighter than air
+    smoke.movementChance = 0.4f; // 40% chance to move
+    smoke.flammable = false; // Smoke doesn't burn
+    smoke.lifetime = 200;
+    setProperties(Type::Smoke, smoke);
+
+    // Steam: Gas state - rises up, condenses back to water when cool
+    PowderParticleProperties steam;
+    steam.matterState = State::Gas;
+    steam.density = 0.15f; // Very light, rises quickly
+    steam.movementChance = 0.5f; // 50% chance to move
+    steam.flammable = false; // Steam doesn't burn
+    steam.airHeatRate = 0.02f; // Cools slowly toward the air temperature
+    steam.transitionInto = Type::Water;
+    steam.transitionTemp = BoilingPoint;
+    steam.transitionAbove = false;
+    setProperties(Type::Steam, steam);
+
+    // Mud: Liquid state - very viscous, created from sand and water
+    PowderParticleProperties mud;
+    mud.matterState = State::Liquid;
+    mud.density = 2.5f; // More dense than water, lava, and acid, but less than powders
+    mud.movementChance = 0.15f; // Very viscous - moves horizontally less often than lava
+    mud.flammable = false; // Mud doesn't burn
+    setProperties(Type::Mud, mud);
+
+    // Oil: Liquid state - less dense than water, more viscous than water but less than lava, flammable
+    PowderParticleProperties oil;
+    oil.matterState = State::Liquid;
+    oil.density = 0.8f; // Less dense than water (oil floats on water)
+    oil.movementChance = 0.5f; // More viscous than water, but less than lava
+    oil.flammable = true; // Oil can burn
+    oil.ignitionTemp = 473.15f; // ~200°C ignition temperature (similar to gas)
+    oil.burnTemp = 1200.0f; // Hot when burning
+    oil.burnLife = 30; // Oil burns faster than wood
+    oil.burnRate = 2;
+    setProperties(Type::Oil, oil);
+
+    // Fire and lava ignite flammable neighbors; flammable particles burn next to fire
+    PowderReaction fireIgnites = makeReaction(Kind::Ignite, 0.2f);
+    fireIgnites.chanceAbove = 2.0f / 3.0f; // Fire spreads upward much more readily
+    fireIgnites.chance = 0.2f;
+    for (int i = 1; i < PowderParticleTypeCount; ++i)
+    {
+        const Type type = static_cast<Type>(i);
+        if (!getProperties(type).flammable)
+            continue;
+        setReaction(Type::Fire, type, fireIgnites);
+        setReaction(Type::Lava, type, makeReaction(Kind::Ignite, 1.0f)); // Lava ignites on contact
+        setReaction(type, Type::Fire, makeReaction(Kind::Kindle, 0.1f));
+    }
+
+    // Heating from fire and lava
+    setReaction(Type::Metal, Type::Fire, makeReaction(Kind::HeatSelf, 0.7f));
+    setReaction(Type::Metal, Type::Lava, makeReaction(Kind::HeatSelf, 0.7f));
+    setReaction(Type::Stone, Type::Fire, makeReaction(Kind::HeatSelf, 0.3f));
+    setReaction(Type::Stone, Type::Lava, makeReaction(Kind::HeatSelf, 0.3f));
+    setReaction(Type::Water, Type::Fire, makeReaction(Kind::HeatSelf, 0.2f));
+    setReaction(Type::Lava, Type::Sand, makeReaction(Kind::Heat, 0.4f));
+    setReaction(Type::Lava, Type::Metal, makeReaction(Kind::Heat, 0.8f));
+
+    // Conversions
+    setReaction(Type::Sand, Type::Water, makeConversion(Type::Mud, Type::Mud));
+    setReaction(Type::Fire, Type::Mud, makeConversion(Type::Sand)); // Fire dries mud
+    setReaction(Type::Lava, Type::Mud, makeConversion(Type::Sand));
+    setReaction(Type::Lava, Type::Water, makeConversion(Type::Steam, Type::Stone, BoilingPoint + 50.0f, AmbientTemp));
+
+    // Acid corrodes everything except itself
+    PowderReaction corrode = makeReaction(Kind::Corrode);
+    corrode.chance = 0.15f;
+    corrode.chanceAbove = 0.15f;
+    for (int i = 1; i < PowderParticleTypeCount; ++i)
+    {
+        if (static_cast<Type>(i) != Type::Acid)
+            setReaction(Type::Acid, static_cast<Type>(i), corrode);
+    }
+}
+
+void PowderElementTable::setProperties(PowderParticleType type, const PowderParticleProperties& properties)
+{
+    m_properties[static_cast<int>(type)] = properties;
+}
+
+void PowderElementTable::setReaction(PowderParticleType particle, PowderParticleType neighbor, const PowderReaction& reaction)
+{
+    const int p = static_cast<int>(particle);
+    const int n = static_cast<int>(neighbor);
+    m_reactions[p][n] = reaction;
+    if (reaction.kind == PowderReactionKind::None)
+        m_reactionMasks[p] &= ~(1u << n);
+    else
+        m_reactionMasks[p] |= 1u << n;
+}
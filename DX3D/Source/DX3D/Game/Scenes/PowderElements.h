@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace dx3d
+{
+    // States of matter - base behaviors for particles
+    enum class PowderMatterState : uint8_t
+    {
+        Solid = 0,   // Do not move via non-chemical reactions
+        Powder = 1,  // Only fall via non-chemical reactions, but will not spread as liquids do
+        Liquid = 2,  // Random horizontal movement each frame, then fall down. Can float above denser liquids/powders
+        Gas = 3      // Repels from other gas particles and reacts to other particles (no gravity movement)
+    };
+
+    // Particle types
+    enum class PowderParticleType : uint8_t
+    {
+        Empty = 0,
+        Sand = 1,
+        Water = 2,
+        Stone = 3,
+        Wood = 4,
+        Gas = 5,
+        Acid = 6,
+        Fire = 7,
+        Smoke = 8,
+        Steam = 9,
+        Metal = 10,
+        Lava = 11,
+        Mud = 12,
+        Oil = 13,
+        Count // More types can be added before this
+    };
+
+    constexpr int PowderParticleTypeCount = static_cast<int>(PowderParticleType::Count);
+
+    // Particle behavior properties (data-driven)
+    struct PowderParticleProperties
+    {
+        PowderMatterState matterState = PowderMatterState::Solid;  // Base state of matter
+        float density = 1.0f;
+        float movementChance = 1.0f; // Chance for the particle to attempt movement each frame (0.0 - 1.0)
+        bool flammable = false; // Can this particle be ignited by fire?
+        float ignitionTemp = 500.0f; // Temperature (Kelvin) at which this particle ignites
+        float burnTemp = 1000.0f; // Temperature (Kelvin) this particle produces when burning
+        int burnLife = 50; // Life a particle starts burning with
+        int burnRate = 1; // Life lost per frame while burning
+        int lifetime = 0; // Frames before the particle disappears (fire, smoke); 0 = forever
+        float airHeatRate = 0.0f; // How fast the particle's temperature follows the air around it
+        bool heatsAir = false; // Pulls the air temperature towards burnTemp (fire, lava)
+        float draftStrength = 0.0f; // Upward air impulse around the particle (fire)
+        bool rises = false; // Always prefers to move upward (fire)
+
+        // Temperature-driven change of type (melting, boiling, condensing):
+        // at or above transitionTemp when transitionAbove, otherwise below it
+        PowderParticleType transitionInto = PowderParticleType::Empty;
+        float transitionTemp = 0.0f;
+        bool transitionAbove = true;
+    };
+
+    enum class PowderReactionKind : uint8_t
+    {
+        None = 0,
+        HeatSelf,  // The neighbor heats the particle towards the neighbor's burnTemp (rate * dt)
+        Heat,      // The particle heats the neighbor towards its own burnTemp (rate * dt); the neighbor may transition
+        Ignite,    // The particle heats a flammable neighbor (rate per frame) and sets it alight at its ignitionTemp
+        Kindle,    // A flammable particle next to the neighbor warms up (rate * dt) and burns once hot enough
+        Convert,   // The neighbor becomes product; the particle becomes selfProduct unless that is Empty
+        Corrode    // The neighbor dissolves and the particle loses one life
+    };
+
+    // What happens when a particle sees a neighbor of a given type during its update
+    struct PowderReaction
+    {
+        PowderReactionKind kind = PowderReactionKind::None;
+        float rate = 0.0f;
+        float chance = 1.0f;      // Chance per frame for neighbors level with or below the particle
+        float chanceAbove = 1.0f; // Chance per frame for neighbors above the particle
+        PowderParticleType product = PowderParticleType::Empty;
+        float productTemp = 0.0f; // 0 keeps the neighbor's temperature
+        PowderParticleType selfProduct = PowderParticleType::Empty;
+        float selfProductTemp = 0.0f; // 0 keeps the particle's temperature
+    };
+
+    // Compiled element data: properties indexed by particle type plus a reaction
+    // matrix [particle][neighbor]. New elements and reactions are table entries,
+    // not new branches in the cell update.
+    class PowderElementTable
+    {
+    public:
+        // The default element set
+        PowderElementTable();
+
+        const PowderParticleProperties& getProperties(PowderParticleType type) const { return m_properties[static_cast<int>(type)]; }
+        void setProperties(PowderParticleType type, const PowderParticleProperties& properties);
+
+        const PowderReaction& getReaction(PowderParticleType particle, PowderParticleType neighbor) const
+        {
+            return m_reactions[static_cast<int>(particle)][static_cast<int>(neighbor)];
+        }
+        void setReaction(PowderParticleType particle, PowderParticleType neighbor, const PowderReaction& reaction);
+
+        // Bit n is set when the particle reacts with neighbors of type n
+        uint32_t getReactionMask(PowderParticleType particle) const { return m_reactionMasks[static_cast<int>(particle)]; }
+
+    private:
+        std::array<PowderParticleProperties, PowderParticleTypeCount> m_properties;
+        std::array<std::array<PowderReaction, PowderParticleTypeCount>, PowderParticleTypeCount> m_reactions;
+        std::array<uint32_t, PowderParticleTypeCount> m_reactionMasks{};
+    };
+}
@@ -1,11 +1,14 @@
 #include <DX3D/Game/Scenes/PowderScene.h>
 #include <DX3D/Graphics/GraphicsEngine.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 #include <DX3D/Graphics/SwapChain.h>
 #include <DX3D/Graphics/Camera.h>
 #include <DX3D/Graphics/SpriteComponent.h>
 #include <DX3D/Graphics/LineRenderer.h>
 #include <DX3D/Core/Input.h>
 #include <imgui.h>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <algorithm>
 #include <cstdlib>
@@ -19,8 +22,9 @@ void PowderScene::load(GraphicsEngine& engine)
     m_graphicsDevice = &device;
     m_entityManager = std::make_unique<EntityManager>();
 
-    // Load texture
-    m_nodeTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), L"DX3D/Assets/Textures/node.png");
+    // Cells and air overlays are drawn as one node.png particle batch
+    m_particleBatchDevice = std::make_unique<ParticleBatchDevice>(device);
+    m_nodeMaterial = m_particleBatchDevice->addMaterial(device.getResourceCache().getTexture(L"DX3D/Assets/Textures/node.png"));
 
     // Create camera
     createCamera(engine);
@@ -36,6 +40,10 @@ void PowderScene::load(GraphicsEngine& engine)
         m_lineRenderer->setLinePipeline(linePipeline);
     }
 
+    // One random stream per job system thread
+    m_threadCount = static_cast<int>(JobSystem::getInstance().getThreadCount());
+    m_random.resize(JobSystem::getInstance().getThreadCount());
+
     // Initialize grid
     initializeGrid();
     
@@ -49,6 +57,7 @@ void PowderScene::load(GraphicsEngine& engine)
 void PowderScene::createCamera(GraphicsEngine& engine)
 {
     auto& cameraEntity = m_entityManager->createEntity("MainCamera");
+    m_cameraEntity = cameraEntity.getHandle();
     float screenWidth = GraphicsEngine::getWindowWidth();
     float screenHeight = GraphicsEngine::getWindowHeight();
     auto& camera = cameraEntity.addComponent<Camera2D>(screenWidth, screenHeight);
@@ -58,14 +67,107 @@ void PowderScene::createCamera(GraphicsEngine& engine)
 
 void PowderScene::initializeGrid()
 {
-    m_grid.clear();
-    m_gridNext.clear();
     m_grid.resize(m_gridWidth * m_gridHeight);
     m_gridNext.resize(m_gridWidth * m_gridHeight);
     
     clearGrid();
 }
 
+void PowderScene::resizeGrid(int width, int height)
+{
+    m_gridWidth = width;
+    m_gridHeight = height;
+    m_gridOrigin = Vec2(-0.5f * width * m_cellSize, -0.5f * height * m_cellSize);
+
+    initializeGrid();
+    initializeAirSystem();
+}
+
+void PowderScene::CellPlanes::resize(int count)
+{
+    type.assign(count, ParticleType::Empty);
+    life.assign(count, 0);
+    temperature.assign(count, 273.15f + 22.0f);
+    updatedStamp.assign(count, 0);
+    step = 1;
+}
+
+void PowderScene::CellPlanes::clear()
+{
+    std::fill(type.begin(), type.end(), ParticleType::Empty);
+    std::fill(life.begin(), life.end(), 0);
+    std::fill(temperature.begin(), temperature.end(), 273.15f + 22.0f); // Reset to ambient temperature
+}
+
+void PowderScene::CellPlanes::beginStep()
+{
+    // Stamp 0 is never a live step, so a wrapped counter starts from a clean plane
+    if (++step == 0)
+    {
+        std::fill(updatedStamp.begin(), updatedStamp.end(), 0);
+        step = 1;
+    }
+}
+
+void PowderScene::CellPlanes::copyCells(const CellPlanes& from, int begin, int count)
+{
+    std::copy_n(from.type.begin() + begin, count, type.begin() + begin);
+    std::copy_n(from.life.begin() + begin, count, life.begin() + begin);
+    std::copy_n(from.temperature.begin() + begin, count, temperature.begin() + begin);
+}
+
+void PowderScene::CellPlanes::swap(CellPlanes& other)
+{
+    type.swap(other.type);
+    life.swap(other.life);
+    temperature.swap(other.temperature);
+    updatedStamp.swap(other.updatedStamp);
+    std::swap(step, other.step);
+}
+
+void PowderScene::CellRandom::seed(std::uint64_t value)
+{
+    // splitmix64 finalizer, so neighboring chunk/step seeds give unrelated streams
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    value ^= value >> 31;
+    state = static_cast<std::uint32_t>(value) | 1u; // xorshift state must be non-zero
+}
+
+void PowderScene::seedRandom(int slot, std::uint64_t stream)
+{
+    const std::uint64_t seed = static_cast<std::uint32_t>(m_randomSeed);
+    m_random[slot].seed((seed << 32) ^ (m_stepCount * 0x100000001B3ull) ^ stream);
+}
+
+void PowderScene::syncBackBuffer()
+{
+    // Everywhere else m_gridNext already equals m_grid, so only dirty rows are copied
+    m_dirtyChunkCount = 0;
+    for (Chunk& chunk : m_activity.getChunks())
+    {
+        if (chunk.dirty.isEmpty())
+            continue;
+
+        const int count = chunk.dirty.maxX - chunk.dirty.minX + 1;
+        for (int y = chunk.dirty.minY; y <= chunk.dirty.maxY; ++y)
+        {
+            m_gridNext.copyCells(m_grid, gridIdx(chunk.dirty.minX, y), count);
+        }
+        chunk.dirty = CellRect{};
+        ++m_dirtyChunkCount;
+    }
+}
+
+void PowderScene::wakeFromAir()
+{
+    // Sleeping particles miss air pushes and heat exchange; only chunks where the
+    // air could affect them are tested
+    m_airWakeChunkCount = m_airWake.wake(m_activity, m_elements, m_grid.type.data(), m_grid.temperature.data(),
+        getAirFields(), m_wakeTemperatureDelta, getAirThreadCount());
+}
+
 void PowderScene::initializeAirSystem()
 {
     int gridSize = m_gridWidth * m_gridHeight;
@@ -86,8 +188,17 @@ void PowderScene::initializeAirSystem()
     m_blockAir.resize(gridSize);
     m_blockAirHeat.resize(gridSize);
     
+    // Scratch planes for the stencil passes
+    m_airBlurX.resize(gridSize);
+    m_airBlurY.resize(gridSize);
+    m_airBlurValue.resize(gridSize);
+    m_airCurl.resize(gridSize);
+    
     // Create Gaussian kernel for smoothing
     makeKernel();
+    m_airStencil.resize(m_gridWidth, m_gridHeight);
+    m_airStencil.setKernel(m_airKernel);
+    m_airWake.resize(m_gridWidth, m_gridHeight);
     
     // Clear all air data to ensure zero velocity
     clearAirSystem();
@@ -132,57 +243,42 @@ void PowderScene::clearAirSystem()
     // Clear blocking maps
     std::fill(m_blockAir.begin(), m_blockAir.end(), 0);
     std::fill(m_blockAirHeat.begin(), m_blockAirHeat.end(), 0);
-}
-
-float PowderScene::vorticity(int x, int y) const
-{
-    // Calculate vorticity: dvy/dx - dvx/dy
-    if (x > 1 && x < m_gridWidth - 2 && y > 1 && y < m_gridHeight - 2)
-    {
-        float vx = m_airVelocityX[gridIdx(x, y)];
-        float vy = m_airVelocityY[gridIdx(x, y)];
-        
-        float dvx_dy = m_airVelocityX[gridIdx(x, y + 1)] - m_airVelocityX[gridIdx(x, y - 1)];
-        float dvy_dx = m_airVelocityY[gridIdx(x + 1, y)] - m_airVelocityY[gridIdx(x - 1, y)];
-        
-        return (dvy_dx - dvx_dy) * 0.5f;
-    }
-    return 0.0f;
+    m_blockAirStale = true;
 }
 
 void PowderScene::updateBlockAirMaps()
 {
     // Update blocking maps based on particles
     // Solids block air, some particles block heat
-    for (int y = 0; y < m_gridHeight; ++y)
+    auto updateRect = [this](int minX, int minY, int maxX, int maxY)
     {
-        for (int x = 0; x < m_gridWidth; ++x)
+        for (int y = minY; y <= maxY; ++y)
         {
-            const Cell& cell = getCell(x, y);
-            bool blocksAir = false;
-            bool blocksHeat = false;
-            
-            if (cell.type != ParticleType::Empty)
+            for (int x = minX; x <= maxX; ++x)
             {
-                const ParticleProperties& props = getParticleProperties(cell.type);
-                
-                // Solids block air flow
-                if (props.matterState == MatterState::Solid)
-                {
-                    blocksAir = true;
-                }
+                const ParticleType type = m_grid.type[gridIdx(x, y)];
                 
-                // Most particles block heat to some degree
+                // Solids block air flow and, for now, heat
                 // (In a full implementation, you'd check heat conductivity)
-                if (props.matterState == MatterState::Solid)
-                {
-                    blocksHeat = true;
-                }
+                const bool blocks = type != ParticleType::Empty && getParticleProperties(type).matterState == MatterState::Solid;
+                m_blockAir[gridIdx(x, y)] = blocks ? 1 : 0;
+                m_blockAirHeat[gridIdx(x, y)] = blocks ? 0x8 : 0;
             }
-            
-            m_blockAir[gridIdx(x, y)] = blocksAir ? 1 : 0;
-            m_blockAirHeat[gridIdx(x, y)] = blocksHeat ? 0x8 : 0;
         }
+    };
+    
+    if (m_blockAirStale)
+    {
+        updateRect(0, 0, m_gridWidth - 1, m_gridHeight - 1);
+        m_blockAirStale = false;
+        return;
+    }
+    
+    // Only cells that changed since the last step (the dirty rects) can change blocking
+    for (const Chunk& chunk : m_activity.getChunks())
+    {
+        if (!chunk.dirty.isEmpty())
+            updateRect(chunk.dirty.minX, chunk.dirty.minY, chunk.dirty.maxX, chunk.dirty.maxY);
     }
 }
 
@@ -192,6 +288,8 @@ void PowderScene::updateAirSystem(float dt)
     if (!m_airEnabled || m_airVelocityX.empty() || m_airVelocityY.empty())
         return;
     
+    const auto start = std::chrono::steady_clock::now();
+    
     // Update air pressure and velocity (but don't swap yet)
     updateAirPressure(dt);
     
@@ -206,6 +304,8 @@ void PowderScene::updateAirSystem(float dt)
     
     // Update ambient heat (needs velocity for advection)
     updateAirHeat(dt);
+    
+    m_airStepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 void PowderScene::updateAirPressure(float dt)
@@ -238,165 +338,43 @@ void PowderScene::updateAirPressure(float dt)
         m_airVelocityYNext[gridIdx(i, m_gridHeight - 1)] = 0.0f;
     }
     
-    // Clear velocities near walls
-    for (int y = 1; y < m_gridHeight - 1; ++y)
-    {
-        for (int x = 1; x < m_gridWidth - 1; ++x)
-        {
-            if (m_blockAir[gridIdx(x, y)])
-            {
-                m_airVelocityXNext[gridIdx(x, y)] = 0.0f;
-                m_airVelocityXNext[gridIdx(x - 1, y)] = 0.0f;
-                m_airVelocityXNext[gridIdx(x + 1, y)] = 0.0f;
-                m_airVelocityYNext[gridIdx(x, y)] = 0.0f;
-                m_airVelocityYNext[gridIdx(x, y - 1)] = 0.0f;
-                m_airVelocityYNext[gridIdx(x, y + 1)] = 0.0f;
-            }
-        }
-    }
-    
-    // Pressure adjustments from velocity divergence
-    const float pressureStep = 0.5f;
-    for (int y = 1; y < m_gridHeight - 1; ++y)
+    // Divergence, gradient, smoothing and curl are row stencils; walls clear the
+    // velocity next to them inside the gradient pass
+    const bool vorticityEnabled = m_airVorticityCoeff > 0.0f;
+    JobSystem::getInstance().parallelFor(0, m_gridHeight, AirRowGrain, [&](int begin, int end)
     {
-        for (int x = 1; x < m_gridWidth - 1; ++x)
-        {
-            float dp = 0.0f;
-            dp += m_airVelocityX[gridIdx(x - 1, y)] - m_airVelocityX[gridIdx(x + 1, y)];
-            dp += m_airVelocityY[gridIdx(x, y - 1)] - m_airVelocityY[gridIdx(x, y + 1)];
-            
-            // Apply pressure loss based on magnitude - weak pressures decay faster (spread out)
-            // Strong pressures decay slower, weak spread-out pressures decay much faster
-            float currentPressure = std::abs(m_airPressureNext[gridIdx(x, y)]);
-            float pressureLoss = m_airPressureLoss;
-            
-            if (currentPressure > 20.0f)
-            {
-                // Very strong pressures - minimal loss
-                pressureLoss = 0.98f;
-            }
-            else if (currentPressure > 10.0f)
-            {
-                // Strong pressures - moderate loss
-                pressureLoss = 0.85f;
-            }
-            else if (currentPressure > 2.0f)
-            {
-                // Medium pressures - use default loss
-                pressureLoss = m_airPressureLoss;
-            }
-            else if (currentPressure > 0.5f)
-            {
-                // Weak pressures - faster decay
-                pressureLoss = 0.3f; // 70% loss per frame
-            }
-            else
-            {
-                // Very weak pressures - very fast decay
-                pressureLoss = 0.1f; // 90% loss per frame
-            }
-            
-            m_airPressureNext[gridIdx(x, y)] *= pressureLoss;
-            m_airPressureNext[gridIdx(x, y)] += dp * pressureStep;
-        }
-    }
+        m_airStencil.divergence(m_airVelocityX.data(), m_airVelocityY.data(), m_airPressureNext.data(), m_airPressureLoss, begin, end);
+        m_airStencil.gradient(m_airPressure.data(), m_blockAir.data(), m_airVelocityXNext.data(), m_airVelocityYNext.data(), m_airVelocityLoss, begin, end);
+        m_airStencil.blur(m_airVelocityX.data(), m_blockAir.data(), 1, m_airBlurX.data(), begin, end);
+        m_airStencil.blur(m_airVelocityY.data(), m_blockAir.data(), 1, m_airBlurY.data(), begin, end);
+        m_airStencil.blur(m_airPressure.data(), m_blockAir.data(), 1, m_airBlurValue.data(), begin, end);
+        if (vorticityEnabled)
+            m_airStencil.vorticity(m_airVelocityX.data(), m_airVelocityY.data(), m_airCurl.data(), begin, end);
+    }, getAirThreadCount());
     
-    // Velocity adjustments from pressure gradient
-    const float velocityStep = 0.5f;
-    for (int y = 1; y < m_gridHeight - 1; ++y)
+    // Advection reads the current fields and the smoothed planes and writes one cell of each next buffer
+    JobSystem::getInstance().parallelFor(0, m_gridHeight, AirRowGrain, [&](int begin, int end)
     {
-        for (int x = 1; x < m_gridWidth - 1; ++x)
-        {
-            float dx = 0.0f;
-            float dy = 0.0f;
-            
-            dx += m_airPressure[gridIdx(x - 1, y)] - m_airPressure[gridIdx(x + 1, y)];
-            dy += m_airPressure[gridIdx(x, y - 1)] - m_airPressure[gridIdx(x, y + 1)];
-            
-            // Apply velocity loss based on magnitude - weak velocities decay faster (spread out)
-            // Strong impulses decay slower, weak spread-out velocities decay much faster
-            float currentVelMag = std::sqrt(m_airVelocityXNext[gridIdx(x, y)] * m_airVelocityXNext[gridIdx(x, y)] + 
-                                            m_airVelocityYNext[gridIdx(x, y)] * m_airVelocityYNext[gridIdx(x, y)]);
-            float velocityLoss = m_airVelocityLoss;
-            
-            if (currentVelMag > 10.0f)
-            {
-                // Very strong impulses - minimal loss
-                velocityLoss = 0.98f;
-            }
-            else if (currentVelMag > 5.0f)
-            {
-                // Strong velocities - moderate loss
-                velocityLoss = 0.85f;
-            }
-            else if (currentVelMag > 2.0f)
-            {
-                // Medium velocities - use default loss
-                velocityLoss = m_airVelocityLoss;
-            }
-            else if (currentVelMag > 0.5f)
-            {
-                // Weak velocities - faster decay
-                velocityLoss = 0.3f; // 70% loss per frame
-            }
-            else
-            {
-                // Very weak velocities - very fast decay
-                velocityLoss = 0.1f; // 90% loss per frame
-            }
-            
-            m_airVelocityXNext[gridIdx(x, y)] *= velocityLoss;
-            m_airVelocityYNext[gridIdx(x, y)] *= velocityLoss;
-            m_airVelocityXNext[gridIdx(x, y)] += dx * velocityStep;
-            m_airVelocityYNext[gridIdx(x, y)] += dy * velocityStep;
-            
-            // Block velocity at walls
-            if (m_blockAir[gridIdx(x - 1, y)] || m_blockAir[gridIdx(x, y)] || m_blockAir[gridIdx(x + 1, y)])
-                m_airVelocityXNext[gridIdx(x, y)] = 0.0f;
-            if (m_blockAir[gridIdx(x, y - 1)] || m_blockAir[gridIdx(x, y)] || m_blockAir[gridIdx(x, y + 1)])
-                m_airVelocityYNext[gridIdx(x, y)] = 0.0f;
-        }
-    }
+        advectAirRows(begin, end);
+    }, getAirThreadCount());
     
+    // Don't swap buffers here - let updateAirSystem handle it after convection
+}
+
+void PowderScene::advectAirRows(int rowBegin, int rowEnd)
+{
     // Advection: take values from far away based on velocity
-    for (int y = 0; y < m_gridHeight; ++y)
+    for (int y = rowBegin; y < rowEnd; ++y)
     {
         for (int x = 0; x < m_gridWidth; ++x)
         {
             if (m_blockAir[gridIdx(x, y)])
                 continue;
             
-            // Don't skip advection - always process to allow impulses to propagate
-            // The advection will naturally handle zero velocities correctly
-            
-            // Smooth using kernel
-            float dx = 0.0f;
-            float dy = 0.0f;
-            float dp = 0.0f;
-            
-            for (int j = -1; j <= 1; ++j)
-            {
-                for (int i = -1; i <= 1; ++i)
-                {
-                    int nx = x + i;
-                    int ny = y + j;
-                    
-                    if (nx > 0 && nx < m_gridWidth - 1 && ny > 0 && ny < m_gridHeight - 1 && !m_blockAir[gridIdx(nx, ny)])
-                    {
-                        float f = m_airKernel[(i + 1) + 3 * (j + 1)];
-                        dx += m_airVelocityX[gridIdx(nx, ny)] * f;
-                        dy += m_airVelocityY[gridIdx(nx, ny)] * f;
-                        dp += m_airPressure[gridIdx(nx, ny)] * f;
-                    }
-                    else
-                    {
-                        float f = m_airKernel[(i + 1) + 3 * (j + 1)];
-                        dx += m_airVelocityX[gridIdx(x, y)] * f;
-                        dy += m_airVelocityY[gridIdx(x, y)] * f;
-                        dp += m_airPressure[gridIdx(x, y)] * f;
-                    }
-                }
-            }
+            // Smoothed values from the blur pass
+            float dx = m_airBlurX[gridIdx(x, y)];
+            float dy = m_airBlurY[gridIdx(x, y)];
+            float dp = m_airBlurValue[gridIdx(x, y)];
             
             // Advection: take value from position moved by velocity
             float tx = x - dx * m_airAdvectionMult;
@@ -487,10 +465,10 @@ void PowderScene::updateAirPressure(float dt)
             // Vorticity confinement (adds swirling motion)
             if (m_airVorticityCoeff > 0.0f && x > 1 && x < m_gridWidth - 2 && y > 1 && y < m_gridHeight - 2)
             {
-                float dwx = (std::abs(vorticity(x + 1, y)) - std::abs(vorticity(x - 1, y))) * 0.5f;
-                float dwy = (std::abs(vorticity(x, y + 1)) - std::abs(vorticity(x, y - 1))) * 0.5f;
+                float dwx = (std::abs(m_airCurl[gridIdx(x + 1, y)]) - std::abs(m_airCurl[gridIdx(x - 1, y)])) * 0.5f;
+                float dwy = (std::abs(m_airCurl[gridIdx(x, y + 1)]) - std::abs(m_airCurl[gridIdx(x, y - 1)])) * 0.5f;
                 float norm = std::sqrt(dwx * dwx + dwy * dwy);
-                float w = vorticity(x, y);
+                float w = m_airCurl[gridIdx(x, y)];
                 
                 if (norm > 0.001f)
                 {
@@ -542,40 +520,28 @@ void PowderScene::updateAirPressure(float dt)
             m_airVelocityYNext[gridIdx(x, y)] = dy;
         }
     }
-    
-    // Don't swap buffers here - let updateAirSystem handle it after convection
 }
 
 void PowderScene::updateAirVelocity(float dt)
 {
     // Apply heat convection to velocity (hot air rises, cold air sinks)
     // This is done after pressure update but before swapping
-    for (int y = 2; y < m_gridHeight - 2; ++y)
+    float convGravX = 0.0f;
+    float convGravY = -1.0f; // Gravity points down (Y-up, so negative Y)
+    
+    // Cap gravity magnitude
+    float gravMagn = std::sqrt(convGravX * convGravX + convGravY * convGravY);
+    if (gravMagn > 10.0f)
     {
-        for (int x = 2; x < m_gridWidth - 2; ++x)
-        {
-            if (m_blockAir[gridIdx(x, y)])
-                continue;
-            
-            float convGravX = 0.0f;
-            float convGravY = -1.0f; // Gravity points down (Y-up, so negative Y)
-            
-            // Cap gravity magnitude
-            float gravMagn = std::sqrt(convGravX * convGravX + convGravY * convGravY);
-            if (gravMagn > 10.0f)
-            {
-                convGravX /= 0.1f * gravMagn;
-                convGravY /= 0.1f * gravMagn;
-            }
-            
-            float weight = (m_airHeat[gridIdx(x, y)] - m_ambientAirTemp) / 10000.0f;
-            weight = std::clamp(weight, -0.01f, 0.01f); // Cap for stability
-            
-            // Add convection to velocity (hot air rises)
-            m_airVelocityXNext[gridIdx(x, y)] += weight * convGravX * m_airHeatConvection;
-            m_airVelocityYNext[gridIdx(x, y)] += weight * convGravY * m_airHeatConvection;
-        }
+        convGravX /= 0.1f * gravMagn;
+        convGravY /= 0.1f * gravMagn;
     }
+    
+    JobSystem::getInstance().parallelFor(0, m_gridHeight, AirRowGrain, [&](int begin, int end)
+    {
+        m_airStencil.convection(m_airHeat.data(), m_blockAir.data(), m_airVelocityXNext.data(), m_airVelocityYNext.data(),
+            m_ambientAirTemp, convGravX, convGravY, m_airHeatConvection, begin, end);
+    }, getAirThreadCount());
 }
 
 void PowderScene::updateAirHeat(float dt)
@@ -600,42 +566,37 @@ void PowderScene::updateAirHeat(float dt)
         m_airHeatNext[gridIdx(i, m_gridHeight - 1)] = m_ambientAirTemp;
     }
     
-    // Update heat with advection and convection
-    for (int y = 0; y < m_gridHeight; ++y)
+    // Smooth heat and the (already swapped) velocity with heat blockers as the mask
+    JobSystem::getInstance().parallelFor(0, m_gridHeight, AirRowGrain, [&](int begin, int end)
+    {
+        m_airStencil.blur(m_airHeat.data(), m_blockAirHeat.data(), 0x8, m_airBlurValue.data(), begin, end);
+        m_airStencil.blur(m_airVelocityX.data(), m_blockAirHeat.data(), 0x8, m_airBlurX.data(), begin, end);
+        m_airStencil.blur(m_airVelocityY.data(), m_blockAirHeat.data(), 0x8, m_airBlurY.data(), begin, end);
+    }, getAirThreadCount());
+    
+    JobSystem::getInstance().parallelFor(0, m_gridHeight, AirRowGrain, [&](int begin, int end)
+    {
+        advectAirHeatRows(begin, end);
+    }, getAirThreadCount());
+    
+    // Swap buffers
+    m_airHeat.swap(m_airHeatNext);
+}
+
+void PowderScene::advectAirHeatRows(int rowBegin, int rowEnd)
+{
+    // Update heat with advection
+    for (int y = rowBegin; y < rowEnd; ++y)
     {
         for (int x = 0; x < m_gridWidth; ++x)
         {
             if (m_blockAirHeat[gridIdx(x, y)] & 0x8)
                 continue;
             
-            // Smooth using kernel
-            float dh = 0.0f;
-            float dx = 0.0f;
-            float dy = 0.0f;
-            
-            for (int j = -1; j <= 1; ++j)
-            {
-                for (int i = -1; i <= 1; ++i)
-                {
-                    int nx = x + i;
-                    int ny = y + j;
-                    
-                    if (nx > 0 && nx < m_gridWidth - 1 && ny > 0 && ny < m_gridHeight - 1 && !(m_blockAirHeat[gridIdx(nx, ny)] & 0x8))
-                    {
-                        float f = m_airKernel[(i + 1) + 3 * (j + 1)];
-                        dh += m_airHeat[gridIdx(nx, ny)] * f;
-                        dx += m_airVelocityX[gridIdx(nx, ny)] * f;
-                        dy += m_airVelocityY[gridIdx(nx, ny)] * f;
-                    }
-                    else
-                    {
-                        float f = m_airKernel[(i + 1) + 3 * (j + 1)];
-                        dh += m_airHeat[gridIdx(x, y)] * f;
-                        dx += m_airVelocityX[gridIdx(x, y)] * f;
-                        dy += m_airVelocityY[gridIdx(x, y)] * f;
-                    }
-                }
-            }
+            // Smoothed values from the blur pass
+            float dh = m_airBlurValue[gridIdx(x, y)];
+            float dx = m_airBlurX[gridIdx(x, y)];
+            float dy = m_airBlurY[gridIdx(x, y)];
             
             // Advection: take heat from position moved by velocity
             float tx = x - dx * m_airAdvectionMult;
@@ -719,20 +680,17 @@ void PowderScene::updateAirHeat(float dt)
             m_airHeatNext[gridIdx(x, y)] = dh;
         }
     }
-    
-    // Swap buffers
-    m_airHeat.swap(m_airHeatNext);
 }
 
 void PowderScene::clearGrid()
 {
-    for (auto& cell : m_grid)
-    {
-        cell.type = ParticleType::Empty;
-        cell.updated = false;
-        cell.life = 0;
-        cell.temperature = 273.15f + 22.0f; // Reset to ambient temperature
-    }
+    m_grid.clear();
+    m_gridNext.clear();
+    m_activity.resize(m_gridWidth, m_gridHeight);
+    m_dirtyChunkCount = 0;
+    m_updatedCellCount = 0;
+    m_blockAirStale = true;
+    m_airWake.invalidate();
     
     // Also clear air system
     if (m_airEnabled)
@@ -754,7 +712,7 @@ Vec2 PowderScene::gridToWorld(int x, int y) const
 
 Vec2 PowderScene::getMouseWorldPosition() const
 {
-    auto* cameraEntity = m_entityManager->findEntity("MainCamera");
+    auto* cameraEntity = m_entityManager->getEntity(m_cameraEntity);
     if (!cameraEntity) return Vec2(0.0f, 0.0f);
     auto* cam = cameraEntity->getComponent<Camera2D>();
     if (!cam) return Vec2(0.0f, 0.0f);
@@ -775,7 +733,7 @@ void PowderScene::update(float dt)
     m_smoothDt = (1.0f - alpha) * m_smoothDt + alpha * std::max(1e-6f, dt);
 
     // Camera controls
-    if (auto* camEnt = m_entityManager->findEntity("MainCamera"))
+    if (auto* camEnt = m_entityManager->getEntity(m_cameraEntity))
     {
         if (auto* cam = camEnt->getComponent<Camera2D>())
         {
@@ -809,7 +767,7 @@ void PowderScene::update(float dt)
             int toEmit = (int)m_emitAccumulator;
             if (toEmit > 0)
             {
-                addParticlesAt(mouseWorld, m_currentParticleType, m_brushRadius);
+                submitEdit(PowderEditKind::Paint, mouseWorld);
                 m_emitAccumulator -= toEmit;
             }
             break;
@@ -820,12 +778,11 @@ void PowderScene::update(float dt)
             // Add air impulse continuously while holding
             if (m_airEnabled)
             {
-                static float impulseAccumulator = 0.0f;
-                impulseAccumulator += dt;
-                if (impulseAccumulator >= 0.05f) // Limit to 20 impulses per second
+                m_impulseAccumulator += dt;
+                if (m_impulseAccumulator >= 0.05f) // Limit to 20 impulses per second
                 {
-                    createAirImpulse(mouseWorld, m_impulseStrength, m_brushRadius);
-                    impulseAccumulator = 0.0f;
+                    submitEdit(PowderEditKind::Impulse, mouseWorld);
+                    m_impulseAccumulator = 0.0f;
                 }
             }
             break;
@@ -834,27 +791,7 @@ void PowderScene::update(float dt)
         case ToolType::Clear:
         {
             // Clear particles
-            Vec2 gridPos = worldToGrid(mouseWorld);
-            int gx = (int)std::floor(gridPos.x);
-            int gy = (int)std::floor(gridPos.y);
-            int radius = (int)(m_brushRadius / m_cellSize);
-            
-            for (int dy = -radius; dy <= radius; ++dy)
-            {
-                for (int dx = -radius; dx <= radius; ++dx)
-                {
-                    int x = gx + dx;
-                    int y = gy + dy;
-                    if (isValidGridPos(x, y))
-                    {
-                        float dist2 = (float)(dx * dx + dy * dy);
-                        if (dist2 <= radius * radius)
-                        {
-                            getCell(x, y).type = ParticleType::Empty;
-                        }
-                    }
-                }
-            }
+            submitEdit(PowderEditKind::Erase, mouseWorld);
             break;
         }
         }
@@ -867,35 +804,94 @@ void PowderScene::update(float dt)
     // Right mouse button always clears particles
     if (input.isMouseDown(MouseClick::RightMouse))
     {
-        Vec2 mouseWorld = getMouseWorldPosition();
-        Vec2 gridPos = worldToGrid(mouseWorld);
-        int gx = (int)std::floor(gridPos.x);
-        int gy = (int)std::floor(gridPos.y);
-        int radius = (int)(m_brushRadius / m_cellSize);
-        
-        for (int dy = -radius; dy <= radius; ++dy)
+        submitEdit(PowderEditKind::Erase, getMouseWorldPosition());
+    }
+}
+
+void PowderScene::submitEdit(PowderEditKind kind, const Vec2& worldPos)
+{
+    // A replay owns the world while it plays
+    if (m_replayMode == ReplayMode::Playing)
+        return;
+
+    Vec2 gridPos = worldToGrid(worldPos);
+    PowderReplayEvent edit;
+    edit.step = m_stepCount;
+    edit.kind = kind;
+    edit.particleType = static_cast<std::uint8_t>(m_currentParticleType);
+    edit.x = (int)std::floor(gridPos.x);
+    edit.y = (int)std::floor(gridPos.y);
+    edit.radius = (int)(m_brushRadius / m_cellSize);
+    edit.strength = m_impulseStrength;
+    applyEdit(edit);
+}
+
+void PowderScene::applyEdit(const PowderReplayEvent& edit)
+{
+    if (m_replayMode == ReplayMode::Recording)
+        m_replay.events.push_back(edit);
+
+    switch (edit.kind)
+    {
+    case PowderEditKind::Paint:
+        addParticlesAt(edit.x, edit.y, edit.radius, static_cast<ParticleType>(edit.particleType));
+        break;
+    case PowderEditKind::Erase:
+        eraseParticlesAt(edit.x, edit.y, edit.radius);
+        break;
+    case PowderEditKind::Impulse:
+        if (m_airEnabled)
         {
-            for (int dx = -radius; dx <= radius; ++dx)
+            createAirImpulse(edit.x, edit.y, edit.radius, edit.strength);
+            // Particles only feel the impulse while they are awake
+            m_activity.wake(edit.x - edit.radius, edit.y - edit.radius, edit.x + edit.radius, edit.y + edit.radius);
+        }
+        break;
+    }
+}
+
+void PowderScene::eraseParticlesAt(int gx, int gy, int radiusCells)
+{
+    for (int dy = -radiusCells; dy <= radiusCells; ++dy)
+    {
+        for (int dx = -radiusCells; dx <= radiusCells; ++dx)
+        {
+            int x = gx + dx;
+            int y = gy + dy;
+            if (isValidGridPos(x, y))
             {
-                int x = gx + dx;
-                int y = gy + dy;
-                if (isValidGridPos(x, y))
+                float dist2 = (float)(dx * dx + dy * dy);
+                if (dist2 <= radiusCells * radiusCells)
                 {
-                    float dist2 = (float)(dx * dx + dy * dy);
-                    if (dist2 <= radius * radius)
-                    {
-                        getCell(x, y).type = ParticleType::Empty;
-                    }
+                    getCell(x, y).type = ParticleType::Empty;
                 }
             }
         }
     }
+    m_activity.markChanged(gx - radiusCells, gy - radiusCells, gx + radiusCells, gy + radiusCells);
 }
 
 void PowderScene::fixedUpdate(float dt)
 {
     if (m_paused) return;
 
+    if (m_replayMode == ReplayMode::Playing)
+    {
+        // Edits recorded between two fixed updates are due before the next one
+        applyReplayEvents();
+        if (m_replayUpdates == m_replay.fixedUpdates)
+        {
+            finishReplay();
+            return;
+        }
+        dt = m_replay.settings.fixedDt;
+    }
+    else if (m_replayMode == ReplayMode::Recording)
+    {
+        m_replay.settings.fixedDt = dt;
+    }
+    ++m_replayUpdates;
+
     const int steps = std::max(1, m_substeps);
     const float h = dt / static_cast<float>(steps);
 
@@ -906,11 +902,23 @@ void PowderScene::fixedUpdate(float dt)
         {
             updateBlockAirMaps();
         }
+        else
+        {
+            m_blockAirStale = true; // this step's dirty rects are not applied to the maps
+        }
         
         // Update air system (pressure, velocity, heat)
         if (m_airEnabled)
         {
             updateAirSystem(h);
+            if (m_cellSleeping)
+                wakeFromAir();
+            else
+                m_airWake.invalidate(); // the air changed without being checked
+        }
+        else
+        {
+            m_airWake.invalidate();
         }
         
         // Update particle positions and interactions
@@ -920,94 +928,179 @@ void PowderScene::fixedUpdate(float dt)
 
 void PowderScene::updateGrid(float dt)
 {
-    // Copy grid to next frame (for double buffering)
-    // We read from m_grid (old state) and write to m_gridNext (new state)
-    std::copy(m_grid.begin(), m_grid.end(), m_gridNext.begin());
+    // Double buffering: we read from m_grid (old state) and write to m_gridNext (new state).
+    // Outside the cells changed last step the buffers are already equal, so only those
+    // are copied, and the updated flags are invalidated by bumping the step stamp.
+    syncBackBuffer();
+    m_gridNext.beginStep();
+    ++m_stepCount;
 
-    // Clear updated flags in new grid (preserve life values from copy)
-    for (auto& cell : m_gridNext)
+    if (!m_cellSleeping)
     {
-        cell.updated = false;
+        m_activity.wake(0, 0, m_gridWidth - 1, m_gridHeight - 1);
     }
 
     // Update particles bottom-to-top (or alternating pattern for better flow)
     // In Y-up coordinate system, bottom is Y=0, top is Y=height-1
-    int yStart = 0;
-    int yEnd = m_gridHeight;
-    int yStep = 1;
-    
-    if (m_alternateUpdate)
-    {
-        // Alternate between bottom-to-top and top-to-bottom
-        static bool alt = false;
-        alt = !alt;
-        if (alt)
-        {
-            yStart = m_gridHeight - 1;
-            yEnd = -1;
-            yStep = -1;
-        }
-    }
-
-    // Update all particles
-    // Read from m_grid, modify m_gridNext
-    for (int y = yStart; y != yEnd; y += yStep)
-    {
-        // Alternate X direction too for better flow
-        int xStart = (std::abs(y) % 2 == 0) ? 0 : m_gridWidth - 1;
-        int xEnd = (std::abs(y) % 2 == 0) ? m_gridWidth : -1;
-        int xStep = (std::abs(y) % 2 == 0) ? 1 : -1;
-
-        for (int x = xStart; x != xEnd; x += xStep)
-        {
-            // Read from old grid
-            const Cell& oldCell = m_grid[gridIdx(x, y)];
-            if (oldCell.type == ParticleType::Empty)
-                continue;
-
-            // Check if already processed in new grid (might have moved here)
-            Cell& newCell = m_gridNext[gridIdx(x, y)];
-            if (newCell.updated)
-                continue;
+    const bool topDown = m_alternateUpdate && (m_stepCount % 2 == 1);
 
-            newCell.updated = true;
+    if (m_parallelUpdate)
+        m_updatedCellCount = updateChunksParallel(dt, topDown);
+    else
+        m_updatedCellCount = updateCellsSerial(dt, topDown);
 
-            // Update particle using unified update function
-            updateParticle(x, y, dt);
-        }
-    }
+    m_activity.collectChanges(CellWriteReach, [this](int idx) { return m_grid.differs(m_gridNext, idx); });
 
     // Swap grids
     m_grid.swap(m_gridNext);
 }
 
-bool PowderScene::tryMove(int x, int y, int newX, int newY)
+bool PowderScene::updateCell(int x, int y, float dt)
 {
-    if (!isValidGridPos(newX, newY))
+    // Read from old grid
+    if (m_grid.type[gridIdx(x, y)] == ParticleType::Empty)
         return false;
 
-    // Read source from old grid (where particle currently is)
-    const Cell& src = m_grid[gridIdx(x, y)];
-    if (src.type == ParticleType::Empty)
+    // Sleeping cells inside an awake rect stay put until something wakes them
+    if (!m_activity.isAwake(x, y))
         return false;
 
-    // Check destination in new grid
-    Cell& dst = m_gridNext[gridIdx(newX, newY)];
-
-    if (dst.type != ParticleType::Empty || dst.updated)
+    // Check if already processed in new grid (might have moved here)
+    CellRef newCell = m_gridNext[gridIdx(x, y)];
+    if (newCell.isUpdated())
         return false;
 
-    // Move particle from old position to new position
-    dst.type = src.type;
-    dst.life = src.life; // Preserve life value
-    dst.temperature = src.temperature; // Preserve temperature
-    dst.updated = true;
+    newCell.markUpdated();
 
-    // Clear source in new grid (particle has moved)
-    Cell& srcNew = m_gridNext[gridIdx(x, y)];
-    srcNew.type = ParticleType::Empty;
-    srcNew.life = 0;
-    srcNew.temperature = 273.15f + 22.0f; // Reset to ambient temperature
+    // Update particle using unified update function
+    updateParticle(x, y, dt);
+    return true;
+}
+
+int PowderScene::updateCellsSerial(float dt, bool topDown)
+{
+    seedRandom(0, ~0ull);
+
+    int yStart = topDown ? m_gridHeight - 1 : 0;
+    int yEnd = topDown ? -1 : m_gridHeight;
+    int yStep = topDown ? -1 : 1;
+
+    // Update the awake cells, keeping the full-grid scan order
+    // Read from m_grid, modify m_gridNext
+    int updatedCells = 0;
+    for (int y = yStart; y != yEnd; y += yStep)
+    {
+        // Alternate X direction too for better flow
+        const bool forward = (std::abs(y) % 2 == 0);
+        const int chunksX = m_activity.getChunksX();
+        const Chunk* chunkRow = &m_activity.getChunks()[(y / ChunkSize) * chunksX];
+
+        for (int i = 0; i < chunksX; ++i)
+        {
+            const CellRect& awake = chunkRow[forward ? i : chunksX - 1 - i].awake;
+            if (awake.isEmpty() || y < awake.minY || y > awake.maxY)
+                continue;
+
+            int xStart = forward ? awake.minX : awake.maxX;
+            int xEnd = forward ? awake.maxX + 1 : awake.minX - 1;
+            int xStep = forward ? 1 : -1;
+
+            for (int x = xStart; x != xEnd; x += xStep)
+            {
+                if (updateCell(x, y, dt))
+                    ++updatedCells;
+            }
+        }
+    }
+    return updatedCells;
+}
+
+int PowderScene::updateChunksParallel(float dt, bool topDown)
+{
+    // Same-phase chunks are a whole chunk apart. Updates read and write at most
+    // UpdateWriteReach cells away (grid cells and the fire draft's air cells), so
+    // their footprints never overlap.
+    static_assert(ChunkSize > 2 * UpdateWriteReach, "checkerboard phases need chunks wider than twice the update reach");
+
+    std::atomic<int> updatedCells{ 0 };
+    for (int phase = 0; phase < 4; ++phase)
+    {
+        m_phaseChunks.clear();
+        const int chunksX = m_activity.getChunksX();
+        for (int cy = phase / 2; cy < m_activity.getChunksY(); cy += 2)
+        {
+            for (int cx = phase % 2; cx < chunksX; cx += 2)
+            {
+                if (!m_activity.getChunks()[cy * chunksX + cx].awake.isEmpty())
+                    m_phaseChunks.push_back(cy * chunksX + cx);
+            }
+        }
+
+        JobSystem::getInstance().parallelFor(0, (int)m_phaseChunks.size(), 1, [&](int begin, int end)
+        {
+            int count = 0;
+            for (int i = begin; i < end; ++i)
+                count += updateChunk(m_phaseChunks[i], dt, topDown);
+            updatedCells.fetch_add(count, std::memory_order_relaxed);
+        }, std::max(1, m_threadCount));
+    }
+    return updatedCells.load(std::memory_order_relaxed);
+}
+
+int PowderScene::updateChunk(int chunkIndex, float dt, bool topDown)
+{
+    seedRandom(JobSystem::getInstance().getThreadIndex(), static_cast<std::uint64_t>(chunkIndex));
+
+    const CellRect& awake = m_activity.getChunks()[chunkIndex].awake;
+    int yStart = topDown ? awake.maxY : awake.minY;
+    int yEnd = topDown ? awake.minY - 1 : awake.maxY + 1;
+    int yStep = topDown ? -1 : 1;
+
+    int updatedCells = 0;
+    for (int y = yStart; y != yEnd; y += yStep)
+    {
+        // Alternate X direction too for better flow
+        const bool forward = (std::abs(y) % 2 == 0);
+        int xStart = forward ? awake.minX : awake.maxX;
+        int xEnd = forward ? awake.maxX + 1 : awake.minX - 1;
+        int xStep = forward ? 1 : -1;
+
+        for (int x = xStart; x != xEnd; x += xStep)
+        {
+            if (updateCell(x, y, dt))
+                ++updatedCells;
+        }
+    }
+    return updatedCells;
+}
+
+bool PowderScene::tryMove(int x, int y, int newX, int newY)
+{
+    if (!isValidGridPos(newX, newY))
+        return false;
+
+    // Read source from old grid (where particle currently is)
+    ConstCellRef src = m_grid[gridIdx(x, y)];
+    if (src.type == ParticleType::Empty)
+        return false;
+
+    // Check destination in new grid
+    CellRef dst = m_gridNext[gridIdx(newX, newY)];
+
+    if (dst.type != ParticleType::Empty || dst.isUpdated())
+        return false;
+
+    // Move particle from old position to new position
+    dst.type = src.type;
+    dst.life = src.life; // Preserve life value
+    dst.temperature = src.temperature; // Preserve temperature
+    dst.markUpdated();
+
+    // Clear source in new grid (particle has moved)
+    CellRef srcNew = m_gridNext[gridIdx(x, y)];
+    srcNew.type = ParticleType::Empty;
+    srcNew.life = 0;
+    srcNew.temperature = 273.15f + 22.0f; // Reset to ambient temperature
 
     // Add particle movement to air (particles push air when they move)
     if (m_airEnabled)
@@ -1028,8 +1121,8 @@ bool PowderScene::trySwap(int x, int y, int newX, int newY)
         return false;
 
     // Read from old grid
-    const Cell& srcOld = m_grid[gridIdx(x, y)];
-    const Cell& dstOld = m_grid[gridIdx(newX, newY)];
+    ConstCellRef srcOld = m_grid[gridIdx(x, y)];
+    ConstCellRef dstOld = m_grid[gridIdx(newX, newY)];
 
     if (srcOld.type == ParticleType::Empty || dstOld.type == ParticleType::Empty)
         return false;
@@ -1051,23 +1144,23 @@ bool PowderScene::trySwap(int x, int y, int newX, int newY)
         return false;
 
     // Check if destination is already updated in new grid (source is being updated now, so ignore its flag)
-    Cell& srcNew = m_gridNext[gridIdx(x, y)];
-    Cell& dstNew = m_gridNext[gridIdx(newX, newY)];
+    CellRef srcNew = m_gridNext[gridIdx(x, y)];
+    CellRef dstNew = m_gridNext[gridIdx(newX, newY)];
 
     // Only check destination - source is currently being processed
-    if (dstNew.updated)
+    if (dstNew.isUpdated())
         return false;
 
     // Swap particles in new grid (denser particle sinks, lighter rises)
     srcNew.type = dstOld.type;
     srcNew.life = dstOld.life; // Preserve life values
     srcNew.temperature = dstOld.temperature; // Preserve temperature
-    srcNew.updated = true;
+    srcNew.markUpdated();
 
     dstNew.type = srcOld.type;
     dstNew.life = srcOld.life; // Preserve life values
     dstNew.temperature = srcOld.temperature; // Preserve temperature
-    dstNew.updated = true;
+    dstNew.markUpdated();
 
     // Add particle swap movement to air (particles push air when they swap)
     if (m_airEnabled)
@@ -1099,497 +1192,208 @@ bool PowderScene::trySwap(int x, int y, int newX, int newY)
 
 void PowderScene::initializeParticleProperties()
 {
-    // Sand: Powder state - falls down, can swap with less dense particles, but doesn't spread horizontally
-    ParticleProperties sand;
-    sand.matterState = MatterState::Powder;
-    sand.density = 3.0f;
-    sand.color = Vec4(0.9f, 0.8f, 0.5f, 1.0f); // Yellowish sand
-    m_particleProperties[ParticleType::Sand] = sand;
-
-    // Water: Liquid state - random horizontal movement, falls down, can float above denser liquids/powders
-    ParticleProperties water;
-    water.matterState = MatterState::Liquid;
-    water.density = 1.0f;
-    water.color = Vec4(0.2f, 0.6f, 1.0f, 0.8f); // Blue water
-    m_particleProperties[ParticleType::Water] = water;
-
-    // Metal: Solid state - does not move via non-chemical reactions (formerly Stone)
-    ParticleProperties metal;
-    metal.matterState = MatterState::Solid;
-    metal.density = 10.0f;
-    metal.color = Vec4(0.3f, 0.3f, 0.3f, 1.0f); // Darker gray metal
-    m_particleProperties[ParticleType::Metal] = metal;
-
-    // Stone: Powder state - falls down like sand, melts into lava when hot
-    ParticleProperties stone;
-    stone.matterState = MatterState::Powder;
-    stone.density = 4.0f; // Denser than lava (stone sinks in lava)
-    stone.color = Vec4(0.5f, 0.5f, 0.5f, 1.0f); // Gray stone
-    stone.flammable = false; // Stone cannot ignite
-    m_particleProperties[ParticleType::Stone] = stone;
-
-    // Lava: Liquid state - hot molten rock, converts other particles
-    ParticleProperties lava;
-    lava.matterState = MatterState::Liquid;
-    lava.density = 3.0f; // Same density as sand (so they don't sink through each other)
-    lava.color = Vec4(1.0f, 0.6f, 0.0f, 1.0f); // More orange lava
-    lava.movementChance = 0.3f; // More viscous - moves horizontally less often
-    lava.flammable = false; // Lava doesn't burn
-    lava.burnTemp = 1500.0f; // Lava is very hot
-    m_particleProperties[ParticleType::Lava] = lava;
-
-    // Wood: Solid state - does not move via non-chemical reactions
-    ParticleProperties wood;
-    wood.matterState = MatterState::Solid;
-    wood.density = 0.8f;
-    wood.color = Vec4(0.4f, 0.25f, 0.1f, 1.0f); // Brown wood
-    wood.flammable = true; // Wood can burn
-    wood.ignitionTemp = 573.15f; // ~300°C ignition temperature
-    wood.burnTemp = 1200.0f; // Hot when burning
-    m_particleProperties[ParticleType::Wood] = wood;
-
-    // Gas: Gas state - moves opposite to gravity (upward), repels from other gas particles
-    ParticleProperties gas;
-    gas.matterState = MatterState::Gas;
-    gas.density = 0.1f; // Very light
-    gas.color = Vec4(204.0f / 255.0f, 153.0f / 255.0f, 153.0f / 255.0f, 1.0f); // Light pink/rose, fully opaque
-    gas.movementChance = 0.3f; // 30% chance to move each frame (makes gas move slower)
-    gas.flammable = true; // Gas can burn
-    gas.ignitionTemp = 473.15f; // ~200°C ignition temperature
-    gas.burnTemp = 1500.0f; // Very hot when burning
-    m_particleProperties[ParticleType::Gas] = gas;
-
-    // Acid: Liquid state - corrodes almost everything, has life value
-    ParticleProperties acid;
-    acid.matterState = MatterState::Liquid;
-    acid.density = 1.2f; // Slightly denser than water
-    acid.color = Vec4(204.0f / 255.0f, 255.0f / 255.0f, 0.0f / 255.0f, 1.0f); // CCFF00 - bright yellow-green
-    m_particleProperties[ParticleType::Acid] = acid;
-
-    // Fire: Gas state - rises up, heats air, ignites flammable particles
-    ParticleProperties fire;
-    fire.matterState = MatterState::Gas;
-    fire.density = 0.05f; // Very light, rises quickly
-    fire.color = Vec4(1.0f, 0.3f, 0.0f, 1.0f); // Orange-red fire
-    fire.movementChance = 0.5f; // 50% chance to move
-    fire.flammable = false; // Fire doesn't ignite itself
-    fire.burnTemp = 1500.0f; // Fire is very hot
-    m_particleProperties[ParticleType::Fire] = fire;
-
-    // Smoke: Gas state - rises up, dissipates over time
-    ParticleProperties smoke;
-    smoke.matterState = MatterState::Gas;
-    smoke.density = 0.2f; // Heavier than fire but lighter than air
-    smoke.color = Vec4(0.2f, 0.2f, 0.2f, 0.8f); // Dark gray smoke
-    smoke.movementChance = 0.4f; // 40% chance to move
-    smoke.flammable = false; // Smoke doesn't burn
-    m_particleProperties[ParticleType::Smoke] = smoke;
-
-    // Steam: Gas state - rises up, condenses back to water when cool
-    ParticleProperties steam;
-    steam.matterState = MatterState::Gas;
-    steam.density = 0.15f; // Very light, rises quickly
-    steam.color = Vec4(0.9f, 0.9f, 0.95f, 0.7f); // Light white/blue steam
-    steam.movementChance = 0.5f; // 50% chance to move
-    steam.flammable = false; // Steam doesn't burn
-    m_particleProperties[ParticleType::Steam] = steam;
-
-    // Mud: Liquid state - very viscous, created from sand and water
-    ParticleProperties mud;
-    mud.matterState = MatterState::Liquid;
-    mud.density = 2.5f; // More dense than water, lava, and acid, but less than powders
-    mud.color = Vec4(0.4f, 0.3f, 0.2f, 1.0f); // Brown mud color
-    mud.movementChance = 0.15f; // Very viscous - moves horizontally less often than lava
-    mud.flammable = false; // Mud doesn't burn
-    m_particleProperties[ParticleType::Mud] = mud;
-
-    // Oil: Liquid state - less dense than water, more viscous than water but less than lava, flammable
-    ParticleProperties oil;
-    oil.matterState = MatterState::Liquid;
-    oil.density = 0.8f; // Less dense than water (oil floats on water)
-    oil.color = Vec4(0.1f, 0.1f, 0.1f, 1.0f); // Dark/black oil color
-    oil.movementChance = 0.5f; // More viscous than water, but less than lava
-    oil.flammable = true; // Oil can burn
-    oil.ignitionTemp = 473.15f; // ~200°C ignition temperature (similar to gas)
-    oil.burnTemp = 1200.0f; // Hot when burning
-    m_particleProperties[ParticleType::Oil] = oil;
-}
-
-const PowderScene::ParticleProperties& PowderScene::getParticleProperties(ParticleType type) const
-{
-    auto it = m_particleProperties.find(type);
-    if (it != m_particleProperties.end())
-    {
-        return it->second;
-    }
-    
-    // Return default properties if not found
-    static ParticleProperties defaultProps;
-    return defaultProps;
-}
-
-bool PowderScene::canCorrode(ParticleType type) const
-{
-    // Acid can corrode almost everything except itself and empty
-    // In the future, we can add particles that resist corrosion
-    if (type == ParticleType::Empty || type == ParticleType::Acid)
-        return false;
-    
-    // For now, acid corrodes everything else
-    // TODO: Add corrosion-resistant particles in the future
-    return true;
+    // Physical properties and reactions come from m_elements; the scene only adds colors
+    m_particleColors.fill(Vec4(0.0f, 0.0f, 0.0f, 0.0f)); // Empty cells are transparent
+    m_particleColors[(int)ParticleType::Sand] = Vec4(0.9f, 0.8f, 0.5f, 1.0f); // Yellowish sand
+    m_particleColors[(int)ParticleType::Water] = Vec4(0.2f, 0.6f, 1.0f, 0.8f); // Blue water
+    m_particleColors[(int)ParticleType::Metal] = Vec4(0.3f, 0.3f, 0.3f, 1.0f); // Darker gray metal
+    m_particleColors[(int)ParticleType::Stone] = Vec4(0.5f, 0.5f, 0.5f, 1.0f); // Gray stone
+    m_particleColors[(int)ParticleType::Lava] = Vec4(1.0f, 0.6f, 0.0f, 1.0f); // More orange lava
+    m_particleColors[(int)ParticleType::Wood] = Vec4(0.4f, 0.25f, 0.1f, 1.0f); // Brown wood
+    m_particleColors[(int)ParticleType::Gas] = Vec4(204.0f / 255.0f, 153.0f / 255.0f, 153.0f / 255.0f, 1.0f); // Light pink/rose, fully opaque
+    m_particleColors[(int)ParticleType::Acid] = Vec4(204.0f / 255.0f, 255.0f / 255.0f, 0.0f / 255.0f, 1.0f); // CCFF00 - bright yellow-green
+    m_particleColors[(int)ParticleType::Fire] = Vec4(1.0f, 0.3f, 0.0f, 1.0f); // Orange-red fire
+    m_particleColors[(int)ParticleType::Smoke] = Vec4(0.2f, 0.2f, 0.2f, 0.8f); // Dark gray smoke
+    m_particleColors[(int)ParticleType::Steam] = Vec4(0.9f, 0.9f, 0.95f, 0.7f); // Light white/blue steam
+    m_particleColors[(int)ParticleType::Mud] = Vec4(0.4f, 0.3f, 0.2f, 1.0f); // Brown mud color
+    m_particleColors[(int)ParticleType::Oil] = Vec4(0.1f, 0.1f, 0.1f, 1.0f); // Dark/black oil color
 }
 
-void PowderScene::updateFireAndIgnition(int x, int y, float dt)
+void PowderScene::applyFireDraft(int x, int y, float strength, float dt)
 {
-    const Cell& oldCell = m_grid[gridIdx(x, y)];
-    Cell& newCell = m_gridNext[gridIdx(x, y)];
+    // Fire creates strong upward impulse (like a draft) that affects particles
+    // Create an upward impulse in a radius around the fire
+    const int fireImpulseRadius = FireDraftRadius; // Radius in cells; bounds the parallel chunk update
     
-    // Handle fire particles
-    if (oldCell.type == ParticleType::Fire)
+    // Add upward impulse to air system in a radius around fire
+    for (int dy = -fireImpulseRadius; dy <= fireImpulseRadius; ++dy)
     {
-        // Fire heats up air and creates upward draft/impulse
-        if (m_airEnabled)
+        for (int dx = -fireImpulseRadius; dx <= fireImpulseRadius; ++dx)
         {
-            const ParticleProperties& fireProps = getParticleProperties(ParticleType::Fire);
-            int idx = gridIdx(x, y);
+            int nx = x + dx;
+            int ny = y + dy;
+            
+            if (!isValidGridPos(nx, ny))
+                continue;
             
-            // Heat up air at fire location
-            float heatIncrease = fireProps.burnTemp - m_ambientAirTemp;
-            m_airHeatNext[idx] += heatIncrease * 0.1f * dt; // Gradually heat up
-            m_airHeatNext[idx] = std::min(m_airHeatNext[idx], fireProps.burnTemp);
+            // Skip if blocked by solid
+            if (m_blockAir[gridIdx(nx, ny)])
+                continue;
             
-            // Fire creates strong upward impulse (like a draft) that affects particles
-            // Create an upward impulse in a radius around the fire
-            const float fireImpulseStrength = 15.0f; // Strong upward impulse
-            const int fireImpulseRadius = 3; // Radius in cells
+            float dist2 = (float)(dx * dx + dy * dy);
+            float r2 = (float)(fireImpulseRadius * fireImpulseRadius);
             
-            // Add upward impulse to air system in a radius around fire
-            for (int dy = -fireImpulseRadius; dy <= fireImpulseRadius; ++dy)
+            if (dist2 <= r2)
             {
-                for (int dx = -fireImpulseRadius; dx <= fireImpulseRadius; ++dx)
-                {
-                    int nx = x + dx;
-                    int ny = y + dy;
-                    
-                    if (!isValidGridPos(nx, ny))
-                        continue;
-                    
-                    // Skip if blocked by solid
-                    if (m_blockAir[gridIdx(nx, ny)])
-                        continue;
-                    
-                    float dist2 = (float)(dx * dx + dy * dy);
-                    float r2 = (float)(fireImpulseRadius * fireImpulseRadius);
-                    
-                    if (dist2 <= r2)
-                    {
-                        // Calculate distance from fire
-                        float dist = std::sqrt(dist2);
-                        if (dist < 0.001f) dist = 0.001f; // Avoid division by zero
-                        
-                        float normalizedDist = dist / (float)fireImpulseRadius;
-                        if (normalizedDist > 1.0f) normalizedDist = 1.0f;
-                        
-                        // Strength falls off with distance (stronger at center, weaker at edges)
-                        // But always upward
-                        float impulseStrength = fireImpulseStrength * (1.0f - normalizedDist * 0.7f); // Keep some strength even at edges
-                        
-                        int nIdx = gridIdx(nx, ny);
-                        
-                        // Add upward velocity impulse (always upward, Y+ direction)
-                        // Write to both current and next buffers for immediate effect
-                        m_airVelocityY[nIdx] += impulseStrength * dt;
-                        m_airVelocityYNext[nIdx] += impulseStrength * dt;
-                        
-                        // Add some pressure (creates upward push)
-                        float pressureStrength = fireImpulseStrength * 0.3f * (1.0f - normalizedDist * 0.7f);
-                        m_airPressure[nIdx] += pressureStrength * dt;
-                        m_airPressureNext[nIdx] += pressureStrength * dt;
-                    }
-                }
+                // Calculate distance from fire
+                float dist = std::sqrt(dist2);
+                if (dist < 0.001f) dist = 0.001f; // Avoid division by zero
+                
+                float normalizedDist = dist / (float)fireImpulseRadius;
+                if (normalizedDist > 1.0f) normalizedDist = 1.0f;
+                
+                // Strength falls off with distance (stronger at center, weaker at edges)
+                // But always upward
+                float impulseStrength = strength * (1.0f - normalizedDist * 0.7f); // Keep some strength even at edges
+                
+                int nIdx = gridIdx(nx, ny);
+                
+                // Add upward velocity impulse (always upward, Y+ direction)
+                // Write to both current and next buffers for immediate effect
+                m_airVelocityY[nIdx] += impulseStrength * dt;
+                m_airVelocityYNext[nIdx] += impulseStrength * dt;
+                
+                // Add some pressure (creates upward push)
+                float pressureStrength = strength * 0.3f * (1.0f - normalizedDist * 0.7f);
+                m_airPressure[nIdx] += pressureStrength * dt;
+                m_airPressureNext[nIdx] += pressureStrength * dt;
             }
         }
-        
-        // Fire tries to ignite flammable neighbors (prefer upward)
-        // Check upward neighbors first, then others
-        int directions[][2] = {{0, 1}, {-1, 1}, {1, 1}, {-1, 0}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}};
-        for (int i = 0; i < 8; ++i)
-        {
-            int dx = directions[i][0];
-            int dy = directions[i][1];
-            // Prefer upward directions - check them more often
-            if (dy > 0 && rand() % 3 != 0) // 2/3 chance to check upward neighbors
+    }
+}
+
+bool PowderScene::applyReactions(int x, int y, const ParticleProperties& props, float dt)
+{
+    const int idx = gridIdx(x, y);
+    const ParticleType type = m_grid.type[idx];
+    const uint32_t reactionMask = m_elements.getReactionMask(type);
+    CellRef self = m_gridNext[idx];
+    int currentLife = m_grid.life[idx];
+    bool kindled = false;
+
+    // Neighbors are read from the old grid and written in the new one
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            if (dx == 0 && dy == 0) continue;
+            if (!isValidGridPos(x + dx, y + dy)) continue;
+
+            const int neighborIdx = gridIdx(x + dx, y + dy);
+            const ParticleType neighborType = m_grid.type[neighborIdx];
+            if ((reactionMask & (1u << (int)neighborType)) == 0)
+                continue;
+
+            const PowderReaction& reaction = m_elements.getReaction(type, neighborType);
+            const float chance = (dy > 0) ? reaction.chanceAbove : reaction.chance;
+            if (chance < 1.0f && randomFloat() > chance)
+                continue;
+
+            CellRef neighbor = m_gridNext[neighborIdx];
+            switch (reaction.kind)
+            {
+            case PowderReactionKind::HeatSelf:
             {
-                tryIgniteNeighbor(x, y, dx, dy);
+                const float heatTemp = getParticleProperties(neighborType).burnTemp;
+                self.temperature += (heatTemp - self.temperature) * reaction.rate * dt;
+                break;
             }
-            else if (dy <= 0 && rand() % 5 == 0) // 1/5 chance to check horizontal/downward neighbors
+
+            case PowderReactionKind::Heat:
             {
-                tryIgniteNeighbor(x, y, dx, dy);
+                neighbor.temperature += (props.burnTemp - neighbor.temperature) * reaction.rate * dt;
+                const ParticleProperties& neighborProps = getParticleProperties(neighborType);
+                if (neighborProps.transitionInto != ParticleType::Empty && neighborProps.transitionAbove &&
+                    neighbor.temperature >= neighborProps.transitionTemp)
+                {
+                    neighbor.type = neighborProps.transitionInto;
+                    neighbor.life = 0;
+                }
+                break;
             }
-        }
-        
-        // Fire dries mud -> turns mud into sand
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
+
+            case PowderReactionKind::Ignite:
             {
-                if (dx == 0 && dy == 0) continue;
-                
-                if (isValidGridPos(x + dx, y + dy))
+                neighbor.temperature += (props.burnTemp - neighbor.temperature) * reaction.rate;
+                if (neighbor.temperature >= getParticleProperties(neighborType).ignitionTemp)
                 {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    if (neighbor.type == ParticleType::Mud)
-                    {
-                        // Convert mud to sand (fire dries mud)
-                        Cell& mudNew = m_gridNext[gridIdx(x + dx, y + dy)];
-                        mudNew.type = ParticleType::Sand;
-                        mudNew.life = 0;
-                        mudNew.temperature = neighbor.temperature; // Preserve temperature
-                    }
+                    // The neighbor now burns (it loses life in its own update)
+                    createFireParticle(x + dx, y + dy);
+                    createSmokeParticle(x + dx, y + dy);
                 }
+                break;
             }
-        }
-        
-        // Fire has a lifetime (decreases over time)
-        int currentLife = oldCell.life;
-        if (currentLife <= 0)
-        {
-            currentLife = 100; // Initial fire lifetime (in frames)
-        }
-        
-        currentLife--;
-        newCell.life = currentLife;
-        
-        // Fire dies out when lifetime reaches zero
-        if (currentLife <= 0)
-        {
-            newCell.type = ParticleType::Empty;
-            newCell.life = 0;
-            newCell.temperature = m_ambientAirTemp;
-            return;
-        }
-        
-        // Fire moves like gas but with strong upward preference
-        const ParticleProperties& fireProps = getParticleProperties(ParticleType::Fire);
-        // Fire has strong upward momentum (preferredDirY = 1 means upward in Y-up coordinate system)
-        int preferredDirX = 0;
-        int preferredDirY = 1; // Strong upward preference for fire
-        if (m_airEnabled)
-        {
-            // Also check air forces, but fire's upward momentum is stronger
-            applyAirForcesToParticle(x, y, fireProps, preferredDirX, preferredDirY);
-            // Fire always prefers upward, so ensure Y direction is upward
-            if (preferredDirY < 1)
-                preferredDirY = 1;
-        }
-        updateGas(x, y, fireProps, preferredDirX, preferredDirY);
-        return;
-    }
-    
-    // Handle smoke particles
-    if (oldCell.type == ParticleType::Smoke)
-    {
-        // Smoke has a lifetime (decreases over time)
-        int currentLife = oldCell.life;
-        if (currentLife <= 0)
-        {
-            currentLife = 200; // Initial smoke lifetime (in frames)
-        }
-        
-        currentLife--;
-        newCell.life = currentLife;
-        
-        // Smoke dissipates when lifetime reaches zero
-        if (currentLife <= 0)
-        {
-            newCell.type = ParticleType::Empty;
-            newCell.life = 0;
-            newCell.temperature = m_ambientAirTemp;
-            return;
-        }
-        
-        // Apply air forces to smoke (smoke is very light and should be strongly affected by air)
-        const ParticleProperties& smokeProps = getParticleProperties(ParticleType::Smoke);
-        int preferredDirX = 0;
-        int preferredDirY = 0;
-        if (m_airEnabled)
-        {
-            applyAirForcesToParticle(x, y, smokeProps, preferredDirX, preferredDirY);
-        }
-        
-        // Smoke moves like gas (rises up) but also reacts to air
-        updateGas(x, y, smokeProps, preferredDirX, preferredDirY);
-        return;
-    }
-    
-    // Handle steam particles
-    if (oldCell.type == ParticleType::Steam)
-    {
-        Cell& newCell = m_gridNext[gridIdx(x, y)];
-        
-        // Steam tries to reach ambient temperature (cools slowly)
-        float& temp = newCell.temperature;
-        if (m_airEnabled)
-        {
-            // Steam temperature moves toward ambient air temperature (slowly)
-            float airTemp = m_airHeat[gridIdx(x, y)];
-            float tempDiff = airTemp - temp;
-            temp += tempDiff * 0.02f * dt; // Cool much slower toward ambient temperature
-        }
-        else
-        {
-            // Without air system, move toward default ambient (slowly)
-            float tempDiff = m_ambientAirTemp - temp;
-            temp += tempDiff * 0.02f * dt; // Cool much slower
-        }
-        
-        // Steam condenses back to water when it cools below boiling point
-        const float boilingPoint = 373.15f; // 100°C (boiling point of water)
-        if (temp < boilingPoint)
-        {
-            // Convert steam back to water
-            newCell.type = ParticleType::Water;
-            newCell.life = 0;
-            newCell.temperature = temp; // Preserve temperature
-            return; // Don't move as gas, it's now water
-        }
-        
-        // Apply air forces to steam (steam is very light and should be strongly affected by air)
-        const ParticleProperties& steamProps = getParticleProperties(ParticleType::Steam);
-        int preferredDirX = 0;
-        int preferredDirY = 0;
-        if (m_airEnabled)
-        {
-            applyAirForcesToParticle(x, y, steamProps, preferredDirX, preferredDirY);
-        }
-        
-        // Steam moves like gas (rises up) but also reacts to air
-        updateGas(x, y, steamProps, preferredDirX, preferredDirY);
-        return;
-    }
-    
-    // Check if this particle can be ignited by nearby fire
-    const ParticleProperties& props = getParticleProperties(oldCell.type);
-    if (props.flammable)
-    {
-        // Check all 8 adjacent cells for fire
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
+
+            case PowderReactionKind::Kindle:
             {
-                if (dx == 0 && dy == 0) continue;
-                
-                if (isValidGridPos(x + dx, y + dy))
+                if (kindled) break; // Heat up once per frame, however many fires are adjacent
+                kindled = true;
+
+                self.temperature += (props.burnTemp - self.temperature) * reaction.rate * dt;
+                if (self.temperature >= props.ignitionTemp)
                 {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    if (neighbor.type == ParticleType::Fire)
+                    // This particle is now burning - create fire and smoke particles
+                    createFireParticle(x, y);
+                    createSmokeParticle(x, y);
+
+                    if (currentLife <= 0)
+                        currentLife = props.burnLife;
+                    currentLife -= props.burnRate;
+                    self.life = currentLife;
+
+                    // If life reaches zero, particle is consumed
+                    if (currentLife <= 0)
                     {
-                        // Fire is nearby, increase temperature
-                        float& temp = newCell.temperature;
-                        temp += (props.burnTemp - temp) * 0.1f * dt; // Heat up gradually
-                        
-                        // If temperature reaches ignition point, ignite!
-                        if (temp >= props.ignitionTemp)
-                        {
-                            // This particle is now burning - create fire particles
-                            createFireParticle(x, y);
-                            
-                            // Create smoke particles
-                            createSmokeParticle(x, y);
-                            
-                            // Reduce particle life (it's burning away)
-                            // Gas burns much faster than other materials
-                            int currentLife = oldCell.life;
-                            if (currentLife <= 0)
-                            {
-                                // Gas burns very quickly, wood burns slower
-                                if (oldCell.type == ParticleType::Gas)
-                                {
-                                    currentLife = 10; // Gas burns quickly (10 frames)
-                                }
-                                else
-                                {
-                                    currentLife = 50; // Other materials burn slower
-                                }
-                            }
-                            
-                            // Gas burns faster (lose more life per frame)
-                            if (oldCell.type == ParticleType::Gas)
-                            {
-                                currentLife -= 2; // Gas loses 2 life per frame
-                            }
-                            else
-                            {
-                                currentLife--; // Other materials lose 1 life per frame
-                            }
-                            
-                            newCell.life = currentLife;
-                            
-                            // If life reaches zero, particle is consumed
-                            if (currentLife <= 0)
-                            {
-                                newCell.type = ParticleType::Empty;
-                                newCell.life = 0;
-                                newCell.temperature = m_ambientAirTemp;
-                            }
-                        }
-                        break; // Found fire, no need to check more
+                        self.type = ParticleType::Empty;
+                        self.life = 0;
+                        self.temperature = m_ambientAirTemp;
+                        return false;
                     }
                 }
+                break;
             }
-        }
-    }
-}
 
-void PowderScene::tryIgniteNeighbor(int x, int y, int dx, int dy)
-{
-    if (!isValidGridPos(x + dx, y + dy))
-        return;
-    
-    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-    if (neighbor.type == ParticleType::Empty || neighbor.type == ParticleType::Fire)
-        return;
-    
-    const ParticleProperties& neighborProps = getParticleProperties(neighbor.type);
-    if (!neighborProps.flammable)
-        return;
-    
-    // Fire heats up the neighbor
-    Cell& neighborNew = m_gridNext[gridIdx(x + dx, y + dy)];
-    float& temp = neighborNew.temperature;
-    const ParticleProperties& fireProps = getParticleProperties(ParticleType::Fire);
-    temp += (fireProps.burnTemp - temp) * 0.2f; // Heat up faster when directly adjacent to fire
-    
-    // If temperature reaches ignition point, ignite!
-    if (temp >= neighborProps.ignitionTemp)
-    {
-        // Create fire at neighbor location
-        createFireParticle(x + dx, y + dy);
-        
-        // Create smoke
-        createSmokeParticle(x + dx, y + dy);
-        
-        // Gas burns very quickly - reduce its life immediately
-        if (neighbor.type == ParticleType::Gas)
-        {
-            int currentLife = neighborNew.life;
-            if (currentLife <= 0)
+            case PowderReactionKind::Convert:
             {
-                currentLife = 10; // Gas burns quickly (10 frames)
+                neighbor.type = reaction.product;
+                neighbor.life = 0;
+                if (reaction.productTemp > 0.0f)
+                    neighbor.temperature = reaction.productTemp;
+
+                if (reaction.selfProduct != ParticleType::Empty)
+                {
+                    self.type = reaction.selfProduct;
+                    self.life = 0;
+                    if (reaction.selfProductTemp > 0.0f)
+                        self.temperature = reaction.selfProductTemp;
+                    return false; // Don't move this frame, it's a different particle now
+                }
+                break;
             }
-            currentLife -= 2; // Gas loses 2 life per frame when burning
-            neighborNew.life = currentLife;
-            
-            // If life reaches zero, gas is consumed
-            if (currentLife <= 0)
+
+            case PowderReactionKind::Corrode:
             {
-                neighborNew.type = ParticleType::Empty;
-                neighborNew.life = 0;
-                neighborNew.temperature = m_ambientAirTemp;
+                neighbor.type = ParticleType::Empty;
+                neighbor.life = 0;
+
+                // Decrement the particle's life for each neighbor corroded
+                currentLife--;
+                self.life = currentLife;
+                if (currentLife <= 0)
+                {
+                    self.type = ParticleType::Empty;
+                    self.life = 0;
+                    return false; // Acid is gone, no movement
+                }
+                break;
+            }
+
+            default:
+                break;
             }
         }
     }
+    return true;
 }
 
 void PowderScene::createFireParticle(int x, int y)
@@ -1609,20 +1413,20 @@ void PowderScene::createFireParticle(int x, int y)
         
         if (isValidGridPos(nx, ny))
         {
-            Cell& cell = m_gridNext[gridIdx(nx, ny)];
-            if (cell.type == ParticleType::Empty && !cell.updated)
+            CellRef cell = m_gridNext[gridIdx(nx, ny)];
+            if (cell.type == ParticleType::Empty && !cell.isUpdated())
             {
                 cell.type = ParticleType::Fire;
                 cell.life = 100; // Fire lifetime
                 cell.temperature = 1500.0f; // Fire is hot
-                cell.updated = true;
+                cell.markUpdated();
                 return;
             }
         }
     }
     
     // Second pass: only try horizontal/downward if upward failed (and only rarely)
-    if (rand() % 4 == 0) // 1/4 chance to spread horizontally/downward
+    if (randomInt(4) == 0) // 1/4 chance to spread horizontally/downward
     {
         for (int i = 3; i < 8; ++i) // Horizontal and downward directions
         {
@@ -1631,13 +1435,13 @@ void PowderScene::createFireParticle(int x, int y)
             
             if (isValidGridPos(nx, ny))
             {
-                Cell& cell = m_gridNext[gridIdx(nx, ny)];
-                if (cell.type == ParticleType::Empty && !cell.updated)
+                CellRef cell = m_gridNext[gridIdx(nx, ny)];
+                if (cell.type == ParticleType::Empty && !cell.isUpdated())
                 {
                     cell.type = ParticleType::Fire;
                     cell.life = 100; // Fire lifetime
                     cell.temperature = 1500.0f; // Fire is hot
-                    cell.updated = true;
+                    cell.markUpdated();
                     return;
                 }
             }
@@ -1654,7 +1458,7 @@ void PowderScene::createSmokeParticle(int x, int y)
     int directions[][2] = {{0, 1}, {-1, 1}, {1, 1}, {-1, 0}, {1, 0}};
     
     // Random chance to create smoke (not every frame)
-    if (rand() % 3 == 0) // 1/3 chance
+    if (randomInt(3) == 0) // 1/3 chance
     {
         for (int i = 0; i < 5; ++i)
         {
@@ -1663,13 +1467,13 @@ void PowderScene::createSmokeParticle(int x, int y)
             
             if (isValidGridPos(nx, ny))
             {
-                Cell& cell = m_gridNext[gridIdx(nx, ny)];
-                if (cell.type == ParticleType::Empty && !cell.updated)
+                CellRef cell = m_gridNext[gridIdx(nx, ny)];
+                if (cell.type == ParticleType::Empty && !cell.isUpdated())
                 {
                     cell.type = ParticleType::Smoke;
                     cell.life = 200; // Smoke lifetime
                     cell.temperature = m_ambientAirTemp;
-                    cell.updated = true;
+                    cell.markUpdated();
                     return;
                 }
             }
@@ -1680,84 +1484,61 @@ void PowderScene::createSmokeParticle(int x, int y)
 void PowderScene::updateParticle(int x, int y, float dt)
 {
     // Read particle type from old grid
-    const Cell& oldCell = m_grid[gridIdx(x, y)];
+    const int idx = gridIdx(x, y);
+    ConstCellRef oldCell = m_grid[idx];
     if (oldCell.type == ParticleType::Empty)
         return;
 
-    // Get particle properties
+    // Get particle properties (flat table indexed by type)
     const ParticleProperties& props = getParticleProperties(oldCell.type);
+    CellRef newCell = m_gridNext[idx];
 
-    // Handle fire, smoke, steam, and lava first (they have special behavior)
-    if (oldCell.type == ParticleType::Fire || oldCell.type == ParticleType::Smoke || oldCell.type == ParticleType::Steam || oldCell.type == ParticleType::Lava)
+    // Short-lived particles (fire, smoke) count down and disappear
+    if (props.lifetime > 0)
     {
-        if (oldCell.type == ParticleType::Lava)
-        {
-            // Lava has special interactions - handle in updateLiquid
-            // But we still need to check for fire ignition first
-            updateFireAndIgnition(x, y, dt);
-        }
-        else
+        int currentLife = (oldCell.life <= 0) ? props.lifetime : oldCell.life;
+        currentLife--;
+        newCell.life = currentLife;
+        if (currentLife <= 0)
         {
-            updateFireAndIgnition(x, y, dt);
+            newCell.type = ParticleType::Empty;
+            newCell.life = 0;
+            newCell.temperature = m_ambientAirTemp;
             return;
         }
     }
 
-    // Apply air forces to particle (ALL particles react to air, but strength depends on density/weight)
-    int preferredDirX = 0;
-    int preferredDirY = 0;
-    if (m_airEnabled)
+    // Heat exchange with the air
+    if (m_airEnabled && props.heatsAir)
     {
-        applyAirForcesToParticle(x, y, props, preferredDirX, preferredDirY);
+        float heatIncrease = props.burnTemp - m_ambientAirTemp;
+        m_airHeatNext[idx] += heatIncrease * 0.1f * dt; // Gradually heat up
+        m_airHeatNext[idx] = std::min(m_airHeatNext[idx], props.burnTemp);
     }
-    
-    // Check for fire ignition (all particles can burn)
-    updateFireAndIgnition(x, y, dt);
-    
-    // Handle Metal heating and melting (solids can still heat up)
-    if (oldCell.type == ParticleType::Metal)
+    if (m_airEnabled && props.draftStrength > 0.0f)
     {
-        Cell& newCell = m_gridNext[gridIdx(x, y)];
-        float& temp = newCell.temperature;
-        
-        // Metal heats up from nearby fire, lava, or hot air
-        if (m_airEnabled)
-        {
-            // Metal temperature moves toward ambient air temperature
-            float airTemp = m_airHeat[gridIdx(x, y)];
-            float tempDiff = airTemp - temp;
-            temp += tempDiff * 0.05f * dt; // Metal heats up slowly
-        }
-        
-        // Check all 8 adjacent cells for fire or lava (they heat metal quickly)
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
-            {
-                if (dx == 0 && dy == 0) continue;
-                
-                if (isValidGridPos(x + dx, y + dy))
-                {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    if (neighbor.type == ParticleType::Fire || neighbor.type == ParticleType::Lava)
-                    {
-                        // Fire/lava nearby heats metal quickly
-                        const ParticleProperties& heatProps = getParticleProperties(neighbor.type);
-                        float tempDiff = heatProps.burnTemp - temp;
-                        temp += tempDiff * 0.7f * dt; // Heat up much faster near fire/lava
-                    }
-                }
-            }
-        }
-        
-        // Metal melts into lava at ~1200°C (1473.15K) - lower than lava temp so it can actually melt
-        const float metalMeltingPoint = 1473.15f; // ~1200°C (same as stone/sand)
-        if (temp >= metalMeltingPoint)
+        applyFireDraft(x, y, props.draftStrength, dt);
+    }
+    if (props.airHeatRate > 0.0f)
+    {
+        // Temperature moves toward the surrounding air (or the ambient temperature without air)
+        float airTemp = m_airEnabled ? m_airHeat[idx] : m_ambientAirTemp;
+        newCell.temperature += (airTemp - newCell.temperature) * props.airHeatRate * dt;
+    }
+
+    // Reactions with neighbors (ignition, heating, conversion, corrosion)
+    if (m_elements.getReactionMask(oldCell.type) != 0 && !applyReactions(x, y, props, dt))
+        return;
+
+    // Temperature-driven transitions (melting, boiling, condensing)
+    if (props.transitionInto != ParticleType::Empty)
+    {
+        const float temp = newCell.temperature;
+        if (props.transitionAbove ? (temp >= props.transitionTemp) : (temp < props.transitionTemp))
         {
-            // Convert metal to lava
-            newCell.type = ParticleType::Lava;
+            newCell.type = props.transitionInto;
             newCell.life = 0;
-            newCell.temperature = temp; // Preserve temperature
+            return; // Don't move this frame, it's a different particle now
         }
     }
     
@@ -1769,19 +1550,30 @@ void PowderScene::updateParticle(int x, int y, float dt)
         return;
     }
 
+    // Apply air forces to particle (ALL particles react to air, but strength depends on density/weight)
+    // Rising particles (fire) keep their upward preference whatever the air does
+    int preferredDirX = 0;
+    int preferredDirY = props.rises ? 1 : 0;
+    if (m_airEnabled)
+    {
+        applyAirForcesToParticle(x, y, props, preferredDirX, preferredDirY);
+        if (props.rises && preferredDirY < 1)
+            preferredDirY = 1;
+    }
+
     // Handle based on state of matter
     switch (props.matterState)
     {
     case MatterState::Powder:
         // Powder: Only fall via non-chemical reactions, but will not spread as liquids do
         // Stays in place unless a force acts upon them (gravity or air)
-        updatePowder(x, y, props, dt, preferredDirX, preferredDirY);
+        updatePowder(x, y, props, preferredDirX, preferredDirY);
         return;
 
     case MatterState::Liquid:
         // Liquid: Random horizontal movement each frame, then fall down
         // Can float above denser liquids/powders
-        updateLiquid(x, y, props, dt, preferredDirX, preferredDirY);
+        updateLiquid(x, y, props, preferredDirX, preferredDirY);
         return;
 
     case MatterState::Gas:
@@ -1799,53 +1591,8 @@ void PowderScene::applyAirForcesToParticle(int x, int y, const ParticlePropertie
     if (!m_airEnabled || !isValidGridPos(x, y))
         return;
 
-    // Get air pressure and velocity at particle location
-    float pressure = m_airPressure[gridIdx(x, y)];
-    float vx = m_airVelocityX[gridIdx(x, y)];
-    float vy = m_airVelocityY[gridIdx(x, y)];
-
-    // Calculate air force strength based on particle density/weight
-    // Lighter particles (low density) are affected more by air
-    // Heavier particles (high density) are affected less by air
-    // Use inverse density: 1.0 / density gives higher values for lighter particles
-    const float baseAirSensitivity = 1.0f; // Base sensitivity multiplier
-    float airSensitivity = baseAirSensitivity / std::max(props.density, 0.1f); // Inverse density (clamp to avoid division by zero)
-    
-    // Clamp sensitivity to reasonable range (very light particles get max effect, very heavy get min effect)
-    airSensitivity = std::clamp(airSensitivity, 0.1f, 10.0f);
-    
-    // Adjust thresholds based on density - lighter particles react to smaller forces
-    float pressureThreshold = 0.5f / airSensitivity; // Lower threshold for lighter particles
-    float velocityThreshold = 0.3f / airSensitivity; // Lower threshold for lighter particles
-
-    // Calculate preferred direction from air pressure gradient
-    float pressureX = 0.0f;
-    float pressureY = 0.0f;
-    
-    if (x > 0 && x < m_gridWidth - 1)
-    {
-        pressureX = m_airPressure[gridIdx(x - 1, y)] - m_airPressure[gridIdx(x + 1, y)];
-    }
-    if (y > 0 && y < m_gridHeight - 1)
-    {
-        pressureY = m_airPressure[gridIdx(x, y - 1)] - m_airPressure[gridIdx(x, y + 1)];
-    }
-
-    // Combine pressure gradient and velocity to get preferred direction
-    // Scale by air sensitivity - lighter particles are pushed more
-    float forceX = (pressureX * 0.5f + vx) * airSensitivity;
-    float forceY = (pressureY * 0.5f + vy) * airSensitivity;
-
-    // Convert to preferred direction (normalize to -1, 0, or 1)
-    // Use the adjusted thresholds
-    if (std::abs(forceX) > pressureThreshold || std::abs(vx * airSensitivity) > velocityThreshold)
-    {
-        preferredDirX = (forceX > 0.0f) ? 1 : (forceX < 0.0f) ? -1 : 0;
-    }
-    if (std::abs(forceY) > pressureThreshold || std::abs(vy * airSensitivity) > velocityThreshold)
-    {
-        preferredDirY = (forceY > 0.0f) ? 1 : (forceY < 0.0f) ? -1 : 0;
-    }
+    // Lighter particles are pushed by weaker air (shared with the wake test)
+    getPowderAirPush(getAirFields(), x, y, props.density, preferredDirX, preferredDirY);
 }
 
 void PowderScene::addParticleMovementToAir(int x, int y, int newX, int newY, const ParticleProperties& props)
@@ -1881,16 +1628,11 @@ void PowderScene::addParticleMovementToAir(int x, int y, int newX, int newY, con
     }
 }
 
-void PowderScene::createAirImpulse(const Vec2& worldPos, float strength, float radius)
+void PowderScene::createAirImpulse(int centerX, int centerY, int radiusCells, float strength)
 {
     if (!m_airEnabled)
         return;
 
-    Vec2 gridPos = worldToGrid(worldPos);
-    int centerX = (int)std::floor(gridPos.x);
-    int centerY = (int)std::floor(gridPos.y);
-    int radiusCells = (int)(radius / m_cellSize);
-    
     // Ensure minimum radius
     if (radiusCells < 1)
         radiusCells = 1;
@@ -1942,98 +1684,15 @@ void PowderScene::createAirImpulse(const Vec2& worldPos, float strength, float r
                 // Also update next buffers directly so it's visible immediately
                 // (in case we're paused or between updates)
                 m_airVelocityXNext[idx] += dirX * impulseStrength;
-                m_airVelocityYNext[idx] += dirY * impulseStrength;
-                m_airPressureNext[idx] += pressureStrength;
-            }
-        }
-    }
-}
-
-void PowderScene::updatePowder(int x, int y, const ParticleProperties& props, float dt, int preferredDirX, int preferredDirY)
-{
-    // Read particle type from old grid
-    const Cell& oldCell = m_grid[gridIdx(x, y)];
-    Cell& newCell = m_gridNext[gridIdx(x, y)];
-    
-    // Handle Sand+Water -> Mud conversion
-    if (oldCell.type == ParticleType::Sand)
-    {
-        // Check all 8 adjacent cells for water
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
-            {
-                if (dx == 0 && dy == 0) continue;
-                
-                if (isValidGridPos(x + dx, y + dy))
-                {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    if (neighbor.type == ParticleType::Water)
-                    {
-                        // Convert sand to mud
-                        newCell.type = ParticleType::Mud;
-                        newCell.life = 0;
-                        newCell.temperature = oldCell.temperature; // Preserve temperature
-                        
-                        // Convert water to mud as well
-                        Cell& waterNew = m_gridNext[gridIdx(x + dx, y + dy)];
-                        waterNew.type = ParticleType::Mud;
-                        waterNew.life = 0;
-                        waterNew.temperature = neighbor.temperature; // Preserve temperature
-                        return; // Don't move as powder, it's now mud
-                    }
-                }
-            }
-        }
-    }
-    
-    // Handle Stone->Lava conversion (stone melts when hot)
-    if (oldCell.type == ParticleType::Stone)
-    {
-        float& temp = newCell.temperature;
-        
-        // Stone heats up from nearby fire, lava, or hot air
-        if (m_airEnabled)
-        {
-            // Stone temperature moves toward ambient air temperature
-            float airTemp = m_airHeat[gridIdx(x, y)];
-            float tempDiff = airTemp - temp;
-            temp += tempDiff * 0.05f * dt; // Stone heats up slowly
-        }
-        
-        // Check all 8 adjacent cells for fire or lava (they heat stone quickly)
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
-            {
-                if (dx == 0 && dy == 0) continue;
-                
-                if (isValidGridPos(x + dx, y + dy))
-                {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    if (neighbor.type == ParticleType::Fire || neighbor.type == ParticleType::Lava)
-                    {
-                        // Fire/lava nearby heats stone quickly
-                        const ParticleProperties& heatProps = getParticleProperties(neighbor.type);
-                        float tempDiff = heatProps.burnTemp - temp;
-                        temp += tempDiff * 0.3f * dt; // Heat up faster near fire/lava
-                    }
-                }
+                m_airVelocityYNext[idx] += dirY * impulseStrength;
+                m_airPressureNext[idx] += pressureStrength;
             }
         }
-        
-        // Stone melts into lava at ~1200°C (1473.15K)
-        const float meltingPoint = 1473.15f; // ~1200°C
-        if (temp >= meltingPoint)
-        {
-            // Convert stone to lava
-            newCell.type = ParticleType::Lava;
-            newCell.life = 0;
-            newCell.temperature = temp; // Preserve temperature
-            return; // Don't move as powder, it's now lava
-        }
     }
-    
+}
+
+void PowderScene::updatePowder(int x, int y, const ParticleProperties& props, int preferredDirX, int preferredDirY)
+{
     // Powder falls down due to gravity (Y-up, so down is Y-1)
     // But can also be pushed by air
     
@@ -2053,7 +1712,7 @@ void PowderScene::updatePowder(int x, int y, const ParticleProperties& props, fl
     // Powders can fall through gases and liquids (but not solids)
     if (isValidGridPos(x, y - 1))
     {
-        const Cell& cellBelow = m_grid[gridIdx(x, y - 1)];
+        ConstCellRef cellBelow = m_grid[gridIdx(x, y - 1)];
         if (cellBelow.type != ParticleType::Empty)
         {
             const ParticleProperties& belowProps = getParticleProperties(cellBelow.type);
@@ -2069,7 +1728,7 @@ void PowderScene::updatePowder(int x, int y, const ParticleProperties& props, fl
     }
 
     // If can't move down, try diagonal down (left or right)
-    int dir = (rand() % 2 == 0) ? -1 : 1;
+    int dir = (randomInt(2) == 0) ? -1 : 1;
     
     // Try diagonal into empty space
     if (tryMove(x, y, x + dir, y - 1))
@@ -2085,7 +1744,7 @@ void PowderScene::updatePowder(int x, int y, const ParticleProperties& props, fl
     {
         if (isValidGridPos(x + dx, y - 1))
         {
-            const Cell& cellDiag = m_grid[gridIdx(x + dx, y - 1)];
+            ConstCellRef cellDiag = m_grid[gridIdx(x + dx, y - 1)];
             if (cellDiag.type != ParticleType::Empty)
             {
                 const ParticleProperties& diagProps = getParticleProperties(cellDiag.type);
@@ -2104,299 +1763,15 @@ void PowderScene::updatePowder(int x, int y, const ParticleProperties& props, fl
     // Powder is at rest (can't fall further, doesn't spread horizontally)
 }
 
-void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, float dt, int preferredDirX, int preferredDirY)
+void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, int preferredDirX, int preferredDirY)
 {
     // Liquid: Each individual dot randomly moves left, right, or stays in place horizontally every frame
     // Then falls down. In cellular automata, each particle can only move once per frame,
     // so we prioritize horizontal movement first, then falling if horizontal didn't happen.
     
-    // Read particle type from old grid
-    const Cell& oldCell = m_grid[gridIdx(x, y)];
-    Cell& newCell = m_gridNext[gridIdx(x, y)];
-    
-    // Handle Lava interactions (converts other particles)
-    if (oldCell.type == ParticleType::Lava)
-    {
-        // Lava heats up air
-        if (m_airEnabled)
-        {
-            const ParticleProperties& lavaProps = getParticleProperties(ParticleType::Lava);
-            int idx = gridIdx(x, y);
-            float heatIncrease = lavaProps.burnTemp - m_ambientAirTemp;
-            m_airHeatNext[idx] += heatIncrease * 0.1f * dt; // Gradually heat up air
-            m_airHeatNext[idx] = std::min(m_airHeatNext[idx], lavaProps.burnTemp);
-        }
-        
-        // Check all 8 adjacent cells for particles to convert/ignite
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
-            {
-                if (dx == 0 && dy == 0) continue;
-                
-                if (isValidGridPos(x + dx, y + dy))
-                {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    Cell& neighborNew = m_gridNext[gridIdx(x + dx, y + dy)];
-                    
-                    // Sand touches lava -> heats up (converts to lava over time)
-                    if (neighbor.type == ParticleType::Sand)
-                    {
-                        float& temp = neighborNew.temperature;
-                        // Heat up sand when touching lava
-                        const ParticleProperties& lavaProps = getParticleProperties(ParticleType::Lava);
-                        float tempDiff = lavaProps.burnTemp - temp;
-                        temp += tempDiff * 0.4f * dt; // Heat up much faster
-                        
-                        // Sand melts into lava at ~1200°C (1473.15K) - same as stone
-                        const float meltingPoint = 1473.15f; // ~1200°C
-                        if (temp >= meltingPoint)
-                        {
-                            neighborNew.type = ParticleType::Lava;
-                            neighborNew.life = 0;
-                            neighborNew.temperature = temp; // Preserve temperature
-                        }
-                        continue;
-                    }
-                    
-                    // Metal touches lava -> melts to lava
-                    if (neighbor.type == ParticleType::Metal)
-                    {
-                        float& temp = neighborNew.temperature;
-                        // Heat up metal quickly when touching lava
-                        const ParticleProperties& lavaProps = getParticleProperties(ParticleType::Lava);
-                        float tempDiff = lavaProps.burnTemp - temp;
-                        temp += tempDiff * 0.8f * dt; // Heat up much faster
-                        
-                        // Metal melts into lava at ~1200°C (1473.15K) - lower than lava temp so it can actually melt
-                        const float metalMeltingPoint = 1473.15f; // ~1200°C (same as stone/sand)
-                        if (temp >= metalMeltingPoint)
-                        {
-                            neighborNew.type = ParticleType::Lava;
-                            neighborNew.life = 0;
-                            neighborNew.temperature = temp; // Preserve temperature
-                        }
-                        continue;
-                    }
-                    
-                    // Water touches lava -> water turns to steam, lava turns to stone
-                    if (neighbor.type == ParticleType::Water)
-                    {
-                        neighborNew.type = ParticleType::Steam;
-                        neighborNew.life = 0;
-                        neighborNew.temperature = 373.15f + 50.0f; // Hot steam
-                        
-                        // Convert the lava that touched water into stone
-                        Cell& lavaNew = m_gridNext[gridIdx(x, y)];
-                        lavaNew.type = ParticleType::Stone;
-                        lavaNew.life = 0;
-                        lavaNew.temperature = 273.15f + 22.0f; // Reset to ambient temperature
-                        continue;
-                    }
-                    
-                    // Mud touches lava -> mud turns to sand
-                    if (neighbor.type == ParticleType::Mud)
-                    {
-                        neighborNew.type = ParticleType::Sand;
-                        neighborNew.life = 0;
-                        neighborNew.temperature = neighbor.temperature; // Preserve temperature
-                        continue;
-                    }
-                    
-                    // Oil touches lava -> ignites immediately
-                    if (neighbor.type == ParticleType::Oil)
-                    {
-                        const ParticleProperties& oilProps = getParticleProperties(ParticleType::Oil);
-                        float& temp = neighborNew.temperature;
-                        temp = oilProps.ignitionTemp + 10.0f; // Set above ignition temperature to ensure ignition
-                        
-                        // Immediately create fire at oil location
-                        createFireParticle(x + dx, y + dy);
-                        
-                        // Oil burns quickly
-                        int currentLife = neighbor.life;
-                        if (currentLife <= 0)
-                        {
-                            currentLife = 30; // Oil burns faster than wood
-                        }
-                        currentLife -= 2; // Oil loses 2 life per frame when burning
-                        neighborNew.life = currentLife;
-                        
-                        // If life reaches zero, oil is consumed
-                        if (currentLife <= 0)
-                        {
-                            neighborNew.type = ParticleType::Empty;
-                            neighborNew.life = 0;
-                            neighborNew.temperature = m_ambientAirTemp;
-                        }
-                        continue;
-                    }
-                    
-                    // Wood touches lava -> ignites immediately
-                    if (neighbor.type == ParticleType::Wood)
-                    {
-                        const ParticleProperties& woodProps = getParticleProperties(ParticleType::Wood);
-                        float& temp = neighborNew.temperature;
-                        temp = woodProps.ignitionTemp + 10.0f; // Set above ignition temperature to ensure ignition
-                        
-                        // Immediately create fire and smoke at wood location
-                        createFireParticle(x + dx, y + dy);
-                        createSmokeParticle(x + dx, y + dy);
-                        
-                        // Start burning process
-                        int currentLife = neighbor.life;
-                        if (currentLife <= 0)
-                        {
-                            currentLife = 50; // Wood burns slower
-                        }
-                        currentLife--; // Start consuming wood
-                        neighborNew.life = currentLife;
-                        
-                        // If life reaches zero, wood is consumed
-                        if (currentLife <= 0)
-                        {
-                            neighborNew.type = ParticleType::Empty;
-                            neighborNew.life = 0;
-                            neighborNew.temperature = m_ambientAirTemp;
-                        }
-                        continue;
-                    }
-                    
-                    // Gas touches lava -> ignites immediately
-                    if (neighbor.type == ParticleType::Gas)
-                    {
-                        const ParticleProperties& gasProps = getParticleProperties(ParticleType::Gas);
-                        float& temp = neighborNew.temperature;
-                        temp = gasProps.ignitionTemp + 10.0f; // Set above ignition temperature to ensure ignition
-                        
-                        // Immediately create fire at gas location
-                        createFireParticle(x + dx, y + dy);
-                        
-                        // Gas burns very quickly
-                        int currentLife = neighbor.life;
-                        if (currentLife <= 0)
-                        {
-                            currentLife = 10; // Gas burns quickly
-                        }
-                        currentLife -= 2; // Gas loses 2 life per frame when burning
-                        neighborNew.life = currentLife;
-                        
-                        // If life reaches zero, gas is consumed
-                        if (currentLife <= 0)
-                        {
-                            neighborNew.type = ParticleType::Empty;
-                            neighborNew.life = 0;
-                            neighborNew.temperature = m_ambientAirTemp;
-                        }
-                        continue;
-                    }
-                }
-            }
-        }
-    }
-    
-    // Handle water->steam conversion (water boils when hot)
-    if (oldCell.type == ParticleType::Water)
-    {
-        float& temp = newCell.temperature;
-        
-        // Water heats up from nearby fire or hot air
-        if (m_airEnabled)
-        {
-            // Water temperature moves toward ambient air temperature
-            float airTemp = m_airHeat[gridIdx(x, y)];
-            float tempDiff = airTemp - temp;
-            temp += tempDiff * 0.05f * dt; // Water heats up slower than steam cools
-        }
-        
-        // Check all 8 adjacent cells for fire (fire heats water quickly)
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
-            {
-                if (dx == 0 && dy == 0) continue;
-                
-                if (isValidGridPos(x + dx, y + dy))
-                {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    if (neighbor.type == ParticleType::Fire)
-                    {
-                        // Fire nearby heats water quickly
-                        const ParticleProperties& fireProps = getParticleProperties(ParticleType::Fire);
-                        float tempDiff = fireProps.burnTemp - temp;
-                        temp += tempDiff * 0.2f * dt; // Heat up faster near fire
-                    }
-                }
-            }
-        }
-        
-        // Water boils and turns to steam at 100°C (373.15K)
-        const float boilingPoint = 373.15f; // 100°C
-        if (temp >= boilingPoint)
-        {
-            // Convert water to steam
-            newCell.type = ParticleType::Steam;
-            newCell.life = 0;
-            newCell.temperature = temp; // Preserve temperature
-            return; // Don't move as liquid, it's now steam
-        }
-    }
-    
-    // Handle acid corrosion before movement
-    if (oldCell.type == ParticleType::Acid)
-    {
-        // Get acid cell in new grid and track life
-        Cell& acidNew = m_gridNext[gridIdx(x, y)];
-        int currentLife = oldCell.life;
-        
-        // Corrosion chance per frame (35% chance to corrode each adjacent particle)
-        // This makes corrosion fast but not instant
-        const float corrosionChance = 0.15f;
-        
-        // Check all 8 adjacent cells (including diagonals) for particles to corrode
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
-            {
-                if (dx == 0 && dy == 0) continue; // Skip self
-                
-                if (isValidGridPos(x + dx, y + dy))
-                {
-                    const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
-                    if (neighbor.type != ParticleType::Empty && canCorrode(neighbor.type))
-                    {
-                        // Random chance to corrode this frame (makes it slower but still fast)
-                        float randomValue = (float)rand() / (float)RAND_MAX;
-                        if (randomValue <= corrosionChance)
-                        {
-                            // Corrode the neighbor particle
-                            Cell& neighborNew = m_gridNext[gridIdx(x + dx, y + dy)];
-                            neighborNew.type = ParticleType::Empty;
-                            neighborNew.life = 0;
-                            
-                            // Decrement acid's life for each particle corroded
-                            currentLife--;
-                            
-                            // If acid's life reaches 0, remove it and stop
-                            if (currentLife <= 0)
-                            {
-                                acidNew.type = ParticleType::Empty;
-                                acidNew.life = 0;
-                                return; // Acid is gone, no movement
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        
-        // Update acid's life in new grid
-        acidNew.life = currentLife;
-    }
-    
     // First, try horizontal movement (random left, right, or stay, but prefer air direction)
     // Use movementChance to control viscosity (lower = more viscous, moves less often)
-    float randomValue = (float)rand() / (float)RAND_MAX;
+    float randomValue = randomFloat();
     if (randomValue > props.movementChance)
     {
         // Skip horizontal movement this frame (viscous liquids move less often)
@@ -2404,10 +1779,10 @@ void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, fl
     }
     else
     {
-        int horizontalDir = rand() % 3 - 1; // -1 (left), 0 (stay), 1 (right)
+        int horizontalDir = randomInt(3) - 1; // -1 (left), 0 (stay), 1 (right)
         
         // If air is pushing, prefer that direction (but still allow randomness)
-        if (preferredDirX != 0 && rand() % 3 == 0) // 1/3 chance to follow air
+        if (preferredDirX != 0 && randomInt(3) == 0) // 1/3 chance to follow air
         {
             horizontalDir = preferredDirX;
         }
@@ -2416,8 +1791,8 @@ void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, fl
         {
             if (isValidGridPos(x + horizontalDir, y))
             {
-                Cell& dst = m_gridNext[gridIdx(x + horizontalDir, y)];
-                if (dst.type == ParticleType::Empty && !dst.updated)
+                CellRef dst = m_gridNext[gridIdx(x + horizontalDir, y)];
+                if (dst.type == ParticleType::Empty && !dst.isUpdated())
                 {
                     if (tryMove(x, y, x + horizontalDir, y))
                     {
@@ -2437,7 +1812,7 @@ void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, fl
     // Try to swap with gas below
     if (isValidGridPos(x, y - 1))
     {
-        const Cell& cellBelow = m_grid[gridIdx(x, y - 1)];
+        ConstCellRef cellBelow = m_grid[gridIdx(x, y - 1)];
         if (cellBelow.type != ParticleType::Empty)
         {
             const ParticleProperties& belowProps = getParticleProperties(cellBelow.type);
@@ -2457,12 +1832,12 @@ void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, fl
     }
 
     // Try diagonal falling through gases
-    int dir = (rand() % 2 == 0) ? -1 : 1;
+    int dir = (randomInt(2) == 0) ? -1 : 1;
     for (int dx : {dir, -dir})
     {
         if (isValidGridPos(x + dx, y - 1))
         {
-            const Cell& cellDiag = m_grid[gridIdx(x + dx, y - 1)];
+            ConstCellRef cellDiag = m_grid[gridIdx(x + dx, y - 1)];
             if (cellDiag.type != ParticleType::Empty)
             {
                 const ParticleProperties& diagProps = getParticleProperties(cellDiag.type);
@@ -2487,7 +1862,7 @@ void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, fl
     float particleDensity = props.density;
     if (isValidGridPos(x, y + 1))
     {
-        const Cell& cellAbove = m_grid[gridIdx(x, y + 1)];
+        ConstCellRef cellAbove = m_grid[gridIdx(x, y + 1)];
         if (cellAbove.type != ParticleType::Empty)
         {
             const ParticleProperties& aboveProps = getParticleProperties(cellAbove.type);
@@ -2509,7 +1884,7 @@ void PowderScene::updateLiquid(int x, int y, const ParticleProperties& props, fl
     {
         if (isValidGridPos(x + dx, y + 1))
         {
-            const Cell& cellDiag = m_grid[gridIdx(x + dx, y + 1)];
+            ConstCellRef cellDiag = m_grid[gridIdx(x + dx, y + 1)];
             if (cellDiag.type != ParticleType::Empty)
             {
                 const ParticleProperties& diagProps = getParticleProperties(cellDiag.type);
@@ -2542,7 +1917,7 @@ void PowderScene::updateGas(int x, int y, const ParticleProperties& props, int p
     // Gas also reacts to air pressure/velocity
 
     // Apply movement chance - gas moves slower by randomly skipping movement attempts
-    float randomValue = (float)rand() / (float)RAND_MAX;
+    float randomValue = randomFloat();
     if (randomValue > props.movementChance)
         return; // Skip movement this frame
 
@@ -2564,7 +1939,7 @@ void PowderScene::updateGas(int x, int y, const ParticleProperties& props, int p
             
             if (isValidGridPos(x + dx, y + dy))
             {
-                const Cell& neighbor = m_grid[gridIdx(x + dx, y + dy)];
+                ConstCellRef neighbor = m_grid[gridIdx(x + dx, y + dy)];
                 if (neighbor.type != ParticleType::Empty)
                 {
                     const ParticleProperties& neighborProps = getParticleProperties(neighbor.type);
@@ -2629,8 +2004,8 @@ void PowderScene::updateGas(int x, int y, const ParticleProperties& props, int p
         {
             if (isValidGridPos(x + repelX, y))
             {
-                Cell& dst = m_gridNext[gridIdx(x + repelX, y)];
-                if (dst.type == ParticleType::Empty && !dst.updated)
+                CellRef dst = m_gridNext[gridIdx(x + repelX, y)];
+                if (dst.type == ParticleType::Empty && !dst.isUpdated())
                 {
                     if (tryMove(x, y, x + repelX, y))
                         return; // Moved horizontally away from neighbors
@@ -2643,8 +2018,8 @@ void PowderScene::updateGas(int x, int y, const ParticleProperties& props, int p
         {
             if (isValidGridPos(x, y + repelY))
             {
-                Cell& dst = m_gridNext[gridIdx(x, y + repelY)];
-                if (dst.type == ParticleType::Empty && !dst.updated)
+                CellRef dst = m_gridNext[gridIdx(x, y + repelY)];
+                if (dst.type == ParticleType::Empty && !dst.isUpdated())
                 {
                     if (tryMove(x, y, x, y + repelY))
                         return; // Moved vertically away from neighbors
@@ -2657,8 +2032,8 @@ void PowderScene::updateGas(int x, int y, const ParticleProperties& props, int p
         {
             if (isValidGridPos(x + repelX, y + repelY))
             {
-                Cell& dst = m_gridNext[gridIdx(x + repelX, y + repelY)];
-                if (dst.type == ParticleType::Empty && !dst.updated)
+                CellRef dst = m_gridNext[gridIdx(x + repelX, y + repelY)];
+                if (dst.type == ParticleType::Empty && !dst.isUpdated())
                 {
                     if (tryMove(x, y, x + repelX, y + repelY))
                         return; // Moved diagonally away from neighbors
@@ -2668,13 +2043,13 @@ void PowderScene::updateGas(int x, int y, const ParticleProperties& props, int p
     }
 
     // If no neighbors to react to, try random horizontal movement (gas expands/diffuses)
-    if (rand() % 3 == 0) // 1/3 chance to move horizontally
+    if (randomInt(3) == 0) // 1/3 chance to move horizontally
     {
-        int horizontalDir = (rand() % 2 == 0) ? -1 : 1;
+        int horizontalDir = (randomInt(2) == 0) ? -1 : 1;
         if (isValidGridPos(x + horizontalDir, y))
         {
-            Cell& dst = m_gridNext[gridIdx(x + horizontalDir, y)];
-            if (dst.type == ParticleType::Empty && !dst.updated)
+            CellRef dst = m_gridNext[gridIdx(x + horizontalDir, y)];
+            if (dst.type == ParticleType::Empty && !dst.isUpdated())
             {
                 if (tryMove(x, y, x + horizontalDir, y))
                     return;
@@ -2685,12 +2060,12 @@ void PowderScene::updateGas(int x, int y, const ParticleProperties& props, int p
     // Gas is at rest (no neighbors to react to and no random movement)
 }
 
-void PowderScene::addParticlesAt(const Vec2& worldPos, ParticleType type, float radius)
+void PowderScene::addParticlesAt(int gx, int gy, int radiusCells, ParticleType type)
 {
-    Vec2 gridPos = worldToGrid(worldPos);
-    int gx = (int)std::floor(gridPos.x);
-    int gy = (int)std::floor(gridPos.y);
-    int radiusCells = (int)(radius / m_cellSize);
+    // Brush placement draws from the seeded stream too, keyed by step and brush
+    // position, so a replayed edit drops exactly the same cells
+    const std::uint64_t brushStream = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(gx)) << 32) | static_cast<std::uint32_t>(gy);
+    seedRandom(0, brushStream ^ 0xB5B5000000000000ull);
     
     int count = 0;
     const int maxParticlesPerFrame = 200; // Limit for performance
@@ -2709,9 +2084,9 @@ void PowderScene::addParticlesAt(const Vec2& worldPos, ParticleType type, float
             float r2 = radiusCells * radiusCells;
             
             // Random placement for better distribution
-            if (dist2 <= r2 && rand() % 3 == 0) // 1/3 chance per cell
+            if (dist2 <= r2 && randomInt(3) == 0) // 1/3 chance per cell
             {
-                Cell& cell = getCell(x, y);
+                CellRef cell = getCell(x, y);
                 if (cell.type == ParticleType::Empty)
                 {
                     cell.type = type;
@@ -2763,15 +2138,208 @@ void PowderScene::addParticlesAt(const Vec2& worldPos, ParticleType type, float
             }
         }
     }
+
+    m_activity.markChanged(gx - radiusCells, gy - radiusCells, gx + radiusCells, gy + radiusCells);
+}
+
+
+void PowderScene::captureWorld(PowderWorldSnapshot& world) const
+{
+    world.width = m_gridWidth;
+    world.height = m_gridHeight;
+    world.randomSeed = static_cast<std::uint32_t>(m_randomSeed);
+    world.stepCount = m_stepCount;
+    world.ambientAirTemp = m_ambientAirTemp;
+
+    world.type.resize(m_grid.type.size());
+    std::transform(m_grid.type.begin(), m_grid.type.end(), world.type.begin(), [](ParticleType type) { return static_cast<std::uint8_t>(type); });
+    world.life = m_grid.life;
+    world.temperature = m_grid.temperature;
+
+    // Air only matters (and is only stepped) while it is enabled
+    world.airPressure = m_airEnabled ? m_airPressure : std::vector<float>();
+    world.airVelocityX = m_airEnabled ? m_airVelocityX : std::vector<float>();
+    world.airVelocityY = m_airEnabled ? m_airVelocityY : std::vector<float>();
+    world.airHeat = m_airEnabled ? m_airHeat : std::vector<float>();
+}
+
+bool PowderScene::restoreWorld(const PowderWorldSnapshot& world)
+{
+    const std::size_t cells = static_cast<std::size_t>(world.width) * world.height;
+    if (world.width <= 0 || world.height <= 0 || world.type.size() != cells || world.life.size() != cells || world.temperature.size() != cells)
+        return false;
+    if (world.hasAir() && (world.airPressure.size() != cells || world.airVelocityX.size() != cells || world.airVelocityY.size() != cells || world.airHeat.size() != cells))
+        return false;
+    for (std::uint8_t type : world.type)
+    {
+        if (type >= PowderParticleTypeCount)
+            return false;
+    }
+
+    if (world.width != m_gridWidth || world.height != m_gridHeight)
+        resizeGrid(world.width, world.height);
+
+    m_randomSeed = static_cast<int>(world.randomSeed);
+    m_stepCount = world.stepCount;
+    m_ambientAirTemp = world.ambientAirTemp;
+
+    std::transform(world.type.begin(), world.type.end(), m_grid.type.begin(), [](std::uint8_t type) { return static_cast<ParticleType>(type); });
+    m_grid.life = world.life;
+    m_grid.temperature = world.temperature;
+
+    if (world.hasAir())
+    {
+        m_airPressure = world.airPressure;
+        m_airVelocityX = world.airVelocityX;
+        m_airVelocityY = world.airVelocityY;
+        m_airHeat = world.airHeat;
+    }
+    else
+    {
+        clearAirSystem();
+    }
+
+    // Everything awake and dirty: the back buffer and block maps are rebuilt on the next step
+    m_activity.resize(m_gridWidth, m_gridHeight);
+    m_activity.markChanged(0, 0, m_gridWidth - 1, m_gridHeight - 1);
+    m_blockAirStale = true;
+    m_airWake.invalidate();
+    m_dirtyChunkCount = 0;
+    m_updatedCellCount = 0;
+    return true;
+}
+
+PowderReplaySettings PowderScene::captureReplaySettings() const
+{
+    PowderReplaySettings settings;
+    settings.substeps = m_substeps;
+    settings.alternateUpdate = m_alternateUpdate ? 1 : 0;
+    settings.airEnabled = m_airEnabled ? 1 : 0;
+    settings.cellSleeping = m_cellSleeping ? 1 : 0;
+    settings.parallelUpdate = m_parallelUpdate ? 1 : 0;
+    settings.airPressureLoss = m_airPressureLoss;
+    settings.airVelocityLoss = m_airVelocityLoss;
+    settings.airAdvectionMult = m_airAdvectionMult;
+    settings.airVorticityCoeff = m_airVorticityCoeff;
+    settings.airHeatConvection = m_airHeatConvection;
+    settings.wakeTemperatureDelta = m_wakeTemperatureDelta;
+    return settings;
+}
+
+void PowderScene::applyReplaySettings(const PowderReplaySettings& settings)
+{
+    m_substeps = std::max(1, static_cast<int>(settings.substeps));
+    m_alternateUpdate = settings.alternateUpdate != 0;
+    m_airEnabled = settings.airEnabled != 0;
+    m_cellSleeping = settings.cellSleeping != 0;
+    m_parallelUpdate = settings.parallelUpdate != 0;
+    m_airPressureLoss = settings.airPressureLoss;
+    m_airVelocityLoss = settings.airVelocityLoss;
+    m_airAdvectionMult = settings.airAdvectionMult;
+    m_airVorticityCoeff = settings.airVorticityCoeff;
+    m_airHeatConvection = settings.airHeatConvection;
+    m_wakeTemperatureDelta = settings.wakeTemperatureDelta;
+    m_airWake.invalidate();
+}
+
+void PowderScene::startRecording()
+{
+    m_replay = PowderReplay{};
+    captureWorld(m_replay.start);
+    m_replay.settings = captureReplaySettings();
+
+    // Continue from exactly the state a replay starts from (everything awake, block maps rebuilt)
+    restoreWorld(m_replay.start);
+    m_replayUpdates = 0;
+    m_replayMode = ReplayMode::Recording;
+    m_fileStatus = "Recording...";
+}
+
+void PowderScene::stopRecording()
+{
+    PowderWorldSnapshot world;
+    captureWorld(world);
+    m_replay.fixedUpdates = m_replayUpdates;
+    m_replay.finalHash = hashPowderWorld(world);
+    m_replayMode = ReplayMode::Off;
+
+    char status[256];
+    if (savePowderReplay(m_replayPath, m_replay))
+        std::snprintf(status, sizeof(status), "Saved %s: %llu updates, %zu edits", m_replayPath, (unsigned long long)m_replay.fixedUpdates, m_replay.events.size());
+    else
+        std::snprintf(status, sizeof(status), "Could not write %s", m_replayPath);
+    m_fileStatus = status;
+}
+
+bool PowderScene::startReplay()
+{
+    if (!loadPowderReplay(m_replayPath, m_replay))
+    {
+        m_fileStatus = std::string("Could not read ") + m_replayPath;
+        return false;
+    }
+
+    applyReplaySettings(m_replay.settings);
+    if (!restoreWorld(m_replay.start))
+    {
+        m_fileStatus = std::string("Invalid world in ") + m_replayPath;
+        return false;
+    }
+
+    m_replayCursor = 0;
+    m_replayUpdates = 0;
+    m_replayMode = ReplayMode::Playing;
+    m_fileStatus = "Playing replay...";
+    return true;
+}
+
+void PowderScene::runReplayHeadless()
+{
+    if (!startReplay())
+        return;
+
+    const bool paused = m_paused;
+    m_paused = false;
+    const auto start = std::chrono::steady_clock::now();
+    while (m_replayMode == ReplayMode::Playing)
+    {
+        fixedUpdate(m_replay.settings.fixedDt);
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_paused = paused;
+
+    const std::uint64_t steps = m_replay.fixedUpdates * static_cast<std::uint64_t>(m_substeps);
+    char status[256];
+    std::snprintf(status, sizeof(status), "%s\n%llu steps in %.1f ms (%.3f ms/step)", m_fileStatus.c_str(),
+        (unsigned long long)steps, ms, steps > 0 ? ms / steps : 0.0);
+    m_fileStatus = status;
+}
+
+void PowderScene::applyReplayEvents()
+{
+    while (m_replayCursor < m_replay.events.size() && m_replay.events[m_replayCursor].step <= m_stepCount)
+    {
+        applyEdit(m_replay.events[m_replayCursor++]);
+    }
 }
 
+void PowderScene::finishReplay()
+{
+    // Edits made after the last recorded update are part of the final world
+    applyReplayEvents();
+    m_replayMode = ReplayMode::Off;
+
+    PowderWorldSnapshot world;
+    captureWorld(world);
+    m_fileStatus = (hashPowderWorld(world) == m_replay.finalHash) ? "Replay matches the recording" : "Replay DIVERGED from the recording";
+}
 
 void PowderScene::render(GraphicsEngine& engine, SwapChain& swapChain)
 {
     auto& ctx = engine.getContext();
 
     // Set up camera
-    if (auto* cameraEntity = m_entityManager->findEntity("MainCamera"))
+    if (auto* cameraEntity = m_entityManager->getEntity(m_cameraEntity))
     {
         if (auto* camera = cameraEntity->getComponent<Camera2D>())
         {
@@ -2785,20 +2353,23 @@ void PowderScene::render(GraphicsEngine& engine, SwapChain& swapChain)
     ctx.enableDepthTest();
     ctx.enableAlphaBlending();
 
-    // Render air velocity visualization first (behind particles)
+    AllocationScope spriteAllocScope;
+
+    // Air velocity and pressure overlays first (behind particles), all in one batch
     if (m_airEnabled && m_showAirVelocity)
     {
-        renderAirVelocity(engine, ctx);
+        batchAirVelocity();
     }
-    
-    // Render air pressure visualization (behind particles)
     if (m_airEnabled && m_showAirPressure)
     {
-        renderAirPressure(engine, ctx);
+        batchAirPressure();
     }
 
-    // Render particles on top
-    renderParticles(engine, ctx);
+    // Particles on top
+    batchParticles();
+    if (m_particleBatchDevice) m_particleBatchDevice->draw(engine, ctx, m_particleBatch);
+    m_particleBatch.clear();
+    m_spriteAllocations = spriteAllocScope.allocations();
 
     // Debug grid
     if (m_lineRenderer)
@@ -2821,119 +2392,55 @@ void PowderScene::render(GraphicsEngine& engine, SwapChain& swapChain)
             Vec2 end = gridToWorld(m_gridWidth, y);
             m_lineRenderer->addLine(start, end, gridColor, 1.0f);
         }
-        m_lineRenderer->updateBuffer();
-        m_lineRenderer->draw(ctx);
-    }
-}
-
-void PowderScene::renderParticles(GraphicsEngine& engine, DeviceContext& ctx)
-{
-    // Create or update sprite entities for visible particles
-    int totalCells = m_gridWidth * m_gridHeight;
-
-    // Create sprites on demand (simplified approach - could be optimized with pooling)
-    static int lastCellCount = 0;
-    static std::vector<std::string> entityNames;
-
-    // Create new entities if needed
-    if (totalCells > entityNames.size())
-    {
-        int needed = totalCells - (int)entityNames.size();
-        for (int i = 0; i < needed; ++i)
-        {
-            std::string name = "PowderParticle_" + std::to_string(entityNames.size());
-            entityNames.push_back(name);
-            auto& e = m_entityManager->createEntity(name);
-            auto& s = e.addComponent<SpriteComponent>(
-                *m_graphicsDevice, 
-                L"DX3D/Assets/Textures/node.png", 
-                m_cellSize, 
-                m_cellSize);
-            s.setVisible(false);
-        }
     }
 
-    // Render all cells (particles)
-    int spriteIndex = 0;
-    for (int y = 0; y < m_gridHeight; ++y)
+    if (m_showChunks && m_lineRenderer)
     {
-        for (int x = 0; x < m_gridWidth; ++x)
+        Vec4 chunkColor = Vec4(1.0f, 0.8f, 0.2f, 0.6f);
+        for (const Chunk& chunk : m_activity.getChunks())
         {
-            const Cell& cell = getCell(x, y);
-            Vec2 worldPos = gridToWorld(x, y);
-            
-            // Get particle color from properties
-            Vec4 particleColor = Vec4(0.0f, 0.0f, 0.0f, 0.0f); // Empty cells are transparent
-            if (cell.type != ParticleType::Empty)
-            {
-                particleColor = getParticleProperties(cell.type).color;
-            }
-            
-            // Render if there's a particle
-            if (cell.type != ParticleType::Empty)
-            {
-                if (spriteIndex >= (int)entityNames.size())
-                    break;
+            if (chunk.awake.isEmpty())
+                continue;
 
-                std::string& name = entityNames[spriteIndex];
-                auto* entity = m_entityManager->findEntity(name);
-                if (entity)
-                {
-                    auto* sprite = entity->getComponent<SpriteComponent>();
-                    if (sprite)
-                    {
-                        sprite->setPosition(worldPos.x, worldPos.y, 0.1f); // Slightly in front
-                        sprite->setTint(particleColor);
-                        sprite->setVisible(true);
-                        sprite->draw(ctx);
-                    }
-                }
-                spriteIndex++;
-            }
+            Vec2 lo = gridToWorld(chunk.awake.minX, chunk.awake.minY);
+            Vec2 hi = gridToWorld(chunk.awake.maxX + 1, chunk.awake.maxY + 1);
+            m_lineRenderer->addLine(Vec2(lo.x, lo.y), Vec2(hi.x, lo.y), chunkColor, 1.0f);
+            m_lineRenderer->addLine(Vec2(hi.x, lo.y), Vec2(hi.x, hi.y), chunkColor, 1.0f);
+            m_lineRenderer->addLine(Vec2(hi.x, hi.y), Vec2(lo.x, hi.y), chunkColor, 1.0f);
+            m_lineRenderer->addLine(Vec2(lo.x, hi.y), Vec2(lo.x, lo.y), chunkColor, 1.0f);
         }
     }
 
-    // Hide unused sprites
-    for (int i = spriteIndex; i < (int)entityNames.size(); ++i)
+    if ((m_showGrid || m_showChunks) && m_lineRenderer)
     {
-        auto* entity = m_entityManager->findEntity(entityNames[i]);
-        if (entity)
-        {
-            auto* sprite = entity->getComponent<SpriteComponent>();
-            if (sprite)
-                sprite->setVisible(false);
-        }
+        m_lineRenderer->updateBuffer();
+        m_lineRenderer->draw(ctx);
     }
 }
 
-void PowderScene::renderAirVelocity(GraphicsEngine& engine, DeviceContext& ctx)
+void PowderScene::batchParticles()
 {
-    // Create or update sprite entities for air velocity visualization
-    int totalCells = m_gridWidth * m_gridHeight;
-
-    // Create sprites on demand (simplified approach - could be optimized with pooling)
-    static std::vector<std::string> airEntityNames;
-
-    // Create new entities if needed
-    if (totalCells > airEntityNames.size())
+    // One quad per occupied cell
+    const float size = m_cellSize;
+    for (int y = 0; y < m_gridHeight; ++y)
     {
-        int needed = totalCells - (int)airEntityNames.size();
-        for (int i = 0; i < needed; ++i)
+        for (int x = 0; x < m_gridWidth; ++x)
         {
-            std::string name = "AirVelocity_" + std::to_string(airEntityNames.size());
-            airEntityNames.push_back(name);
-            auto& e = m_entityManager->createEntity(name);
-            auto& s = e.addComponent<SpriteComponent>(
-                *m_graphicsDevice, 
-                L"DX3D/Assets/Textures/node.png", 
-                m_cellSize, 
-                m_cellSize);
-            s.setVisible(false);
+            ConstCellRef cell = getCell(x, y);
+            if (cell.type == ParticleType::Empty)
+                continue;
+
+            Vec2 worldPos = gridToWorld(x, y);
+            const Vec4& particleColor = getParticleColor(cell.type);
+            m_particleBatch.add(m_nodeMaterial, worldPos.x, worldPos.y, size,
+                packParticleColor(particleColor.x, particleColor.y, particleColor.z, particleColor.w));
         }
     }
+}
 
+void PowderScene::batchAirVelocity()
+{
     // Render air velocity as color overlay
-    int spriteIndex = 0;
     const float maxVelocity = 20.0f; // Maximum velocity for color mapping
     
     for (int y = 0; y < m_gridHeight; ++y)
@@ -2983,69 +2490,17 @@ void PowderScene::renderAirVelocity(GraphicsEngine& engine, DeviceContext& ctx)
                 velocityColor = Vec4(t, 0.0f, 1.0f - t, alpha); // Blue -> Red
             }
 
-            // Render velocity overlay
-            if (spriteIndex >= (int)airEntityNames.size())
-                break;
-
+            // Render velocity overlay (batched before the particles, so behind them)
             Vec2 worldPos = gridToWorld(x, y);
-            std::string& name = airEntityNames[spriteIndex];
-            auto* entity = m_entityManager->findEntity(name);
-            if (entity)
-            {
-                auto* sprite = entity->getComponent<SpriteComponent>();
-                if (sprite)
-                {
-                    sprite->setPosition(worldPos.x, worldPos.y, -0.1f); // Behind particles
-                    sprite->setTint(velocityColor);
-                    sprite->setVisible(true);
-                    sprite->draw(ctx);
-                }
-            }
-            spriteIndex++;
-        }
-    }
-
-    // Hide unused sprites
-    for (int i = spriteIndex; i < (int)airEntityNames.size(); ++i)
-    {
-        auto* entity = m_entityManager->findEntity(airEntityNames[i]);
-        if (entity)
-        {
-            auto* sprite = entity->getComponent<SpriteComponent>();
-            if (sprite)
-                sprite->setVisible(false);
+            m_particleBatch.add(m_nodeMaterial, worldPos.x, worldPos.y, m_cellSize,
+                packParticleColor(velocityColor.x, velocityColor.y, velocityColor.z, velocityColor.w));
         }
     }
 }
 
-void PowderScene::renderAirPressure(GraphicsEngine& engine, DeviceContext& ctx)
+void PowderScene::batchAirPressure()
 {
-    // Create or update sprite entities for air pressure visualization
-    int totalCells = m_gridWidth * m_gridHeight;
-
-    // Create sprites on demand (simplified approach - could be optimized with pooling)
-    static std::vector<std::string> airPressureEntityNames;
-
-    // Create new entities if needed
-    if (totalCells > airPressureEntityNames.size())
-    {
-        int needed = totalCells - (int)airPressureEntityNames.size();
-        for (int i = 0; i < needed; ++i)
-        {
-            std::string name = "AirPressure_" + std::to_string(airPressureEntityNames.size());
-            airPressureEntityNames.push_back(name);
-            auto& e = m_entityManager->createEntity(name);
-            auto& s = e.addComponent<SpriteComponent>(
-                *m_graphicsDevice, 
-                L"DX3D/Assets/Textures/node.png", 
-                m_cellSize, 
-                m_cellSize);
-            s.setVisible(false);
-        }
-    }
-
     // Render air pressure as color overlay
-    int spriteIndex = 0;
     const float maxPressure = 50.0f; // Maximum pressure for color mapping
     
     for (int y = 0; y < m_gridHeight; ++y)
@@ -3098,39 +2553,19 @@ void PowderScene::renderAirPressure(GraphicsEngine& engine, DeviceContext& ctx)
                 pressureColor = Vec4(0.0f, 0.5f, 0.0f, 0.3f); // Green, semi-transparent
             }
 
-            // Render pressure overlay
-            if (spriteIndex >= (int)airPressureEntityNames.size())
-                break;
-
+            // Render pressure overlay (batched before the particles, so behind them)
             Vec2 worldPos = gridToWorld(x, y);
-            std::string& name = airPressureEntityNames[spriteIndex];
-            auto* entity = m_entityManager->findEntity(name);
-            if (entity)
-            {
-                auto* sprite = entity->getComponent<SpriteComponent>();
-                if (sprite)
-                {
-                    sprite->setPosition(worldPos.x, worldPos.y, -0.1f); // Behind particles
-                    sprite->setTint(pressureColor);
-                    sprite->setVisible(true);
-                    sprite->draw(ctx);
-                }
-            }
-            spriteIndex++;
+            m_particleBatch.add(m_nodeMaterial, worldPos.x, worldPos.y, m_cellSize,
+                packParticleColor(pressureColor.x, pressureColor.y, pressureColor.z, pressureColor.w));
         }
     }
+}
 
-    // Hide unused sprites
-    for (int i = spriteIndex; i < (int)airPressureEntityNames.size(); ++i)
-    {
-        auto* entity = m_entityManager->findEntity(airPressureEntityNames[i]);
-        if (entity)
-        {
-            auto* sprite = entity->getComponent<SpriteComponent>();
-            if (sprite)
-                sprite->setVisible(false);
-        }
-    }
+void PowderScene::onFrameEnd()
+{
+    Scene::onFrameEnd();
+    m_frameAllocations = m_frameAllocScope.allocations();
+    m_frameAllocScope.reset();
 }
 
 void PowderScene::renderImGui(GraphicsEngine& engine)
@@ -3140,25 +2575,30 @@ void PowderScene::renderImGui(GraphicsEngine& engine)
     {
         float fps = (m_smoothDt > 0.0f) ? (1.0f / m_smoothDt) : 0.0f;
         ImGui::Text("FPS: %.1f (dt=%.3f ms)", fps, m_smoothDt * 1000.0f);
+        if (AllocationCounter::enabled)
+            ImGui::Text("Heap allocs/frame: %llu (sprite passes: %llu)",
+                (unsigned long long)m_frameAllocations, (unsigned long long)m_spriteAllocations);
+        else
+            ImGui::Text("Heap allocs/frame: n/a");
         ImGui::Checkbox("Paused (P)", &m_paused);
 
         // Count particles
         int sandCount = 0, waterCount = 0, stoneCount = 0, woodCount = 0, gasCount = 0, acidCount = 0, fireCount = 0, smokeCount = 0, steamCount = 0, metalCount = 0, lavaCount = 0, mudCount = 0, oilCount = 0;
-        for (const auto& cell : m_grid)
-        {
-            if (cell.type == ParticleType::Sand) sandCount++;
-            else if (cell.type == ParticleType::Water) waterCount++;
-            else if (cell.type == ParticleType::Stone) stoneCount++;
-            else if (cell.type == ParticleType::Wood) woodCount++;
-            else if (cell.type == ParticleType::Gas) gasCount++;
-            else if (cell.type == ParticleType::Acid) acidCount++;
-            else if (cell.type == ParticleType::Fire) fireCount++;
-            else if (cell.type == ParticleType::Smoke) smokeCount++;
-            else if (cell.type == ParticleType::Steam) steamCount++;
-            else if (cell.type == ParticleType::Metal) metalCount++;
-            else if (cell.type == ParticleType::Lava) lavaCount++;
-            else if (cell.type == ParticleType::Mud) mudCount++;
-            else if (cell.type == ParticleType::Oil) oilCount++;
+        for (ParticleType type : m_grid.type)
+        {
+            if (type == ParticleType::Sand) sandCount++;
+            else if (type == ParticleType::Water) waterCount++;
+            else if (type == ParticleType::Stone) stoneCount++;
+            else if (type == ParticleType::Wood) woodCount++;
+            else if (type == ParticleType::Gas) gasCount++;
+            else if (type == ParticleType::Acid) acidCount++;
+            else if (type == ParticleType::Fire) fireCount++;
+            else if (type == ParticleType::Smoke) smokeCount++;
+            else if (type == ParticleType::Steam) steamCount++;
+            else if (type == ParticleType::Metal) metalCount++;
+            else if (type == ParticleType::Lava) lavaCount++;
+            else if (type == ParticleType::Mud) mudCount++;
+            else if (type == ParticleType::Oil) oilCount++;
         }
         ImGui::Text("Particles: Sand=%d, Water=%d, Stone=%d, Wood=%d, Gas=%d, Acid=%d, Fire=%d, Smoke=%d, Steam=%d, Metal=%d, Lava=%d, Mud=%d, Oil=%d", 
                     sandCount, waterCount, stoneCount, woodCount, gasCount, acidCount, fireCount, smokeCount, steamCount, metalCount, lavaCount, mudCount, oilCount);
@@ -3169,6 +2609,32 @@ void PowderScene::renderImGui(GraphicsEngine& engine)
         ImGui::Checkbox("Alternate Update", &m_alternateUpdate);
         ImGui::Text("(Alternating improves flow)");
 
+        // Grid size (resizing clears the simulation)
+        const int gridSizes[][2] = { { 200, 150 }, { 512, 512 }, { 1024, 1024 } };
+        const char* gridSizeNames[] = { "200 x 150", "512 x 512", "1024 x 1024" };
+        int gridSize = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (m_gridWidth == gridSizes[i][0] && m_gridHeight == gridSizes[i][1]) gridSize = i;
+        }
+        if (ImGui::Combo("Grid Size", &gridSize, gridSizeNames, 3))
+        {
+            resizeGrid(gridSizes[gridSize][0], gridSizes[gridSize][1]);
+        }
+        ImGui::Checkbox("Sleep Idle Cells", &m_cellSleeping);
+        ImGui::Checkbox("Parallel Update (checkerboard)", &m_parallelUpdate);
+        if (m_parallelUpdate)
+        {
+            int maxThreads = static_cast<int>(JobSystem::getInstance().getThreadCount());
+            ImGui::SliderInt("Threads", &m_threadCount, 1, maxThreads);
+        }
+        ImGui::InputInt("Seed", &m_randomSeed);
+        const int totalCells = m_gridWidth * m_gridHeight;
+        const int awakeCells = m_activity.getAwakeCellCount();
+        ImGui::Text("Active cells: %d / %d (%.1f%%)", awakeCells, totalCells, totalCells > 0 ? 100.0f * awakeCells / totalCells : 0.0f);
+        ImGui::Text("Chunks: %d / %d awake, %d synced", m_activity.getAwakeChunkCount(), m_activity.getChunksX() * m_activity.getChunksY(), m_dirtyChunkCount);
+        ImGui::Text("Cells updated: %d", m_updatedCellCount);
+
         ImGui::Separator();
         ImGui::Text("Tools");
         
@@ -3217,6 +2683,7 @@ void PowderScene::renderImGui(GraphicsEngine& engine)
         ImGui::Separator();
         ImGui::Text("Visualization");
         ImGui::Checkbox("Show Grid", &m_showGrid);
+        ImGui::Checkbox("Show Awake Chunks", &m_showChunks);
         if (m_airEnabled)
         {
             ImGui::Checkbox("Show Air Velocity", &m_showAirVelocity);
@@ -3236,6 +2703,19 @@ void PowderScene::renderImGui(GraphicsEngine& engine)
             ImGui::SliderFloat("Advection Mult", &m_airAdvectionMult, 0.1f, 1.0f, "%.2f");
             ImGui::SliderFloat("Vorticity Coeff", &m_airVorticityCoeff, 0.0f, 1.0f, "%.2f");
             ImGui::SliderFloat("Heat Convection", &m_airHeatConvection, 0.0f, 0.001f, "%.5f");
+            if (ImGui::SliderFloat("Wake Temp Delta (K)", &m_wakeTemperatureDelta, 0.1f, 50.0f, "%.1f"))
+                m_airWake.invalidate();
+            
+            // Stencil instruction set (only what this build was compiled for)
+            const char* simdNames[] = { getPowderAirSimdName(PowderAirSimd::Scalar), getPowderAirSimdName(PowderAirSimd::Sse2), getPowderAirSimdName(PowderAirSimd::Avx2) };
+            int simd = static_cast<int>(m_airStencil.getSimd());
+            if (ImGui::Combo("Air Kernels", &simd, simdNames, static_cast<int>(getPowderAirSimdSupport()) + 1))
+            {
+                m_airStencil.setSimd(static_cast<PowderAirSimd>(simd));
+            }
+            ImGui::Text("Air step: %.2f ms", m_airStepMs);
+            if (m_cellSleeping)
+                ImGui::Text("Air wake: %d chunks tested", m_airWakeChunkCount);
             
             // Display some air stats
             float avgPressure = 0.0f;
@@ -3285,10 +2765,54 @@ void PowderScene::renderImGui(GraphicsEngine& engine)
             }
         }
 
+        ImGui::Separator();
+        ImGui::Text("World Files");
+        const bool idle = m_replayMode == ReplayMode::Off;
+        if (!idle) ImGui::BeginDisabled(true);
+        ImGui::InputText("World", m_worldPath, sizeof(m_worldPath));
+        if (ImGui::Button("Save World"))
+        {
+            PowderWorldSnapshot world;
+            captureWorld(world);
+            m_fileStatus = (savePowderWorld(m_worldPath, world) ? "Saved " : "Could not write ") + std::string(m_worldPath);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load World"))
+        {
+            PowderWorldSnapshot world;
+            m_fileStatus = (loadPowderWorld(m_worldPath, world) && restoreWorld(world) ? "Loaded " : "Could not load ") + std::string(m_worldPath);
+        }
+        ImGui::InputText("Replay", m_replayPath, sizeof(m_replayPath));
+        if (!idle) ImGui::EndDisabled();
+
+        if (m_replayMode == ReplayMode::Recording)
+        {
+            ImGui::Text("Recording: %llu updates, %zu edits", (unsigned long long)m_replayUpdates, m_replay.events.size());
+            if (ImGui::Button("Stop Recording")) stopRecording();
+        }
+        else if (m_replayMode == ReplayMode::Playing)
+        {
+            ImGui::Text("Playing: %llu / %llu updates", (unsigned long long)m_replayUpdates, (unsigned long long)m_replay.fixedUpdates);
+            if (ImGui::Button("Stop Replay")) m_replayMode = ReplayMode::Off;
+        }
+        else
+        {
+            if (ImGui::Button("Record")) startRecording();
+            ImGui::SameLine();
+            if (ImGui::Button("Play")) startReplay();
+            ImGui::SameLine();
+            if (ImGui::Button("Replay Headless")) runReplayHeadless();
+            ImGui::Text("(Settings are captured when recording starts)");
+        }
+        if (!m_fileStatus.empty()) ImGui::TextWrapped("%s", m_fileStatus.c_str());
+
+        // Clearing is not a recorded edit
+        if (!idle) ImGui::BeginDisabled(true);
         if (ImGui::Button("Clear All", ImVec2(-FLT_MIN, 0)))
         {
             clearGrid();
         }
+        if (!idle) ImGui::EndDisabled();
     }
     ImGui::End();
 }
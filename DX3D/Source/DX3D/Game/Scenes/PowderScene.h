@@ -3,14 +3,23 @@
 #include <DX3D/Graphics/GraphicsEngine.h>
 #include <DX3D/Graphics/Camera.h>
 #include <DX3D/Graphics/SpriteComponent.h>
+#include <DX3D/Graphics/ParticleBatchDevice.h>
 #include <DX3D/Core/EntityManager.h>
 #include <DX3D/Core/Input.h>
+#include <DX3D/Core/AllocationCounter.h>
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/PowderElements.h>
+#include <DX3D/Game/Scenes/PowderAirKernels.h>
+#include <DX3D/Game/Scenes/PowderActivity.h>
+#include <DX3D/Game/Scenes/PowderAirWake.h>
+#include <DX3D/Game/Scenes/PowderWorldFile.h>
 #include <DX3D/Graphics/LineRenderer.h>
 #include <DX3D/Math/Geometry.h>
+#include <array>
 #include <vector>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <algorithm>
 #include <cstdint>
 
 namespace dx3d
@@ -27,66 +36,109 @@ namespace dx3d
         void fixedUpdate(float dt) override;
         void render(GraphicsEngine& engine, SwapChain& swapChain) override;
         void renderImGui(GraphicsEngine& engine) override;
+        void onFrameEnd() override;
 
     private:
-        // States of matter - base behaviors for particles
-        enum class MatterState : uint8_t
+        // Element data lives in PowderElementTable (PowderElements.h)
+        using MatterState = PowderMatterState;
+        using ParticleType = PowderParticleType;
+        using ParticleProperties = PowderParticleProperties;
+
+        // Mutable view of one cell across the SoA planes. "updated" is a per-cell
+        // step stamp, so a new step invalidates every flag without touching the grid.
+        struct CellRef
         {
-            Solid = 0,   // Do not move via non-chemical reactions
-            Powder = 1,  // Only fall via non-chemical reactions, but will not spread as liquids do
-            Liquid = 2,  // Random horizontal movement each frame, then fall down. Can float above denser liquids/powders
-            Gas = 3      // Repels from other gas particles and reacts to other particles (no gravity movement)
+            ParticleType& type;
+            std::int16_t& life; // Life value for particles that need it (e.g., acid, fire lifetime, smoke lifetime)
+            float& temperature; // Temperature in Kelvin (default ~22°C)
+            std::uint16_t& stamp;
+            std::uint16_t step;
+
+            bool isUpdated() const { return stamp == step; } // Prevent double-updating in same frame
+            void markUpdated() { stamp = step; }
         };
 
-        // Particle types
-        enum class ParticleType : uint8_t
+        struct ConstCellRef
         {
-            Empty = 0,
-            Sand = 1,
-            Water = 2,
-            Stone = 3,
-            Wood = 4,
-            Gas = 5,
-            Acid = 6,
-            Fire = 7,
-            Smoke = 8,
-            Steam = 9,
-            Metal = 10,
-            Lava = 11,
-            Mud = 12,
-            Oil = 13,
-            // More types can be added later
+            const ParticleType& type;
+            const std::int16_t& life;
+            const float& temperature;
+
+            ConstCellRef(const ParticleType& t, const std::int16_t& l, const float& temp) : type(t), life(l), temperature(temp) {}
+            ConstCellRef(const CellRef& cell) : type(cell.type), life(cell.life), temperature(cell.temperature) {}
         };
 
-        // Particle behavior properties (data-driven)
-        struct ParticleProperties
+        // Grid cell data, one plane per field (structure of arrays)
+        struct CellPlanes
         {
-            MatterState matterState = MatterState::Solid;  // Base state of matter
-            float density = 1.0f;
-            Vec4 color = Vec4(1.0f, 1.0f, 1.0f, 1.0f);
-            float movementChance = 1.0f; // Chance for the particle to attempt movement each frame (0.0 - 1.0)
-            bool flammable = false; // Can this particle be ignited by fire?
-            float ignitionTemp = 500.0f; // Temperature (Kelvin) at which this particle ignites
-            float burnTemp = 1000.0f; // Temperature (Kelvin) this particle produces when burning
+            std::vector<ParticleType> type;
+            std::vector<std::int16_t> life;
+            std::vector<float> temperature;
+            std::vector<std::uint16_t> updatedStamp;
+            std::uint16_t step = 1;
+
+            void resize(int count);
+            // Reset every cell to empty air at ambient temperature
+            void clear();
+            // Start a new step: every updated flag reads false afterwards
+            void beginStep();
+            // Copy count cells starting at index begin from another grid of the same size
+            void copyCells(const CellPlanes& from, int begin, int count);
+            bool differs(const CellPlanes& other, int index) const
+            {
+                return type[index] != other.type[index] || life[index] != other.life[index] || temperature[index] != other.temperature[index];
+            }
+            void swap(CellPlanes& other);
+
+            CellRef operator[](int index) { return { type[index], life[index], temperature[index], updatedStamp[index], step }; }
+            ConstCellRef operator[](int index) const { return { type[index], life[index], temperature[index] }; }
         };
 
-        // Grid cell data
-        struct Cell
+        using CellRect = PowderCellRect;
+        using Chunk = PowderChunk;
+
+        // xorshift32 stream. Particle updates draw from the slot of the calling job system
+        // thread, which is reseeded from (seed, step, chunk) before each chunk, so results
+        // do not depend on which thread ran which chunk.
+        struct alignas(64) CellRandom
         {
-            ParticleType type = ParticleType::Empty;
-            bool updated = false; // Prevent double-updating in same frame
-            int life = 0; // Life value for particles that need it (e.g., acid, fire lifetime, smoke lifetime)
-            float temperature = 273.15f + 22.0f; // Temperature in Kelvin (default ~22°C)
+            std::uint32_t state = 0x9E3779B9u;
+
+            void seed(std::uint64_t value);
+            std::uint32_t next()
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                return state;
+            }
         };
 
+        static constexpr int ChunkSize = PowderActivityMap::ChunkSize;
+        static constexpr int CellWriteReach = 2;   // farthest cell a particle update writes (fire spawned next to an ignited neighbor)
+        static constexpr int FireDraftRadius = 3;  // farthest air cell a particle update writes (applyFireDraft)
+        static constexpr int UpdateWriteReach = std::max(CellWriteReach, FireDraftRadius);
+        static constexpr int AirRowGrain = 16;     // rows per job in the air passes
+
         // Helper functions
         void createCamera(GraphicsEngine& engine);
         void initializeGrid();
         void clearGrid();
         void updateGrid(float dt);
-        void renderParticles(GraphicsEngine& engine, DeviceContext& ctx);
-        void renderAirVelocity(GraphicsEngine& engine, DeviceContext& ctx);
-        void renderAirPressure(GraphicsEngine& engine, DeviceContext& ctx);
+        // Update one cell if it holds a particle not yet updated this step
+        bool updateCell(int x, int y, float dt);
+        // Serial sweep over the awake cells in the classic alternating scan order
+        int updateCellsSerial(float dt, bool topDown);
+        // Checkerboard: four phases of chunks, each phase a parallelFor over chunks that are
+        // a whole chunk apart, so no two threads touch the same cells or air
+        int updateChunksParallel(float dt, bool topDown);
+        int updateChunk(int chunkIndex, float dt, bool topDown);
+        // Resize the simulation (grid, chunks and air) and center it on the origin
+        void resizeGrid(int width, int height);
+        // Add the cells / air overlays to m_particleBatch
+        void batchParticles();
+        void batchAirVelocity();
+        void batchAirPressure();
         Vec2 getMouseWorldPosition() const;
 
         // Grid access
@@ -95,15 +147,21 @@ namespace dx3d
         { 
             return x >= 0 && x < m_gridWidth && y >= 0 && y < m_gridHeight; 
         }
-        inline Cell& getCell(int x, int y) { return m_grid[gridIdx(x, y)]; }
-        inline const Cell& getCell(int x, int y) const { return m_grid[gridIdx(x, y)]; }
+        inline CellRef getCell(int x, int y) { return m_grid[gridIdx(x, y)]; }
+        inline ConstCellRef getCell(int x, int y) const { return m_grid[gridIdx(x, y)]; }
+
+        // Dirty-cell tracking (m_activity)
+        // Copy cells changed since the last step into m_gridNext so it matches m_grid again
+        void syncBackBuffer();
+        // Wake sleeping particles the air would push or whose temperature lags the air (m_airWake)
+        void wakeFromAir();
 
         // Unified particle update function (uses matter state)
         void updateParticle(int x, int y, float dt);
         
         // Matter state update functions
-        void updatePowder(int x, int y, const ParticleProperties& props, float dt, int preferredDirX = 0, int preferredDirY = 0);
-        void updateLiquid(int x, int y, const ParticleProperties& props, float dt, int preferredDirX = 0, int preferredDirY = 0);
+        void updatePowder(int x, int y, const ParticleProperties& props, int preferredDirX = 0, int preferredDirY = 0);
+        void updateLiquid(int x, int y, const ParticleProperties& props, int preferredDirX = 0, int preferredDirY = 0);
         void updateGas(int x, int y, const ParticleProperties& props, int preferredDirX = 0, int preferredDirY = 0);
         
         // Helper for particle movement
@@ -115,23 +173,32 @@ namespace dx3d
         void addParticleMovementToAir(int x, int y, int newX, int newY, const ParticleProperties& props);
         
         // Air test functions
-        void createAirImpulse(const Vec2& worldPos, float strength, float radius);
+        void createAirImpulse(int centerX, int centerY, int radiusCells, float strength);
         
+        // Deterministic randomness for particle updates
+        CellRandom& random() { return m_random[JobSystem::getInstance().getThreadIndex()]; }
+        int randomInt(int n) { return static_cast<int>(random().next() % static_cast<std::uint32_t>(n)); } // [0, n)
+        float randomFloat() { return (random().next() >> 8) * (1.0f / 16777215.0f); } // [0, 1]
+        void seedRandom(int slot, std::uint64_t stream);
+
         // Particle properties management
         void initializeParticleProperties();
-        const ParticleProperties& getParticleProperties(ParticleType type) const;
+        const ParticleProperties& getParticleProperties(ParticleType type) const { return m_elements.getProperties(type); }
+        const Vec4& getParticleColor(ParticleType type) const { return m_particleColors[static_cast<int>(type)]; }
         
-        // Corrosion helper
-        bool canCorrode(ParticleType type) const;
+        // Reactions with the 8 neighbors from the element table; false when the particle was consumed or converted
+        bool applyReactions(int x, int y, const ParticleProperties& props, float dt);
         
         // Fire system helpers
-        void updateFireAndIgnition(int x, int y, float dt);
-        void tryIgniteNeighbor(int x, int y, int dx, int dy);
+        void applyFireDraft(int x, int y, float strength, float dt);
         void createFireParticle(int x, int y);
         void createSmokeParticle(int x, int y);
         
-        // Mouse interaction
-        void addParticlesAt(const Vec2& worldPos, ParticleType type, float radius);
+        // Mouse interaction. Tools go through applyEdit in grid space, so a replay can repeat them.
+        void submitEdit(PowderEditKind kind, const Vec2& worldPos);
+        void applyEdit(const PowderReplayEvent& edit);
+        void addParticlesAt(int gx, int gy, int radiusCells, ParticleType type);
+        void eraseParticlesAt(int gx, int gy, int radiusCells);
         Vec2 worldToGrid(const Vec2& worldPos) const;
         Vec2 gridToWorld(int x, int y) const;
 
@@ -144,25 +211,74 @@ namespace dx3d
         void updateAirHeat(float dt);
         void updateBlockAirMaps();
         void makeKernel(); // Gaussian kernel for air smoothing
-        float vorticity(int x, int y) const; // Calculate vorticity for velocity field
+
+        // World files and input replay (PowderWorldFile.h)
+        void captureWorld(PowderWorldSnapshot& world) const;
+        // Replace the simulation with a snapshot (resizing if needed); false if it holds unknown elements
+        bool restoreWorld(const PowderWorldSnapshot& world);
+        PowderReplaySettings captureReplaySettings() const;
+        void applyReplaySettings(const PowderReplaySettings& settings);
+        void startRecording();
+        void stopRecording();
+        // Restore the replay's start world and settings; fixedUpdate then plays it back
+        bool startReplay();
+        // Play the loaded replay to the end without rendering and time it
+        void runReplayHeadless();
+        // Apply recorded edits due at the current step
+        void applyReplayEvents();
+        void finishReplay();
+
+        // Semi-Lagrangian advection of the smoothed fields, per row band (rows are independent)
+        void advectAirRows(int rowBegin, int rowEnd);
+        void advectAirHeatRows(int rowBegin, int rowEnd);
+        int getAirThreadCount() const { return m_parallelUpdate ? std::max(1, m_threadCount) : 1; }
         
         // Air system access
         inline float& getAirPressure(int x, int y) { return m_airPressure[gridIdx(x, y)]; }
         inline float& getAirVelocityX(int x, int y) { return m_airVelocityX[gridIdx(x, y)]; }
         inline float& getAirVelocityY(int x, int y) { return m_airVelocityY[gridIdx(x, y)]; }
         inline float& getAirHeat(int x, int y) { return m_airHeat[gridIdx(x, y)]; }
+        PowderAirFields getAirFields() const
+        {
+            return { m_airPressure.data(), m_airVelocityX.data(), m_airVelocityY.data(), m_airHeat.data(), m_gridWidth, m_gridHeight };
+        }
 
         // ECS
-        std::unique_ptr<EntityManager> m_entityManager;
+        EntityHandle m_cameraEntity;
+        // Cells and air overlays are node.png quads in one batch, not a sprite entity each
+        ParticleBatchRenderer m_particleBatch;
+        std::unique_ptr<ParticleBatchDevice> m_particleBatchDevice;
+        ui32 m_nodeMaterial = 0;
+        // Heap allocations in the last frame (all threads) and in the sprite passes alone
+        AllocationScope m_frameAllocScope;
+        std::uint64_t m_frameAllocations = 0;
+        std::uint64_t m_spriteAllocations = 0;
         GraphicsDevice* m_graphicsDevice = nullptr;
         LineRenderer* m_lineRenderer = nullptr;
 
         // Grid simulation
-        std::vector<Cell> m_grid;
-        std::vector<Cell> m_gridNext; // Double buffering for parallel updates
+        CellPlanes m_grid;
+        CellPlanes m_gridNext; // Double buffering for parallel updates
         
         int m_gridWidth = 200;
         int m_gridHeight = 150;
+
+        // Awake cells and dirty rects per chunk
+        PowderActivityMap m_activity;
+        bool m_cellSleeping = true; // false simulates every cell every step
+        float m_wakeTemperatureDelta = 1.0f; // air/particle temperature gap (K) that wakes a sleeping particle
+        PowderAirWake m_airWake; // chunks the air field can wake particles in
+        // Parallel update
+        bool m_parallelUpdate = true;
+        int m_threadCount = 1; // threads used per phase; set to all job system threads on load
+        std::vector<int> m_phaseChunks; // awake chunks of the current checkerboard phase
+        std::vector<CellRandom> m_random; // one stream per job system thread
+        int m_randomSeed = 12345;
+        std::uint64_t m_stepCount = 0;
+        // Last step's stats
+        int m_dirtyChunkCount = 0;
+        int m_updatedCellCount = 0;
+        int m_airWakeChunkCount = 0; // chunks wakeFromAir tested
         float m_cellSize = 4.0f; // world units per cell
         Vec2 m_gridOrigin = Vec2(-400.0f, -300.0f); // bottom-left of domain
 
@@ -185,18 +301,36 @@ namespace dx3d
         float m_emitRate = 50.0f; // particles per second
         float m_emitAccumulator = 0.0f;
         float m_impulseStrength = 50.0f; // Air impulse strength
+        float m_impulseAccumulator = 0.0f;
+
+        // World files and input replay
+        enum class ReplayMode
+        {
+            Off = 0,
+            Recording = 1,
+            Playing = 2
+        };
+
+        ReplayMode m_replayMode = ReplayMode::Off;
+        PowderReplay m_replay;
+        std::size_t m_replayCursor = 0;    // next event to apply while playing
+        std::uint64_t m_replayUpdates = 0; // fixedUpdate calls recorded or played so far
+        char m_worldPath[128] = "PowderWorld.pwld";
+        char m_replayPath[128] = "PowderReplay.pwrp";
+        std::string m_fileStatus;
 
         // Rendering
-        std::shared_ptr<Texture2D> m_nodeTexture;
         bool m_showGrid = false;
+        bool m_showChunks = false; // Outline awake chunk rectangles
         bool m_showAirVelocity = false; // Show air velocity as color overlay
         bool m_showAirPressure = false; // Show air pressure as color overlay
         
         // Performance tracking
         float m_smoothDt = 0.016f;
         
-        // Particle properties registry
-        std::unordered_map<ParticleType, ParticleProperties> m_particleProperties;
+        // Particle properties and reactions, indexed by ParticleType
+        PowderElementTable m_elements;
+        std::array<Vec4, PowderParticleTypeCount> m_particleColors;
 
         // Air system
         std::vector<float> m_airPressure;      // Air pressure grid
@@ -209,7 +343,14 @@ namespace dx3d
         std::vector<float> m_airHeatNext;      // Double buffering for heat
         std::vector<uint8_t> m_blockAir;       // Block air flow map
         std::vector<uint8_t> m_blockAirHeat;   // Block air heat map
+        bool m_blockAirStale = true;           // block maps need a full rebuild (dirty rects were missed)
         float m_airKernel[9];                  // Gaussian kernel for smoothing (3x3)
+        PowderAirStencil m_airStencil;         // SIMD row stencils (blur, divergence, gradient, curl, convection)
+        std::vector<float> m_airBlurX;         // Smoothed velocity X / heat-pass velocity X
+        std::vector<float> m_airBlurY;         // Smoothed velocity Y / heat-pass velocity Y
+        std::vector<float> m_airBlurValue;     // Smoothed pressure, or smoothed heat in the heat pass
+        std::vector<float> m_airCurl;          // Vorticity of the current velocity field
+        float m_airStepMs = 0.0f;              // Time spent in updateAirSystem last step
         
         // Air system parameters
         float m_ambientAirTemp = 273.15f + 22.0f; // ~22°C in Kelvin
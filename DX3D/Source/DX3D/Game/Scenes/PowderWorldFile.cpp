@@ -0,0 +1,384 @@
+#include <DX3D/Game/Scenes/PowderWorldFile.h>
+#include <DX3D/Game/Scenes/PowderElements.h>
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Core/MappedFile.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+using namespace dx3d;
+
+namespace
+{
+    const char WorldMagic[4] = { 'P', 'W', 'L', 'D' };
+    const char ReplayMagic[4] = { 'P', 'W', 'R', 'P' };
+    const std::uint32_t WorldVersion = 1;
+    const std::uint32_t ReplayVersion = 1;
+    const int MaxWorldSide = 16384;
+    const std::size_t MaxRunLength = 0x8000;
+
+    // Little-endian field writer/reader; fields are written one by one so the
+    // format does not depend on struct padding
+    template<typename T>
+    void put(std::vector<std::uint8_t>& out, const T& value)
+    {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    struct Reader
+    {
+        const std::uint8_t* data;
+        std::size_t size;
+        std::size_t offset = 0;
+
+        template<typename T>
+        bool get(T& value)
+        {
+            if (size - offset < sizeof(T)) return false;
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+    };
+
+    struct Plane
+    {
+        std::uint8_t* data;
+        std::size_t elementSize;
+    };
+
+    // Plane order in the file: type, life, temperature, then the air fields when present
+    int getPlanes(PowderWorldSnapshot& world, Plane* planes)
+    {
+        int count = 0;
+        planes[count++] = { world.type.data(), sizeof(std::uint8_t) };
+        planes[count++] = { reinterpret_cast<std::uint8_t*>(world.life.data()), sizeof(std::int16_t) };
+        planes[count++] = { reinterpret_cast<std::uint8_t*>(world.temperature.data()), sizeof(float) };
+        if (world.hasAir())
+        {
+            planes[count++] = { reinterpret_cast<std::uint8_t*>(world.airPressure.data()), sizeof(float) };
+            planes[count++] = { reinterpret_cast<std::uint8_t*>(world.airVelocityX.data()), sizeof(float) };
+            planes[count++] = { reinterpret_cast<std::uint8_t*>(world.airVelocityY.data()), sizeof(float) };
+            planes[count++] = { reinterpret_cast<std::uint8_t*>(world.airHeat.data()), sizeof(float) };
+        }
+        return count;
+    }
+
+    // Events are applied as they are, so anything the scene could not have recorded is
+    // rejected at load: unknown kinds and types, and radii beyond the grid
+    bool isValidEvent(const PowderReplayEvent& e, int width, int height)
+    {
+        if (e.kind != PowderEditKind::Paint && e.kind != PowderEditKind::Erase && e.kind != PowderEditKind::Impulse)
+            return false;
+        if (e.particleType >= PowderParticleTypeCount)
+            return false;
+        return e.radius >= 0 && e.radius <= std::max(width, height);
+    }
+
+    bool writeFile(const std::string& path, const std::vector<std::uint8_t>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(file);
+    }
+}
+
+// ========================= RLE =========================
+
+void dx3d::encodePowderRle(const void* src, std::size_t count, std::size_t elementSize, std::vector<std::uint8_t>& out)
+{
+    const auto* bytes = static_cast<const std::uint8_t*>(src);
+    auto same = [&](std::size_t a, std::size_t b) { return std::memcmp(bytes + a * elementSize, bytes + b * elementSize, elementSize) == 0; };
+    auto putHeader = [&](std::size_t header) { out.push_back(static_cast<std::uint8_t>(header)); out.push_back(static_cast<std::uint8_t>(header >> 8)); };
+
+    std::size_t i = 0;
+    std::size_t literalStart = 0;
+    auto flushLiterals = [&](std::size_t end)
+    {
+        while (literalStart < end)
+        {
+            const std::size_t n = std::min(end - literalStart, MaxRunLength);
+            putHeader(0x8000 | (n - 1));
+            out.insert(out.end(), bytes + literalStart * elementSize, bytes + (literalStart + n) * elementSize);
+            literalStart += n;
+        }
+    };
+
+    while (i < count)
+    {
+        std::size_t run = 1;
+        while (i + run < count && run < MaxRunLength && same(i, i + run)) ++run;
+
+        // Pairs stay in the literal stream; a run packet only pays off from three elements
+        if (run >= 3)
+        {
+            flushLiterals(i);
+            putHeader(run - 1);
+            out.insert(out.end(), bytes + i * elementSize, bytes + (i + 1) * elementSize);
+            i += run;
+            literalStart = i;
+        }
+        else
+        {
+            i += run;
+        }
+    }
+    flushLiterals(count);
+}
+
+bool dx3d::decodePowderRle(const std::uint8_t* src, std::size_t srcSize, void* dst, std::size_t count, std::size_t elementSize)
+{
+    auto* out = static_cast<std::uint8_t*>(dst);
+    std::size_t read = 0;
+    std::size_t written = 0;
+    while (read + 2 <= srcSize)
+    {
+        const std::size_t header = src[read] | (static_cast<std::size_t>(src[read + 1]) << 8);
+        read += 2;
+        const std::size_t n = (header & 0x7FFF) + 1;
+        if (written + n > count) return false;
+
+        if (header & 0x8000)
+        {
+            if (srcSize - read < n * elementSize) return false;
+            std::memcpy(out + written * elementSize, src + read, n * elementSize);
+            read += n * elementSize;
+        }
+        else
+        {
+            if (srcSize - read < elementSize) return false;
+            // Fill by doubling the already written part of the run
+            std::uint8_t* run = out + written * elementSize;
+            std::memcpy(run, src + read, elementSize);
+            for (std::size_t filled = 1; filled < n; filled *= 2)
+                std::memcpy(run + filled * elementSize, run, std::min(filled, n - filled) * elementSize);
+            read += elementSize;
+        }
+        written += n;
+    }
+    return read == srcSize && written == count;
+}
+
+// ========================= World =========================
+
+void dx3d::writePowderWorld(const PowderWorldSnapshot& world, std::vector<std::uint8_t>& out)
+{
+    // Planes are only read here; getPlanes hands out mutable pointers for the loader's sake
+    PowderWorldSnapshot& source = const_cast<PowderWorldSnapshot&>(world);
+    Plane planes[7];
+    const int planeCount = getPlanes(source, planes);
+    const int bandCount = (world.height + PowderWorldBandRows - 1) / PowderWorldBandRows;
+    const int blockCount = planeCount * bandCount;
+
+    // Compress every block in parallel, then lay them out behind the block table
+    std::vector<std::vector<std::uint8_t>> blocks(blockCount);
+    JobSystem::getInstance().parallelFor(0, blockCount, 1, [&](int begin, int end)
+    {
+        for (int b = begin; b < end; ++b)
+        {
+            const Plane& plane = planes[b / bandCount];
+            const int firstRow = (b % bandCount) * PowderWorldBandRows;
+            const int rows = std::min(PowderWorldBandRows, world.height - firstRow);
+            const std::size_t first = static_cast<std::size_t>(firstRow) * world.width;
+            encodePowderRle(plane.data + first * plane.elementSize, static_cast<std::size_t>(rows) * world.width, plane.elementSize, blocks[b]);
+        }
+    });
+
+    out.assign(WorldMagic, WorldMagic + 4);
+    put(out, WorldVersion);
+    put(out, static_cast<std::int32_t>(world.width));
+    put(out, static_cast<std::int32_t>(world.height));
+    put(out, static_cast<std::int32_t>(PowderWorldBandRows));
+    put(out, static_cast<std::uint32_t>(planeCount));
+    put(out, world.randomSeed);
+    put(out, world.ambientAirTemp);
+    put(out, world.stepCount);
+
+    // Block table: offset from the start of the world and compressed size
+    std::uint64_t offset = out.size() + static_cast<std::size_t>(blockCount) * (sizeof(std::uint64_t) * 2);
+    for (const auto& block : blocks)
+    {
+        put(out, offset);
+        put(out, static_cast<std::uint64_t>(block.size()));
+        offset += block.size();
+    }
+    for (const auto& block : blocks) out.insert(out.end(), block.begin(), block.end());
+}
+
+bool dx3d::readPowderWorld(const std::uint8_t* data, std::size_t size, PowderWorldSnapshot& world)
+{
+    Reader reader{ data, size };
+    char magic[4];
+    std::uint32_t version = 0;
+    std::int32_t width = 0, height = 0, bandRows = 0;
+    std::uint32_t planeCount = 0;
+    if (!reader.get(magic) || std::memcmp(magic, WorldMagic, 4) != 0) return false;
+    if (!reader.get(version) || version != WorldVersion) return false;
+    if (!reader.get(width) || !reader.get(height) || !reader.get(bandRows) || !reader.get(planeCount)) return false;
+    if (width <= 0 || height <= 0 || width > MaxWorldSide || height > MaxWorldSide || bandRows <= 0) return false;
+    if (planeCount != 3 && planeCount != 7) return false;
+    if (!reader.get(world.randomSeed) || !reader.get(world.ambientAirTemp) || !reader.get(world.stepCount)) return false;
+
+    const std::size_t cells = static_cast<std::size_t>(width) * height;
+    world.width = width;
+    world.height = height;
+    world.type.resize(cells);
+    world.life.resize(cells);
+    world.temperature.resize(cells);
+    for (auto* air : { &world.airPressure, &world.airVelocityX, &world.airVelocityY, &world.airHeat })
+        air->assign(planeCount == 7 ? cells : 0, 0.0f);
+
+    Plane planes[7];
+    getPlanes(world, planes);
+    const int bandCount = (height + bandRows - 1) / bandRows;
+    const int blockCount = static_cast<int>(planeCount) * bandCount;
+
+    struct Block { std::uint64_t offset; std::uint64_t size; };
+    std::vector<Block> table(blockCount);
+    for (Block& block : table)
+    {
+        if (!reader.get(block.offset) || !reader.get(block.size)) return false;
+        if (block.offset > size || block.size > size - block.offset) return false;
+    }
+
+    std::atomic<bool> ok{ true };
+    JobSystem::getInstance().parallelFor(0, blockCount, 1, [&](int begin, int end)
+    {
+        for (int b = begin; b < end; ++b)
+        {
+            const Plane& plane = planes[b / bandCount];
+            const int firstRow = (b % bandCount) * bandRows;
+            const int rows = std::min(bandRows, height - firstRow);
+            const std::size_t first = static_cast<std::size_t>(firstRow) * width;
+            if (!decodePowderRle(data + table[b].offset, static_cast<std::size_t>(table[b].size),
+                    plane.data + first * plane.elementSize, static_cast<std::size_t>(rows) * width, plane.elementSize))
+                ok.store(false, std::memory_order_relaxed);
+        }
+    });
+    return ok.load();
+}
+
+bool dx3d::savePowderWorld(const std::string& path, const PowderWorldSnapshot& world)
+{
+    std::vector<std::uint8_t> bytes;
+    writePowderWorld(world, bytes);
+    return writeFile(path, bytes);
+}
+
+bool dx3d::loadPowderWorld(const std::string& path, PowderWorldSnapshot& world)
+{
+    MappedFile file;
+    if (!file.open(path)) return false;
+    return readPowderWorld(file.getData(), file.getSize(), world);
+}
+
+std::uint64_t dx3d::hashPowderWorld(const PowderWorldSnapshot& world)
+{
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+    };
+
+    mix(&world.width, sizeof(world.width));
+    mix(&world.height, sizeof(world.height));
+    mix(world.type.data(), world.type.size());
+    mix(world.life.data(), world.life.size() * sizeof(std::int16_t));
+    mix(world.temperature.data(), world.temperature.size() * sizeof(float));
+    for (const auto* air : { &world.airPressure, &world.airVelocityX, &world.airVelocityY, &world.airHeat })
+        mix(air->data(), air->size() * sizeof(float));
+    return hash;
+}
+
+// ========================= Replay =========================
+
+bool dx3d::savePowderReplay(const std::string& path, const PowderReplay& replay)
+{
+    std::vector<std::uint8_t> world;
+    writePowderWorld(replay.start, world);
+
+    std::vector<std::uint8_t> out;
+    out.insert(out.end(), ReplayMagic, ReplayMagic + 4);
+    put(out, ReplayVersion);
+
+    const PowderReplaySettings& s = replay.settings;
+    put(out, s.fixedDt);
+    put(out, s.substeps);
+    put(out, s.alternateUpdate);
+    put(out, s.airEnabled);
+    put(out, s.cellSleeping);
+    put(out, s.parallelUpdate);
+    put(out, s.airPressureLoss);
+    put(out, s.airVelocityLoss);
+    put(out, s.airAdvectionMult);
+    put(out, s.airVorticityCoeff);
+    put(out, s.airHeatConvection);
+    put(out, s.wakeTemperatureDelta);
+
+    put(out, replay.fixedUpdates);
+    put(out, replay.finalHash);
+    put(out, static_cast<std::uint64_t>(replay.events.size()));
+    for (const PowderReplayEvent& e : replay.events)
+    {
+        put(out, e.step);
+        put(out, e.kind);
+        put(out, e.particleType);
+        put(out, e.reserved);
+        put(out, e.x);
+        put(out, e.y);
+        put(out, e.radius);
+        put(out, e.strength);
+    }
+
+    put(out, static_cast<std::uint64_t>(world.size()));
+    out.insert(out.end(), world.begin(), world.end());
+    return writeFile(path, out);
+}
+
+bool dx3d::loadPowderReplay(const std::string& path, PowderReplay& replay)
+{
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    Reader reader{ file.getData(), file.getSize() };
+    char magic[4];
+    std::uint32_t version = 0;
+    if (!reader.get(magic) || std::memcmp(magic, ReplayMagic, 4) != 0) return false;
+    if (!reader.get(version) || version != ReplayVersion) return false;
+
+    PowderReplaySettings& s = replay.settings;
+    if (!reader.get(s.fixedDt) || !reader.get(s.substeps) || !reader.get(s.alternateUpdate) || !reader.get(s.airEnabled) ||
+        !reader.get(s.cellSleeping) || !reader.get(s.parallelUpdate) || !reader.get(s.airPressureLoss) || !reader.get(s.airVelocityLoss) ||
+        !reader.get(s.airAdvectionMult) || !reader.get(s.airVorticityCoeff) || !reader.get(s.airHeatConvection) ||
+        !reader.get(s.wakeTemperatureDelta))
+        return false;
+
+    std::uint64_t eventCount = 0;
+    if (!reader.get(replay.fixedUpdates) || !reader.get(replay.finalHash) || !reader.get(eventCount)) return false;
+    if (eventCount > file.getSize()) return false;
+
+    replay.events.resize(static_cast<std::size_t>(eventCount));
+    for (PowderReplayEvent& e : replay.events)
+    {
+        if (!reader.get(e.step) || !reader.get(e.kind) || !reader.get(e.particleType) || !reader.get(e.reserved) ||
+            !reader.get(e.x) || !reader.get(e.y) || !reader.get(e.radius) || !reader.get(e.strength))
+            return false;
+    }
+
+    std::uint64_t worldSize = 0;
+    if (!reader.get(worldSize) || worldSize > file.getSize() - reader.offset) return false;
+    if (!readPowderWorld(file.getData() + reader.offset, static_cast<std::size_t>(worldSize), replay.start)) return false;
+    for (const PowderReplayEvent& e : replay.events)
+    {
+        if (!isValidEvent(e, replay.start.width, replay.start.height)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // Everything needed to restore a PowderScene world: the cell planes, the air
+    // fields (empty when air was off) and what seeds the deterministic step
+    struct PowderWorldSnapshot
+    {
+        int width = 0;
+        int height = 0;
+        std::uint32_t randomSeed = 0;
+        std::uint64_t stepCount = 0;
+        float ambientAirTemp = 273.15f + 22.0f;
+
+        std::vector<std::uint8_t> type;
+        std::vector<std::int16_t> life;
+        std::vector<float> temperature;
+
+        std::vector<float> airPressure;
+        std::vector<float> airVelocityX;
+        std::vector<float> airVelocityY;
+        std::vector<float> airHeat;
+
+        bool hasAir() const { return !airPressure.empty(); }
+    };
+
+    // World file (.pwld): a header, a block table and one compressed block per
+    // (plane, band of PowderWorldBandRows rows). Blocks are independent, so the
+    // loader decompresses them in parallel straight out of a memory mapping.
+    constexpr int PowderWorldBandRows = 64;
+
+    bool savePowderWorld(const std::string& path, const PowderWorldSnapshot& world);
+    bool loadPowderWorld(const std::string& path, PowderWorldSnapshot& world);
+    // Parse a world already in memory (a mapped file or a block embedded in a replay)
+    bool readPowderWorld(const std::uint8_t* data, std::size_t size, PowderWorldSnapshot& world);
+    void writePowderWorld(const PowderWorldSnapshot& world, std::vector<std::uint8_t>& out);
+
+    // Run-length coding over elements of elementSize bytes. Each packet starts with
+    // a 16-bit header: bit 15 set = (low bits + 1) literal elements follow, clear =
+    // one element repeated (low bits + 1) times.
+    void encodePowderRle(const void* src, std::size_t count, std::size_t elementSize, std::vector<std::uint8_t>& out);
+    // Returns false if the packets are malformed or do not produce exactly count elements
+    bool decodePowderRle(const std::uint8_t* src, std::size_t srcSize, void* dst, std::size_t count, std::size_t elementSize);
+
+    // FNV-1a over the snapshot's planes; equal hashes after a replay mean an identical world
+    std::uint64_t hashPowderWorld(const PowderWorldSnapshot& world);
+
+    // ========================= Replay =========================
+
+    enum class PowderEditKind : std::uint8_t
+    {
+        Paint = 0,   // drop particleType in a circle (1/3 of the empty cells)
+        Erase = 1,   // empty a circle
+        Impulse = 2  // radial air impulse of the given strength
+    };
+
+    // One tool edit in grid space, applied before the step with index step runs
+    struct PowderReplayEvent
+    {
+        std::uint64_t step = 0;
+        PowderEditKind kind = PowderEditKind::Paint;
+        std::uint8_t particleType = 0;
+        std::uint16_t reserved = 0;
+        std::int32_t x = 0;
+        std::int32_t y = 0;
+        std::int32_t radius = 0;
+        float strength = 0.0f;
+    };
+
+    // Simulation settings that change results; captured when recording starts
+    struct PowderReplaySettings
+    {
+        float fixedDt = 1.0f / 60.0f;
+        std::int32_t substeps = 1;
+        std::uint8_t alternateUpdate = 1;
+        std::uint8_t airEnabled = 1;
+        std::uint8_t cellSleeping = 1;
+        std::uint8_t parallelUpdate = 1; // serial and checkerboard sweeps draw different random streams
+        float airPressureLoss = 0.6f;
+        float airVelocityLoss = 0.6f;
+        float airAdvectionMult = 0.7f;
+        float airVorticityCoeff = 0.0f;
+        float airHeatConvection = 0.0001f;
+        float wakeTemperatureDelta = 1.0f;
+    };
+
+    // Replay file (.pwrp): the world at the start, the settings, every edit and
+    // the world hash after the last recorded step, for regression comparison
+    struct PowderReplay
+    {
+        PowderWorldSnapshot start;
+        PowderReplaySettings settings;
+        std::vector<PowderReplayEvent> events;
+        std::uint64_t fixedUpdates = 0; // fixedUpdate calls recorded (each runs settings.substeps steps)
+        std::uint64_t finalHash = 0;
+    };
+
+    bool savePowderReplay(const std::string& path, const PowderReplay& replay);
+    // Fails on events with an unknown kind or particle type, or a radius outside [0, grid side]
+    bool loadPowderReplay(const std::string& path, PowderReplay& replay);
+}
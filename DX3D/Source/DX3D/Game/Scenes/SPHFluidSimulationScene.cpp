@@ -1,7 +1,7 @@
-#include <thread>
 #include <DX3D/Math/Geometry.h>
 #include <DX3D/Game/Scenes/SPHFluidSimulationScene.h>
 #include <DX3D/Graphics/GraphicsEngine.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 #include <DX3D/Graphics/SwapChain.h>
 #include <DX3D/Graphics/Camera.h>
 #include <DX3D/Graphics/SpriteComponent.h>
@@ -15,6 +15,7 @@
 #include <sstream>
 #include <algorithm>
 #include <cstdio>
+#include <atomic>
 
 using namespace dx3d;
 
@@ -32,6 +33,7 @@ void SPHFluidSimulationScene::updateKernelConstants()
     m_h4 = m_h2 * m_h2;
     m_h5 = m_h4 * m_h;
     m_h6 = m_h3 * m_h3;
+    m_kernelConstants = SPHKernelConstants::forRadius(m_h);
 }
 
 void SPHFluidSimulationScene::load(GraphicsEngine& engine)
@@ -39,9 +41,12 @@ void SPHFluidSimulationScene::load(GraphicsEngine& engine)
     auto& device = engine.getGraphicsDevice();
     m_graphicsDevice = &device;
     m_entityManager = std::make_unique<EntityManager>();
+    m_threadCount = static_cast<int>(JobSystem::getInstance().getThreadCount());
 
-    // Preload node texture for Sprites mode
-    m_nodeTexture = Texture2D::LoadTexture2D(device.getD3DDevice(), L"DX3D/Assets/Textures/node.png");
+    // Particle batch materials: node.png for Sprites mode, the falloff for Metaballs mode
+    m_particleBatchDevice = std::make_unique<ParticleBatchDevice>(device);
+    m_nodeMaterial = m_particleBatchDevice->addMaterial(device.getResourceCache().getTexture(L"DX3D/Assets/Textures/node.png"));
+    m_metaballMaterial = m_particleBatchDevice->addMaterial(device.getResourceCache().getTexture(L"DX3D/Assets/Textures/MetaballFalloff.png"));
 
     // Camera
     createCamera(engine);
@@ -72,7 +77,6 @@ void SPHFluidSimulationScene::load(GraphicsEngine& engine)
     createBoundaries();
     createBall();
     spawnParticles();
-    m_neighbors.resize(m_particles.size());
     m_neighborsValid = false;
     
     printf("SPH Fluid Simulation Scene loaded with LiquidFun optimizations\n");
@@ -81,6 +85,7 @@ void SPHFluidSimulationScene::load(GraphicsEngine& engine)
 void SPHFluidSimulationScene::createCamera(GraphicsEngine& engine)
 {
     auto& cameraEntity = m_entityManager->createEntity("MainCamera");
+    m_cameraEntity = cameraEntity.getHandle();
     float screenWidth = GraphicsEngine::getWindowWidth();
     float screenHeight = GraphicsEngine::getWindowHeight();
     auto& camera = cameraEntity.addComponent<Camera2D>(screenWidth, screenHeight);
@@ -88,21 +93,21 @@ void SPHFluidSimulationScene::createCamera(GraphicsEngine& engine)
     camera.setZoom(0.8f);
 }
 
-std::string SPHFluidSimulationScene::boundaryName(int i) const
+NameId SPHFluidSimulationScene::boundaryName(int i) const
 {
-    switch (i)
-    {
-    case 0: return "BoundaryLeft";
-    case 1: return "BoundaryRight";
-    case 2: return "BoundaryBottom";
-    default: return "BoundaryTop";
-    }
+    static const NameId names[4] = {
+        NameTable::intern("BoundaryLeft"),
+        NameTable::intern("BoundaryRight"),
+        NameTable::intern("BoundaryBottom"),
+        NameTable::intern("BoundaryTop")
+    };
+    return names[std::clamp(i, 0, 3)];
 }
 
 void SPHFluidSimulationScene::createBoundaries()
 {
     // Physics boundaries using FirmGuy static bodies
-    auto addBoundary = [&](const std::string& name, const Vec2& pos, float w, float h)
+    auto addBoundary = [&](NameId name, const Vec2& pos, float w, float h)
     {
         auto& e = m_entityManager->createEntity(name);
         auto& s = e.addComponent<SpriteComponent>(*m_graphicsDevice, L"DX3D/Assets/Textures/beam.png", w, h);
@@ -165,7 +170,6 @@ void SPHFluidSimulationScene::spawnParticles()
     Vec2 start = m_domainMin + Vec2(m_domainWidth * 0.2f, m_domainHeight * 0.6f);
     float spacing = m_particleRadius * 2.0f * 0.9f;
 
-    int id = 0;
     for (int j = 0; j < particlesY; ++j)
     {
         for (int i = 0; i < particlesX; ++i)
@@ -176,17 +180,17 @@ void SPHFluidSimulationScene::spawnParticles()
             p.acceleration = Vec2(0.0f, 0.0f);
             p.density = m_sphParams.rest_density;
             p.pressure = 0.0f;
-            p.entityName = "SPHParticle_" + std::to_string(id++);
-
-            auto& e = m_entityManager->createEntity(p.entityName);
-            auto& s = e.addComponent<SpriteComponent>(*m_graphicsDevice, L"DX3D/Assets/Textures/MetaballFalloff.png", m_particleRadius * 2.0f, m_particleRadius * 2.0f);
-            s.setPosition(p.position.x, p.position.y, 0.0f);
-            s.setTint(Vec4(0.2f, 0.6f, 1.0f, 1.0f));
+            p.color = Vec4(0.2f, 0.6f, 1.0f, 1.0f);
             m_particles.push_back(p);
         }
     }
+    if (m_useOptimizedLayout)
+    {
+        m_optimizedParticles.syncFromParticles(m_particles);
+        m_particles.clear();
+    }
     
-    printf("Spawned %d SPH particles\n", (int)m_particles.size());
+    printf("Spawned %d SPH particles\n", getParticleCount());
 }
 
 void SPHFluidSimulationScene::update(float dt)
@@ -252,10 +256,12 @@ void SPHFluidSimulationScene::fixedUpdate(float dt)
     if (m_paused) return;
 
     // Rebuild grid if parameters changed
-    if (m_prevSmoothingRadius != m_sphParams.smoothing_radius || m_prevGridCellScale != m_gridCellScale)
+    if (m_prevSmoothingRadius != m_sphParams.smoothing_radius || m_prevGridCellScale != m_gridCellScale || m_prevNeighborSkin != m_neighborSkin)
     {
-        m_spatialGrid.initialize(m_domainWidth, m_domainHeight, m_domainMin.x, m_domainMin.y, m_sphParams.smoothing_radius, m_gridCellScale);
+        // Cells span the table's search radius, so a skin does not widen the search to 5x5 cells
+        m_spatialGrid.initialize(m_domainWidth, m_domainHeight, m_domainMin.x, m_domainMin.y, m_sphParams.smoothing_radius + m_neighborSkin, m_gridCellScale);
         m_prevGridCellScale = m_gridCellScale;
+        m_prevNeighborSkin = m_neighborSkin;
         updateKernelConstants();
     }
 
@@ -273,8 +279,15 @@ void SPHFluidSimulationScene::fixedUpdate(float dt)
         FirmGuySystem::update(*m_entityManager, dt);
     }
 
-    const int steps = 1; // SPH is more stable than FLIP, fewer substeps needed
-    const float h = dt / static_cast<float>(steps);
+    int steps = 1; // SPH is more stable than FLIP, fewer substeps needed
+    float h = dt / static_cast<float>(steps);
+    if (m_solverMode == SPHSolverMode::PositionBased && m_useOptimizedLayout)
+    {
+        // One longer step every m_positionStepFrames fixed updates
+        steps = ++m_framesSinceStep >= m_positionStepFrames ? 1 : 0;
+        h = dt * static_cast<float>(m_framesSinceStep);
+        if (steps > 0) m_framesSinceStep = 0;
+    }
     for (int s = 0; s < steps; ++s)
     {
         stepSPH(h);
@@ -282,14 +295,14 @@ void SPHFluidSimulationScene::fixedUpdate(float dt)
         resolveBallParticleCollisions();
     }
 
-    updateParticleSprites();
+    updateParticleColors();
 }
 
 void SPHFluidSimulationScene::render(GraphicsEngine& engine, SwapChain& swapChain)
 {
     auto& ctx = engine.getContext();
 
-    if (auto* cameraEntity = m_entityManager->findEntity("MainCamera"))
+    if (auto* cameraEntity = m_entityManager->getEntity(m_cameraEntity))
     {
         if (auto* camera = cameraEntity->getComponent<Camera2D>())
         {
@@ -310,21 +323,22 @@ void SPHFluidSimulationScene::render(GraphicsEngine& engine, SwapChain& swapChai
     }
     else // Sprites mode
     {
-        // Ensure particle sprites use node.png in Sprites mode
-        for (auto* entity : m_entityManager->getEntitiesWithComponent<SpriteComponent>())
+        // Particles as node.png quads in one batch, then the boundary and ball sprites
+        // Only the active layout holds particles
+        const auto& soa = m_optimizedParticles;
+        for (size_t i = 0; i < soa.count; ++i)
+            m_particleBatch.add(m_nodeMaterial, soa.positions_x[i], soa.positions_y[i], m_particleRadius * 2.0f, soa.colors[i]);
+        for (const auto& p : m_particles)
+            m_particleBatch.add(m_nodeMaterial, p.position.x, p.position.y, m_particleRadius * 2.0f,
+                packParticleColor(p.color.x, p.color.y, p.color.z, p.color.w));
+        if (m_particleBatchDevice) m_particleBatchDevice->draw(engine, ctx, m_particleBatch);
+        m_particleBatch.clear();
+
+        m_entityManager->view<SpriteComponent>().each([&](Entity& entity, SpriteComponent& sprite)
         {
-            if (auto* sprite = entity->getComponent<SpriteComponent>())
-            {
-                // Only retarget textures for particle entities to avoid affecting boundaries/ball
-                const std::string& n = entity->getName();
-                if (n.rfind("SPHParticle_", 0) == 0 && m_nodeTexture)
-                {
-                    sprite->setTexture(m_nodeTexture);
-                }
-                if (sprite->isVisible() && sprite->isValid())
-                    sprite->draw(ctx);
-            }
-        }
+            if (sprite.isVisible() && sprite.isValid())
+                sprite.draw(ctx);
+        });
     }
     
     // Debug grid visualization
@@ -355,6 +369,13 @@ void SPHFluidSimulationScene::render(GraphicsEngine& engine, SwapChain& swapChai
     // Boundaries are static - no rotation
 }
 
+void SPHFluidSimulationScene::onFrameEnd()
+{
+    Scene::onFrameEnd();
+    m_frameAllocations = m_frameAllocScope.allocations();
+    m_frameAllocScope.reset();
+}
+
 void SPHFluidSimulationScene::renderImGui(GraphicsEngine& engine)
 {
     ImGui::SetNextWindowSize(ImVec2(420, 400), ImGuiCond_FirstUseEver);
@@ -363,12 +384,57 @@ void SPHFluidSimulationScene::renderImGui(GraphicsEngine& engine)
         float fps = (m_smoothDt > 0.0f) ? (1.0f / m_smoothDt) : 0.0f;
         ImGui::Text("FPS: %.1f (dt=%.3f ms)", fps, m_smoothDt * 1000.0f);
         ImGui::Checkbox("Paused (P)", &m_paused);
-        ImGui::Text("Particles: %d", (int)m_particles.size());
+        ImGui::Text("Particles: %d", getParticleCount());
+        if (AllocationCounter::enabled)
+            ImGui::Text("Heap allocs/frame: %llu (color sync: %llu)",
+                (unsigned long long)m_frameAllocations, (unsigned long long)m_colorSyncAllocations);
+        else
+            ImGui::Text("Heap allocs/frame: n/a");
         ImGui::Checkbox("Show Grid", &m_showGridDebug);
+        int maxThreads = static_cast<int>(JobSystem::getInstance().getThreadCount());
+        ImGui::SliderInt("Threads", &m_threadCount, 1, maxThreads);
+        // Legacy forces: gather per particle, or each pair once (per-thread sums, or colored blocks for
+        // results that do not depend on the thread count). The SoA kernels gather over the neighbor table instead
+        const char* pairModeNames[] = { getSPHPairModeName(SPHPairMode::Gather), getSPHPairModeName(SPHPairMode::PerThread), getSPHPairModeName(SPHPairMode::Colored) };
+        int pairMode = static_cast<int>(m_pairMode);
+        if (m_useOptimizedLayout) ImGui::BeginDisabled(true);
+        if (ImGui::Combo("Pair Forces (AoS layout)", &pairMode, pairModeNames, 3))
+        {
+            m_pairMode = static_cast<SPHPairMode>(pairMode);
+        }
+        if (m_useOptimizedLayout) ImGui::EndDisabled();
+        // Position-based solving runs on the SoA layout only
+        const char* solverNames[] = { getSPHSolverModeName(SPHSolverMode::EquationOfState), getSPHSolverModeName(SPHSolverMode::PositionBased) };
+        int solverMode = static_cast<int>(m_solverMode);
+        if (ImGui::Combo("Solver", &solverMode, solverNames, 2))
+        {
+            m_solverMode = static_cast<SPHSolverMode>(solverMode);
+            m_framesSinceStep = 0;
+            if (m_solverMode == SPHSolverMode::PositionBased) setOptimizedLayout(true);
+        }
+        if (m_solverMode == SPHSolverMode::PositionBased)
+        {
+            ImGui::SliderInt("PBF Iterations", &m_positionSettings.iterations, 1, 16);
+            ImGui::SliderInt("PBF Step (fixed updates)", &m_positionStepFrames, 1, 8);
+            ImGui::SliderFloat("PBF Relaxation", &m_positionSettings.relaxation, 0.01f, 1.0f, "%.2f");
+            ImGui::SliderFloat("PBF XSPH", &m_positionSettings.xsph, 0.0f, 0.1f, "%.3f");
+            ImGui::Text("PBF density error: %.2f%%", m_positionSolver.getDensityError() * 100.0f);
+        }
         
         ImGui::Separator();
         ImGui::Text("LiquidFun Optimizations");
-        ImGui::Checkbox("Use Optimized Layout (SoA)", &m_useOptimizedLayout);
+        bool optimizedLayout = m_useOptimizedLayout;
+        if (ImGui::Checkbox("Use Optimized Layout (SoA)", &optimizedLayout))
+        {
+            setOptimizedLayout(optimizedLayout);
+        }
+        // Pair kernel instruction set (only what this build was compiled for)
+        const char* simdNames[] = { getSPHSimdName(SPHSimd::Scalar), getSPHSimdName(SPHSimd::Sse2), getSPHSimdName(SPHSimd::Avx2) };
+        int simd = static_cast<int>(m_kernels.getSimd());
+        if (ImGui::Combo("SoA Kernels", &simd, simdNames, static_cast<int>(getSPHSimdSupport()) + 1))
+        {
+            m_kernels.setSimd(static_cast<SPHSimd>(simd));
+        }
         ImGui::Checkbox("Enable Island Simulation", &m_enableIslandSimulation);
         ImGui::SliderFloat("Sleep Threshold", &m_sleepThreshold, 0.01f, 1.0f, "%.3f");
         
@@ -486,11 +552,17 @@ void SPHFluidSimulationScene::renderImGui(GraphicsEngine& engine)
         
         ImGui::Separator();
         ImGui::Text("Performance");
-        ImGui::Text("Particles: %d", (int)m_particles.size());
+        ImGui::Text("Particles: %d", getParticleCount());
         ImGui::Text("Neighbor Checks: %u", m_neighbor_checks);
         ImGui::Text("Density Calculations: %u", m_density_calculations);
         ImGui::Text("Avg Neighbors: %.1f", m_average_neighbors);
         ImGui::Text("Grid: %dx%d (cell=%.1f)", m_spatialGrid.grid_width, m_spatialGrid.grid_height, m_spatialGrid.cell_size);
+        ImGui::Text("Neighbor Pairs: %zu", m_neighborTable.getPairCount());
+        ImGui::SliderFloat("Neighbor Skin", &m_neighborSkin, 0.0f, 12.0f, "%.1f");
+        const int neighborUpdates = m_neighborRebuilds + m_neighborRefreshes;
+        ImGui::Text("Neighbor rebuilds: %d of %d steps (%.0f%%)", m_neighborRebuilds, neighborUpdates,
+            neighborUpdates > 0 ? 100.0f * m_neighborRebuilds / neighborUpdates : 0.0f);
+        ImGui::SliderInt("Z-Order Reorder (steps, 0=off)", &m_reorderInterval, 0, 120);
         
         ImGui::Separator();
         ImGui::Text("Collision Detection (LiquidFun Style)");
@@ -498,7 +570,6 @@ void SPHFluidSimulationScene::renderImGui(GraphicsEngine& engine)
         ImGui::SliderInt("Collision Iterations", &m_collisionIterations, 1, 5);
         ImGui::SliderFloat("Restitution", &m_collisionRestitution, 0.0f, 1.0f, "%.2f");
         ImGui::SliderFloat("Friction", &m_collisionFriction, 0.0f, 1.0f, "%.2f");
-        ImGui::SliderFloat("Hash Cell Size", &m_collisionHashCellSize, 8.0f, 32.0f, "%.1f");
         ImGui::SliderInt("Max Neighbors (per particle)", &m_maxCollisionNeighbors, 4, 64);
         
         ImGui::Separator();
@@ -555,15 +626,6 @@ void SPHFluidSimulationScene::renderImGui(GraphicsEngine& engine)
 
         if (ImGui::Button("Reset Particles", ImVec2(-FLT_MIN, 0)))
         {
-            // Remove existing particle entities
-            const auto& all = m_entityManager->getEntities();
-            std::vector<std::string> toRemove;
-            for (const auto& up : all)
-            {
-                const std::string& n = up->getName();
-                if (n.rfind("SPHParticle_", 0) == 0) toRemove.push_back(n);
-            }
-            for (const auto& n : toRemove) m_entityManager->removeEntity(n);
             spawnParticles();
         }
     }
@@ -575,7 +637,11 @@ void SPHFluidSimulationScene::renderImGui(GraphicsEngine& engine)
 void SPHFluidSimulationScene::stepSPH(float dt)
 {
     updateKernelConstants();
-    if (m_useOptimizedLayout)
+    if (m_useOptimizedLayout && m_solverMode == SPHSolverMode::PositionBased)
+    {
+        stepPositionBased(dt);
+    }
+    else if (m_useOptimizedLayout)
     {
         stepSPHOptimized(dt);
     }
@@ -593,7 +659,6 @@ void SPHFluidSimulationScene::stepSPH(float dt)
         // LiquidFun-style particle collision detection
         if (m_enableParticleCollisions)
         {
-            buildCollisionHash();
             resolveParticleCollisions();
         }
         
@@ -619,57 +684,80 @@ void SPHFluidSimulationScene::stepSPH(float dt)
 
 void SPHFluidSimulationScene::updateSpatialGrid()
 {
-    m_spatialGrid.clear();
-    
-    for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
+    const int threads = std::max(1, m_threadCount);
+    ++m_stepsSinceReorder;
+    m_neighborTable.setSkin(m_neighborSkin);
+    if (m_neighborTable.refresh(m_particles, m_sphParams.smoothing_radius, threads))
     {
-        const auto& p = m_particles[i];
-        m_spatialGrid.addParticle(i, p.position.x, p.position.y);
+        // The skin still covers everyone's motion: the table is current without the grid
+        ++m_neighborRefreshes;
+        m_neighborsValid = true;
+        return;
+    }
+    m_spatialGrid.update(m_particles, threads);
+
+    // Periodically put the particles in Z-order so each one's neighbors sit close in memory
+    // (on a rebuild, so a reorder never costs one)
+    if (m_reorderInterval > 0 && m_stepsSinceReorder >= m_reorderInterval)
+    {
+        m_stepsSinceReorder = 0;
+        reorderParticles();
+        m_spatialGrid.build(m_particles, threads);
     }
-    if (static_cast<int>(m_neighbors.size()) != static_cast<int>(m_particles.size()))
-        m_neighbors.resize(m_particles.size());
     m_neighborsValid = false;
 }
 
-void SPHFluidSimulationScene::buildNeighborLists()
+void SPHFluidSimulationScene::reorderParticles()
 {
-    if (m_neighborsValid && static_cast<int>(m_neighbors.size()) == static_cast<int>(m_particles.size())) return;
-    for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
+    // Particles are only referenced by index within a step, so nothing else needs remapping
+    mortonOrder(m_spatialGrid.cells, m_reorderOrder, m_reorderCellKeys);
+    m_sortedParticles.resize(m_particles.size());
+    parallelFor(0, static_cast<int>(m_reorderOrder.size()), 1024, [&](int begin, int end)
     {
-        m_spatialGrid.findNeighbors(i, m_particles[i].position.x, m_particles[i].position.y, m_sphParams.smoothing_radius, m_neighbors[i]);
-    }
+        for (int k = begin; k < end; ++k)
+            m_sortedParticles[k] = m_particles[m_reorderOrder[k]];
+    });
+    m_particles.swap(m_sortedParticles);
+}
+
+void SPHFluidSimulationScene::buildNeighborLists()
+{
+    if (m_neighborsValid && m_neighborTable.getParticleCount() == static_cast<int>(m_particles.size())) return;
+    m_neighborTable.setSkin(m_neighborSkin);
+    m_neighborTable.build(m_particles, m_spatialGrid.cells, m_sphParams.smoothing_radius, std::max(1, m_threadCount));
+    // Blocks span the skin too: the table's pairs stay among the candidates they were built for
+    m_pairBlocks.build(m_spatialGrid.cells, m_sphParams.smoothing_radius + m_neighborTable.getSkin(), std::max(1, m_threadCount));
+    ++m_neighborRebuilds;
     m_neighborsValid = true;
 }
 
 void SPHFluidSimulationScene::calculateDensity()
 {
-    m_density_calculations = 0;
-    for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
+    std::atomic<uint32_t> densityCalculations{ 0 };
+    parallelFor(0, static_cast<int>(m_particles.size()), 64, [&](int begin, int end)
     {
-        float density = 0.0f;
-        const auto& neighbors = m_neighbors[i];
-        
-        for (int j : neighbors)
+        uint32_t localCalculations = 0;
+        for (int i = begin; i < end; ++i)
         {
-            if (i == j) continue;
-            
-            Vec2 r = m_particles[i].position - m_particles[j].position;
-            float dx = r.x; float dy = r.y;
-            float r2 = dx * dx + dy * dy;
-            if (r2 < m_sphParams.smoothing_radius * m_sphParams.smoothing_radius)
+            float density = 0.0f;
+        
+            // Every pair in the table is within the smoothing radius
+            for (int k = m_neighborTable.begin(i); k < m_neighborTable.end(i); ++k)
             {
-                float distance = std::sqrt(std::max(1e-6f, r2));
+                float distance = std::max(1e-3f, m_neighborTable.getDistance(k));
                 density += m_sphParams.mass * poly6Kernel(distance, m_sphParams.smoothing_radius);
-                m_density_calculations++;
+                localCalculations++;
             }
-        }
         
-        // Add self-contribution for better density calculation
-        density += m_sphParams.mass * poly6Kernel(0.0f, m_sphParams.smoothing_radius);
+            // Add self-contribution for better density calculation
+            density += m_sphParams.mass * poly6Kernel(0.0f, m_sphParams.smoothing_radius);
         
-        // Ensure minimum density to prevent division by zero, but allow some compression
-        m_particles[i].density = std::max(density, m_sphParams.rest_density * 0.3f);
-    }
+            // Ensure minimum density to prevent division by zero, but allow some compression
+            m_particles[i].density = std::max(density, m_sphParams.rest_density * 0.3f);
+        }
+        densityCalculations.fetch_add(localCalculations, std::memory_order_relaxed);
+    });
+    m_density_calculations = densityCalculations.load();
 }
 
 void SPHFluidSimulationScene::calculatePressure()
@@ -683,60 +771,67 @@ void SPHFluidSimulationScene::calculatePressure()
 
 void SPHFluidSimulationScene::calculateForces()
 {
-    m_neighbor_checks = 0;
-    for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
+    if (m_pairMode != SPHPairMode::Gather)
     {
-        Vec2 pressureForce(0.0f, 0.0f);
-        Vec2 viscosityForce(0.0f, 0.0f);
-        Vec2 artificialPressureForce(0.0f, 0.0f);
-        
-        const auto& neighbors = m_neighbors[i];
-        
-        for (int j : neighbors)
+        calculatePairForces();
+        return;
+    }
+
+    std::atomic<uint32_t> neighborChecks{ 0 };
+    parallelFor(0, static_cast<int>(m_particles.size()), 64, [&](int begin, int end)
+    {
+        uint32_t localChecks = 0;
+        for (int i = begin; i < end; ++i)
         {
-            if (i == j) continue;
-            
-            Vec2 r = m_particles[i].position - m_particles[j].position;
-            float dx = r.x; float dy = r.y;
-            float r2 = dx * dx + dy * dy;
-            if (r2 < m_sphParams.smoothing_radius * m_sphParams.smoothing_radius && r2 > 1e-12f)
+            Vec2 pressureForce(0.0f, 0.0f);
+            Vec2 viscosityForce(0.0f, 0.0f);
+            Vec2 artificialPressureForce(0.0f, 0.0f);
+        
+            for (int k = m_neighborTable.begin(i); k < m_neighborTable.end(i); ++k)
             {
-                float distance = std::sqrt(r2);
-                m_neighbor_checks++;
+                if (m_neighborTable.getR2(k) > 1e-12f)
+                {
+                    int j = m_neighborTable.getIndex(k);
+                    Vec2 r = m_particles[i].position - m_particles[j].position;
+                    float distance = m_neighborTable.getDistance(k);
+                    localChecks++;
                 
-                // Standard pressure force
-                float pressureTerm = (m_particles[i].pressure + m_particles[j].pressure) / (2.0f * m_particles[j].density);
-                Vec2 pressureGradient = spikyKernelGradient(r, m_sphParams.smoothing_radius);
-                pressureForce -= pressureGradient * (static_cast<f32>(m_sphParams.mass) * static_cast<f32>(pressureTerm));
+                    // Standard pressure force
+                    float pressureTerm = (m_particles[i].pressure + m_particles[j].pressure) / (2.0f * m_particles[j].density);
+                    Vec2 pressureGradient = spikyKernelGradient(r, distance, m_sphParams.smoothing_radius);
+                    pressureForce -= pressureGradient * (static_cast<f32>(m_sphParams.mass) * static_cast<f32>(pressureTerm));
                 
-                // Artificial pressure for incompressibility (Monaghan 1994)
-                float densityRatio = m_particles[i].density / m_sphParams.rest_density;
-                float artificialPressure = m_sphParams.artificial_pressure * (densityRatio * densityRatio * densityRatio * densityRatio - 1.0f);
-                artificialPressureForce -= pressureGradient * (static_cast<f32>(m_sphParams.mass) * static_cast<f32>(artificialPressure));
+                    // Artificial pressure for incompressibility (Monaghan 1994)
+                    float densityRatio = m_particles[i].density / m_sphParams.rest_density;
+                    float artificialPressure = m_sphParams.artificial_pressure * (densityRatio * densityRatio * densityRatio * densityRatio - 1.0f);
+                    artificialPressureForce -= pressureGradient * (static_cast<f32>(m_sphParams.mass) * static_cast<f32>(artificialPressure));
                 
-                // Viscosity force
-                Vec2 velocityDiff = m_particles[j].velocity - m_particles[i].velocity;
-                float viscosityTerm = m_sphParams.viscosity * m_sphParams.mass * viscosityKernel(distance, m_sphParams.smoothing_radius) / static_cast<f32>(m_particles[j].density);
-                viscosityForce += velocityDiff * static_cast<f32>(viscosityTerm);
+                    // Viscosity force
+                    Vec2 velocityDiff = m_particles[j].velocity - m_particles[i].velocity;
+                    float viscosityTerm = m_sphParams.viscosity * m_sphParams.mass * viscosityKernel(distance, m_sphParams.smoothing_radius) / static_cast<f32>(m_particles[j].density);
+                    viscosityForce += velocityDiff * static_cast<f32>(viscosityTerm);
                 
-                // Artificial viscosity for stability
-                float artificialViscosityTerm = m_sphParams.artificial_viscosity * m_sphParams.mass * viscosityKernel(distance, m_sphParams.smoothing_radius) / static_cast<f32>(m_particles[j].density);
-                viscosityForce += velocityDiff * static_cast<f32>(artificialViscosityTerm);
+                    // Artificial viscosity for stability
+                    float artificialViscosityTerm = m_sphParams.artificial_viscosity * m_sphParams.mass * viscosityKernel(distance, m_sphParams.smoothing_radius) / static_cast<f32>(m_particles[j].density);
+                    viscosityForce += velocityDiff * static_cast<f32>(artificialViscosityTerm);
+                }
             }
-        }
         
-        // Total force = pressure + artificial pressure + viscosity + gravity
-        Vec2 totalForce = (pressureForce + artificialPressureForce + viscosityForce) / static_cast<f32>(m_particles[i].density) + Vec2(0.0f, static_cast<f32>(m_sphParams.gravity));
+            // Total force = pressure + artificial pressure + viscosity + gravity
+            Vec2 totalForce = (pressureForce + artificialPressureForce + viscosityForce) / static_cast<f32>(m_particles[i].density) + Vec2(0.0f, static_cast<f32>(m_sphParams.gravity));
         
-        // More reasonable force limiting to allow stronger pressure forces
-        float forceMagnitude = totalForce.length();
-        if (forceMagnitude > 5000.0f) // Increased from 1000.0f
-        {
-            totalForce = totalForce * (5000.0f / forceMagnitude);
-        }
+            // More reasonable force limiting to allow stronger pressure forces
+            float forceMagnitude = totalForce.length();
+            if (forceMagnitude > 5000.0f) // Increased from 1000.0f
+            {
+                totalForce = totalForce * (5000.0f / forceMagnitude);
+            }
         
-        m_particles[i].acceleration = totalForce;
-    }
+            m_particles[i].acceleration = totalForce;
+        }
+        neighborChecks.fetch_add(localChecks, std::memory_order_relaxed);
+    });
+    m_neighbor_checks = neighborChecks.load();
     
     // Update average neighbors
     if (m_particles.size() > 0)
@@ -745,20 +840,109 @@ void SPHFluidSimulationScene::calculateForces()
     }
 }
 
-void SPHFluidSimulationScene::integrateParticles(float dt)
+void SPHFluidSimulationScene::calculatePairForces()
 {
-    for (auto& p : m_particles)
+    const int count = static_cast<int>(m_particles.size());
+    // Each pair (i, j > i) once, both sides accumulated: into the running thread's
+    // arrays and summed after, or into shared arrays block color by block color
+    m_pairForceX.resize(count);
+    m_pairForceY.resize(count);
+    std::atomic<uint32_t> pairChecks{ 0 };
+    auto accumulate = [&](int i, float* forceX, float* forceY)
     {
-        // Verlet integration for better stability
-        Vec2 oldVelocity = p.velocity;
-        p.velocity += p.acceleration * static_cast<f32>(dt);
-        
-        // Gentle damping to prevent instability while preserving fluid motion
-        p.velocity *= 0.995f; // Reduced damping for better fluid behavior
-        
-        // Position update with velocity averaging for stability
-        p.position += (oldVelocity + p.velocity) * 0.5f * static_cast<f32>(dt);
+        uint32_t checks = 0;
+        for (int k = m_neighborTable.begin(i); k < m_neighborTable.end(i); ++k)
+        {
+            const int j = m_neighborTable.getIndex(k);
+            if (j <= i || m_neighborTable.getR2(k) <= 1e-12f) continue;
+            Vec2 onI, onJ;
+            pairForces(i, j, m_neighborTable.getDistance(k), onI, onJ);
+            forceX[i] += onI.x;
+            forceY[i] += onI.y;
+            forceX[j] += onJ.x;
+            forceY[j] += onJ.y;
+            checks += 2;
+        }
+        return checks;
+    };
+    if (m_pairMode == SPHPairMode::PerThread)
+    {
+        m_threadForces.begin(count);
+        parallelFor(0, count, 64, [&](int begin, int end)
+        {
+            SPHThreadAccumulators::Buffer forces = m_threadForces.local();
+            uint32_t localChecks = 0;
+            for (int i = begin; i < end; ++i) localChecks += accumulate(i, forces.x, forces.y);
+            pairChecks.fetch_add(localChecks, std::memory_order_relaxed);
+        });
+        m_threadForces.reduce(m_pairForceX.data(), m_pairForceY.data(), std::max(1, m_threadCount));
     }
+    else
+    {
+        std::fill(m_pairForceX.begin(), m_pairForceX.end(), 0.0f);
+        std::fill(m_pairForceY.begin(), m_pairForceY.end(), 0.0f);
+        m_pairBlocks.forEachBlock([&](int, const int* particles, int blockSize)
+        {
+            uint32_t localChecks = 0;
+            for (int n = 0; n < blockSize; ++n) localChecks += accumulate(particles[n], m_pairForceX.data(), m_pairForceY.data());
+            pairChecks.fetch_add(localChecks, std::memory_order_relaxed);
+        }, std::max(1, m_threadCount));
+    }
+
+    parallelFor(0, count, 1024, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            Vec2 totalForce = Vec2(m_pairForceX[i], m_pairForceY[i]) / static_cast<f32>(m_particles[i].density) + Vec2(0.0f, static_cast<f32>(m_sphParams.gravity));
+            float forceMagnitude = totalForce.length();
+            if (forceMagnitude > 5000.0f)
+            {
+                totalForce = totalForce * (5000.0f / forceMagnitude);
+            }
+            m_particles[i].acceleration = totalForce;
+        }
+    });
+    m_neighbor_checks = pairChecks.load();
+    m_average_neighbors = count > 0 ? static_cast<float>(m_neighbor_checks) / count : 0.0f;
+}
+
+void SPHFluidSimulationScene::pairForces(int i, int j, float distance, Vec2& onI, Vec2& onJ)
+{
+    // The terms of the gather above, shared by both sides: each side divides by the
+    // other's density and takes its own artificial pressure; ∇W(r_ji) = -∇W(r_ij)
+    const SPHParticle& a = m_particles[i];
+    const SPHParticle& b = m_particles[j];
+    const float mass = m_sphParams.mass;
+    Vec2 gradient = spikyKernelGradient(a.position - b.position, distance, m_sphParams.smoothing_radius);
+    float viscosity = (m_sphParams.viscosity + m_sphParams.artificial_viscosity) * mass * viscosityKernel(distance, m_sphParams.smoothing_radius);
+    float pressureSum = a.pressure + b.pressure;
+    float ratioA = a.density / m_sphParams.rest_density;
+    float ratioB = b.density / m_sphParams.rest_density;
+    float artificialA = m_sphParams.artificial_pressure * (ratioA * ratioA * ratioA * ratioA - 1.0f);
+    float artificialB = m_sphParams.artificial_pressure * (ratioB * ratioB * ratioB * ratioB - 1.0f);
+    Vec2 velocityDiff = b.velocity - a.velocity;
+    onI = gradient * (-mass * (pressureSum / (2.0f * b.density) + artificialA)) + velocityDiff * (viscosity / b.density);
+    onJ = gradient * (mass * (pressureSum / (2.0f * a.density) + artificialB)) - velocityDiff * (viscosity / a.density);
+}
+
+void SPHFluidSimulationScene::integrateParticles(float dt)
+{
+    parallelFor(0, static_cast<int>(m_particles.size()), 1024, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            auto& p = m_particles[i];
+            // Verlet integration for better stability
+            Vec2 oldVelocity = p.velocity;
+            p.velocity += p.acceleration * static_cast<f32>(dt);
+            
+            // Gentle damping to prevent instability while preserving fluid motion
+            p.velocity *= 0.995f; // Reduced damping for better fluid behavior
+            
+            // Position update with velocity averaging for stability
+            p.position += (oldVelocity + p.velocity) * 0.5f * static_cast<f32>(dt);
+        }
+    });
 }
 
 void SPHFluidSimulationScene::enforceBoundaries()
@@ -770,34 +954,34 @@ void SPHFluidSimulationScene::enforceBoundaries()
 void SPHFluidSimulationScene::resolveParticleBoundaryCollisions()
 {
     // Simple axis-aligned boundary collision detection
-    for (auto& particle : m_particles)
+    forEachParticle([&](Vec2& position, Vec2& velocity)
     {
         bool collided = false;
         Vec2 normal(0.0f, 0.0f);
         
         // Check against domain boundaries
-        if (particle.position.x < m_domainMin.x + m_particleRadius)
+        if (position.x < m_domainMin.x + m_particleRadius)
         {
-            particle.position.x = m_domainMin.x + m_particleRadius;
+            position.x = m_domainMin.x + m_particleRadius;
             normal = Vec2(1.0f, 0.0f);
             collided = true;
         }
-        else if (particle.position.x > m_domainMax.x - m_particleRadius)
+        else if (position.x > m_domainMax.x - m_particleRadius)
         {
-            particle.position.x = m_domainMax.x - m_particleRadius;
+            position.x = m_domainMax.x - m_particleRadius;
             normal = Vec2(-1.0f, 0.0f);
             collided = true;
         }
         
-        if (particle.position.y < m_domainMin.y + m_particleRadius)
+        if (position.y < m_domainMin.y + m_particleRadius)
         {
-            particle.position.y = m_domainMin.y + m_particleRadius;
+            position.y = m_domainMin.y + m_particleRadius;
             normal = Vec2(0.0f, 1.0f);
             collided = true;
         }
-        else if (particle.position.y > m_domainMax.y - m_particleRadius)
+        else if (position.y > m_domainMax.y - m_particleRadius)
         {
-            particle.position.y = m_domainMax.y - m_particleRadius;
+            position.y = m_domainMax.y - m_particleRadius;
             normal = Vec2(0.0f, -1.0f);
             collided = true;
         }
@@ -805,101 +989,113 @@ void SPHFluidSimulationScene::resolveParticleBoundaryCollisions()
         // Apply velocity reflection if collided
         if (collided)
         {
-            float vN = particle.velocity.dot(normal);
+            float vN = velocity.dot(normal);
             if (vN < 0.0f)
             {
                 float restitution = 0.1f;
-                particle.velocity = particle.velocity - normal * vN * (1.0f + restitution);
-                particle.velocity *= 0.98f; // Damping
+                velocity = velocity - normal * vN * (1.0f + restitution);
+                velocity *= 0.98f; // Damping
             }
         }
-    }
+    });
 }
 
-void SPHFluidSimulationScene::updateParticleSprites()
+void SPHFluidSimulationScene::updateParticleColors()
 {
-    for (const auto& p : m_particles)
+    AllocationScope allocScope;
+    if (m_useOptimizedLayout)
     {
-        if (auto* e = m_entityManager->findEntity(p.entityName))
+        auto& soa = m_optimizedParticles;
+        parallelFor(0, static_cast<int>(soa.count), 2048, [&](int begin, int end)
         {
-            if (auto* s = e->getComponent<SpriteComponent>())
+            for (int i = begin; i < end; ++i)
             {
-                s->setPosition(p.position.x, p.position.y, 0.0f);
-                
-                Vec4 color;
-                if (m_colorBySpeed)
-                {
-                    float speed = p.velocity.length();
-                    float sMin = std::min(m_colorSpeedMin, m_colorSpeedMax - 1.0f);
-                    float sMax = std::max(m_colorSpeedMax, sMin + 1.0f);
-                    float t = (speed - sMin) / (sMax - sMin);
-                    t = clampf(t, 0.0f, 1.0f);
+                const float speed = std::sqrt(soa.velocities_x[i] * soa.velocities_x[i] + soa.velocities_y[i] * soa.velocities_y[i]);
+                const Vec4 color = particleColor(speed, soa.densities[i]);
+                soa.colors[i] = packParticleColor(color.x, color.y, color.z, color.w);
+            }
+        });
+    }
+    for (auto& p : m_particles)
+    {
+        p.color = particleColor(p.velocity.length(), p.density);
+    }
 
-                    if (m_debugColor)
-                    {
-                        // Debug gradient: Blue -> Green -> Red
-                        Vec4 blue  = Vec4(0.0f, 0.0f, 1.0f, 1.0f);
-                        Vec4 green = Vec4(0.0f, 1.0f, 0.0f, 1.0f);
-                        Vec4 red   = Vec4(1.0f, 0.0f, 0.0f, 1.0f);
-                        if (t < 0.5f)
-                        {
-                            float k = t / 0.5f;
-                            color = Vec4(
-                                blue.x + (green.x - blue.x) * k,
-                                blue.y + (green.y - blue.y) * k,
-                                blue.z + (green.z - blue.z) * k,
-                                1.0f);
-                        }
-                        else
-                        {
-                            float k = (t - 0.5f) / 0.5f;
-                            color = Vec4(
-                                green.x + (red.x - green.x) * k,
-                                green.y + (red.y - green.y) * k,
-                                green.z + (red.z - green.z) * k,
-                                1.0f);
-                        }
-                    }
-                    else
-                    {
-                        // Regular gradient: deep blue -> cyan -> white
-                        Vec4 slow = Vec4(0.1f, 0.35f, 0.9f, 1.0f);
-                        Vec4 mid  = Vec4(0.0f, 1.0f, 1.0f, 1.0f);
-                        Vec4 fast = Vec4(0.95f, 0.95f, 0.95f, 1.0f);
-                        if (t < 0.5f)
-                        {
-                            float k = t / 0.5f;
-                            color = Vec4(
-                                slow.x + (mid.x - slow.x) * k,
-                                slow.y + (mid.y - slow.y) * k,
-                                slow.z + (mid.z - slow.z) * k,
-                                1.0f);
-                        }
-                        else
-                        {
-                            float k = (t - 0.5f) / 0.5f;
-                            color = Vec4(
-                                mid.x + (fast.x - mid.x) * k,
-                                mid.y + (fast.y - mid.y) * k,
-                                mid.z + (fast.z - mid.z) * k,
-                                1.0f);
-                        }
-                    }
-                }
-                else
-                {
-                    // Density-based fallback coloring
-                    float densityRatio = p.density / m_sphParams.rest_density;
-                    color = Vec4(0.2f, 0.6f, 1.0f, 1.0f);
-                    if (densityRatio > 1.0f)
-                    {
-                        color = Vec4(1.0f, 0.2f, 0.2f, 1.0f);
-                    }
-                }
-                s->setTint(color);
+    m_colorSyncAllocations = allocScope.allocations();
+}
+
+Vec4 SPHFluidSimulationScene::particleColor(float speed, float density) const
+{
+    Vec4 color;
+    if (m_colorBySpeed)
+    {
+        float sMin = std::min(m_colorSpeedMin, m_colorSpeedMax - 1.0f);
+        float sMax = std::max(m_colorSpeedMax, sMin + 1.0f);
+        float t = (speed - sMin) / (sMax - sMin);
+        t = clampf(t, 0.0f, 1.0f);
+
+        if (m_debugColor)
+        {
+            // Debug gradient: Blue -> Green -> Red
+            Vec4 blue  = Vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            Vec4 green = Vec4(0.0f, 1.0f, 0.0f, 1.0f);
+            Vec4 red   = Vec4(1.0f, 0.0f, 0.0f, 1.0f);
+            if (t < 0.5f)
+            {
+                float k = t / 0.5f;
+                color = Vec4(
+                    blue.x + (green.x - blue.x) * k,
+                    blue.y + (green.y - blue.y) * k,
+                    blue.z + (green.z - blue.z) * k,
+                    1.0f);
+            }
+            else
+            {
+                float k = (t - 0.5f) / 0.5f;
+                color = Vec4(
+                    green.x + (red.x - green.x) * k,
+                    green.y + (red.y - green.y) * k,
+                    green.z + (red.z - green.z) * k,
+                    1.0f);
+            }
+        }
+        else
+        {
+            // Regular gradient: deep blue -> cyan -> white
+            Vec4 slow = Vec4(0.1f, 0.35f, 0.9f, 1.0f);
+            Vec4 mid  = Vec4(0.0f, 1.0f, 1.0f, 1.0f);
+            Vec4 fast = Vec4(0.95f, 0.95f, 0.95f, 1.0f);
+            if (t < 0.5f)
+            {
+                float k = t / 0.5f;
+                color = Vec4(
+                    slow.x + (mid.x - slow.x) * k,
+                    slow.y + (mid.y - slow.y) * k,
+                    slow.z + (mid.z - slow.z) * k,
+                    1.0f);
+            }
+            else
+            {
+                float k = (t - 0.5f) / 0.5f;
+                color = Vec4(
+                    mid.x + (fast.x - mid.x) * k,
+                    mid.y + (fast.y - mid.y) * k,
+                    mid.z + (fast.z - mid.z) * k,
+                    1.0f);
             }
         }
     }
+    else
+    {
+        // Density-based fallback coloring
+        float densityRatio = density / m_sphParams.rest_density;
+        color = Vec4(0.2f, 0.6f, 1.0f, 1.0f);
+        if (densityRatio > 1.0f)
+        {
+            color = Vec4(1.0f, 0.2f, 0.2f, 1.0f);
+        }
+    }
+    return color;
 }
 
 // ========================= SPH Kernels =========================
@@ -964,6 +1160,16 @@ Vec2 SPHFluidSimulationScene::spikyKernelGradient(const Vec2& r, float smoothing
     return r * static_cast<f32>(factor / distance);
 }
 
+Vec2 SPHFluidSimulationScene::spikyKernelGradient(const Vec2& r, float distance, float smoothing_radius)
+{
+    float h = smoothing_radius;
+    float h3 = h * h * h;
+    float h6 = h3 * h3;
+    float t = 1.0f - distance / h;
+    float factor = -(45.0f / (3.14159f * h6)) * t * t;
+    return r * static_cast<f32>(factor / distance);
+}
+
 float SPHFluidSimulationScene::viscosityKernel(float distance, float smoothing_radius)
 {
     if (distance >= smoothing_radius) return 0.0f;
@@ -985,71 +1191,19 @@ void SPHFluidSimulationScene::SpatialGrid::initialize(float world_width, float w
     
     // Cell size relative to smoothing radius (default 1.0x). Lower => more cells, fewer candidates
     cell_size = std::max(1.0f, smoothing_radius * cell_scale);
-    grid_width = static_cast<int>(std::ceil(world_width / cell_size));
-    grid_height = static_cast<int>(std::ceil(world_height / cell_size));
-    
-    cells.resize(grid_width * grid_height);
-    temp_neighbors.reserve(64);
+    cells.resize(world_min_x, world_min_y, world_width, world_height, cell_size);
+    grid_width = cells.getCellsX();
+    grid_height = cells.getCellsY();
     
     printf("SPH Spatial grid initialized: Grid %dx%d, Cell size %.1f\n", 
            grid_width, grid_height, cell_size);
 }
 
-void SPHFluidSimulationScene::SpatialGrid::clear()
-{
-    for (size_t i = 0; i < cells.size(); ++i)
-    {
-        cells[i].clear();
-    }
-}
-
-void SPHFluidSimulationScene::SpatialGrid::addParticle(int particle_id, float x, float y)
-{
-    int grid_x = static_cast<int>((x - world_min.x) / cell_size);
-    int grid_y = static_cast<int>((y - world_min.y) / cell_size);
-    
-    grid_x = std::max(0, std::min(grid_x, grid_width - 1));
-    grid_y = std::max(0, std::min(grid_y, grid_height - 1));
-    
-    int cell_index = grid_y * grid_width + grid_x;
-    cells[cell_index].push_back(particle_id);
-}
-
-void SPHFluidSimulationScene::SpatialGrid::findNeighbors(int particle_id, float x, float y, float radius, std::vector<int>& neighbors)
-{
-    neighbors.clear();
-    
-    int grid_x = static_cast<int>((x - world_min.x) / cell_size);
-    int grid_y = static_cast<int>((y - world_min.y) / cell_size);
-    
-    for (int dy = -1; dy <= 1; ++dy)
-    {
-        for (int dx = -1; dx <= 1; ++dx)
-        {
-            int check_x = grid_x + dx;
-            int check_y = grid_y + dy;
-            
-            if (check_x < 0 || check_x >= grid_width ||
-                check_y < 0 || check_y >= grid_height)
-                continue;
-            
-            int cell_index = check_y * grid_width + check_x;
-            const auto& cell = cells[cell_index];
-            
-            for (int other_id : cell)
-            {
-                if (other_id == particle_id) continue;
-                neighbors.push_back(other_id);
-            }
-        }
-    }
-}
-
 // ========================= Mouse Interaction =========================
 
 Vec2 SPHFluidSimulationScene::getMouseWorldPosition() const
 {
-    auto* cameraEntity = m_entityManager->findEntity("MainCamera");
+    auto* cameraEntity = m_entityManager->getEntity(m_cameraEntity);
     if (!cameraEntity) return Vec2(0.0f, 0.0f);
     auto* cam = cameraEntity->getComponent<Camera2D>();
     if (!cam) return Vec2(0.0f, 0.0f);
@@ -1059,7 +1213,6 @@ Vec2 SPHFluidSimulationScene::getMouseWorldPosition() const
 
 void SPHFluidSimulationScene::addParticlesAt(const Vec2& worldPos, int count, float jitter)
 {
-    int startIdx = (int)m_particles.size();
     for (int i = 0; i < count; ++i)
     {
         SPHParticle p;
@@ -1070,135 +1223,103 @@ void SPHFluidSimulationScene::addParticlesAt(const Vec2& worldPos, int count, fl
         p.acceleration = Vec2(0.0f, 0.0f);
         p.density = m_sphParams.rest_density;
         p.pressure = 0.0f;
-        p.entityName = "SPHParticle_" + std::to_string(startIdx + i);
-
-        auto& e = m_entityManager->createEntity(p.entityName);
-        auto& s = e.addComponent<SpriteComponent>(*m_graphicsDevice, L"DX3D/Assets/Textures/MetaballFalloff.png", m_particleRadius * 2.0f, m_particleRadius * 2.0f);
-        s.setPosition(p.position.x, p.position.y, 0.0f);
-        s.setTint(Vec4(0.2f, 0.6f, 1.0f, 1.0f));
-        m_particles.push_back(p);
+        p.color = Vec4(0.2f, 0.6f, 1.0f, 1.0f);
+        if (m_useOptimizedLayout) m_optimizedParticles.addParticle(p);
+        else m_particles.push_back(p);
     }
 }
 
 void SPHFluidSimulationScene::applyForceBrush(const Vec2& worldPos, const Vec2& worldVel)
 {
     float r2 = m_brushRadius * m_brushRadius;
-    for (auto& p : m_particles)
+    forEachParticle([&](Vec2& position, Vec2& velocity)
     {
-        Vec2 d = p.position - worldPos;
+        Vec2 d = position - worldPos;
         float dist2 = d.x * d.x + d.y * d.y;
         if (dist2 <= r2)
         {
             float dist = std::sqrt(std::max(1e-4f, dist2));
             float falloff = 1.0f - dist / m_brushRadius;
-            p.velocity += worldVel * falloff * (m_forceStrength / 10000.0f);
+            velocity += worldVel * falloff * (m_forceStrength / 10000.0f);
         }
-    }
+    });
 }
 
 // ========================= Collision Detection (LiquidFun Style) =========================
 
-void SPHFluidSimulationScene::buildCollisionHash()
+void SPHFluidSimulationScene::resolveParticleCollisions()
 {
-    m_collisionHash.clear();
-    float inv = 1.0f / std::max(1.0f, m_collisionHashCellSize);
-    
-    for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
-    {
-        const Vec2& pos = m_particles[i].position;
-        int ix = static_cast<int>(std::floor((pos.x - m_domainMin.x) * inv));
-        int iy = static_cast<int>(std::floor((pos.y - m_domainMin.y) * inv));
-        m_collisionHash[collisionHashKey(ix, iy)].push_back(i);
-    }
+    resolveCollisionsBlocked(AosAccess{ m_particles });
 }
 
-void SPHFluidSimulationScene::resolveParticleCollisions()
+template<typename Particles>
+void SPHFluidSimulationScene::resolveCollisionsBlocked(Particles particles)
 {
     const float particleDiameter = m_particleRadius * 2.0f;
     const float targetDistance = particleDiameter * 0.95f; // Slightly less for packing
     const float targetDistance2 = targetDistance * targetDistance;
     const float slop = particleDiameter * 0.1f; // penetration allowance to reduce jitter
     const float smallRelVel = 5.0f; // threshold to damp tiny bouncing
-    std::vector<int> neighbors;
-    neighbors.reserve(128);
+    
+    // Gauss-Seidel over the table's pairs (j > i), distances re-measured as particles move.
+    // Blocks of one color never share a particle, and each walks its rows bottom to top
+    // (shock propagation), so the result does not depend on the thread count.
     for (int iteration = 0; iteration < m_collisionIterations; ++iteration)
     {
-        // Shock propagation: process from bottom to top
-        std::vector<int> order(m_particles.size());
-        for (int k = 0; k < static_cast<int>(m_particles.size()); ++k) order[k] = k;
-        std::sort(order.begin(), order.end(), [&](int a, int b) { return m_particles[a].position.y < m_particles[b].position.y; });
-
-        for (int idx = 0; idx < static_cast<int>(order.size()); ++idx)
+        m_pairBlocks.forEachBlock([&](int, const int* block, int blockSize)
         {
-            int i = order[idx];
-            const Vec2& pos_i = m_particles[i].position;
-            int ix = static_cast<int>(std::floor((pos_i.x - m_domainMin.x) / m_collisionHashCellSize));
-            int iy = static_cast<int>(std::floor((pos_i.y - m_domainMin.y) / m_collisionHashCellSize));
-            
-            // Check 3x3 grid around particle
-            for (int dy = -1; dy <= 1; ++dy)
+            for (int n = 0; n < blockSize; ++n)
             {
-                for (int dx = -1; dx <= 1; ++dx)
+                const int i = block[n];
+                if (!particles.awake(i)) continue;
+                
+                int processed = 0;
+                for (int k = m_neighborTable.begin(i); k < m_neighborTable.end(i); ++k)
                 {
-                    auto it = m_collisionHash.find(collisionHashKey(ix + dx, iy + dy));
-                    if (it == m_collisionHash.end()) continue;
+                    const int j = m_neighborTable.getIndex(k);
+                    if (j <= i || !particles.awake(j)) continue; // Avoid duplicate pairs
+                    if (processed++ >= m_maxCollisionNeighbors) break; // Cap work per particle
+                    
+                    Vec2 pos_i = particles.position(i);
+                    Vec2 pos_j = particles.position(j);
+                    Vec2 dp = pos_j - pos_i;
+                    float dist2 = dp.x * dp.x + dp.y * dp.y;
                     
-                    const auto& bucket = it->second;
-                    int processed = 0;
-                    for (int j : bucket)
+                    if (dist2 < targetDistance2 && dist2 > 1e-6f)
                     {
-                        if (j <= i) continue; // Avoid duplicate pairs
-                        if (processed++ >= m_maxCollisionNeighbors) break; // Cap work per particle
+                        float dist = std::sqrt(dist2);
+                        Vec2 normal = dp * (1.0f / dist);
+                        float overlap = targetDistance - dist;
                         
-                        Vec2 pos_j = m_particles[j].position;
-                        Vec2 dp = pos_j - pos_i;
-                        float dist2 = dp.x * dp.x + dp.y * dp.y;
+                        // Skip tiny penetrations (slop) to avoid jitter
+                        if (overlap <= slop) continue;
+                        
+                        // Split impulse: position correction WITHOUT velocity injection
+                        float separation = (overlap - slop) * 0.4f;
+                        particles.setPosition(i, pos_i - normal * separation);
+                        particles.setPosition(j, pos_j + normal * separation);
+                        
+                        // Only apply velocity response for significant relative motion
+                        Vec2 vel_i = particles.velocity(i);
+                        Vec2 vel_j = particles.velocity(j);
+                        Vec2 relVel = vel_j - vel_i;
+                        float relVelN = relVel.x * normal.x + relVel.y * normal.y;
                         
-                        if (dist2 < targetDistance2 && dist2 > 1e-6f)
+                        if (relVelN < -smallRelVel) // Only for significant approaching motion
                         {
-                            float dist = std::sqrt(dist2);
-                            Vec2 normal = dp * (1.0f / dist);
-                            float overlap = targetDistance - dist;
-                            
-                            // Skip tiny penetrations (slop) to avoid jitter
-                            if (overlap <= slop) continue;
-                            
-                            // Split impulse: position correction WITHOUT velocity injection
-                            float separation = (overlap - slop) * 0.4f;
-                            m_particles[i].position -= normal * separation;
-                            m_particles[j].position += normal * separation;
-                            
-                            // Only apply velocity response for significant relative motion
-                            Vec2 relVel = m_particles[j].velocity - m_particles[i].velocity;
-                            float relVelN = relVel.x * normal.x + relVel.y * normal.y;
-                            
-                            if (relVelN < -smallRelVel) // Only for significant approaching motion
-                            {
-                                // Gentle velocity correction (no bouncing)
-                                float correction = -relVelN * 0.1f; // Very gentle
-                                Vec2 velCorrection = normal * correction;
-                                m_particles[i].velocity += velCorrection;
-                                m_particles[j].velocity -= velCorrection;
-                            }
+                            // Gentle velocity correction (no bouncing)
+                            float correction = -relVelN * 0.1f; // Very gentle
+                            Vec2 velCorrection = normal * correction;
+                            particles.setVelocity(i, vel_i + velCorrection);
+                            particles.setVelocity(j, vel_j - velCorrection);
                         }
                     }
                 }
             }
-        }
-        
-        // Rebuild hash after positions changed
-        if (iteration + 1 < m_collisionIterations)
-        {
-            buildCollisionHash();
-        }
+        }, std::max(1, m_threadCount));
     }
 }
 
-long long SPHFluidSimulationScene::collisionHashKey(int ix, int iy) const
-{
-    return (static_cast<long long>(ix) << 32) ^ static_cast<unsigned long long>(iy);
-}
-
 // ========================= LiquidFun-Style Optimized Implementation =========================
 
 void SPHFluidSimulationScene::OptimizedParticleData::resize(size_t new_capacity)
@@ -1212,16 +1333,16 @@ void SPHFluidSimulationScene::OptimizedParticleData::resize(size_t new_capacity)
     accelerations_y.resize(capacity);
     densities.resize(capacity);
     pressures.resize(capacity);
+    inv_densities.resize(capacity);
     masses.resize(capacity);
     radii.resize(capacity);
     colors.resize(capacity);
-    entity_ids.resize(capacity);
     is_awake.resize(capacity);
 }
 
-void SPHFluidSimulationScene::OptimizedParticleData::addParticle(const SPHParticle& p, uint16_t entity_id)
+void SPHFluidSimulationScene::OptimizedParticleData::addParticle(const SPHParticle& p)
 {
-    if (count >= capacity) resize(capacity * 2);
+    if (count >= capacity) resize(std::max<size_t>(capacity * 2, 64));
     
     positions_x[count] = p.position.x;
     positions_y[count] = p.position.y;
@@ -1231,40 +1352,26 @@ void SPHFluidSimulationScene::OptimizedParticleData::addParticle(const SPHPartic
     accelerations_y[count] = p.acceleration.y;
     densities[count] = p.density;
     pressures[count] = p.pressure;
+    inv_densities[count] = 1.0f / std::max(1e-3f, p.density);
     masses[count] = 1.0f; // Default mass
     radii[count] = 4.0f; // Default radius
-    colors[count] = 0xFF4080FF; // Default blue
-    entity_ids[count] = entity_id;
-    is_awake[count] = true;
+    colors[count] = packParticleColor(p.color.x, p.color.y, p.color.z, p.color.w);
+    is_awake[count] = 1;
     
     count++;
 }
 
 void SPHFluidSimulationScene::OptimizedParticleData::syncFromParticles(const std::vector<SPHParticle>& particles)
 {
-    if (particles.size() != count)
-    {
-        count = particles.size();
-        if (count > capacity) resize(count);
-    }
-    
-    for (size_t i = 0; i < count; ++i)
-    {
-        positions_x[i] = particles[i].position.x;
-        positions_y[i] = particles[i].position.y;
-        velocities_x[i] = particles[i].velocity.x;
-        velocities_y[i] = particles[i].velocity.y;
-        accelerations_x[i] = particles[i].acceleration.x;
-        accelerations_y[i] = particles[i].acceleration.y;
-        densities[i] = particles[i].density;
-        pressures[i] = particles[i].pressure;
-        is_awake[i] = true; // ensure active after sync
-    }
+    count = 0;
+    if (particles.size() > capacity) resize(particles.size());
+    for (const auto& p : particles) addParticle(p);
 }
 
 void SPHFluidSimulationScene::OptimizedParticleData::syncToParticles(std::vector<SPHParticle>& particles)
 {
-    for (size_t i = 0; i < count && i < particles.size(); ++i)
+    particles.resize(count);
+    for (size_t i = 0; i < count; ++i)
     {
         particles[i].position.x = positions_x[i];
         particles[i].position.y = positions_y[i];
@@ -1274,20 +1381,84 @@ void SPHFluidSimulationScene::OptimizedParticleData::syncToParticles(std::vector
         particles[i].acceleration.y = accelerations_y[i];
         particles[i].density = densities[i];
         particles[i].pressure = pressures[i];
+        const ParticleColor color = unpackParticleColor(colors[i]);
+        particles[i].color = Vec4(color.r, color.g, color.b, color.a);
     }
 }
 
-void SPHFluidSimulationScene::stepSPHOptimized(float dt)
+void SPHFluidSimulationScene::OptimizedParticleData::reorder(const std::vector<int>& order, int maxThreads)
 {
-    // Sync from particles to optimized layout
-    m_optimizedParticles.syncFromParticles(m_particles);
-    
-    // Update spatial grid with optimized data
-    m_spatialGrid.clear();
-    for (size_t i = 0; i < m_optimizedParticles.count; ++i)
+    const int n = static_cast<int>(order.size());
+    auto gather = [&](auto& field, auto& scratch)
     {
-        m_spatialGrid.addParticle(static_cast<int>(i), m_optimizedParticles.positions_x[i], m_optimizedParticles.positions_y[i]);
+        scratch.resize(field.size());
+        JobSystem::getInstance().parallelFor(0, n, 2048, [&](int begin, int end)
+        {
+            for (int k = begin; k < end; ++k) scratch[k] = field[order[k]];
+        }, maxThreads);
+        field.swap(scratch);
+    };
+    for (auto* field : { &positions_x, &positions_y, &velocities_x, &velocities_y, &accelerations_x, &accelerations_y,
+        &densities, &pressures, &inv_densities, &masses, &radii })
+        gather(*field, reorderScratch);
+    gather(colors, reorderScratchColors);
+    gather(is_awake, reorderScratchAwake);
+}
+
+void SPHFluidSimulationScene::setOptimizedLayout(bool enabled)
+{
+    if (enabled == m_useOptimizedLayout) return;
+    // The particles move to whichever layout is active; the other stays empty
+    if (enabled)
+    {
+        m_optimizedParticles.syncFromParticles(m_particles);
+        m_particles.clear();
+    }
+    else
+    {
+        m_optimizedParticles.syncToParticles(m_particles);
+        m_optimizedParticles.count = 0;
     }
+    m_useOptimizedLayout = enabled;
+    if (!enabled) m_solverMode = SPHSolverMode::EquationOfState;
+    m_neighborsValid = false;
+}
+
+SPHFluidFields SPHFluidSimulationScene::optimizedFields()
+{
+    auto& soa = m_optimizedParticles;
+    SPHFluidFields fields;
+    fields.x = soa.positions_x.data();
+    fields.y = soa.positions_y.data();
+    fields.vx = soa.velocities_x.data();
+    fields.vy = soa.velocities_y.data();
+    fields.density = soa.densities.data();
+    fields.pressure = soa.pressures.data();
+    fields.invDensity = soa.inv_densities.data();
+    fields.ax = soa.accelerations_x.data();
+    fields.ay = soa.accelerations_y.data();
+    fields.awake = soa.is_awake.data();
+    return fields;
+}
+
+void SPHFluidSimulationScene::stepSPHOptimized(float dt)
+{
+    // The SoA arrays are the particles here: nothing is copied in or out per step
+    const int count = static_cast<int>(m_optimizedParticles.count);
+    const int threads = std::max(1, m_threadCount);
+    ++m_stepsSinceReorder;
+    updateNeighborsOptimized(count, threads, m_reorderInterval > 0 && m_stepsSinceReorder >= m_reorderInterval);
+
+    SPHFluidConstants fluid;
+    fluid.mass = m_sphParams.mass;
+    fluid.restDensity = m_sphParams.rest_density;
+    fluid.minDensity = m_sphParams.rest_density * 0.1f;
+    fluid.gasConstant = m_sphParams.gas_constant;
+    fluid.viscosity = m_sphParams.viscosity + m_sphParams.artificial_viscosity;
+    fluid.artificialPressure = m_sphParams.artificial_pressure;
+    fluid.gravity = m_sphParams.gravity;
+    fluid.maxAcceleration = 5000.0f;
+    m_kernels.setConstants(m_kernelConstants, fluid);
     
     // Optimized SPH steps
     calculateDensityOptimized();
@@ -1295,14 +1466,7 @@ void SPHFluidSimulationScene::stepSPHOptimized(float dt)
     calculateForcesOptimized();
     integrateParticlesOptimized(dt);
     
-    // Rebuild spatial grid for collision phase (positions updated during integration)
-    m_spatialGrid.clear();
-    for (size_t i = 0; i < m_optimizedParticles.count; ++i)
-    {
-        m_spatialGrid.addParticle(static_cast<int>(i), m_optimizedParticles.positions_x[i], m_optimizedParticles.positions_y[i]);
-    }
-    
-    // Optimized collision resolution
+    // Optimized collision resolution (over this step's table pairs, re-measured)
     if (m_enableParticleCollisions)
     {
         resolveCollisionsOptimized();
@@ -1314,116 +1478,102 @@ void SPHFluidSimulationScene::stepSPHOptimized(float dt)
         updateIslands();
     }
     
-    // Sync back to particles
-    m_optimizedParticles.syncToParticles(m_particles);
-    
     // Enforce boundaries
     enforceBoundaries();
 }
 
-void SPHFluidSimulationScene::calculateDensityOptimized()
+void SPHFluidSimulationScene::stepPositionBased(float dt)
+{
+    // Positions are predicted, then the grid, table and blocks are built on them for the solve
+    const int count = static_cast<int>(m_optimizedParticles.count);
+    const int threads = std::max(1, m_threadCount);
+    auto& soa = m_optimizedParticles;
+    // The reorder goes before predict(), which keeps the start positions by index; the
+    // next table update then most likely rebuilds
+    if (m_reorderInterval > 0 && ++m_stepsSinceReorder >= m_reorderInterval)
+    {
+        m_stepsSinceReorder = 0;
+        m_spatialGrid.update(soa.positions_x.data(), soa.positions_y.data(), count, threads);
+        reorderOptimizedParticles();
+    }
+
+    // Rest spacing is the collision pass's target distance; the box is resolveParticleBoundaryCollisions'
+    SPHPositionSolverSettings settings = m_positionSettings;
+    settings.restSpacing = m_particleRadius * 2.0f * 0.95f;
+    settings.gravity = m_sphParams.gravity;
+    settings.restDensity = m_sphParams.rest_density;
+    settings.minX = m_domainMin.x + m_particleRadius;
+    settings.minY = m_domainMin.y + m_particleRadius;
+    settings.maxX = m_domainMax.x - m_particleRadius;
+    settings.maxY = m_domainMax.y - m_particleRadius;
+    m_positionSolver.setSettings(m_sphParams.smoothing_radius, settings);
+
+    SPHPositionFields fields;
+    fields.x = soa.positions_x.data();
+    fields.y = soa.positions_y.data();
+    fields.vx = soa.velocities_x.data();
+    fields.vy = soa.velocities_y.data();
+    fields.density = soa.densities.data();
+    m_positionSolver.predict(fields, count, dt, threads);
+    updateNeighborsOptimized(count, threads, false);
+    m_positionSolver.solve(m_neighborTable, m_pairBlocks, fields, count, dt, threads);
+    m_density_calculations = static_cast<uint32_t>(m_neighborTable.getPairCount());
+    m_neighbor_checks = m_density_calculations;
+    m_average_neighbors = count > 0 ? static_cast<float>(m_neighbor_checks) / count : 0.0f;
+
+    enforceBoundaries();
+}
+
+void SPHFluidSimulationScene::updateNeighborsOptimized(int count, int threads, bool reorderDue)
 {
-    m_density_calculations = 0;
-    std::vector<int> neighbors;
-    neighbors.reserve(64);
-    for (size_t i = 0; i < m_optimizedParticles.count; ++i)
+    // A refresh only asks whether every particle is still within skin / 2 of where the
+    // last build saw it (by index), so it stays right across reorders and layout switches
+    auto& soa = m_optimizedParticles;
+    const float h = m_sphParams.smoothing_radius;
+    m_neighborTable.setSkin(m_neighborSkin);
+    if (m_neighborTable.refresh(soa.positions_x.data(), soa.positions_y.data(), count, h, threads))
     {
-        if (!m_optimizedParticles.is_awake[i]) continue;
-        
-        f32 density = 0.0f;
-        m_spatialGrid.findNeighbors(static_cast<int>(i), m_optimizedParticles.positions_x[i], m_optimizedParticles.positions_y[i], m_sphParams.smoothing_radius, neighbors);
-        
-        for (int j : neighbors)
-        {
-            if (static_cast<size_t>(j) == i) continue;
-            
-            f32 dx = m_optimizedParticles.positions_x[i] - m_optimizedParticles.positions_x[j];
-            f32 dy = m_optimizedParticles.positions_y[i] - m_optimizedParticles.positions_y[j];
-            f32 distance = std::sqrt(dx * dx + dy * dy);
-            
-            if (distance < m_sphParams.smoothing_radius)
-            {
-                density += m_sphParams.mass * poly6Kernel(distance, m_sphParams.smoothing_radius);
-                m_density_calculations++;
-            }
-        }
-        
-        m_optimizedParticles.densities[i] = std::max(density, m_sphParams.rest_density * 0.1f);
+        ++m_neighborRefreshes;
+        return;
+    }
+
+    m_spatialGrid.update(soa.positions_x.data(), soa.positions_y.data(), count, threads);
+    if (reorderDue)
+    {
+        m_stepsSinceReorder = 0;
+        reorderOptimizedParticles(); // swaps the arrays: positions are fetched again below
+        m_spatialGrid.build(soa.positions_x.data(), soa.positions_y.data(), count, threads);
     }
+    m_neighborTable.build(soa.positions_x.data(), soa.positions_y.data(), count, m_spatialGrid.cells, h, threads);
+    m_pairBlocks.build(m_spatialGrid.cells, h + m_neighborTable.getSkin(), threads);
+    ++m_neighborRebuilds;
+}
+
+void SPHFluidSimulationScene::reorderOptimizedParticles()
+{
+    // As reorderParticles: nothing keeps a particle index across steps
+    mortonOrder(m_spatialGrid.cells, m_reorderOrder, m_reorderCellKeys);
+    m_optimizedParticles.reorder(m_reorderOrder, std::max(1, m_threadCount));
+}
+
+void SPHFluidSimulationScene::calculateDensityOptimized()
+{
+    SPHFluidFields fields = optimizedFields();
+    parallelFor(0, static_cast<int>(m_optimizedParticles.count), 256, [&](int begin, int end)
+    {
+        m_kernels.density(m_neighborTable, fields, begin, end);
+    });
+    m_density_calculations = static_cast<uint32_t>(m_neighborTable.getPairCount());
 }
 
 void SPHFluidSimulationScene::calculateForcesOptimized()
 {
-    m_neighbor_checks = 0;
-    std::vector<int> neighbors;
-    neighbors.reserve(64);
-    for (size_t i = 0; i < m_optimizedParticles.count; ++i)
+    SPHFluidFields fields = optimizedFields();
+    parallelFor(0, static_cast<int>(m_optimizedParticles.count), 256, [&](int begin, int end)
     {
-        if (!m_optimizedParticles.is_awake[i]) continue;
-        
-        f32 pressureForceX = 0.0f;
-        f32 pressureForceY = 0.0f;
-        f32 viscosityForceX = 0.0f;
-        f32 viscosityForceY = 0.0f;
-        f32 artificialPressureForceX = 0.0f;
-        f32 artificialPressureForceY = 0.0f;
-        
-        m_spatialGrid.findNeighbors(static_cast<int>(i), m_optimizedParticles.positions_x[i], m_optimizedParticles.positions_y[i], m_sphParams.smoothing_radius, neighbors);
-        
-        for (int j : neighbors)
-        {
-            if (static_cast<size_t>(j) == i) continue;
-            
-            f32 dx = m_optimizedParticles.positions_x[i] - m_optimizedParticles.positions_x[j];
-            f32 dy = m_optimizedParticles.positions_y[i] - m_optimizedParticles.positions_y[j];
-            f32 distance = std::sqrt(dx * dx + dy * dy);
-            
-            if (distance < m_sphParams.smoothing_radius && distance > 1e-6f)
-            {
-                m_neighbor_checks++;
-                
-                // Standard pressure force
-                f32 pressureTerm = (m_optimizedParticles.pressures[i] + m_optimizedParticles.pressures[j]) / (2.0f * std::max(1e-3f, m_optimizedParticles.densities[j]));
-                Vec2 pressureGradient = spikyKernelGradient(Vec2(dx, dy), m_sphParams.smoothing_radius);
-                pressureForceX -= pressureGradient.x * (m_sphParams.mass * pressureTerm);
-                pressureForceY -= pressureGradient.y * (m_sphParams.mass * pressureTerm);
-                
-                // Artificial pressure for incompressibility
-                f32 densityRatio = m_optimizedParticles.densities[i] / m_sphParams.rest_density;
-                f32 artificialPressure = m_sphParams.artificial_pressure * (densityRatio * densityRatio * densityRatio * densityRatio - 1.0f);
-                artificialPressureForceX -= pressureGradient.x * (m_sphParams.mass * artificialPressure);
-                artificialPressureForceY -= pressureGradient.y * (m_sphParams.mass * artificialPressure);
-                
-                // Viscosity force
-                f32 velocityDiffX = m_optimizedParticles.velocities_x[j] - m_optimizedParticles.velocities_x[i];
-                f32 velocityDiffY = m_optimizedParticles.velocities_y[j] - m_optimizedParticles.velocities_y[i];
-                f32 viscosityTerm = m_sphParams.viscosity * m_sphParams.mass * viscosityKernel(distance, m_sphParams.smoothing_radius) / std::max(1e-3f, m_optimizedParticles.densities[j]);
-                viscosityForceX += velocityDiffX * viscosityTerm;
-                viscosityForceY += velocityDiffY * viscosityTerm;
-                
-                // Artificial viscosity for stability
-                f32 artificialViscosityTerm = m_sphParams.artificial_viscosity * m_sphParams.mass * viscosityKernel(distance, m_sphParams.smoothing_radius) / std::max(1e-3f, m_optimizedParticles.densities[j]);
-                viscosityForceX += velocityDiffX * artificialViscosityTerm;
-                viscosityForceY += velocityDiffY * artificialViscosityTerm;
-            }
-        }
-        
-        // Total force with improved magnitude limiting
-        f32 denom = std::max(1e-3f, m_optimizedParticles.densities[i]);
-        f32 totalForceX = (pressureForceX + artificialPressureForceX + viscosityForceX) / denom;
-        f32 totalForceY = (pressureForceY + artificialPressureForceY + viscosityForceY) / denom + m_sphParams.gravity;
-        
-        f32 forceMagnitude = std::sqrt(totalForceX * totalForceX + totalForceY * totalForceY);
-        if (forceMagnitude > 5000.0f) // Increased from 1000.0f
-        {
-            f32 scale = 5000.0f / forceMagnitude;
-            totalForceX *= scale;
-            totalForceY *= scale;
-        }
-        
-        m_optimizedParticles.accelerations_x[i] = totalForceX;
-        m_optimizedParticles.accelerations_y[i] = totalForceY;
-    }
+        m_kernels.forces(m_neighborTable, fields, begin, end);
+    });
+    m_neighbor_checks = static_cast<uint32_t>(m_neighborTable.getPairCount());
     
     // Update average neighbors
     if (m_optimizedParticles.count > 0)
@@ -1434,101 +1584,36 @@ void SPHFluidSimulationScene::calculateForcesOptimized()
 
 void SPHFluidSimulationScene::calculatePressureOptimized()
 {
-    for (size_t i = 0; i < m_optimizedParticles.count; ++i)
+    SPHFluidFields fields = optimizedFields();
+    parallelFor(0, static_cast<int>(m_optimizedParticles.count), 4096, [&](int begin, int end)
     {
-        m_optimizedParticles.pressures[i] = m_sphParams.gas_constant * (m_optimizedParticles.densities[i] - m_sphParams.rest_density);
-    }
+        m_kernels.pressure(fields, begin, end);
+    });
 }
 
 void SPHFluidSimulationScene::integrateParticlesOptimized(float dt)
 {
-    for (size_t i = 0; i < m_optimizedParticles.count; ++i)
-    {
-        if (!m_optimizedParticles.is_awake[i]) continue;
-        
-        // Verlet integration with damping
-        m_optimizedParticles.velocities_x[i] += m_optimizedParticles.accelerations_x[i] * dt;
-        m_optimizedParticles.velocities_y[i] += m_optimizedParticles.accelerations_y[i] * dt;
-        m_optimizedParticles.velocities_x[i] *= 0.99f; // Damping
-        m_optimizedParticles.velocities_y[i] *= 0.99f;
-        
-        m_optimizedParticles.positions_x[i] += m_optimizedParticles.velocities_x[i] * dt;
-        m_optimizedParticles.positions_y[i] += m_optimizedParticles.velocities_y[i] * dt;
-    }
-}
-
-void SPHFluidSimulationScene::resolveCollisionsOptimized()
-{
-    const f32 particleDiameter = m_particleRadius * 2.0f;
-    const f32 targetDistance = particleDiameter * 0.95f;
-    const f32 targetDistance2 = targetDistance * targetDistance;
-    const f32 slop = particleDiameter * 0.1f;
-    const f32 smallRelVel = 5.0f;
-    
-    for (int iteration = 0; iteration < m_collisionIterations; ++iteration)
+    parallelFor(0, static_cast<int>(m_optimizedParticles.count), 1024, [&](int begin, int end)
     {
-        std::vector<int> neighbors;
-        neighbors.reserve(128);
-        // Shock propagation order: bottom to top
-        std::vector<int> order(static_cast<int>(m_optimizedParticles.count));
-        for (int k = 0; k < static_cast<int>(m_optimizedParticles.count); ++k) order[k] = k;
-        std::sort(order.begin(), order.end(), [&](int a, int b) { return m_optimizedParticles.positions_y[a] < m_optimizedParticles.positions_y[b]; });
-        for (size_t ord = 0; ord < order.size(); ++ord)
+        for (size_t i = static_cast<size_t>(begin); i < static_cast<size_t>(end); ++i)
         {
-            int i = order[ord];
             if (!m_optimizedParticles.is_awake[i]) continue;
             
-            f32 posX = m_optimizedParticles.positions_x[i];
-            f32 posY = m_optimizedParticles.positions_y[i];
-            
-            m_spatialGrid.findNeighbors(static_cast<int>(i), posX, posY, m_sphParams.smoothing_radius, neighbors);
+            // Verlet integration with damping
+            m_optimizedParticles.velocities_x[i] += m_optimizedParticles.accelerations_x[i] * dt;
+            m_optimizedParticles.velocities_y[i] += m_optimizedParticles.accelerations_y[i] * dt;
+            m_optimizedParticles.velocities_x[i] *= 0.99f; // Damping
+            m_optimizedParticles.velocities_y[i] *= 0.99f;
             
-            int processed = 0;
-            for (int j : neighbors)
-            {
-                if (static_cast<size_t>(j) <= i || !m_optimizedParticles.is_awake[j]) continue;
-                if (processed++ >= m_maxCollisionNeighbors) break;
-                
-                f32 dx = m_optimizedParticles.positions_x[j] - posX;
-                f32 dy = m_optimizedParticles.positions_y[j] - posY;
-                f32 dist2 = dx * dx + dy * dy;
-                
-                if (dist2 < targetDistance2 && dist2 > 1e-6f)
-                {
-                    f32 dist = std::sqrt(dist2);
-                    f32 invDist = 1.0f / dist;
-                    f32 normalX = dx * invDist;
-                    f32 normalY = dy * invDist;
-                    f32 overlap = targetDistance - dist;
-                    
-                    if (overlap <= slop) continue;
-                    // Split impulse: position correction WITHOUT velocity injection
-                    f32 separation = (overlap - slop) * 0.4f;
-                    m_optimizedParticles.positions_x[i] -= normalX * separation;
-                    m_optimizedParticles.positions_y[i] -= normalY * separation;
-                    m_optimizedParticles.positions_x[j] += normalX * separation;
-                    m_optimizedParticles.positions_y[j] += normalY * separation;
-                    
-                    // Only apply velocity response for significant relative motion
-                    f32 relVelX = m_optimizedParticles.velocities_x[j] - m_optimizedParticles.velocities_x[i];
-                    f32 relVelY = m_optimizedParticles.velocities_y[j] - m_optimizedParticles.velocities_y[i];
-                    f32 relVelN = relVelX * normalX + relVelY * normalY;
-                    
-                    if (relVelN < -smallRelVel) // Only for significant approaching motion
-                    {
-                        // Gentle velocity correction (no bouncing)
-                        f32 correction = -relVelN * 0.1f; // Very gentle
-                        f32 velCorrectionX = normalX * correction;
-                        f32 velCorrectionY = normalY * correction;
-                        m_optimizedParticles.velocities_x[i] += velCorrectionX;
-                        m_optimizedParticles.velocities_y[i] += velCorrectionY;
-                        m_optimizedParticles.velocities_x[j] -= velCorrectionX;
-                        m_optimizedParticles.velocities_y[j] -= velCorrectionY;
-                    }
-                }
-            }
+            m_optimizedParticles.positions_x[i] += m_optimizedParticles.velocities_x[i] * dt;
+            m_optimizedParticles.positions_y[i] += m_optimizedParticles.velocities_y[i] * dt;
         }
-    }
+    });
+}
+
+void SPHFluidSimulationScene::resolveCollisionsOptimized()
+{
+    resolveCollisionsBlocked(SoaAccess{ m_optimizedParticles });
 }
 
 void SPHFluidSimulationScene::updateIslands()
@@ -1541,12 +1626,12 @@ void SPHFluidSimulationScene::updateIslands()
         
         if (speed > m_sleepThreshold)
         {
-            m_optimizedParticles.is_awake[i] = true;
+            m_optimizedParticles.is_awake[i] = 1;
         }
         else
         {
             // Could implement sleep counter here
-            m_optimizedParticles.is_awake[i] = true; // Keep awake for now
+            m_optimizedParticles.is_awake[i] = 1; // Keep awake for now
         }
     }
 }
@@ -1561,75 +1646,98 @@ void SPHFluidSimulationScene::buildContactCache()
 
 void SPHFluidSimulationScene::buildContactList()
 {
-    m_contactList.clear();
     const float particleDiameter = m_particleRadius * 2.0f;
     const float contactDistance = particleDiameter * 0.98f;
     const float contactDistance2 = contactDistance * contactDistance;
     
-    // Build contact list using spatial grid
-    for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
+    // Contacts from the table's pairs (j > i), grouped by the block of particle_a so the
+    // constraint passes can run colored blocks in parallel: count, offsets, then fill
+    const int blocks = m_pairBlocks.getBlockCount();
+    m_contactBlockStart.assign(blocks + 1, 0);
+    auto forEachContact = [&](int block, auto&& fn)
+    {
+        const int* particles = m_pairBlocks.getBlockParticles(block);
+        for (int n = 0; n < m_pairBlocks.getBlockSize(block); ++n)
+        {
+            const int i = particles[n];
+            for (int k = m_neighborTable.begin(i); k < m_neighborTable.end(i); ++k)
+            {
+                const int j = m_neighborTable.getIndex(k);
+                if (j <= i) continue;
+                
+                Vec2 dp = m_particles[j].position - m_particles[i].position;
+                float dist2 = dp.x * dp.x + dp.y * dp.y;
+                if (dist2 < contactDistance2 && dist2 > 1e-6f) fn(i, j, dp, dist2);
+            }
+        }
+    };
+    parallelFor(0, blocks, 4, [&](int begin, int end)
     {
-        std::vector<int> neighbors;
-        m_spatialGrid.findNeighbors(i, m_particles[i].position.x, m_particles[i].position.y, m_sphParams.smoothing_radius, neighbors);
-        
-        for (int j : neighbors)
+        for (int b = begin; b < end; ++b)
         {
-            if (j <= i) continue;
-            
-            Vec2 dp = m_particles[j].position - m_particles[i].position;
-            float dist2 = dp.x * dp.x + dp.y * dp.y;
-            
-            if (dist2 < contactDistance2 && dist2 > 1e-6f)
+            int contacts = 0;
+            forEachContact(b, [&](int, int, const Vec2&, float) { ++contacts; });
+            m_contactBlockStart[b + 1] = contacts;
+        }
+    });
+    for (int b = 0; b < blocks; ++b) m_contactBlockStart[b + 1] += m_contactBlockStart[b];
+    
+    m_contactList.resize(m_contactBlockStart[blocks]);
+    parallelFor(0, blocks, 4, [&](int begin, int end)
+    {
+        for (int b = begin; b < end; ++b)
+        {
+            int next = m_contactBlockStart[b];
+            forEachContact(b, [&](int i, int j, const Vec2& dp, float dist2)
             {
                 float dist = std::sqrt(dist2);
-                Vec2 normal = dp * (1.0f / dist);
-                float overlap = contactDistance - dist;
-                
-                ContactInfo contact;
+                ContactInfo& contact = m_contactList[next++];
                 contact.particle_a = i;
                 contact.particle_b = j;
-                contact.normal = normal;
-                contact.overlap = overlap;
+                contact.normal = dp * (1.0f / dist);
+                contact.overlap = contactDistance - dist;
                 contact.sleep_counter = 0;
                 contact.is_active = true;
-                m_contactList.push_back(contact);
-            }
+            });
         }
-    }
+    });
 }
 
 void SPHFluidSimulationScene::updateContactSleeping()
 {
     if (!m_enableContactSleeping) return;
     
-    for (auto& contact : m_contactList)
+    // Each contact only writes itself
+    parallelFor(0, static_cast<int>(m_contactList.size()), 1024, [&](int begin, int end)
     {
-        if (!contact.is_active) continue;
-        
-        Vec2& pos_a = m_particles[contact.particle_a].position;
-        Vec2& pos_b = m_particles[contact.particle_b].position;
-        Vec2& vel_a = m_particles[contact.particle_a].velocity;
-        Vec2& vel_b = m_particles[contact.particle_b].velocity;
-        
-        // Check if particles are moving slowly relative to each other
-        Vec2 rel_vel = vel_b - vel_a;
-        float rel_vel_mag = rel_vel.length();
-        
-        if (rel_vel_mag < m_contactSleepVelocity)
-        {
-            contact.sleep_counter++;
-        }
-        else
-        {
-            contact.sleep_counter = 0;
-        }
-        
-        // Put contact to sleep if it's been stable long enough
-        if (contact.sleep_counter > m_contactSleepThreshold)
+        for (int c = begin; c < end; ++c)
         {
-            contact.is_active = false;
+            ContactInfo& contact = m_contactList[c];
+            if (!contact.is_active) continue;
+            
+            const Vec2& vel_a = m_particles[contact.particle_a].velocity;
+            const Vec2& vel_b = m_particles[contact.particle_b].velocity;
+            
+            // Check if particles are moving slowly relative to each other
+            Vec2 rel_vel = vel_b - vel_a;
+            float rel_vel_mag = rel_vel.length();
+            
+            if (rel_vel_mag < m_contactSleepVelocity)
+            {
+                contact.sleep_counter++;
+            }
+            else
+            {
+                contact.sleep_counter = 0;
+            }
+            
+            // Put contact to sleep if it's been stable long enough
+            if (contact.sleep_counter > m_contactSleepThreshold)
+            {
+                contact.is_active = false;
+            }
         }
-    }
+    });
 }
 
 void SPHFluidSimulationScene::applyPositionConstraints()
@@ -1639,48 +1747,52 @@ void SPHFluidSimulationScene::applyPositionConstraints()
     const float particleDiameter = m_particleRadius * 2.0f;
     const float targetDistance = particleDiameter * 0.95f;
     
-    // Apply position-based constraints (LiquidFun style)
+    // Apply position-based constraints (LiquidFun style), block color by block color
     for (int iteration = 0; iteration < 3; ++iteration)
     {
-        for (auto& contact : m_contactList)
+        m_pairBlocks.forEachBlock([&](int block, const int*, int)
         {
-            if (!contact.is_active) continue;
-            
-            int i = contact.particle_a;
-            int j = contact.particle_b;
-            
-            Vec2& pos_a = m_particles[i].position;
-            Vec2& pos_b = m_particles[j].position;
-            Vec2& vel_a = m_particles[i].velocity;
-            Vec2& vel_b = m_particles[j].velocity;
-            
-            Vec2 dp = pos_b - pos_a;
-            float dist = dp.length();
-            
-            if (dist < targetDistance && dist > 1e-6f)
+            for (int c = m_contactBlockStart[block]; c < m_contactBlockStart[block + 1]; ++c)
             {
-                Vec2 normal = dp * (1.0f / dist);
-                float overlap = targetDistance - dist;
+                const ContactInfo& contact = m_contactList[c];
+                if (!contact.is_active) continue;
                 
-                // Position correction (LiquidFun style)
-                float correction = overlap * m_positionConstraintStrength;
-                Vec2 correction_vec = normal * correction;
+                int i = contact.particle_a;
+                int j = contact.particle_b;
                 
-                pos_a -= correction_vec * 0.5f;
-                pos_b += correction_vec * 0.5f;
+                Vec2& pos_a = m_particles[i].position;
+                Vec2& pos_b = m_particles[j].position;
+                Vec2& vel_a = m_particles[i].velocity;
+                Vec2& vel_b = m_particles[j].velocity;
                 
-                // Velocity damping for stability
-                Vec2 rel_vel = vel_b - vel_a;
-                float rel_vel_n = rel_vel.x * normal.x + rel_vel.y * normal.y;
+                Vec2 dp = pos_b - pos_a;
+                float dist = dp.length();
                 
-                if (rel_vel_n < 0.0f) // Approaching
+                if (dist < targetDistance && dist > 1e-6f)
                 {
-                    Vec2 damp_impulse = normal * (rel_vel_n * m_positionConstraintDamping * 0.5f);
-                    vel_a += damp_impulse;
-                    vel_b -= damp_impulse;
+                    Vec2 normal = dp * (1.0f / dist);
+                    float overlap = targetDistance - dist;
+                    
+                    // Position correction (LiquidFun style)
+                    float correction = overlap * m_positionConstraintStrength;
+                    Vec2 correction_vec = normal * correction;
+                    
+                    pos_a -= correction_vec * 0.5f;
+                    pos_b += correction_vec * 0.5f;
+                    
+                    // Velocity damping for stability
+                    Vec2 rel_vel = vel_b - vel_a;
+                    float rel_vel_n = rel_vel.x * normal.x + rel_vel.y * normal.y;
+                    
+                    if (rel_vel_n < 0.0f) // Approaching
+                    {
+                        Vec2 damp_impulse = normal * (rel_vel_n * m_positionConstraintDamping * 0.5f);
+                        vel_a += damp_impulse;
+                        vel_b -= damp_impulse;
+                    }
                 }
             }
-        }
+        }, std::max(1, m_threadCount));
     }
 }
 
@@ -1689,15 +1801,19 @@ void SPHFluidSimulationScene::applyContactSleeping()
     if (!m_enableContactSleeping) return;
     
     // Skip velocity updates for sleeping contacts
-    for (auto& contact : m_contactList)
+    m_pairBlocks.forEachBlock([&](int block, const int*, int)
     {
-        if (!contact.is_active)
+        for (int c = m_contactBlockStart[block]; c < m_contactBlockStart[block + 1]; ++c)
         {
-            // Apply gentle damping to sleeping particles
-            m_particles[contact.particle_a].velocity *= 0.99f;
-            m_particles[contact.particle_b].velocity *= 0.99f;
+            const ContactInfo& contact = m_contactList[c];
+            if (!contact.is_active)
+            {
+                // Apply gentle damping to sleeping particles
+                m_particles[contact.particle_a].velocity *= 0.99f;
+                m_particles[contact.particle_b].velocity *= 0.99f;
+            }
         }
-    }
+    }, std::max(1, m_threadCount));
 }
 
 void SPHFluidSimulationScene::applyXSPHSmoothing()
@@ -1707,33 +1823,36 @@ void SPHFluidSimulationScene::applyXSPHSmoothing()
     // XSPH velocity smoothing: v_i += c * Σ_j (m_j/ρ_j) * (v_j - v_i) * W_ij
     std::vector<Vec2> smoothed_velocities(m_particles.size());
     
-    for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
+    // The table's pairs were found before integration and the collision passes, so
+    // the distances are re-measured; pairs that drifted out of range drop out
+    parallelFor(0, static_cast<int>(m_particles.size()), 64, [&](int begin, int end)
     {
-        Vec2 smoothing_velocity(0.0f, 0.0f);
-        const auto& neighbors = m_neighbors[i];
-        
-        for (int j : neighbors)
+        for (int i = begin; i < end; ++i)
         {
-            if (i == j) continue;
+            Vec2 smoothing_velocity(0.0f, 0.0f);
             
-            Vec2 r = m_particles[i].position - m_particles[j].position;
-            float dx = r.x; float dy = r.y;
-            float r2 = dx * dx + dy * dy;
-            if (r2 < m_sphParams.smoothing_radius * m_sphParams.smoothing_radius && r2 > 1e-12f)
+            for (int k = m_neighborTable.begin(i); k < m_neighborTable.end(i); ++k)
             {
-                float distance = std::sqrt(r2);
-                // XSPH smoothing term
-                float kernel_value = poly6Kernel(distance, m_sphParams.smoothing_radius);
-                Vec2 velocity_diff = m_particles[j].velocity - m_particles[i].velocity;
-                float mass_density_ratio = m_sphParams.mass / std::max(1e-3f, m_particles[j].density);
-                
-                smoothing_velocity += velocity_diff * (mass_density_ratio * kernel_value);
+                int j = m_neighborTable.getIndex(k);
+                Vec2 r = m_particles[i].position - m_particles[j].position;
+                float dx = r.x; float dy = r.y;
+                float r2 = dx * dx + dy * dy;
+                if (r2 < m_sphParams.smoothing_radius * m_sphParams.smoothing_radius && r2 > 1e-12f)
+                {
+                    float distance = std::sqrt(r2);
+                    // XSPH smoothing term
+                    float kernel_value = poly6Kernel(distance, m_sphParams.smoothing_radius);
+                    Vec2 velocity_diff = m_particles[j].velocity - m_particles[i].velocity;
+                    float mass_density_ratio = m_sphParams.mass / std::max(1e-3f, m_particles[j].density);
+                    
+                    smoothing_velocity += velocity_diff * (mass_density_ratio * kernel_value);
+                }
             }
+            
+            // Apply smoothing with factor
+            smoothed_velocities[i] = m_particles[i].velocity + smoothing_velocity * m_xsphSmoothingFactor;
         }
-        
-        // Apply smoothing with factor
-        smoothed_velocities[i] = m_particles[i].velocity + smoothing_velocity * m_xsphSmoothingFactor;
-    }
+    });
     
     // Update velocities with smoothed values
     for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
@@ -1750,61 +1869,62 @@ void SPHFluidSimulationScene::stabilizeLowSpeedParticles()
     const float targetDistance = particleDiameter * 0.98f; // Slightly tighter for stability
     const float targetDistance2 = targetDistance * targetDistance;
     
-    std::vector<int> neighbors;
-    neighbors.reserve(64);
-    
-    // Multiple iterations for better stability
+    // Multiple iterations for better stability. Each pair (j > i) is corrected once, when
+    // either side is slow, in colored blocks like the collision pass.
     for (int iteration = 0; iteration < m_lowSpeedStabilizationIterations; ++iteration)
     {
-        for (int i = 0; i < static_cast<int>(m_particles.size()); ++i)
+        m_pairBlocks.forEachBlock([&](int, const int* block, int blockSize)
         {
-            float speed = m_particles[i].velocity.length();
-            
-            // Only stabilize slow particles
-            if (speed > m_lowSpeedThreshold) continue;
-            
-            m_spatialGrid.findNeighbors(i, m_particles[i].position.x, m_particles[i].position.y, m_sphParams.smoothing_radius, neighbors);
-            
-            for (int j : neighbors)
+            for (int n = 0; n < blockSize; ++n)
             {
-                if (i == j) continue;
-                
-                Vec2 dp = m_particles[j].position - m_particles[i].position;
-                float dist2 = dp.x * dp.x + dp.y * dp.y;
+                const int i = block[n];
+                float speed = m_particles[i].velocity.length();
                 
-                if (dist2 < targetDistance2 && dist2 > 1e-6f)
+                for (int k = m_neighborTable.begin(i); k < m_neighborTable.end(i); ++k)
                 {
-                    float dist = std::sqrt(dist2);
-                    Vec2 normal = dp * (1.0f / dist);
-                    float overlap = targetDistance - dist;
+                    const int j = m_neighborTable.getIndex(k);
+                    if (j <= i) continue;
+                    
+                    // Only stabilize slow particles
+                    if (speed > m_lowSpeedThreshold && m_particles[j].velocity.length() > m_lowSpeedThreshold) continue;
                     
-                    if (overlap > 0.0f)
+                    Vec2 dp = m_particles[j].position - m_particles[i].position;
+                    float dist2 = dp.x * dp.x + dp.y * dp.y;
+                    
+                    if (dist2 < targetDistance2 && dist2 > 1e-6f)
                     {
-                        // Gentle position correction
-                        float correction = overlap * 0.2f; // Very gentle
-                        m_particles[i].position -= normal * correction;
-                        m_particles[j].position += normal * correction;
-                        
-                        // Strong velocity damping for low-speed particles
-                        Vec2 relVel = m_particles[j].velocity - m_particles[i].velocity;
-                        float relVelN = relVel.x * normal.x + relVel.y * normal.y;
+                        float dist = std::sqrt(dist2);
+                        Vec2 normal = dp * (1.0f / dist);
+                        float overlap = targetDistance - dist;
                         
-                        if (std::fabs(relVelN) > 1.0f) // Only damp significant relative motion
+                        if (overlap > 0.0f)
                         {
-                            Vec2 damp = normal * (relVelN * m_lowSpeedDamping);
-                            m_particles[i].velocity += damp;
-                            m_particles[j].velocity -= damp;
+                            // Gentle position correction
+                            float correction = overlap * 0.2f; // Very gentle
+                            m_particles[i].position -= normal * correction;
+                            m_particles[j].position += normal * correction;
+                            
+                            // Strong velocity damping for low-speed particles
+                            Vec2 relVel = m_particles[j].velocity - m_particles[i].velocity;
+                            float relVelN = relVel.x * normal.x + relVel.y * normal.y;
+                            
+                            if (std::fabs(relVelN) > 1.0f) // Only damp significant relative motion
+                            {
+                                Vec2 damp = normal * (relVelN * m_lowSpeedDamping);
+                                m_particles[i].velocity += damp;
+                                m_particles[j].velocity -= damp;
+                            }
                         }
                     }
                 }
+                
+                // Additional damping for very slow particles
+                if (speed < m_lowSpeedThreshold * 0.5f)
+                {
+                    m_particles[i].velocity *= m_lowSpeedDamping;
+                }
             }
-            
-            // Additional damping for very slow particles
-            if (speed < m_lowSpeedThreshold * 0.5f)
-            {
-                m_particles[i].velocity *= m_lowSpeedDamping;
-            }
-        }
+        }, std::max(1, m_threadCount));
     }
 }
 
@@ -1836,9 +1956,9 @@ void SPHFluidSimulationScene::enforceBallOnParticles()
     Vec2 c = rb->getPosition();
     float r = rb->getRadius();
 
-    for (auto& p : m_particles)
+    forEachParticle([&](Vec2& position, Vec2& velocity)
     {
-        Vec2 d = p.position - c;
+        Vec2 d = position - c;
         float dist2 = d.x*d.x + d.y*d.y;
         float minDist = r + m_particleRadius * 0.9f;
         if (dist2 < minDist*minDist)
@@ -1847,12 +1967,12 @@ void SPHFluidSimulationScene::enforceBallOnParticles()
             Vec2 n = (dist > 1e-6f) ? d * (1.0f/dist) : Vec2(1.0f, 0.0f);
             float penetration = minDist - dist;
             // push particle out
-            p.position += n * penetration;
+            position += n * penetration;
             // reflect/bounce velocity along normal
-            float vn = p.velocity.dot(n);
-            if (vn < 0.0f) p.velocity -= n * (1.0f + m_collisionRestitution) * vn;
+            float vn = velocity.dot(n);
+            if (vn < 0.0f) velocity -= n * (1.0f + m_collisionRestitution) * vn;
         }
-    }
+    });
 }
 
 float SPHFluidSimulationScene::calculateFluidDensityAt(const Vec2& worldPos)
@@ -1860,9 +1980,9 @@ float SPHFluidSimulationScene::calculateFluidDensityAt(const Vec2& worldPos)
     float density = 0.0f;
     float influenceRadius = m_particleRadius * 3.0f; // larger influence radius for smoother density
     
-    for (const auto& p : m_particles)
+    forEachParticle([&](Vec2& position, Vec2&)
     {
-        Vec2 toParticle = worldPos - p.position;
+        Vec2 toParticle = worldPos - position;
         float dist = toParticle.length();
         
         if (dist < influenceRadius)
@@ -1872,7 +1992,7 @@ float SPHFluidSimulationScene::calculateFluidDensityAt(const Vec2& worldPos)
             float influence = 1.0f - (3.0f * t * t - 2.0f * t * t * t); // Smooth step
             density += influence;
         }
-    }
+    });
     
     return density;
 }
@@ -1939,16 +2059,15 @@ void SPHFluidSimulationScene::updateMetaballData()
         m_metaballPositions.push_back(p.position);
         m_metaballRadii.push_back(m_metaballRadius);
         
-        // Get color from particle's sprite
-        Vec4 color(0.2f, 0.6f, 1.0f, 1.0f); // default blue
-        if (auto* e = m_entityManager->findEntity(p.entityName))
-        {
-            if (auto* s = e->getComponent<SpriteComponent>())
-            {
-                color = s->getTint();
-            }
-        }
-        m_metaballColors.push_back(color);
+        m_metaballColors.push_back(p.color);
+    }
+    const auto& soa = m_optimizedParticles;
+    for (size_t i = 0; i < soa.count; ++i)
+    {
+        m_metaballPositions.push_back(Vec2(soa.positions_x[i], soa.positions_y[i]));
+        m_metaballRadii.push_back(m_metaballRadius);
+        const ParticleColor color = unpackParticleColor(soa.colors[i]);
+        m_metaballColors.push_back(Vec4(color.r, color.g, color.b, color.a));
     }
 }
 
@@ -1988,48 +2107,17 @@ void SPHFluidSimulationScene::renderMetaballField(GraphicsEngine& engine, Device
     // Enable additive blending for field accumulation
     ctx.enableAlphaBlending();
     
-    // Load metaball falloff texture if not already loaded
-    static std::shared_ptr<Texture2D> metaballTexture = nullptr;
-    if (!metaballTexture)
-    {
-        metaballTexture = Texture2D::LoadTexture2D(engine.getGraphicsDevice().getD3DDevice(), L"DX3D/Assets/Textures/MetaballFalloff.png");
-    }
-    
-    // Render each particle using the MetaballFalloff.png texture with velocity colors
+    // One MetaballFalloff.png quad per particle with its velocity color, in a single batch
+    const float size = m_metaballRadius * 2.0f;
+    // Only the active layout holds particles
+    const auto& soa = m_optimizedParticles;
+    for (size_t i = 0; i < soa.count; ++i)
+        m_particleBatch.add(m_metaballMaterial, soa.positions_x[i], soa.positions_y[i], size, soa.colors[i]);
     for (const auto& p : m_particles)
-    {
-        if (auto* e = m_entityManager->findEntity(p.entityName))
-        {
-            if (auto* s = e->getComponent<SpriteComponent>())
-            {
-                // Store original scale, color, and texture
-                Vec3 originalScale = s->getScale();
-                Vec4 originalColor = s->getTint();
-                auto originalTexture = s->getTexture();
-                
-                // Set metaball texture and scale up for metaball effect
-                if (metaballTexture)
-                {
-                    s->setTexture(metaballTexture);
-                }
-                float scale = m_metaballRadius / m_particleRadius;
-                s->setScale(scale, scale, 1.0f);
-                
-                // Use the particle's velocity-based color for metaball rendering
-                s->setTint(originalColor);
-                
-                if (s->isVisible() && s->isValid())
-                {
-                    s->draw(ctx);
-                }
-                
-                // Restore original scale, color, and texture
-                s->setScale(originalScale.x, originalScale.y, originalScale.z);
-                s->setTint(originalColor);
-                s->setTexture(originalTexture);
-            }
-        }
-    }
+        m_particleBatch.add(m_metaballMaterial, p.position.x, p.position.y, size,
+            packParticleColor(p.color.x, p.color.y, p.color.z, p.color.w));
+    if (m_particleBatchDevice) m_particleBatchDevice->draw(engine, ctx, m_particleBatch);
+    m_particleBatch.clear();
 }
 
 float SPHFluidSimulationScene::calculateMetaballField(const Vec2& worldPos)
@@ -5,13 +5,19 @@
 #include <DX3D/Graphics/SpriteComponent.h>
 #include <DX3D/Core/EntityManager.h>
 #include <DX3D/Core/Input.h>
+#include <DX3D/Core/AllocationCounter.h>
+#include <DX3D/Core/JobSystem.h>
 #include <DX3D/Graphics/LineRenderer.h>
+#include <DX3D/Graphics/ParticleBatchDevice.h>
+#include <DX3D/Game/Scenes/SPHKernels.h>
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
+#include <DX3D/Game/Scenes/SPHPairBlocks.h>
+#include <DX3D/Game/Scenes/SPHPositionSolver.h>
 #include <DX3D/Math/Geometry.h>
 #include <DX3D/Components/FirmGuyComponent.h>
 #include <vector>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <algorithm>
 
 namespace dx3d
@@ -27,6 +33,7 @@ namespace dx3d
         void fixedUpdate(float dt) override;
         void render(GraphicsEngine& engine, SwapChain& swapChain) override;
         void renderImGui(GraphicsEngine& engine) override;
+        void onFrameEnd() override;
 
     private:
         struct SPHParticle
@@ -36,7 +43,7 @@ namespace dx3d
             Vec2 acceleration;
             float density;
             float pressure;
-            std::string entityName;
+            Vec4 color;      // speed / density tint, drawn through m_particleBatch
         };
 
         // SPH parameters
@@ -53,7 +60,7 @@ namespace dx3d
             float artificial_viscosity = 0.2f; // Artificial viscosity for stability (increased)
         };
 
-        // Spatial partitioning for neighbor finding
+        // Spatial partitioning for neighbor finding: flat counting-sort cells, updated on each table rebuild
         struct SpatialGrid
         {
             int grid_width;
@@ -62,13 +69,16 @@ namespace dx3d
             Vec2 world_min;
             Vec2 world_max;
             
-            std::vector<std::vector<int>> cells;
-            std::vector<int> temp_neighbors;
+            FlipParticleGrid cells;
             
             void initialize(float world_width, float world_height, float world_min_x, float world_min_y, float smoothing_radius, float cell_scale = 1.0f);
-            void clear();
-            void addParticle(int particle_id, float x, float y);
-            void findNeighbors(int particle_id, float x, float y, float radius, std::vector<int>& neighbors);
+            template<typename Particles>
+            void build(const Particles& particles, int maxThreads) { cells.build(particles, maxThreads); }
+            void build(const float* x, const float* y, int count, int maxThreads) { cells.build(x, y, count, maxThreads); }
+            // Moves only the particles that changed cell since the last build or update
+            template<typename Particles>
+            void update(const Particles& particles, int maxThreads) { cells.update(particles, maxThreads); }
+            void update(const float* x, const float* y, int count, int maxThreads) { cells.update(x, y, count, maxThreads); }
         };
 
         // SPH kernels (smoothing functions)
@@ -76,27 +86,52 @@ namespace dx3d
         Vec2 poly6KernelGradient(const Vec2& r, float smoothing_radius);
         float spikyKernel(float distance, float smoothing_radius);
         Vec2 spikyKernelGradient(const Vec2& r, float smoothing_radius);
+        // Same with |r| already known (0 < distance < smoothing_radius)
+        Vec2 spikyKernelGradient(const Vec2& r, float distance, float smoothing_radius);
         float viscosityKernel(float distance, float smoothing_radius);
         void updateKernelConstants();
 
         // SPH simulation steps
         void stepSPH(float dt);
         void updateSpatialGrid();
+        void reorderParticles();
         void buildNeighborLists();
         void calculateDensity();
         void calculatePressure();
         void calculateForces();
+        void calculatePairForces(); // m_pairMode PerThread / Colored
+        // Force on i and on j from the pair (i, j) at the given distance, evaluated once
+        void pairForces(int i, int j, float distance, Vec2& onI, Vec2& onJ);
         void integrateParticles(float dt);
         void enforceBoundaries();
-        void updateParticleSprites();
+        void updateParticleColors();
+        Vec4 particleColor(float speed, float density) const;
         
-        // Collision detection (LiquidFun style)
-        void buildCollisionHash();
+        // Collision detection (LiquidFun style): table pairs, colored blocks in parallel
         void resolveParticleCollisions();
-        long long collisionHashKey(int ix, int iy) const;
+        // Position and velocity access to either layout for the passes both share
+        struct AosAccess
+        {
+            std::vector<SPHParticle>& particles;
+            Vec2 position(int i) const { return particles[i].position; }
+            Vec2 velocity(int i) const { return particles[i].velocity; }
+            void setPosition(int i, const Vec2& p) { particles[i].position = p; }
+            void setVelocity(int i, const Vec2& v) { particles[i].velocity = v; }
+            bool awake(int) const { return true; }
+        };
+        template<typename Particles>
+        void resolveCollisionsBlocked(Particles particles);
         
-        // LiquidFun-style optimized methods
+        // LiquidFun-style optimized methods: the SoA layout is the particle storage while
+        // enabled, and density, pressure and forces run on m_kernels over the neighbor table
+        void setOptimizedLayout(bool enabled);
         void stepSPHOptimized(float dt);
+        // Neighbor table for the SoA positions: re-measured while the skin covers the motion,
+        // else grid update, Z-order reorder if reorderDue, table and block rebuild
+        void updateNeighborsOptimized(int count, int threads, bool reorderDue);
+        // m_solverMode PositionBased: m_positionSolver in place of the gas law and collision passes
+        void stepPositionBased(float dt);
+        void reorderOptimizedParticles();
         void calculateDensityOptimized();
         void calculatePressureOptimized();
         void calculateForcesOptimized();
@@ -135,13 +170,17 @@ namespace dx3d
         void resolveBallParticleCollisions();
 
         // ECS
-        std::unique_ptr<EntityManager> m_entityManager;
+        EntityHandle m_cameraEntity;
+        // Heap allocations in the last frame (all threads) and in the color sync alone
+        AllocationScope m_frameAllocScope;
+        std::uint64_t m_frameAllocations = 0;
+        std::uint64_t m_colorSyncAllocations = 0;
         GraphicsDevice* m_graphicsDevice = nullptr;
         LineRenderer* m_lineRenderer = nullptr;
         
         // Physics ball (matching FLIP scene)
         Entity* m_physicsBall = nullptr;
-        std::string m_ballEntityName = "SPHBall";
+        NameId m_ballEntityName = NameTable::intern("SPHBall");
         bool m_ballEnabled = false;
         float m_ballRadius = 18.0f;
         float m_ballMass = 3.0f;
@@ -164,7 +203,33 @@ namespace dx3d
         SpatialGrid m_spatialGrid;
         float m_gridCellScale = 1.0f;
         float m_prevGridCellScale = -1.0f;
-        std::vector<std::vector<int>> m_neighbors; // per-frame neighbor cache
+        SPHNeighborTable m_neighborTable; // pairs within the smoothing radius, built or re-measured once per step
+        SPHPairBlocks m_pairBlocks;       // blocks over the same grid for the passes that write both sides of a pair
+        // Verlet skin: the table keeps pairs within smoothing radius + skin and is only
+        // re-measured, not rebuilt, until some particle has moved more than skin / 2
+        float m_neighborSkin = 0.0f;
+        int m_neighborRebuilds = 0;
+        int m_neighborRefreshes = 0;
+        float m_prevNeighborSkin = -1.0f;
+        // Legacy force pass: per particle gather, or each pair once through per-thread sums or colored blocks
+        SPHPairMode m_pairMode = SPHPairMode::Colored;
+        SPHThreadAccumulators m_threadForces;
+        std::vector<float> m_pairForceX;
+        std::vector<float> m_pairForceY;
+        // Particles are put in Z-order of their grid cells every m_reorderInterval steps (0 = never)
+        int m_reorderInterval = 16;
+        int m_stepsSinceReorder = 0;
+        std::vector<SPHParticle> m_sortedParticles;
+        std::vector<int> m_reorderOrder;
+        std::vector<std::uint64_t> m_reorderCellKeys;
+
+        // Multithreading: loops run on the engine JobSystem's persistent workers
+        int m_threadCount = 1; // threads used per loop; set to all job system threads on load
+        template<typename F>
+        void parallelFor(int start, int end, int grain, F&& fn)
+        {
+            JobSystem::getInstance().parallelFor(start, end, grain, std::forward<F>(fn), std::max(1, m_threadCount));
+        }
         bool m_neighborsValid = false;
         // Precomputed kernel constants
         float m_prevSmoothingRadius = -1.0f;
@@ -174,9 +239,14 @@ namespace dx3d
         float m_h4 = 0.0f;
         float m_h5 = 0.0f;
         float m_h6 = 0.0f;
-        float m_poly6Coeff = 0.0f;            // 315 / (64π h^9)
-        float m_spikyGradCoeff = 0.0f;        // 45 / (π h^6)
-        float m_viscLaplacianCoeff = 0.0f;    // 45 / (π h^6)
+        SPHKernelConstants m_kernelConstants; // poly6 / spiky gradient / viscosity coefficients at m_h
+        SPHKernels m_kernels;
+        // Incompressibility on the SoA layout: gas law plus collision passes, or density constraints
+        SPHSolverMode m_solverMode = SPHSolverMode::EquationOfState;
+        SPHPositionSolver m_positionSolver;
+        SPHPositionSolverSettings m_positionSettings; // box, spacing and gravity are filled in per step
+        int m_positionStepFrames = 4; // fixed updates per position-based step, which is that many times as long
+        int m_framesSinceStep = 0;
         
         // LiquidFun-style optimized data (SoA layout for better cache efficiency)
         struct OptimizedParticleData
@@ -189,24 +259,65 @@ namespace dx3d
             std::vector<f32> accelerations_y;
             std::vector<f32> densities;
             std::vector<f32> pressures;
+            std::vector<f32> inv_densities; // 1 / max(density, 1e-3), written with the pressures
             std::vector<f32> masses;
             std::vector<f32> radii;
-            std::vector<uint32_t> colors;
-            std::vector<uint16_t> entity_ids; // Maps to m_particles array
-            std::vector<bool> is_awake; // Island-based simulation
+            std::vector<uint32_t> colors; // packParticleColor, drawn as is
+            std::vector<uint8_t> is_awake; // Island-based simulation (bytes, so threads can write neighbors)
             
             size_t count = 0;
             size_t capacity = 0;
             
             void resize(size_t new_capacity);
-            void addParticle(const SPHParticle& p, uint16_t entity_id);
-            void removeParticle(size_t index);
+            void addParticle(const SPHParticle& p);
+            // Layout switches only: copy every particle in from / out to the AoS array
             void syncFromParticles(const std::vector<SPHParticle>& particles);
             void syncToParticles(std::vector<SPHParticle>& particles);
+            // Gather every field through order (order[k] moves to slot k)
+            void reorder(const std::vector<int>& order, int maxThreads);
+
+            std::vector<f32> reorderScratch;
+            std::vector<uint32_t> reorderScratchColors;
+            std::vector<uint8_t> reorderScratchAwake;
+        };
+        struct SoaAccess
+        {
+            OptimizedParticleData& particles;
+            Vec2 position(int i) const { return Vec2(particles.positions_x[i], particles.positions_y[i]); }
+            Vec2 velocity(int i) const { return Vec2(particles.velocities_x[i], particles.velocities_y[i]); }
+            void setPosition(int i, const Vec2& p) { particles.positions_x[i] = p.x; particles.positions_y[i] = p.y; }
+            void setVelocity(int i, const Vec2& v) { particles.velocities_x[i] = v.x; particles.velocities_y[i] = v.y; }
+            bool awake(int i) const { return particles.is_awake[i] != 0; }
         };
         
         OptimizedParticleData m_optimizedParticles;
-        bool m_useOptimizedLayout = false;
+        bool m_useOptimizedLayout = true; // m_particles is empty while set
+        SPHFluidFields optimizedFields();
+        int getParticleCount() const
+        {
+            return m_useOptimizedLayout ? static_cast<int>(m_optimizedParticles.count) : static_cast<int>(m_particles.size());
+        }
+        // fn(Vec2& position, Vec2& velocity) for every particle of the active layout
+        template<typename F>
+        void forEachParticle(F&& fn)
+        {
+            if (!m_useOptimizedLayout)
+            {
+                for (auto& p : m_particles) fn(p.position, p.velocity);
+                return;
+            }
+            auto& soa = m_optimizedParticles;
+            for (size_t i = 0; i < soa.count; ++i)
+            {
+                Vec2 position(soa.positions_x[i], soa.positions_y[i]);
+                Vec2 velocity(soa.velocities_x[i], soa.velocities_y[i]);
+                fn(position, velocity);
+                soa.positions_x[i] = position.x;
+                soa.positions_y[i] = position.y;
+                soa.velocities_x[i] = velocity.x;
+                soa.velocities_y[i] = velocity.y;
+            }
+        }
 
         // Simulation parameters
         float m_particleRadius = 4.0f;
@@ -247,8 +358,6 @@ namespace dx3d
         int m_collisionIterations = 2;
         float m_collisionRestitution = 0.3f;
         float m_collisionFriction = 0.1f;
-        std::unordered_map<long long, std::vector<int>> m_collisionHash;
-        float m_collisionHashCellSize = 16.0f;
         int m_maxCollisionNeighbors = 16;
         
         // LiquidFun-style contact sleeping and position constraints
@@ -260,7 +369,8 @@ namespace dx3d
             int sleep_counter;
             bool is_active;
         };
-        std::vector<ContactInfo> m_contactList;
+        std::vector<ContactInfo> m_contactList;      // grouped by the pair block of particle_a
+        std::vector<int> m_contactBlockStart;        // blocks + 1 offsets into m_contactList
         bool m_enableContactSleeping = true;
         int m_contactSleepThreshold = 30;
         float m_contactSleepVelocity = 0.1f;
@@ -331,10 +441,16 @@ namespace dx3d
         std::vector<Vec2> m_metaballPositions;
         std::vector<Vec4> m_metaballColors;
         std::vector<float> m_metaballRadii;
-        std::shared_ptr<Texture2D> m_nodeTexture; // sprite texture for Sprites mode
+
+        // Particles are quads in one batch rather than one sprite entity each:
+        // node.png in Sprites mode, MetaballFalloff.png in Metaballs mode
+        ParticleBatchRenderer m_particleBatch;
+        std::unique_ptr<ParticleBatchDevice> m_particleBatchDevice;
+        ui32 m_nodeMaterial = 0;
+        ui32 m_metaballMaterial = 0;
 
         // Helper functions
-        std::string boundaryName(int i) const;
+        NameId boundaryName(int i) const;
         float clampf(float v, float a, float b) const { return v < a ? a : (v > b ? b : v); }
         
         // Boundary collision detection
@@ -0,0 +1,321 @@
+#include <DX3D/Game/Scenes/SPHKernels.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define DX3D_SPH_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DX3D_SPH_SSE2 1
+#endif
+#if defined(DX3D_SPH_SSE2) || defined(DX3D_SPH_AVX2)
+#include <immintrin.h>
+#endif
+
+using namespace dx3d;
+
+namespace
+{
+    const float Pi = 3.14159f; // as the scene's kernels
+    const float MinDistance = 1e-6f;
+
+    // Pressure and viscosity sums of one particle's pairs, before the mass and density factors
+    struct PairSums
+    {
+        float pressureX = 0.0f;
+        float pressureY = 0.0f;
+        float viscosityX = 0.0f;
+        float viscosityY = 0.0f;
+    };
+
+    // Per-particle values every pair of particle i uses
+    struct Center
+    {
+        float x, y, vx, vy;
+        float halfPressure;       // pressure[i] / 2
+        float artificialPressure; // artificialPressure * ((density[i] / restDensity)^4 - 1)
+    };
+
+    // ========================= Scalar reference =========================
+
+    float densityPair(const SPHKernelConstants& k, float r2)
+    {
+        const float t = (k.h2 - r2) * k.invH2;
+        return t * t * t;
+    }
+
+    void forcePair(const SPHKernelConstants& k, const SPHFluidFields& f, const Center& c, int j, float distance, PairSums& sums)
+    {
+        if (distance <= MinDistance) return;
+        const float rx = c.x - f.x[j];
+        const float ry = c.y - f.y[j];
+        const float invDensity = f.invDensity[j];
+
+        // -spikyGradient(r) * (pressure term + artificial pressure)
+        const float t = 1.0f - distance * k.invH;
+        const float gradient = k.spikyGradient * t * t / distance;
+        const float pressure = gradient * (f.pressure[j] * 0.5f * invDensity + c.halfPressure * invDensity + c.artificialPressure);
+        sums.pressureX += rx * pressure;
+        sums.pressureY += ry * pressure;
+
+        const float q = std::max(distance * k.invH, 1e-6f);
+        const float viscosity = k.viscosity * (-0.5f * q * q * q + q * q + 0.5f / q - 1.0f) * invDensity;
+        sums.viscosityX += (f.vx[j] - c.vx) * viscosity;
+        sums.viscosityY += (f.vy[j] - c.vy) * viscosity;
+    }
+
+    // ========================= Lane types =========================
+
+#if defined(DX3D_SPH_SSE2)
+    struct SseLanes
+    {
+        using F = __m128;
+        static constexpr int Width = 4;
+
+        static F load(const float* p) { return _mm_loadu_ps(p); }
+        static F set(float v) { return _mm_set1_ps(v); }
+        static F zero() { return _mm_setzero_ps(); }
+        static F add(F a, F b) { return _mm_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+        static F div(F a, F b) { return _mm_div_ps(a, b); }
+        static F max(F a, F b) { return _mm_max_ps(a, b); }
+        static F greater(F a, F b) { return _mm_cmpgt_ps(a, b); }
+        static F both(F a, F b) { return _mm_and_ps(a, b); }
+        // SSE2 has no gather: four scalar loads
+        static F gather(const float* base, const int* index)
+        {
+            return _mm_setr_ps(base[index[0]], base[index[1]], base[index[2]], base[index[3]]);
+        }
+        static float sum(F a)
+        {
+            const F pairs = _mm_add_ps(a, _mm_movehl_ps(a, a));
+            return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+        }
+    };
+#endif
+
+#if defined(DX3D_SPH_AVX2)
+    struct AvxLanes
+    {
+        using F = __m256;
+        static constexpr int Width = 8;
+
+        static F load(const float* p) { return _mm256_loadu_ps(p); }
+        static F set(float v) { return _mm256_set1_ps(v); }
+        static F zero() { return _mm256_setzero_ps(); }
+        static F add(F a, F b) { return _mm256_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+        static F div(F a, F b) { return _mm256_div_ps(a, b); }
+        static F max(F a, F b) { return _mm256_max_ps(a, b); }
+        static F greater(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static F both(F a, F b) { return _mm256_and_ps(a, b); }
+        static F gather(const float* base, const int* index)
+        {
+            return _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index)), 4);
+        }
+        static float sum(F a)
+        {
+            return SseLanes::sum(_mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1)));
+        }
+    };
+#endif
+
+    // Run fn with the lane type for simd; returns k unchanged when only the scalar path is available
+    template<typename Fn>
+    int dispatchLanes(SPHSimd simd, int k, Fn&& fn)
+    {
+#if defined(DX3D_SPH_AVX2)
+        if (simd == SPHSimd::Avx2) return fn(AvxLanes{});
+#endif
+#if defined(DX3D_SPH_SSE2)
+        if (simd != SPHSimd::Scalar) return fn(SseLanes{});
+#endif
+        (void)simd;
+        return k;
+    }
+
+    // ========================= Vectorized pairs =========================
+    // Each processes whole vectors of particle i's pairs starting at k while they
+    // end before end, adds them to the sums, and returns where the scalar tail starts
+
+    template<typename L>
+    int densityLanes(const SPHKernelConstants& k, const float* r2, int pair, int end, float& sum)
+    {
+        using F = typename L::F;
+        const F h2 = L::set(k.h2);
+        const F invH2 = L::set(k.invH2);
+        F acc = L::zero();
+        for (; pair + L::Width <= end; pair += L::Width)
+        {
+            const F t = L::mul(L::sub(h2, L::load(r2 + pair)), invH2);
+            acc = L::add(acc, L::mul(L::mul(t, t), t));
+        }
+        sum += L::sum(acc);
+        return pair;
+    }
+
+    template<typename L>
+    int forceLanes(const SPHKernelConstants& k, const SPHFluidFields& f, const Center& c,
+        const int* index, const float* distance, int pair, int end, PairSums& sums)
+    {
+        using F = typename L::F;
+        const F x = L::set(c.x);
+        const F y = L::set(c.y);
+        const F vx = L::set(c.vx);
+        const F vy = L::set(c.vy);
+        const F halfPressure = L::set(c.halfPressure);
+        const F artificialPressure = L::set(c.artificialPressure);
+        const F invH = L::set(k.invH);
+        const F spikyGradient = L::set(k.spikyGradient);
+        const F viscosityCoeff = L::set(k.viscosity);
+        const F one = L::set(1.0f);
+        const F half = L::set(0.5f);
+        const F minDistance = L::set(MinDistance);
+        const F minQ = L::set(1e-6f);
+
+        F pressureX = L::zero(), pressureY = L::zero();
+        F viscosityX = L::zero(), viscosityY = L::zero();
+        for (; pair + L::Width <= end; pair += L::Width)
+        {
+            const int* j = index + pair;
+            const F d = L::load(distance + pair);
+            const F valid = L::greater(d, minDistance);
+            const F rx = L::sub(x, L::gather(f.x, j));
+            const F ry = L::sub(y, L::gather(f.y, j));
+            const F invDensity = L::gather(f.invDensity, j);
+
+            const F t = L::sub(one, L::mul(d, invH));
+            const F gradient = L::div(L::mul(L::mul(spikyGradient, t), t), d);
+            const F term = L::add(L::add(L::mul(L::mul(L::gather(f.pressure, j), half), invDensity),
+                L::mul(halfPressure, invDensity)), artificialPressure);
+            const F pressure = L::both(valid, L::mul(gradient, term));
+            pressureX = L::add(pressureX, L::both(valid, L::mul(rx, pressure)));
+            pressureY = L::add(pressureY, L::both(valid, L::mul(ry, pressure)));
+
+            const F q = L::max(L::mul(d, invH), minQ);
+            const F q2 = L::mul(q, q);
+            const F shape = L::sub(L::add(L::sub(q2, L::mul(half, L::mul(q2, q))), L::div(half, q)), one);
+            const F viscosity = L::both(valid, L::mul(L::mul(viscosityCoeff, shape), invDensity));
+            viscosityX = L::add(viscosityX, L::mul(L::sub(L::gather(f.vx, j), vx), viscosity));
+            viscosityY = L::add(viscosityY, L::mul(L::sub(L::gather(f.vy, j), vy), viscosity));
+        }
+        sums.pressureX += L::sum(pressureX);
+        sums.pressureY += L::sum(pressureY);
+        sums.viscosityX += L::sum(viscosityX);
+        sums.viscosityY += L::sum(viscosityY);
+        return pair;
+    }
+}
+
+SPHSimd dx3d::getSPHSimdSupport()
+{
+#if defined(DX3D_SPH_AVX2)
+    return SPHSimd::Avx2;
+#elif defined(DX3D_SPH_SSE2)
+    return SPHSimd::Sse2;
+#else
+    return SPHSimd::Scalar;
+#endif
+}
+
+const char* dx3d::getSPHSimdName(SPHSimd simd)
+{
+    switch (simd)
+    {
+    case SPHSimd::Sse2: return "SSE2";
+    case SPHSimd::Avx2: return "AVX2";
+    default: return "Scalar";
+    }
+}
+
+SPHKernelConstants SPHKernelConstants::forRadius(float h)
+{
+    SPHKernelConstants k;
+    k.h = h;
+    k.h2 = h * h;
+    k.invH = 1.0f / h;
+    k.invH2 = 1.0f / k.h2;
+    const float h3 = k.h2 * h;
+    const float h6 = h3 * h3;
+    k.poly6 = 315.0f / (64.0f * Pi * h6 * h3);
+    k.spikyGradient = 45.0f / (Pi * h6);
+    k.viscosity = 15.0f / (2.0f * Pi * h6);
+    return k;
+}
+
+void SPHKernels::setConstants(const SPHKernelConstants& kernel, const SPHFluidConstants& fluid)
+{
+    m_kernel = kernel;
+    m_fluid = fluid;
+}
+
+void SPHKernels::setSimd(SPHSimd simd)
+{
+    m_simd = std::min(simd, getSPHSimdSupport());
+}
+
+void SPHKernels::density(const SPHNeighborTable& table, SPHFluidFields& fields, int begin, int end) const
+{
+    const float* r2 = table.getR2Data();
+    const float scale = m_fluid.mass * m_kernel.poly6;
+    for (int i = begin; i < end; ++i)
+    {
+        if (fields.awake && !fields.awake[i]) continue;
+        float sum = 0.0f;
+        int pair = dispatchLanes(m_simd, table.begin(i), [&](auto lanes)
+        {
+            return densityLanes<decltype(lanes)>(m_kernel, r2, table.begin(i), table.end(i), sum);
+        });
+        for (; pair < table.end(i); ++pair) sum += densityPair(m_kernel, r2[pair]);
+        fields.density[i] = std::max(scale * sum, m_fluid.minDensity);
+    }
+}
+
+void SPHKernels::pressure(SPHFluidFields& fields, int begin, int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        fields.pressure[i] = m_fluid.gasConstant * (fields.density[i] - m_fluid.restDensity);
+        fields.invDensity[i] = 1.0f / std::max(1e-3f, fields.density[i]);
+    }
+}
+
+void SPHKernels::forces(const SPHNeighborTable& table, SPHFluidFields& fields, int begin, int end) const
+{
+    const int* index = table.getIndexData();
+    const float* distance = table.getDistanceData();
+    for (int i = begin; i < end; ++i)
+    {
+        if (fields.awake && !fields.awake[i]) continue;
+        const float ratio = fields.density[i] / m_fluid.restDensity;
+        Center c;
+        c.x = fields.x[i];
+        c.y = fields.y[i];
+        c.vx = fields.vx[i];
+        c.vy = fields.vy[i];
+        c.halfPressure = fields.pressure[i] * 0.5f;
+        c.artificialPressure = m_fluid.artificialPressure * (ratio * ratio * ratio * ratio - 1.0f);
+
+        PairSums sums;
+        int pair = dispatchLanes(m_simd, table.begin(i), [&](auto lanes)
+        {
+            return forceLanes<decltype(lanes)>(m_kernel, fields, c, index, distance, table.begin(i), table.end(i), sums);
+        });
+        for (; pair < table.end(i); ++pair) forcePair(m_kernel, fields, c, index[pair], distance[pair], sums);
+
+        const float invDensity = fields.invDensity[i];
+        float ax = m_fluid.mass * (sums.pressureX + m_fluid.viscosity * sums.viscosityX) * invDensity;
+        float ay = m_fluid.mass * (sums.pressureY + m_fluid.viscosity * sums.viscosityY) * invDensity + m_fluid.gravity;
+        const float magnitude = std::sqrt(ax * ax + ay * ay);
+        if (magnitude > m_fluid.maxAcceleration)
+        {
+            const float scale = m_fluid.maxAcceleration / magnitude;
+            ax *= scale;
+            ay *= scale;
+        }
+        fields.ax[i] = ax;
+        fields.ay[i] = ay;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
+#include <cstdint>
+
+namespace dx3d
+{
+    // Instruction set used by the SPH pair kernels. Only what the build targets is
+    // available: SSE2 on every x64 build, AVX2 when compiled with /arch:AVX2 (-mavx2).
+    enum class SPHSimd : uint8_t
+    {
+        Scalar = 0,
+        Sse2,
+        Avx2
+    };
+
+    // Widest instruction set this build was compiled for
+    SPHSimd getSPHSimdSupport();
+    const char* getSPHSimdName(SPHSimd simd);
+
+    // The scene's kernels for one smoothing radius h, in terms of the pair's r² or distance:
+    //   poly6(r)          = poly6 * (1 - r²/h²)³
+    //   spikyGradient(r)  = -spikyGradient * (1 - r/h)² * r / |r|
+    //   viscosity(r)      = viscosity * (-q³/2 + q² + 1/(2q) - 1), q = max(r/h, 1e-6)
+    struct SPHKernelConstants
+    {
+        float h = 0.0f;
+        float h2 = 0.0f;
+        float invH = 0.0f;
+        float invH2 = 0.0f;
+        float poly6 = 0.0f;         // 315 / (64π h^9)
+        float spikyGradient = 0.0f; // 45 / (π h^6)
+        float viscosity = 0.0f;     // 15 / (2π h^6)
+
+        static SPHKernelConstants forRadius(float h);
+    };
+
+    // Fluid parameters the passes apply on top of the kernels
+    struct SPHFluidConstants
+    {
+        float mass = 1.0f;
+        float restDensity = 1000.0f;
+        float minDensity = 100.0f;        // densities are clamped up to this
+        float gasConstant = 50000.0f;
+        float viscosity = 1.0f;           // physical + artificial viscosity
+        float artificialPressure = 0.05f;
+        float gravity = -500.0f;
+        float maxAcceleration = 5000.0f;
+    };
+
+    // SoA particle fields the passes read and write, all indexed like the neighbor table
+    struct SPHFluidFields
+    {
+        const float* x = nullptr;
+        const float* y = nullptr;
+        const float* vx = nullptr;
+        const float* vy = nullptr;
+        float* density = nullptr;
+        float* pressure = nullptr;
+        float* invDensity = nullptr; // 1 / max(density, 1e-3), written with the pressure
+        float* ax = nullptr;
+        float* ay = nullptr;
+        const uint8_t* awake = nullptr; // particles with 0 are skipped; nullptr runs every particle
+    };
+
+    // Density, pressure and force passes of the SoA SPH step over a neighbor table.
+    // Each particle's pairs are contiguous in the table, so the density sum reads
+    // the cached r² four or eight pairs at a time and the force pass gathers the
+    // neighbors' fields into the same lanes; the kernel coefficients are broadcast
+    // once per pass. The scalar path is the reference: the vector paths do the same
+    // operations per pair and differ only in summation order. Passes only write
+    // particles in [begin, end), which lets callers split them across threads.
+    class SPHKernels
+    {
+    public:
+        void setConstants(const SPHKernelConstants& kernel, const SPHFluidConstants& fluid);
+        void setSimd(SPHSimd simd); // Clamped to getSPHSimdSupport()
+        SPHSimd getSimd() const { return m_simd; }
+
+        // density[i] = max(mass * Σ poly6(r_ij), minDensity)
+        void density(const SPHNeighborTable& table, SPHFluidFields& fields, int begin, int end) const;
+
+        // pressure[i] = gasConstant * (density[i] - restDensity), and invDensity[i]
+        void pressure(SPHFluidFields& fields, int begin, int end) const;
+
+        // Pressure (with artificial pressure) and viscosity accelerations plus gravity,
+        // clamped to maxAcceleration. Coincident pairs (r <= 1e-6) are skipped.
+        void forces(const SPHNeighborTable& table, SPHFluidFields& fields, int begin, int end) const;
+
+    private:
+        SPHKernelConstants m_kernel;
+        SPHFluidConstants m_fluid;
+        SPHSimd m_simd = getSPHSimdSupport();
+    };
+}
@@ -0,0 +1,110 @@
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
+
+using namespace dx3d;
+
+void SPHNeighborTable::clear()
+{
+    m_offsets.assign(1, 0);
+    m_indices.clear();
+    m_r2.clear();
+    m_distance.clear();
+    m_skinOffsets.assign(1, 0);
+    m_skinIndices.clear();
+    m_skinR2.clear();
+    m_builtX.clear();
+    m_builtY.clear();
+    m_builtSkin = 0.0f;
+}
+
+void SPHNeighborTable::build(const float* x, const float* y, int count, const FlipParticleGrid& grid, float radius, int maxThreads)
+{
+    buildFrom(count, [x](int i) { return x[i]; }, [y](int i) { return y[i]; }, grid, radius, maxThreads);
+}
+
+bool SPHNeighborTable::refresh(const float* x, const float* y, int count, float radius, int maxThreads)
+{
+    return refreshFrom(count, [x](int i) { return x[i]; }, [y](int i) { return y[i]; }, radius, maxThreads);
+}
+
+void SPHNeighborTable::packSkinPairs(int count, float radius, int maxThreads)
+{
+    const float radius2 = radius * radius;
+    JobSystem& jobs = JobSystem::getInstance();
+    m_kept.resize(count);
+    jobs.parallelFor(0, count, 1024, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            int kept = 0;
+            for (int k = m_skinOffsets[i]; k < m_skinOffsets[i + 1]; ++k) kept += m_skinR2[k] < radius2;
+            m_kept[i] = kept;
+        }
+    }, maxThreads);
+
+    m_offsets.resize(static_cast<std::size_t>(count) + 1);
+    m_offsets[0] = 0;
+    for (int i = 0; i < count; ++i) m_offsets[i + 1] = m_offsets[i] + m_kept[i];
+
+    const std::size_t pairs = static_cast<std::size_t>(m_offsets[count]);
+    m_indices.resize(pairs);
+    m_r2.resize(pairs);
+    m_distance.resize(pairs);
+    jobs.parallelFor(0, count, 1024, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            int to = m_offsets[i];
+            for (int k = m_skinOffsets[i]; k < m_skinOffsets[i + 1]; ++k)
+            {
+                if (m_skinR2[k] >= radius2) continue;
+                m_indices[to] = m_skinIndices[k];
+                m_r2[to] = m_skinR2[k];
+                m_distance[to] = std::sqrt(m_skinR2[k]);
+                ++to;
+            }
+        }
+    }, maxThreads);
+}
+
+namespace
+{
+    // Spread the 16 bits of v over the even bits of the result
+    std::uint32_t spreadBits(std::uint32_t v)
+    {
+        v = (v | (v << 8)) & 0x00FF00FFu;
+        v = (v | (v << 4)) & 0x0F0F0F0Fu;
+        v = (v | (v << 2)) & 0x33333333u;
+        v = (v | (v << 1)) & 0x55555555u;
+        return v;
+    }
+}
+
+std::uint32_t dx3d::mortonCode(std::uint16_t x, std::uint16_t y)
+{
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+void dx3d::mortonOrder(const FlipParticleGrid& grid, std::vector<int>& order, std::vector<std::uint64_t>& cellKeys)
+{
+    // Sort the cells (not the particles) by code, then emit each cell's particles;
+    // the grid already holds them grouped and ascending
+    const int cellsX = grid.getCellsX();
+    const int cells = cellsX * grid.getCellsY();
+    cellKeys.resize(cells);
+    for (int c = 0; c < cells; ++c)
+    {
+        const auto code = mortonCode(static_cast<std::uint16_t>(c % cellsX), static_cast<std::uint16_t>(c / cellsX));
+        cellKeys[c] = (static_cast<std::uint64_t>(code) << 32) | static_cast<std::uint32_t>(c);
+    }
+    std::sort(cellKeys.begin(), cellKeys.end());
+
+    const std::vector<int>& sorted = grid.getSortedIndices();
+    order.resize(sorted.size());
+    int next = 0;
+    for (std::uint64_t key : cellKeys)
+    {
+        const int c = static_cast<int>(key & 0xFFFFFFFFu);
+        for (int s = grid.getCellStart(c); s < grid.getCellEnd(c); ++s)
+            order[next++] = sorted[s];
+    }
+}
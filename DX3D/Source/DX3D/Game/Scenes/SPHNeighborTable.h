@@ -0,0 +1,299 @@
+#pragma once
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleGrid.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // Flat (CSR) neighbour table: the particles closer than the radius to particle i
+    // are getIndex(k) for k in [begin(i), end(i)), each with its r² and distance
+    // cached, so the density, force and smoothing passes read the pair instead of
+    // re-testing and re-sqrting it.
+    //
+    // Built in one sweep over the grid: positions are gathered in cell order so each
+    // row of candidate cells is one contiguous run, every candidate is written to a
+    // scratch slot sized by the cell counts and kept by advancing the cursor only when
+    // it is in range (no branch), then the kept pairs are packed. The arrays are
+    // reused, so a rebuild allocates nothing once the particle count settles.
+    //
+    // With a Verlet skin, build() searches radius + skin and keeps those pairs as
+    // candidates, with the positions it saw. Until some particle has moved more than
+    // skin / 2 since, no pair can have come within radius unseen, so refresh() just
+    // re-measures the candidates and packs the ones within radius, with no grid.
+    class SPHNeighborTable
+    {
+    public:
+        // particles[i].position.x / .y; grid must be built over the same particles.
+        // Cells narrower than the radius are searched as far out as the radius reaches.
+        template<typename Particles>
+        void build(const Particles& particles, const FlipParticleGrid& grid, float radius, int maxThreads = 1);
+        // Same from SoA positions x[i] / y[i]
+        void build(const float* x, const float* y, int count, const FlipParticleGrid& grid, float radius, int maxThreads = 1);
+        void clear();
+
+        // Pairs are re-measured for the current positions if the last build's candidates
+        // still cover them; false (table unchanged) when a build is needed instead
+        template<typename Particles>
+        bool refresh(const Particles& particles, float radius, int maxThreads = 1);
+        bool refresh(const float* x, const float* y, int count, float radius, int maxThreads = 1);
+        void setSkin(float skin) { m_skin = std::max(0.0f, skin); } // 0: refresh() always fails
+        float getSkin() const { return m_skin; }
+        std::size_t getCandidateCount() const { return m_skinIndices.size(); }
+
+        int begin(int i) const { return m_offsets[i]; }
+        int end(int i) const { return m_offsets[i + 1]; }
+        int getIndex(int k) const { return m_indices[k]; }
+        float getR2(int k) const { return m_r2[k]; }
+        float getDistance(int k) const { return m_distance[k]; }
+
+        // Whole pair arrays, indexed like getIndex / getR2 / getDistance
+        const int* getIndexData() const { return m_indices.data(); }
+        const float* getR2Data() const { return m_r2.data(); }
+        const float* getDistanceData() const { return m_distance.data(); }
+
+        int getParticleCount() const { return static_cast<int>(m_offsets.size()) - 1; }
+        std::size_t getPairCount() const { return m_indices.size(); }
+
+    private:
+        // positionX(i) / positionY(i) for i in [0, count)
+        template<typename PositionX, typename PositionY>
+        void buildFrom(int count, PositionX positionX, PositionY positionY, const FlipParticleGrid& grid, float radius, int maxThreads);
+        template<typename PositionX, typename PositionY>
+        bool refreshFrom(int count, PositionX positionX, PositionY positionY, float radius, int maxThreads);
+        // Pairs within radius out of the skin candidates, from m_skinR2
+        void packSkinPairs(int count, float radius, int maxThreads);
+
+        std::vector<int> m_offsets{ 0 }; // particles + 1 offsets into the pair arrays
+        std::vector<int> m_indices;
+        std::vector<float> m_r2;
+        std::vector<float> m_distance;
+
+        // Build scratch
+        std::vector<float> m_cellOrderX; // positions in the grid's sorted order
+        std::vector<float> m_cellOrderY;
+        std::vector<int> m_candidateStart; // particles + 1 offsets, sized by the cell counts
+        std::vector<int> m_kept;           // pairs kept per particle
+        std::vector<int> m_candidateIndex;
+        std::vector<float> m_candidateR2;
+
+        // Verlet skin: pairs within radius + skin at the last build, and where it saw the particles
+        float m_skin = 0.0f;
+        float m_builtSkin = 0.0f;
+        float m_builtRadius = 0.0f;
+        std::vector<int> m_skinOffsets{ 0 };
+        std::vector<int> m_skinIndices;
+        std::vector<float> m_skinR2;
+        std::vector<float> m_builtX;
+        std::vector<float> m_builtY;
+    };
+
+    // Z-order (Morton) code: the bits of x and y interleaved, so points close in 2D
+    // are mostly close in the order
+    std::uint32_t mortonCode(std::uint16_t x, std::uint16_t y);
+
+    // Particle permutation walking the grid's cells in Z-order (the grid's order within
+    // a cell): order[k] is the particle that moves to slot k. Gathering particles in
+    // this order keeps the neighbours of each one close in memory. grid must be built.
+    void mortonOrder(const FlipParticleGrid& grid, std::vector<int>& order, std::vector<std::uint64_t>& cellKeys);
+
+    template<typename Particles>
+    void SPHNeighborTable::build(const Particles& particles, const FlipParticleGrid& grid, float radius, int maxThreads)
+    {
+        buildFrom(static_cast<int>(particles.size()),
+            [&particles](int i) { return particles[i].position.x; },
+            [&particles](int i) { return particles[i].position.y; }, grid, radius, maxThreads);
+    }
+
+    template<typename Particles>
+    bool SPHNeighborTable::refresh(const Particles& particles, float radius, int maxThreads)
+    {
+        return refreshFrom(static_cast<int>(particles.size()),
+            [&particles](int i) { return particles[i].position.x; },
+            [&particles](int i) { return particles[i].position.y; }, radius, maxThreads);
+    }
+
+    template<typename PositionX, typename PositionY>
+    void SPHNeighborTable::buildFrom(int count, PositionX positionX, PositionY positionY, const FlipParticleGrid& grid, float radius, int maxThreads)
+    {
+        const float searchRadius = radius + m_skin;
+        const float radius2 = searchRadius * searchRadius;
+        const int reach = std::max(1, static_cast<int>(std::ceil(searchRadius / grid.getCellSize())));
+        const int cellsX = grid.getCellsX();
+        const int cellsY = grid.getCellsY();
+        const std::vector<int>& sorted = grid.getSortedIndices();
+        JobSystem& jobs = JobSystem::getInstance();
+
+        m_cellOrderX.resize(count);
+        m_cellOrderY.resize(count);
+        jobs.parallelFor(0, count, 1024, [&](int begin, int end)
+        {
+            for (int s = begin; s < end; ++s)
+            {
+                m_cellOrderX[s] = positionX(sorted[s]);
+                m_cellOrderY[s] = positionY(sorted[s]);
+            }
+        }, maxThreads);
+
+        // Cells of a row are consecutive in the sorted order, so the candidates of
+        // particle i in row y are the sorted range [rowBegin, rowEnd)
+        auto rowRange = [&](int i, int y, int& rowBegin, int& rowEnd)
+        {
+            const int cx = grid.getParticleCell(i) % cellsX;
+            rowBegin = grid.getCellStart(y * cellsX + std::max(cx - reach, 0));
+            rowEnd = grid.getCellEnd(y * cellsX + std::min(cx + reach, cellsX - 1));
+        };
+        auto rows = [&](int i, int& yBegin, int& yEnd)
+        {
+            const int cy = grid.getParticleCell(i) / cellsX;
+            yBegin = std::max(cy - reach, 0);
+            yEnd = std::min(cy + reach, cellsY - 1);
+        };
+
+        m_candidateStart.resize(static_cast<std::size_t>(count) + 1);
+        m_candidateStart[0] = 0;
+        jobs.parallelFor(0, count, 1024, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                int yBegin, yEnd, candidates = 0;
+                rows(i, yBegin, yEnd);
+                for (int y = yBegin; y <= yEnd; ++y)
+                {
+                    int rowBegin, rowEnd;
+                    rowRange(i, y, rowBegin, rowEnd);
+                    candidates += rowEnd - rowBegin;
+                }
+                m_candidateStart[i + 1] = candidates;
+            }
+        }, maxThreads);
+        for (int i = 0; i < count; ++i) m_candidateStart[i + 1] += m_candidateStart[i];
+
+        m_candidateIndex.resize(m_candidateStart[count]);
+        m_candidateR2.resize(m_candidateStart[count]);
+        m_kept.resize(count);
+        jobs.parallelFor(0, count, 256, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const float px = positionX(i);
+                const float py = positionY(i);
+                int yBegin, yEnd;
+                rows(i, yBegin, yEnd);
+                int k = m_candidateStart[i];
+                for (int y = yBegin; y <= yEnd; ++y)
+                {
+                    int rowBegin, rowEnd;
+                    rowRange(i, y, rowBegin, rowEnd);
+                    for (int s = rowBegin; s < rowEnd; ++s)
+                    {
+                        const float dx = px - m_cellOrderX[s];
+                        const float dy = py - m_cellOrderY[s];
+                        const float r2 = dx * dx + dy * dy;
+                        m_candidateIndex[k] = sorted[s];
+                        m_candidateR2[k] = r2;
+                        k += (r2 < radius2) & (sorted[s] != i);
+                    }
+                }
+                m_kept[i] = k - m_candidateStart[i];
+            }
+        }, maxThreads);
+
+        m_builtSkin = m_skin;
+        m_builtRadius = radius;
+        if (m_skin > 0.0f)
+        {
+            // The candidates within radius + skin are kept with the positions they were
+            // measured at; the pairs within radius are packed from their distances
+            m_skinOffsets.resize(static_cast<std::size_t>(count) + 1);
+            m_skinOffsets[0] = 0;
+            for (int i = 0; i < count; ++i) m_skinOffsets[i + 1] = m_skinOffsets[i] + m_kept[i];
+            m_skinIndices.resize(m_skinOffsets[count]);
+            m_skinR2.resize(m_skinOffsets[count]);
+            m_builtX.resize(count);
+            m_builtY.resize(count);
+            jobs.parallelFor(0, count, 1024, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    std::copy_n(m_candidateIndex.begin() + m_candidateStart[i], m_kept[i], m_skinIndices.begin() + m_skinOffsets[i]);
+                    std::copy_n(m_candidateR2.begin() + m_candidateStart[i], m_kept[i], m_skinR2.begin() + m_skinOffsets[i]);
+                    m_builtX[i] = positionX(i);
+                    m_builtY[i] = positionY(i);
+                }
+            }, maxThreads);
+            packSkinPairs(count, radius, maxThreads);
+            return;
+        }
+        m_builtX.clear();
+        m_builtY.clear();
+
+        m_offsets.resize(static_cast<std::size_t>(count) + 1);
+        m_offsets[0] = 0;
+        for (int i = 0; i < count; ++i) m_offsets[i + 1] = m_offsets[i] + m_kept[i];
+
+        const std::size_t pairs = static_cast<std::size_t>(m_offsets[count]);
+        m_indices.resize(pairs);
+        m_r2.resize(pairs);
+        m_distance.resize(pairs);
+        jobs.parallelFor(0, count, 1024, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const int from = m_candidateStart[i];
+                const int to = m_offsets[i];
+                for (int n = 0; n < m_kept[i]; ++n)
+                {
+                    m_indices[to + n] = m_candidateIndex[from + n];
+                    m_r2[to + n] = m_candidateR2[from + n];
+                    m_distance[to + n] = std::sqrt(m_candidateR2[from + n]);
+                }
+            }
+        }, maxThreads);
+    }
+
+    template<typename PositionX, typename PositionY>
+    bool SPHNeighborTable::refreshFrom(int count, PositionX positionX, PositionY positionY, float radius, int maxThreads)
+    {
+        if (m_builtSkin <= 0.0f || m_skin != m_builtSkin || radius != m_builtRadius || count != static_cast<int>(m_builtX.size()))
+            return false;
+
+        const float limit2 = 0.25f * m_skin * m_skin;
+        JobSystem& jobs = JobSystem::getInstance();
+        std::atomic<bool> moved{ false };
+        jobs.parallelFor(0, count, 2048, [&](int begin, int end)
+        {
+            bool local = false;
+            for (int i = begin; i < end; ++i)
+            {
+                const float dx = positionX(i) - m_builtX[i];
+                const float dy = positionY(i) - m_builtY[i];
+                local |= dx * dx + dy * dy > limit2;
+            }
+            if (local) moved.store(true, std::memory_order_relaxed);
+        }, maxThreads);
+        if (moved.load()) return false;
+
+        // Re-measure the candidates, then pack
+        jobs.parallelFor(0, count, 256, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const float px = positionX(i);
+                const float py = positionY(i);
+                for (int k = m_skinOffsets[i]; k < m_skinOffsets[i + 1]; ++k)
+                {
+                    const int j = m_skinIndices[k];
+                    const float dx = px - positionX(j);
+                    const float dy = py - positionY(j);
+                    m_skinR2[k] = dx * dx + dy * dy;
+                }
+            }
+        }, maxThreads);
+        packSkinPairs(count, radius, maxThreads);
+        return true;
+    }
+}
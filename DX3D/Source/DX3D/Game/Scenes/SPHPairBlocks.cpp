@@ -0,0 +1,124 @@
+#include <DX3D/Game/Scenes/SPHPairBlocks.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace dx3d;
+
+const char* dx3d::getSPHPairModeName(SPHPairMode mode)
+{
+    switch (mode)
+    {
+    case SPHPairMode::Gather: return "Gather";
+    case SPHPairMode::PerThread: return "Per-Thread Sums";
+    case SPHPairMode::Colored: return "Colored Blocks";
+    }
+    return "Unknown";
+}
+
+void SPHPairBlocks::build(const FlipParticleGrid& grid, float radius, int maxThreads)
+{
+    const int cellsX = grid.getCellsX();
+    const int cellsY = grid.getCellsY();
+    const int reach = std::max(1, static_cast<int>(std::ceil(radius / grid.getCellSize())));
+    m_side = std::max(reach, MinBlockCells);
+    const int blocksX = (cellsX + m_side - 1) / m_side;
+    const int blocksY = (cellsY + m_side - 1) / m_side;
+
+    // Blocks grouped by color, rows bottom to top within a color
+    m_blockCell.clear();
+    for (int c = 0; c < Colors; ++c)
+    {
+        m_colorStart[c] = static_cast<int>(m_blockCell.size());
+        for (int by = c / 3; by < blocksY; by += 3)
+            for (int bx = c % 3; bx < blocksX; bx += 3)
+                m_blockCell.push_back(by * m_side * cellsX + bx * m_side);
+    }
+    m_colorStart[Colors] = static_cast<int>(m_blockCell.size());
+
+    const int blocks = static_cast<int>(m_blockCell.size());
+    auto forBlockCells = [&](int block, auto&& fn)
+    {
+        const int first = m_blockCell[block];
+        const int x0 = first % cellsX;
+        const int y0 = first / cellsX;
+        const int x1 = std::min(x0 + m_side, cellsX);
+        const int y1 = std::min(y0 + m_side, cellsY);
+        for (int y = y0; y < y1; ++y)
+            for (int x = x0; x < x1; ++x) fn(y * cellsX + x);
+    };
+
+    m_blockStart.resize(blocks + 1);
+    m_blockStart[0] = 0;
+    for (int b = 0; b < blocks; ++b)
+    {
+        int count = 0;
+        forBlockCells(b, [&](int cell) { count += grid.getCellEnd(cell) - grid.getCellStart(cell); });
+        m_blockStart[b + 1] = m_blockStart[b] + count;
+    }
+
+    const std::vector<int>& sorted = grid.getSortedIndices();
+    m_particles.resize(m_blockStart[blocks]);
+    m_jobs->parallelFor(0, blocks, 16, [&](int begin, int end)
+    {
+        for (int b = begin; b < end; ++b)
+        {
+            int next = m_blockStart[b];
+            forBlockCells(b, [&](int cell)
+            {
+                for (int s = grid.getCellStart(cell); s < grid.getCellEnd(cell); ++s)
+                    m_particles[next++] = sorted[s];
+            });
+        }
+    }, maxThreads);
+}
+
+void SPHThreadAccumulators::begin(int count)
+{
+    const size_t threads = m_jobs->getThreadCount();
+    if (m_x.size() != threads)
+    {
+        m_x.resize(threads);
+        m_y.resize(threads);
+        m_stamp.assign(threads, 0);
+    }
+    m_count = count;
+    ++m_pass;
+}
+
+SPHThreadAccumulators::Buffer SPHThreadAccumulators::local()
+{
+    // Only the owning thread touches its arrays and stamp during a pass
+    const unsigned t = m_jobs->getThreadIndex();
+    std::vector<float>& x = m_x[t];
+    std::vector<float>& y = m_y[t];
+    if (m_stamp[t] != m_pass)
+    {
+        x.assign(m_count, 0.0f);
+        y.assign(m_count, 0.0f);
+        m_stamp[t] = m_pass;
+    }
+    return { x.data(), y.data() };
+}
+
+void SPHThreadAccumulators::reduce(float* outX, float* outY, int maxThreads) const
+{
+    std::vector<int> used;
+    for (size_t t = 0; t < m_stamp.size(); ++t)
+        if (m_stamp[t] == m_pass) used.push_back(static_cast<int>(t));
+
+    m_jobs->parallelFor(0, m_count, 4096, [&](int begin, int end)
+    {
+        std::fill(outX + begin, outX + end, 0.0f);
+        std::fill(outY + begin, outY + end, 0.0f);
+        for (int t : used)
+        {
+            const float* x = m_x[t].data();
+            const float* y = m_y[t].data();
+            for (int i = begin; i < end; ++i)
+            {
+                outX[i] += x[i];
+                outY[i] += y[i];
+            }
+        }
+    }, maxThreads);
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/FlipParticleGrid.h>
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // How a pass that writes both particles of a pair is split across threads
+    enum class SPHPairMode : uint8_t
+    {
+        Gather = 0, // every particle sums all of its pairs: each pair is evaluated twice, nothing shared is written
+        PerThread,  // each pair once, into the running thread's accumulators, summed per particle afterwards;
+                    // the order of the sums follows the scheduling
+        Colored     // each pair once, blocks run color by color (SPHPairBlocks); the same result for any thread count
+    };
+
+    const char* getSPHPairModeName(SPHPairMode mode);
+
+    // Spatial blocks over a built grid for passes that write both particles of a pair.
+    // A block is at least `reach` cells square (the cells a neighbor search spans), so
+    // the pairs of its particles stay within it and the eight blocks around it, and at
+    // least MinBlockCells so a block is worth scheduling on its own. Blocks are colored
+    // by (bx % 3, by % 3): the 3x3 neighborhoods of two blocks of one color never
+    // overlap, so every block of a color can run at once with no two threads touching
+    // the same particle, and no atomics. Colors run in order and each block walks its
+    // particles in grid order (rows bottom to top), so a pass does the same operations
+    // in the same order whatever the thread count.
+    class SPHPairBlocks
+    {
+    public:
+        // Passes run on jobs (the engine's job system unless a benchmark brings its own)
+        explicit SPHPairBlocks(JobSystem& jobs = JobSystem::getInstance()) : m_jobs(&jobs) {}
+
+        // Blocks of max(ceil(radius / cell size), MinBlockCells) cells; the reach matches the neighbor table's
+        void build(const FlipParticleGrid& grid, float radius, int maxThreads = 1);
+
+        // fn(block, particles, count) for every block, one color at a time; the blocks
+        // of a color are spread over up to maxThreads threads (0 = all)
+        template<typename Fn>
+        void forEachBlock(Fn&& fn, int maxThreads = 0) const;
+
+        int getBlockCount() const { return static_cast<int>(m_blockStart.size()) - 1; }
+        const int* getBlockParticles(int block) const { return m_particles.data() + m_blockStart[block]; }
+        int getBlockSize(int block) const { return m_blockStart[block + 1] - m_blockStart[block]; }
+
+    private:
+        static constexpr int Colors = 9;
+        static constexpr int MinBlockCells = 4; // ~100 particles at the scene's spacing
+        JobSystem* m_jobs;
+        std::vector<int> m_blockStart{ 0 }; // blocks + 1 offsets into m_particles, blocks grouped by color
+        std::vector<int> m_particles;
+        int m_colorStart[Colors + 1] = {};  // blocks of color c are [m_colorStart[c], m_colorStart[c + 1])
+        std::vector<int> m_blockCell;       // bottom left cell of each block
+        int m_side = 1;
+    };
+
+    // Per-thread (x, y) accumulators for SPHPairMode::PerThread: each job system
+    // thread adds into its own arrays, which it clears the first time it touches
+    // them in a pass, and reduce() sums the arrays that were used
+    class SPHThreadAccumulators
+    {
+    public:
+        struct Buffer
+        {
+            float* x;
+            float* y;
+        };
+
+        explicit SPHThreadAccumulators(JobSystem& jobs = JobSystem::getInstance()) : m_jobs(&jobs) {}
+
+        // Start a pass over count particles
+        void begin(int count);
+        // The calling thread's arrays, zeroed on first use in this pass
+        Buffer local();
+        // outX[i] / outY[i] = sum over the used arrays, for every particle
+        void reduce(float* outX, float* outY, int maxThreads = 0) const;
+
+    private:
+        JobSystem* m_jobs;
+        std::vector<std::vector<float>> m_x;
+        std::vector<std::vector<float>> m_y;
+        std::vector<std::uint64_t> m_stamp; // pass each thread last cleared its arrays in
+        std::uint64_t m_pass = 0;
+        int m_count = 0;
+    };
+
+    template<typename Fn>
+    void SPHPairBlocks::forEachBlock(Fn&& fn, int maxThreads) const
+    {
+        for (int c = 0; c < Colors; ++c)
+        {
+            m_jobs->parallelFor(m_colorStart[c], m_colorStart[c + 1], 4, [&](int begin, int end)
+            {
+                for (int b = begin; b < end; ++b) fn(b, getBlockParticles(b), getBlockSize(b));
+            }, maxThreads);
+        }
+    }
+}
@@ -0,0 +1,241 @@
+#include <DX3D/Game/Scenes/SPHPositionSolver.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace dx3d;
+
+namespace
+{
+    const float MinDistance = 1e-6f;
+}
+
+const char* dx3d::getSPHSolverModeName(SPHSolverMode mode)
+{
+    switch (mode)
+    {
+    case SPHSolverMode::EquationOfState: return "Equation of State";
+    case SPHSolverMode::PositionBased: return "Position Based (PBF)";
+    }
+    return "Unknown";
+}
+
+void SPHPositionSolver::setSettings(float smoothingRadius, const SPHPositionSolverSettings& settings)
+{
+    m_settings = settings;
+    m_h = std::max(1e-3f, smoothingRadius);
+    m_invH = 1.0f / m_h;
+    const double h = m_h;
+    const double spacing = std::max(1e-3f, settings.restSpacing);
+    const int reach = static_cast<int>(std::ceil(h / spacing));
+
+    // Shape and squared gradient sums over a rest lattice around one particle
+    double restSum = 0.0;
+    double gradientSum = 0.0;
+    for (int a = -reach; a <= reach; ++a)
+    {
+        for (int b = -reach; b <= reach; ++b)
+        {
+            const double r = spacing * std::sqrt(static_cast<double>(a * a + b * b));
+            if (r >= h) continue;
+            const double q = 1.0 - r / h;
+            restSum += q * q * q;
+            if (r > 0.0) gradientSum += (3.0 * q * q / h) * (3.0 * q * q / h);
+        }
+    }
+    m_invRestSum = static_cast<float>(1.0 / restSum);
+    m_epsilon = static_cast<float>(settings.relaxation * gradientSum / (restSum * restSum));
+
+    // The rest lattice beyond a wall: rows at d + k * spacing behind it, averaged over
+    // where the particle sits between two columns
+    const int phases = 4;
+    for (int s = 0; s <= WallSamples; ++s)
+    {
+        const double d = h * s / WallSamples;
+        double density = 0.0;
+        double gradient = 0.0;
+        for (int p = 0; p < phases; ++p)
+        {
+            const double phase = spacing * p / phases;
+            for (int k = 1; d + k * spacing < h; ++k)
+            {
+                const double dy = d + k * spacing;
+                for (int m = -reach - 1; m <= reach + 1; ++m)
+                {
+                    const double dx = m * spacing + phase;
+                    const double r = std::sqrt(dx * dx + dy * dy);
+                    if (r >= h) continue;
+                    const double q = 1.0 - r / h;
+                    density += q * q * q;
+                    gradient -= 3.0 * q * q / h * dy / r;
+                }
+            }
+        }
+        m_wallDensity[s] = static_cast<float>(density / phases / restSum);
+        m_wallGradient[s] = static_cast<float>(gradient / phases / restSum);
+    }
+}
+
+void SPHPositionSolver::wallTerms(float d, float& density, float& gradient) const
+{
+    const float t = std::max(d, 0.0f) * m_invH * WallSamples;
+    const int s = static_cast<int>(t);
+    if (s >= WallSamples)
+    {
+        density = 0.0f;
+        gradient = 0.0f;
+        return;
+    }
+    const float f = t - s;
+    density = m_wallDensity[s] + (m_wallDensity[s + 1] - m_wallDensity[s]) * f;
+    gradient = m_wallGradient[s] + (m_wallGradient[s + 1] - m_wallGradient[s]) * f;
+}
+
+void SPHPositionSolver::predict(SPHPositionFields& fields, int count, float dt, int maxThreads)
+{
+    m_prevX.resize(count);
+    m_prevY.resize(count);
+    const SPHPositionSolverSettings& s = m_settings;
+    m_jobs->parallelFor(0, count, 2048, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            m_prevX[i] = fields.x[i];
+            m_prevY[i] = fields.y[i];
+            fields.vy[i] += s.gravity * dt;
+            fields.x[i] = std::clamp(fields.x[i] + fields.vx[i] * dt, s.minX, s.maxX);
+            fields.y[i] = std::clamp(fields.y[i] + fields.vy[i] * dt, s.minY, s.maxY);
+        }
+    }, maxThreads);
+}
+
+void SPHPositionSolver::project(const SPHNeighborTable& table, SPHPositionFields& fields, const int* particles, int count, bool reverse, double& errorSum)
+{
+    const SPHPositionSolverSettings& s = m_settings;
+    const float h2 = m_h * m_h;
+    const float gradientScale = 3.0f * m_invH * m_invRestSum;
+    for (int n = 0; n < count; ++n)
+    {
+        const int i = particles[reverse ? count - 1 - n : n];
+        const float xi = fields.x[i];
+        const float yi = fields.y[i];
+        float shapeSum = 1.0f; // self
+        float gradientX = 0.0f, gradientY = 0.0f; // d(rho_i) / d(x_i)
+        float gradientSquares = 0.0f;             // sum of |d(rho_i) / d(x_j)|^2
+        float* pairGradient = m_pairGradient.data();
+        for (int k = table.begin(i); k < table.end(i); ++k)
+        {
+            const int j = table.getIndex(k);
+            const float dx = xi - fields.x[j];
+            const float dy = yi - fields.y[j];
+            const float r2 = dx * dx + dy * dy;
+            pairGradient[k] = 0.0f;
+            if (r2 >= h2) continue;
+            const float r = std::sqrt(r2);
+            const float q = 1.0f - r * m_invH;
+            shapeSum += q * q * q;
+            if (r <= MinDistance) continue;
+            const float g = gradientScale * q * q / r;
+            pairGradient[k] = g;
+            gradientX -= g * dx;
+            gradientY -= g * dy;
+            gradientSquares += g * g * r2;
+        }
+        float density = shapeSum * m_invRestSum;
+
+        // Walls: d(rho_i) / d(x_i) along each wall's inward normal
+        float wallDensity, wallGradient;
+        wallTerms(xi - s.minX, wallDensity, wallGradient);
+        density += wallDensity;
+        gradientX += wallGradient;
+        wallTerms(s.maxX - xi, wallDensity, wallGradient);
+        density += wallDensity;
+        gradientX -= wallGradient;
+        wallTerms(yi - s.minY, wallDensity, wallGradient);
+        density += wallDensity;
+        gradientY += wallGradient;
+        wallTerms(s.maxY - yi, wallDensity, wallGradient);
+        density += wallDensity;
+        gradientY -= wallGradient;
+        fields.density[i] = density * s.restDensity;
+
+        const float constraint = density - 1.0f;
+        if (constraint <= 0.0f) continue;
+        errorSum += constraint;
+        const float delta = -constraint / (gradientX * gradientX + gradientY * gradientY + gradientSquares + m_epsilon);
+
+        // x_k += delta * d(rho_i) / d(x_k) for i and each neighbor, along the gathered directions
+        fields.x[i] = std::clamp(xi + delta * gradientX, s.minX, s.maxX);
+        fields.y[i] = std::clamp(yi + delta * gradientY, s.minY, s.maxY);
+        for (int k = table.begin(i); k < table.end(i); ++k)
+        {
+            if (pairGradient[k] == 0.0f) continue;
+            const int j = table.getIndex(k);
+            const float g = delta * pairGradient[k];
+            fields.x[j] = std::clamp(fields.x[j] + g * (xi - fields.x[j]), s.minX, s.maxX);
+            fields.y[j] = std::clamp(fields.y[j] + g * (yi - fields.y[j]), s.minY, s.maxY);
+        }
+    }
+}
+
+void SPHPositionSolver::solve(const SPHNeighborTable& table, const SPHPairBlocks& blocks, SPHPositionFields& fields, int count, float dt, int maxThreads)
+{
+    const SPHPositionSolverSettings& s = m_settings;
+    m_dx.resize(count);
+    m_dy.resize(count);
+    m_pairGradient.resize(table.getPairCount());
+
+    // Alternate the sweep direction so corrections do not drift one way along a row
+    for (int iteration = 0; iteration < std::max(1, s.iterations); ++iteration)
+    {
+        std::atomic<double> errorSum{ 0.0 };
+        blocks.forEachBlock([&](int, const int* particles, int blockSize)
+        {
+            double localError = 0.0;
+            project(table, fields, particles, blockSize, (iteration & 1) != 0, localError);
+            errorSum.fetch_add(localError, std::memory_order_relaxed);
+        }, maxThreads);
+        m_densityError = count > 0 ? static_cast<float>(errorSum.load() / count) : 0.0f;
+    }
+
+    // Velocities from the corrected displacement, damped by the same fraction per
+    // simulated second whatever the step
+    const float invDt = dt > 0.0f ? std::pow(std::clamp(s.damping, 0.0f, 1.0f), dt) / dt : 0.0f;
+    m_jobs->parallelFor(0, count, 2048, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            fields.vx[i] = (fields.x[i] - m_prevX[i]) * invDt;
+            fields.vy[i] = (fields.y[i] - m_prevY[i]) * invDt;
+        }
+    }, maxThreads);
+    if (s.xsph <= 0.0f) return;
+
+    // XSPH: v_i += c * sum (v_j - v_i) W_ij
+
+    const float h2 = m_h * m_h;
+    const float smoothing = s.xsph * m_invRestSum;
+    m_jobs->parallelFor(0, count, 256, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            float sumX = 0.0f, sumY = 0.0f;
+            for (int k = table.begin(i); k < table.end(i); ++k)
+            {
+                const int j = table.getIndex(k);
+                const float dx = fields.x[i] - fields.x[j];
+                const float dy = fields.y[i] - fields.y[j];
+                const float r2 = dx * dx + dy * dy;
+                if (r2 >= h2) continue;
+                const float q = 1.0f - std::sqrt(r2) * m_invH;
+                const float w = q * q * q;
+                sumX += (fields.vx[j] - fields.vx[i]) * w;
+                sumY += (fields.vy[j] - fields.vy[i]) * w;
+            }
+            m_dx[i] = fields.vx[i] + sumX * smoothing;
+            m_dy[i] = fields.vy[i] + sumY * smoothing;
+        }
+    }, maxThreads);
+    std::copy(m_dx.begin(), m_dx.begin() + count, fields.vx);
+    std::copy(m_dy.begin(), m_dy.begin() + count, fields.vy);
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Game/Scenes/SPHNeighborTable.h>
+#include <DX3D/Game/Scenes/SPHPairBlocks.h>
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // How the SPH scene keeps the fluid from compressing
+    enum class SPHSolverMode : uint8_t
+    {
+        EquationOfState = 0, // pressure from a stiff gas law, plus the collision and stabilization passes
+        PositionBased        // SPHPositionSolver: density constraints solved on positions
+    };
+
+    const char* getSPHSolverModeName(SPHSolverMode mode);
+
+    struct SPHPositionSolverSettings
+    {
+        int iterations = 8;            // Gauss-Seidel sweeps; fewer stop settling deep columns at the scene's 4x step
+        float restSpacing = 7.6f;      // particle spacing the fluid rests at; sets the rest density
+        float relaxation = 0.05f;      // constraint softening, as a fraction of the rest lattice's gradient sum
+        float xsph = 0.01f;            // velocity smoothing after the solve
+        float damping = 0.55f;         // fraction of velocity kept per simulated second (0.99 per 1/60 s step)
+        float gravity = -500.0f;
+        float restDensity = 1000.0f;   // density written for particles at the rest spacing
+        // Positions are kept in this box; its walls count as fluid at rest beyond them
+        float minX = -1e30f, minY = -1e30f, maxX = 1e30f, maxY = 1e30f;
+    };
+
+    // SoA fields the solver moves, indexed like the neighbor table
+    struct SPHPositionFields
+    {
+        float* x = nullptr;
+        float* y = nullptr;
+        float* vx = nullptr;
+        float* vy = nullptr;
+        float* density = nullptr; // written by solve(), in settings.restDensity units
+    };
+
+    // Position Based Fluids (Macklin & Müller 2013). Instead of turning density error
+    // into pressure forces, which needs a stiff gas constant and small steps, each
+    // iteration moves the predicted positions towards C_i = rho_i / rho_0 - 1 = 0, only
+    // where compressed (C_i >= 0, so the free surface does not pull together).
+    //
+    // Density and its gradient both use the spiky shape (1 - r/h)^3 normalized by its
+    // sum over a square lattice at restSpacing, so rho_0 is 1 whatever the kernel's mass
+    // units and the gradient is the density's exact derivative. The box walls add the
+    // density of a rest lattice beyond them, so particles at a wall rest at restSpacing
+    // too. Constraints are projected one particle at a time (Gauss-Seidel), which
+    // carries a column's weight down far quicker than the paper's Jacobi passes; a
+    // projection moves only particles within h, so SPHPairBlocks' same-colored blocks
+    // run in parallel.
+    //
+    // A step: predict() (v += g dt, x += v dt), then the caller builds the grid, neighbor
+    // table and pair blocks on the predicted positions, then solve() (iterations,
+    // v = dx / dt, XSPH smoothing).
+    class SPHPositionSolver
+    {
+    public:
+        explicit SPHPositionSolver(JobSystem& jobs = JobSystem::getInstance()) : m_jobs(&jobs) {}
+
+        void setSettings(float smoothingRadius, const SPHPositionSolverSettings& settings);
+        const SPHPositionSolverSettings& getSettings() const { return m_settings; }
+
+        void predict(SPHPositionFields& fields, int count, float dt, int maxThreads = 0);
+        void solve(const SPHNeighborTable& table, const SPHPairBlocks& blocks, SPHPositionFields& fields, int count, float dt, int maxThreads = 0);
+
+        // Mean of max(rho_i / rho_0 - 1, 0) over the last iteration
+        float getDensityError() const { return m_densityError; }
+
+    private:
+        static constexpr int WallSamples = 64;
+
+        // Density and d(density)/d(distance) of the rest lattice beyond a wall, d from the wall in [0, h)
+        void wallTerms(float d, float& density, float& gradient) const;
+        // Project the density constraint of each particle in a block onto it and its neighbors
+        void project(const SPHNeighborTable& table, SPHPositionFields& fields, const int* particles, int count, bool reverse, double& errorSum);
+
+        JobSystem* m_jobs;
+        SPHPositionSolverSettings m_settings;
+        float m_h = 1.0f;
+        float m_invH = 1.0f;
+        float m_invRestSum = 1.0f;  // 1 / (spiky shape sum at rest): rho_i / rho_0 = shape sum * this
+        float m_epsilon = 0.0f;
+        float m_wallDensity[WallSamples + 1] = {};
+        float m_wallGradient[WallSamples + 1] = {};
+        float m_densityError = 0.0f;
+        std::vector<float> m_prevX, m_prevY;
+        std::vector<float> m_dx, m_dy;
+        std::vector<float> m_pairGradient; // per table pair, d(rho_i) / d(x_j) / r_ij from a projection's gather
+    };
+}
@@ -126,7 +126,6 @@ namespace dx3d {
         bool isValidSequenceFromPosition(CardStack* stack, size_t startIndex);
 
         // Game state
-        std::unique_ptr<EntityManager> m_entityManager;
         SpiderDifficulty m_difficulty;
 
         // Card containers
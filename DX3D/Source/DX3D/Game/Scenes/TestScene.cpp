@@ -15,6 +15,8 @@
 #include <DX3D/Components/FirmGuyComponent.h>
 #include <DX3D/Components/FirmGuySystem.h>
 #include <DX3D/Components/SoftGuyComponent.h>
+#include <DX3D/Components/SpringGuyComponent.h>
+#include <DX3D/Game/Scenes/PhysicsTetrisScene.h> // For FrameComponent
 #include <imgui.h>
 #include <iostream>
 #include <string>
@@ -352,116 +354,134 @@ void TestScene::load(GraphicsEngine& engine) {
     auto& fpsText = fpsTextE.addComponent<TextComponent>(device, TextSystem::getRenderer(), L"FPS: 0", 20.0f);
     fpsText.setScreenPosition(0.05, 0.02);
     fpsText.setColor(Vec4(1, 1, 0, 1));
+
+    registerSystems();
 }
 
 void TestScene::update(float dt) {
-    auto& input = Input::getInstance();
+    // Every per-frame system is registered in registerSystems(); the SystemManager
+    // runs the ones that do not share written components in parallel
+    m_systems->update(*m_entityManager, dt);
+}
 
-    // Update camera movement
-    updateCameraMovement(dt);
+void TestScene::registerSystems() {
+    m_systems = std::make_unique<SystemManager>();
 
-    // Handle cat2 movement with arrow keys
-    if (auto* cat2Entity = m_entityManager->findEntity("Cat2")) {
-        if (auto* movement = cat2Entity->getComponent<MovementComponent>()) {
-            Vec2 velocity(0.0f, 0.0f);
-            float speed = movement->getSpeed();
+    m_systems->addSystem("Camera", SystemAccess().write<Camera2D>(),
+        [this](EntityManager&, float dt) { updateCameraMovement(dt); });
 
-            if (input.isKeyDown(Key::Up))    velocity.y += speed;
-            if (input.isKeyDown(Key::Down))  velocity.y -= speed;
-            if (input.isKeyDown(Key::Left))  velocity.x -= speed;
-            if (input.isKeyDown(Key::Right)) velocity.x += speed;
+    // Handle cat2 movement with arrow keys
+    m_systems->addSystem("PlayerInput", SystemAccess().write<MovementComponent>(),
+        [](EntityManager& em, float) {
+            auto& input = Input::getInstance();
+            if (auto* cat2Entity = em.findEntity("Cat2")) {
+                if (auto* movement = cat2Entity->getComponent<MovementComponent>()) {
+                    Vec2 velocity(0.0f, 0.0f);
+                    float speed = movement->getSpeed();
+
+                    if (input.isKeyDown(Key::Up))    velocity.y += speed;
+                    if (input.isKeyDown(Key::Down))  velocity.y -= speed;
+                    if (input.isKeyDown(Key::Left))  velocity.x -= speed;
+                    if (input.isKeyDown(Key::Right)) velocity.x += speed;
+
+                    movement->setVelocity(velocity);
+                }
+            }
+        });
 
-            movement->setVelocity(velocity);
-        }
-    }
-    if (auto* debugQuad = m_entityManager->findEntity("DebugQuad")) {
-        float speed = 0.005f; // normalized space movement per frame
-        auto debugQuadSprite = debugQuad->getComponent<SpriteComponent>();
-        Vec2 newPos = debugQuadSprite->getScreenPosition();
+    m_systems->addSystem("DebugQuadKeys", SystemAccess().write<SpriteComponent>(),
+        [](EntityManager& em, float) {
+            auto& input = Input::getInstance();
+            if (auto* debugQuad = em.findEntity("DebugQuad")) {
+                float speed = 0.005f; // normalized space movement per frame
+                auto debugQuadSprite = debugQuad->getComponent<SpriteComponent>();
+                Vec2 newPos = debugQuadSprite->getScreenPosition();
+
+                if (input.isKeyDown(Key::I)) {
+                    newPos.y += speed;
+                }
+                if (input.isKeyDown(Key::K)) {
+                    newPos.y -= speed;
+                }
+                if (input.isKeyDown(Key::J)) {
+                    newPos.x -= speed;
+                }
+                if (input.isKeyDown(Key::L)) {
+                    newPos.x += speed;
+                }
+
+                debugQuadSprite->setScreenPosition(newPos.x, newPos.y);
+            }
+        });
 
-        if (input.isKeyDown(Key::I)) {
-            newPos.y += speed;
-        }
-        if (input.isKeyDown(Key::K)) {
-            newPos.y -= speed;
-        }
-        if (input.isKeyDown(Key::J)) {
-            newPos.x -= speed;
-        }
-        if (input.isKeyDown(Key::L)) {
-            newPos.x += speed;
-        }
+    // Animation callbacks move sprites and the rotating FirmGuy box walls
+    m_systems->addSystem("Animation", SystemAccess().write<AnimationComponent, SpriteComponent, FirmGuyComponent>(),
+        [](EntityManager& em, float dt) {
+            em.forEach<AnimationComponent>([dt](Entity& entity, AnimationComponent& animation) {
+                animation.update(entity, dt);
+            });
+        });
 
-        debugQuadSprite->setScreenPosition(newPos.x, newPos.y);
-    }
+    m_systems->addSystem("Movement", SystemAccess().read<MovementComponent>().write<SpriteComponent>(),
+        [](EntityManager& em, float dt) {
+            em.forEach<MovementComponent>([dt](Entity& entity, MovementComponent& movement) {
+                movement.update(entity, dt);
+            });
+        });
 
-    // Update all animation components
-    auto animatedEntities = m_entityManager->getEntitiesWithComponent<AnimationComponent>();
-    for (auto* entity : animatedEntities) {
-        if (auto* animation = entity->getComponent<AnimationComponent>()) {
-            animation->update(*entity, dt);
-        }
-    }
+    // Update FirmGuy physics last so input moved sprites can be overridden by physics bodies
+    m_systems->addSystem("FirmGuy",
+        SystemAccess().read<SoftGuyComponent>().write<FirmGuyComponent, SpringGuyNodeComponent, SpriteComponent>(),
+        [](EntityManager& em, float dt) { FirmGuySystem::update(em, dt); });
 
-    // Update all movement components
-    auto movingEntities = m_entityManager->getEntitiesWithComponent<MovementComponent>();
-    for (auto* entity : movingEntities) {
-        if (auto* movement = entity->getComponent<MovementComponent>()) {
-            movement->update(*entity, dt);
-        }
-    }
+    // Nodes and beams are updated data-parallel inside SpringGuySystem; frames fall under gravity
+    m_systems->addSystem("SoftGuy",
+        SystemAccess().write<SpringGuyNodeComponent, SpringGuyBeamComponent, SpriteComponent, FrameComponent>(),
+        [](EntityManager& em, float dt) { SoftGuySystem::update(em, dt); });
 
-    // Update FirmGuy physics last so input moved sprites can be overridden by physics bodies
-    FirmGuySystem::update(*m_entityManager, dt);
-    
-    // Update SoftGuy physics system
-    SoftGuySystem::update(*m_entityManager, dt);
-    
     // Debug: Print ball position
-    if (auto* ballEntity = m_entityManager->findEntity("FG_Ball")) {
-        if (auto* ballRB = ballEntity->getComponent<FirmGuyComponent>()) {
-            Vec2 pos = ballRB->getPosition();
-            Vec2 vel = ballRB->getVelocity();
-            printf("Ball: pos(%.1f, %.1f) vel(%.1f, %.1f)\n", pos.x, pos.y, vel.x, vel.y);
-        }
-    }
-    auto buttonEntities = m_entityManager->getEntitiesWithComponent<ButtonComponent>();
-    for (auto* entity : buttonEntities) {
-        if (auto* movement = entity->getComponent<ButtonComponent>()) {
-            movement->update(dt);
-        }
-    }
-    auto mouse = Input::getInstance().getMousePositionNDC();
-    if (auto* debugQuad = m_entityManager->findEntity("DebugQuad")) {
-        float speed = 0.005f; // normalized space movement per frame
-        auto debugQuadSprite = debugQuad->getComponent<SpriteComponent>();
-        Vec2 newPos = debugQuadSprite->getScreenPosition();
-
-        if (input.isKeyDown(Key::I)) {
-            newPos.y += speed;
-        }
-        if (input.isKeyDown(Key::K)) {
-            newPos.y -= speed;
-        }
-        if (input.isKeyDown(Key::J)) {
-            newPos.x -= speed;
-        }
-        if (input.isKeyDown(Key::L)) {
-            newPos.x += speed;
-        }
+    m_systems->addSystem("BallDebug", SystemAccess().read<FirmGuyComponent>(),
+        [](EntityManager& em, float) {
+            if (auto* ballEntity = em.findEntity("FG_Ball")) {
+                if (auto* ballRB = ballEntity->getComponent<FirmGuyComponent>()) {
+                    Vec2 pos = ballRB->getPosition();
+                    Vec2 vel = ballRB->getVelocity();
+                    printf("Ball: pos(%.1f, %.1f) vel(%.1f, %.1f)\n", pos.x, pos.y, vel.x, vel.y);
+                }
+            }
+        });
 
-        debugQuadSprite->setScreenPosition(mouse.x, mouse.y);
-    }
-    static float timer = 0; static int frames = 0;
-    timer += dt; frames++;
-    if (timer >= 1.0f) {
-        if (auto* fpsEntity = m_entityManager->findEntity("UI_FPS"))
-            if (auto* fpsText = fpsEntity->getComponent<TextComponent>()) {
-                fpsText->setText(L"FPS: " + std::to_wstring(frames));
+    // Button click callbacks rescale the cat sprite
+    m_systems->addSystem("Buttons", SystemAccess().write<ButtonComponent, SpriteComponent>(),
+        [](EntityManager& em, float dt) {
+            em.forEach<ButtonComponent>([dt](Entity&, ButtonComponent& button) {
+                button.update(dt);
+            });
+        });
+
+    m_systems->addSystem("DebugQuadMouse", SystemAccess().write<SpriteComponent>(),
+        [](EntityManager& em, float) {
+            auto mouse = Input::getInstance().getMousePositionNDC();
+            if (auto* debugQuad = em.findEntity("DebugQuad")) {
+                debugQuad->getComponent<SpriteComponent>()->setScreenPosition(mouse.x, mouse.y);
             }
-        frames = 0; timer = 0;
-    }
-    printf("%f,%f\n", mouse.x, mouse.y);
+            printf("%f,%f\n", mouse.x, mouse.y);
+        });
+
+    m_systems->addSystem("FpsCounter", SystemAccess().write<TextComponent>(),
+        [](EntityManager& em, float dt) {
+            static float timer = 0; static int frames = 0;
+            timer += dt; frames++;
+            if (timer >= 1.0f) {
+                if (auto* fpsEntity = em.findEntity("UI_FPS"))
+                    if (auto* fpsText = fpsEntity->getComponent<TextComponent>()) {
+                        fpsText->setText(L"FPS: " + std::to_wstring(frames));
+                    }
+                frames = 0; timer = 0;
+            }
+        });
+
+    m_systems->build();
 }
 
 void TestScene::updateCameraMovement(float dt) {
@@ -709,6 +729,33 @@ void TestScene::renderImGui(GraphicsEngine& engine) {
     ImGui::Text("FirmGuy Objects: %d", (int)firmGuyEntities.size());
     
     ImGui::End();
+
+    // System schedule and per-system timings
+    ImGui::Begin("Systems");
+    bool parallel = m_systems->isParallel();
+    if (ImGui::Checkbox("Run In Parallel", &parallel)) {
+        m_systems->setParallel(parallel);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump Schedule")) {
+        printf("%s", m_systems->dumpSchedule().c_str());
+    }
+    ImGui::Text("Update: %.3f ms on %u threads", m_systems->getFrameMs(), JobSystem::getInstance().getThreadCount());
+    ImGui::Separator();
+    for (SystemManager::SystemId id = 0; id < m_systems->getSystemCount(); ++id) {
+        const auto& stats = m_systems->getSystemStats(id);
+        bool enabled = m_systems->isEnabled(id);
+        ImGui::PushID(static_cast<int>(id));
+        if (ImGui::Checkbox("##enabled", &enabled)) {
+            m_systems->setEnabled(id, enabled);
+        }
+        ImGui::PopID();
+        ImGui::SameLine();
+        ImGui::Text("[%d] %-14s %7.3f ms  start %6.3f  thread %u",
+            m_systems->getStage(id), m_systems->getSystemName(id).c_str(),
+            stats.averageMs, stats.startMs, stats.threadIndex);
+    }
+    ImGui::End();
 }
 
 void TestScene::spawnSoftGuyCircle(Vec2 position) {
@@ -1,6 +1,7 @@
 #pragma once
 #include <DX3D/Core/Scene.h>
 #include <DX3D/Core/EntityManager.h>
+#include <DX3D/Core/SystemManager.h>
 #include <DX3D/Graphics/GraphicsEngine.h>
 #include <memory>
 #include <string>
@@ -27,7 +28,9 @@ namespace dx3d {
         void spawnFirmGuyCircle(Vec2 position);
         void spawnFirmGuyRectangle(Vec2 position);
     private:
-        std::unique_ptr<EntityManager> m_entityManager;
+        std::unique_ptr<SystemManager> m_systems;
+
+        void registerSystems();
 
         void updateCameraMovement(float dt);
     };
@@ -407,6 +407,12 @@ void dx3d::DeviceContext::drawTriangleList(ui32 vertexCount, ui32 startVertexLoc
 	m_context->Draw(vertexCount, startVertexLocation);
 }
 
+void dx3d::DeviceContext::drawInstancedTriangleList(ui32 vertexCountPerInstance, ui32 instanceCount)
+{
+	m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	m_context->DrawInstanced(vertexCountPerInstance, instanceCount, 0, 0);
+}
+
 void dx3d::DeviceContext::setIndexBuffer(IndexBuffer& ib, DXGI_FORMAT fmt, ui32 offset)
 {
 	m_context->IASetIndexBuffer(ib.getNative(), fmt, offset);
@@ -432,6 +438,11 @@ void dx3d::DeviceContext::setPSShaderResource(ui32 slot, ID3D11ShaderResourceVie
 	m_context->PSSetShaderResources(slot, 1, &srv);
 }
 
+void dx3d::DeviceContext::setVSShaderResource(ui32 slot, ID3D11ShaderResourceView* srv)
+{
+	m_context->VSSetShaderResources(slot, 1, &srv);
+}
+
 void dx3d::DeviceContext::setPSConstants0(const void* data, ui32 byteSize)
 {
     // Create or resize a small dynamic buffer on demand and bind to PS b0
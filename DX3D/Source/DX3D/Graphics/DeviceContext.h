@@ -20,11 +20,13 @@ namespace dx3d
 		void setVertexBuffer(const VertexBuffer& buffer);
 		void setViewportSize(const Rect& size);
 		void drawTriangleList(ui32 vertexCount, ui32 startVertexLocation);
+		void drawInstancedTriangleList(ui32 vertexCountPerInstance, ui32 instanceCount);
 
 		void setIndexBuffer(IndexBuffer& ib, DXGI_FORMAT fmt = DXGI_FORMAT_R32_UINT, ui32 offset = 0);
 		void drawIndexedTriangleList(ui32 indexCount, ui32 startIndex);
 		void drawIndexedLineList(ui32 indexCount, ui32 startIndex);
 		void setPSShaderResource(ui32 slot, ID3D11ShaderResourceView* srv);
+		void setVSShaderResource(ui32 slot, ID3D11ShaderResourceView* srv);
 
 		void setWorldMatrix(const Mat4& worldMatrix);
 		void setPSSampler(ui32 slot, ID3D11SamplerState* sampler);
@@ -6,6 +6,7 @@
 #include <DX3D/Graphics/GraphicsPipelineState.h>
 #include <DX3D/Graphics/VertexBuffer.h>
 #include <DX3D/Graphics/VertexShaderSignature.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 
 using namespace dx3d;
 
@@ -28,6 +29,8 @@ dx3d::GraphicsDevice::GraphicsDevice(const GraphicsDeviceDesc& desc) : Base(desc
 	//getting the IDXGIFactory which is the parent of the m_dxgiAdapter
 	DX3DGraphicsLogThrowOnFail(m_dxgiAdapter->GetParent(IID_PPV_ARGS(&m_dxgiFactory)),
 		"GetParent failed to retrieve IDXGIFactory");
+
+	m_resourceCache = std::make_unique<GraphicsResourceCache>(*this);
 }
 
 dx3d::GraphicsDevice::~GraphicsDevice()
@@ -5,9 +5,11 @@
 #include <d3d11.h>
 #include <wrl.h>
 #include <DX3D/Graphics/IndexBuffer.h>
+#include <memory>
 
 namespace dx3d
 {
+    class GraphicsResourceCache;
 
     struct IndexBufferDesc {
         const void* data{};
@@ -34,6 +36,8 @@ namespace dx3d
         void executeCommandList(DeviceContext& context);
         ID3D11Device* getD3DDevice() const noexcept { return m_d3dDevice.Get(); }
         GraphicsResourceDesc getGraphicsResourceDesc() const noexcept;
+        // Textures and primitive meshes shared by everything created on this device
+        GraphicsResourceCache& getResourceCache() noexcept { return *m_resourceCache; }
     private:
 
     private:
@@ -42,5 +46,6 @@ namespace dx3d
         Microsoft::WRL::ComPtr<IDXGIDevice>         m_dxgiDevice{};
         Microsoft::WRL::ComPtr<IDXGIAdapter>        m_dxgiAdapter{};
         Microsoft::WRL::ComPtr<IDXGIFactory>        m_dxgiFactory{};
+        std::unique_ptr<GraphicsResourceCache>      m_resourceCache; // released before the device
     };
 }
\ No newline at end of file
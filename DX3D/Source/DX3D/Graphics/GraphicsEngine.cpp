@@ -242,6 +242,32 @@ dx3d::GraphicsEngine::GraphicsEngine(const GraphicsEngineDesc& desc) : Base(desc
             m_skyboxPipeline.reset();
         }
     }
+
+    // ---- Batched particle pipeline (ParticleBatch.hlsl) ----
+    {
+        constexpr char shaderFilePath[] = "DX3D/Assets/Shaders/ParticleBatch.hlsl";
+        std::ifstream shaderStream(shaderFilePath);
+        if (shaderStream) {
+            std::string shaderFileData{ std::istreambuf_iterator<char>(shaderStream), std::istreambuf_iterator<char>() };
+            auto* src = shaderFileData.c_str();
+            auto len = shaderFileData.length();
+
+            auto vs = device.compileShader({ shaderFilePath, src, len, "VSMain", ShaderType::VertexShader });
+            auto ps = device.compileShader({ shaderFilePath, src, len, "PSMain", ShaderType::PixelShader });
+            if (vs && ps) {
+                // Instances come from a structured buffer; no input layout
+                auto vsSig = device.createVertexShaderSignature({ vs });
+                m_particleBatchPipeline = device.createGraphicsPipelineState({ *vsSig, *ps });
+            } else {
+                std::cout << "ERROR: Failed to compile particle batch shaders" << std::endl;
+                m_particleBatchPipeline.reset();
+            }
+        }
+        else {
+            std::cout << "Failed to create particle batch pipeline - shader file not found" << std::endl;
+            m_particleBatchPipeline.reset();
+        }
+    }
 }
 
 
@@ -34,6 +34,7 @@ namespace dx3d
         GraphicsPipelineState* getBackgroundDotsPipeline() noexcept { return m_backgroundDotsPipeline.get(); }
         GraphicsPipelineState* getLinePipeline() noexcept { return m_linePipeline.get(); }
         GraphicsPipelineState* getSkyboxPipeline() noexcept { return m_skyboxPipeline.get(); }
+        GraphicsPipelineState* getParticleBatchPipeline() noexcept { return m_particleBatchPipeline.get(); }
         std::shared_ptr<Mesh> getFullscreenQuad() noexcept { return m_fullscreenQuad; }
         
         // Static function to render background dots (reusable)
@@ -55,6 +56,7 @@ namespace dx3d
         std::shared_ptr<GraphicsPipelineState> m_shadowMapDebugPipeline;
         std::shared_ptr<GraphicsPipelineState> m_linePipeline;
         std::shared_ptr<GraphicsPipelineState> m_skyboxPipeline;
+        std::shared_ptr<GraphicsPipelineState> m_particleBatchPipeline;
         std::shared_ptr<Mesh> m_fullscreenQuad;
     };
 
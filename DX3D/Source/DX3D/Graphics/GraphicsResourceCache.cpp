@@ -0,0 +1,62 @@
+#include <DX3D/Graphics/GraphicsResourceCache.h>
+#include <DX3D/Graphics/GraphicsDevice.h>
+
+namespace
+{
+	// Unreferenced textures beyond this are evicted least recently used first
+	constexpr std::size_t kTextureBudgetBytes = 256u * 1024u * 1024u;
+
+	// GPU footprint of a loaded texture (every loader here creates RGBA8 without mips)
+	std::size_t textureBytes(const dx3d::Texture2D& texture)
+	{
+		if (!texture.getSRV()) return 0;
+		Microsoft::WRL::ComPtr<ID3D11Resource> resource;
+		texture.getSRV()->GetResource(resource.GetAddressOf());
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> texture2D;
+		if (FAILED(resource.As(&texture2D))) return 0;
+		D3D11_TEXTURE2D_DESC desc{};
+		texture2D->GetDesc(&desc);
+		return static_cast<std::size_t>(desc.Width) * desc.Height * desc.ArraySize * 4;
+	}
+
+	dx3d::ResourceCache<dx3d::Texture2D>::Loader textureLoader(ID3D11Device* device, std::wstring path)
+	{
+		return [device, path = std::move(path)]()
+		{
+			auto texture = dx3d::Texture2D::LoadTexture2D(device, path.c_str());
+			return dx3d::ResourceCache<dx3d::Texture2D>::Loaded{ texture, texture ? textureBytes(*texture) : 0 };
+		};
+	}
+}
+
+dx3d::GraphicsResourceCache::GraphicsResourceCache(GraphicsDevice& device)
+	: m_device(device), m_textures(kTextureBudgetBytes)
+{
+}
+
+std::shared_ptr<dx3d::Texture2D> dx3d::GraphicsResourceCache::getTexture(const std::wstring& path)
+{
+	return m_textures.get(path, textureLoader(m_device.getD3DDevice(), path));
+}
+
+void dx3d::GraphicsResourceCache::prefetchTexture(const std::wstring& path)
+{
+	m_textures.prefetch(path, textureLoader(m_device.getD3DDevice(), path));
+}
+
+std::shared_ptr<const dx3d::Mesh> dx3d::GraphicsResourceCache::getQuadTextured(float w, float h)
+{
+	const std::wstring key = L"quad:" + std::to_wstring(w) + L"x" + std::to_wstring(h);
+	return m_meshes.get(key, [this, w, h]()
+	{
+		auto mesh = Mesh::CreateQuadTextured(m_device, w, h);
+		const std::size_t bytes = mesh ? mesh->getVertexCount() * sizeof(Vertex) + mesh->getIndexCount() * sizeof(ui32) : 0;
+		return ResourceCache<Mesh>::Loaded{ mesh, bytes };
+	});
+}
+
+void dx3d::GraphicsResourceCache::trim()
+{
+	m_textures.trim();
+	m_meshes.trim();
+}
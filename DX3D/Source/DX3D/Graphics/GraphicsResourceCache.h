@@ -0,0 +1,38 @@
+#pragma once
+#include <DX3D/Core/ResourceCache.h>
+#include <DX3D/Graphics/Mesh.h>
+#include <DX3D/Graphics/Texture2D.h>
+#include <memory>
+#include <string>
+
+namespace dx3d
+{
+	class GraphicsDevice;
+
+	// Per-device textures (keyed by file path) and primitive meshes (keyed by shape),
+	// so sprites created from the same file or size share one upload.
+	class GraphicsResourceCache
+	{
+	public:
+		explicit GraphicsResourceCache(GraphicsDevice& device);
+
+		// Decoded texture for path, or nullptr if it cannot be loaded
+		std::shared_ptr<Texture2D> getTexture(const std::wstring& path);
+		// Decode path on a JobSystem worker so a later getTexture finds it resident
+		void prefetchTexture(const std::wstring& path);
+
+		// Shared Mesh::CreateQuadTextured geometry. Copy the Mesh before giving it a
+		// texture or sprite frame (SpriteComponent does); copies share the GPU buffers.
+		std::shared_ptr<const Mesh> getQuadTextured(float w, float h);
+
+		ResourceCache<Texture2D>::Stats getTextureStats() const { return m_textures.getStats(); }
+		ResourceCache<Mesh>::Stats getMeshStats() const { return m_meshes.getStats(); }
+		// Drop everything no longer referenced outside the cache
+		void trim();
+
+	private:
+		GraphicsDevice& m_device;
+		ResourceCache<Texture2D> m_textures;
+		ResourceCache<Mesh> m_meshes;
+	};
+}
@@ -0,0 +1,108 @@
+#include <DX3D/Graphics/ParticleBatchDevice.h>
+#include <DX3D/Graphics/DeviceContext.h>
+#include <DX3D/Graphics/GraphicsEngine.h>
+#include <cstring>
+
+dx3d::ParticleBatchDevice::ParticleBatchDevice(GraphicsDevice& device) : m_device(device)
+{
+	D3D11_BUFFER_DESC drawDesc{};
+	drawDesc.Usage = D3D11_USAGE_DYNAMIC;
+	drawDesc.ByteWidth = 16; // firstInstance + pad
+	drawDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	drawDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	if (FAILED(m_device.getD3DDevice()->CreateBuffer(&drawDesc, nullptr, m_drawBuffer.GetAddressOf())))
+		m_drawBuffer.Reset(); // draw() then reports the batch as not drawn
+}
+
+dx3d::ui32 dx3d::ParticleBatchDevice::addMaterial(std::shared_ptr<Texture2D> texture)
+{
+	m_materials.push_back(std::move(texture));
+	return static_cast<ui32>(m_materials.size() - 1);
+}
+
+bool dx3d::ParticleBatchDevice::draw(GraphicsEngine& engine, DeviceContext& ctx, ParticleBatchRenderer& batch)
+{
+	auto* pipeline = engine.getParticleBatchPipeline();
+	if (!pipeline || !m_drawBuffer) return false;
+
+	ctx.setGraphicsPipelineState(*pipeline);
+	ctx.setWorldMatrix(Mat4::identity());
+	ctx.setPSSampler(0, ctx.getDefaultSampler());
+	ctx.enableAlphaBlending();
+	ctx.enableTransparentDepth();
+
+	m_context = &ctx;
+	const bool drawn = batch.flush(*this);
+	m_context = nullptr;
+
+	ctx.setVSShaderResource(1, nullptr);
+	ctx.disableAlphaBlending();
+	ctx.enableDefaultDepth();
+	ctx.setGraphicsPipelineState(engine.getDefaultPipeline());
+	return drawn;
+}
+
+bool dx3d::ParticleBatchDevice::uploadInstances(const ParticleInstance* instances, ui32 count)
+{
+	if (!m_context) return false;
+
+	// Grow to the next power of two so a slowly rising particle count reallocates rarely
+	if (count > m_capacity)
+	{
+		ui32 capacity = 1024;
+		while (capacity < count) capacity *= 2;
+
+		D3D11_BUFFER_DESC desc{};
+		desc.Usage = D3D11_USAGE_DYNAMIC;
+		desc.ByteWidth = capacity * sizeof(ParticleInstance);
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		desc.StructureByteStride = sizeof(ParticleInstance);
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> view;
+		if (FAILED(m_device.getD3DDevice()->CreateBuffer(&desc, nullptr, buffer.GetAddressOf())))
+			return false;
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc{};
+		viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+		viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		viewDesc.Buffer.FirstElement = 0;
+		viewDesc.Buffer.NumElements = capacity;
+		if (FAILED(m_device.getD3DDevice()->CreateShaderResourceView(buffer.Get(), &viewDesc, view.GetAddressOf())))
+			return false;
+
+		m_instanceBuffer = buffer;
+		m_instanceView = view;
+		m_capacity = capacity;
+	}
+
+	auto* context = m_context->getD3DDeviceContext();
+	D3D11_MAPPED_SUBRESOURCE mapped{};
+	if (FAILED(context->Map(m_instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return false;
+	memcpy(mapped.pData, instances, count * sizeof(ParticleInstance));
+	context->Unmap(m_instanceBuffer.Get(), 0);
+
+	m_context->setVSShaderResource(1, m_instanceView.Get());
+	return true;
+}
+
+void dx3d::ParticleBatchDevice::drawInstances(ui32 material, ui32 firstInstance, ui32 count)
+{
+	if (!m_context) return;
+
+	auto* context = m_context->getD3DDeviceContext();
+	D3D11_MAPPED_SUBRESOURCE mapped{};
+	if (FAILED(context->Map(m_drawBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return;
+	const ui32 data[4] = { firstInstance, 0, 0, 0 };
+	memcpy(mapped.pData, data, sizeof(data));
+	context->Unmap(m_drawBuffer.Get(), 0);
+	context->VSSetConstantBuffers(1, 1, m_drawBuffer.GetAddressOf());
+
+	auto* texture = material < m_materials.size() ? m_materials[material].get() : nullptr;
+	m_context->setPSShaderResource(0, texture ? texture->getSRV() : nullptr);
+	m_context->drawInstancedTriangleList(6, count);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <DX3D/Graphics/GraphicsDevice.h>
+#include <DX3D/Graphics/ParticleBatchRenderer.h>
+#include <DX3D/Graphics/Texture2D.h>
+#include <d3d11.h>
+#include <wrl.h>
+#include <memory>
+#include <vector>
+
+namespace dx3d
+{
+	class GraphicsEngine;
+
+	// Draws a ParticleBatchRenderer with ParticleBatch.hlsl: the instances go into one
+	// dynamic structured buffer per flush and each material is a single DrawInstanced of
+	// a six-vertex quad, textured with that material's texture.
+	class ParticleBatchDevice final : public ParticleBatchTarget
+	{
+	public:
+		explicit ParticleBatchDevice(GraphicsDevice& device);
+
+		// Index to pass to ParticleBatchRenderer::add for quads using this texture
+		ui32 addMaterial(std::shared_ptr<Texture2D> texture);
+
+		// Flush batch in world space with the context's current view / projection and
+		// alpha blending; leaves the engine's default pipeline bound. Returns false if the
+		// particle pipeline or its buffers are unavailable (batch is left untouched).
+		bool draw(GraphicsEngine& engine, DeviceContext& ctx, ParticleBatchRenderer& batch);
+
+		bool uploadInstances(const ParticleInstance* instances, ui32 count) override;
+		void drawInstances(ui32 material, ui32 firstInstance, ui32 count) override;
+
+	private:
+		GraphicsDevice& m_device;
+		std::vector<std::shared_ptr<Texture2D>> m_materials;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> m_instanceBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_instanceView;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> m_drawBuffer; // VS b1: first instance of the draw
+		ui32 m_capacity = 0;
+		DeviceContext* m_context = nullptr; // set for the duration of draw()
+	};
+}
@@ -0,0 +1,61 @@
+#include <DX3D/Graphics/ParticleBatchRenderer.h>
+
+using namespace dx3d;
+
+void ParticleBatchRenderer::clear()
+{
+    for (auto& instances : m_materials) instances.clear();
+}
+
+void ParticleBatchRenderer::add(std::uint32_t material, std::uint32_t count, const float* x, const float* y,
+    const float* sizes, float size, const std::uint32_t* colors, std::uint32_t color)
+{
+    if (material >= m_materials.size()) m_materials.resize(material + 1);
+    auto& instances = m_materials[material];
+    const std::size_t first = instances.size();
+    instances.resize(first + count);
+    ParticleInstance* out = instances.data() + first;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        out[i].x = x[i];
+        out[i].y = y[i];
+        out[i].size = sizes ? sizes[i] : size;
+        out[i].color = colors ? colors[i] : color;
+    }
+}
+
+std::uint32_t ParticleBatchRenderer::getInstanceCount() const
+{
+    std::size_t count = 0;
+    for (const auto& instances : m_materials) count += instances.size();
+    return static_cast<std::uint32_t>(count);
+}
+
+bool ParticleBatchRenderer::flush(ParticleBatchTarget& target)
+{
+    m_drawCalls = 0;
+    m_packed.clear();
+    m_packed.reserve(getInstanceCount());
+    for (const auto& instances : m_materials)
+        m_packed.insert(m_packed.end(), instances.begin(), instances.end());
+    if (m_packed.empty())
+        return true;
+
+    if (!target.uploadInstances(m_packed.data(), static_cast<std::uint32_t>(m_packed.size())))
+    {
+        clear();
+        return false;
+    }
+
+    std::uint32_t first = 0;
+    for (std::uint32_t material = 0; material < m_materials.size(); ++material)
+    {
+        const std::uint32_t count = static_cast<std::uint32_t>(m_materials[material].size());
+        if (count == 0) continue;
+        target.drawInstances(material, first, count);
+        first += count;
+        ++m_drawCalls;
+    }
+    clear();
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace dx3d
+{
+    // One particle quad as the vertex shader reads it: center, edge length and an RGBA8
+    // tint (red in the low byte). Like SpriteComponent, the tint's alpha is how much of
+    // the texture color it replaces; the quad's opacity comes from the texture.
+    struct ParticleInstance
+    {
+        float x;
+        float y;
+        float size;
+        std::uint32_t color;
+    };
+
+    inline std::uint32_t packParticleColor(float r, float g, float b, float a)
+    {
+        auto channel = [](float c)
+        {
+            c = c < 0.0f ? 0.0f : (c > 1.0f ? 1.0f : c);
+            return static_cast<std::uint32_t>(c * 255.0f + 0.5f);
+        };
+        return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+    }
+
+    // RGBA channels of a packParticleColor value, each in [0, 1]
+    struct ParticleColor
+    {
+        float r, g, b, a;
+    };
+
+    inline ParticleColor unpackParticleColor(std::uint32_t color)
+    {
+        auto channel = [color](int shift) { return static_cast<float>((color >> shift) & 0xFFu) / 255.0f; };
+        return { channel(0), channel(8), channel(16), channel(24) };
+    }
+
+    // Receives a flushed batch: every instance in one upload, then one draw per material
+    // over a contiguous range of them. ParticleBatchDevice draws with D3D11; anything
+    // else (a recording stub, a benchmark) can stand in without a GPU.
+    class ParticleBatchTarget
+    {
+    public:
+        virtual ~ParticleBatchTarget() = default;
+        virtual bool uploadInstances(const ParticleInstance* instances, std::uint32_t count) = 0;
+        virtual void drawInstances(std::uint32_t material, std::uint32_t firstInstance, std::uint32_t count) = 0;
+    };
+
+    // Collects particle quads for a frame and hands them to a target as one instance
+    // buffer, so drawing N particles costs one draw per material instead of one sprite
+    // draw (world matrix, tint and texture binds) per particle. Materials are small
+    // indices the target maps to textures; quads keep their submission order within one.
+    class ParticleBatchRenderer
+    {
+    public:
+        // Drop everything added since the last flush; keeps the capacity
+        void clear();
+
+        void add(std::uint32_t material, float x, float y, float size, std::uint32_t color)
+        {
+            if (material >= m_materials.size()) m_materials.resize(material + 1);
+            m_materials[material].push_back({ x, y, size, color });
+        }
+
+        // count quads from SoA arrays; sizes / colors may be null to use size / color for all
+        void add(std::uint32_t material, std::uint32_t count, const float* x, const float* y,
+            const float* sizes, float size, const std::uint32_t* colors, std::uint32_t color);
+
+        // Pack, upload and draw everything added, then clear. Returns false (and draws
+        // nothing) if the target could not take the upload.
+        bool flush(ParticleBatchTarget& target);
+
+        std::uint32_t getInstanceCount() const;
+        // Of the last flush
+        std::uint32_t getDrawCalls() const { return m_drawCalls; }
+
+    private:
+        std::vector<std::vector<ParticleInstance>> m_materials; // quads added per material
+        std::vector<ParticleInstance> m_packed;                 // all of them, grouped by material
+        std::uint32_t m_drawCalls = 0;
+    };
+}
@@ -1,13 +1,14 @@
 ﻿#include "SpriteComponent.h"
 #include <DX3D/Graphics/GraphicsEngine.h>
+#include <DX3D/Graphics/GraphicsResourceCache.h>
 
 using namespace dx3d;
 
 
 SpriteComponent::SpriteComponent(GraphicsDevice& device, const std::wstring& texturePath,
 	float width, float height) : m_device(device) {
-	// Load texture
-	m_texture = Texture2D::LoadTexture2D(device.getD3DDevice(), texturePath.c_str());
+	// Shared with every other sprite using this file
+	m_texture = device.getResourceCache().getTexture(texturePath);
 	if (!m_texture) {
 		// Fallback to white texture if loading fails
 		m_texture = Texture2D::CreateDebugTexture(device.getD3DDevice());
@@ -38,10 +39,11 @@ SpriteComponent::SpriteComponent(GraphicsDevice& device, std::shared_ptr<Mesh> m
 
 
 void SpriteComponent::initialize(GraphicsDevice& device, float width, float height) {
-	// Create textured quad mesh
+	// Own copy of the cached quad: shares its buffers, keeps its own texture and frame
 	m_width = width;
 	m_height = height;
-	m_mesh = Mesh::CreateQuadTextured(device, width, height);
+	if (auto quad = device.getResourceCache().getQuadTextured(width, height))
+		m_mesh = std::make_shared<Mesh>(*quad);
 	if (m_mesh && m_texture) {
 		m_mesh->setTexture(m_texture);
 	}